@@ -57,6 +57,16 @@ macro(MITK_CREATE_MODULE_TESTS)
       endif()
     endforeach()
 
+    # Benchmarks are compiled with the regular tests (MODULE_BENCHMARK_TESTS lists
+    # files of MODULE_TESTS) and only run on request, see MITK_BENCHMARK.
+    if(MITK_ENABLE_BENCHMARK_TESTING)
+      foreach( test ${MODULE_BENCHMARK_TESTS} )
+        get_filename_component(TName ${test} NAME_WE)
+        add_test(${TName}_Benchmark ${CMAKE_RUNTIME_OUTPUT_DIRECTORY}/${TESTDRIVER} ${TName} benchmark)
+        set_property(TEST ${TName}_Benchmark PROPERTY LABELS ${MODULE_SUBPROJECTS} MITK Benchmark)
+      endforeach()
+    endif()
+
     set(TEST_TYPES IMAGE SURFACE POINTSET) # add other file types here
 
     foreach(test_type ${TEST_TYPES})
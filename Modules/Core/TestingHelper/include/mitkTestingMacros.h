@@ -17,6 +17,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #ifndef mitkTestingMacros_h
 #define mitkTestingMacros_h
 
+#include <algorithm>
 #include <exception>
 #include <iostream>
 #include <string>
@@ -305,6 +306,25 @@ namespace mitk
  */
 #define MITK_TEST(TESTMETHOD) CPPUNIT_TEST(TESTMETHOD)
 
+/**
+ * @brief Adds a benchmark to the current test suite.
+ *
+ * @ingroup MITKTestingAPI
+ *
+ * Benchmarks are only added if the test driver is called with the argument
+ * "benchmark" after the test name. If MITK_ENABLE_BENCHMARK_TESTING is set,
+ * MITK_CREATE_MODULE_TESTS adds such a run with the label "Benchmark" for every
+ * test listed in MODULE_BENCHMARK_TESTS. The run executes the other tests of
+ * the suite as well.
+ *
+ * @param TESTMETHOD The name of the member funtion benchmark.
+ */
+#define MITK_BENCHMARK(TESTMETHOD)                                                                                     \
+  if (std::find(globalCmdLineArgs.begin(), globalCmdLineArgs.end(), "benchmark") != globalCmdLineArgs.end())           \
+  {                                                                                                                    \
+    CPPUNIT_TEST(TESTMETHOD);                                                                                          \
+  }
+
 /**
  * @brief Adds a parameterized test to the current test suite.
  *
@@ -134,6 +134,8 @@ set(CPP_FILES
   DataManagement/mitkPropertyExtensions.cpp
   DataManagement/mitkPropertyFilter.cpp
   DataManagement/mitkPropertyFilters.cpp
+  DataManagement/mitkPropertyHandle.cpp
+  DataManagement/mitkPropertyKeys.cpp
   DataManagement/mitkPropertyList.cpp
   DataManagement/mitkPropertyListReplacedObserver.cpp
   DataManagement/mitkPropertyNameHelper.cpp
@@ -243,12 +245,14 @@ set(CPP_FILES
   IO/mitkLegacyFileWriterService.cpp
   IO/mitkLocaleSwitch.cpp
   IO/mitkLog.cpp
+  IO/mitkMappedImageMemory.cpp
   IO/mitkMimeType.cpp
   IO/mitkMimeTypeProvider.cpp
   IO/mitkOperation.cpp
   IO/mitkPixelType.cpp
   IO/mitkPointSetReaderService.cpp
   IO/mitkPointSetWriterService.cpp
+  IO/mitkProgressiveImageMemory.cpp
   IO/mitkProportionalTimeGeometryToXML.cpp
   IO/mitkRawImageFileReader.cpp
   IO/mitkStandardFileLocations.cpp
@@ -264,6 +268,7 @@ set(CPP_FILES
   #Rendering/mitkGLMapper.cpp Moved to deprecated LegacyGL Module
   Rendering/mitkGradientBackground.cpp
   Rendering/mitkImageVtkMapper2D.cpp
+  Rendering/mitkImageSliceCache.cpp
   Rendering/mitkIShaderRepository.cpp
   Rendering/mitkMapper.cpp
   Rendering/mitkAnnotation.cpp
@@ -32,6 +32,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #endif
 
 #include "mitkColorProperty.h"
+#include "mitkPropertyHandle.h"
 #include "mitkPropertyList.h"
 #include "mitkStringProperty.h"
 //#include "mitkMapper.h"
@@ -68,7 +69,8 @@ namespace mitk
   public:
     typedef mitk::Geometry3D::Pointer Geometry3DPointer;
     typedef std::vector<itk::SmartPointer<Mapper>> MapperVector;
-    typedef std::map<std::string, mitk::PropertyList::Pointer> MapOfPropertyLists;
+    /** transparent comparator: renderer specific lists are looked up by renderer name without a temporary string */
+    typedef std::map<std::string, mitk::PropertyList::Pointer, std::less<>> MapOfPropertyLists;
     typedef std::vector<MapOfPropertyLists::key_type> PropertyListKeyNames;
     typedef std::set<std::string> GroupTagList;
 
@@ -228,6 +230,16 @@ namespace mitk
      */
     mitk::BaseProperty *GetProperty(const char *propertyKey, const mitk::BaseRenderer *renderer = nullptr) const;
 
+    /**
+     * \brief Get the property of \a handle like GetProperty(const char *, const BaseRenderer *) const.
+     *
+     * The result is cached in the handle and reused until a property is added to, replaced in or deleted from the
+     * property lists of this node that the handle looked at. Keep the handle (e.g. as a member of a mapper) to look up
+     * the same property for every frame.
+     * \sa PropertyHandle
+     */
+    mitk::BaseProperty *GetProperty(PropertyHandle &handle, const mitk::BaseRenderer *renderer = nullptr) const;
+
     /**
      * \brief Get the property of type T with key \a propertyKey from the PropertyList
      * of the \a renderer, if available there, otherwise use the BaseRenderer-independent PropertyList.
@@ -293,6 +305,12 @@ namespace mitk
      */
     bool GetBoolProperty(const char *propertyKey, bool &boolValue, const mitk::BaseRenderer *renderer = nullptr) const;
 
+    /**
+     * \brief Convenience access method for bool properties, looked up by a PropertyHandle
+     * \return \a true property was found
+     */
+    bool GetBoolProperty(PropertyHandle &handle, bool &boolValue, const mitk::BaseRenderer *renderer = nullptr) const;
+
     /**
      * \brief Convenience access method for int properties (instances of
      * IntProperty)
@@ -300,6 +318,12 @@ namespace mitk
      */
     bool GetIntProperty(const char *propertyKey, int &intValue, const mitk::BaseRenderer *renderer = nullptr) const;
 
+    /**
+     * \brief Convenience access method for int properties, looked up by a PropertyHandle
+     * \return \a true property was found
+     */
+    bool GetIntProperty(PropertyHandle &handle, int &intValue, const mitk::BaseRenderer *renderer = nullptr) const;
+
     /**
      * \brief Convenience access method for float properties (instances of
      * FloatProperty)
@@ -309,6 +333,12 @@ namespace mitk
                           float &floatValue,
                           const mitk::BaseRenderer *renderer = nullptr) const;
 
+    /**
+     * \brief Convenience access method for float properties, looked up by a PropertyHandle
+     * \return \a true property was found
+     */
+    bool GetFloatProperty(PropertyHandle &handle, float &floatValue, const mitk::BaseRenderer *renderer = nullptr) const;
+
     /**
      * \brief Convenience access method for double properties (instances of
      * DoubleProperty)
@@ -338,6 +368,12 @@ namespace mitk
      */
     bool GetColor(float rgb[3], const mitk::BaseRenderer *renderer = nullptr, const char *propertyKey = "color") const;
 
+    /**
+     * \brief Convenience access method for color properties, looked up by a PropertyHandle
+     * \return \a true property was found
+     */
+    bool GetColor(float rgb[3], const mitk::BaseRenderer *renderer, PropertyHandle &handle) const;
+
     /**
      * \brief Convenience access method for level-window properties (instances of
      * LevelWindowProperty)
@@ -415,6 +451,15 @@ namespace mitk
       return GetBoolProperty(propertyKey, visible, renderer);
     }
 
+    /**
+     * \brief Convenience access method for visibility properties, looked up by a PropertyHandle
+     * \return \a true property was found
+     */
+    bool GetVisibility(bool &visible, const mitk::BaseRenderer *renderer, PropertyHandle &handle) const
+    {
+      return GetBoolProperty(handle, visible, renderer);
+    }
+
     /**
      * \brief Convenience access method for opacity properties (instances of
      * FloatProperty)
@@ -422,6 +467,12 @@ namespace mitk
      */
     bool GetOpacity(float &opacity, const mitk::BaseRenderer *renderer, const char *propertyKey = "opacity") const;
 
+    /**
+     * \brief Convenience access method for opacity properties, looked up by a PropertyHandle
+     * \return \a true property was found
+     */
+    bool GetOpacity(float &opacity, const mitk::BaseRenderer *renderer, PropertyHandle &handle) const;
+
     /**
      * \brief Convenience access method for boolean properties (instances
      * of BoolProperty). Return value is the value of the property. If the property is
@@ -553,6 +604,12 @@ namespace mitk
     /// Invoked when the property list was modified. Calls Modified() of the DataNode
     virtual void PropertyListModified(const itk::Object *caller, const itk::EventObject &event);
 
+    /// Common implementation of the GetProperty methods, \a renderer may be NULL.
+    /// \a cached marks the looked at lists as used by cached lookups, see PropertyList::UseForCachedLookups().
+    mitk::BaseProperty *LookupProperty(const std::string &propertyKey,
+                                       const mitk::BaseRenderer *renderer,
+                                       bool cached = false) const;
+
     /// \brief Mapper-slots
     mutable MapperVector m_Mappers;
 
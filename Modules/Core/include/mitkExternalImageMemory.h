@@ -0,0 +1,68 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKEXTERNALIMAGEMEMORY_H
+#define MITKEXTERNALIMAGEMEMORY_H
+
+#include <MitkCoreExports.h>
+#include <mitkCommon.h>
+
+#include <itkObject.h>
+
+namespace mitk
+{
+  /**
+   * \brief Memory block of an image channel that is not allocated by mitk::Image itself
+   *
+   * Implementations provide the buffer of an image channel, e.g. a memory mapped file (see
+   * mitk::MappedImageMemory) or a buffer that is filled in the background (see mitk::ProgressiveImageMemory).
+   * The memory is imported by mitk::Image::SetImportChannel(ExternalImageMemory*, int) and stays alive as long as
+   * any ImageDataItem refers to it.
+   *
+   * Memory that is filled in the background reports which parts are available already. Image accessors wait for
+   * the parts they order (see mitk::ImageAccessorBase), mitk::Image::GetData() and mitk::Image::GetVtkImageData()
+   * wait for the whole channel or volume. Mappers may use mitk::Image::IsTimeStepAvailable() to skip parts that are
+   * not loaded yet.
+   *
+   * @ingroup Data
+   */
+  class MITKCORE_EXPORT ExternalImageMemory : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(ExternalImageMemory, itk::Object);
+
+    /** \brief Returns the first byte of the memory block. */
+    virtual void *GetData() const = 0;
+
+    /** \brief Returns the size of the memory block in bytes. */
+    virtual size_t GetSize() const = 0;
+
+    /** \brief Returns true if all bytes in [begin, end) hold their final values. */
+    virtual bool IsAvailable(const void * /*begin*/, const void * /*end*/) const { return true; }
+    /** \brief Blocks until all bytes in [begin, end) hold their final values.
+     * \throws mitk::Exception if the memory cannot be filled (e.g. on read errors)
+     */
+    virtual void WaitUntilAvailable(const void * /*begin*/, const void * /*end*/) const {}
+  protected:
+    ExternalImageMemory() {}
+    virtual ~ExternalImageMemory() {}
+  private:
+    ExternalImageMemory(const ExternalImageMemory &);
+    ExternalImageMemory &operator=(const ExternalImageMemory &);
+  };
+}
+
+#endif
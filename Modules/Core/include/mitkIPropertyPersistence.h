@@ -49,6 +49,8 @@ namespace mitk
       * are regarded equal, if the mime types are equal.
       * You may enforce to overwrite the old equal info for a property name
       * by the overwrite parameter.
+      * The service stores a copy of the info. Changing the passed instance
+      * afterwards has no effect, add it again with overwrite instead.
       *
       * \param[in] propertyName Name of the property.
       * \param[in] info Persistence info of the property.
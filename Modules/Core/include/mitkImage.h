@@ -259,6 +259,22 @@ namespace mitk
                                   int n = 0,
                                   ImportMemoryManagementType importMemoryManagement = CopyMemory);
 
+    //##Documentation
+    //## @brief Use the external @a memory as channel @a n without copying it.
+    //##
+    //## The memory is kept alive as long as the channel data (or any slice or volume
+    //## referencing it) exists. Accessors of memory that is filled in the background wait
+    //## for the parts they order, see mitk::ExternalImageMemory.
+    //## @sa IsTimeStepAvailable
+    virtual bool SetImportChannel(ExternalImageMemory *memory, int n = 0);
+
+    //##Documentation
+    //## @brief Check whether the data of time step @a t in channel @a n has been loaded
+    //##
+    //## Always true unless the channel is filled in the background (see
+    //## mitk::ProgressiveImageMemory), in which case pending time steps return false.
+    bool IsTimeStepAvailable(int t = 0, int n = 0) const;
+
     //##Documentation
     //## initialize new (or re-initialize) image information
     //## @warning Initialize() by pic assumes a plane, evenly spaced geometry starting at (0,0,0).
@@ -23,6 +23,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkSimpleFastMutexLock.h>
 #include <itkSmartPointer.h>
 
+#include <utility>
+#include <vector>
+
 #include "mitkImageDataItem.h"
 
 namespace mitk
@@ -65,6 +68,14 @@ namespace mitk
   public:
     typedef itk::SmartPointer<const mitk::Image> ImageConstPointer;
 
+    /** \brief Region type of sub-region accessors. Index and size are given in voxels, relative to the accessed
+     * ImageDataItem (or to the first channel if no ImageDataItem is given). Unused dimensions have index 0 and size 1. */
+    typedef itk::ImageRegion<4> RegionType;
+
+    /** \brief Half-open byte interval [first, second) of the memory covered by an accessor. */
+    typedef std::pair<const unsigned char *, const unsigned char *> MemoryIntervalType;
+    typedef std::vector<MemoryIntervalType> MemoryIntervalListType;
+
     /** \brief defines different flags for the ImageAccessor constructors
       */
     enum Options
@@ -85,8 +96,28 @@ namespace mitk
 
     virtual ~ImageAccessorBase();
 
-    /** \brief Gives const access to the data. */
+    /** \brief Gives const access to the data.
+     *
+     * For sub-region accessors this points to the first voxel of the region. The region is not copied, so the
+     * strides of the accessed ImageDataItem apply when moving from one row or slice of the region to the next.
+     */
     inline const void *GetData() const { return m_AddressBegin; }
+
+    /** \brief Returns true if the accessor was ordered for a sub-region of its image part. */
+    inline bool HasSubRegion() const { return m_SubRegion != nullptr; }
+
+    /** \brief Returns the byte intervals locked by this accessor, sorted by address. */
+    inline const MemoryIntervalListType &GetMemoryIntervals() const { return m_Intervals; }
+
+    /** \brief Creates a region covering one axial slice of the given time step. */
+    static RegionType CreateSliceRegion(const Image *image, unsigned int slice, unsigned int timestep = 0);
+
+    /** \brief Creates a region covering numberOfSlices consecutive axial slices of the given time step. */
+    static RegionType CreateSlabRegion(const Image *image,
+                                       unsigned int firstSlice,
+                                       unsigned int numberOfSlices,
+                                       unsigned int timestep = 0);
+
   protected:
 // Define type of thread id
 #ifdef ITK_USE_SPROC
@@ -102,8 +133,13 @@ namespace mitk
 #endif
 
     /** \brief Checks validity of given parameters from inheriting classes and stores those parameters in member
-     * variables. */
-    ImageAccessorBase(ImageConstPointer iP, const ImageDataItem *iDI = nullptr, int OptionFlags = DefaultBehavior);
+     * variables.
+     * \throws mitk::Exception if subRegion does not lie inside the accessed image part
+     */
+    ImageAccessorBase(ImageConstPointer iP,
+                      const ImageDataItem *iDI = nullptr,
+                      int OptionFlags = DefaultBehavior,
+                      const RegionType *subRegion = nullptr);
 
     /** ImageAccessor has access to the image it belongs to. */
     // ImagePointer m_Image;
@@ -125,6 +161,10 @@ namespace mitk
     /** Defines if the accessed image part lies coherently in memory */
     bool m_CoherentMemory;
 
+    /** Sorted, non-adjacent byte intervals covered by the image part. Contains a single interval for coherent
+     * memory. */
+    MemoryIntervalListType m_Intervals;
+
     /** \brief Pointer to a WaitLock struct, that allows other ImageAccessors to wait for this ImageAccessor */
     ImageAccessorWaitLock *m_WaitLock;
 
@@ -132,8 +172,8 @@ namespace mitk
      * mitk::Image class is Locked. */
     inline void Increment() { m_WaitLock->m_WaiterCount += 1; }
     /** \brief Computes if there is an Overlap of the image part between this instantiation and another ImageAccessor
-     * object
-      * \throws mitk::Exception if memory area is incoherent (not supported yet)
+     * object by intersecting their memory intervals. Accessors of disjoint sub-regions do not overlap, even if the
+     * address ranges enclosing their regions interleave.
       */
     bool Overlap(const ImageAccessorBase *iAB);
 
@@ -148,6 +188,9 @@ namespace mitk
     virtual const Image *GetImage() const = 0;
 
   private:
+    /** \brief Fills m_Intervals, m_AddressBegin and m_AddressEnd for m_SubRegion inside the given image part */
+    void ComputeSubRegionIntervals(const ImageDataItem *imageDataItem);
+
     /** \brief System dependend thread method, to prevent recursive mutex access */
     ThreadIDType CurrentThreadHandle();
     /** \brief System dependend thread method, to prevent recursive mutex access */
@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <MitkCoreExports.h>
 //#include <mitkIpPic.h>
 //#include "mitkPixelType.h"
+#include "mitkExternalImageMemory.h"
 #include "mitkImageDescriptor.h"
 //#include "mitkImageVtkAccessor.h"
 
@@ -134,6 +135,18 @@ namespace mitk
     unsigned long GetSize() const { return m_Size; }
     virtual void Modified() const;
 
+    /** \brief Returns the external memory holding the data of this item or of its parent, nullptr if the memory is
+     * allocated by the image. */
+    const ExternalImageMemory *GetExternalMemory() const;
+
+    /** \brief Blocks until the data of this item is loaded if it is filled in the background, see
+     * mitk::ExternalImageMemory. Used by the accessors that hand out the data without an mitk::ImageAccessorBase.
+     * \throws mitk::Exception if the data cannot be loaded */
+    void WaitUntilAvailable() const;
+
+    /** \brief Keeps memory alive as long as this item exists. Only used for items without parent. */
+    void SetExternalMemory(ExternalImageMemory *memory) { m_ExternalMemory = memory; }
+
   protected:
     unsigned char *m_Data;
 
@@ -150,6 +163,8 @@ namespace mitk
 
     unsigned long m_Size;
 
+    ExternalImageMemory::Pointer m_ExternalMemory;
+
   private:
     void ComputeItemSize(const unsigned int *dimensions, unsigned int dimension);
 
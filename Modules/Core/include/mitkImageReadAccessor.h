@@ -57,6 +57,20 @@ namespace mitk
 
     ImageReadAccessor(const Image *image, const ImageDataItem *iDI = nullptr);
 
+    /** \brief Orders read access for a sub-region (e.g. a slice, a slab or a bounding box) of an image part
+     *
+     *  Only accessors whose regions share memory with this region are waited for, so readers and writers of
+     *  disjoint regions of the same image proceed concurrently.
+     *  \param region region of the image part in voxel coordinates, see mitk::ImageAccessorBase::RegionType
+     *  \throws mitk::Exception if the region exceeds the accessed image part
+     *  \throws mitk::MemoryIsLockedException if the region is exclusively locked and
+     * mitk::ImageAccessorBase::ExceptionIfLocked is set in OptionFlags
+     */
+    ImageReadAccessor(ImageConstPointer image,
+                      const RegionType &region,
+                      const ImageDataItem *iDI = nullptr,
+                      int OptionFlags = ImageAccessorBase::DefaultBehavior);
+
     /** Destructor informs Image to unlock memory. */
     virtual ~ImageReadAccessor();
 
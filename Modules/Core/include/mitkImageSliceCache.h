@@ -0,0 +1,229 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKIMAGESLICECACHE_H
+#define MITKIMAGESLICECACHE_H
+
+#include <MitkCoreExports.h>
+
+#include <mitkExtractSliceFilter.h>
+#include <mitkImage.h>
+#include <mitkPlaneGeometry.h>
+
+#include <itkConditionVariable.h>
+#include <itkMultiThreader.h>
+#include <itkMutexLock.h>
+
+#include <vtkSmartPointer.h>
+
+#include <deque>
+#include <list>
+#include <vector>
+
+class vtkImageData;
+class vtkMatrix4x4;
+class vtkMitkThickSlicesFilter;
+class vtkPolyData;
+class vtkRenderWindow;
+
+namespace mitk
+{
+  class RenderingManager;
+
+  /**
+   * \brief Least recently used cache of resliced image slices, filled synchronously or by a background thread
+   *
+   * Used by mitk::ImageVtkMapper2D, which holds one cache per node and render window. A slice is identified by
+   * everything that determines its content: the image, its modification time, the plane, the time step and the
+   * reslicing parameters. Modifying the image therefore invalidates all of its slices without any notification.
+   *
+   * Slices of neighbouring planes or time steps can be computed in advance by Prefetch(). The background thread
+   * reslices a private wrapper of the requested volume and holds an mitk::ImageReadAccessor meanwhile, so the
+   * image itself is never touched by two threads. Slices that are still being computed can be bridged with the
+   * closest cached parallel slice (GetNearest()).
+   *
+   * All methods have to be called from the thread that renders.
+   */
+  class MITKCORE_EXPORT ImageSliceCache : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(ImageSliceCache, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    /** \brief Describes a slice to be extracted by Reslice() */
+    struct MITKCORE_EXPORT Request
+    {
+      Request();
+
+      Image::ConstPointer Input;
+      /** Modification time of the input, usually the maximum of the image and time step geometry MTimes */
+      unsigned long InputMTime;
+      PlaneGeometry::ConstPointer WorldGeometry;
+      unsigned int TimeStep;
+      ExtractSliceFilter::ResliceInterpolation Interpolation;
+      bool InPlaneResampleExtentByGeometry;
+      /** Thick slice mode as used by vtkMitkThickSlicesFilter plus one, 0 for thin slices */
+      int ThickSlicesMode;
+      int ThickSlicesNum;
+      double ThickSlicesSpacing;
+    };
+
+    /** \brief A resliced image and everything needed to display it */
+    class MITKCORE_EXPORT Slice : public itk::LightObject
+    {
+    public:
+      mitkClassMacroItkParent(Slice, itk::LightObject);
+      itkFactorylessNewMacro(Self);
+
+      vtkSmartPointer<vtkImageData> Image;
+      /** Bounds of the slice in plane coordinates, see ExtractSliceFilter::GetClippedPlaneBounds() */
+      double Bounds[6];
+      /** Pixel spacing in mm */
+      ScalarType Spacing[2];
+      /** Transformation from plane coordinates to world coordinates */
+      vtkSmartPointer<vtkMatrix4x4> ResliceAxes;
+
+      /** Outline of a binary slice, computed on demand by the mapper for the given depth */
+      vtkSmartPointer<vtkPolyData> Outline;
+      float OutlineDepth;
+
+    protected:
+      Slice();
+    };
+
+    /**
+     * \brief Extracts the requested slice with the given filters.
+     *
+     * The caller may reuse the filters for subsequent calls, the returned slice does not depend on them.
+     */
+    static Slice::Pointer Reslice(const Request &request,
+                                  ExtractSliceFilter *reslicer,
+                                  vtkMitkThickSlicesFilter *thickSlicesFilter);
+
+    /** \brief Returns true if both requests describe the same slice. */
+    static bool IsSameSlice(const Request &first, const Request &second);
+
+    /** \brief Returns the cached slice for the request (and marks it as recently used), or nullptr. */
+    Slice::Pointer Get(const Request &request);
+
+    /**
+     * \brief Returns the cached slice of the same image, time step and orientation whose plane is closest to the
+     * requested one, or nullptr.
+     *
+     * The returned slice is a copy sharing the pixel data, its ResliceAxes are moved to the requested plane.
+     */
+    Slice::Pointer GetNearest(const Request &request);
+
+    /** \brief Adds a slice, dropping the least recently used slices if the cache is full. */
+    void Add(const Request &request, Slice *slice);
+
+    /**
+     * \brief Queues the request for the background thread. Nothing happens if the slice is cached or queued.
+     *
+     * If a render window is given, an update of it is requested when the slice is available, or right away if
+     * the request is dropped because newer requests filled the queue.
+     */
+    void Prefetch(const Request &request, vtkRenderWindow *renderWindowToUpdate = nullptr);
+
+    /** \brief Returns true if the request is queued or currently computed. */
+    bool IsPending(const Request &request);
+
+    /** \brief Removes all slices and discards all queued requests. */
+    void Clear();
+
+    void SetMaximumNumberOfSlices(unsigned int maximumNumberOfSlices);
+    unsigned int GetMaximumNumberOfSlices();
+    unsigned int GetNumberOfSlices();
+
+  protected:
+    ImageSliceCache();
+    virtual ~ImageSliceCache();
+
+  private:
+    /** Everything that distinguishes two slices, without references to the input */
+    struct Key
+    {
+      const Image *Input;
+      unsigned long InputMTime;
+      Point3D Origin;
+      Vector3D Axis0;
+      Vector3D Axis1;
+      unsigned int TimeStep;
+      ExtractSliceFilter::ResliceInterpolation Interpolation;
+      bool InPlaneResampleExtentByGeometry;
+      int ThickSlicesMode;
+      int ThickSlicesNum;
+      double ThickSlicesSpacing;
+
+      Key();
+      explicit Key(const Request &request);
+
+      /** True if both keys differ in nothing but the plane position along the normal */
+      bool IsParallelTo(const Key &other) const;
+      bool operator==(const Key &other) const;
+    };
+
+    struct Entry
+    {
+      Key SliceKey;
+      Slice::Pointer CachedSlice;
+    };
+
+    struct Job
+    {
+      Job() : RenderWindowToUpdate(nullptr) {}
+
+      Key SliceKey;
+      /** The request, redirected to an image that only wraps the volume of the requested time step */
+      Request VolumeRequest;
+      Image::ConstPointer Source;
+      Image::ImageDataItemPointer SourceVolume;
+      vtkRenderWindow *RenderWindowToUpdate;
+      itk::SmartPointer<RenderingManager> RenderingManagerToUpdate;
+    };
+
+    static ITK_THREAD_RETURN_TYPE WorkerThread(void *pInfoStruct);
+
+    /** Computes queued jobs until m_Abort is set */
+    void ProcessJobs();
+
+    /** Adds or refreshes an entry, m_Mutex has to be locked */
+    void AddLocked(const Key &key, Slice *slice);
+
+    void StopWorker();
+
+    itk::SimpleMutexLock m_Mutex;
+    itk::ConditionVariable::Pointer m_JobsAvailable;
+
+    /** Most recently used slice first */
+    std::list<Entry> m_Entries;
+    unsigned int m_MaximumNumberOfSlices;
+
+    std::deque<Job> m_Jobs;
+    /** The job that is computed right now, only its key and render window are set */
+    bool m_JobRunning;
+    Job m_RunningJob;
+    bool m_Abort;
+
+    /** Inputs of finished jobs, released by the rendering thread in the next Get() or Prefetch() */
+    std::vector<Image::ConstPointer> m_ReleasedInputs;
+
+    itk::MultiThreader::Pointer m_MultiThreader;
+    int m_ThreadID;
+  };
+}
+
+#endif
@@ -23,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 // MITK Rendering
 #include "mitkBaseRenderer.h"
 #include "mitkExtractSliceFilter.h"
+#include "mitkImageSliceCache.h"
 #include "mitkVtkMapper.h"
 
 // VTK
@@ -56,6 +57,10 @@ namespace mitk
    * properties such as thick slices. This code was already present in the old version
    * (mitkImageMapperGL2D).
    *
+   * Resliced slices are kept in an mitk::ImageSliceCache per render window, so that returning to a slice
+   * (or time step) does not reslice the image again as long as the image is not modified. While scrolling
+   * through space or time, the next slices in the scroll direction are resliced in the background.
+   *
    * Next, the obtained slice (m_ReslicedImage) is put into a vtkMitkLevelWindowFilter
    * and the scalar levelwindow, opacity levelwindow and optional clipping to
    * local image bounds are applied
@@ -92,6 +97,10 @@ namespace mitk
    *   - \b "texture interpolation": (BoolProperty) texture interpolation of the image
    *   - \b "reslice interpolation": (VtkResliceInterpolationProperty) reslice interpolation of the image
    *   - \b "in plane resample extent by geometry": (BoolProperty) Do it or not
+   *   - \b "Image Rendering.Prefetched slices": (IntProperty) Number of slices (or time steps) in the scroll
+   *          direction that are resliced in the background, 0 disables prefetching
+   *   - \b "Image Rendering.Show nearest cached slice": (BoolProperty) Display the closest cached slice until
+   *          the requested slice has been resliced in the background instead of reslicing it immediately
    *   - \b "bounding box": (BoolProperty) Is the Bounding Box of the image shown or not
    *   - \b "layer": (IntProperty) Layer of the image
    *   - \b "volume annotation color": (ColorProperty) color of the volume annotation, TODO has to be reimplemented
@@ -107,6 +116,8 @@ namespace mitk
    *   - \b "texture interpolation", mitk::BoolProperty::New( mitk::DataNodeFactory::m_TextureInterpolationActive ) )
    *   - \b "reslice interpolation", mitk::VtkResliceInterpolationProperty::New() )
    *   - \b "in plane resample extent by geometry", mitk::BoolProperty::New( false ) )
+   *   - \b "Image Rendering.Prefetched slices", mitk::IntProperty::New( 2 ) )
+   *   - \b "Image Rendering.Show nearest cached slice", mitk::BoolProperty::New( false ) )
    *   - \b "bounding box", mitk::BoolProperty::New( false ) )
    *   - \b "layer", mitk::IntProperty::New(10), renderer, overwrite)
    *   - \b "Image Rendering.Transfer Function":  Default color transfer function for CTs
@@ -184,9 +195,25 @@ namespace mitk
       /** \brief Timestamp of last update of stored data. */
       itk::TimeStamp m_LastUpdateTime;
 
+      /** \brief True if the displayed time step was not loaded yet at the last update. */
+      bool m_WaitingForTimeStep;
+
       /** \brief mmPerPixel relation between pixel and mm. (World spacing).*/
       mitk::ScalarType *m_mmPerPixel;
 
+      /** \brief Resliced slices of this render window, also filled in the background. */
+      ImageSliceCache::Pointer m_SliceCache;
+      /** \brief The displayed slice, holds m_ReslicedImage, m_mmPerPixel and the reslice axes. */
+      ImageSliceCache::Slice::Pointer m_Slice;
+
+      /** \brief True if the slice of m_NearestSliceRequest is still being computed and a neighbour is shown. */
+      bool m_ShowingNearestSlice;
+      ImageSliceCache::Request m_NearestSliceRequest;
+
+      /** \brief Slice and time step of the last update, the scroll direction is derived from them. */
+      unsigned int m_LastSlice;
+      unsigned int m_LastTimeStep;
+
       /** \brief This filter is used to apply the level window to Grayvalue and RBG(A) images. */
       vtkSmartPointer<vtkMitkLevelWindowFilter> m_LevelWindowFilter;
 
@@ -233,6 +260,19 @@ namespace mitk
       */
     void GeneratePlane(mitk::BaseRenderer *renderer, double planeBounds[6]);
 
+    /** \brief Collects the parameters for reslicing the image at the given plane and time step.
+      * \return false if the plane is not suitable for reslicing
+      */
+    bool GetSliceRequest(mitk::BaseRenderer *renderer,
+                         const PlaneGeometry *worldGeometry,
+                         unsigned int timeStep,
+                         ImageSliceCache::Request &request);
+
+    /** \brief Queues the neighbours of the requested slice in the current scroll direction for reslicing in
+      * the background, see property "Image Rendering.Prefetched slices".
+      */
+    void PrefetchSlices(mitk::BaseRenderer *renderer, const ImageSliceCache::Request &request);
+
     /** \brief Generates a vtkPolyData object containing the outline of a given binary slice.
         \param renderer: Pointer to the renderer containing the needed information
         \note This code is based on code from the iil library.
@@ -47,6 +47,20 @@ namespace mitk
                        const ImageDataItem *iDI = nullptr,
                        int OptionFlags = ImageAccessorBase::DefaultBehavior);
 
+    /** \brief Orders write access for a sub-region (e.g. a slice, a slab or a bounding box) of an image part
+     *
+     *  Writers of disjoint regions of the same image do not block each other. GetData() points to the first voxel
+     *  of the region, the strides of the image part apply.
+     *  \param region region of the image part in voxel coordinates, see mitk::ImageAccessorBase::RegionType
+     *  \throws mitk::Exception if the region exceeds the accessed image part
+     *  \throws mitk::MemoryIsLockedException if the region is exclusively locked and
+     * mitk::ImageAccessorBase::ExceptionIfLocked is set in OptionFlags
+     */
+    ImageWriteAccessor(ImagePointer image,
+                       const RegionType &region,
+                       const ImageDataItem *iDI = nullptr,
+                       int OptionFlags = ImageAccessorBase::DefaultBehavior);
+
     /** \brief Gives full data access. */
     inline void *GetData() { return m_AddressBegin; }
     /** \brief informs Image to unlock the represented image part */
@@ -30,6 +30,12 @@ namespace mitk
    * Instantiating this class with a given itk::ImageIOBase instance
    * will register corresponding MITK reader/writer services for that
    * ITK ImageIO object.
+   *
+   * Writers provide the options OPTION_COMPRESSION() and OPTION_COMPRESSION_LEVEL().
+   * By default the ITK ImageIO object compresses the data if the format supports it.
+   * For NRRD and gzip compressed NIfTI files (.nii.gz), the data can instead be split
+   * into blocks that are compressed in parallel and stored as consecutive gzip members.
+   * Every gzip reader decompresses such files like ordinary gzip files.
    */
   class MITKCORE_EXPORT ItkImageIO : public AbstractFileIO
   {
@@ -37,6 +43,19 @@ namespace mitk
     ItkImageIO(itk::ImageIOBase::Pointer imageIO);
     ItkImageIO(const CustomMimeType &mimeType, itk::ImageIOBase::Pointer imageIO, int rank);
 
+    /** \brief Writer option that selects the compression, one of the COMPRESSION_*() values as std::string or
+     * const char*. Writing throws an mitk::Exception for other values. */
+    static std::string OPTION_COMPRESSION();
+    /** \brief Writer option with the zlib compression level (0-9) used by COMPRESSION_PARALLEL(). */
+    static std::string OPTION_COMPRESSION_LEVEL();
+
+    /** \brief Compression as done by the ITK ImageIO object (single-threaded gzip at level 6 for NRRD). */
+    static std::string COMPRESSION_DEFAULT();
+    /** \brief Uncompressed data. */
+    static std::string COMPRESSION_NONE();
+    /** \brief Block-wise gzip compression with all available threads (NRRD and .nii.gz only). */
+    static std::string COMPRESSION_PARALLEL();
+
     // -------------- AbstractFileReader -------------
 
     using AbstractFileReader::Read;
@@ -55,6 +74,9 @@ namespace mitk
     // Fills the m_DefaultMetaDataKeys vector with default values
     virtual void InitializeDefaultMetaDataKeys();
 
+    // Sets the compression options as default writer options
+    void InitializeDefaultWriterOptions();
+
   private:
     ItkImageIO(const ItkImageIO &other);
 
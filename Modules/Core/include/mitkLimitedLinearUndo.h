@@ -22,6 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkUndoModel.h"
 #include <MitkCoreExports.h>
 // STL header
+#include <cstddef>
 #include <vector>
 // ITK header
 #pragma GCC visibility push(default)
@@ -35,6 +36,11 @@ namespace mitk
   //##
   //## Derived from UndoModel AND itk::Object. Invokes ITK-events to signal listening
   //## GUI elements, whether each of the stacks is empty or not (to enable/disable button, ...)
+  //##
+  //## The items of both stacks are kept within a memory budget: whenever the memory cost of
+  //## all items exceeds the budget, the items farthest away from the current state are asked
+  //## to release their memory (see UndoStackItem::ReleaseMemory()). They restore their data
+  //## on demand when they are undone or redone.
   class MITKCORE_EXPORT LimitedLinearUndo : public UndoModel
   {
   public:
@@ -101,6 +107,21 @@ namespace mitk
     //## corresponding to the given values; if nothing found, then returns NULL
     virtual OperationEvent *GetLastOfType(OperationActor *destination, OperationType opType) override;
 
+    //##Documentation
+    //## @brief Sets the number of bytes the items of both stacks may hold in memory (0 means no limit)
+    //##
+    //## Default is 512 MB.
+    void SetMemoryBudget(std::size_t bytes);
+    std::size_t GetMemoryBudget() const;
+
+    //##Documentation
+    //## @brief Returns the number of bytes the items of both stacks currently hold in memory
+    std::size_t GetMemoryCost();
+
+    //##Documentation
+    //## @brief Returns the time in milliseconds the last call of Undo() or Redo() took
+    double GetLastExecutionTime() const;
+
   protected:
     //##Documentation
     //## Constructor
@@ -114,12 +135,20 @@ namespace mitk
     //## elements in the list and to clear the list
     void ClearList(UndoContainer *list);
 
+    //##Documentation
+    //## @brief Releases the memory of the items farthest away from the current state until the
+    //## memory cost is within the budget
+    void EnforceMemoryBudget();
+
     UndoContainer m_UndoList;
 
     UndoContainer m_RedoList;
 
   private:
     int FirstObjectEventIdOfCurrentGroup(UndoContainer &stack);
+
+    std::size_t m_MemoryBudget;
+    double m_LastExecutionTime;
   };
 
 #pragma GCC visibility push(default)
@@ -0,0 +1,88 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKMAPPEDIMAGEMEMORY_H
+#define MITKMAPPEDIMAGEMEMORY_H
+
+#include <mitkExternalImageMemory.h>
+
+#include <string>
+
+namespace mitk
+{
+  /**
+   * \brief Image memory backed by a copy-on-write mapping of a file region
+   *
+   * The pages of the mapped region are read by the operating system when they are touched first, so opening a
+   * large uncompressed image only costs the time of reading its header. Writing to the memory modifies private
+   * copies of the affected pages, the file itself is never changed.
+   *
+   * @ingroup IO
+   */
+  class MITKCORE_EXPORT MappedImageMemory : public ExternalImageMemory
+  {
+  public:
+    mitkClassMacro(MappedImageMemory, ExternalImageMemory);
+
+    /**
+     * \brief Maps size bytes of the file at path, starting at byte offset.
+     * \throws mitk::Exception if the file cannot be opened or mapped
+     */
+    mitkNewMacro3Param(Self, const std::string &, unsigned long long, size_t);
+
+    virtual void *GetData() const override { return m_Data; }
+    virtual size_t GetSize() const override { return m_Size; }
+    /** \brief Returns the path of the mapped file. */
+    const std::string &GetFileName() const { return m_FileName; }
+
+    /**
+     * \brief Replaces the mapping by anonymous memory with the same content at the same address.
+     *
+     * Needed before the mapped file is overwritten, which would otherwise change (or, if the file shrinks,
+     * invalidate) pages that were not touched yet. Callers must make sure that nobody accesses the memory
+     * meanwhile, e.g. by holding an mitk::ImageWriteAccessor.
+     * \throws mitk::Exception if no memory can be allocated. On Windows the mapping is already released then and
+     * GetData() returns nullptr.
+     */
+    void Detach();
+
+    /** \brief Returns true if the memory does not depend on the file anymore. */
+    bool IsDetached() const { return m_Detached; }
+
+  protected:
+    MappedImageMemory(const std::string &path, unsigned long long offset, size_t size);
+    virtual ~MappedImageMemory();
+
+  private:
+    std::string m_FileName;
+    bool m_Detached;
+
+    /** Start of the mapped view, aligned to the allocation granularity of the system */
+    void *m_View;
+    size_t m_ViewSize;
+
+    /** First byte of the requested file region inside the view */
+    void *m_Data;
+    size_t m_Size;
+
+#ifdef _WIN32
+    void *m_FileHandle;
+    void *m_MappingHandle;
+#endif
+  };
+}
+
+#endif
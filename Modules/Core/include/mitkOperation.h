@@ -22,6 +22,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkCommon.h>
 
+#include <cstddef>
+
 namespace mitk
 {
   typedef int OperationType;
@@ -43,6 +45,22 @@ namespace mitk
 
     OperationType GetOperationType();
 
+    //##Documentation
+    //## @brief Returns the number of bytes of data this operation currently holds in memory
+    //##
+    //## Used by undo models to keep the undo history within a memory budget.
+    //## Operations that hold only a few parameters return 0, operations holding
+    //## image data or similar override this.
+    virtual std::size_t GetMemoryCost();
+
+    //##Documentation
+    //## @brief Moves the data of this operation out of memory, e.g. into a temporary file
+    //##
+    //## The data has to be restored transparently when the operation is executed.
+    //## Afterwards, GetMemoryCost() should report only what is still held in memory.
+    //## The default implementation does nothing.
+    virtual void ReleaseMemory();
+
   protected:
     OperationType m_OperationType;
   };
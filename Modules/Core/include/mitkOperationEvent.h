@@ -78,6 +78,14 @@ namespace mitk
     virtual void ReverseOperations();
     virtual void ReverseAndExecute();
 
+    //##Documentation
+    //## @brief Returns the number of bytes this item holds in memory, 0 by default
+    virtual std::size_t GetMemoryCost();
+
+    //##Documentation
+    //## @brief Moves data out of memory that can be restored on demand, does nothing by default
+    virtual void ReleaseMemory();
+
     //##Documentation
     //## @brief Increases the current ObjectEventId
     //## For example if a button click generates operations the ObjectEventId has to be incremented to be able to undo
@@ -170,6 +178,12 @@ namespace mitk
     //##reverses and executes both operations (used, when moved from undo to redo stack)
     virtual void ReverseAndExecute() override;
 
+    //## @brief Returns the memory cost of both operations
+    virtual std::size_t GetMemoryCost() override;
+
+    //## @brief Releases the memory of both operations
+    virtual void ReleaseMemory() override;
+
     //## @brief returns true if the destination still is present
     //## and false if it already has been deleted
     virtual bool IsValid();
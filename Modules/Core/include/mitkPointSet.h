@@ -21,6 +21,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkDefaultDynamicMeshTraits.h>
 #include <itkMesh.h>
+#include <itkSimpleFastMutexLock.h>
+
+#include <memory>
 
 namespace mitk
 {
@@ -252,6 +255,10 @@ namespace mitk
      * \param distance is in mm.
      * returns -1 if no point is found
      * or the position in the list of the first match
+     *
+     * For large point sets the search uses a grid of the points of time step t,
+     * which is built on the first search and rebuilt after the point set was
+     * modified.
      */
     int SearchPoint(Point3D point, ScalarType distance, int t = 0) const;
 
@@ -283,6 +290,19 @@ namespace mitk
     /** \brief swaps point coordinates and point data of the points with identifiers id1 and id2 */
     bool SwapPointContents(PointIdentifier id1, PointIdentifier id2, int t = 0);
 
+    /**
+    * \brief Contiguous copy of the points of one time step, sorted by the cells
+    * of a uniform grid. Used by SearchPoint() for large point sets.
+    */
+    struct SearchIndex;
+
+    /**
+    * \brief Returns the search index of time step t, (re)builds it if the
+    * point set was modified or the cell size does not fit the search radius.
+    * m_SearchIndexMutex has to be locked.
+    */
+    const SearchIndex *GetSearchIndex(unsigned int t, ScalarType radius) const;
+
     typedef std::vector<DataType::Pointer> PointSetSeries;
 
     PointSetSeries m_PointSetSeries;
@@ -293,6 +313,10 @@ namespace mitk
     * @brief flag to indicate the right time to call SetBounds
     **/
     bool m_CalculateBoundingBox;
+
+    /** \brief search index per time step, built on demand */
+    mutable std::vector<std::unique_ptr<SearchIndex>> m_SearchIndices;
+    mutable itk::SimpleFastMutexLock m_SearchIndexMutex;
   };
 
   /**
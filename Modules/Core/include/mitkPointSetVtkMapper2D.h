@@ -114,7 +114,7 @@ namespace mitk
   *   - \b "opacity": (FloatProperty 1.0)                       // opacity of point set, contours
   *   - \b "label": (StringProperty NULL)     // a label can be defined for each point, which is rendered in proximity
   * to
-  * the point
+  * the point. Labels are only rendered for points inside the render window.
   *
   * @ingroup Mapper
   */
@@ -0,0 +1,117 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKPROGRESSIVEIMAGEMEMORY_H
+#define MITKPROGRESSIVEIMAGEMEMORY_H
+
+#include <mitkExternalImageMemory.h>
+
+#include <itkConditionVariable.h>
+#include <itkMultiThreader.h>
+#include <itkMutexLock.h>
+
+#include <string>
+
+namespace mitk
+{
+  /**
+   * \brief Image memory that is filled time step by time step by a background thread
+   *
+   * A loader thread inflates the zlib or gzip compressed pixel data of a file (several concatenated gzip members
+   * are supported) directly into the memory. Each time step becomes available as soon as it is inflated
+   * completely. After each time step an itk::ProgressEvent is invoked. Note that observers are called in the loader
+   * thread, so they have to be added before the loader thread is started by Start().
+   *
+   * Used by mitk::ItkImageIO for compressed time resolved images, so that the first time steps can be displayed
+   * while the rest of the file is still being read.
+   *
+   * @ingroup IO
+   */
+  class MITKCORE_EXPORT ProgressiveImageMemory : public ExternalImageMemory
+  {
+  public:
+    mitkClassMacro(ProgressiveImageMemory, ExternalImageMemory);
+
+    /**
+     * \brief Allocates the memory for the pixel data of a file, call Start() to load it.
+     *
+     * \param fileName the file holding the compressed data
+     * \param compressedOffset position of the compressed data in the file
+     * \param uncompressedOffset position of the pixel data in the inflated stream (e.g. the header size)
+     * \param size size of the pixel data in bytes
+     * \param numberOfTimeSteps number of equally sized time steps of the pixel data
+     * \throws mitk::Exception if the layout of the pixel data is invalid
+     */
+    mitkNewMacro5Param(Self, const std::string &, unsigned long long, unsigned long long, size_t, unsigned int);
+
+    /**
+     * \brief Starts the loader thread and returns when the first time step is available.
+     *
+     * Does nothing if loading has already been started.
+     * \throws mitk::Exception if the first time step cannot be read
+     */
+    void Start();
+
+    virtual void *GetData() const override { return m_Data; }
+    virtual size_t GetSize() const override { return m_Size; }
+    virtual bool IsAvailable(const void *begin, const void *end) const override;
+    virtual void WaitUntilAvailable(const void *begin, const void *end) const override;
+
+    unsigned int GetNumberOfTimeSteps() const { return m_NumberOfTimeSteps; }
+    unsigned int GetNumberOfLoadedTimeSteps() const;
+
+  protected:
+    ProgressiveImageMemory(const std::string &fileName,
+                           unsigned long long compressedOffset,
+                           unsigned long long uncompressedOffset,
+                           size_t size,
+                           unsigned int numberOfTimeSteps);
+    virtual ~ProgressiveImageMemory();
+
+  private:
+    static ITK_THREAD_RETURN_TYPE LoaderThread(void *pInfoStruct);
+
+    /** Inflates the file into m_Data, throws mitk::Exception on errors */
+    void Load();
+
+    /** Stops the loader thread and waits for it */
+    void StopLoading();
+
+    /** Returns the number of time steps needed to make [begin, end) available */
+    unsigned int GetRequiredTimeSteps(const void *begin, const void *end) const;
+
+    std::string m_FileName;
+    unsigned long long m_CompressedOffset;
+    unsigned long long m_UncompressedOffset;
+
+    unsigned char *m_Data;
+    size_t m_Size;
+    size_t m_TimeStepSize;
+    unsigned int m_NumberOfTimeSteps;
+
+    mutable itk::SimpleMutexLock m_Mutex;
+    itk::ConditionVariable::Pointer m_TimeStepLoaded;
+    unsigned int m_NumberOfLoadedTimeSteps;
+    bool m_Failed;
+    bool m_Abort;
+    std::string m_ErrorMessage;
+
+    itk::MultiThreader::Pointer m_MultiThreader;
+    int m_ThreadID;
+  };
+}
+
+#endif
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <map>
 #include <mitkIPropertyAliases.h>
+#include <set>
 
 namespace mitk
 {
@@ -40,11 +41,16 @@ namespace mitk
     typedef std::map<std::string, std::vector<std::string>> AliasesMap;
     typedef AliasesMap::const_iterator AliasesMapConstIterator;
     typedef AliasesMap::iterator AliasesMapIterator;
+    /** Reverse lookup of m_Aliases: property names by alias */
+    typedef std::map<std::string, std::set<std::string>> PropertyNamesMap;
+
+    void RemovePropertyName(const std::string &alias, const std::string &propertyName, const std::string &className);
 
     PropertyAliases(const PropertyAliases &);
     PropertyAliases &operator=(const PropertyAliases &);
 
     std::map<std::string, AliasesMap> m_Aliases;
+    std::map<std::string, PropertyNamesMap> m_PropertyNames;
   };
 }
 
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <map>
 #include <mitkIPropertyDescriptions.h>
+#include <regex>
 
 namespace mitk
 {
@@ -48,11 +49,19 @@ namespace mitk
     typedef DescriptionMap::const_iterator DescriptionMapConstIterator;
     typedef DescriptionMap::iterator DescriptionMapIterator;
 
+    /** Description of a property regex together with the compiled regex. */
+    struct RegExDescription
+    {
+      std::regex RegEx;
+      std::string Description;
+    };
+    typedef std::map<std::string, RegExDescription> RegExDescriptionMap;
+
     PropertyDescriptions(const PropertyDescriptions &);
     PropertyDescriptions &operator=(const PropertyDescriptions &);
 
     std::map<std::string, DescriptionMap> m_Descriptions;
-    std::map<std::string, DescriptionMap> m_DescriptionsRegEx;
+    std::map<std::string, RegExDescriptionMap> m_DescriptionsRegEx;
   };
 }
 
@@ -0,0 +1,93 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkPropertyHandle_h
+#define mitkPropertyHandle_h
+
+#include "mitkPropertyKeys.h"
+#include <MitkCoreExports.h>
+
+namespace mitk
+{
+  class BaseProperty;
+  class BaseRenderer;
+  class DataNode;
+
+  /**
+   * \brief Cached lookup of a property of a DataNode.
+   *
+   * A handle is meant to be kept by code that asks for the same property many times, e.g. a mapper that needs
+   * "visible", "color" and "opacity" of its node in every frame for every render window:
+   *
+   * \code
+   * mitk::PropertyHandle m_VisibleHandle("visible");
+   * ...
+   * bool visible = true;
+   * node->GetBoolProperty(m_VisibleHandle, visible, renderer);
+   * \endcode
+   *
+   * The handle remembers the resolved property (renderer specific or renderer independent) for the last few
+   * node/renderer combinations. Renderers are identified by their name, like the renderer specific property lists
+   * of DataNode, so a renderer that is destroyed and replaced by another one cannot hit a wrong cache entry.
+   * The cached results stay valid until a property is added to, replaced in or deleted from one of the PropertyLists
+   * the handle looked at, or until such a list or its node is destroyed, see PropertyList::GetStructureVersion().
+   * As long as nothing like that happened, a lookup costs an integer comparison and a short scan of the cache instead
+   * of two string map lookups. Changing the value of a property does not invalidate the handle since the property
+   * object stays the same.
+   *
+   * A handle must not be used by several threads at the same time.
+   *
+   * \sa DataNode::GetProperty(PropertyHandle &, const BaseRenderer *) const
+   * \ingroup DataManagement
+   */
+  class MITKCORE_EXPORT PropertyHandle
+  {
+  public:
+    explicit PropertyHandle(const std::string &propertyKey);
+
+    PropertyKeys::IdType GetKeyId() const { return m_KeyId; }
+    const std::string &GetKey() const { return *m_Key; }
+
+    /**
+     * \brief Drop all cached lookups.
+     */
+    void Reset();
+
+  private:
+    friend class DataNode;
+
+    /** enough for the four render windows of the standard display and the renderer independent lookup */
+    static const unsigned int NumberOfSlots = 8;
+
+    struct Slot
+    {
+      const DataNode *Node;
+      /** name of the renderer, empty for the renderer independent lookup */
+      std::string RendererName;
+      BaseProperty *Property;
+    };
+
+    PropertyKeys::IdType m_KeyId;
+    const std::string *m_Key;
+
+    unsigned long m_StructureVersion;
+    unsigned int m_NumberOfUsedSlots;
+    unsigned int m_NextSlot;
+    Slot m_Slots[NumberOfSlots];
+  };
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkPropertyKeys_h
+#define mitkPropertyKeys_h
+
+#include <MitkCoreExports.h>
+
+#include <string>
+
+namespace mitk
+{
+  /**
+   * \brief Process wide table of interned property keys.
+   *
+   * Every key that is added to the table gets a unique integer id. Ids are never reused and the key string of an
+   * id stays valid (at the same address) until the process ends, so code that resolves the same property over and
+   * over again (see PropertyHandle) can keep the id instead of a string and look the property up without creating
+   * temporary strings.
+   *
+   * All methods are thread-safe.
+   *
+   * \ingroup DataManagement
+   */
+  class MITKCORE_EXPORT PropertyKeys
+  {
+  public:
+    typedef unsigned int IdType;
+
+    /**
+     * \brief Get the id of a property key, the key is added to the table if it is not interned yet.
+     */
+    static IdType GetId(const std::string &propertyKey);
+
+    /**
+     * \brief Get the property key of an id.
+     *
+     * \throws mitk::Exception if the id was not returned by GetId.
+     */
+    static const std::string &GetKey(IdType id);
+
+    /**
+     * \brief Get the number of interned property keys.
+     */
+    static IdType GetNumberOfKeys();
+
+  private:
+    PropertyKeys();
+  };
+}
+
+#endif
@@ -24,6 +24,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkObjectFactory.h>
 
+#include <atomic>
 #include <map>
 #include <string>
 
@@ -233,6 +234,30 @@ namespace mitk
     bool IsEmpty() const { return m_Properties.empty(); }
     virtual void Clear();
 
+    /**
+     * @brief Get a counter that is incremented whenever a property list that was used by a cached lookup
+     * (see UseForCachedLookups()) is cleared or destroyed or gets a property added, replaced or deleted.
+     *
+     * Changing the value of a property (SetProperty with an existing key) does not increment the counter, neither do
+     * changes of lists that no cached lookup has seen so far.
+     * Used by PropertyHandle to find out if cached lookups are still valid.
+     */
+    static unsigned long GetStructureVersion();
+
+    /**
+     * @brief Mark the list as used by a cached lookup. From now on, changes of its structure increment the
+     * structure version.
+     */
+    void UseForCachedLookups() const;
+
+    /**
+     * @brief Increment the structure version if the list was used by a cached lookup.
+     *
+     * Subclasses that modify m_Properties directly have to call it. Owners of lists call it if something the
+     * cached lookups of the list depend on changes, e.g. DataNode gets a new renderer specific list.
+     */
+    void StructureModified();
+
   protected:
     PropertyList();
     PropertyList(const PropertyList &other);
@@ -245,6 +270,9 @@ namespace mitk
     PropertyMap m_Properties;
 
   private:
+    /** set by UseForCachedLookups(), read and written by render threads */
+    mutable std::atomic<bool> m_UsedForCachedLookups;
+
     virtual itk::LightObject::Pointer InternalClone() const override;
   };
 
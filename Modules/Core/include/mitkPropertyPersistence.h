@@ -45,14 +45,23 @@ namespace mitk
   private:
     typedef std::multimap<const std::string, PropertyPersistenceInfo::ConstPointer> InfoMap;
 
-    /**Helper function that selects */
-    using SelectFunctionType = std::function<bool(const InfoMap::value_type &)>;
-    static InfoMap SelectInfo(const InfoMap &infoMap, const SelectFunctionType &selectFunction);
+    /**Helper function that selects all infos for a property name and mime type.*/
+    InfoMap SelectInfo(const std::string &propertyName, const MimeTypeNameType &mime, bool allowNameRegEx) const;
+
+    /**Helper functions that keep the key index and the regex index in sync with m_InfoMap.*/
+    void AddToIndex(const PropertyPersistenceInfo *info);
+    void RemoveFromIndex(const PropertyPersistenceInfo *info);
 
     PropertyPersistence(const PropertyPersistence &);
     PropertyPersistence &operator=(const PropertyPersistence &);
 
+    /**All infos by name. AddInfo stores a copy of the passed info, so changes of the passed
+     * info after adding it cannot make the indexes below stale.*/
     InfoMap m_InfoMap;
+    /**Infos without regex by key.*/
+    InfoMap m_KeyMap;
+    /**Infos with regex by name regex.*/
+    InfoMap m_RegExInfoMap;
   };
 
   /**Creates an unmanaged (!) instance of PropertyPersistence for testing purposes.*/
@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define mitkPropertyPersistenceInfo_h
 
 #include <functional>
+#include <regex>
 
 #include <mitkBaseProperty.h>
 #include <mitkCommon.h>
@@ -65,6 +66,11 @@ namespace mitk
     const std::string &GetKeyTemplate() const;
     const std::string &GetNameTemplate() const;
 
+    /** Compiled regular expressions of the name and the key, they are compiled once in UseRegEx.
+    * @pre IsRegEx() must be true.*/
+    const std::regex &GetNameRegEx() const;
+    const std::regex &GetKeyRegEx() const;
+
     const MimeTypeNameType &GetMimeTypeName() const;
     void SetMimeTypeName(const MimeTypeNameType &mimeTypeName);
 
@@ -99,6 +105,8 @@ namespace mitk
 
     virtual void PrintSelf(std::ostream &os, itk::Indent indent) const override;
 
+    itk::LightObject::Pointer InternalClone() const override;
+
   private:
     PropertyPersistenceInfo(const Self &other);
     Self &operator=(const Self &other);
@@ -22,7 +22,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkCallbackCommand.h>
 
 #include <itkObject.h>
+#include <itkMutexLock.h>
 #include <itkObjectFactory.h>
+#include <set>
 #include <string>
 
 #include "mitkProperties.h"
@@ -127,6 +129,19 @@ namespace mitk
    * soon as the main loop is ready for rendering. */
     void RequestUpdate(vtkRenderWindow *renderWindow);
 
+    /** Requests an update for the specified RenderWindow from a thread other
+     * than the one running the main loop, e.g. when a background computation
+     * has finished. The request is merged into the pending requests by the next
+     * #ExecutePendingRequests. Requires a thread-safe implementation of
+     * GenerateRenderingRequestEvent() (the Qt based RenderingManagers post an event). */
+    void RequestUpdateFromBackgroundThread(vtkRenderWindow *renderWindow);
+
+    /** Requests all RenderWindows registered at the time of the next
+     * #ExecutePendingRequests to be updated, from a thread other than the one
+     * running the main loop (e.g. when image data loaded in the background
+     * became available). See #RequestUpdateFromBackgroundThread. */
+    void RequestUpdateAllFromBackgroundThread(RequestType type = REQUEST_UPDATE_ALL);
+
     /** Immediately executes an update of the specified RenderWindow. */
     void ForceImmediateUpdate(vtkRenderWindow *renderWindow);
 
@@ -335,6 +350,12 @@ namespace mitk
 
     typedef std::map<vtkRenderWindow *, int> RenderWindowList;
 
+    /** Render windows requested by #RequestUpdateFromBackgroundThread, guarded by m_BackgroundRequestsLock */
+    std::set<vtkRenderWindow *> m_BackgroundRequests;
+    /** Request types of #RequestUpdateAllFromBackgroundThread, guarded by m_BackgroundRequestsLock */
+    std::set<RequestType> m_BackgroundRequestTypes;
+    itk::SimpleMutexLock m_BackgroundRequestsLock;
+
     RenderWindowList m_RenderWindowList;
     RenderWindowVector m_AllRenderWindows;
 
@@ -166,6 +166,11 @@ namespace mitk
     /** virtual destructor in order to derive from this class */
     virtual ~VtkMapper();
 
+    /** \brief Cached lookups of the properties that are read for every frame in every render window */
+    PropertyHandle m_VisibleHandle;
+    PropertyHandle m_ColorHandle;
+    PropertyHandle m_OpacityHandle;
+
   private:
     /** copy constructor */
     VtkMapper(const VtkMapper &);
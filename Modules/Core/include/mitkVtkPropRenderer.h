@@ -25,6 +25,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <map>
 #include <utility>
+#include <vector>
 
 class vtkRenderWindow;
 class vtkLight;
@@ -53,6 +54,11 @@ namespace mitk
   It redirects render() calls to the VtkPropRenderer, which is responsible for rendering of the datatreenodes.
   VtkPropRenderer replaces the old OpenGLRenderer.
 
+  The renderer keeps a render queue of the nodes of its DataStorage that are visible in this renderer, sorted by
+  their "layer" property. The queue is maintained from the add and remove events of the DataStorage and from
+  observers of the "visible" and "layer" properties of the nodes, so the mappers of hidden nodes cost nothing per
+  frame. The bounds of the nodes are cached per node (see ComputeVisibleBoundingBox()).
+
   \sa rendering
   \ingroup rendering
   */
@@ -190,6 +196,17 @@ namespace mitk
 
     MappersMapType GetMappersMap() const;
 
+    /**
+    * \brief Compute the bounding box of the data of all nodes of the DataStorage that are visible in \a renderer
+    * and for which the bool property \a boolPropertyKey is not false.
+    *
+    * Same result as DataStorage::ComputeVisibleBoundingBox(renderer, boolPropertyKey), the properties are looked up
+    * for \a renderer (NULL for the renderer independent ones). The bounds of a node are computed again only if its
+    * data or its geometry was modified. If \a renderer is this renderer, only the nodes of the render queue are
+    * visited.
+    */
+    BoundingBox::Pointer ComputeVisibleBoundingBox(const BaseRenderer *renderer, const char *boolPropertyKey = nullptr);
+
     static bool useImmediateModeRendering();
 
   protected:
@@ -212,6 +229,48 @@ namespace mitk
     // prepare all mitk::mappers for rendering
     void PrepareMapperQueue();
 
+    /** \brief A node of the DataStorage as seen by this renderer */
+    struct RenderQueueEntry
+    {
+      DataNode *Node;
+      /** order in which the nodes were added, keeps the order of nodes within one layer stable */
+      unsigned long Order;
+      bool Visible;
+      int Layer;
+
+      /** observed properties, held to be able to remove the observers if the node replaces them */
+      BaseProperty::Pointer VisibleProperty;
+      unsigned long VisibleObserverTag;
+      BaseProperty::Pointer LayerProperty;
+      unsigned long LayerObserverTag;
+
+      /** world bounds of the data, valid as long as the data of the node, its time geometry and their modification
+       * times match */
+      const BaseData *BoundsData;
+      unsigned long BoundsTime;
+      const TimeGeometry *BoundsGeometry;
+      unsigned long BoundsGeometryTime;
+      bool HasBounds;
+      Point3D BoundsMinimum;
+      Point3D BoundsMaximum;
+    };
+
+    typedef std::map<const DataNode *, RenderQueueEntry> RenderQueueEntryMap;
+
+    void AddRenderQueueEntry(const DataNode *node);
+    void RemoveRenderQueueEntries();
+    void RemoveRenderQueueObservers(RenderQueueEntry &entry);
+    void ResolveRenderQueueProperties(RenderQueueEntry &entry);
+    void UpdateRenderQueueBounds(RenderQueueEntry &entry);
+
+    /** \brief Sort the visible nodes into the render queue if a node or one of the observed properties changed.
+     * \return true if the render queue was modified */
+    bool UpdateRenderQueue();
+
+    void OnNodeAdded(const DataNode *node);
+    void OnNodeRemoved(const DataNode *node);
+    void OnRenderQueuePropertyModified();
+
     /** \brief Set parallel projection, remove the interactor and the lights of VTK. */
     bool Initialize2DvtkCamera();
 
@@ -234,6 +293,20 @@ namespace mitk
     // sorted list of mappers
     MappersMapType m_MappersMap;
 
+    // all nodes of the DataStorage
+    RenderQueueEntryMap m_RenderQueueEntries;
+    // visible nodes, sorted by layer
+    std::vector<RenderQueueEntry *> m_RenderQueue;
+    // nodes that were hidden since the last update, their mappers have to be updated once more to hide their props
+    std::vector<DataNode *> m_HiddenNodes;
+    bool m_RenderQueueModified;
+    unsigned long m_RenderQueueStructureVersion;
+    // used to look up "visible" and "layer", so that their lists report structure changes (see PropertyHandle)
+    PropertyHandle m_RenderQueueVisibleHandle;
+    PropertyHandle m_RenderQueueLayerHandle;
+    unsigned long m_NextRenderQueueOrder;
+    itk::SimpleMemberCommand<VtkPropRenderer>::Pointer m_RenderQueuePropertyCommand;
+
     // rendering of text
     vtkRenderer *m_TextRenderer;
     typedef std::map<unsigned int, vtkTextActor *> TextMapType;
@@ -15,11 +15,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkLimitedLinearUndo.h"
+#include <mitkLogMacros.h>
 #include <mitkRenderingManager.h>
 
-mitk::LimitedLinearUndo::LimitedLinearUndo()
+#include <itkTimeProbe.h>
+
+#include <algorithm>
+
+mitk::LimitedLinearUndo::LimitedLinearUndo() : m_MemoryBudget(512 * 1024 * 1024), m_LastExecutionTime(0.0)
 {
-  // nothing to do
 }
 
 mitk::LimitedLinearUndo::~LimitedLinearUndo()
@@ -56,6 +60,8 @@ bool mitk::LimitedLinearUndo::SetOperationEvent(UndoStackItem *stackItem)
 
   InvokeEvent(UndoNotEmptyEvent());
 
+  this->EnforceMemoryBudget();
+
   return true;
 }
 
@@ -89,6 +95,9 @@ bool mitk::LimitedLinearUndo::Undo(int oeid)
   if (m_UndoList.empty())
     return false;
 
+  itk::TimeProbe probe;
+  probe.Start();
+
   bool rc = true;
   do
   {
@@ -106,6 +115,11 @@ bool mitk::LimitedLinearUndo::Undo(int oeid)
     }
   } while (m_UndoList.back()->GetObjectEventId() >= oeid);
 
+  probe.Stop();
+  m_LastExecutionTime = probe.GetTotal() * 1000.0;
+  MITK_DEBUG << "Undo took " << m_LastExecutionTime << " ms";
+  this->EnforceMemoryBudget();
+
   // Update. Check Rendering Mechanism where to request updates
   mitk::RenderingManager::GetInstance()->RequestUpdateAll();
   return rc;
@@ -130,6 +144,9 @@ bool mitk::LimitedLinearUndo::Redo(int oeid)
   if (m_RedoList.empty())
     return false;
 
+  itk::TimeProbe probe;
+  probe.Start();
+
   do
   {
     m_RedoList.back()->ReverseAndExecute();
@@ -145,6 +162,11 @@ bool mitk::LimitedLinearUndo::Redo(int oeid)
     }
   } while (m_RedoList.back()->GetObjectEventId() <= oeid);
 
+  probe.Stop();
+  m_LastExecutionTime = probe.GetTotal() * 1000.0;
+  MITK_DEBUG << "Redo took " << m_LastExecutionTime << " ms";
+  this->EnforceMemoryBudget();
+
   // Update. This should belong into the ExecuteOperation() of OperationActors, but it seems not to be used everywhere
   mitk::RenderingManager::GetInstance()->RequestUpdateAll();
   return true;
@@ -197,6 +219,71 @@ mitk::OperationEvent *mitk::LimitedLinearUndo::GetLastOfType(OperationActor *des
   return nullptr;
 }
 
+void mitk::LimitedLinearUndo::SetMemoryBudget(std::size_t bytes)
+{
+  m_MemoryBudget = bytes;
+  this->EnforceMemoryBudget();
+}
+
+std::size_t mitk::LimitedLinearUndo::GetMemoryBudget() const
+{
+  return m_MemoryBudget;
+}
+
+std::size_t mitk::LimitedLinearUndo::GetMemoryCost()
+{
+  std::size_t cost = 0;
+  for (auto item : m_UndoList)
+    cost += item->GetMemoryCost();
+  for (auto item : m_RedoList)
+    cost += item->GetMemoryCost();
+  return cost;
+}
+
+double mitk::LimitedLinearUndo::GetLastExecutionTime() const
+{
+  return m_LastExecutionTime;
+}
+
+void mitk::LimitedLinearUndo::EnforceMemoryBudget()
+{
+  if (m_MemoryBudget == 0)
+    return;
+
+  std::size_t cost = this->GetMemoryCost();
+  if (cost <= m_MemoryBudget)
+    return;
+
+  const std::size_t costBefore = cost;
+
+  // the fronts of both stacks are farthest away from the current state, release them first
+  std::size_t undoIndex = 0;
+  std::size_t redoIndex = 0;
+  while (cost > m_MemoryBudget && (undoIndex < m_UndoList.size() || redoIndex < m_RedoList.size()))
+  {
+    UndoStackItem *item = nullptr;
+    if (redoIndex == m_RedoList.size() ||
+        (undoIndex < m_UndoList.size() && m_UndoList.size() - undoIndex >= m_RedoList.size() - redoIndex))
+    {
+      item = m_UndoList[undoIndex++];
+    }
+    else
+    {
+      item = m_RedoList[redoIndex++];
+    }
+
+    const std::size_t itemCost = item->GetMemoryCost();
+    if (itemCost == 0)
+      continue;
+
+    item->ReleaseMemory();
+    cost -= itemCost - std::min(itemCost, item->GetMemoryCost());
+  }
+
+  MITK_DEBUG << "Undo stack memory reduced from " << costBefore << " to " << cost << " bytes (budget "
+             << m_MemoryBudget << " bytes)";
+}
+
 int mitk::LimitedLinearUndo::FirstObjectEventIdOfCurrentGroup(mitk::LimitedLinearUndo::UndoContainer &stack)
 {
   int currentGroupEventId = stack.back()->GetGroupEventId();
@@ -76,6 +76,15 @@ void mitk::UndoStackItem::ReverseAndExecute()
   ReverseOperations();
 }
 
+std::size_t mitk::UndoStackItem::GetMemoryCost()
+{
+  return 0;
+}
+
+void mitk::UndoStackItem::ReleaseMemory()
+{
+}
+
 // ******************** mitk::OperationEvent ********************
 
 mitk::Operation *mitk::OperationEvent::GetOperation()
@@ -152,3 +161,21 @@ bool mitk::OperationEvent::IsValid()
 {
   return !m_Invalid;
 }
+
+std::size_t mitk::OperationEvent::GetMemoryCost()
+{
+  std::size_t cost = 0;
+  if (m_Operation)
+    cost += m_Operation->GetMemoryCost();
+  if (m_UndoOperation)
+    cost += m_UndoOperation->GetMemoryCost();
+  return cost;
+}
+
+void mitk::OperationEvent::ReleaseMemory()
+{
+  if (m_Operation)
+    m_Operation->ReleaseMemory();
+  if (m_UndoOperation)
+    m_UndoOperation->ReleaseMemory();
+}
@@ -27,6 +27,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkNumericTypes.h"
 #include <itkAffineGeometryFrame.h>
 #include <itkCommand.h>
+#include <itkMutexLockHolder.h>
 #include <itkScalableAffineTransform.h>
 #include <mitkVtkPropRenderer.h>
 
@@ -213,6 +214,27 @@ namespace mitk
     }
   }
 
+  void RenderingManager::RequestUpdateFromBackgroundThread(vtkRenderWindow *renderWindow)
+  {
+    {
+      itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_BackgroundRequestsLock);
+      m_BackgroundRequests.insert(renderWindow);
+    }
+
+    // m_UpdatePending belongs to the main loop, an additional request event is harmless
+    this->GenerateRenderingRequestEvent();
+  }
+
+  void RenderingManager::RequestUpdateAllFromBackgroundThread(RequestType type)
+  {
+    {
+      itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_BackgroundRequestsLock);
+      m_BackgroundRequestTypes.insert(type);
+    }
+
+    this->GenerateRenderingRequestEvent();
+  }
+
   void RenderingManager::ForceImmediateUpdate(vtkRenderWindow *renderWindow)
   {
     // If the renderWindow is not valid, we do not want to inadvertantly create
@@ -522,6 +544,26 @@ namespace mitk
   {
     m_UpdatePending = false;
 
+    std::set<vtkRenderWindow *> backgroundRequests;
+    std::set<RequestType> backgroundRequestTypes;
+    {
+      itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_BackgroundRequestsLock);
+      backgroundRequests.swap(m_BackgroundRequests);
+      backgroundRequestTypes.swap(m_BackgroundRequestTypes);
+    }
+    for (auto type : backgroundRequestTypes)
+    {
+      this->RequestUpdateAll(type);
+    }
+    for (auto renderWindow : backgroundRequests)
+    {
+      // windows that were removed meanwhile are ignored like in RequestUpdate()
+      if (m_RenderWindowList.find(renderWindow) != m_RenderWindowList.cend())
+      {
+        m_RenderWindowList[renderWindow] = RENDERING_REQUESTED;
+      }
+    }
+
     // Satisfy all pending update requests
     RenderWindowList::const_iterator it;
     int i = 0;
@@ -96,8 +96,12 @@ mitk::DataNode::DataNode() : m_PropertyListModifiedObserverTag(0)
 
 mitk::DataNode::~DataNode()
 {
+  // cached lookups refer to the node by its address, the lists might survive the node
   if (m_PropertyList.IsNotNull())
+  {
     m_PropertyList->RemoveObserver(m_PropertyListModifiedObserverTag);
+    m_PropertyList->StructureModified();
+  }
 
   m_Mappers.clear();
   m_Data = nullptr;
@@ -208,7 +212,11 @@ mitk::PropertyList *mitk::DataNode::GetPropertyList(const std::string &rendererN
   mitk::PropertyList::Pointer &propertyList = m_MapOfPropertyLists[rendererName];
 
   if (propertyList.IsNull())
+  {
     propertyList = mitk::PropertyList::New();
+    // cached lookups of this node and renderer fell back to the renderer independent list so far
+    m_PropertyList->StructureModified();
+  }
 
   assert(m_MapOfPropertyLists[rendererName].IsNotNull());
 
@@ -225,39 +233,72 @@ mitk::BaseProperty *mitk::DataNode::GetProperty(const char *propertyKey, const m
   if (propertyKey == NULL)
     return NULL;
 
+  return this->LookupProperty(propertyKey, renderer);
+}
+
+mitk::BaseProperty *mitk::DataNode::GetProperty(PropertyHandle &handle, const mitk::BaseRenderer *renderer) const
+{
+  const unsigned long structureVersion = PropertyList::GetStructureVersion();
+
+  // renderer specific lists are found by the renderer name, so the cache uses it as well
+  const char *rendererName = renderer != nullptr ? renderer->GetName() : "";
+
+  if (handle.m_StructureVersion != structureVersion)
+  {
+    // a property list the handle looked at was destroyed or changed its keys since the handle was used the last time
+    handle.Reset();
+    handle.m_StructureVersion = structureVersion;
+  }
+  else
+  {
+    for (unsigned int i = 0; i < handle.m_NumberOfUsedSlots; ++i)
+    {
+      const PropertyHandle::Slot &slot = handle.m_Slots[i];
+      if (slot.Node == this && slot.RendererName == rendererName)
+        return slot.Property;
+    }
+  }
+
+  mitk::BaseProperty *property = this->LookupProperty(handle.GetKey(), renderer, true);
+
+  PropertyHandle::Slot &slot = handle.m_Slots[handle.m_NextSlot];
+  slot.Node = this;
+  slot.RendererName = rendererName;
+  slot.Property = property;
+
+  handle.m_NextSlot = (handle.m_NextSlot + 1) % PropertyHandle::NumberOfSlots;
+  if (handle.m_NumberOfUsedSlots < PropertyHandle::NumberOfSlots)
+    ++handle.m_NumberOfUsedSlots;
+
+  return property;
+}
+
+mitk::BaseProperty *mitk::DataNode::LookupProperty(const std::string &propertyKey,
+                                                   const mitk::BaseRenderer *renderer,
+                                                   bool cached) const
+{
+  // cached lookups must learn about structure changes of every list they looked at
+  if (cached)
+    m_PropertyList->UseForCachedLookups();
+
   // renderer specified?
   if (renderer)
   {
-    std::string rendererName = renderer->GetName();
-
-    MapOfPropertyLists::const_iterator it;
     // check for the renderer specific property
-    it = m_MapOfPropertyLists.find(rendererName);
+    auto it = m_MapOfPropertyLists.find(renderer->GetName());
     if (it != m_MapOfPropertyLists.end()) // found
     {
-      mitk::BaseProperty::Pointer property;
-      property = it->second->GetProperty(propertyKey);
-      if (property.IsNotNull()) // found an enabled property in the render specific list
+      if (cached)
+        it->second->UseForCachedLookups();
+
+      mitk::BaseProperty *property = it->second->GetProperty(propertyKey);
+      if (property != nullptr) // found an enabled property in the render specific list
         return property;
-      else                                               // found a renderer specific list, but not the desired property
-        return m_PropertyList->GetProperty(propertyKey); // return renderer unspecific property
     }
-    else // didn't find the property list of the given renderer
-    {
-      // return the renderer unspecific property if there is one
-      return m_PropertyList->GetProperty(propertyKey);
-    }
-  }
-  else // no specific renderer given; use the renderer independent one
-  {
-    mitk::BaseProperty::Pointer property;
-    property = m_PropertyList->GetProperty(propertyKey);
-    if (property.IsNotNull())
-      return property;
   }
 
-  // only to satisfy compiler!
-  return NULL;
+  // no specific renderer given or the property is not renderer specific; use the renderer independent one
+  return m_PropertyList->GetProperty(propertyKey);
 }
 
 mitk::DataNode::GroupTagList mitk::DataNode::GetGroupTags() const
@@ -290,6 +331,16 @@ bool mitk::DataNode::GetBoolProperty(const char *propertyKey, bool &boolValue, c
   return true;
 }
 
+bool mitk::DataNode::GetBoolProperty(PropertyHandle &handle, bool &boolValue, const mitk::BaseRenderer *renderer) const
+{
+  auto boolprop = dynamic_cast<mitk::BoolProperty *>(GetProperty(handle, renderer));
+  if (boolprop == nullptr)
+    return false;
+
+  boolValue = boolprop->GetValue();
+  return true;
+}
+
 bool mitk::DataNode::GetIntProperty(const char *propertyKey, int &intValue, const mitk::BaseRenderer *renderer) const
 {
   mitk::IntProperty::Pointer intprop = dynamic_cast<mitk::IntProperty *>(GetProperty(propertyKey, renderer));
@@ -300,6 +351,16 @@ bool mitk::DataNode::GetIntProperty(const char *propertyKey, int &intValue, cons
   return true;
 }
 
+bool mitk::DataNode::GetIntProperty(PropertyHandle &handle, int &intValue, const mitk::BaseRenderer *renderer) const
+{
+  auto intprop = dynamic_cast<mitk::IntProperty *>(GetProperty(handle, renderer));
+  if (intprop == nullptr)
+    return false;
+
+  intValue = intprop->GetValue();
+  return true;
+}
+
 bool mitk::DataNode::GetFloatProperty(const char *propertyKey,
                                       float &floatValue,
                                       const mitk::BaseRenderer *renderer) const
@@ -312,6 +373,18 @@ bool mitk::DataNode::GetFloatProperty(const char *propertyKey,
   return true;
 }
 
+bool mitk::DataNode::GetFloatProperty(PropertyHandle &handle,
+                                      float &floatValue,
+                                      const mitk::BaseRenderer *renderer) const
+{
+  auto floatprop = dynamic_cast<mitk::FloatProperty *>(GetProperty(handle, renderer));
+  if (floatprop == nullptr)
+    return false;
+
+  floatValue = floatprop->GetValue();
+  return true;
+}
+
 bool mitk::DataNode::GetDoubleProperty(const char *propertyKey,
                                        double &doubleValue,
                                        const mitk::BaseRenderer *renderer) const
@@ -360,6 +433,16 @@ bool mitk::DataNode::GetColor(float rgb[3], const mitk::BaseRenderer *renderer,
   return true;
 }
 
+bool mitk::DataNode::GetColor(float rgb[3], const mitk::BaseRenderer *renderer, PropertyHandle &handle) const
+{
+  auto colorprop = dynamic_cast<mitk::ColorProperty *>(GetProperty(handle, renderer));
+  if (colorprop == nullptr)
+    return false;
+
+  memcpy(rgb, colorprop->GetColor().GetDataPointer(), 3 * sizeof(float));
+  return true;
+}
+
 bool mitk::DataNode::GetOpacity(float &opacity, const mitk::BaseRenderer *renderer, const char *propertyKey) const
 {
   mitk::FloatProperty::Pointer opacityprop = dynamic_cast<mitk::FloatProperty *>(GetProperty(propertyKey, renderer));
@@ -370,6 +453,16 @@ bool mitk::DataNode::GetOpacity(float &opacity, const mitk::BaseRenderer *render
   return true;
 }
 
+bool mitk::DataNode::GetOpacity(float &opacity, const mitk::BaseRenderer *renderer, PropertyHandle &handle) const
+{
+  auto opacityprop = dynamic_cast<mitk::FloatProperty *>(GetProperty(handle, renderer));
+  if (opacityprop == nullptr)
+    return false;
+
+  opacity = opacityprop->GetValue();
+  return true;
+}
+
 bool mitk::DataNode::GetLevelWindow(mitk::LevelWindow &levelWindow,
                                     const mitk::BaseRenderer *renderer,
                                     const char *propertyKey) const
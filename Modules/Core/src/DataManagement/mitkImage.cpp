@@ -129,6 +129,8 @@ void *mitk::Image::GetData()
       GetSource()->UpdateOutputInformation();
   }
   m_CompleteData = GetChannelData();
+  // the pointer is used without an accessor, so data loaded in the background has to be complete
+  m_CompleteData->WaitUntilAvailable();
 
   // update channel's data
   // if data was not available at creation point, the m_Data of channel descriptor is NULL
@@ -799,6 +801,54 @@ bool mitk::Image::SetImportChannel(void *data, int n, ImportMemoryManagementType
   return true;
 }
 
+bool mitk::Image::SetImportChannel(ExternalImageMemory *memory, int n)
+{
+  if (memory == nullptr || IsValidChannel(n) == false)
+    return false;
+
+  const size_t ptypeSize = this->m_ImageDescriptor->GetChannelTypeById(n).GetSize();
+  if (memory->GetSize() < m_OffsetTable[4] * ptypeSize)
+  {
+    MITK_ERROR << "External memory of " << memory->GetSize() << " bytes is too small for channel " << n;
+    return false;
+  }
+
+  // an already allocated channel copies the data instead of referencing it, so it has to be complete
+  if (IsChannelSet(n))
+  {
+    const unsigned char *begin = static_cast<const unsigned char *>(memory->GetData());
+    memory->WaitUntilAvailable(begin, begin + memory->GetSize());
+  }
+
+  if (!SetImportChannel(memory->GetData(), n, ReferenceMemory))
+    return false;
+
+  MutexHolder lock(m_ImageDataArraysLock);
+  if (m_Channels[n]->m_Data == memory->GetData())
+  {
+    m_Channels[n]->SetExternalMemory(memory);
+  }
+  return true;
+}
+
+bool mitk::Image::IsTimeStepAvailable(int t, int n) const
+{
+  if (IsValidVolume(t, n) == false)
+    return false;
+
+  ImageDataItemPointer ch;
+  {
+    MutexHolder lock(m_ImageDataArraysLock);
+    ch = m_Channels[n];
+  }
+  if (ch.IsNull() || ch->GetExternalMemory() == nullptr)
+    return true;
+
+  const size_t volumeSize = m_OffsetTable[3] * this->m_ImageDescriptor->GetChannelTypeById(n).GetSize();
+  const unsigned char *begin = ch->m_Data + static_cast<size_t>(t) * volumeSize;
+  return ch->GetExternalMemory()->IsAvailable(begin, begin + volumeSize);
+}
+
 void mitk::Image::Initialize()
 {
   ImageDataItemPointerArray::iterator it, end;
@@ -40,11 +40,13 @@ bool mitk::ImageAccessorBase::CompareThreadHandles(mitk::ImageAccessorBase::Thre
 
 mitk::ImageAccessorBase::~ImageAccessorBase()
 {
+  delete m_SubRegion;
 }
 
 mitk::ImageAccessorBase::ImageAccessorBase(ImageConstPointer image,
                                            const ImageDataItem *imageDataItem,
-                                           int OptionFlags)
+                                           int OptionFlags,
+                                           const RegionType *subRegion)
   : // m_Image(iP)
     //, imageDataItem(iDI)
     m_SubRegion(nullptr),
@@ -74,6 +76,7 @@ mitk::ImageAccessorBase::ImageAccessorBase(ImageConstPointer image,
     {
       if (image->GetSource().IsNull())
       {
+        delete m_WaitLock;
         mitkThrow() << "ImageAccessor: No image source is defined";
       }
       image->m_ReadWriteLock.Lock();
@@ -87,67 +90,187 @@ mitk::ImageAccessorBase::ImageAccessorBase(ImageConstPointer image,
 
   // Investigate 4 cases of possible image parts/regions
 
-  // Case 1: No ImageDataItem and no Subregion => Whole Image is accessed
-  if (imageDataItem == nullptr && m_SubRegion == nullptr)
+  // Case 1 and 3: No ImageDataItem => the first image channel is accessed (entirely or in parts)
+  if (imageDataItem == nullptr)
   {
-    m_CoherentMemory = true;
-
-    // Organize first image channel
     image->m_ReadWriteLock.Lock();
     imageDataItem = image->GetChannelData();
     image->m_ReadWriteLock.Unlock();
-
-    // Set memory area
-    m_AddressBegin = imageDataItem->m_Data;
-    m_AddressEnd = (unsigned char *)m_AddressBegin + imageDataItem->m_Size;
   }
 
-  // Case 2: ImageDataItem but no Subregion
-  if (imageDataItem && m_SubRegion == nullptr)
+  // Case 1 and 2: No Subregion => the whole image part is accessed
+  if (subRegion == nullptr)
   {
     m_CoherentMemory = true;
 
     // Set memory area
     m_AddressBegin = imageDataItem->m_Data;
     m_AddressEnd = (unsigned char *)m_AddressBegin + imageDataItem->m_Size;
+    m_Intervals.push_back(MemoryIntervalType(static_cast<const unsigned char *>(m_AddressBegin),
+                                             static_cast<const unsigned char *>(m_AddressEnd)));
+  }
+  // Case 3 and 4: SubRegion of the image part
+  else
+  {
+    m_SubRegion = new RegionType(*subRegion);
+    try
+    {
+      ComputeSubRegionIntervals(imageDataItem);
+    }
+    catch (...)
+    {
+      delete m_SubRegion;
+      delete m_WaitLock;
+      throw;
+    }
   }
 
-  // Case 3: No ImageDataItem but a SubRegion
-  if (imageDataItem == nullptr && m_SubRegion)
+  // Memory that is filled in the background (see mitk::ExternalImageMemory) has to be loaded before it is accessed
+  const ExternalImageMemory *memory = imageDataItem->GetExternalMemory();
+  if (memory != nullptr && !memory->IsAvailable(m_AddressBegin, m_AddressEnd))
   {
-    mitkThrow() << "Invalid ImageAccessor: The use of a SubRegion is not supported (yet).";
+    try
+    {
+      if (m_Options & ExceptionIfLocked)
+      {
+        mitkThrowException(mitk::MemoryIsLockedException) << "The image part being ordered by the ImageAccessor is "
+                                                             "not loaded yet";
+      }
+      memory->WaitUntilAvailable(m_AddressBegin, m_AddressEnd);
+    }
+    catch (...)
+    {
+      delete m_SubRegion;
+      delete m_WaitLock;
+      throw;
+    }
   }
+}
 
-  // Case 4: ImageDataItem and SubRegion
-  if (imageDataItem == nullptr && m_SubRegion)
+void mitk::ImageAccessorBase::ComputeSubRegionIntervals(const ImageDataItem *imageDataItem)
+{
+  const RegionType::IndexType &index = m_SubRegion->GetIndex();
+  const RegionType::SizeType &size = m_SubRegion->GetSize();
+
+  // byte strides of the image part, missing dimensions have extent 1
+  unsigned long extent[4];
+  unsigned long stride[4];
+  stride[0] = imageDataItem->GetPixelType().GetSize();
+  for (unsigned int i = 0; i < 4; ++i)
   {
-    mitkThrow() << "Invalid ImageAccessor: The use of a SubRegion is not supported (yet).";
+    extent[i] = imageDataItem->GetDimension(i) > 0 ? imageDataItem->GetDimension(i) : 1;
+    if (i > 0)
+      stride[i] = stride[i - 1] * extent[i - 1];
+
+    if (index[i] < 0 || size[i] == 0 || static_cast<unsigned long>(index[i]) + size[i] > extent[i])
+    {
+      mitkThrow() << "Invalid ImageAccessor: SubRegion " << *m_SubRegion << " exceeds the accessed image part.";
+    }
+  }
+
+  // Leading dimensions that are covered completely collapse into one contiguous run
+  unsigned int runDimension = 0;
+  while (runDimension < 3 && index[runDimension] == 0 && size[runDimension] == extent[runDimension])
+  {
+    ++runDimension;
   }
+  const unsigned long runLength = size[runDimension] * stride[runDimension];
+
+  const unsigned char *data = imageDataItem->m_Data;
+  unsigned long counter[4] = {0, 0, 0, 0};
+  bool done = false;
+  while (!done)
+  {
+    unsigned long offset = index[runDimension] * stride[runDimension];
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+      if (i != runDimension)
+        offset += (index[i] + counter[i]) * stride[i];
+    }
+
+    const unsigned char *begin = data + offset;
+    if (!m_Intervals.empty() && m_Intervals.back().second == begin)
+      m_Intervals.back().second = begin + runLength;
+    else
+      m_Intervals.push_back(MemoryIntervalType(begin, begin + runLength));
+
+    // advance the counters of the dimensions above the run
+    done = true;
+    for (unsigned int i = runDimension + 1; i < 4; ++i)
+    {
+      if (++counter[i] < size[i])
+      {
+        done = false;
+        break;
+      }
+      counter[i] = 0;
+    }
+  }
+
+  m_CoherentMemory = (m_Intervals.size() == 1);
+  m_AddressBegin = const_cast<unsigned char *>(m_Intervals.front().first);
+  m_AddressEnd = const_cast<unsigned char *>(m_Intervals.back().second);
+}
+
+mitk::ImageAccessorBase::RegionType mitk::ImageAccessorBase::CreateSliceRegion(const Image *image,
+                                                                                unsigned int slice,
+                                                                                unsigned int timestep)
+{
+  return CreateSlabRegion(image, slice, 1, timestep);
+}
+
+mitk::ImageAccessorBase::RegionType mitk::ImageAccessorBase::CreateSlabRegion(const Image *image,
+                                                                               unsigned int firstSlice,
+                                                                               unsigned int numberOfSlices,
+                                                                               unsigned int timestep)
+{
+  RegionType::IndexType index;
+  index.Fill(0);
+  index[2] = firstSlice;
+  index[3] = timestep;
+
+  RegionType::SizeType size;
+  size[0] = image->GetDimension(0);
+  size[1] = image->GetDimension(1);
+  size[2] = numberOfSlices;
+  size[3] = 1;
+
+  return RegionType(index, size);
 }
 
 /** \brief Computes if there is an Overlap of the image part between this instantiation and another ImageAccessor object
- * \throws mitk::Exception if memory area is incoherent (not supported yet)
  */
 bool mitk::ImageAccessorBase::Overlap(const ImageAccessorBase *iAB)
 {
-  if (m_CoherentMemory)
+  // Quick rejection based on the enclosing address ranges
+  if (iAB->m_AddressBegin >= m_AddressEnd || m_AddressBegin >= iAB->m_AddressEnd)
+  {
+    return false;
+  }
+
+  if (m_CoherentMemory && iAB->m_CoherentMemory)
+  {
+    return true;
+  }
+
+  // Both interval lists are sorted, intersect them in one sweep
+  auto mine = m_Intervals.begin();
+  auto other = iAB->m_Intervals.begin();
+  while (mine != m_Intervals.end() && other != iAB->m_Intervals.end())
   {
-    if ((iAB->m_AddressBegin >= m_AddressBegin && iAB->m_AddressBegin < m_AddressEnd) ||
-        (iAB->m_AddressEnd > m_AddressBegin && iAB->m_AddressEnd <= m_AddressEnd))
+    if (mine->second <= other->first)
     {
-      return true;
+      ++mine;
+    }
+    else if (other->second <= mine->first)
+    {
+      ++other;
     }
-    if ((m_AddressBegin >= iAB->m_AddressBegin && m_AddressBegin < iAB->m_AddressEnd) ||
-        (m_AddressEnd > iAB->m_AddressBegin && m_AddressEnd <= iAB->m_AddressEnd))
+    else
     {
       return true;
     }
   }
-  else
-  {
-    GetImage()->m_ReadWriteLock.Unlock();
-    mitkThrow() << "ImageAccessor: incoherent memory area is not supported yet";
-  }
 
   return false;
 }
@@ -183,11 +183,32 @@ mitk::ImageDataItem::ImageDataItem(const ImageDataItem &other)
     m_Dimension(other.m_Dimension),
     m_Timestep(other.m_Timestep)
 {
+  m_ExternalMemory = other.m_ExternalMemory;
+
   // copy m_Data ??
   for (int i = 0; i < MAX_IMAGE_DIMENSIONS; ++i)
     m_Dimensions[i] = other.m_Dimensions[i];
 }
 
+const mitk::ExternalImageMemory *mitk::ImageDataItem::GetExternalMemory() const
+{
+  const ImageDataItem *item = this;
+  while (item->m_Parent.IsNotNull())
+  {
+    item = item->m_Parent.GetPointer();
+  }
+  return item->m_ExternalMemory.GetPointer();
+}
+
+void mitk::ImageDataItem::WaitUntilAvailable() const
+{
+  const ExternalImageMemory *memory = this->GetExternalMemory();
+  if (memory != nullptr)
+  {
+    memory->WaitUntilAvailable(m_Data, m_Data + m_Size);
+  }
+}
+
 itk::LightObject::Pointer mitk::ImageDataItem::InternalClone() const
 {
   Self::Pointer newGeometry = new Self(*this);
@@ -313,6 +334,8 @@ void mitk::ImageDataItem::Modified() const
 
 mitk::ImageVtkReadAccessor *mitk::ImageDataItem::GetVtkImageAccessor(mitk::ImageDataItem::ImageConstPointer iP) const
 {
+  // the vtkImageData is used long after the accessor was created, e.g. by the 3D mappers
+  WaitUntilAvailable();
   if (m_VtkImageData == nullptr)
   {
     ConstructVtkImageData(iP);
@@ -326,6 +349,7 @@ mitk::ImageVtkReadAccessor *mitk::ImageDataItem::GetVtkImageAccessor(mitk::Image
 
 mitk::ImageVtkWriteAccessor *mitk::ImageDataItem::GetVtkImageAccessor(ImagePointer iP)
 {
+  WaitUntilAvailable();
   if (m_VtkImageData == nullptr)
   {
     ConstructVtkImageData(iP.GetPointer());
@@ -58,6 +58,26 @@ mitk::ImageReadAccessor::ImageReadAccessor(const mitk::Image *image, const Image
   OrganizeReadAccess();
 }
 
+mitk::ImageReadAccessor::ImageReadAccessor(ImageConstPointer image,
+                                           const RegionType &region,
+                                           const mitk::ImageDataItem *iDI,
+                                           int OptionFlags)
+  : ImageAccessorBase(image, iDI, OptionFlags, &region), m_Image(image)
+{
+  if (!(OptionFlags & ImageAccessorBase::IgnoreLock))
+  {
+    try
+    {
+      OrganizeReadAccess();
+    }
+    catch (...)
+    {
+      delete m_WaitLock;
+      throw;
+    }
+  }
+}
+
 mitk::ImageReadAccessor::~ImageReadAccessor()
 {
   if (!(m_Options & ImageAccessorBase::IgnoreLock))
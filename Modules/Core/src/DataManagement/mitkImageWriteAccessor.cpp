@@ -23,6 +23,23 @@ mitk::ImageWriteAccessor::ImageWriteAccessor(ImagePointer image, const mitk::Ima
   OrganizeWriteAccess();
 }
 
+mitk::ImageWriteAccessor::ImageWriteAccessor(ImagePointer image,
+                                             const RegionType &region,
+                                             const mitk::ImageDataItem *iDI,
+                                             int OptionFlags)
+  : ImageAccessorBase(image.GetPointer(), iDI, OptionFlags, &region), m_Image(image)
+{
+  try
+  {
+    OrganizeWriteAccess();
+  }
+  catch (...)
+  {
+    delete m_WaitLock;
+    throw;
+  }
+}
+
 mitk::ImageWriteAccessor::~ImageWriteAccessor()
 {
   // In case of non-coherent memory, copied area needs to be written back
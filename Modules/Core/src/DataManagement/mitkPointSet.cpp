@@ -21,6 +21,48 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <iomanip>
 #include <mitkNumericTypes.h>
 
+#include <itkMutexLockHolder.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  // below this size a linear search is faster than building the grid
+  const int MINIMUM_NUMBER_OF_POINTS_FOR_SEARCH_INDEX = 1000;
+
+  // number of bits per dimension of a grid cell key
+  const int CELL_KEY_BITS = 21;
+  const long long MAXIMUM_CELL_INDEX = (1LL << CELL_KEY_BITS) - 1;
+
+  long long ComputeCellKey(long long x, long long y, long long z)
+  {
+    // x is the fastest running index, thus all cells of a row are contiguous
+    return (z << (2 * CELL_KEY_BITS)) | (y << CELL_KEY_BITS) | x;
+  }
+}
+
+struct mitk::PointSet::SearchIndex
+{
+  itk::ModifiedTimeType MTime;
+  std::size_t NumberOfPoints;
+  ScalarType CellSize;
+  ScalarType MinimumCellSize;
+  ScalarType Origin[3];
+  long long NumberOfCells[3];
+
+  // one entry per point, sorted by CellKeys
+  std::vector<long long> CellKeys;
+  std::vector<PointIdentifier> Ids;
+  std::vector<ScalarType> Coordinates[3];
+
+  long long GetCellIndex(ScalarType value, unsigned int dim) const
+  {
+    long long index = static_cast<long long>(std::floor((value - Origin[dim]) / CellSize));
+    return std::min(std::max(index, 0LL), NumberOfCells[dim] - 1);
+  }
+};
+
 mitk::PointSet::PointSet() : m_CalculateBoundingBox(true)
 {
   this->InitializeEmpty();
@@ -29,6 +71,7 @@ mitk::PointSet::PointSet() : m_CalculateBoundingBox(true)
 mitk::PointSet::PointSet(const PointSet &other)
   : BaseData(other), m_PointSetSeries(other.GetPointSetSeriesSize()), m_CalculateBoundingBox(true)
 {
+  // the search index is not copied, it is rebuilt on demand
   // Copy points
   for (std::size_t t = 0; t < m_PointSetSeries.size(); ++t)
   {
@@ -184,6 +227,103 @@ mitk::PointSet::PointsIterator mitk::PointSet::GetMaxId(int t)
   return this->Begin(t) == this->End(t) ? this->End(t) : --End(t);
 }
 
+const mitk::PointSet::SearchIndex *mitk::PointSet::GetSearchIndex(unsigned int t, ScalarType radius) const
+{
+  if (m_SearchIndices.size() < m_PointSetSeries.size())
+  {
+    m_SearchIndices.resize(m_PointSetSeries.size());
+  }
+
+  const DataType *itkPointSet = m_PointSetSeries[t];
+  const PointsContainer *points = itkPointSet->GetPoints();
+  itk::ModifiedTimeType mTime = std::max(this->GetMTime(), std::max(itkPointSet->GetMTime(), points->GetMTime()));
+
+  // the cells should be about as large as the search radius, thus a search
+  // visits at most 3x3x3 cells
+  std::unique_ptr<SearchIndex> &index = m_SearchIndices[t];
+  if (index && index->MTime == mTime && index->NumberOfPoints == points->Size() && radius <= index->CellSize &&
+      (radius * 8 >= index->CellSize || index->CellSize <= index->MinimumCellSize))
+  {
+    return index.get();
+  }
+
+  if (!index)
+  {
+    index.reset(new SearchIndex);
+  }
+  index->MTime = mTime;
+  index->NumberOfPoints = points->Size();
+
+  ScalarType minimum[3] = {0.0, 0.0, 0.0};
+  ScalarType maximum[3] = {0.0, 0.0, 0.0};
+  bool first = true;
+  for (PointsConstIterator it = points->Begin(); it != points->End(); ++it)
+  {
+    const DataType::PointType &p = it->Value();
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      minimum[d] = first ? p[d] : std::min(minimum[d], p[d]);
+      maximum[d] = first ? p[d] : std::max(maximum[d], p[d]);
+    }
+    first = false;
+  }
+
+  // make sure that the number of cells fits into the cell keys
+  index->MinimumCellSize = 0.0;
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    index->MinimumCellSize = std::max(index->MinimumCellSize, (maximum[d] - minimum[d]) / MAXIMUM_CELL_INDEX);
+  }
+  index->CellSize = std::max(radius, index->MinimumCellSize);
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    index->Origin[d] = minimum[d];
+    index->NumberOfCells[d] =
+      std::min(static_cast<long long>((maximum[d] - minimum[d]) / index->CellSize) + 1, MAXIMUM_CELL_INDEX + 1);
+  }
+
+  struct GridPoint
+  {
+    long long key;
+    PointIdentifier id;
+    const DataType::PointType *point;
+
+    // sorting by key and id keeps the points of a cell in the order of the point set
+    bool operator<(const GridPoint &other) const { return key < other.key || (key == other.key && id < other.id); }
+  };
+
+  std::vector<GridPoint> gridPoints;
+  gridPoints.reserve(index->NumberOfPoints);
+  for (PointsConstIterator it = points->Begin(); it != points->End(); ++it)
+  {
+    const DataType::PointType &p = it->Value();
+    GridPoint gridPoint = {
+      ComputeCellKey(index->GetCellIndex(p[0], 0), index->GetCellIndex(p[1], 1), index->GetCellIndex(p[2], 2)),
+      it->Index(),
+      &p};
+    gridPoints.push_back(gridPoint);
+  }
+  std::sort(gridPoints.begin(), gridPoints.end());
+
+  index->CellKeys.resize(gridPoints.size());
+  index->Ids.resize(gridPoints.size());
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    index->Coordinates[d].resize(gridPoints.size());
+  }
+  for (std::size_t i = 0; i < gridPoints.size(); ++i)
+  {
+    index->CellKeys[i] = gridPoints[i].key;
+    index->Ids[i] = gridPoints[i].id;
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      index->Coordinates[d][i] = (*gridPoints[i].point)[d];
+    }
+  }
+
+  return index.get();
+}
+
 int mitk::PointSet::SearchPoint(Point3D point, ScalarType distance, int t) const
 {
   if (t >= (int)m_PointSetSeries.size())
@@ -215,6 +355,65 @@ int mitk::PointSet::SearchPoint(Point3D point, ScalarType distance, int t) const
   ScalarType bestDist = distance;
   ScalarType dist, tmp;
 
+  if (this->GetSize(t) >= MINIMUM_NUMBER_OF_POINTS_FOR_SEARCH_INDEX)
+  {
+    // only the cells within the search radius are visited. The result is the
+    // same as for the linear search below: the first totally equal point or
+    // else the first point with the smallest distance
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(m_SearchIndexMutex);
+    ScalarType radius = std::sqrt(distance);
+    const SearchIndex *index = this->GetSearchIndex(t, radius);
+
+    int equalIndex = -1;
+    long long lower[3], upper[3];
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      lower[d] = index->GetCellIndex(indexPoint[d] - radius, d);
+      upper[d] = index->GetCellIndex(indexPoint[d] + radius, d);
+    }
+
+    for (long long z = lower[2]; z <= upper[2]; ++z)
+    {
+      for (long long y = lower[1]; y <= upper[1]; ++y)
+      {
+        long long firstKey = ComputeCellKey(lower[0], y, z);
+        long long lastKey = ComputeCellKey(upper[0], y, z);
+        auto first = std::lower_bound(index->CellKeys.begin(), index->CellKeys.end(), firstKey);
+        for (std::size_t n = first - index->CellKeys.begin(); n < index->CellKeys.size() && index->CellKeys[n] <= lastKey;
+             ++n)
+        {
+          int id = index->Ids[n];
+          out[0] = index->Coordinates[0][n];
+          out[1] = index->Coordinates[1][n];
+          out[2] = index->Coordinates[2][n];
+
+          if (indexPoint == out) // if totally equal
+          {
+            if (equalIndex == -1 || id < equalIndex)
+            {
+              equalIndex = id;
+            }
+            continue;
+          }
+
+          tmp = out[0] - indexPoint[0];
+          dist = tmp * tmp;
+          tmp = out[1] - indexPoint[1];
+          dist += tmp * tmp;
+          tmp = out[2] - indexPoint[2];
+          dist += tmp * tmp;
+
+          if (dist < bestDist || (dist == bestDist && bestIndex != -1 && id < bestIndex))
+          {
+            bestIndex = id;
+            bestDist = dist;
+          }
+        }
+      }
+    }
+    return equalIndex != -1 ? equalIndex : bestIndex;
+  }
+
   for (it = m_PointSetSeries[t]->GetPoints()->Begin(), i = 0; it != end; ++it, ++i)
   {
     bool ok = m_PointSetSeries[t]->GetPoints()->GetElementIfIndexExists(it->Index(), &out);
@@ -22,20 +22,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 #pragma warning(disable : 4503) // "decorated name length exceeded, name was truncated"
 #endif
 
-class AliasEquals
-{
-public:
-  AliasEquals(const std::string &alias) : m_Alias(alias) {}
-  bool operator()(const std::pair<std::string, std::vector<std::string>> &element)
-  {
-    std::vector<std::string>::const_iterator iter = std::find(element.second.begin(), element.second.end(), m_Alias);
-    return iter != element.second.end();
-  }
-
-private:
-  std::string m_Alias;
-};
-
 mitk::PropertyAliases::PropertyAliases()
 {
 }
@@ -64,6 +50,8 @@ bool mitk::PropertyAliases::AddAlias(const std::string &propertyName,
     aliases.insert(std::make_pair(propertyName, std::vector<std::string>(1, alias)));
   }
 
+  m_PropertyNames[className][alias].insert(propertyName);
+
   return true;
 }
 
@@ -86,11 +74,12 @@ std::string mitk::PropertyAliases::GetPropertyName(const std::string &alias, con
 {
   if (!alias.empty())
   {
-    AliasesMap &aliases = m_Aliases[className];
-    AliasesMapConstIterator iter = std::find_if(aliases.begin(), aliases.end(), AliasEquals(alias));
+    // first property name in the order of m_Aliases
+    PropertyNamesMap &propertyNames = m_PropertyNames[className];
+    PropertyNamesMap::const_iterator iter = propertyNames.find(alias);
 
-    if (iter != aliases.end())
-      return iter->first;
+    if (iter != propertyNames.end())
+      return *iter->second.begin();
   }
 
   return "";
@@ -119,6 +108,7 @@ void mitk::PropertyAliases::RemoveAlias(const std::string &propertyName,
       if (aliasIter != iter->second.end())
       {
         iter->second.erase(aliasIter);
+        this->RemovePropertyName(alias, propertyName, className);
 
         if (iter->second.empty())
           aliases.erase(propertyName);
@@ -132,7 +122,15 @@ void mitk::PropertyAliases::RemoveAliases(const std::string &propertyName, const
   if (!propertyName.empty())
   {
     AliasesMap &aliases = m_Aliases[className];
-    aliases.erase(propertyName);
+    AliasesMapIterator iter = aliases.find(propertyName);
+
+    if (iter != aliases.end())
+    {
+      for (const auto &alias : iter->second)
+        this->RemovePropertyName(alias, propertyName, className);
+
+      aliases.erase(iter);
+    }
   }
 }
 
@@ -140,4 +138,21 @@ void mitk::PropertyAliases::RemoveAllAliases(const std::string &className)
 {
   AliasesMap &aliases = m_Aliases[className];
   aliases.clear();
+  m_PropertyNames[className].clear();
+}
+
+void mitk::PropertyAliases::RemovePropertyName(const std::string &alias,
+                                               const std::string &propertyName,
+                                               const std::string &className)
+{
+  PropertyNamesMap &propertyNames = m_PropertyNames[className];
+  PropertyNamesMap::iterator iter = propertyNames.find(alias);
+
+  if (iter != propertyNames.end())
+  {
+    iter->second.erase(propertyName);
+
+    if (iter->second.empty())
+      propertyNames.erase(iter);
+  }
 }
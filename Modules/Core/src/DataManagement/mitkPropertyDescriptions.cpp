@@ -55,21 +55,25 @@ bool mitk::PropertyDescriptions::AddDescriptionRegEx(const std::string &property
   if (propertyRegEx.empty())
     return false;
 
+  RegExDescription regExDescription;
+
   try
   {
-    std::regex checker(propertyRegEx); // no exception => valid we can change the info
+    regExDescription.RegEx = std::regex(propertyRegEx); // no exception => valid we can change the info
   }
   catch (std::regex_error)
   {
     return false;
   }
 
-  DescriptionMap &descriptions = m_DescriptionsRegEx[className];
-  std::pair<DescriptionMapIterator, bool> ret = descriptions.insert(std::make_pair(propertyRegEx, description));
+  regExDescription.Description = description;
+
+  RegExDescriptionMap &descriptions = m_DescriptionsRegEx[className];
+  auto ret = descriptions.insert(std::make_pair(propertyRegEx, regExDescription));
 
   if (!ret.second && overwrite)
   {
-    ret.first->second = description;
+    ret.first->second = regExDescription;
     ret.second = true;
   }
 
@@ -95,9 +99,8 @@ std::string mitk::PropertyDescriptions::GetDescription(const std::string &proper
 
   if (allowNameRegEx && !propertyName.empty())
   {
-    auto selector = [propertyName](const DescriptionMap::value_type &x) {
-      std::regex ex(x.first);
-      return std::regex_match(propertyName, ex);
+    auto selector = [&propertyName](const RegExDescriptionMap::value_type &x) {
+      return std::regex_match(propertyName, x.second.RegEx);
     };
 
     auto descriptionsIter = m_DescriptionsRegEx.find(className);
@@ -107,7 +110,7 @@ std::string mitk::PropertyDescriptions::GetDescription(const std::string &proper
       auto finding = std::find_if(descriptionsIter->second.cbegin(), descriptionsIter->second.cend(), selector);
 
       if (finding != descriptionsIter->second.cend())
-        return finding->second;
+        return finding->second.Description;
     }
   }
 
@@ -133,9 +136,8 @@ bool mitk::PropertyDescriptions::HasDescription(const std::string &propertyName,
 
   if (allowNameRegEx && !propertyName.empty())
   {
-    auto selector = [propertyName](const DescriptionMap::value_type &x) {
-      std::regex ex(x.first);
-      return std::regex_match(propertyName, ex);
+    auto selector = [&propertyName](const RegExDescriptionMap::value_type &x) {
+      return std::regex_match(propertyName, x.second.RegEx);
     };
 
     auto descriptionsIter = m_DescriptionsRegEx.find(className);
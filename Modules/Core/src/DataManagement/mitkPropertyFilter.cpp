@@ -63,12 +63,15 @@ namespace mitk
 
     if (!m_Lists[Whitelist].empty())
     {
-      auto end = propertyMap.end();
+      auto end = m_Lists[Whitelist].end();
 
-      for (auto iter = propertyMap.begin(); iter != end; ++iter)
+      // look up the whitelist entries in the sorted property map instead of searching every property in the list
+      for (auto iter = m_Lists[Whitelist].begin(); iter != end; ++iter)
       {
-        if (std::find(m_Lists[Whitelist].begin(), m_Lists[Whitelist].end(), iter->first) != m_Lists[Whitelist].end())
-          ret.insert(*iter);
+        auto finding = propertyMap.find(*iter);
+
+        if (finding != propertyMap.end())
+          ret.insert(*finding);
       }
     }
 
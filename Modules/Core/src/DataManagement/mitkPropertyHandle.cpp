@@ -0,0 +1,32 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkPropertyHandle.h"
+
+mitk::PropertyHandle::PropertyHandle(const std::string &propertyKey)
+  : m_KeyId(PropertyKeys::GetId(propertyKey)),
+    m_Key(&PropertyKeys::GetKey(m_KeyId)),
+    m_StructureVersion(0),
+    m_NumberOfUsedSlots(0),
+    m_NextSlot(0)
+{
+}
+
+void mitk::PropertyHandle::Reset()
+{
+  m_NumberOfUsedSlots = 0;
+  m_NextSlot = 0;
+}
@@ -0,0 +1,75 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkPropertyKeys.h"
+#include "mitkExceptionMacro.h"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace
+{
+  struct KeyTable
+  {
+    std::mutex Mutex;
+    // a deque does not move its elements when it grows, references returned by GetKey stay valid
+    std::deque<std::string> Keys;
+    std::unordered_map<std::string, mitk::PropertyKeys::IdType> Ids;
+  };
+
+  KeyTable &GetKeyTable()
+  {
+    static KeyTable table;
+    return table;
+  }
+}
+
+mitk::PropertyKeys::IdType mitk::PropertyKeys::GetId(const std::string &propertyKey)
+{
+  KeyTable &table = GetKeyTable();
+  std::lock_guard<std::mutex> lock(table.Mutex);
+
+  auto iter = table.Ids.find(propertyKey);
+
+  if (iter != table.Ids.end())
+    return iter->second;
+
+  IdType id = static_cast<IdType>(table.Keys.size());
+  table.Keys.push_back(propertyKey);
+  table.Ids.insert(std::make_pair(propertyKey, id));
+
+  return id;
+}
+
+const std::string &mitk::PropertyKeys::GetKey(IdType id)
+{
+  KeyTable &table = GetKeyTable();
+  std::lock_guard<std::mutex> lock(table.Mutex);
+
+  if (id >= table.Keys.size())
+    mitkThrow() << "Property key id " << id << " is unknown.";
+
+  return table.Keys[id];
+}
+
+mitk::PropertyKeys::IdType mitk::PropertyKeys::GetNumberOfKeys()
+{
+  KeyTable &table = GetKeyTable();
+  std::lock_guard<std::mutex> lock(table.Mutex);
+
+  return static_cast<IdType>(table.Keys.size());
+}
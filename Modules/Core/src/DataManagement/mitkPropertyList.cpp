@@ -20,6 +20,31 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkProperties.h"
 #include "mitkStringProperty.h"
 
+#include <atomic>
+
+namespace
+{
+  std::atomic<unsigned long> StructureVersion(1);
+}
+
+unsigned long mitk::PropertyList::GetStructureVersion()
+{
+  return StructureVersion.load(std::memory_order_relaxed);
+}
+
+void mitk::PropertyList::UseForCachedLookups() const
+{
+  if (!m_UsedForCachedLookups.load(std::memory_order_relaxed))
+    m_UsedForCachedLookups.store(true, std::memory_order_relaxed);
+}
+
+void mitk::PropertyList::StructureModified()
+{
+  // lists no cached lookup has seen cannot make cached lookups invalid
+  if (m_UsedForCachedLookups.load(std::memory_order_relaxed))
+    ++StructureVersion;
+}
+
 mitk::BaseProperty *mitk::PropertyList::GetProperty(const std::string &propertyKey) const
 {
   PropertyMap::const_iterator it;
@@ -71,6 +96,7 @@ void mitk::PropertyList::SetProperty(const std::string &propertyKey, BasePropert
 
   // no? add it.
   m_Properties.insert(PropertyMap::value_type(propertyKey, property));
+  StructureModified();
   this->Modified();
 }
 
@@ -90,14 +116,15 @@ void mitk::PropertyList::ReplaceProperty(const std::string &propertyKey, BasePro
 
   // no? add/replace it.
   m_Properties.insert(PropertyMap::value_type(propertyKey, property));
+  StructureModified();
   Modified();
 }
 
-mitk::PropertyList::PropertyList()
+mitk::PropertyList::PropertyList() : m_UsedForCachedLookups(false)
 {
 }
 
-mitk::PropertyList::PropertyList(const mitk::PropertyList &other) : itk::Object()
+mitk::PropertyList::PropertyList(const mitk::PropertyList &other) : itk::Object(), m_UsedForCachedLookups(false)
 {
   for (auto i = other.m_Properties.cbegin(); i != other.m_Properties.cend(); ++i)
   {
@@ -140,6 +167,7 @@ bool mitk::PropertyList::DeleteProperty(const std::string &propertyKey)
   {
     it->second = nullptr;
     m_Properties.erase(it);
+    StructureModified();
     Modified();
     return true;
   }
@@ -155,6 +183,7 @@ void mitk::PropertyList::Clear()
     ++it;
   }
   m_Properties.clear();
+  StructureModified();
 }
 
 itk::LightObject::Pointer mitk::PropertyList::InternalClone() const
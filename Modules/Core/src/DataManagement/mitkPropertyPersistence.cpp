@@ -57,25 +57,66 @@ bool mitk::PropertyPersistence::AddInfo(const PropertyPersistenceInfo *info, boo
   {
     if (exists && overwrite)
     {
+      this->RemoveFromIndex(finding->second);
       m_InfoMap.erase(finding);
     }
     result = true;
-    m_InfoMap.insert(std::make_pair(info->GetName(), info));
+    // the indexes depend on name, key and regexs of the info, changes of the caller's instance must not affect them
+    PropertyPersistenceInfo::ConstPointer copy = info->Clone().GetPointer();
+    m_InfoMap.insert(std::make_pair(copy->GetName(), copy));
+    this->AddToIndex(copy);
   }
 
   return result;
 }
 
-mitk::PropertyPersistence::InfoMap mitk::PropertyPersistence::SelectInfo(const InfoMap &infoMap,
-                                                                         const SelectFunctionType &selectFunction)
+void mitk::PropertyPersistence::AddToIndex(const PropertyPersistenceInfo *info)
+{
+  if (info->IsRegEx())
+  {
+    m_RegExInfoMap.insert(std::make_pair(info->GetName(), info));
+  }
+  else
+  {
+    m_KeyMap.insert(std::make_pair(info->GetKey(), info));
+  }
+}
+
+void mitk::PropertyPersistence::RemoveFromIndex(const PropertyPersistenceInfo *info)
+{
+  InfoMap &index = info->IsRegEx() ? m_RegExInfoMap : m_KeyMap;
+  auto range = index.equal_range(info->IsRegEx() ? info->GetName() : info->GetKey());
+  auto finding =
+    std::find_if(range.first, range.second, [info](const InfoMap::value_type &x) { return x.second == info; });
+  if (finding != range.second)
+  {
+    index.erase(finding);
+  }
+}
+
+mitk::PropertyPersistence::InfoMap mitk::PropertyPersistence::SelectInfo(const std::string &propertyName,
+                                                                         const MimeTypeNameType &mime,
+                                                                         bool allowNameRegEx) const
 {
   InfoMap result;
 
-  for (auto pos : infoMap)
+  auto range = m_InfoMap.equal_range(propertyName);
+  for (auto pos = range.first; pos != range.second; ++pos)
   {
-    if (selectFunction(pos))
+    if (pos->second.IsNotNull() && !pos->second->IsRegEx() && pos->second->GetMimeTypeName() == mime)
     {
-      result.insert(pos);
+      result.insert(*pos);
+    }
+  }
+
+  if (allowNameRegEx)
+  {
+    for (const auto &pos : m_RegExInfoMap)
+    {
+      if (pos.second->GetMimeTypeName() == mime && std::regex_match(propertyName, pos.second->GetNameRegEx()))
+      {
+        result.insert(pos);
+      }
     }
   }
 
@@ -85,99 +126,41 @@ mitk::PropertyPersistence::InfoMap mitk::PropertyPersistence::SelectInfo(const I
 mitk::PropertyPersistence::InfoResultType mitk::PropertyPersistence::GetInfo(const std::string &propertyName,
                                                                              bool allowNameRegEx) const
 {
-  SelectFunctionType select = [propertyName](const InfoMap::value_type &x) {
-    return x.second.IsNotNull() && !x.second->IsRegEx() && x.second->GetName() == propertyName;
-  };
-
-  InfoMap selection = SelectInfo(m_InfoMap, select);
-
   InfoResultType result;
-  for (const auto &pos : selection)
+
+  auto range = m_InfoMap.equal_range(propertyName);
+  for (auto pos = range.first; pos != range.second; ++pos)
   {
-    result.push_back(pos.second->UnRegExByName(propertyName).GetPointer());
+    if (pos->second.IsNotNull() && !pos->second->IsRegEx())
+    {
+      result.push_back(pos->second->UnRegExByName(propertyName).GetPointer());
+    }
   }
 
   if (allowNameRegEx)
   {
-    select = [propertyName](const InfoMap::value_type &x) {
-      if (x.second.IsNotNull() && x.second->IsRegEx())
+    for (const auto &pos : m_RegExInfoMap)
+    {
+      if (std::regex_match(propertyName, pos.second->GetNameRegEx()))
       {
-        std::regex ex(x.second->GetName());
-        return std::regex_match(propertyName, ex);
+        result.push_back(pos.second->UnRegExByName(propertyName).GetPointer());
       }
-      return false;
-    };
-
-    selection = SelectInfo(m_InfoMap, select);
-
-    for (const auto &pos : selection)
-    {
-      result.push_back(pos.second->UnRegExByName(propertyName).GetPointer());
     }
   }
 
   return result;
 }
 
-bool infoPredicate(const std::multimap<const std::string, mitk::PropertyPersistenceInfo::ConstPointer>::value_type &x,
-                   const std::string &propertyName,
-                   const std::string &mime)
-{
-  return x.second.IsNotNull() && !x.second->IsRegEx() && x.second->GetName() == propertyName &&
-         x.second->GetMimeTypeName() == mime;
-}
-
-bool infoPredicateRegEx(
-  const std::multimap<const std::string, mitk::PropertyPersistenceInfo::ConstPointer>::value_type &x,
-  const std::string &propertyName,
-  const std::string &mime)
-{
-  if (x.second.IsNotNull() && x.second->IsRegEx())
-  {
-    std::regex ex(x.second->GetName());
-    return std::regex_match(propertyName, ex) && x.second->GetMimeTypeName() == mime;
-  }
-  return false;
-}
-
 mitk::PropertyPersistence::InfoResultType mitk::PropertyPersistence::GetInfo(const std::string &propertyName,
                                                                              const MimeTypeNameType &mime,
                                                                              bool allowMimeWildCard,
                                                                              bool allowNameRegEx) const
 {
-  SelectFunctionType select = [propertyName, mime](const InfoMap::value_type &x) {
-    return infoPredicate(x, propertyName, mime);
-  };
-
-  InfoMap selection = SelectInfo(m_InfoMap, select);
-
-  if (allowNameRegEx)
-  {
-    select = [propertyName, mime](const InfoMap::value_type &x) { return infoPredicateRegEx(x, propertyName, mime); };
-
-    InfoMap regExSelection = SelectInfo(m_InfoMap, select);
-
-    selection.insert(regExSelection.begin(), regExSelection.end());
-  }
+  InfoMap selection = this->SelectInfo(propertyName, mime, allowNameRegEx);
 
   if (selection.empty() && allowMimeWildCard)
   { // no perfect match => second run through with "any mime type"
-    select = [propertyName](const InfoMap::value_type &x) {
-      return infoPredicate(x, propertyName, PropertyPersistenceInfo::ANY_MIMETYPE_NAME());
-    };
-
-    selection = SelectInfo(m_InfoMap, select);
-
-    if (allowNameRegEx)
-    {
-      select = [propertyName](const InfoMap::value_type &x) {
-        return infoPredicateRegEx(x, propertyName, PropertyPersistenceInfo::ANY_MIMETYPE_NAME());
-      };
-
-      InfoMap regExSelection = SelectInfo(m_InfoMap, select);
-
-      selection.insert(regExSelection.begin(), regExSelection.end());
-    }
+    selection = this->SelectInfo(propertyName, PropertyPersistenceInfo::ANY_MIMETYPE_NAME(), allowNameRegEx);
   }
 
   InfoResultType result;
@@ -192,26 +175,30 @@ mitk::PropertyPersistence::InfoResultType mitk::PropertyPersistence::GetInfo(con
 mitk::PropertyPersistence::InfoResultType mitk::PropertyPersistence::GetInfoByKey(const std::string &persistenceKey,
                                                                                   bool allowKeyRegEx) const
 {
-  InfoResultType result;
+  // collect by name to keep the order of m_InfoMap
+  InfoMap selection;
 
-  for (const auto &pos : m_InfoMap)
+  auto range = m_KeyMap.equal_range(persistenceKey);
+  for (auto pos = range.first; pos != range.second; ++pos)
   {
-    if (pos.second.IsNotNull())
-    {
-      bool valid = pos.second->GetKey() == persistenceKey;
-      if (!valid && pos.second->IsRegEx() && allowKeyRegEx)
-      {
-        std::regex ex(pos.second->GetKey());
-        valid = std::regex_match(persistenceKey, ex);
-      }
+    selection.insert(std::make_pair(pos->second->GetName(), pos->second));
+  }
 
-      if (valid)
-      {
-        result.push_back(pos.second->UnRegExByKey(persistenceKey).GetPointer());
-      }
+  for (const auto &pos : m_RegExInfoMap)
+  {
+    if (pos.second->GetKey() == persistenceKey ||
+        (allowKeyRegEx && std::regex_match(persistenceKey, pos.second->GetKeyRegEx())))
+    {
+      selection.insert(pos);
     }
   }
 
+  InfoResultType result;
+  for (const auto &pos : selection)
+  {
+    result.push_back(pos.second->UnRegExByKey(persistenceKey).GetPointer());
+  }
+
   return result;
 }
 
@@ -223,24 +210,35 @@ bool mitk::PropertyPersistence::HasInfo(const std::string &propertyName, bool al
 void mitk::PropertyPersistence::RemoveAllInfo()
 {
   m_InfoMap.clear();
-  m_InfoMap.clear();
+  m_KeyMap.clear();
+  m_RegExInfoMap.clear();
 }
 
 void mitk::PropertyPersistence::RemoveInfo(const std::string &propertyName)
 {
   if (!propertyName.empty())
   {
-    m_InfoMap.erase(propertyName);
+    auto range = m_InfoMap.equal_range(propertyName);
+    for (auto pos = range.first; pos != range.second; ++pos)
+    {
+      if (pos->second.IsNotNull())
+      {
+        this->RemoveFromIndex(pos->second);
+      }
+    }
+    m_InfoMap.erase(range.first, range.second);
   }
 }
 
 void mitk::PropertyPersistence::RemoveInfo(const std::string &propertyName, const MimeTypeNameType &mime)
 {
-  auto itr = m_InfoMap.begin();
-  while (itr != m_InfoMap.end())
+  auto range = m_InfoMap.equal_range(propertyName);
+  auto itr = range.first;
+  while (itr != range.second)
   {
-    if (itr->first == propertyName && itr->second.IsNotNull() && itr->second->GetMimeTypeName() == mime)
+    if (itr->second.IsNotNull() && itr->second->GetMimeTypeName() == mime)
     {
+      this->RemoveFromIndex(itr->second);
       itr = m_InfoMap.erase(itr);
     }
     else
@@ -15,6 +15,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include <cassert>
+#include <memory>
 #include <regex>
 
 #include <mitkIOMimeTypes.h>
@@ -33,6 +34,9 @@ namespace mitk
     bool IsRegEx;
     std::string NameTemplate;
     std::string KeyTemplate;
+    /** Compiled Name and Key regexs, shared by copies (see UnRegExByName) */
+    std::shared_ptr<const std::regex> NameRegEx;
+    std::shared_ptr<const std::regex> KeyRegEx;
     DeserializationFunctionType DeSerFnc;
     SerializationFunctionType SerFnc;
     MimeTypeNameType MimeTypeName;
@@ -87,6 +91,8 @@ void mitk::PropertyPersistenceInfo::SetName(const std::string &name)
   m_Impl->IsRegEx = false;
   m_Impl->NameTemplate.clear();
   m_Impl->KeyTemplate.clear();
+  m_Impl->NameRegEx.reset();
+  m_Impl->KeyRegEx.reset();
 }
 
 void mitk::PropertyPersistenceInfo::SetNameAndKey(const std::string &name, const std::string &key)
@@ -96,16 +102,20 @@ void mitk::PropertyPersistenceInfo::SetNameAndKey(const std::string &name, const
   m_Impl->IsRegEx = false;
   m_Impl->NameTemplate.clear();
   m_Impl->KeyTemplate.clear();
+  m_Impl->NameRegEx.reset();
+  m_Impl->KeyRegEx.reset();
 }
 
 void mitk::PropertyPersistenceInfo::UseRegEx(const std::string &nameRegEx, const std::string &nameTemplate)
 {
-  std::regex checker(nameRegEx); // no exception => valid we can change the info
+  auto checker = std::make_shared<const std::regex>(nameRegEx); // no exception => valid we can change the info
   m_Impl->Name = nameRegEx;
   m_Impl->Key = nameRegEx;
   m_Impl->IsRegEx = true;
   m_Impl->NameTemplate = nameTemplate;
   m_Impl->KeyTemplate = nameTemplate;
+  m_Impl->NameRegEx = checker;
+  m_Impl->KeyRegEx = checker;
 }
 
 void mitk::PropertyPersistenceInfo::UseRegEx(const std::string &nameRegEx,
@@ -113,13 +123,15 @@ void mitk::PropertyPersistenceInfo::UseRegEx(const std::string &nameRegEx,
                                              const std::string &keyRegEx,
                                              const std::string keyTemplate)
 {
-  std::regex nameChecker(nameRegEx); // no exception => valid we can change the info
-  std::regex keyChecker(keyRegEx);   // no exception => valid we can change the info
+  auto nameChecker = std::make_shared<const std::regex>(nameRegEx); // no exception => valid we can change the info
+  auto keyChecker = std::make_shared<const std::regex>(keyRegEx);   // no exception => valid we can change the info
   m_Impl->Name = nameRegEx;
   m_Impl->Key = keyRegEx;
   m_Impl->IsRegEx = true;
   m_Impl->NameTemplate = nameTemplate;
   m_Impl->KeyTemplate = keyTemplate;
+  m_Impl->NameRegEx = nameChecker;
+  m_Impl->KeyRegEx = keyChecker;
 }
 
 bool mitk::PropertyPersistenceInfo::IsRegEx() const
@@ -137,6 +149,18 @@ const std::string &mitk::PropertyPersistenceInfo::GetNameTemplate() const
   return m_Impl->NameTemplate;
 }
 
+const std::regex &mitk::PropertyPersistenceInfo::GetNameRegEx() const
+{
+  assert(m_Impl->NameRegEx);
+  return *(m_Impl->NameRegEx);
+}
+
+const std::regex &mitk::PropertyPersistenceInfo::GetKeyRegEx() const
+{
+  assert(m_Impl->KeyRegEx);
+  return *(m_Impl->KeyRegEx);
+}
+
 const mitk::PropertyPersistenceInfo::MimeTypeNameType &mitk::PropertyPersistenceInfo::GetMimeTypeName() const
 {
   return m_Impl->MimeTypeName;
@@ -173,25 +197,27 @@ void mitk::PropertyPersistenceInfo::SetSerializationFunction(
 
 std::string GenerateFromTemplate(const std::string &sourceStr,
                                  const std::string &templateStr,
-                                 const std::string &regexStr)
+                                 const std::regex &ex)
 {
   std::smatch sm;
-  std::regex ex(regexStr);
   std::regex_match(sourceStr, sm, ex);
 
   std::string result = templateStr;
 
-  int groupID = 0;
-  for (const auto &match : sm)
+  // replace the placeholders $1, $2, ... by the matched groups
+  for (std::size_t groupID = 1; groupID < sm.size(); ++groupID)
   {
-    if (groupID)
+    std::ostringstream stream;
+    stream << "$" << groupID;
+    const std::string placeholder = stream.str();
+    const std::string value = sm[groupID].str();
+
+    std::string::size_type pos = result.find(placeholder);
+    while (pos != std::string::npos)
     {
-      std::ostringstream stream;
-      stream << "(\\$" << groupID << ")";
-      std::regex rex(stream.str());
-      result = std::regex_replace(result, rex, match.str());
+      result.replace(pos, placeholder.size(), value);
+      pos = result.find(placeholder, pos + value.size());
     }
-    ++groupID;
   }
 
   return result;
@@ -205,7 +231,7 @@ mitk::PropertyPersistenceInfo::Pointer mitk::PropertyPersistenceInfo::UnRegExByN
 
   if (this->IsRegEx())
   {
-    std::string newKey = GenerateFromTemplate(propertyName, this->GetKeyTemplate(), this->GetName());
+    std::string newKey = GenerateFromTemplate(propertyName, this->GetKeyTemplate(), *(m_Impl->NameRegEx));
     resultInfo->SetNameAndKey(propertyName, newKey);
   }
 
@@ -219,7 +245,7 @@ mitk::PropertyPersistenceInfo::Pointer mitk::PropertyPersistenceInfo::UnRegExByK
 
   if (this->IsRegEx())
   {
-    std::string newName = GenerateFromTemplate(key, this->GetNameTemplate(), this->GetKey());
+    std::string newName = GenerateFromTemplate(key, this->GetNameTemplate(), *(m_Impl->KeyRegEx));
     resultInfo->SetNameAndKey(newName, key);
   }
 
@@ -232,6 +258,13 @@ mitk::PropertyPersistenceInfo::MimeTypeNameType mitk::PropertyPersistenceInfo::A
   return name;
 };
 
+itk::LightObject::Pointer mitk::PropertyPersistenceInfo::InternalClone() const
+{
+  PropertyPersistenceInfo::Pointer clone = PropertyPersistenceInfo::New();
+  *(clone->m_Impl) = *(this->m_Impl);
+  return clone.GetPointer();
+};
+
 void mitk::PropertyPersistenceInfo::PrintSelf(std::ostream &os, itk::Indent indent) const
 {
   this->Superclass::PrintSelf(os, indent);
@@ -23,15 +23,31 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIPropertyPersistence.h>
 #include <mitkImage.h>
 #include <mitkImageReadAccessor.h>
+#include <mitkIOUtil.h>
+#include <mitkImageWriteAccessor.h>
 #include <mitkLocaleSwitch.h>
+#include <mitkMappedImageMemory.h>
+#include <mitkProgressiveImageMemory.h>
+#include <mitkRenderingManager.h>
 
+#include <itkByteSwapper.h>
+#include <itkCommand.h>
 #include <itkImage.h>
 #include <itkImageFileReader.h>
 #include <itkImageIOFactory.h>
 #include <itkImageIORegion.h>
 #include <itkMetaDataObject.h>
+#include <itkMultiThreader.h>
+#include <itksys/SystemTools.hxx>
+
+#include "itk_zlib.h"
 
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
 
 namespace mitk
 {
@@ -40,6 +56,39 @@ namespace mitk
   const char *const PROPERTY_KEY_TIMEGEOMETRY_TYPE = "org_mitk_timegeometry_type";
   const char *const PROPERTY_KEY_TIMEGEOMETRY_TIMEPOINTS = "org_mitk_timegeometry_timepoints";
 
+  /** zlib level of the ITK ImageIO objects */
+  static const int DEFAULT_COMPRESSION_LEVEL = 6;
+
+  std::string ItkImageIO::OPTION_COMPRESSION()
+  {
+    static std::string s = "Compression";
+    return s;
+  }
+
+  std::string ItkImageIO::OPTION_COMPRESSION_LEVEL()
+  {
+    static std::string s = "Compression level";
+    return s;
+  }
+
+  std::string ItkImageIO::COMPRESSION_DEFAULT()
+  {
+    static std::string s = "Default";
+    return s;
+  }
+
+  std::string ItkImageIO::COMPRESSION_NONE()
+  {
+    static std::string s = "None";
+    return s;
+  }
+
+  std::string ItkImageIO::COMPRESSION_PARALLEL()
+  {
+    static std::string s = "Parallel";
+    return s;
+  }
+
   ItkImageIO::ItkImageIO(const ItkImageIO &other)
     : AbstractFileIO(other), m_ImageIO(dynamic_cast<itk::ImageIOBase *>(other.m_ImageIO->Clone().GetPointer()))
   {
@@ -108,6 +157,7 @@ namespace mitk
 
     this->AbstractFileReader::SetMimeTypePrefix(IOMimeTypes::DEFAULT_BASE_NAME() + ".image.");
     this->InitializeDefaultMetaDataKeys();
+    this->InitializeDefaultWriterOptions();
 
     std::vector<std::string> readExtensions = m_ImageIO->GetSupportedReadExtensions();
 
@@ -177,6 +227,7 @@ namespace mitk
 
     this->AbstractFileReader::SetMimeTypePrefix(IOMimeTypes::DEFAULT_BASE_NAME() + ".image.");
     this->InitializeDefaultMetaDataKeys();
+    this->InitializeDefaultWriterOptions();
 
     if (rank)
     {
@@ -209,6 +260,289 @@ namespace mitk
     return result;
   };
 
+  /**Helper function that reads "key<separator>value" header lines of a text header (NRRD, MetaImage) into fields,
+   * until an empty line or a line with key lastKey is found. Returns the file position after the last header line
+   * or -1 if the header ends unexpectedly.*/
+  static long long ReadTextHeader(std::ifstream &file,
+                                  char separator,
+                                  const std::string &lastKey,
+                                  std::map<std::string, std::string> &fields)
+  {
+    std::string line;
+    while (std::getline(file, line))
+    {
+      if (!line.empty() && line[line.size() - 1] == '\r')
+      {
+        line.erase(line.size() - 1);
+      }
+      if (line.empty())
+      {
+        return lastKey.empty() ? static_cast<long long>(file.tellg()) : -1;
+      }
+      if (line[0] == '#')
+      {
+        continue;
+      }
+
+      const std::string::size_type pos = line.find(separator);
+      if (pos == std::string::npos || (pos + 1 < line.size() && line[pos + 1] == '='))
+      {
+        continue; // NRRD key/value pairs ("key:=value") are no fields
+      }
+
+      std::string key = line.substr(0, pos);
+      std::string value = line.substr(pos + 1);
+      key.erase(key.find_last_not_of(" \t") + 1);
+      value.erase(0, value.find_first_not_of(" \t"));
+      fields[key] = value;
+
+      if (!lastKey.empty() && key == lastKey)
+      {
+        return static_cast<long long>(file.tellg());
+      }
+    }
+    return -1;
+  }
+
+  /**Helper function that resolves the name of a detached data file relative to its header file. Returns false for
+   * lists and file name patterns.*/
+  static bool ResolveDataFileName(const std::string &headerPath, const std::string &dataFileName, std::string &path)
+  {
+    if (dataFileName.empty() || dataFileName.compare(0, 4, "LIST") == 0 ||
+        dataFileName.find('%') != std::string::npos)
+    {
+      return false;
+    }
+    path = itksys::SystemTools::FileIsFullPath(dataFileName.c_str()) ?
+             dataFileName :
+             itksys::SystemTools::GetFilenamePath(headerPath) + "/" + dataFileName;
+    return true;
+  }
+
+  /**Location of the pixel data of an image file as it is stored on disk.*/
+  struct RawDataLocation
+  {
+    /** The file holding the pixel data (the image file itself or a detached data file) */
+    std::string m_File;
+    /** Position of the (compressed) pixel data in m_File */
+    unsigned long long m_Offset;
+    /** True if the data is a zlib or gzip stream, which holds the pixel data at m_InflatedOffset */
+    bool m_Compressed;
+    unsigned long long m_InflatedOffset;
+  };
+
+  /**Helper function that locates the pixel data of a NRRD, NIfTI or MetaImage file. Returns false if the data
+   * cannot be used as it is stored, i.e. if it is split into several files, stored in foreign byte order, uses an
+   * unsupported compression or is reordered by ITK while reading.*/
+  static bool GetRawDataLocation(const itk::ImageIOBase *imageIO, RawDataLocation &location)
+  {
+    const std::string path = imageIO->GetFileName();
+    const std::string ioName = imageIO->GetNameOfClass();
+    const unsigned long long imageSize = imageIO->GetImageSizeInBytes();
+    const bool bigEndianSystem = itk::ByteSwapper<int>::SystemIsBigEndian();
+    const bool needsByteOrder = imageIO->GetComponentSize() > 1;
+
+    location.m_Offset = 0;
+    location.m_Compressed = false;
+    location.m_InflatedOffset = 0;
+
+    std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+    if (!file.good())
+    {
+      return false;
+    }
+
+    long long byteSkip = 0;
+    if (ioName == "NrrdImageIO")
+    {
+      std::string magic;
+      std::getline(file, magic);
+      if (magic.compare(0, 4, "NRRD") != 0)
+      {
+        return false;
+      }
+
+      std::map<std::string, std::string> fields;
+      long long headerEnd = ReadTextHeader(file, ':', "", fields);
+
+      const std::string encoding = fields["encoding"];
+      location.m_Compressed = (encoding == "gzip" || encoding == "gz");
+      if ((encoding != "raw" && !location.m_Compressed) ||
+          (!fields["line skip"].empty() && fields["line skip"] != "0") ||
+          (!fields["lineskip"].empty() && fields["lineskip"] != "0"))
+      {
+        return false;
+      }
+      if (needsByteOrder && fields["endian"] != (bigEndianSystem ? "big" : "little"))
+      {
+        return false;
+      }
+      // ITK moves a non-leading vector axis to the front while reading
+      if (imageIO->GetNumberOfComponents() > 1)
+      {
+        const std::string firstKind = fields["kinds"].substr(0, fields["kinds"].find(' '));
+        if (firstKind == "domain" || firstKind == "space" || firstKind == "time")
+        {
+          return false;
+        }
+      }
+
+      std::string dataFileName = !fields["data file"].empty() ? fields["data file"] : fields["datafile"];
+      if (dataFileName.empty())
+      {
+        if (headerEnd < 0)
+        {
+          return false;
+        }
+        location.m_File = path;
+        location.m_Offset = headerEnd;
+      }
+      else if (!ResolveDataFileName(path, dataFileName, location.m_File))
+      {
+        return false;
+      }
+
+      std::string skip = !fields["byte skip"].empty() ? fields["byte skip"] : fields["byteskip"];
+      byteSkip = skip.empty() ? 0 : std::atoll(skip.c_str());
+      if (location.m_Compressed)
+      {
+        // for compressed encodings the byte skip applies to the inflated data
+        if (byteSkip < 0)
+        {
+          return false;
+        }
+        location.m_InflatedOffset = byteSkip;
+        byteSkip = 0;
+      }
+    }
+    else if (ioName == "NiftiImageIO")
+    {
+      const std::string lowerPath = itksys::SystemTools::LowerCase(path);
+      const bool compressed = lowerPath.size() > 7 && lowerPath.compare(lowerPath.size() - 7, 7, ".nii.gz") == 0;
+      const bool uncompressed = lowerPath.size() > 4 && lowerPath.compare(lowerPath.size() - 4, 4, ".nii") == 0;
+      if ((!compressed && !uncompressed) || imageIO->GetNumberOfComponents() != 1)
+      {
+        return false;
+      }
+
+      char header[348];
+      if (compressed)
+      {
+        gzFile gzHeader = gzopen(path.c_str(), "rb");
+        if (gzHeader == nullptr)
+        {
+          return false;
+        }
+        const int headerBytes = gzread(gzHeader, header, sizeof(header));
+        gzclose(gzHeader);
+        if (headerBytes != sizeof(header))
+        {
+          return false;
+        }
+      }
+      else if (!file.read(header, sizeof(header)))
+      {
+        return false;
+      }
+
+      int headerSize;
+      float voxOffset, sclSlope, sclInter;
+      std::memcpy(&headerSize, header, sizeof(int));
+      std::memcpy(&voxOffset, header + 108, sizeof(float));
+      std::memcpy(&sclSlope, header + 112, sizeof(float));
+      std::memcpy(&sclInter, header + 116, sizeof(float));
+
+      // a swapped header means foreign byte order, ITK rescales if scl_slope is set
+      if (headerSize != 348 || std::strncmp(header + 344, "n+1", 4) != 0 ||
+          (sclSlope != 0.0f && (sclSlope != 1.0f || sclInter != 0.0f)))
+      {
+        return false;
+      }
+      location.m_File = path;
+      location.m_Compressed = compressed;
+      if (compressed)
+      {
+        location.m_InflatedOffset = static_cast<unsigned long long>(voxOffset);
+      }
+      else
+      {
+        location.m_Offset = static_cast<unsigned long long>(voxOffset);
+      }
+    }
+    else if (ioName == "MetaImageIO")
+    {
+      std::map<std::string, std::string> fields;
+      long long headerEnd = ReadTextHeader(file, '=', "ElementDataFile", fields);
+      if (headerEnd < 0)
+      {
+        return false;
+      }
+
+      const std::string compressed = fields["CompressedData"];
+      location.m_Compressed = (compressed == "True" || compressed == "true");
+      std::string msb = !fields["ElementByteOrderMSB"].empty() ? fields["ElementByteOrderMSB"] :
+                                                                   fields["BinaryDataByteOrderMSB"];
+      const bool bigEndianData = (msb == "True" || msb == "true");
+      if (needsByteOrder && bigEndianData != bigEndianSystem)
+      {
+        return false;
+      }
+
+      if (fields["ElementDataFile"] == "LOCAL")
+      {
+        location.m_File = path;
+        location.m_Offset = headerEnd;
+      }
+      else if (!ResolveDataFileName(path, fields["ElementDataFile"], location.m_File))
+      {
+        return false;
+      }
+
+      byteSkip = fields["HeaderSize"].empty() ? 0 : std::atoll(fields["HeaderSize"].c_str());
+      if (location.m_Compressed && byteSkip != 0)
+      {
+        return false;
+      }
+    }
+    else
+    {
+      return false;
+    }
+
+    if (location.m_Compressed)
+    {
+      return true;
+    }
+
+    const unsigned long long fileSize = itksys::SystemTools::FileLength(location.m_File);
+    if (byteSkip < 0)
+    {
+      // the data is stored at the end of the file
+      if (fileSize < imageSize)
+      {
+        return false;
+      }
+      location.m_Offset = fileSize - imageSize;
+    }
+    else
+    {
+      location.m_Offset += byteSkip;
+    }
+
+    // unaligned pixel data would need a copy anyway
+    return location.m_Offset + imageSize <= fileSize && location.m_Offset % imageIO->GetComponentSize() == 0;
+  }
+
+  /**Observer of mitk::ProgressiveImageMemory, called in the loader thread whenever a time step has been loaded.
+   * Mappers render nothing for pending time steps, so views showing them have to be updated.*/
+  static void RequestUpdateOnLoadedTimeStep(itk::Object *, const itk::EventObject &, void *)
+  {
+    if (RenderingManager::IsInstantiated())
+    {
+      RenderingManager::GetInstance()->RequestUpdateAllFromBackgroundThread(RenderingManager::REQUEST_UPDATE_2DWINDOWS);
+    }
+  }
+
   std::vector<BaseData::Pointer> ItkImageIO::Read()
   {
     std::vector<BaseData::Pointer> result;
@@ -284,11 +618,59 @@ namespace mitk
 
     MITK_INFO << "ioRegion: " << ioRegion << std::endl;
     m_ImageIO->SetIORegion(ioRegion);
-    void *buffer = new unsigned char[m_ImageIO->GetImageSizeInBytes()];
-    m_ImageIO->Read(buffer);
 
     image->Initialize(MakePixelType(m_ImageIO), ndim, dimensions);
-    image->SetImportChannel(buffer, 0, Image::ManageMemory);
+
+    // Uncompressed data is mapped copy-on-write, pages are read when they are accessed first. Compressed time
+    // resolved images are inflated time step by time step in the background. Everything else is read completely
+    // by ITK right now.
+    ExternalImageMemory::Pointer memory;
+    RawDataLocation location;
+    if (ndim == m_ImageIO->GetNumberOfDimensions() && GetRawDataLocation(m_ImageIO, location))
+    {
+      try
+      {
+        if (!location.m_Compressed)
+        {
+          memory = MappedImageMemory::New(location.m_File, location.m_Offset, m_ImageIO->GetImageSizeInBytes())
+                     .GetPointer();
+          MITK_DEBUG << "mapping pixel data of " << location.m_File << " at offset " << location.m_Offset;
+        }
+        else if (ndim == 4 && dimensions[3] > 1)
+        {
+          ProgressiveImageMemory::Pointer progressiveMemory =
+            ProgressiveImageMemory::New(location.m_File,
+                                        location.m_Offset,
+                                        location.m_InflatedOffset,
+                                        m_ImageIO->GetImageSizeInBytes(),
+                                        dimensions[3]);
+          // the observer is called in the loader thread, so it has to be added before that is started
+          itk::CStyleCommand::Pointer command = itk::CStyleCommand::New();
+          command->SetCallback(&RequestUpdateOnLoadedTimeStep);
+          progressiveMemory->AddObserver(itk::ProgressEvent(), command);
+          progressiveMemory->Start();
+          memory = progressiveMemory.GetPointer();
+          MITK_DEBUG << "loading " << dimensions[3] << " time steps of " << location.m_File << " in the background";
+        }
+      }
+      catch (const mitk::Exception &e)
+      {
+        MITK_WARN << "Reading image data with ITK: " << e.GetDescription();
+        memory = nullptr;
+      }
+    }
+
+    void *buffer = nullptr;
+    if (memory.IsNotNull())
+    {
+      image->SetImportChannel(memory.GetPointer(), 0);
+    }
+    else
+    {
+      buffer = new unsigned char[m_ImageIO->GetImageSizeInBytes()];
+      m_ImageIO->Read(buffer);
+      image->SetImportChannel(buffer, 0, Image::ManageMemory);
+    }
 
     const itk::MetaDataDictionary &dictionary = m_ImageIO->GetMetaDataDictionary();
 
@@ -465,6 +847,201 @@ namespace mitk
     return m_ImageIO->CanReadFile(GetLocalFileName().c_str()) ? IFileReader::Supported : IFileReader::Unsupported;
   }
 
+  /**Jobs of the threads of WriteGzipMembers(): each thread compresses every numberOfThreads-th block of a batch.*/
+  struct GzipMemberJob
+  {
+    const unsigned char *m_Data;
+    size_t m_Size;
+    size_t m_BlockSize;
+    size_t m_FirstBlock;
+    size_t m_NumberOfBlocks;
+    int m_Level;
+    std::vector<std::vector<unsigned char>> m_Members;
+    std::vector<char> m_Failed;
+  };
+
+  static ITK_THREAD_RETURN_TYPE CompressGzipMembersCallback(void *arg)
+  {
+    itk::MultiThreader::ThreadInfoStruct *info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+    GzipMemberJob *job = static_cast<GzipMemberJob *>(info->UserData);
+
+    for (size_t i = info->ThreadID; i < job->m_NumberOfBlocks; i += info->NumberOfThreads)
+    {
+      const size_t begin = (job->m_FirstBlock + i) * job->m_BlockSize;
+      const size_t size = std::min(job->m_BlockSize, job->m_Size - begin);
+
+      z_stream stream;
+      std::memset(&stream, 0, sizeof(stream));
+      // 15 + 16: maximum window size, gzip header
+      if (deflateInit2(&stream, job->m_Level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+      {
+        job->m_Failed[i] = 1;
+        continue;
+      }
+
+      std::vector<unsigned char> &member = job->m_Members[i];
+      member.resize(deflateBound(&stream, static_cast<uLong>(size)));
+      stream.next_in = const_cast<Bytef *>(job->m_Data + begin);
+      stream.avail_in = static_cast<uInt>(size);
+      stream.next_out = &member[0];
+      stream.avail_out = static_cast<uInt>(member.size());
+
+      if (deflate(&stream, Z_FINISH) == Z_STREAM_END)
+      {
+        member.resize(member.size() - stream.avail_out);
+      }
+      else
+      {
+        job->m_Failed[i] = 1;
+      }
+      deflateEnd(&stream);
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  /**Helper function that compresses [data, data + size) into independent gzip members of 1 MB input each and
+   * appends them to out. Blocks are compressed in batches by all threads of the global default number of threads,
+   * so the memory needed is bounded by a few blocks per thread. Concatenated gzip members form a valid gzip stream.*/
+  static void WriteGzipMembers(const unsigned char *data, size_t size, int level, std::ostream &out)
+  {
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    const size_t blocksPerBatch = 4 * static_cast<size_t>(threader->GetNumberOfThreads());
+
+    GzipMemberJob job;
+    job.m_Data = data;
+    job.m_Size = size;
+    job.m_BlockSize = 1024 * 1024;
+    job.m_Level = level;
+
+    const size_t numberOfBlocks = (size + job.m_BlockSize - 1) / job.m_BlockSize;
+    for (job.m_FirstBlock = 0; job.m_FirstBlock < numberOfBlocks; job.m_FirstBlock += blocksPerBatch)
+    {
+      job.m_NumberOfBlocks = std::min(blocksPerBatch, numberOfBlocks - job.m_FirstBlock);
+      job.m_Members.assign(job.m_NumberOfBlocks, std::vector<unsigned char>());
+      job.m_Failed.assign(job.m_NumberOfBlocks, 0);
+
+      threader->SetSingleMethod(CompressGzipMembersCallback, &job);
+      threader->SingleMethodExecute();
+
+      for (size_t i = 0; i < job.m_NumberOfBlocks; ++i)
+      {
+        if (job.m_Failed[i])
+        {
+          mitkThrow() << "Could not compress block " << job.m_FirstBlock + i << " with zlib level " << level;
+        }
+        out.write(reinterpret_cast<const char *>(&job.m_Members[i][0]), job.m_Members[i].size());
+      }
+    }
+
+    if (!out.good())
+    {
+      mitkThrow() << "Could not write compressed data";
+    }
+  }
+
+  /**Helper function that writes prefix, followed by the gzip compressed content of source from offset on, to
+   * target.*/
+  static void CompressFile(const std::string &source,
+                           unsigned long long offset,
+                           const std::string &prefix,
+                           const std::string &target,
+                           int level)
+  {
+    std::ofstream out(target.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!out.good())
+    {
+      mitkThrow() << "Could not open " << target << " for writing";
+    }
+    out.write(prefix.data(), prefix.size());
+
+    const unsigned long long size = itksys::SystemTools::FileLength(source) - offset;
+    if (size > 0)
+    {
+      // the file was just written, so its pages are most likely still cached
+      MappedImageMemory::Pointer content = MappedImageMemory::New(source, offset, static_cast<size_t>(size));
+      WriteGzipMembers(static_cast<const unsigned char *>(content->GetData()), content->GetSize(), level, out);
+    }
+  }
+
+  /**Helper function that changes the encoding of a NRRD header from raw to gzip. The data file, if any, is
+   * replaced by dataFile. Returns false if the header does not describe raw data.*/
+  static bool PatchNrrdHeader(std::string &header, const std::string &dataFile)
+  {
+    std::istringstream in(header);
+    std::string patched;
+    std::string line;
+    bool isRaw = false;
+    while (std::getline(in, line))
+    {
+      if (line.compare(0, 9, "encoding:") == 0)
+      {
+        isRaw = line.find("raw") != std::string::npos;
+        line = "encoding: gzip";
+      }
+      else if (line.compare(0, 10, "data file:") == 0 || line.compare(0, 9, "datafile:") == 0)
+      {
+        line = "data file: " + dataFile;
+      }
+      patched += line + "\n";
+    }
+    header = patched;
+    return isRaw;
+  }
+
+  /**Helper function that compresses the raw NRRD file written to rawPath into path. Attached headers (.nrrd) are
+   * copied into path, detached data files are replaced by a compressed data file next to the header at path.*/
+  static void CompressNrrdFile(const std::string &rawPath, const std::string &path, int level)
+  {
+    std::ifstream file(rawPath.c_str(), std::ios::in | std::ios::binary);
+    std::map<std::string, std::string> fields;
+    long long headerSize = ReadTextHeader(file, ':', "", fields);
+    if (headerSize < 0 && (fields.count("data file") || fields.count("datafile")))
+    {
+      // detached headers do not need to end with an empty line
+      headerSize = static_cast<long long>(itksys::SystemTools::FileLength(rawPath));
+    }
+    if (headerSize <= 0)
+    {
+      mitkThrow() << "Could not read the NRRD header of " << rawPath;
+    }
+
+    std::string header(static_cast<size_t>(headerSize), '\0');
+    file.clear();
+    file.seekg(0);
+    file.read(&header[0], headerSize);
+    file.close();
+
+    std::string dataFile = fields.count("data file") ? fields["data file"] : fields["datafile"];
+    std::string dataPath;
+    if (!dataFile.empty() && !ResolveDataFileName(rawPath, dataFile, dataPath))
+    {
+      mitkThrow() << "Cannot compress NRRD data stored in " << dataFile;
+    }
+
+    if (!PatchNrrdHeader(header, dataFile + ".gz"))
+    {
+      mitkThrow() << "NRRD file " << rawPath << " does not contain raw data";
+    }
+
+    if (dataFile.empty())
+    {
+      CompressFile(rawPath, static_cast<unsigned long long>(headerSize), header, path, level);
+    }
+    else
+    {
+      CompressFile(dataPath, 0, std::string(), dataPath + ".gz", level);
+      itksys::SystemTools::RemoveFile(dataPath.c_str());
+
+      std::ofstream out(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+      out.write(header.data(), header.size());
+      if (!out.good())
+      {
+        mitkThrow() << "Could not write " << path;
+      }
+    }
+  }
+
   void ItkImageIO::Write()
   {
     const mitk::Image *image = dynamic_cast<const mitk::Image *>(this->GetInput());
@@ -571,11 +1148,89 @@ namespace mitk
         ioRegion.SetIndex(i, image->GetLargestPossibleRegion().GetIndex(i));
       }
 
-      // use compression if available
-      m_ImageIO->UseCompressionOn();
+      // Handle compression
+      std::string compression = COMPRESSION_DEFAULT();
+      const us::Any compressionOption = this->GetWriterOption(OPTION_COMPRESSION());
+      if (compressionOption.Type() == typeid(std::vector<std::string>))
+      {
+        compression = us::ref_any_cast<std::vector<std::string>>(compressionOption).front();
+      }
+      else if (compressionOption.Type() == typeid(std::string))
+      {
+        compression = us::ref_any_cast<std::string>(compressionOption);
+      }
+      else if (compressionOption.Type() == typeid(const char *))
+      {
+        compression = us::ref_any_cast<const char *>(compressionOption);
+      }
+      else if (!compressionOption.Empty())
+      {
+        mitkThrow() << "Writer option \"" << OPTION_COMPRESSION() << "\" must be a string, got "
+                    << compressionOption.ToString();
+      }
+      if (compression != COMPRESSION_DEFAULT() && compression != COMPRESSION_NONE() &&
+          compression != COMPRESSION_PARALLEL())
+      {
+        mitkThrow() << "Unknown compression \"" << compression << "\", expected \"" << COMPRESSION_DEFAULT()
+                    << "\", \"" << COMPRESSION_NONE() << "\" or \"" << COMPRESSION_PARALLEL() << "\"";
+      }
+
+      int compressionLevel = DEFAULT_COMPRESSION_LEVEL;
+      const us::Any compressionLevelOption = this->GetWriterOption(OPTION_COMPRESSION_LEVEL());
+      if (compressionLevelOption.Type() == typeid(int))
+      {
+        compressionLevel = us::ref_any_cast<int>(compressionLevelOption);
+      }
+      else if (!compressionLevelOption.Empty())
+      {
+        mitkThrow() << "Writer option \"" << OPTION_COMPRESSION_LEVEL() << "\" must be an int, got "
+                    << compressionLevelOption.ToString();
+      }
+
+      // The ITK ImageIO object writes uncompressed data to writePath, which is compressed into path afterwards
+      std::string writePath = path;
+      const std::string ioName = m_ImageIO->GetNameOfClass();
+      const std::string lowerPath = itksys::SystemTools::LowerCase(path);
+      const bool isNiftiGz = ioName == "NiftiImageIO" && lowerPath.size() > 7 &&
+                             lowerPath.compare(lowerPath.size() - 7, 7, ".nii.gz") == 0;
+      const bool isDetachedNrrd =
+        ioName == "NrrdImageIO" && itksys::SystemTools::GetFilenameLastExtension(lowerPath) == ".nhdr";
+      bool compressAfterWriting = false;
+
+      if (compression == COMPRESSION_PARALLEL() && (ioName == "NrrdImageIO" || isNiftiGz))
+      {
+        if (compressionLevel < 0 || compressionLevel > 9)
+        {
+          MITK_WARN << "Invalid compression level " << compressionLevel << ", using " << DEFAULT_COMPRESSION_LEVEL;
+          compressionLevel = DEFAULT_COMPRESSION_LEVEL;
+        }
+
+        m_ImageIO->UseCompressionOff();
+        compressAfterWriting = true;
+        if (!isDetachedNrrd)
+        {
+          std::string directory = itksys::SystemTools::GetFilenamePath(path);
+          directory += directory.empty() ? "./" : "/";
+          writePath =
+            IOUtil::CreateTemporaryFile(".XXXXXX" + std::string(ioName == "NrrdImageIO" ? ".nrrd" : ".nii"), directory);
+        }
+      }
+      else if (compression == COMPRESSION_NONE())
+      {
+        m_ImageIO->UseCompressionOff();
+      }
+      else
+      {
+        if (compression == COMPRESSION_PARALLEL())
+        {
+          MITK_WARN << "Parallel compression is not supported by " << ioName << ", using its default compression";
+        }
+        // use compression if available
+        m_ImageIO->UseCompressionOn();
+      }
 
       m_ImageIO->SetIORegion(ioRegion);
-      m_ImageIO->SetFileName(path);
+      m_ImageIO->SetFileName(writePath);
 
       // Handle time geometry
       const ArbitraryTimeGeometry *arbitraryTG = dynamic_cast<const ArbitraryTimeGeometry *>(image->GetTimeGeometry());
@@ -622,8 +1277,49 @@ namespace mitk
         itk::EncapsulateMetaData<std::string>(m_ImageIO->GetMetaDataDictionary(), key, value);
       }
 
-      ImageReadAccessor imageAccess(image);
-      m_ImageIO->Write(imageAccess.GetData());
+      // Overwriting the mapped file would change the image data while it is written
+      MappedImageMemory *mappedMemory = dynamic_cast<MappedImageMemory *>(
+        const_cast<ExternalImageMemory *>(const_cast<Image *>(image)->GetChannelData()->GetExternalMemory()));
+      if (mappedMemory != nullptr && !mappedMemory->IsDetached() &&
+          itksys::SystemTools::GetFilenamePath(mappedMemory->GetFileName()) ==
+            itksys::SystemTools::GetFilenamePath(path) &&
+          itksys::SystemTools::GetFilenameWithoutExtension(mappedMemory->GetFileName()) ==
+            itksys::SystemTools::GetFilenameWithoutExtension(path))
+      {
+        ImageWriteAccessor exclusiveAccess(const_cast<Image *>(image));
+        mappedMemory->Detach();
+      }
+
+      try
+      {
+        {
+          ImageReadAccessor imageAccess(image);
+          const void *data = imageAccess.GetData();
+          m_ImageIO->Write(data);
+        }
+
+        if (compressAfterWriting && ioName == "NrrdImageIO")
+        {
+          CompressNrrdFile(writePath, path, compressionLevel);
+        }
+        else if (compressAfterWriting)
+        {
+          CompressFile(writePath, 0, std::string(), path, compressionLevel);
+        }
+      }
+      catch (...)
+      {
+        if (writePath != path)
+        {
+          itksys::SystemTools::RemoveFile(writePath.c_str());
+        }
+        throw;
+      }
+
+      if (writePath != path)
+      {
+        itksys::SystemTools::RemoveFile(writePath.c_str());
+      }
     }
     catch (const std::exception &e)
     {
@@ -668,4 +1364,17 @@ namespace mitk
     this->m_DefaultMetaDataKeys.push_back(PROPERTY_NAME_TIMEGEOMETRY_TIMEPOINTS);
     this->m_DefaultMetaDataKeys.push_back("ITK.InputFilterName");
   }
+
+  void ItkImageIO::InitializeDefaultWriterOptions()
+  {
+    std::vector<std::string> compressions;
+    compressions.push_back(COMPRESSION_DEFAULT());
+    compressions.push_back(COMPRESSION_NONE());
+    compressions.push_back(COMPRESSION_PARALLEL());
+
+    Options defaultOptions;
+    defaultOptions[OPTION_COMPRESSION()] = us::Any(compressions);
+    defaultOptions[OPTION_COMPRESSION_LEVEL()] = us::Any(DEFAULT_COMPRESSION_LEVEL);
+    this->SetDefaultWriterOptions(defaultOptions);
+  }
 }
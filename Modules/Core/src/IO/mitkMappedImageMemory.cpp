@@ -0,0 +1,186 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkMappedImageMemory.h"
+
+#include <mitkExceptionMacro.h>
+
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mitk::MappedImageMemory::MappedImageMemory(const std::string &path, unsigned long long offset, size_t size)
+  : m_FileName(path), m_Detached(false), m_View(nullptr), m_ViewSize(0), m_Data(nullptr), m_Size(size)
+{
+  if (size == 0)
+  {
+    mitkThrow() << "Cannot map an empty region of " << path;
+  }
+
+#ifdef _WIN32
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+  const unsigned long long alignedOffset = offset - offset % systemInfo.dwAllocationGranularity;
+  m_ViewSize = static_cast<size_t>(offset - alignedOffset) + size;
+
+  m_FileHandle =
+    CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (m_FileHandle == INVALID_HANDLE_VALUE)
+  {
+    mitkThrow() << "Could not open " << path << " for mapping (error " << GetLastError() << ")";
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(m_FileHandle, &fileSize) || static_cast<unsigned long long>(fileSize.QuadPart) < offset + size)
+  {
+    CloseHandle(m_FileHandle);
+    mitkThrow() << "File " << path << " is too small to hold " << size << " bytes at offset " << offset;
+  }
+
+  // copy-on-write: pages written by MITK become private copies, the file is never changed
+  m_MappingHandle = CreateFileMappingA(m_FileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  if (m_MappingHandle == nullptr)
+  {
+    CloseHandle(m_FileHandle);
+    mitkThrow() << "Could not create a file mapping for " << path << " (error " << GetLastError() << ")";
+  }
+
+  m_View = MapViewOfFile(m_MappingHandle,
+                         FILE_MAP_COPY,
+                         static_cast<DWORD>(alignedOffset >> 32),
+                         static_cast<DWORD>(alignedOffset & 0xFFFFFFFF),
+                         m_ViewSize);
+  if (m_View == nullptr)
+  {
+    CloseHandle(m_MappingHandle);
+    CloseHandle(m_FileHandle);
+    mitkThrow() << "Could not map " << size << " bytes of " << path << " (error " << GetLastError() << ")";
+  }
+#else
+  const unsigned long long pageSize = static_cast<unsigned long long>(sysconf(_SC_PAGESIZE));
+  const unsigned long long alignedOffset = offset - offset % pageSize;
+  m_ViewSize = static_cast<size_t>(offset - alignedOffset) + size;
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    mitkThrow() << "Could not open " << path << " for mapping";
+  }
+
+  struct stat fileStatus;
+  if (fstat(fd, &fileStatus) != 0 || static_cast<unsigned long long>(fileStatus.st_size) < offset + size)
+  {
+    close(fd);
+    mitkThrow() << "File " << path << " is too small to hold " << size << " bytes at offset " << offset;
+  }
+
+  // MAP_PRIVATE: pages written by MITK become private copies, the file is never changed
+  m_View = mmap(nullptr, m_ViewSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, static_cast<off_t>(alignedOffset));
+
+  // the mapping keeps its own reference to the file
+  close(fd);
+
+  if (m_View == MAP_FAILED)
+  {
+    m_View = nullptr;
+    mitkThrow() << "Could not map " << size << " bytes of " << path;
+  }
+#endif
+
+  m_Data = static_cast<unsigned char *>(m_View) + (offset - alignedOffset);
+}
+
+mitk::MappedImageMemory::~MappedImageMemory()
+{
+  // a failed Detach() has already released everything
+  if (m_View == nullptr)
+  {
+    return;
+  }
+
+#ifdef _WIN32
+  if (m_Detached)
+  {
+    VirtualFree(m_View, 0, MEM_RELEASE);
+  }
+  else
+  {
+    UnmapViewOfFile(m_View);
+    CloseHandle(m_MappingHandle);
+    CloseHandle(m_FileHandle);
+  }
+#else
+  munmap(m_View, m_ViewSize);
+#endif
+}
+
+void mitk::MappedImageMemory::Detach()
+{
+  if (m_Detached)
+  {
+    return;
+  }
+
+  // reads all pages that were not touched yet
+  std::vector<unsigned char> content(static_cast<unsigned char *>(m_View),
+                                     static_cast<unsigned char *>(m_View) + m_ViewSize);
+
+#ifdef _WIN32
+  // the buffer has to keep its address, so it can only be allocated after the view has been unmapped
+  UnmapViewOfFile(m_View);
+  CloseHandle(m_MappingHandle);
+  CloseHandle(m_FileHandle);
+  m_MappingHandle = nullptr;
+  m_FileHandle = nullptr;
+  void *memory = VirtualAlloc(m_View, m_ViewSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+  if (memory != m_View)
+  {
+    const DWORD error = GetLastError();
+    if (memory != nullptr)
+    {
+      VirtualFree(memory, 0, MEM_RELEASE);
+    }
+    // nothing is left to be released by the destructor
+    m_View = nullptr;
+    m_Data = nullptr;
+    mitkThrow() << "Could not allocate " << m_ViewSize << " bytes to detach the image data from " << m_FileName
+                << " (error " << error << ")";
+  }
+#else
+  // MAP_FIXED atomically replaces the file mapping
+  void *memory = mmap(m_View, m_ViewSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+  if (memory == MAP_FAILED)
+  {
+    memory = nullptr;
+  }
+#endif
+
+  if (memory != m_View)
+  {
+    mitkThrow() << "Could not allocate " << m_ViewSize << " bytes to detach the image data from " << m_FileName;
+  }
+
+  std::memcpy(m_View, &content[0], m_ViewSize);
+  m_Detached = true;
+}
@@ -28,3 +28,12 @@ mitk::OperationType mitk::Operation::GetOperationType()
 {
   return m_OperationType;
 }
+
+std::size_t mitk::Operation::GetMemoryCost()
+{
+  return 0;
+}
+
+void mitk::Operation::ReleaseMemory()
+{
+}
@@ -0,0 +1,271 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkProgressiveImageMemory.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkLogMacros.h>
+
+#include <itkEventObject.h>
+#include <itkMutexLockHolder.h>
+
+#include "itk_zlib.h"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+mitk::ProgressiveImageMemory::ProgressiveImageMemory(const std::string &fileName,
+                                                     unsigned long long compressedOffset,
+                                                     unsigned long long uncompressedOffset,
+                                                     size_t size,
+                                                     unsigned int numberOfTimeSteps)
+  : m_FileName(fileName),
+    m_CompressedOffset(compressedOffset),
+    m_UncompressedOffset(uncompressedOffset),
+    m_Data(nullptr),
+    m_Size(size),
+    m_TimeStepSize(0),
+    m_NumberOfTimeSteps(numberOfTimeSteps),
+    m_TimeStepLoaded(itk::ConditionVariable::New()),
+    m_NumberOfLoadedTimeSteps(0),
+    m_Failed(false),
+    m_Abort(false),
+    m_MultiThreader(itk::MultiThreader::New()),
+    m_ThreadID(-1)
+{
+  if (m_Size == 0 || m_NumberOfTimeSteps == 0 || m_Size % m_NumberOfTimeSteps != 0)
+  {
+    mitkThrow() << "Invalid layout of " << m_Size << " bytes in " << m_NumberOfTimeSteps << " time steps";
+  }
+  m_TimeStepSize = m_Size / m_NumberOfTimeSteps;
+  m_Data = new unsigned char[m_Size];
+}
+
+mitk::ProgressiveImageMemory::~ProgressiveImageMemory()
+{
+  this->StopLoading();
+  delete[] m_Data;
+}
+
+void mitk::ProgressiveImageMemory::Start()
+{
+  if (m_ThreadID >= 0)
+    return;
+
+  m_ThreadID = m_MultiThreader->SpawnThread(this->LoaderThread, this);
+
+  // the first time step is needed for displaying the image anyway
+  try
+  {
+    this->WaitUntilAvailable(m_Data, m_Data + m_TimeStepSize);
+  }
+  catch (...)
+  {
+    this->StopLoading();
+    throw;
+  }
+}
+
+void mitk::ProgressiveImageMemory::StopLoading()
+{
+  if (m_ThreadID >= 0)
+  {
+    m_Mutex.Lock();
+    m_Abort = true;
+    m_Mutex.Unlock();
+
+    m_MultiThreader->TerminateThread(m_ThreadID);
+    m_ThreadID = -1;
+  }
+}
+
+ITK_THREAD_RETURN_TYPE mitk::ProgressiveImageMemory::LoaderThread(void *pInfoStruct)
+{
+  /* extract this pointer from Thread Info structure */
+  struct itk::MultiThreader::ThreadInfoStruct *pInfo = (struct itk::MultiThreader::ThreadInfoStruct *)pInfoStruct;
+  if (pInfo == nullptr || pInfo->UserData == nullptr)
+  {
+    return ITK_THREAD_RETURN_VALUE;
+  }
+  ProgressiveImageMemory *memory = static_cast<ProgressiveImageMemory *>(pInfo->UserData);
+
+  try
+  {
+    memory->Load();
+  }
+  catch (const mitk::Exception &e)
+  {
+    MITK_ERROR << e.GetDescription();
+
+    itk::MutexLockHolder<itk::SimpleMutexLock> lock(memory->m_Mutex);
+    memory->m_Failed = true;
+    memory->m_ErrorMessage = e.GetDescription();
+    memory->m_TimeStepLoaded->Broadcast();
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+void mitk::ProgressiveImageMemory::Load()
+{
+  std::ifstream file(m_FileName.c_str(), std::ios::in | std::ios::binary);
+  file.seekg(static_cast<std::streamoff>(m_CompressedOffset));
+  if (!file.good())
+  {
+    mitkThrow() << "Could not open " << m_FileName << " at offset " << m_CompressedOffset;
+  }
+
+  z_stream stream;
+  stream.zalloc = Z_NULL;
+  stream.zfree = Z_NULL;
+  stream.opaque = Z_NULL;
+  stream.avail_in = 0;
+  stream.next_in = Z_NULL;
+
+  // 15 + 32: maximum window size, detect zlib and gzip headers automatically
+  if (inflateInit2(&stream, 15 + 32) != Z_OK)
+  {
+    mitkThrow() << "Could not initialize zlib for reading " << m_FileName;
+  }
+
+  // inflate in chunks of at most this size, so that the abort flag is checked regularly
+  const size_t maximumChunkSize = 4 * 1024 * 1024;
+
+  std::vector<unsigned char> input(1024 * 1024);
+  std::vector<unsigned char> skipped(64 * 1024);
+  unsigned long long remainingSkip = m_UncompressedOffset;
+  size_t written = 0;
+  unsigned int loadedTimeSteps = 0;
+
+  while (written < m_Size)
+  {
+    {
+      itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+      if (m_Abort)
+        break;
+    }
+
+    if (stream.avail_in == 0)
+    {
+      file.read(reinterpret_cast<char *>(&input[0]), input.size());
+      stream.avail_in = static_cast<uInt>(file.gcount());
+      stream.next_in = &input[0];
+      if (stream.avail_in == 0)
+      {
+        inflateEnd(&stream);
+        mitkThrow() << "Unexpected end of compressed data in " << m_FileName << " after " << written << " of "
+                    << m_Size << " bytes";
+      }
+    }
+
+    // the header part of the inflated stream (e.g. of .nii.gz files) is inflated into a scratch buffer
+    size_t chunkSize;
+    if (remainingSkip > 0)
+    {
+      chunkSize = static_cast<size_t>(std::min<unsigned long long>(remainingSkip, skipped.size()));
+      stream.next_out = &skipped[0];
+    }
+    else
+    {
+      chunkSize = std::min(m_Size - written, maximumChunkSize);
+      stream.next_out = m_Data + written;
+    }
+    stream.avail_out = static_cast<uInt>(chunkSize);
+
+    int result = inflate(&stream, Z_NO_FLUSH);
+    const size_t produced = chunkSize - stream.avail_out;
+
+    if (remainingSkip > 0)
+      remainingSkip -= produced;
+    else
+      written += produced;
+
+    if (result == Z_STREAM_END)
+    {
+      // data written by independent compressors consists of several concatenated gzip members
+      if (written < m_Size)
+      {
+        inflateReset(&stream);
+      }
+    }
+    else if (result != Z_OK && !(result == Z_BUF_ERROR && (produced > 0 || stream.avail_in == 0)))
+    {
+      std::string message = stream.msg != Z_NULL ? stream.msg : "unknown error";
+      inflateEnd(&stream);
+      mitkThrow() << "Could not inflate " << m_FileName << ": " << message;
+    }
+
+    const unsigned int completeTimeSteps = static_cast<unsigned int>(written / m_TimeStepSize);
+    if (completeTimeSteps > loadedTimeSteps)
+    {
+      loadedTimeSteps = completeTimeSteps;
+      {
+        itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+        m_NumberOfLoadedTimeSteps = loadedTimeSteps;
+        m_TimeStepLoaded->Broadcast();
+      }
+      this->InvokeEvent(itk::ProgressEvent());
+    }
+  }
+
+  inflateEnd(&stream);
+}
+
+unsigned int mitk::ProgressiveImageMemory::GetNumberOfLoadedTimeSteps() const
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  return m_NumberOfLoadedTimeSteps;
+}
+
+unsigned int mitk::ProgressiveImageMemory::GetRequiredTimeSteps(const void *begin, const void *end) const
+{
+  const unsigned char *first = static_cast<const unsigned char *>(begin);
+  const unsigned char *last = static_cast<const unsigned char *>(end);
+  if (last <= first || last <= m_Data || first >= m_Data + m_Size)
+  {
+    return 0;
+  }
+  if (last > m_Data + m_Size)
+  {
+    last = m_Data + m_Size;
+  }
+  return static_cast<unsigned int>((last - 1 - m_Data) / m_TimeStepSize) + 1;
+}
+
+bool mitk::ProgressiveImageMemory::IsAvailable(const void *begin, const void *end) const
+{
+  return this->GetRequiredTimeSteps(begin, end) <= this->GetNumberOfLoadedTimeSteps();
+}
+
+void mitk::ProgressiveImageMemory::WaitUntilAvailable(const void *begin, const void *end) const
+{
+  const unsigned int required = this->GetRequiredTimeSteps(begin, end);
+
+  m_Mutex.Lock();
+  while (m_NumberOfLoadedTimeSteps < required && !m_Failed)
+  {
+    m_TimeStepLoaded->Wait(&m_Mutex);
+  }
+  const bool available = m_NumberOfLoadedTimeSteps >= required;
+  const std::string errorMessage = m_ErrorMessage;
+  m_Mutex.Unlock();
+
+  if (!available)
+  {
+    mitkThrow() << "Image data is not available, loading " << m_FileName << " failed: " << errorMessage;
+  }
+}
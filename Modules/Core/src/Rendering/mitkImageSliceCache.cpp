@@ -0,0 +1,553 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkImageSliceCache.h"
+
+#include <mitkBaseRenderer.h>
+#include <mitkExceptionMacro.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkLogMacros.h>
+#include <mitkRenderingManager.h>
+
+#include "vtkMitkThickSlicesFilter.h"
+
+#include <itkMutexLockHolder.h>
+
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPolyData.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+  /** Tolerance in mm for comparing plane positions and axes */
+  const mitk::ScalarType PLANE_TOLERANCE = 1e-4;
+
+  /** Prefetch requests beyond this number are dropped, the oldest first */
+  const size_t MAXIMUM_NUMBER_OF_JOBS = 16;
+}
+
+mitk::ImageSliceCache::Request::Request()
+  : InputMTime(0),
+    TimeStep(0),
+    Interpolation(ExtractSliceFilter::RESLICE_NEAREST),
+    InPlaneResampleExtentByGeometry(false),
+    ThickSlicesMode(0),
+    ThickSlicesNum(1),
+    ThickSlicesSpacing(1.0)
+{
+}
+
+mitk::ImageSliceCache::Slice::Slice() : OutlineDepth(0.0f)
+{
+  std::fill(Bounds, Bounds + 6, 0.0);
+  std::fill(Spacing, Spacing + 2, 1.0);
+}
+
+mitk::ImageSliceCache::Key::Key()
+  : Input(nullptr),
+    InputMTime(0),
+    TimeStep(0),
+    Interpolation(ExtractSliceFilter::RESLICE_NEAREST),
+    InPlaneResampleExtentByGeometry(false),
+    ThickSlicesMode(0),
+    ThickSlicesNum(1),
+    ThickSlicesSpacing(1.0)
+{
+  Origin.Fill(0.0);
+  Axis0.Fill(0.0);
+  Axis1.Fill(0.0);
+}
+
+mitk::ImageSliceCache::Key::Key(const Request &request)
+  : Input(request.Input.GetPointer()),
+    InputMTime(request.InputMTime),
+    Origin(request.WorldGeometry->GetOrigin()),
+    Axis0(request.WorldGeometry->GetAxisVector(0)),
+    Axis1(request.WorldGeometry->GetAxisVector(1)),
+    TimeStep(request.TimeStep),
+    Interpolation(request.Interpolation),
+    InPlaneResampleExtentByGeometry(request.InPlaneResampleExtentByGeometry),
+    ThickSlicesMode(request.ThickSlicesMode),
+    ThickSlicesNum(request.ThickSlicesMode > 0 ? request.ThickSlicesNum : 1),
+    ThickSlicesSpacing(request.ThickSlicesMode > 0 ? request.ThickSlicesSpacing : 1.0)
+{
+}
+
+bool mitk::ImageSliceCache::Key::IsParallelTo(const Key &other) const
+{
+  if (Input != other.Input || InputMTime != other.InputMTime || TimeStep != other.TimeStep ||
+      Interpolation != other.Interpolation || InPlaneResampleExtentByGeometry != other.InPlaneResampleExtentByGeometry ||
+      ThickSlicesMode != other.ThickSlicesMode || ThickSlicesNum != other.ThickSlicesNum ||
+      ThickSlicesSpacing != other.ThickSlicesSpacing)
+  {
+    return false;
+  }
+
+  if (!mitk::Equal(Axis0, other.Axis0, PLANE_TOLERANCE) || !mitk::Equal(Axis1, other.Axis1, PLANE_TOLERANCE))
+  {
+    return false;
+  }
+
+  // the planes may only be shifted along their normal
+  const Vector3D shift = other.Origin - Origin;
+  return std::abs(shift * Axis0) <= PLANE_TOLERANCE * Axis0.GetNorm() &&
+         std::abs(shift * Axis1) <= PLANE_TOLERANCE * Axis1.GetNorm();
+}
+
+bool mitk::ImageSliceCache::Key::operator==(const Key &other) const
+{
+  return this->IsParallelTo(other) && mitk::Equal(Origin, other.Origin, PLANE_TOLERANCE);
+}
+
+mitk::ImageSliceCache::ImageSliceCache()
+  : m_JobsAvailable(itk::ConditionVariable::New()),
+    m_MaximumNumberOfSlices(16),
+    m_JobRunning(false),
+    m_Abort(false),
+    m_MultiThreader(itk::MultiThreader::New()),
+    m_ThreadID(-1)
+{
+}
+
+mitk::ImageSliceCache::~ImageSliceCache()
+{
+  this->StopWorker();
+}
+
+void mitk::ImageSliceCache::StopWorker()
+{
+  if (m_ThreadID >= 0)
+  {
+    {
+      itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+      m_Abort = true;
+      m_Jobs.clear();
+      m_JobsAvailable->Broadcast();
+    }
+
+    m_MultiThreader->TerminateThread(m_ThreadID);
+    m_ThreadID = -1;
+  }
+}
+
+mitk::ImageSliceCache::Slice::Pointer mitk::ImageSliceCache::Reslice(const Request &request,
+                                                                     ExtractSliceFilter *reslicer,
+                                                                     vtkMitkThickSlicesFilter *thickSlicesFilter)
+{
+  reslicer->SetInput(request.Input);
+  reslicer->SetWorldGeometry(request.WorldGeometry);
+  reslicer->SetTimeStep(request.TimeStep);
+
+  // set the transformation of the image to adapt reslice axis
+  reslicer->SetResliceTransformByGeometry(request.Input->GetTimeGeometry()->GetGeometryForTimeStep(request.TimeStep));
+  reslicer->SetInPlaneResampleExtentByGeometry(request.InPlaneResampleExtentByGeometry);
+  reslicer->SetInterpolationMode(request.Interpolation);
+
+  // set the vtk output property to true, makes sure that no unneeded mitk image convertion
+  // is done.
+  reslicer->SetVtkOutputRequest(true);
+
+  vtkImageData *output = nullptr;
+  if (request.ThickSlicesMode > 0)
+  {
+    reslicer->SetOutputDimensionality(3);
+    reslicer->SetOutputSpacingZDirection(request.ThickSlicesSpacing);
+    reslicer->SetOutputExtentZDirection(-request.ThickSlicesNum, 0 + request.ThickSlicesNum);
+
+    // Do the reslicing. Modified() is called to make sure that the reslicer is
+    // executed even though the input geometry information did not change; this
+    // is necessary when the input /em data, but not the /em geometry changes.
+    thickSlicesFilter->SetThickSliceMode(request.ThickSlicesMode - 1);
+    thickSlicesFilter->SetInputData(reslicer->GetVtkOutput());
+
+    // vtkFilter=>mitkFilter=>vtkFilter update mechanism will fail without calling manually
+    reslicer->Modified();
+    reslicer->Update();
+
+    thickSlicesFilter->Modified();
+    thickSlicesFilter->Update();
+    output = thickSlicesFilter->GetOutput();
+  }
+  else
+  {
+    // this is needed when thick mode was enable bevore. These variable have to be reset to default values
+    reslicer->SetOutputDimensionality(2);
+    reslicer->SetOutputSpacingZDirection(1.0);
+    reslicer->SetOutputExtentZDirection(0, 0);
+
+    reslicer->Modified();
+    // start the pipeline with updating the largest possible, needed if the geometry of the input has changed
+    reslicer->UpdateLargestPossibleRegion();
+    output = reslicer->GetVtkOutput();
+  }
+
+  // the filters overwrite their outputs with the next slice
+  Slice::Pointer slice = Slice::New();
+  slice->Image = vtkSmartPointer<vtkImageData>::New();
+  slice->Image->DeepCopy(output);
+
+  // Bounds information for reslicing (only reuqired if reference geometry
+  // is present)
+  // this used for generating a vtkPLaneSource with the right size
+  reslicer->GetClippedPlaneBounds(slice->Bounds);
+
+  // get the spacing of the slice
+  slice->Spacing[0] = reslicer->GetOutputSpacing()[0];
+  slice->Spacing[1] = reslicer->GetOutputSpacing()[1];
+
+  slice->ResliceAxes = vtkSmartPointer<vtkMatrix4x4>::New();
+  slice->ResliceAxes->DeepCopy(reslicer->GetResliceAxes());
+
+  return slice;
+}
+
+bool mitk::ImageSliceCache::IsSameSlice(const Request &first, const Request &second)
+{
+  if (first.Input.IsNull() || second.Input.IsNull() || first.WorldGeometry.IsNull() || second.WorldGeometry.IsNull())
+  {
+    return false;
+  }
+  return Key(first) == Key(second);
+}
+
+mitk::ImageSliceCache::Slice::Pointer mitk::ImageSliceCache::Get(const Request &request)
+{
+  const Key key(request);
+  std::vector<Image::ConstPointer> releasedInputs;
+
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  // every rendered slice is looked up first, so finished jobs release their inputs soon in the rendering thread
+  releasedInputs.swap(m_ReleasedInputs);
+  for (auto it = m_Entries.begin(); it != m_Entries.end(); ++it)
+  {
+    if (it->SliceKey == key)
+    {
+      // move to the front, the list is ordered by the last use
+      m_Entries.splice(m_Entries.begin(), m_Entries, it);
+      return m_Entries.front().CachedSlice;
+    }
+  }
+  return nullptr;
+}
+
+mitk::ImageSliceCache::Slice::Pointer mitk::ImageSliceCache::GetNearest(const Request &request)
+{
+  const Key key(request);
+  const Vector3D normal = request.WorldGeometry->GetNormal();
+
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  const Entry *nearest = nullptr;
+  ScalarType nearestDistance = std::numeric_limits<ScalarType>::max();
+  for (const auto &entry : m_Entries)
+  {
+    if (entry.SliceKey.IsParallelTo(key))
+    {
+      const ScalarType distance = std::abs((entry.SliceKey.Origin - key.Origin) * normal);
+      if (distance < nearestDistance)
+      {
+        nearestDistance = distance;
+        nearest = &entry;
+      }
+    }
+  }
+
+  if (nearest == nullptr)
+  {
+    return nullptr;
+  }
+
+  Slice::Pointer slice = Slice::New();
+  slice->Image = nearest->CachedSlice->Image;
+  std::copy(nearest->CachedSlice->Bounds, nearest->CachedSlice->Bounds + 6, slice->Bounds);
+  std::copy(nearest->CachedSlice->Spacing, nearest->CachedSlice->Spacing + 2, slice->Spacing);
+  slice->Outline = nearest->CachedSlice->Outline;
+  slice->OutlineDepth = nearest->CachedSlice->OutlineDepth;
+
+  // the planes are parallel, so moving the origin of the reslice axes places the slice on the requested plane
+  const Vector3D shift = key.Origin - nearest->SliceKey.Origin;
+  slice->ResliceAxes = vtkSmartPointer<vtkMatrix4x4>::New();
+  slice->ResliceAxes->DeepCopy(nearest->CachedSlice->ResliceAxes);
+  for (int i = 0; i < 3; ++i)
+  {
+    slice->ResliceAxes->SetElement(i, 3, slice->ResliceAxes->GetElement(i, 3) + shift[i]);
+  }
+
+  return slice;
+}
+
+void mitk::ImageSliceCache::Add(const Request &request, Slice *slice)
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  this->AddLocked(Key(request), slice);
+}
+
+void mitk::ImageSliceCache::AddLocked(const Key &key, Slice *slice)
+{
+  for (auto it = m_Entries.begin(); it != m_Entries.end(); ++it)
+  {
+    if (it->SliceKey == key)
+    {
+      m_Entries.erase(it);
+      break;
+    }
+  }
+
+  Entry entry;
+  entry.SliceKey = key;
+  entry.CachedSlice = slice;
+  m_Entries.push_front(entry);
+
+  while (m_Entries.size() > m_MaximumNumberOfSlices)
+  {
+    m_Entries.pop_back();
+  }
+}
+
+void mitk::ImageSliceCache::Prefetch(const Request &request, vtkRenderWindow *renderWindowToUpdate)
+{
+  const Key key(request);
+
+  {
+    itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+    for (const auto &entry : m_Entries)
+    {
+      if (entry.SliceKey == key)
+        return;
+    }
+    if (m_JobRunning && m_RunningJob.SliceKey == key)
+    {
+      if (renderWindowToUpdate != nullptr)
+      {
+        m_RunningJob.RenderWindowToUpdate = renderWindowToUpdate;
+        m_RunningJob.RenderingManagerToUpdate = BaseRenderer::GetInstance(renderWindowToUpdate)->GetRenderingManager();
+      }
+      return;
+    }
+    for (auto &job : m_Jobs)
+    {
+      if (job.SliceKey == key)
+      {
+        if (renderWindowToUpdate != nullptr)
+        {
+          job.RenderWindowToUpdate = renderWindowToUpdate;
+          job.RenderingManagerToUpdate = BaseRenderer::GetInstance(renderWindowToUpdate)->GetRenderingManager();
+        }
+        return;
+      }
+    }
+  }
+
+  Job job;
+  job.SliceKey = key;
+  job.Source = request.Input;
+  job.RenderWindowToUpdate = renderWindowToUpdate;
+  if (renderWindowToUpdate != nullptr)
+  {
+    job.RenderingManagerToUpdate = BaseRenderer::GetInstance(renderWindowToUpdate)->GetRenderingManager();
+  }
+
+  // The worker must not call GetVtkImageData() of the input, which creates the vtkImageData of the volume on
+  // first use. It reslices an image of its own that references the pixels of the requested time step.
+  job.SourceVolume = const_cast<Image *>(request.Input.GetPointer())->GetVolumeData(request.TimeStep);
+  if (job.SourceVolume.IsNull())
+  {
+    return;
+  }
+
+  Image::Pointer volume = Image::New();
+  try
+  {
+    ImageReadAccessor sourceAccess(request.Input, job.SourceVolume, ImageAccessorBase::ExceptionIfLocked);
+    volume->Initialize(request.Input->GetPixelType(), *request.Input->GetGeometry(request.TimeStep));
+    volume->SetImportVolume(const_cast<void *>(sourceAccess.GetData()), 0, 0, Image::ReferenceMemory);
+  }
+  catch (const mitk::Exception &)
+  {
+    // the volume is being written, the slice will be computed when it is displayed
+    return;
+  }
+
+  job.VolumeRequest = request;
+  job.VolumeRequest.Input = volume.GetPointer();
+  job.VolumeRequest.TimeStep = 0;
+  job.VolumeRequest.WorldGeometry = request.WorldGeometry->Clone().GetPointer();
+
+  std::vector<Image::ConstPointer> releasedInputs;
+  std::vector<Job> droppedJobs;
+
+  {
+    itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+    // the latest requests are the most relevant ones while scrolling
+    m_Jobs.push_front(job);
+    while (m_Jobs.size() > MAXIMUM_NUMBER_OF_JOBS)
+    {
+      // drop the oldest prefetch request
+      droppedJobs.push_back(m_Jobs.back());
+      m_Jobs.pop_back();
+    }
+    m_JobsAvailable->Signal();
+
+    // images must not be destroyed by the worker, see ProcessJobs()
+    releasedInputs.swap(m_ReleasedInputs);
+
+    if (m_ThreadID < 0)
+    {
+      m_Abort = false;
+      m_ThreadID = m_MultiThreader->SpawnThread(this->WorkerThread, this);
+    }
+  }
+
+  // views waiting for a dropped slice compute it themselves when they are rendered
+  for (const auto &droppedJob : droppedJobs)
+  {
+    if (droppedJob.RenderWindowToUpdate != nullptr)
+    {
+      droppedJob.RenderingManagerToUpdate->RequestUpdate(droppedJob.RenderWindowToUpdate);
+    }
+  }
+}
+
+bool mitk::ImageSliceCache::IsPending(const Request &request)
+{
+  const Key key(request);
+
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  if (m_JobRunning && m_RunningJob.SliceKey == key)
+  {
+    return true;
+  }
+  for (const auto &job : m_Jobs)
+  {
+    if (job.SliceKey == key)
+      return true;
+  }
+  return false;
+}
+
+void mitk::ImageSliceCache::Clear()
+{
+  std::vector<Image::ConstPointer> releasedInputs;
+
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  m_Entries.clear();
+  m_Jobs.clear();
+  releasedInputs.swap(m_ReleasedInputs);
+}
+
+void mitk::ImageSliceCache::SetMaximumNumberOfSlices(unsigned int maximumNumberOfSlices)
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  m_MaximumNumberOfSlices = std::max(1u, maximumNumberOfSlices);
+  while (m_Entries.size() > m_MaximumNumberOfSlices)
+  {
+    m_Entries.pop_back();
+  }
+}
+
+unsigned int mitk::ImageSliceCache::GetMaximumNumberOfSlices()
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  return m_MaximumNumberOfSlices;
+}
+
+unsigned int mitk::ImageSliceCache::GetNumberOfSlices()
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  return static_cast<unsigned int>(m_Entries.size());
+}
+
+ITK_THREAD_RETURN_TYPE mitk::ImageSliceCache::WorkerThread(void *pInfoStruct)
+{
+  /* extract this pointer from Thread Info structure */
+  struct itk::MultiThreader::ThreadInfoStruct *pInfo = (struct itk::MultiThreader::ThreadInfoStruct *)pInfoStruct;
+  if (pInfo == nullptr || pInfo->UserData == nullptr)
+  {
+    return ITK_THREAD_RETURN_VALUE;
+  }
+  static_cast<ImageSliceCache *>(pInfo->UserData)->ProcessJobs();
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+void mitk::ImageSliceCache::ProcessJobs()
+{
+  ExtractSliceFilter::Pointer reslicer = ExtractSliceFilter::New();
+  vtkSmartPointer<vtkMitkThickSlicesFilter> thickSlicesFilter = vtkSmartPointer<vtkMitkThickSlicesFilter>::New();
+
+  m_Mutex.Lock();
+  while (!m_Abort)
+  {
+    if (m_Jobs.empty())
+    {
+      m_JobsAvailable->Wait(&m_Mutex);
+      continue;
+    }
+
+    Job job = m_Jobs.front();
+    m_Jobs.pop_front();
+    m_JobRunning = true;
+    // only the key and the render window to update are used, Prefetch() may change the latter meanwhile
+    m_RunningJob.SliceKey = job.SliceKey;
+    m_RunningJob.RenderWindowToUpdate = job.RenderWindowToUpdate;
+    m_RunningJob.RenderingManagerToUpdate = job.RenderingManagerToUpdate;
+    m_Mutex.Unlock();
+
+    Slice::Pointer slice;
+    try
+    {
+      // do not wait for writers, the GUI thread might be waiting for this thread while holding a write accessor
+      ImageReadAccessor sourceAccess(job.Source, job.SourceVolume, ImageAccessorBase::ExceptionIfLocked);
+      slice = Reslice(job.VolumeRequest, reslicer, thickSlicesFilter);
+    }
+    catch (const mitk::Exception &e)
+    {
+      MITK_DEBUG << "Slice is not prefetched: " << e.GetDescription();
+    }
+    catch (const itk::ExceptionObject &e)
+    {
+      MITK_DEBUG << "Slice is not prefetched: " << e.GetDescription();
+    }
+
+    // release the references to the private volume outside of the lock
+    reslicer->SetInput(nullptr);
+    reslicer->SetWorldGeometry(nullptr);
+    job.VolumeRequest = Request();
+    job.SourceVolume = nullptr;
+
+    m_Mutex.Lock();
+    m_JobRunning = false;
+
+    // the input might have been removed meanwhile, destroying it here would notify its observers in this thread
+    m_ReleasedInputs.push_back(job.Source);
+    job.Source = nullptr;
+
+    if (slice.IsNotNull() && !m_Abort)
+    {
+      this->AddLocked(job.SliceKey, slice);
+    }
+    if (m_RunningJob.RenderWindowToUpdate != nullptr && !m_Abort)
+    {
+      m_RunningJob.RenderingManagerToUpdate->RequestUpdateFromBackgroundThread(m_RunningJob.RenderWindowToUpdate);
+    }
+    m_RunningJob.RenderWindowToUpdate = nullptr;
+    m_RunningJob.RenderingManagerToUpdate = nullptr;
+  }
+  m_Mutex.Unlock();
+}
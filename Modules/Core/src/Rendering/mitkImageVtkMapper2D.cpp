@@ -59,6 +59,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkRGBAPixel.h>
 #include <mitkRenderingModeProperty.h>
 
+#include <algorithm>
+
 mitk::ImageVtkMapper2D::ImageVtkMapper2D()
 {
 }
@@ -150,153 +152,86 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
     return;
   }
 
-  // set main input for ExtractSliceFilter
-  localStorage->m_Reslicer->SetInput(image);
-  localStorage->m_Reslicer->SetWorldGeometry(worldGeometry);
-  localStorage->m_Reslicer->SetTimeStep(this->GetTimestep());
-
-  // set the transformation of the image to adapt reslice axis
-  localStorage->m_Reslicer->SetResliceTransformByGeometry(
-    image->GetTimeGeometry()->GetGeometryForTimeStep(this->GetTimestep()));
-
-  // is the geometry of the slice based on the input image or the worldgeometry?
-  bool inPlaneResampleExtentByGeometry = false;
-  datanode->GetBoolProperty("in plane resample extent by geometry", inPlaneResampleExtentByGeometry, renderer);
-  localStorage->m_Reslicer->SetInPlaneResampleExtentByGeometry(inPlaneResampleExtentByGeometry);
+  // time steps that are still loaded in the background are not displayed yet, Update() checks again
+  localStorage->m_WaitingForTimeStep = !image->IsTimeStepAvailable(this->GetTimestep());
+  if (localStorage->m_WaitingForTimeStep)
+  {
+    localStorage->m_ReslicedImage = NULL;
+    localStorage->m_Mapper->SetInputData(localStorage->m_EmptyPolyData);
+    return;
+  }
 
-  // Initialize the interpolation mode for resampling; switch to nearest
-  // neighbor if the input image is too small.
-  if ((image->GetDimension() >= 3) && (image->GetDimension(2) > 1))
+  ImageSliceCache::Request request;
+  if (!this->GetSliceRequest(renderer, worldGeometry, this->GetTimestep(), request))
   {
-    VtkResliceInterpolationProperty *resliceInterpolationProperty;
-    datanode->GetProperty(resliceInterpolationProperty, "reslice interpolation", renderer);
+    return; // no fitting geometry set
+  }
 
-    int interpolationMode = VTK_RESLICE_NEAREST;
-    if (resliceInterpolationProperty != NULL)
-    {
-      interpolationMode = resliceInterpolationProperty->GetInterpolation();
-    }
+  // Slices of curved planes are not cached, their plane does not identify them.
+  const bool cacheable = dynamic_cast<const AbstractTransformGeometry *>(worldGeometry) == nullptr;
 
-    switch (interpolationMode)
-    {
-      case VTK_RESLICE_NEAREST:
-        localStorage->m_Reslicer->SetInterpolationMode(ExtractSliceFilter::RESLICE_NEAREST);
-        break;
-      case VTK_RESLICE_LINEAR:
-        localStorage->m_Reslicer->SetInterpolationMode(ExtractSliceFilter::RESLICE_LINEAR);
-        break;
-      case VTK_RESLICE_CUBIC:
-        localStorage->m_Reslicer->SetInterpolationMode(ExtractSliceFilter::RESLICE_CUBIC);
-        break;
-    }
-  }
-  else
+  ImageSliceCache::Slice::Pointer slice;
+  if (cacheable)
   {
-    localStorage->m_Reslicer->SetInterpolationMode(ExtractSliceFilter::RESLICE_NEAREST);
+    slice = localStorage->m_SliceCache->Get(request);
   }
 
-  // set the vtk output property to true, makes sure that no unneeded mitk image convertion
-  // is done.
-  localStorage->m_Reslicer->SetVtkOutputRequest(true);
-
-  // Thickslicing
-  int thickSlicesMode = 0;
-  int thickSlicesNum = 1;
-  // Thick slices parameters
-  if (image->GetPixelType().GetNumberOfComponents() == 1) // for now only single component are allowed
+  if (slice.IsNull())
   {
-    DataNode *dn = renderer->GetCurrentWorldPlaneGeometryNode();
-    if (dn)
-    {
-      ResliceMethodProperty *resliceMethodEnumProperty = 0;
+    bool showNearestSlice = false;
+    datanode->GetBoolProperty("Image Rendering.Show nearest cached slice", showNearestSlice, renderer);
 
-      if (dn->GetProperty(resliceMethodEnumProperty, "reslice.thickslices", renderer) && resliceMethodEnumProperty)
-        thickSlicesMode = resliceMethodEnumProperty->GetValueAsId();
+    // if the background reslicing of this slice finished without result, it is resliced right here
+    const bool backgroundReslicingFailed = localStorage->m_ShowingNearestSlice &&
+                                           ImageSliceCache::IsSameSlice(request, localStorage->m_NearestSliceRequest) &&
+                                           !localStorage->m_SliceCache->IsPending(request);
 
-      IntProperty *intProperty = 0;
-      if (dn->GetProperty(intProperty, "reslice.thickslices.num", renderer) && intProperty)
+    if (cacheable && showNearestSlice && !backgroundReslicingFailed)
+    {
+      slice = localStorage->m_SliceCache->GetNearest(request);
+      if (slice.IsNotNull())
       {
-        thickSlicesNum = intProperty->GetValue();
-        if (thickSlicesNum < 1)
-          thickSlicesNum = 1;
+        // Update() regenerates as soon as the slice is not pending anymore
+        localStorage->m_SliceCache->Prefetch(request, renderer->GetRenderWindow());
       }
     }
-    else
-    {
-      MITK_WARN << "no associated widget plane data tree node found";
-    }
-  }
-
-  const PlaneGeometry *planeGeometry = dynamic_cast<const PlaneGeometry *>(worldGeometry);
-
-  if (thickSlicesMode > 0)
-  {
-    double dataZSpacing = 1.0;
 
-    Vector3D normInIndex, normal;
+    localStorage->m_ShowingNearestSlice = slice.IsNotNull();
+    localStorage->m_NearestSliceRequest = slice.IsNotNull() ? request : ImageSliceCache::Request();
 
-    const mitk::AbstractTransformGeometry *abstractGeometry =
-      dynamic_cast<const AbstractTransformGeometry *>(worldGeometry);
-    if (abstractGeometry != NULL)
-      normal = abstractGeometry->GetPlane()->GetNormal();
-    else
+    if (slice.IsNull())
     {
-      if (planeGeometry != NULL)
+      slice = ImageSliceCache::Reslice(request, localStorage->m_Reslicer, localStorage->m_TSFilter);
+      if (cacheable)
       {
-        normal = planeGeometry->GetNormal();
+        localStorage->m_SliceCache->Add(request, slice);
       }
-      else
-        return; // no fitting geometry set
     }
-    normal.Normalize();
-
-    image->GetTimeGeometry()->GetGeometryForTimeStep(this->GetTimestep())->WorldToIndex(normal, normInIndex);
-
-    dataZSpacing = 1.0 / normInIndex.GetNorm();
-
-    localStorage->m_Reslicer->SetOutputDimensionality(3);
-    localStorage->m_Reslicer->SetOutputSpacingZDirection(dataZSpacing);
-    localStorage->m_Reslicer->SetOutputExtentZDirection(-thickSlicesNum, 0 + thickSlicesNum);
-
-    // Do the reslicing. Modified() is called to make sure that the reslicer is
-    // executed even though the input geometry information did not change; this
-    // is necessary when the input /em data, but not the /em geometry changes.
-    localStorage->m_TSFilter->SetThickSliceMode(thickSlicesMode - 1);
-    localStorage->m_TSFilter->SetInputData(localStorage->m_Reslicer->GetVtkOutput());
-
-    // vtkFilter=>mitkFilter=>vtkFilter update mechanism will fail without calling manually
-    localStorage->m_Reslicer->Modified();
-    localStorage->m_Reslicer->Update();
-
-    localStorage->m_TSFilter->Modified();
-    localStorage->m_TSFilter->Update();
-    localStorage->m_ReslicedImage = localStorage->m_TSFilter->GetOutput();
   }
   else
   {
-    // this is needed when thick mode was enable bevore. These variable have to be reset to default values
-    localStorage->m_Reslicer->SetOutputDimensionality(2);
-    localStorage->m_Reslicer->SetOutputSpacingZDirection(1.0);
-    localStorage->m_Reslicer->SetOutputExtentZDirection(0, 0);
-
-    localStorage->m_Reslicer->Modified();
-    // start the pipeline with updating the largest possible, needed if the geometry of the input has changed
-    localStorage->m_Reslicer->UpdateLargestPossibleRegion();
-    localStorage->m_ReslicedImage = localStorage->m_Reslicer->GetVtkOutput();
+    localStorage->m_ShowingNearestSlice = false;
+    localStorage->m_NearestSliceRequest = ImageSliceCache::Request();
+  }
+
+  if (cacheable)
+  {
+    this->PrefetchSlices(renderer, request);
   }
 
+  localStorage->m_Slice = slice;
+  localStorage->m_ReslicedImage = slice->Image;
+
   // Bounds information for reslicing (only reuqired if reference geometry
   // is present)
   // this used for generating a vtkPLaneSource with the right size
   double sliceBounds[6];
-  for (auto &sliceBound : sliceBounds)
-  {
-    sliceBound = 0.0;
-  }
-  localStorage->m_Reslicer->GetClippedPlaneBounds(sliceBounds);
+  std::copy(slice->Bounds, slice->Bounds + 6, sliceBounds);
 
   // get the spacing of the slice
-  localStorage->m_mmPerPixel = localStorage->m_Reslicer->GetOutputSpacing();
+  localStorage->m_mmPerPixel = slice->Spacing;
+
+  const PlaneGeometry *planeGeometry = dynamic_cast<const PlaneGeometry *>(worldGeometry);
 
   // calculate minimum bounding rect of IMAGE in texture
   {
@@ -332,15 +267,24 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
     {
       // get pixel type of vtk image
       itk::ImageIOBase::IOComponentType componentType = static_cast<itk::ImageIOBase::IOComponentType>(image->GetPixelType().GetComponentType());
+      // the outline is cached along with the slice, it only has to be regenerated if the depth changed
+      const float depth = this->CalculateLayerDepth(renderer);
+      const bool outlineCached = slice->Outline != nullptr && slice->OutlineDepth == depth;
       switch (componentType)
       {
       case itk::ImageIOBase::UCHAR:
         // generate contours/outlines
-        localStorage->m_OutlinePolyData = CreateOutlinePolyData<unsigned char>(renderer);
+        if (!outlineCached)
+          slice->Outline = CreateOutlinePolyData<unsigned char>(renderer);
+        slice->OutlineDepth = depth;
+        localStorage->m_OutlinePolyData = slice->Outline;
         break;
       case itk::ImageIOBase::USHORT:
         // generate contours/outlines
-        localStorage->m_OutlinePolyData = CreateOutlinePolyData<unsigned short>(renderer);
+        if (!outlineCached)
+          slice->Outline = CreateOutlinePolyData<unsigned short>(renderer);
+        slice->OutlineDepth = depth;
+        localStorage->m_OutlinePolyData = slice->Outline;
         break;
       default:
         binaryOutline = false;
@@ -442,6 +386,173 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
   localStorage->m_LastUpdateTime.Modified();
 }
 
+bool mitk::ImageVtkMapper2D::GetSliceRequest(mitk::BaseRenderer *renderer,
+                                             const PlaneGeometry *worldGeometry,
+                                             unsigned int timeStep,
+                                             ImageSliceCache::Request &request)
+{
+  const mitk::Image *image = this->GetInput();
+  mitk::DataNode *datanode = this->GetDataNode();
+
+  request.Input = image;
+  request.WorldGeometry = worldGeometry;
+  request.TimeStep = timeStep;
+
+  // slices are invalidated by modifications of the pixels as well as of the geometry of the time step
+  const BaseGeometry *imageGeometry = image->GetTimeGeometry()->GetGeometryForTimeStep(timeStep);
+  request.InputMTime = std::max(image->GetMTime(), imageGeometry->GetMTime());
+
+  // is the geometry of the slice based on the input image or the worldgeometry?
+  bool inPlaneResampleExtentByGeometry = false;
+  datanode->GetBoolProperty("in plane resample extent by geometry", inPlaneResampleExtentByGeometry, renderer);
+  request.InPlaneResampleExtentByGeometry = inPlaneResampleExtentByGeometry;
+
+  // Initialize the interpolation mode for resampling; switch to nearest
+  // neighbor if the input image is too small.
+  request.Interpolation = ExtractSliceFilter::RESLICE_NEAREST;
+  if ((image->GetDimension() >= 3) && (image->GetDimension(2) > 1))
+  {
+    VtkResliceInterpolationProperty *resliceInterpolationProperty;
+    datanode->GetProperty(resliceInterpolationProperty, "reslice interpolation", renderer);
+
+    int interpolationMode = VTK_RESLICE_NEAREST;
+    if (resliceInterpolationProperty != NULL)
+    {
+      interpolationMode = resliceInterpolationProperty->GetInterpolation();
+    }
+
+    switch (interpolationMode)
+    {
+      case VTK_RESLICE_NEAREST:
+        request.Interpolation = ExtractSliceFilter::RESLICE_NEAREST;
+        break;
+      case VTK_RESLICE_LINEAR:
+        request.Interpolation = ExtractSliceFilter::RESLICE_LINEAR;
+        break;
+      case VTK_RESLICE_CUBIC:
+        request.Interpolation = ExtractSliceFilter::RESLICE_CUBIC;
+        break;
+    }
+  }
+
+  // Thickslicing
+  int thickSlicesMode = 0;
+  int thickSlicesNum = 1;
+  // Thick slices parameters
+  if (image->GetPixelType().GetNumberOfComponents() == 1) // for now only single component are allowed
+  {
+    DataNode *dn = renderer->GetCurrentWorldPlaneGeometryNode();
+    if (dn)
+    {
+      ResliceMethodProperty *resliceMethodEnumProperty = 0;
+
+      if (dn->GetProperty(resliceMethodEnumProperty, "reslice.thickslices", renderer) && resliceMethodEnumProperty)
+        thickSlicesMode = resliceMethodEnumProperty->GetValueAsId();
+
+      IntProperty *intProperty = 0;
+      if (dn->GetProperty(intProperty, "reslice.thickslices.num", renderer) && intProperty)
+      {
+        thickSlicesNum = intProperty->GetValue();
+        if (thickSlicesNum < 1)
+          thickSlicesNum = 1;
+      }
+    }
+    else
+    {
+      MITK_WARN << "no associated widget plane data tree node found";
+    }
+  }
+
+  request.ThickSlicesMode = thickSlicesMode;
+  request.ThickSlicesNum = thickSlicesNum;
+
+  if (thickSlicesMode > 0)
+  {
+    Vector3D normInIndex, normal;
+
+    const mitk::AbstractTransformGeometry *abstractGeometry =
+      dynamic_cast<const AbstractTransformGeometry *>(worldGeometry);
+    if (abstractGeometry != NULL)
+      normal = abstractGeometry->GetPlane()->GetNormal();
+    else if (worldGeometry != NULL)
+      normal = worldGeometry->GetNormal();
+    else
+      return false;
+    normal.Normalize();
+
+    imageGeometry->WorldToIndex(normal, normInIndex);
+
+    request.ThickSlicesSpacing = 1.0 / normInIndex.GetNorm();
+  }
+
+  return true;
+}
+
+void mitk::ImageVtkMapper2D::PrefetchSlices(mitk::BaseRenderer *renderer, const ImageSliceCache::Request &request)
+{
+  LocalStorage *localStorage = m_LSH.GetLocalStorage(renderer);
+
+  const unsigned int slice = renderer->GetSlice();
+  const int sliceDirection = slice > localStorage->m_LastSlice ? 1 : (slice < localStorage->m_LastSlice ? -1 : 0);
+  const int timeDirection =
+    request.TimeStep > localStorage->m_LastTimeStep ? 1 : (request.TimeStep < localStorage->m_LastTimeStep ? -1 : 0);
+  localStorage->m_LastSlice = slice;
+  localStorage->m_LastTimeStep = request.TimeStep;
+
+  int numberOfSlices = 0;
+  this->GetDataNode()->GetIntProperty("Image Rendering.Prefetched slices", numberOfSlices, renderer);
+  if (numberOfSlices <= 0 || (sliceDirection == 0 && timeDirection == 0))
+  {
+    return;
+  }
+
+  const mitk::Image *image = this->GetInput();
+  const SlicedGeometry3D *worldSlices = nullptr;
+  if (renderer->GetWorldTimeGeometry() != nullptr)
+  {
+    worldSlices = dynamic_cast<const SlicedGeometry3D *>(
+      renderer->GetWorldTimeGeometry()->GetGeometryForTimeStep(renderer->GetTimeStep()).GetPointer());
+  }
+
+  // the cache reslices the latest request first, so the farthest neighbour is requested first
+  for (int distance = numberOfSlices; distance > 0; --distance)
+  {
+    if (sliceDirection != 0)
+    {
+      // scrolling through space has priority
+      const int neighbour = static_cast<int>(slice) + sliceDirection * distance;
+      if (worldSlices == nullptr || neighbour < 0 || neighbour >= static_cast<int>(worldSlices->GetSlices()))
+      {
+        continue;
+      }
+
+      const PlaneGeometry *neighbourGeometry = worldSlices->GetPlaneGeometry(neighbour);
+      ImageSliceCache::Request neighbourRequest;
+      if (neighbourGeometry != nullptr &&
+          RenderingGeometryIntersectsImage(neighbourGeometry, image->GetSlicedGeometry(request.TimeStep)) &&
+          this->GetSliceRequest(renderer, neighbourGeometry, request.TimeStep, neighbourRequest))
+      {
+        localStorage->m_SliceCache->Prefetch(neighbourRequest);
+      }
+    }
+    else
+    {
+      const int neighbour = static_cast<int>(request.TimeStep) + timeDirection * distance;
+      if (neighbour < 0 || neighbour >= static_cast<int>(image->GetTimeSteps()) ||
+          !image->IsTimeStepAvailable(neighbour))
+      {
+        continue;
+      }
+
+      ImageSliceCache::Request neighbourRequest;
+      if (this->GetSliceRequest(renderer, request.WorldGeometry, neighbour, neighbourRequest))
+      {
+        localStorage->m_SliceCache->Prefetch(neighbourRequest);
+      }
+    }
+  }
+}
+
 void mitk::ImageVtkMapper2D::ApplyLevelWindow(mitk::BaseRenderer *renderer)
 {
   LocalStorage *localStorage = this->GetLocalStorage(renderer);
@@ -681,7 +792,11 @@ void mitk::ImageVtkMapper2D::Update(mitk::BaseRenderer *renderer)
       (localStorage->m_LastUpdateTime < renderer->GetCurrentWorldPlaneGeometry()->GetMTime()) ||
       (localStorage->m_LastUpdateTime < node->GetPropertyList()->GetMTime()) // was a property modified?
       ||
-      (localStorage->m_LastUpdateTime < node->GetPropertyList(renderer)->GetMTime()))
+      (localStorage->m_LastUpdateTime < node->GetPropertyList(renderer)->GetMTime()) ||
+      (localStorage->m_WaitingForTimeStep && data->IsTimeStepAvailable(this->GetTimestep())) // was it loaded?
+      ||
+      (localStorage->m_ShowingNearestSlice &&
+       !localStorage->m_SliceCache->IsPending(localStorage->m_NearestSliceRequest))) // was it resliced?
   {
     this->GenerateDataForRenderer(renderer);
   }
@@ -702,6 +817,8 @@ void mitk::ImageVtkMapper2D::SetDefaultProperties(mitk::DataNode *node, mitk::Ba
   node->AddProperty("outline binary shadow", mitk::BoolProperty::New(false), renderer, overwrite);
   node->AddProperty("outline binary shadow color", ColorProperty::New(0.0, 0.0, 0.0), renderer, overwrite);
   node->AddProperty("outline shadow width", mitk::FloatProperty::New(1.5), renderer, overwrite);
+  node->AddProperty("Image Rendering.Prefetched slices", mitk::IntProperty::New(2), renderer, overwrite);
+  node->AddProperty("Image Rendering.Show nearest cached slice", mitk::BoolProperty::New(false), renderer, overwrite);
   if (image->IsRotated())
     node->AddProperty("reslice interpolation", mitk::VtkResliceInterpolationProperty::New(VTK_RESLICE_CUBIC));
   else
@@ -1033,7 +1150,7 @@ void mitk::ImageVtkMapper2D::TransformActor(mitk::BaseRenderer *renderer)
   LocalStorage *localStorage = m_LSH.GetLocalStorage(renderer);
   // get the transformation matrix of the reslicer in order to render the slice as axial, coronal or saggital
   vtkSmartPointer<vtkTransform> trans = vtkSmartPointer<vtkTransform>::New();
-  vtkSmartPointer<vtkMatrix4x4> matrix = localStorage->m_Reslicer->GetResliceAxes();
+  vtkSmartPointer<vtkMatrix4x4> matrix = localStorage->m_Slice->ResliceAxes;
   trans->SetMatrix(matrix);
   // transform the plane/contour (the actual actor) to the corresponding view (axial, coronal or saggital)
   localStorage->m_Actor->SetUserTransform(trans);
@@ -1082,7 +1199,11 @@ mitk::ImageVtkMapper2D::LocalStorage::~LocalStorage()
 }
 
 mitk::ImageVtkMapper2D::LocalStorage::LocalStorage()
-  : m_VectorComponentExtractor(vtkSmartPointer<vtkImageExtractComponents>::New())
+  : m_VectorComponentExtractor(vtkSmartPointer<vtkImageExtractComponents>::New()),
+    m_WaitingForTimeStep(false),
+    m_ShowingNearestSlice(false),
+    m_LastSlice(0),
+    m_LastTimeStep(0)
 {
   m_LevelWindowFilter = vtkSmartPointer<vtkMitkLevelWindowFilter>::New();
 
@@ -1096,6 +1217,7 @@ mitk::ImageVtkMapper2D::LocalStorage::LocalStorage()
   m_Actor = vtkSmartPointer<vtkActor>::New();
   m_Actors = vtkSmartPointer<vtkPropAssembly>::New();
   m_Reslicer = mitk::ExtractSliceFilter::New();
+  m_SliceCache = mitk::ImageSliceCache::New();
   m_TSFilter = vtkSmartPointer<vtkMitkThickSlicesFilter>::New();
   m_OutlinePolyData = vtkSmartPointer<vtkPolyData>::New();
   m_ReslicedImage = vtkSmartPointer<vtkImageData>::New();
@@ -298,7 +298,13 @@ namespace mitk
       // bounds
       else if (m_DataStorage.IsNotNull())
       {
-        m_SurfaceCreator->SetBoundingBox(m_DataStorage->ComputeVisibleBoundingBox(NULL, "includeInBoundingBox"));
+        // the renderer caches the bounds of the nodes of its storage, visibility is renderer independent as before
+        VtkPropRenderer *vtkPropRenderer = dynamic_cast<VtkPropRenderer *>(renderer);
+        if (vtkPropRenderer != nullptr &&
+            vtkPropRenderer->GetDataStorage().GetPointer() == m_DataStorage.GetPointer())
+          m_SurfaceCreator->SetBoundingBox(vtkPropRenderer->ComputeVisibleBoundingBox(NULL, "includeInBoundingBox"));
+        else
+          m_SurfaceCreator->SetBoundingBox(m_DataStorage->ComputeVisibleBoundingBox(NULL, "includeInBoundingBox"));
         tubeRadius = sqrt(m_SurfaceCreator->GetBoundingBox()->GetDiagonalLength2()) / 450.0;
       }
 
@@ -132,6 +132,17 @@ vtkProp *mitk::PointSetVtkMapper2D::GetVtkProp(mitk::BaseRenderer *renderer)
   return ls->m_PropAssembly;
 }
 
+/** \brief Returns the text actor with the given index, the list is extended if necessary.
+ * The actors are reused between updates instead of being recreated. */
+static vtkTextActor *getTextActor(std::vector<vtkSmartPointer<vtkTextActor>> &actors, unsigned int index)
+{
+  if (index >= actors.size())
+  {
+    actors.push_back(vtkSmartPointer<vtkTextActor>::New());
+  }
+  return actors[index];
+}
+
 static bool makePerpendicularVector2D(const mitk::Vector2D &in, mitk::Vector2D &out)
 {
   // The dot product of orthogonal vectors is zero.
@@ -163,9 +174,8 @@ void mitk::PointSetVtkMapper2D::CreateVTKRenderObjects(mitk::BaseRenderer *rende
   unsigned i = 0;
 
   // The vtk text actors need to be removed manually from the propassembly
-  // since the same vtk text actors are not overwriten within this function,
-  // but new actors are added to the propassembly each time this function is executed.
-  // Thus, the actors from the last call must be removed in the beginning.
+  // since the number of needed actors changes between the calls of this function.
+  // The actors are reused, but only the ones needed in this call are added again.
   for (i = 0; i < ls->m_VtkTextLabelActors.size(); i++)
   {
     if (ls->m_PropAssembly->GetParts()->IsItemPresent(ls->m_VtkTextLabelActors.at(i)))
@@ -241,9 +251,18 @@ void mitk::PointSetVtkMapper2D::CreateVTKRenderObjects(mitk::BaseRenderer *rende
 
   ls->m_DistancesBetweenPoints->Reset();
 
-  ls->m_VtkTextLabelActors.clear();
-  ls->m_VtkTextDistanceActors.clear();
-  ls->m_VtkTextAngleActors.clear();
+  // the text actors of the last call are reused
+  unsigned int numberOfLabels = 0;
+  unsigned int numberOfDistances = 0;
+  unsigned int numberOfAngles = 0;
+
+  // labels are only created for points inside the render window
+  mitk::StringProperty *labelProperty = dynamic_cast<mitk::StringProperty *>(this->GetDataNode()->GetProperty("label"));
+  float labelColor[4] = {1.0, 1.0, 0.0, 1.0};
+  GetDataNode()->GetColor(labelColor);
+  const bool appendPointIdToLabel = input->GetSize() > 1;
+  const double displayWidth = renderer->GetSizeX();
+  const double displayHeight = renderer->GetSizeY();
 
   ls->m_UnselectedScales->SetNumberOfComponents(3);
   ls->m_SelectedScales->SetNumberOfComponents(3);
@@ -327,32 +346,23 @@ void mitk::PointSetVtkMapper2D::CreateVTKRenderObjects(mitk::BaseRenderer *rende
 
       //---- LABEL -----//
       // paint label for each point if available
-      if (dynamic_cast<mitk::StringProperty *>(this->GetDataNode()->GetProperty("label")) != NULL)
+      if (labelProperty != NULL && pt2d[0] >= 0 && pt2d[1] >= 0 && pt2d[0] <= displayWidth &&
+          pt2d[1] <= displayHeight)
       {
-        const char *pointLabel =
-          dynamic_cast<mitk::StringProperty *>(this->GetDataNode()->GetProperty("label"))->GetValue();
-        std::string l = pointLabel;
-        if (input->GetSize() > 1)
+        std::string l = labelProperty->GetValue();
+        if (appendPointIdToLabel)
         {
           std::stringstream ss;
           ss << pointsIter->Index();
           l.append(ss.str());
         }
 
-        ls->m_VtkTextActor = vtkSmartPointer<vtkTextActor>::New();
+        ls->m_VtkTextActor = getTextActor(ls->m_VtkTextLabelActors, numberOfLabels++);
 
         ls->m_VtkTextActor->SetDisplayPosition(pt2d[0] + text2dDistance, pt2d[1] + text2dDistance);
         ls->m_VtkTextActor->SetInput(l.c_str());
         ls->m_VtkTextActor->GetTextProperty()->SetOpacity(100);
-
-        float unselectedColor[4] = {1.0, 1.0, 0.0, 1.0};
-
-        // check if there is a color property
-        GetDataNode()->GetColor(unselectedColor);
-
-        ls->m_VtkTextActor->GetTextProperty()->SetColor(unselectedColor[0], unselectedColor[1], unselectedColor[2]);
-
-        ls->m_VtkTextLabelActors.push_back(ls->m_VtkTextActor);
+        ls->m_VtkTextActor->GetTextProperty()->SetColor(labelColor[0], labelColor[1], labelColor[2]);
       }
     }
 
@@ -395,13 +405,11 @@ void mitk::PointSetVtkMapper2D::CreateVTKRenderObjects(mitk::BaseRenderer *rende
                                     vec2d); // text is rendered within text2dDistance perpendicular to current line
           Vector2D pos2d = (lastPt2d.GetVectorFromOrigin() + pt2d.GetVectorFromOrigin()) * 0.5 + vec2d * text2dDistance;
 
-          ls->m_VtkTextActor = vtkSmartPointer<vtkTextActor>::New();
+          ls->m_VtkTextActor = getTextActor(ls->m_VtkTextDistanceActors, numberOfDistances++);
 
           ls->m_VtkTextActor->SetDisplayPosition(pos2d[0], pos2d[1]);
           ls->m_VtkTextActor->SetInput(buffer.str().c_str());
           ls->m_VtkTextActor->GetTextProperty()->SetColor(0.0, 1.0, 0.0);
-
-          ls->m_VtkTextDistanceActors.push_back(ls->m_VtkTextActor);
         }
 
         if (m_ShowAngles && count > 1) // calculate and print angle between connected lines
@@ -420,13 +428,11 @@ void mitk::PointSetVtkMapper2D::CreateVTKRenderObjects(mitk::BaseRenderer *rende
           // middle between two vectors that enclose the angle
           Vector2D pos2d = lastPt2d.GetVectorFromOrigin() + vec2d * text2dDistance * text2dDistance;
 
-          ls->m_VtkTextActor = vtkSmartPointer<vtkTextActor>::New();
+          ls->m_VtkTextActor = getTextActor(ls->m_VtkTextAngleActors, numberOfAngles++);
 
           ls->m_VtkTextActor->SetDisplayPosition(pos2d[0], pos2d[1]);
           ls->m_VtkTextActor->SetInput(buffer.str().c_str());
           ls->m_VtkTextActor->GetTextProperty()->SetColor(0.0, 1.0, 0.0);
-
-          ls->m_VtkTextAngleActors.push_back(ls->m_VtkTextActor);
         }
       }
     }
@@ -438,6 +444,11 @@ void mitk::PointSetVtkMapper2D::CreateVTKRenderObjects(mitk::BaseRenderer *rende
     }
   }
 
+  // release the text actors that are not needed anymore
+  ls->m_VtkTextLabelActors.resize(numberOfLabels);
+  ls->m_VtkTextDistanceActors.resize(numberOfDistances);
+  ls->m_VtkTextAngleActors.resize(numberOfAngles);
+
   // add each single text actor to the assembly
   for (i = 0; i < ls->m_VtkTextLabelActors.size(); i++)
   {
@@ -27,6 +27,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkConeSource.h>
 #include <vtkCubeSource.h>
 #include <vtkCylinderSource.h>
+#include <vtkGlyph3D.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
 #include <vtkPolyDataAlgorithm.h>
 #include <vtkPolyDataMapper.h>
 #include <vtkPropAssembly.h>
@@ -38,12 +41,72 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkTubeFilter.h>
 #include <vtkVectorText.h>
 
+#include <map>
 #include <stdlib.h>
 
 #include <vtkgl.h>
 
 #include <mitkPropertyObserver.h>
 
+namespace
+{
+  /** \brief Creates the source of the glyph of the given point type, centered at the origin */
+  vtkSmartPointer<vtkPolyDataAlgorithm> CreatePointSource(int pointType, float pointSize, bool isInputDevice)
+  {
+    switch (pointType)
+    {
+      case mitk::PTUNDEFINED:
+      {
+        vtkSmartPointer<vtkSphereSource> sphere = vtkSmartPointer<vtkSphereSource>::New();
+        sphere->SetRadius(pointSize / 2.0f);
+
+        // MouseOrientation Tool (PositionTracker)
+        if (isInputDevice)
+        {
+          sphere->SetThetaResolution(10);
+          sphere->SetPhiResolution(10);
+        }
+        else
+        {
+          sphere->SetThetaResolution(20);
+          sphere->SetPhiResolution(20);
+        }
+        return sphere.GetPointer();
+      }
+      case mitk::PTSTART:
+      {
+        vtkSmartPointer<vtkCubeSource> cube = vtkSmartPointer<vtkCubeSource>::New();
+        cube->SetXLength(pointSize / 2);
+        cube->SetYLength(pointSize / 2);
+        cube->SetZLength(pointSize / 2);
+        return cube.GetPointer();
+      }
+      case mitk::PTCORNER:
+      {
+        vtkSmartPointer<vtkConeSource> cone = vtkSmartPointer<vtkConeSource>::New();
+        cone->SetRadius(pointSize / 2.0f);
+        cone->SetResolution(20);
+        return cone.GetPointer();
+      }
+      case mitk::PTEDGE:
+      {
+        vtkSmartPointer<vtkCylinderSource> cylinder = vtkSmartPointer<vtkCylinderSource>::New();
+        cylinder->SetRadius(pointSize / 2.0f);
+        cylinder->SetResolution(20);
+        return cylinder.GetPointer();
+      }
+      default:
+      {
+        vtkSmartPointer<vtkSphereSource> sphere = vtkSmartPointer<vtkSphereSource>::New();
+        sphere->SetRadius(pointSize / 2.0f);
+        sphere->SetThetaResolution(20);
+        sphere->SetPhiResolution(20);
+        return sphere.GetPointer();
+      }
+    }
+  }
+}
+
 const mitk::PointSet *mitk::PointSetVtkMapper3D::GetInput()
 {
   return static_cast<const mitk::PointSet *>(GetDataNode()->GetData());
@@ -207,12 +270,12 @@ void mitk::PointSetVtkMapper3D::CreateVTKRenderObjects()
   bool pointDataBroken = (itkPointSet->GetPointData()->Size() != itkPointSet->GetPoints()->Size());
 
   // now add an object for each point in data
+  std::map<std::pair<int, bool>, vtkSmartPointer<vtkPoints>> glyphPointLists;
   mitk::PointSet::PointDataContainer::Iterator pointDataIter = itkPointSet->GetPointData()->Begin();
   for (ptIdx = 0; ptIdx < nbPoints; ++ptIdx) // pointDataIter moved at end of loop
   {
     double currentPoint[3];
     m_WorldPositions->GetPoint(ptIdx, currentPoint);
-    vtkSmartPointer<vtkPolyDataAlgorithm> source;
 
     // check for the pointtype in data and decide which geom-object to take and then add to the selected or unselected
     // list
@@ -222,90 +285,25 @@ void mitk::PointSetVtkMapper3D::CreateVTKRenderObjects()
     else
       pointType = pointDataIter.Value().pointSpec;
 
-    switch (pointType)
+    // all points of the same type and selection state are rendered as glyphs
+    // of one shared source instead of creating a source per point
+    bool selected = !pointDataBroken && pointDataIter.Value().selected;
+    vtkSmartPointer<vtkPoints> &glyphPoints = glyphPointLists[std::make_pair(pointType, selected)];
+    if (!glyphPoints)
     {
-      case mitk::PTUNDEFINED:
-      {
-        vtkSmartPointer<vtkSphereSource> sphere = vtkSmartPointer<vtkSphereSource>::New();
-        sphere->SetRadius(m_PointSize / 2.0f);
-        sphere->SetCenter(currentPoint);
-        // sphere->SetCenter(pointsIter.Value()[0],pointsIter.Value()[1],pointsIter.Value()[2]);
-
-        // MouseOrientation Tool (PositionTracker)
-        if (isInputDevice)
-        {
-          sphere->SetThetaResolution(10);
-          sphere->SetPhiResolution(10);
-        }
-        else
-        {
-          sphere->SetThetaResolution(20);
-          sphere->SetPhiResolution(20);
-        }
-        source = sphere;
-      }
-      break;
-      case mitk::PTSTART:
-      {
-        vtkSmartPointer<vtkCubeSource> cube = vtkSmartPointer<vtkCubeSource>::New();
-        cube->SetXLength(m_PointSize / 2);
-        cube->SetYLength(m_PointSize / 2);
-        cube->SetZLength(m_PointSize / 2);
-        cube->SetCenter(currentPoint);
-        source = cube;
-      }
-      break;
-      case mitk::PTCORNER:
-      {
-        vtkSmartPointer<vtkConeSource> cone = vtkSmartPointer<vtkConeSource>::New();
-        cone->SetRadius(m_PointSize / 2.0f);
-        cone->SetCenter(currentPoint);
-        cone->SetResolution(20);
-        source = cone;
-      }
-      break;
-      case mitk::PTEDGE:
-      {
-        vtkSmartPointer<vtkCylinderSource> cylinder = vtkSmartPointer<vtkCylinderSource>::New();
-        cylinder->SetRadius(m_PointSize / 2.0f);
-        cylinder->SetCenter(currentPoint);
-        cylinder->SetResolution(20);
-        source = cylinder;
-      }
-      break;
-      case mitk::PTEND:
-      {
-        vtkSmartPointer<vtkSphereSource> sphere = vtkSmartPointer<vtkSphereSource>::New();
-        sphere->SetRadius(m_PointSize / 2.0f);
-        // no SetCenter?? this functionality should be explained!
-        // otherwise: join with default block!
-        sphere->SetThetaResolution(20);
-        sphere->SetPhiResolution(20);
-        source = sphere;
-      }
-      break;
-      default:
-      {
-        vtkSmartPointer<vtkSphereSource> sphere = vtkSmartPointer<vtkSphereSource>::New();
-        sphere->SetRadius(m_PointSize / 2.0f);
-        sphere->SetCenter(currentPoint);
-        sphere->SetThetaResolution(20);
-        sphere->SetPhiResolution(20);
-        source = sphere;
-      }
-      break;
+      glyphPoints = vtkSmartPointer<vtkPoints>::New();
     }
+    glyphPoints->InsertNextPoint(currentPoint);
 
-    if (pointDataIter.Value().selected && !pointDataBroken)
+    if (selected)
     {
-      m_vtkSelectedPointList->AddInputConnection(source->GetOutputPort());
       ++m_NumberOfSelectedAdded;
     }
     else
     {
-      m_vtkUnselectedPointList->AddInputConnection(source->GetOutputPort());
       ++m_NumberOfUnselectedAdded;
     }
+
     if (showLabel)
     {
       char buffer[20];
@@ -347,6 +345,32 @@ void mitk::PointSetVtkMapper3D::CreateVTKRenderObjects()
       pointDataIter++;
   } // end FOR
 
+  for (auto &glyphPointList : glyphPointLists)
+  {
+    int pointType = glyphPointList.first.first;
+    vtkAppendPolyData *pointList =
+      glyphPointList.first.second ? m_vtkSelectedPointList.GetPointer() : m_vtkUnselectedPointList.GetPointer();
+
+    vtkSmartPointer<vtkPolyDataAlgorithm> source = CreatePointSource(pointType, m_PointSize, isInputDevice);
+
+    if (pointType == mitk::PTEND)
+    {
+      // end points have always been rendered at the origin, one source is enough
+      pointList->AddInputConnection(source->GetOutputPort());
+      continue;
+    }
+
+    vtkSmartPointer<vtkPolyData> glyphInput = vtkSmartPointer<vtkPolyData>::New();
+    glyphInput->SetPoints(glyphPointList.second);
+
+    vtkSmartPointer<vtkGlyph3D> glyphs = vtkSmartPointer<vtkGlyph3D>::New();
+    glyphs->SetSourceConnection(source->GetOutputPort());
+    glyphs->SetInputData(glyphInput);
+    glyphs->ScalingOff();
+    glyphs->OrientOff();
+    pointList->AddInputConnection(glyphs->GetOutputPort());
+  }
+
   // now according to number of elements added to selected or unselected, build up the rendering pipeline
   if (m_NumberOfSelectedAdded > 0)
   {
@@ -16,7 +16,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkVtkMapper.h"
 
-mitk::VtkMapper::VtkMapper()
+mitk::VtkMapper::VtkMapper() : m_VisibleHandle("visible"), m_ColorHandle("color"), m_OpacityHandle("opacity")
 {
 }
 
@@ -62,7 +62,7 @@ bool mitk::VtkMapper::IsVtkBased() const
 void mitk::VtkMapper::MitkRenderOverlay(BaseRenderer *renderer)
 {
   bool visible = true;
-  GetDataNode()->GetVisibility(visible, renderer, "visible");
+  GetDataNode()->GetVisibility(visible, renderer, m_VisibleHandle);
   if (!visible)
     return;
 
@@ -76,7 +76,7 @@ void mitk::VtkMapper::MitkRenderOpaqueGeometry(BaseRenderer *renderer)
 {
   bool visible = true;
 
-  GetDataNode()->GetVisibility(visible, renderer, "visible");
+  GetDataNode()->GetVisibility(visible, renderer, m_VisibleHandle);
   if (!visible)
     return;
 
@@ -89,7 +89,7 @@ void mitk::VtkMapper::MitkRenderOpaqueGeometry(BaseRenderer *renderer)
 void mitk::VtkMapper::MitkRenderTranslucentGeometry(BaseRenderer *renderer)
 {
   bool visible = true;
-  GetDataNode()->GetVisibility(visible, renderer, "visible");
+  GetDataNode()->GetVisibility(visible, renderer, m_VisibleHandle);
   if (!visible)
     return;
 
@@ -112,7 +112,7 @@ void mitk::VtkMapper::ApplyShaderProperties(mitk::BaseRenderer *renderer)
 void mitk::VtkMapper::MitkRenderVolumetricGeometry(BaseRenderer *renderer)
 {
   bool visible = true;
-  GetDataNode()->GetVisibility(visible, renderer, "visible");
+  GetDataNode()->GetVisibility(visible, renderer, m_VisibleHandle);
   if (!visible)
     return;
 
@@ -151,9 +151,9 @@ void mitk::VtkMapper::ApplyColorAndOpacityProperties(BaseRenderer *renderer, vtk
   DataNode *node = GetDataNode();
 
   // check for color prop and use it for rendering if it exists
-  node->GetColor(rgba, renderer, "color");
+  node->GetColor(rgba, renderer, m_ColorHandle);
   // check for opacity prop and use it for rendering if it exists
-  node->GetOpacity(rgba[3], renderer, "opacity");
+  node->GetOpacity(rgba[3], renderer, m_OpacityHandle);
 
   double drgba[4] = {rgba[0], rgba[1], rgba[2], rgba[3]};
   actor->GetProperty()->SetColor(drgba);
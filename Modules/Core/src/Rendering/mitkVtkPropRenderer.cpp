@@ -56,14 +56,25 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkTransform.h>
 #include <vtkWorldPointPicker.h>
 
+#include <algorithm>
+
 mitk::VtkPropRenderer::VtkPropRenderer(const char *name,
                                        vtkRenderWindow *renWin,
                                        mitk::RenderingManager *rm,
                                        mitk::BaseRenderer::RenderingMode::Type renderingMode)
-  : BaseRenderer(name, renWin, rm, renderingMode), m_CameraInitializedForMapperID(0)
+  : BaseRenderer(name, renWin, rm, renderingMode),
+    m_CameraInitializedForMapperID(0),
+    m_RenderQueueModified(true),
+    m_RenderQueueStructureVersion(0),
+    m_RenderQueueVisibleHandle("visible"),
+    m_RenderQueueLayerHandle("layer"),
+    m_NextRenderQueueOrder(0)
 {
   didCount = false;
 
+  m_RenderQueuePropertyCommand = itk::SimpleMemberCommand<VtkPropRenderer>::New();
+  m_RenderQueuePropertyCommand->SetCallbackFunction(this, &VtkPropRenderer::OnRenderQueuePropertyModified);
+
   m_WorldPointPicker = vtkWorldPointPicker::New();
 
   m_PointPicker = vtkPointPicker::New();
@@ -97,6 +108,15 @@ mitk::VtkPropRenderer::~VtkPropRenderer()
     checkState();
   }
 
+  if (m_DataStorage.IsNotNull())
+  {
+    m_DataStorage->AddNodeEvent.RemoveListener(
+      mitk::MessageDelegate1<VtkPropRenderer, const mitk::DataNode *>(this, &VtkPropRenderer::OnNodeAdded));
+    m_DataStorage->RemoveNodeEvent.RemoveListener(
+      mitk::MessageDelegate1<VtkPropRenderer, const mitk::DataNode *>(this, &VtkPropRenderer::OnNodeRemoved));
+  }
+  this->RemoveRenderQueueEntries();
+
   if (m_LightKit != nullptr)
     m_LightKit->Delete();
 
@@ -126,8 +146,27 @@ void mitk::VtkPropRenderer::SetDataStorage(mitk::DataStorage *storage)
   if (storage == nullptr || storage == m_DataStorage)
     return;
 
+  if (m_DataStorage.IsNotNull())
+  {
+    m_DataStorage->AddNodeEvent.RemoveListener(
+      mitk::MessageDelegate1<VtkPropRenderer, const mitk::DataNode *>(this, &VtkPropRenderer::OnNodeAdded));
+    m_DataStorage->RemoveNodeEvent.RemoveListener(
+      mitk::MessageDelegate1<VtkPropRenderer, const mitk::DataNode *>(this, &VtkPropRenderer::OnNodeRemoved));
+  }
+  this->RemoveRenderQueueEntries();
+
   BaseRenderer::SetDataStorage(storage);
 
+  // the render queue is filled once and then kept up to date by the events of the storage
+  m_DataStorage->AddNodeEvent.AddListener(
+    mitk::MessageDelegate1<VtkPropRenderer, const mitk::DataNode *>(this, &VtkPropRenderer::OnNodeAdded));
+  m_DataStorage->RemoveNodeEvent.AddListener(
+    mitk::MessageDelegate1<VtkPropRenderer, const mitk::DataNode *>(this, &VtkPropRenderer::OnNodeRemoved));
+
+  DataStorage::SetOfObjects::ConstPointer allObjects = m_DataStorage->GetAll();
+  for (DataStorage::SetOfObjects::ConstIterator it = allObjects->Begin(); it != allObjects->End(); ++it)
+    this->AddRenderQueueEntry(it->Value());
+
   static_cast<mitk::PlaneGeometryDataVtkMapper3D *>(m_CurrentWorldPlaneGeometryMapper.GetPointer())
     ->SetDataStorageForTexture(m_DataStorage.GetPointer());
 
@@ -193,18 +232,25 @@ int mitk::VtkPropRenderer::Render(mitk::VtkPropRenderer::RenderType type)
 }
 
 /*!
-\brief PrepareMapperQueue iterates the datatree
+\brief PrepareMapperQueue collects the mappers of the render queue
 
-PrepareMapperQueue iterates the datatree in order to find mappers which shall be rendered. Also, it sortes the mappers
-wrt to their layer.
+PrepareMapperQueue collects the mappers of the visible nodes in the render queue, which is already sorted wrt to the
+layer of the nodes. Hidden nodes are not visited.
 */
 void mitk::VtkPropRenderer::PrepareMapperQueue()
 {
   // variable for counting LOD-enabled mappers
   m_NumberOfVisibleLODEnabledMappers = 0;
 
+  // DataStorage
+  if (m_DataStorage.IsNull())
+    return;
+
+  const bool renderQueueModified = this->UpdateRenderQueue();
+
   // Do we have to update the mappers ?
-  if (m_LastUpdateTime < GetMTime() || m_LastUpdateTime < this->GetCurrentWorldPlaneGeometry()->GetMTime())
+  if (renderQueueModified || m_LastUpdateTime < GetMTime() ||
+      m_LastUpdateTime < this->GetCurrentWorldPlaneGeometry()->GetMTime())
   {
     Update();
   }
@@ -225,39 +271,279 @@ void mitk::VtkPropRenderer::PrepareMapperQueue()
 
   int mapperNo = 0;
 
-  // DataStorage
-  if (m_DataStorage.IsNull())
-    return;
-
-  DataStorage::SetOfObjects::ConstPointer allObjects = m_DataStorage->GetAll();
-
-  for (DataStorage::SetOfObjects::ConstIterator it = allObjects->Begin(); it != allObjects->End(); ++it)
+  // the mappers are looked up for every frame, they are replaced if the data of a node is replaced
+  for (auto it = m_RenderQueue.cbegin(); it != m_RenderQueue.cend(); ++it)
   {
-    const DataNode::Pointer node = it->Value();
-    if (node.IsNull())
-      continue;
-    const mitk::Mapper::Pointer mapper = node->GetMapper(m_MapperID);
+    const RenderQueueEntry *entry = *it;
+    Mapper *mapper = entry->Node->GetMapper(m_MapperID);
 
-    if (mapper.IsNull())
+    if (mapper == nullptr)
       continue;
 
-    bool visible = true;
-    node->GetVisibility(visible, this, "visible");
-
     // The information about LOD-enabled mappers is required by RenderingManager
-    if (mapper->IsLODEnabled(this) && visible)
+    if (mapper->IsLODEnabled(this))
     {
       ++m_NumberOfVisibleLODEnabledMappers;
     }
-    // mapper without a layer property get layer number 1
-    int layer = 1;
-    node->GetIntProperty("layer", layer, this);
-    int nr = (layer << 16) + mapperNo;
-    m_MappersMap.insert(std::pair<int, Mapper *>(nr, mapper));
+    int nr = (entry->Layer << 16) + mapperNo;
+    m_MappersMap.insert(m_MappersMap.end(), std::pair<int, Mapper *>(nr, mapper));
     mapperNo++;
   }
 }
 
+void mitk::VtkPropRenderer::AddRenderQueueEntry(const DataNode *node)
+{
+  if (node == nullptr || m_RenderQueueEntries.find(node) != m_RenderQueueEntries.end())
+    return;
+
+  RenderQueueEntry &entry = m_RenderQueueEntries[node];
+  entry.Node = const_cast<DataNode *>(node);
+  entry.Order = m_NextRenderQueueOrder++;
+  entry.Visible = false;
+  entry.Layer = 1;
+  entry.VisibleObserverTag = 0;
+  entry.LayerObserverTag = 0;
+  entry.BoundsData = nullptr;
+  entry.BoundsTime = 0;
+  entry.BoundsGeometry = nullptr;
+  entry.BoundsGeometryTime = 0;
+  entry.HasBounds = false;
+
+  this->ResolveRenderQueueProperties(entry);
+  m_RenderQueueModified = true;
+}
+
+void mitk::VtkPropRenderer::RemoveRenderQueueEntries()
+{
+  for (auto it = m_RenderQueueEntries.begin(); it != m_RenderQueueEntries.end(); ++it)
+    this->RemoveRenderQueueObservers(it->second);
+
+  m_RenderQueueEntries.clear();
+  m_RenderQueue.clear();
+  m_HiddenNodes.clear();
+  m_RenderQueueModified = true;
+}
+
+void mitk::VtkPropRenderer::RemoveRenderQueueObservers(RenderQueueEntry &entry)
+{
+  if (entry.VisibleProperty.IsNotNull())
+    entry.VisibleProperty->RemoveObserver(entry.VisibleObserverTag);
+  if (entry.LayerProperty.IsNotNull())
+    entry.LayerProperty->RemoveObserver(entry.LayerObserverTag);
+
+  entry.VisibleProperty = nullptr;
+  entry.LayerProperty = nullptr;
+}
+
+void mitk::VtkPropRenderer::ResolveRenderQueueProperties(RenderQueueEntry &entry)
+{
+  BaseProperty *visibleProperty = entry.Node->GetProperty(m_RenderQueueVisibleHandle, this);
+  if (visibleProperty != entry.VisibleProperty.GetPointer())
+  {
+    if (entry.VisibleProperty.IsNotNull())
+      entry.VisibleProperty->RemoveObserver(entry.VisibleObserverTag);
+
+    entry.VisibleProperty = visibleProperty;
+
+    if (visibleProperty != nullptr)
+      entry.VisibleObserverTag = visibleProperty->AddObserver(itk::ModifiedEvent(), m_RenderQueuePropertyCommand);
+  }
+
+  BaseProperty *layerProperty = entry.Node->GetProperty(m_RenderQueueLayerHandle, this);
+  if (layerProperty != entry.LayerProperty.GetPointer())
+  {
+    if (entry.LayerProperty.IsNotNull())
+      entry.LayerProperty->RemoveObserver(entry.LayerObserverTag);
+
+    entry.LayerProperty = layerProperty;
+
+    if (layerProperty != nullptr)
+      entry.LayerObserverTag = layerProperty->AddObserver(itk::ModifiedEvent(), m_RenderQueuePropertyCommand);
+  }
+}
+
+bool mitk::VtkPropRenderer::UpdateRenderQueue()
+{
+  // Properties were added to, replaced in or deleted from a property list of a node (maybe a new renderer specific
+  // list): the observed properties might not be the ones that decide about visibility and layer any more.
+  const unsigned long structureVersion = PropertyList::GetStructureVersion();
+  if (structureVersion != m_RenderQueueStructureVersion)
+  {
+    for (auto it = m_RenderQueueEntries.begin(); it != m_RenderQueueEntries.end(); ++it)
+      this->ResolveRenderQueueProperties(it->second);
+
+    m_RenderQueueStructureVersion = structureVersion;
+    m_RenderQueueModified = true;
+  }
+
+  if (!m_RenderQueueModified)
+    return false;
+
+  m_RenderQueue.clear();
+
+  for (auto it = m_RenderQueueEntries.begin(); it != m_RenderQueueEntries.end(); ++it)
+  {
+    RenderQueueEntry &entry = it->second;
+
+    // nodes without a visibility property are visible, nodes without a layer property get layer number 1
+    auto visibleProperty = dynamic_cast<BoolProperty *>(entry.VisibleProperty.GetPointer());
+    const bool visible = visibleProperty == nullptr || visibleProperty->GetValue();
+
+    auto layerProperty = dynamic_cast<IntProperty *>(entry.LayerProperty.GetPointer());
+    entry.Layer = layerProperty != nullptr ? layerProperty->GetValue() : 1;
+
+    if (entry.Visible && !visible)
+      m_HiddenNodes.push_back(entry.Node);
+
+    entry.Visible = visible;
+
+    if (visible)
+      m_RenderQueue.push_back(&entry);
+  }
+
+  std::sort(m_RenderQueue.begin(), m_RenderQueue.end(), [](const RenderQueueEntry *a, const RenderQueueEntry *b) {
+    return a->Layer < b->Layer || (a->Layer == b->Layer && a->Order < b->Order);
+  });
+
+  m_RenderQueueModified = false;
+  return true;
+}
+
+void mitk::VtkPropRenderer::OnNodeAdded(const DataNode *node)
+{
+  this->AddRenderQueueEntry(node);
+}
+
+void mitk::VtkPropRenderer::OnNodeRemoved(const DataNode *node)
+{
+  auto it = m_RenderQueueEntries.find(node);
+  if (it == m_RenderQueueEntries.end())
+    return;
+
+  // the entry must not be used after this method returns, m_RenderQueue is sorted again anyway
+  m_RenderQueue.erase(std::remove(m_RenderQueue.begin(), m_RenderQueue.end(), &it->second), m_RenderQueue.end());
+  m_HiddenNodes.erase(std::remove(m_HiddenNodes.begin(), m_HiddenNodes.end(), it->second.Node), m_HiddenNodes.end());
+
+  this->RemoveRenderQueueObservers(it->second);
+  m_RenderQueueEntries.erase(it);
+  m_RenderQueueModified = true;
+}
+
+void mitk::VtkPropRenderer::OnRenderQueuePropertyModified()
+{
+  m_RenderQueueModified = true;
+}
+
+void mitk::VtkPropRenderer::UpdateRenderQueueBounds(RenderQueueEntry &entry)
+{
+  BaseData *data = entry.Node->GetData();
+
+  if (data == nullptr)
+  {
+    entry.BoundsData = nullptr;
+    entry.HasBounds = false;
+    return;
+  }
+
+  // Update the geometry before the times are compared: a moved geometry of a time step only modifies the time
+  // geometry (and the data) when the time geometry updates its bounding box.
+  const TimeGeometry *geometry = data->GetUpdatedTimeGeometry();
+  const unsigned long geometryTime = geometry != nullptr ? geometry->GetMTime() : 0;
+
+  if (data == entry.BoundsData && data->GetMTime() == entry.BoundsTime && geometry == entry.BoundsGeometry &&
+      geometryTime == entry.BoundsGeometryTime)
+    return;
+
+  entry.BoundsData = data;
+  entry.BoundsGeometry = geometry;
+  entry.HasBounds = false;
+
+  if (!data->IsEmpty())
+  {
+    if (geometry != nullptr)
+    {
+      // Needed for check of zero bounding boxes
+      mitk::ScalarType nullpoint[] = {0, 0, 0, 0, 0, 0};
+      BoundingBox::BoundsArrayType itkBoundsZero(nullpoint);
+
+      // bounding box (only if non-zero)
+      if (geometry->GetBoundingBoxInWorld()->GetBounds() != itkBoundsZero)
+      {
+        for (unsigned char i = 0; i < 8; ++i)
+        {
+          const Point3D point = geometry->GetCornerPointInWorld(i);
+          if (point[0] * point[0] + point[1] * point[1] + point[2] * point[2] >= large)
+          {
+            itkGenericOutputMacro(<< "Unrealistically distant corner point encountered. Ignored. Node: "
+                                  << entry.Node);
+            continue;
+          }
+
+          if (!entry.HasBounds)
+          {
+            entry.BoundsMinimum = point;
+            entry.BoundsMaximum = point;
+            entry.HasBounds = true;
+            continue;
+          }
+
+          for (unsigned int d = 0; d < 3; ++d)
+          {
+            entry.BoundsMinimum[d] = std::min(entry.BoundsMinimum[d], point[d]);
+            entry.BoundsMaximum[d] = std::max(entry.BoundsMaximum[d], point[d]);
+          }
+        }
+      }
+    }
+  }
+
+  entry.BoundsTime = data->GetMTime();
+  entry.BoundsGeometryTime = geometryTime;
+}
+
+mitk::BoundingBox::Pointer mitk::VtkPropRenderer::ComputeVisibleBoundingBox(const BaseRenderer *renderer,
+                                                                             const char *boolPropertyKey)
+{
+  BoundingBox::PointsContainer::Pointer pointscontainer = BoundingBox::PointsContainer::New();
+  BoundingBox::PointIdentifier pointid = 0;
+
+  auto includeBounds = [&](RenderQueueEntry &entry) {
+    if (!entry.Node->IsOn(boolPropertyKey, renderer))
+      return;
+
+    this->UpdateRenderQueueBounds(entry);
+
+    if (entry.HasBounds)
+    {
+      pointscontainer->InsertElement(pointid++, entry.BoundsMinimum);
+      pointscontainer->InsertElement(pointid++, entry.BoundsMaximum);
+    }
+  };
+
+  if (renderer == this)
+  {
+    // the render queue holds exactly the nodes that are visible in this renderer
+    this->UpdateRenderQueue();
+
+    for (auto it = m_RenderQueue.cbegin(); it != m_RenderQueue.cend(); ++it)
+      includeBounds(**it);
+  }
+  else
+  {
+    for (auto it = m_RenderQueueEntries.begin(); it != m_RenderQueueEntries.end(); ++it)
+    {
+      if (it->second.Node->IsOn("visible", renderer))
+        includeBounds(it->second);
+    }
+  }
+
+  BoundingBox::Pointer result = BoundingBox::New();
+  result->SetPoints(pointscontainer);
+  result->ComputeBoundingBox();
+
+  return result;
+}
+
 void mitk::VtkPropRenderer::Update(mitk::DataNode *datatreenode)
 {
   if (datatreenode != nullptr)
@@ -285,9 +571,20 @@ void mitk::VtkPropRenderer::Update()
   if (m_DataStorage.IsNull())
     return;
 
-  mitk::DataStorage::SetOfObjects::ConstPointer all = m_DataStorage->GetAll();
-  for (mitk::DataStorage::SetOfObjects::ConstIterator it = all->Begin(); it != all->End(); ++it)
-    Update(it->Value());
+  this->UpdateRenderQueue();
+
+  // mappers may add or remove nodes while they are updated, so the nodes are collected first
+  std::vector<DataNode::Pointer> nodes;
+  nodes.reserve(m_RenderQueue.size() + m_HiddenNodes.size());
+  for (auto it = m_RenderQueue.cbegin(); it != m_RenderQueue.cend(); ++it)
+    nodes.push_back((*it)->Node);
+
+  // the mappers of nodes that were hidden since the last update hide their props
+  nodes.insert(nodes.end(), m_HiddenNodes.begin(), m_HiddenNodes.end());
+  m_HiddenNodes.clear();
+
+  for (auto it = nodes.begin(); it != nodes.end(); ++it)
+    Update(*it);
 
   Modified();
   m_LastUpdateTime = GetMTime();
@@ -431,14 +728,19 @@ mitk::DataNode *mitk::VtkPropRenderer::PickObject(const Point2D &displayPosition
 {
   m_CellPicker->InitializePickList();
 
-  // Iterate over all DataStorage objects to determine all vtkProps intended
+  // Hidden nodes cannot be picked, only the nodes of the render queue are considered
+  auto self = const_cast<mitk::VtkPropRenderer *>(this);
+  self->UpdateRenderQueue();
+  std::vector<DataNode::Pointer> nodes;
+  nodes.reserve(m_RenderQueue.size());
+  for (auto it = m_RenderQueue.cbegin(); it != m_RenderQueue.cend(); ++it)
+    nodes.push_back((*it)->Node);
+
+  // Iterate over the visible nodes to determine all vtkProps intended
   // for picking
-  DataStorage::SetOfObjects::ConstPointer allObjects = m_DataStorage->GetAll();
-  for (DataStorage::SetOfObjects::ConstIterator it = allObjects->Begin(); it != allObjects->End(); ++it)
+  for (auto it = nodes.cbegin(); it != nodes.cend(); ++it)
   {
-    const DataNode *node = it->Value();
-    if (node == nullptr)
-      continue;
+    const DataNode *node = *it;
 
     bool pickable = false;
     node->GetBoolProperty("pickable", pickable);
@@ -469,13 +771,11 @@ mitk::DataNode *mitk::VtkPropRenderer::PickObject(const Point2D &displayPosition
     return nullptr;
   }
 
-  // Iterate over all DataStorage objects to determine if the retrieved
+  // Iterate over the visible nodes to determine if the retrieved
   // vtkProp is owned by any associated mapper.
-  for (DataStorage::SetOfObjects::ConstIterator it = allObjects->Begin(); it != allObjects->End(); ++it)
+  for (auto it = nodes.cbegin(); it != nodes.cend(); ++it)
   {
-    DataNode::Pointer node = it->Value();
-    if (node.IsNull())
-      continue;
+    DataNode::Pointer node = *it;
 
     mitk::Mapper *mapper = node->GetMapper(m_MapperID);
     if (mapper == nullptr)
@@ -486,7 +786,7 @@ mitk::DataNode *mitk::VtkPropRenderer::PickObject(const Point2D &displayPosition
     if (vtkmapper)
     {
       // if vtk-based, then ...
-      if (vtkmapper->HasVtkProp(prop, const_cast<mitk::VtkPropRenderer *>(this)))
+      if (vtkmapper->HasVtkProp(prop, self))
       {
         return node;
       }
@@ -523,14 +823,16 @@ void mitk::VtkPropRenderer::UpdatePaths()
     // Create the list to hold all the paths
     m_Paths = vtkSmartPointer<vtkAssemblyPaths>::New();
 
-    DataStorage::SetOfObjects::ConstPointer objects = m_DataStorage->GetAll();
-    for (DataStorage::SetOfObjects::const_iterator iter = objects->begin(); iter != objects->end(); ++iter)
+    // props of hidden nodes are not visible
+    this->UpdateRenderQueue();
+    for (auto iter = m_RenderQueue.cbegin(); iter != m_RenderQueue.cend(); ++iter)
     {
       vtkSmartPointer<vtkAssemblyPath> onePath = vtkSmartPointer<vtkAssemblyPath>::New();
-      Mapper *mapper = (*iter)->GetMapper(BaseRenderer::Standard3D);
+      Mapper *mapper = (*iter)->Node->GetMapper(BaseRenderer::Standard3D);
       if (mapper)
       {
         VtkMapper *vtkmapper = dynamic_cast<VtkMapper *>(mapper);
+        if (vtkmapper)
         {
           vtkProp *prop = vtkmapper->GetVtkProp(this);
           if (prop && prop->GetVisibility())
@@ -563,14 +865,10 @@ void mitk::VtkPropRenderer::ReleaseGraphicsResources(vtkWindow * /*renWin*/)
   if (m_DataStorage.IsNull())
     return;
 
-  DataStorage::SetOfObjects::ConstPointer allObjects = m_DataStorage->GetAll();
-  for (DataStorage::SetOfObjects::const_iterator iter = allObjects->begin(); iter != allObjects->end(); ++iter)
+  // hidden nodes may hold graphics resources as well
+  for (auto iter = m_RenderQueueEntries.cbegin(); iter != m_RenderQueueEntries.cend(); ++iter)
   {
-    DataNode::Pointer node = *iter;
-    if (node.IsNull())
-      continue;
-
-    Mapper *mapper = node->GetMapper(m_MapperID);
+    Mapper *mapper = iter->second.Node->GetMapper(m_MapperID);
 
     if (mapper)
     {
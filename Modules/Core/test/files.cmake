@@ -38,6 +38,9 @@ set(MODULE_TESTS
   mitkImageCastTest.cpp
   mitkImageEqualTest.cpp
   mitkImageDataItemTest.cpp
+  mitkImageRegionAccessorTest.cpp
+  mitkImageSliceCacheTest.cpp
+  mitkExternalImageMemoryTest.cpp
   mitkImageGeneratorTest.cpp
   mitkIOUtilTest.cpp
   mitkBaseDataTest.cpp
@@ -59,6 +62,7 @@ set(MODULE_TESTS
   mitkProgressBarTest.cpp
   mitkPropertyTest.cpp
   mitkPropertyListTest.cpp
+  mitkPropertyHandleTest.cpp
   mitkPropertyPersistenceTest.cpp
   mitkPropertyPersistenceInfoTest.cpp
   mitkSlicedGeometry3DTest.cpp
@@ -69,6 +73,7 @@ set(MODULE_TESTS
   mitkTimeGeometryTest.cpp
   mitkProportionalTimeGeometryTest.cpp
   mitkUndoControllerTest.cpp
+  mitkLimitedLinearUndoTest.cpp
   mitkVtkWidgetRenderingTest.cpp
   mitkVerboseLimitedLinearUndoTest.cpp
   mitkWeakPointerTest.cpp
@@ -118,6 +123,11 @@ set(MODULE_TESTS
   mitkNodePredicateGeometryTest.cpp
 )
 
+# tests that also provide benchmarks, run with the argument "benchmark" if MITK_ENABLE_BENCHMARK_TESTING is ON
+set(MODULE_BENCHMARK_TESTS
+  mitkItkImageIOTest.cpp
+)
+
 if(MITK_ENABLE_RENDERING_TESTING)
 set(MODULE_TESTS
   ${MODULE_TESTS}
@@ -125,6 +135,7 @@ set(MODULE_TESTS
   mitkPointSetDataInteractorTest.cpp #since mitkInteractionTestHelper is currently creating a vtkRenderWindow
   mitkSurfaceVtkMapper2DTest.cpp #new rendering test in CppUnit style
   mitkSurfaceVtkMapper2D3DTest.cpp # comparisons/consistency 2D/3D
+  mitkVtkPropRendererRenderQueueTest.cpp
 )
 endif()
 
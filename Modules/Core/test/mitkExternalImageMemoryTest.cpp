@@ -0,0 +1,219 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include "mitkIOUtil.h"
+#include "mitkImage.h"
+#include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
+#include "mitkMappedImageMemory.h"
+#include "mitkProgressiveImageMemory.h"
+
+#include <itksys/SystemTools.hxx>
+
+#include "itk_zlib.h"
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+class mitkExternalImageMemoryTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkExternalImageMemoryTestSuite);
+  MITK_TEST(MappedMemory_IsCopyOnWrite);
+  MITK_TEST(MappedMemory_SurvivesOverwriteAfterDetach);
+  MITK_TEST(MappedMemory_TooSmallFile_Throws);
+  MITK_TEST(ProgressiveMemory_InflatesConcatenatedMembers);
+  MITK_TEST(ProgressiveMemory_ImportedImage_AccessorWaits);
+  MITK_TEST(ProgressiveMemory_TruncatedFile_Throws);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  static const unsigned int m_NumberOfTimeSteps = 4;
+  static const unsigned int m_VoxelsPerTimeStep = 32 * 16 * 8;
+
+  std::vector<int> m_Pixels;
+  std::vector<std::string> m_Files;
+
+  std::string CreateFile(const std::vector<char> &content)
+  {
+    std::ofstream stream;
+    std::string fileName = mitk::IOUtil::CreateTemporaryFile(stream, std::ios_base::out | std::ios_base::binary);
+    stream.write(content.data(), content.size());
+    stream.close();
+    m_Files.push_back(fileName);
+    return fileName;
+  }
+
+  /** Appends one gzip member holding [begin, end) to output */
+  static void AppendGzipMember(const char *begin, const char *end, std::vector<char> &output)
+  {
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    // 15 + 16: gzip wrapper
+    CPPUNIT_ASSERT_EQUAL(Z_OK, deflateInit2(&stream, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY));
+
+    std::vector<char> buffer(deflateBound(&stream, static_cast<uLong>(end - begin)));
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(begin));
+    stream.avail_in = static_cast<uInt>(end - begin);
+    stream.next_out = reinterpret_cast<Bytef *>(&buffer[0]);
+    stream.avail_out = static_cast<uInt>(buffer.size());
+    CPPUNIT_ASSERT_EQUAL(Z_STREAM_END, deflate(&stream, Z_FINISH));
+    output.insert(output.end(), buffer.begin(), buffer.begin() + (buffer.size() - stream.avail_out));
+    deflateEnd(&stream);
+  }
+
+  /** Writes junk, followed by two gzip members holding a header of headerSize bytes and m_Pixels */
+  std::string CreateCompressedFile(unsigned int junkSize, unsigned int headerSize)
+  {
+    std::vector<char> uncompressed(headerSize, 'h');
+    const char *pixels = reinterpret_cast<const char *>(m_Pixels.data());
+    uncompressed.insert(uncompressed.end(), pixels, pixels + m_Pixels.size() * sizeof(int));
+
+    std::vector<char> content(junkSize, 'j');
+    const size_t split = uncompressed.size() / 3;
+    AppendGzipMember(&uncompressed[0], &uncompressed[0] + split, content);
+    AppendGzipMember(&uncompressed[0] + split, &uncompressed[0] + uncompressed.size(), content);
+    return CreateFile(content);
+  }
+
+  size_t GetSize() const { return m_Pixels.size() * sizeof(int); }
+public:
+  void setUp() override
+  {
+    m_Pixels.resize(m_NumberOfTimeSteps * m_VoxelsPerTimeStep);
+    for (size_t i = 0; i < m_Pixels.size(); ++i)
+    {
+      m_Pixels[i] = static_cast<int>(i * 7 + 3);
+    }
+  }
+
+  void tearDown() override
+  {
+    for (const auto &fileName : m_Files)
+    {
+      itksys::SystemTools::RemoveFile(fileName.c_str());
+    }
+    m_Files.clear();
+  }
+
+  void MappedMemory_IsCopyOnWrite()
+  {
+    // an odd header size gives an offset that is not page aligned
+    std::vector<char> content(13, 'h');
+    const char *pixels = reinterpret_cast<const char *>(m_Pixels.data());
+    content.insert(content.end(), pixels, pixels + GetSize());
+    std::string fileName = CreateFile(content);
+
+    {
+      mitk::MappedImageMemory::Pointer memory = mitk::MappedImageMemory::New(fileName, 13, GetSize());
+      CPPUNIT_ASSERT_EQUAL(GetSize(), memory->GetSize());
+      CPPUNIT_ASSERT(std::memcmp(memory->GetData(), m_Pixels.data(), GetSize()) == 0);
+      CPPUNIT_ASSERT(memory->IsAvailable(memory->GetData(), static_cast<char *>(memory->GetData()) + GetSize()));
+
+      std::memset(memory->GetData(), 0, GetSize());
+    }
+
+    std::ifstream stream(fileName.c_str(), std::ios_base::in | std::ios_base::binary);
+    std::vector<char> reread(content.size());
+    stream.read(&reread[0], reread.size());
+    CPPUNIT_ASSERT_MESSAGE("Mapped file was modified", reread == content);
+  }
+
+  void MappedMemory_SurvivesOverwriteAfterDetach()
+  {
+    const char *pixels = reinterpret_cast<const char *>(m_Pixels.data());
+    std::string fileName = CreateFile(std::vector<char>(pixels, pixels + GetSize()));
+
+    mitk::MappedImageMemory::Pointer memory = mitk::MappedImageMemory::New(fileName, 0, GetSize());
+    memory->Detach();
+    CPPUNIT_ASSERT(memory->IsDetached());
+
+    // truncate the file, untouched pages of a mapping would not be readable anymore
+    std::ofstream stream(fileName.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    stream.write("x", 1);
+    stream.close();
+
+    CPPUNIT_ASSERT(std::memcmp(memory->GetData(), m_Pixels.data(), GetSize()) == 0);
+  }
+
+  void MappedMemory_TooSmallFile_Throws()
+  {
+    std::string fileName = CreateFile(std::vector<char>(100, 'x'));
+    CPPUNIT_ASSERT_THROW(mitk::MappedImageMemory::New(fileName, 50, 51), mitk::Exception);
+    CPPUNIT_ASSERT_THROW(mitk::MappedImageMemory::New(fileName + ".missing", 0, 1), mitk::Exception);
+  }
+
+  void ProgressiveMemory_InflatesConcatenatedMembers()
+  {
+    std::string fileName = CreateCompressedFile(21, 352);
+
+    mitk::ProgressiveImageMemory::Pointer memory =
+      mitk::ProgressiveImageMemory::New(fileName, 21, 352, GetSize(), m_NumberOfTimeSteps);
+    CPPUNIT_ASSERT_EQUAL(0u, memory->GetNumberOfLoadedTimeSteps());
+    memory->Start();
+    CPPUNIT_ASSERT_EQUAL(m_NumberOfTimeSteps, memory->GetNumberOfTimeSteps());
+    CPPUNIT_ASSERT(memory->GetNumberOfLoadedTimeSteps() >= 1);
+
+    char *data = static_cast<char *>(memory->GetData());
+    CPPUNIT_ASSERT(memory->IsAvailable(data, data + GetSize() / m_NumberOfTimeSteps));
+
+    memory->WaitUntilAvailable(data, data + GetSize());
+    CPPUNIT_ASSERT_EQUAL(m_NumberOfTimeSteps, memory->GetNumberOfLoadedTimeSteps());
+    CPPUNIT_ASSERT(memory->IsAvailable(data, data + GetSize()));
+    CPPUNIT_ASSERT(std::memcmp(data, m_Pixels.data(), GetSize()) == 0);
+  }
+
+  void ProgressiveMemory_ImportedImage_AccessorWaits()
+  {
+    std::string fileName = CreateCompressedFile(0, 0);
+
+    unsigned int dimensions[4] = {32, 16, 8, m_NumberOfTimeSteps};
+    mitk::Image::Pointer image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<int>(), 4, dimensions);
+    mitk::ProgressiveImageMemory::Pointer memory =
+      mitk::ProgressiveImageMemory::New(fileName, 0, 0, GetSize(), m_NumberOfTimeSteps);
+    memory->Start();
+    CPPUNIT_ASSERT(image->SetImportChannel(memory));
+    CPPUNIT_ASSERT(image->IsTimeStepAvailable(0));
+
+    mitk::ImageReadAccessor lastTimeStep(image.GetPointer(), image->GetVolumeData(m_NumberOfTimeSteps - 1));
+    CPPUNIT_ASSERT(image->IsTimeStepAvailable(m_NumberOfTimeSteps - 1));
+    CPPUNIT_ASSERT(std::memcmp(lastTimeStep.GetData(),
+                               &m_Pixels[(m_NumberOfTimeSteps - 1) * m_VoxelsPerTimeStep],
+                               m_VoxelsPerTimeStep * sizeof(int)) == 0);
+
+    mitk::ImageReadAccessor whole(image.GetPointer());
+    CPPUNIT_ASSERT(std::memcmp(whole.GetData(), m_Pixels.data(), GetSize()) == 0);
+  }
+
+  void ProgressiveMemory_TruncatedFile_Throws()
+  {
+    std::string fileName = CreateCompressedFile(0, 0);
+    std::ifstream stream(fileName.c_str(), std::ios_base::in | std::ios_base::binary);
+    std::vector<char> content(64);
+    stream.read(&content[0], content.size());
+    std::string truncatedFileName = CreateFile(content);
+
+    mitk::ProgressiveImageMemory::Pointer memory =
+      mitk::ProgressiveImageMemory::New(truncatedFileName, 0, 0, GetSize(), m_NumberOfTimeSteps);
+    CPPUNIT_ASSERT_THROW(memory->Start(), mitk::Exception);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkExternalImageMemory)
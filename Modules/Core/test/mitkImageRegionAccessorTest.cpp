@@ -0,0 +1,283 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include "mitkImage.h"
+#include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+class mitkImageRegionAccessorTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkImageRegionAccessorTestSuite);
+  MITK_TEST(SliceRegion_IsCoherent);
+  MITK_TEST(BoundingBoxRegion_HasOneIntervalPerRow);
+  MITK_TEST(InvalidRegion_Throws);
+  MITK_TEST(DisjointSliceWriters_DoNotBlock);
+  MITK_TEST(InterleavedBoundingBoxes_DoNotBlock);
+  MITK_TEST(OverlappingWriter_IsLocked);
+  MITK_TEST(ReaderOfWholeImage_WaitsForRegionWriter);
+  MITK_TEST(ConcurrentSliceWriters_Stress);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_Image;
+  unsigned int m_Dimensions[3];
+
+  mitk::ImageAccessorBase::RegionType CreateBox(
+    unsigned int x, unsigned int y, unsigned int z, unsigned int sx, unsigned int sy, unsigned int sz)
+  {
+    mitk::ImageAccessorBase::RegionType::IndexType index;
+    index[0] = x;
+    index[1] = y;
+    index[2] = z;
+    index[3] = 0;
+    mitk::ImageAccessorBase::RegionType::SizeType size;
+    size[0] = sx;
+    size[1] = sy;
+    size[2] = sz;
+    size[3] = 1;
+    return mitk::ImageAccessorBase::RegionType(index, size);
+  }
+
+  /** Tries to get write access to region from a second thread, returns true if the region was locked. */
+  bool IsLockedForOtherThread(const mitk::ImageAccessorBase::RegionType &region)
+  {
+    bool locked = false;
+    std::thread other([this, &region, &locked]()
+    {
+      try
+      {
+        mitk::ImageWriteAccessor accessor(m_Image, region, nullptr, mitk::ImageAccessorBase::ExceptionIfLocked);
+      }
+      catch (const mitk::MemoryIsLockedException &)
+      {
+        locked = true;
+      }
+    });
+    other.join();
+    return locked;
+  }
+
+public:
+  void setUp() override
+  {
+    m_Dimensions[0] = 64;
+    m_Dimensions[1] = 48;
+    m_Dimensions[2] = 32;
+    m_Image = mitk::Image::New();
+    m_Image->Initialize(mitk::MakeScalarPixelType<int>(), 3, m_Dimensions);
+
+    mitk::ImageWriteAccessor accessor(m_Image);
+    std::fill_n(static_cast<int *>(accessor.GetData()), m_Dimensions[0] * m_Dimensions[1] * m_Dimensions[2], 0);
+  }
+
+  void tearDown() override { m_Image = nullptr; }
+  void SliceRegion_IsCoherent()
+  {
+    mitk::ImageWriteAccessor whole(m_Image);
+    const unsigned char *base = static_cast<const unsigned char *>(whole.GetData());
+    const unsigned long sliceBytes = m_Dimensions[0] * m_Dimensions[1] * sizeof(int);
+
+    mitk::ImageReadAccessor slice(
+      m_Image.GetPointer(), mitk::ImageAccessorBase::CreateSliceRegion(m_Image, 5), nullptr,
+      mitk::ImageAccessorBase::IgnoreLock);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), slice.GetMemoryIntervals().size());
+    CPPUNIT_ASSERT(slice.GetData() == base + 5 * sliceBytes);
+    CPPUNIT_ASSERT(slice.GetMemoryIntervals().front().second == base + 6 * sliceBytes);
+
+    mitk::ImageReadAccessor slab(
+      m_Image.GetPointer(), mitk::ImageAccessorBase::CreateSlabRegion(m_Image, 2, 3), nullptr,
+      mitk::ImageAccessorBase::IgnoreLock);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), slab.GetMemoryIntervals().size());
+    CPPUNIT_ASSERT(slab.GetMemoryIntervals().front().second == base + 5 * sliceBytes);
+  }
+
+  void BoundingBoxRegion_HasOneIntervalPerRow()
+  {
+    mitk::ImageWriteAccessor box(m_Image, CreateBox(3, 4, 5, 10, 6, 2));
+    CPPUNIT_ASSERT(box.HasSubRegion());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(12), box.GetMemoryIntervals().size());
+    for (const auto &interval : box.GetMemoryIntervals())
+    {
+      CPPUNIT_ASSERT_EQUAL(std::ptrdiff_t(10 * sizeof(int)), interval.second - interval.first);
+    }
+
+    // rows spanning the full width collapse into one interval per slice
+    mitk::ImageWriteAccessor rows(m_Image, CreateBox(0, 4, 10, m_Dimensions[0], 6, 2));
+    CPPUNIT_ASSERT_EQUAL(std::size_t(2), rows.GetMemoryIntervals().size());
+  }
+
+  void InvalidRegion_Throws()
+  {
+    CPPUNIT_ASSERT_THROW(mitk::ImageWriteAccessor(m_Image, CreateBox(60, 0, 0, 10, 1, 1)), mitk::Exception);
+    CPPUNIT_ASSERT_THROW(mitk::ImageWriteAccessor(m_Image, CreateBox(0, 0, 0, 0, 1, 1)), mitk::Exception);
+    CPPUNIT_ASSERT_THROW(mitk::ImageWriteAccessor(m_Image, mitk::ImageAccessorBase::CreateSliceRegion(m_Image, 32)),
+                         mitk::Exception);
+  }
+
+  void DisjointSliceWriters_DoNotBlock()
+  {
+    mitk::ImageWriteAccessor first(m_Image, mitk::ImageAccessorBase::CreateSliceRegion(m_Image, 0));
+    CPPUNIT_ASSERT_NO_THROW(mitk::ImageWriteAccessor(m_Image,
+                                                     mitk::ImageAccessorBase::CreateSliceRegion(m_Image, 1),
+                                                     nullptr,
+                                                     mitk::ImageAccessorBase::ExceptionIfLocked));
+    CPPUNIT_ASSERT(!IsLockedForOtherThread(mitk::ImageAccessorBase::CreateSlabRegion(m_Image, 1, 31)));
+  }
+
+  void InterleavedBoundingBoxes_DoNotBlock()
+  {
+    // both boxes span the same rows, their enclosing address ranges interleave
+    mitk::ImageWriteAccessor left(m_Image, CreateBox(0, 0, 0, 32, 48, 32));
+    CPPUNIT_ASSERT(!IsLockedForOtherThread(CreateBox(32, 0, 0, 32, 48, 32)));
+    CPPUNIT_ASSERT(IsLockedForOtherThread(CreateBox(31, 10, 10, 2, 1, 1)));
+  }
+
+  void OverlappingWriter_IsLocked()
+  {
+    mitk::ImageWriteAccessor slab(m_Image, mitk::ImageAccessorBase::CreateSlabRegion(m_Image, 8, 4));
+    CPPUNIT_ASSERT(IsLockedForOtherThread(mitk::ImageAccessorBase::CreateSliceRegion(m_Image, 11)));
+    CPPUNIT_ASSERT(IsLockedForOtherThread(CreateBox(20, 20, 7, 4, 4, 2)));
+    CPPUNIT_ASSERT(!IsLockedForOtherThread(mitk::ImageAccessorBase::CreateSliceRegion(m_Image, 12)));
+  }
+
+  void ReaderOfWholeImage_WaitsForRegionWriter()
+  {
+    std::atomic<bool> released(false);
+    std::atomic<bool> readerSawRelease(false);
+
+    auto writer = new mitk::ImageWriteAccessor(m_Image, mitk::ImageAccessorBase::CreateSliceRegion(m_Image, 3));
+    std::thread reader([this, &released, &readerSawRelease]()
+    {
+      mitk::ImageReadAccessor whole(m_Image.GetPointer());
+      readerSawRelease = released.load();
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    released = true;
+    delete writer;
+    reader.join();
+
+    CPPUNIT_ASSERT(readerSawRelease);
+  }
+
+  /** Hammers the lock with writers on interleaved slices and readers of slabs. Every writer fills a complete slice
+   * with one value, so a reader must never see two different values within one slice. */
+  void ConcurrentSliceWriters_Stress()
+  {
+    const unsigned int numberOfWriters = 8;
+    const unsigned int numberOfReaders = 2;
+    const unsigned int iterations = 200;
+    const unsigned int voxelsPerSlice = m_Dimensions[0] * m_Dimensions[1];
+
+    std::atomic<unsigned int> writes(0);
+    std::atomic<unsigned int> tornSlices(0);
+    std::atomic<unsigned int> errors(0);
+    std::atomic<bool> writersDone(false);
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+    for (unsigned int w = 0; w < numberOfWriters; ++w)
+    {
+      threads.emplace_back([&, w]()
+      {
+        try
+        {
+          for (unsigned int i = 0; i < iterations; ++i)
+          {
+            for (unsigned int slice = w; slice < m_Dimensions[2]; slice += numberOfWriters)
+            {
+              mitk::ImageWriteAccessor accessor(m_Image, mitk::ImageAccessorBase::CreateSliceRegion(m_Image, slice));
+              std::fill_n(static_cast<int *>(accessor.GetData()), voxelsPerSlice, static_cast<int>(i * 1000 + slice));
+              ++writes;
+            }
+          }
+        }
+        catch (const mitk::Exception &)
+        {
+          ++errors;
+        }
+      });
+    }
+
+    for (unsigned int r = 0; r < numberOfReaders; ++r)
+    {
+      threads.emplace_back([&, r]()
+      {
+        try
+        {
+          unsigned int firstSlice = r;
+          while (!writersDone)
+          {
+            mitk::ImageReadAccessor accessor(m_Image.GetPointer(),
+                                             mitk::ImageAccessorBase::CreateSlabRegion(m_Image, firstSlice, 4));
+            const int *data = static_cast<const int *>(accessor.GetData());
+            for (unsigned int slice = 0; slice < 4; ++slice)
+            {
+              const int *begin = data + slice * voxelsPerSlice;
+              if (std::find_if(begin, begin + voxelsPerSlice, [begin](int v) { return v != *begin; }) !=
+                  begin + voxelsPerSlice)
+              {
+                ++tornSlices;
+              }
+            }
+            firstSlice = (firstSlice + 3) % (m_Dimensions[2] - 4);
+          }
+        }
+        catch (const mitk::Exception &)
+        {
+          ++errors;
+        }
+      });
+    }
+
+    for (unsigned int w = 0; w < numberOfWriters; ++w)
+    {
+      threads[w].join();
+    }
+    writersDone = true;
+    for (unsigned int r = numberOfWriters; r < threads.size(); ++r)
+    {
+      threads[r].join();
+    }
+
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    MITK_INFO << writes << " slice writes by " << numberOfWriters << " writers and " << numberOfReaders
+              << " slab readers in " << seconds << " s (" << writes / seconds << " writes/s)";
+
+    CPPUNIT_ASSERT_EQUAL(0u, errors.load());
+    CPPUNIT_ASSERT_EQUAL(0u, tornSlices.load());
+    CPPUNIT_ASSERT_EQUAL(iterations * m_Dimensions[2], writes.load());
+
+    mitk::ImageReadAccessor result(m_Image.GetPointer());
+    const int *data = static_cast<const int *>(result.GetData());
+    for (unsigned int slice = 0; slice < m_Dimensions[2]; ++slice)
+    {
+      CPPUNIT_ASSERT_EQUAL(static_cast<int>((iterations - 1) * 1000 + slice), data[slice * voxelsPerSlice]);
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkImageRegionAccessor)
@@ -0,0 +1,199 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include "mitkImageSliceCache.h"
+#include "mitkImageWriteAccessor.h"
+#include "vtkMitkThickSlicesFilter.h"
+
+#include <itksys/SystemTools.hxx>
+
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+
+#include <cstring>
+
+class mitkImageSliceCacheTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkImageSliceCacheTestSuite);
+  MITK_TEST(Get_ReturnsAddedSlice);
+  MITK_TEST(Get_ModifiedImage_Misses);
+  MITK_TEST(Add_DropsLeastRecentlyUsed);
+  MITK_TEST(GetNearest_MovesSliceToRequestedPlane);
+  MITK_TEST(Prefetch_ResliceEqualsSynchronous);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_Image;
+  mitk::ImageSliceCache::Pointer m_Cache;
+
+  mitk::ImageSliceCache::Request CreateRequest(int sliceIndex)
+  {
+    mitk::PlaneGeometry::Pointer plane = mitk::PlaneGeometry::New();
+    plane->InitializeStandardPlane(m_Image->GetGeometry(), mitk::PlaneGeometry::Axial, sliceIndex);
+
+    mitk::ImageSliceCache::Request request;
+    request.Input = m_Image.GetPointer();
+    request.InputMTime = m_Image->GetMTime();
+    request.WorldGeometry = plane.GetPointer();
+    return request;
+  }
+
+  mitk::ImageSliceCache::Slice::Pointer Reslice(const mitk::ImageSliceCache::Request &request)
+  {
+    return mitk::ImageSliceCache::Reslice(
+      request, mitk::ExtractSliceFilter::New(), vtkSmartPointer<vtkMitkThickSlicesFilter>::New());
+  }
+
+public:
+  void setUp() override
+  {
+    unsigned int dimensions[3] = {16, 12, 8};
+    m_Image = mitk::Image::New();
+    m_Image->Initialize(mitk::MakeScalarPixelType<int>(), 3, dimensions);
+    {
+      mitk::ImageWriteAccessor access(m_Image);
+      int *pixels = static_cast<int *>(access.GetData());
+      for (unsigned int i = 0; i < 16 * 12 * 8; ++i)
+      {
+        pixels[i] = static_cast<int>(i);
+      }
+    }
+
+    m_Cache = mitk::ImageSliceCache::New();
+  }
+
+  void tearDown() override
+  {
+    m_Cache = nullptr;
+    m_Image = nullptr;
+  }
+
+  void Get_ReturnsAddedSlice()
+  {
+    mitk::ImageSliceCache::Request request = this->CreateRequest(3);
+    CPPUNIT_ASSERT(m_Cache->Get(request).IsNull());
+
+    mitk::ImageSliceCache::Slice::Pointer slice = this->Reslice(request);
+    m_Cache->Add(request, slice);
+
+    // an equal plane that is a different object
+    CPPUNIT_ASSERT(m_Cache->Get(this->CreateRequest(3)) == slice);
+    CPPUNIT_ASSERT(m_Cache->Get(this->CreateRequest(4)).IsNull());
+
+    mitk::ImageSliceCache::Request linear = this->CreateRequest(3);
+    linear.Interpolation = mitk::ExtractSliceFilter::RESLICE_LINEAR;
+    CPPUNIT_ASSERT(m_Cache->Get(linear).IsNull());
+
+    // thick slices only match with the same spacing
+    mitk::ImageSliceCache::Request thick = this->CreateRequest(3);
+    thick.ThickSlicesMode = 1;
+    thick.ThickSlicesNum = 2;
+    thick.ThickSlicesSpacing = 1.0;
+    m_Cache->Add(thick, this->Reslice(thick));
+    CPPUNIT_ASSERT(m_Cache->Get(thick).IsNotNull());
+    thick.ThickSlicesSpacing = 0.5;
+    CPPUNIT_ASSERT(m_Cache->Get(thick).IsNull());
+    CPPUNIT_ASSERT(m_Cache->GetNearest(thick).IsNull());
+  }
+
+  void Get_ModifiedImage_Misses()
+  {
+    mitk::ImageSliceCache::Request request = this->CreateRequest(3);
+    m_Cache->Add(request, this->Reslice(request));
+
+    m_Image->Modified();
+    CPPUNIT_ASSERT(m_Cache->Get(this->CreateRequest(3)).IsNull());
+  }
+
+  void Add_DropsLeastRecentlyUsed()
+  {
+    m_Cache->SetMaximumNumberOfSlices(2);
+    for (int i = 0; i < 2; ++i)
+    {
+      mitk::ImageSliceCache::Request request = this->CreateRequest(i);
+      m_Cache->Add(request, this->Reslice(request));
+    }
+
+    // slice 0 becomes the most recently used one, slice 1 is dropped
+    CPPUNIT_ASSERT(m_Cache->Get(this->CreateRequest(0)).IsNotNull());
+    mitk::ImageSliceCache::Request request = this->CreateRequest(2);
+    m_Cache->Add(request, this->Reslice(request));
+
+    CPPUNIT_ASSERT_EQUAL(2u, m_Cache->GetNumberOfSlices());
+    CPPUNIT_ASSERT(m_Cache->Get(this->CreateRequest(0)).IsNotNull());
+    CPPUNIT_ASSERT(m_Cache->Get(this->CreateRequest(1)).IsNull());
+    CPPUNIT_ASSERT(m_Cache->Get(this->CreateRequest(2)).IsNotNull());
+  }
+
+  void GetNearest_MovesSliceToRequestedPlane()
+  {
+    CPPUNIT_ASSERT(m_Cache->GetNearest(this->CreateRequest(4)).IsNull());
+
+    for (int i : {1, 6})
+    {
+      mitk::ImageSliceCache::Request request = this->CreateRequest(i);
+      m_Cache->Add(request, this->Reslice(request));
+    }
+
+    mitk::ImageSliceCache::Request request = this->CreateRequest(5);
+    mitk::ImageSliceCache::Slice::Pointer nearest = m_Cache->GetNearest(request);
+    CPPUNIT_ASSERT(nearest.IsNotNull());
+
+    mitk::ImageSliceCache::Slice::Pointer cached = m_Cache->Get(this->CreateRequest(6));
+    CPPUNIT_ASSERT(nearest->Image == cached->Image);
+
+    // the exact slice has the axes the nearest slice was moved to
+    mitk::ImageSliceCache::Slice::Pointer exact = this->Reslice(request);
+    for (int row = 0; row < 4; ++row)
+    {
+      for (int column = 0; column < 4; ++column)
+      {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(
+          exact->ResliceAxes->GetElement(row, column), nearest->ResliceAxes->GetElement(row, column), mitk::eps);
+      }
+    }
+  }
+
+  void Prefetch_ResliceEqualsSynchronous()
+  {
+    mitk::ImageSliceCache::Request request = this->CreateRequest(5);
+    m_Cache->Prefetch(request);
+
+    for (int i = 0; i < 1000 && m_Cache->IsPending(request); ++i)
+    {
+      itksys::SystemTools::Delay(10);
+    }
+    CPPUNIT_ASSERT(!m_Cache->IsPending(request));
+
+    mitk::ImageSliceCache::Slice::Pointer prefetched = m_Cache->Get(request);
+    CPPUNIT_ASSERT(prefetched.IsNotNull());
+
+    mitk::ImageSliceCache::Slice::Pointer exact = this->Reslice(request);
+    CPPUNIT_ASSERT_EQUAL(exact->Image->GetNumberOfPoints(), prefetched->Image->GetNumberOfPoints());
+    CPPUNIT_ASSERT(std::memcmp(exact->Image->GetScalarPointer(),
+                               prefetched->Image->GetScalarPointer(),
+                               exact->Image->GetNumberOfPoints() * sizeof(int)) == 0);
+    for (int i = 0; i < 6; ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(exact->Bounds[i], prefetched->Bounds[i], mitk::eps);
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkImageSliceCache)
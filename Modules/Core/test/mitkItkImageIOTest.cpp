@@ -19,15 +19,26 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkTestFixture.h>
 #include <mitkTestingMacros.h>
 
+#include "mitkCoreServices.h"
 #include "mitkIOUtil.h"
+#include "mitkIPropertyPersistence.h"
 #include "mitkITKImageImport.h"
+#include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
+#include "mitkItkImageIO.h"
+#include "mitkStringProperty.h"
 #include <mitkExtractSliceFilter.h>
 
 #include "itksys/SystemTools.hxx"
 #include <itkImageRegionIterator.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 
 #ifdef WIN32
 #include "process.h"
@@ -47,6 +58,9 @@ class mitkItkImageIOTestSuite : public mitk::TestFixture
   MITK_TEST(TestWrite3DImageWithTwoPlanes);
   MITK_TEST(TestWrite3DplusT_ArbitraryTG);
   MITK_TEST(TestWrite3DplusT_ProportionalTG);
+  MITK_TEST(TestWriteCompressionOptions);
+  MITK_BENCHMARK(TestWriteThroughput_Benchmark);
+  MITK_BENCHMARK(TestReadWriteProperties_Benchmark);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -422,6 +436,206 @@ public:
     CPPUNIT_ASSERT_THROW(mitk::IOUtil::SaveImage(image, mitk::IOUtil::CreateTemporaryFile("3Dto2DTestImageXXXXXX.png")),
                          mitk::Exception);
   }
+
+  /** Creates a 3D short image of about sizeInMB megabytes with smooth, compressible content. */
+  mitk::Image::Pointer CreateCompressibleImage(unsigned int sizeInMB)
+  {
+    unsigned int dimensions[3] = {256, 256, std::max(1u, sizeInMB * 8)};
+    mitk::Image::Pointer image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<short>(), 3, dimensions);
+
+    mitk::ImageWriteAccessor accessor(image);
+    short *pixels = static_cast<short *>(accessor.GetData());
+    for (unsigned int z = 0; z < dimensions[2]; ++z)
+      for (unsigned int y = 0; y < dimensions[1]; ++y)
+        for (unsigned int x = 0; x < dimensions[0]; ++x)
+          *pixels++ = static_cast<short>((x * y / 64 + z * 3) % 2000 - 1000);
+    return image;
+  }
+
+  mitk::IFileWriter::Options CreateCompressionOptions(const std::string &compression, int level)
+  {
+    mitk::IFileWriter::Options options;
+    options[mitk::ItkImageIO::OPTION_COMPRESSION()] = us::Any(compression);
+    options[mitk::ItkImageIO::OPTION_COMPRESSION_LEVEL()] = us::Any(level);
+    return options;
+  }
+
+  /** Saves image with the given options and checks that loading it gives the same pixels. Returns the size of the
+   * written files. */
+  unsigned long SaveAndCompare(mitk::Image *image,
+                               const std::string &extension,
+                               const mitk::IFileWriter::Options &options)
+  {
+    const std::string fileName = mitk::IOUtil::CreateTemporaryFile("CompressionTestXXXXXX" + extension);
+    const std::string fileNameWithoutExt = fileName.substr(0, fileName.size() - extension.size());
+
+    mitk::IOUtil::Save(image, fileName, options);
+
+    unsigned long size = itksys::SystemTools::FileLength(fileName);
+    std::vector<std::string> dataFiles;
+    dataFiles.push_back(fileNameWithoutExt + ".raw");
+    dataFiles.push_back(fileNameWithoutExt + ".raw.gz");
+    dataFiles.push_back(fileNameWithoutExt + ".zraw");
+    for (const auto &dataFile : dataFiles)
+    {
+      if (itksys::SystemTools::FileExists(dataFile.c_str()))
+      {
+        size += itksys::SystemTools::FileLength(dataFile);
+      }
+    }
+
+    {
+      mitk::Image::Pointer compareImage = mitk::IOUtil::LoadImage(fileName);
+      CPPUNIT_ASSERT_MESSAGE("Compressed image could be loaded", compareImage.IsNotNull());
+
+      mitk::ImageReadAccessor expected(image);
+      mitk::ImageReadAccessor actual(compareImage.GetPointer());
+      const size_t bytes = image->GetPixelType().GetSize() * image->GetDimension(0) * image->GetDimension(1) *
+                           image->GetDimension(2);
+      CPPUNIT_ASSERT_MESSAGE("Pixels of " + extension + " file are unchanged",
+                             std::memcmp(expected.GetData(), actual.GetData(), bytes) == 0);
+    }
+
+    std::remove(fileName.c_str());
+    for (const auto &dataFile : dataFiles)
+    {
+      std::remove(dataFile.c_str());
+    }
+    return size;
+  }
+
+  void TestWriteCompressionOptions()
+  {
+    // more than one block of the parallel compression
+    mitk::Image::Pointer image = CreateCompressibleImage(3);
+    const unsigned long rawSize = 256 * 256 * image->GetDimension(2) * sizeof(short);
+
+    const char *extensions[] = {".nrrd", ".nhdr", ".nii.gz", ".mhd"};
+    for (const char *extension : extensions)
+    {
+      const unsigned long defaultSize =
+        SaveAndCompare(image, extension, CreateCompressionOptions(mitk::ItkImageIO::COMPRESSION_DEFAULT(), 6));
+      const unsigned long parallelSize =
+        SaveAndCompare(image, extension, CreateCompressionOptions(mitk::ItkImageIO::COMPRESSION_PARALLEL(), 6));
+      const unsigned long fastSize =
+        SaveAndCompare(image, extension, CreateCompressionOptions(mitk::ItkImageIO::COMPRESSION_PARALLEL(), 1));
+      const unsigned long smallSize =
+        SaveAndCompare(image, extension, CreateCompressionOptions(mitk::ItkImageIO::COMPRESSION_PARALLEL(), 9));
+      CPPUNIT_ASSERT(defaultSize < rawSize);
+      CPPUNIT_ASSERT(parallelSize < rawSize);
+      CPPUNIT_ASSERT(fastSize < rawSize);
+      // the level has to be passed on to zlib
+      CPPUNIT_ASSERT_MESSAGE(extension, parallelSize <= fastSize);
+      CPPUNIT_ASSERT_MESSAGE(extension, smallSize <= parallelSize);
+    }
+
+    CPPUNIT_ASSERT(SaveAndCompare(image, ".nrrd", CreateCompressionOptions(mitk::ItkImageIO::COMPRESSION_NONE(), 6)) >=
+                   rawSize);
+
+    // string literals are accepted, unknown values are rejected instead of silently using the default
+    mitk::IFileWriter::Options options = CreateCompressionOptions(mitk::ItkImageIO::COMPRESSION_NONE(), 6);
+    options[mitk::ItkImageIO::OPTION_COMPRESSION()] = us::Any(static_cast<const char *>("None"));
+    CPPUNIT_ASSERT(SaveAndCompare(image, ".nrrd", options) >= rawSize);
+
+    const std::string fileName = mitk::IOUtil::CreateTemporaryFile("CompressionTestXXXXXX.nrrd");
+    options[mitk::ItkImageIO::OPTION_COMPRESSION()] = us::Any(std::string("Fastest"));
+    CPPUNIT_ASSERT_THROW(mitk::IOUtil::Save(image, fileName, options), mitk::Exception);
+    options[mitk::ItkImageIO::OPTION_COMPRESSION()] = us::Any(1.5);
+    CPPUNIT_ASSERT_THROW(mitk::IOUtil::Save(image, fileName, options), mitk::Exception);
+    std::remove(fileName.c_str());
+  }
+
+  /** Prints the write throughput of NRRD files for several image sizes and compression settings. */
+  void TestWriteThroughput_Benchmark()
+  {
+    const unsigned int sizesInMB[] = {16, 64, 256};
+    const std::pair<std::string, int> settings[] = {std::make_pair(mitk::ItkImageIO::COMPRESSION_NONE(), 6),
+                                                    std::make_pair(mitk::ItkImageIO::COMPRESSION_DEFAULT(), 6),
+                                                    std::make_pair(mitk::ItkImageIO::COMPRESSION_PARALLEL(), 1),
+                                                    std::make_pair(mitk::ItkImageIO::COMPRESSION_PARALLEL(), 6),
+                                                    std::make_pair(mitk::ItkImageIO::COMPRESSION_PARALLEL(), 9)};
+
+    for (unsigned int sizeInMB : sizesInMB)
+    {
+      mitk::Image::Pointer image = CreateCompressibleImage(sizeInMB);
+      for (const auto &setting : settings)
+      {
+        const std::string fileName = mitk::IOUtil::CreateTemporaryFile("CompressionBenchmarkXXXXXX.nrrd");
+        auto start = std::chrono::steady_clock::now();
+        mitk::IOUtil::Save(image, fileName, CreateCompressionOptions(setting.first, setting.second));
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        MITK_INFO << sizeInMB << " MB, " << setting.first << " (level " << setting.second
+                  << "): " << sizeInMB / seconds << " MB/s, ratio "
+                  << static_cast<double>(itksys::SystemTools::FileLength(fileName)) / (sizeInMB * 1024 * 1024);
+        std::remove(fileName.c_str());
+      }
+    }
+  }
+
+  /** Prints the time to write and read an image with 500 properties that are persisted by regex infos,
+   * like the DICOM tags of interest. */
+  void TestReadWriteProperties_Benchmark()
+  {
+    const unsigned int numberOfInfos = 100;
+    const unsigned int propertiesPerInfo = 5;
+    const unsigned int repetitions = 10;
+
+    mitk::IPropertyPersistence *persistence = mitk::CoreServices::GetPropertyPersistence();
+    std::vector<std::string> nameRegExs;
+
+    mitk::Image::Pointer image = CreateCompressibleImage(1);
+    for (unsigned int i = 0; i < numberOfInfos; ++i)
+    {
+      std::ostringstream tag;
+      tag << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << i;
+
+      mitk::PropertyPersistenceInfo::Pointer info = mitk::PropertyPersistenceInfo::New();
+      info->UseRegEx("BENCHMARK\\.0008\\." + tag.str() + "\\.(\\d*)",
+                     "BENCHMARK.0008." + tag.str() + ".$1",
+                     "BENCHMARK_0008_" + tag.str() + "_(\\d*)",
+                     "BENCHMARK_0008_" + tag.str() + "_$1");
+      persistence->AddInfo(info);
+      nameRegExs.push_back(info->GetName());
+
+      for (unsigned int j = 0; j < propertiesPerInfo; ++j)
+      {
+        std::ostringstream name;
+        name << "BENCHMARK.0008." << tag.str() << "." << j;
+        image->SetProperty(name.str().c_str(), mitk::StringProperty::New("value of " + name.str()));
+      }
+    }
+
+    const std::string fileName = mitk::IOUtil::CreateTemporaryFile("PropertiesBenchmarkXXXXXX.nrrd");
+    const mitk::IFileWriter::Options options = CreateCompressionOptions(mitk::ItkImageIO::COMPRESSION_NONE(), 6);
+
+    double writeSeconds = 0;
+    double readSeconds = 0;
+    for (unsigned int i = 0; i < repetitions; ++i)
+    {
+      auto start = std::chrono::steady_clock::now();
+      mitk::IOUtil::Save(image, fileName, options);
+      auto written = std::chrono::steady_clock::now();
+      mitk::Image::Pointer loadedImage = mitk::IOUtil::LoadImage(fileName);
+      auto read = std::chrono::steady_clock::now();
+
+      writeSeconds += std::chrono::duration<double>(written - start).count();
+      readSeconds += std::chrono::duration<double>(read - written).count();
+
+      CPPUNIT_ASSERT_MESSAGE("Properties are read back",
+                             loadedImage->GetProperty("BENCHMARK.0008.0063.4").IsNotNull());
+    }
+
+    MITK_INFO << numberOfInfos * propertiesPerInfo << " properties: write " << 1000. * writeSeconds / repetitions
+              << " ms, read " << 1000. * readSeconds / repetitions << " ms";
+
+    std::remove(fileName.c_str());
+    for (const auto &nameRegEx : nameRegExs)
+    {
+      persistence->RemoveInfo(nameRegEx);
+    }
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkItkImageIO)
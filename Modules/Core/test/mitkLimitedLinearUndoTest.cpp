@@ -0,0 +1,133 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <mitkInteractionConst.h>
+#include <mitkLimitedLinearUndo.h>
+#include <mitkOperationActor.h>
+
+namespace
+{
+  /** Operation holding a fixed number of bytes until its memory is released */
+  class MemoryTestOperation : public mitk::Operation
+  {
+  public:
+    MemoryTestOperation(std::size_t cost) : Operation(mitk::OpTEST), m_Cost(cost), m_Released(false) {}
+    std::size_t GetMemoryCost() override { return m_Released ? 0 : m_Cost; }
+    void ReleaseMemory() override { m_Released = true; }
+    void Restore() { m_Released = false; }
+    bool IsReleased() const { return m_Released; }
+  private:
+    std::size_t m_Cost;
+    bool m_Released;
+  };
+
+  /** Restores released operations when they are executed, like the image operations do */
+  class MemoryTestActor : public mitk::OperationActor
+  {
+  public:
+    void ExecuteOperation(mitk::Operation *operation) override
+    {
+      static_cast<MemoryTestOperation *>(operation)->Restore();
+    }
+  };
+}
+
+class mitkLimitedLinearUndoTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkLimitedLinearUndoTestSuite);
+  MITK_TEST(SetOperationEvent_OverBudget_ReleasesOldestItems);
+  MITK_TEST(Undo_RestoredItems_StayWithinBudget);
+  MITK_TEST(SetMemoryBudget_Zero_KeepsAllItems);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::LimitedLinearUndo::Pointer m_Undo;
+  MemoryTestActor m_Actor;
+  std::vector<MemoryTestOperation *> m_DoOperations;
+
+  void AddOperationEvents(unsigned int count)
+  {
+    for (unsigned int i = 0; i < count; ++i)
+    {
+      auto doOperation = new MemoryTestOperation(60);
+      auto undoOperation = new MemoryTestOperation(40);
+      m_DoOperations.push_back(doOperation);
+      m_Undo->SetOperationEvent(new mitk::OperationEvent(&m_Actor, doOperation, undoOperation, "Test"));
+      mitk::OperationEvent::IncCurrObjectEventId();
+    }
+  }
+
+public:
+  void setUp() override
+  {
+    m_Undo = mitk::LimitedLinearUndo::New();
+    m_DoOperations.clear();
+  }
+
+  void tearDown() override
+  {
+    m_Undo = nullptr;
+    m_DoOperations.clear();
+  }
+
+  void SetOperationEvent_OverBudget_ReleasesOldestItems()
+  {
+    m_Undo->SetMemoryBudget(250);
+    this->AddOperationEvents(5);
+
+    CPPUNIT_ASSERT(m_Undo->GetMemoryCost() <= 250);
+    CPPUNIT_ASSERT(m_DoOperations[0]->IsReleased());
+    CPPUNIT_ASSERT(m_DoOperations[2]->IsReleased());
+    CPPUNIT_ASSERT(!m_DoOperations[3]->IsReleased());
+    CPPUNIT_ASSERT(!m_DoOperations[4]->IsReleased());
+  }
+
+  void Undo_RestoredItems_StayWithinBudget()
+  {
+    m_Undo->SetMemoryBudget(250);
+    this->AddOperationEvents(5);
+
+    while (m_Undo->Undo())
+    {
+      CPPUNIT_ASSERT(m_Undo->GetMemoryCost() <= 250);
+    }
+    CPPUNIT_ASSERT(m_Undo->GetMemoryCost() <= 250);
+    CPPUNIT_ASSERT(m_Undo->GetLastExecutionTime() >= 0.0);
+
+    while (m_Undo->Redo())
+    {
+      CPPUNIT_ASSERT(m_Undo->GetMemoryCost() <= 250);
+    }
+    CPPUNIT_ASSERT(m_Undo->RedoListEmpty());
+  }
+
+  void SetMemoryBudget_Zero_KeepsAllItems()
+  {
+    m_Undo->SetMemoryBudget(0);
+    this->AddOperationEvents(5);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(500), m_Undo->GetMemoryCost());
+
+    // lowering the budget releases items immediately
+    m_Undo->SetMemoryBudget(100);
+    CPPUNIT_ASSERT(m_Undo->GetMemoryCost() <= 100);
+    CPPUNIT_ASSERT(!m_DoOperations[4]->IsReleased());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkLimitedLinearUndo)
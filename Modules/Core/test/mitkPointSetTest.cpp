@@ -45,6 +45,7 @@ class mitkPointSetTestSuite : public mitk::TestFixture
   MITK_TEST(TestRemovePointInterface);
   MITK_TEST(TestMaxIdAccess);
   MITK_TEST(TestInsertPointAtEnd);
+  MITK_TEST(TestSearchPointInLargePointSet);
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -483,6 +484,52 @@ std::cout<<"[PASSED]"<<std::endl;
     pointSet->InsertPoint(in4, 7);
     MITK_ASSERT_EQUAL(pointSet, refPs4, "Check point insertion for time step 7.");
   }
+
+  void TestSearchPointInLargePointSet()
+  {
+    // large point sets are searched with a grid, the results have to be the
+    // same as for the linear search
+    mitk::PointSet::Pointer largePointSet = mitk::PointSet::New();
+    mitk::PointSet::PointIdentifier id = 0;
+    for (int z = 0; z < 10; ++z)
+      for (int y = 0; y < 20; ++y)
+        for (int x = 0; x < 20; ++x)
+        {
+          mitk::Point3D point;
+          mitk::FillVector3D(point, 2.0 * x, 2.0 * y, 2.0 * z);
+          largePointSet->InsertPoint(id++, point);
+        }
+
+    mitk::Point3D query;
+    mitk::FillVector3D(query, 10.4, 6.3, 4.1);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Nearest point within distance not found", 2 * 400 + 3 * 20 + 5,
+                                 largePointSet->SearchPoint(query, 1.0));
+
+    mitk::FillVector3D(query, 11.0, 6.0, 4.0);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Equally distant points have to return the smallest id", 2 * 400 + 3 * 20 + 5,
+                                 largePointSet->SearchPoint(query, 1.5));
+
+    mitk::FillVector3D(query, 10.0, 6.0, 4.0);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Equal point not found", 2 * 400 + 3 * 20 + 5,
+                                 largePointSet->SearchPoint(query, 0.0));
+
+    mitk::FillVector3D(query, 11.0, 7.0, 5.0);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Point found although none is within distance", -1,
+                                 largePointSet->SearchPoint(query, 0.5));
+
+    mitk::FillVector3D(query, -100.0, 7.0, 5.0);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Point found outside of the point set", -1, largePointSet->SearchPoint(query, 3.0));
+
+    // moving a point has to be reflected by the search
+    mitk::Point3D moved;
+    mitk::FillVector3D(moved, 100.0, 100.0, 100.0);
+    largePointSet->SetPoint(7, moved);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Moved point not found", 7, largePointSet->SearchPoint(moved, 1.0));
+
+    mitk::FillVector3D(query, 14.0, 0.0, 0.0);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Point found at the old position of a moved point", -1,
+                                 largePointSet->SearchPoint(query, 0.5));
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkPointSet)
@@ -0,0 +1,143 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkDataNode.h>
+#include <mitkProperties.h>
+#include <mitkPropertyHandle.h>
+#include <mitkPropertyKeys.h>
+#include <mitkTestingMacros.h>
+#include <mitkVtkPropRenderer.h>
+
+#include <vtkRenderWindow.h>
+
+int mitkPropertyHandleTest(int, char *[])
+{
+  MITK_TEST_BEGIN("mitkPropertyHandleTest");
+
+  // interned keys
+  mitk::PropertyKeys::IdType visibleId = mitk::PropertyKeys::GetId("visible");
+  mitk::PropertyKeys::IdType opacityId = mitk::PropertyKeys::GetId("opacity");
+
+  MITK_TEST_CONDITION(visibleId != opacityId, "Different keys get different ids");
+  MITK_TEST_CONDITION(mitk::PropertyKeys::GetId("visible") == visibleId, "Same key gets the same id");
+  MITK_TEST_CONDITION(mitk::PropertyKeys::GetKey(visibleId) == "visible", "Get key of an id");
+  MITK_TEST_CONDITION(mitk::PropertyKeys::GetNumberOfKeys() > opacityId, "Number of keys covers all ids");
+  MITK_TEST_FOR_EXCEPTION(mitk::Exception, mitk::PropertyKeys::GetKey(mitk::PropertyKeys::GetNumberOfKeys()));
+
+  mitk::PropertyHandle visibleHandle("visible");
+  MITK_TEST_CONDITION(visibleHandle.GetKeyId() == visibleId && visibleHandle.GetKey() == "visible",
+                      "Handle uses the interned key");
+
+  // lookups through a handle
+  mitk::DataNode::Pointer node1 = mitk::DataNode::New();
+  mitk::DataNode::Pointer node2 = mitk::DataNode::New();
+  node1->SetBoolProperty("visible", true);
+  node2->SetBoolProperty("visible", false);
+
+  bool visible = false;
+  MITK_TEST_CONDITION(node1->GetVisibility(visible, nullptr, visibleHandle) && visible, "Get property of node 1");
+  MITK_TEST_CONDITION(node2->GetVisibility(visible, nullptr, visibleHandle) && !visible, "Get property of node 2");
+  MITK_TEST_CONDITION(node1->GetProperty(visibleHandle) == node1->GetProperty("visible"),
+                      "Handle resolves to the same property object as the key");
+
+  // value changes keep the property object
+  node1->SetBoolProperty("visible", false);
+  MITK_TEST_CONDITION(node1->GetBoolProperty(visibleHandle, visible) && !visible, "Get changed value of a property");
+
+  // structural changes invalidate the handle
+  unsigned long structureVersion = mitk::PropertyList::GetStructureVersion();
+  mitk::BoolProperty::Pointer replacement = mitk::BoolProperty::New(true);
+  node1->ReplaceProperty("visible", replacement);
+  MITK_TEST_CONDITION(mitk::PropertyList::GetStructureVersion() != structureVersion,
+                      "Replacing a property changes the structure version");
+  MITK_TEST_CONDITION(node1->GetProperty(visibleHandle) == replacement.GetPointer(), "Get replaced property");
+
+  node1->GetPropertyList()->DeleteProperty("visible");
+  MITK_TEST_CONDITION(node1->GetProperty(visibleHandle) == nullptr, "Deleted property is not found");
+
+  structureVersion = mitk::PropertyList::GetStructureVersion();
+  node2->SetBoolProperty("visible", true);
+  MITK_TEST_CONDITION(mitk::PropertyList::GetStructureVersion() == structureVersion,
+                      "Changing the value of a property keeps the structure version");
+
+  // only lists a handle has seen report structure changes
+  structureVersion = mitk::PropertyList::GetStructureVersion();
+  mitk::PropertyList::Pointer unseenList = mitk::PropertyList::New();
+  unseenList->SetBoolProperty("visible", true);
+  unseenList->DeleteProperty("visible");
+  mitk::DataNode::Pointer unseenNode = mitk::DataNode::New();
+  unseenNode->SetIntProperty("layer", 3);
+  unseenList = nullptr;
+  unseenNode = nullptr;
+  MITK_TEST_CONDITION(mitk::PropertyList::GetStructureVersion() == structureVersion,
+                      "Lists that were not looked at by a handle keep the structure version");
+
+  mitk::DataNode::Pointer seenNode = mitk::DataNode::New();
+  seenNode->GetProperty(visibleHandle);
+  structureVersion = mitk::PropertyList::GetStructureVersion();
+  seenNode = nullptr;
+  MITK_TEST_CONDITION(mitk::PropertyList::GetStructureVersion() != structureVersion,
+                      "Destroying a node that was looked at by a handle changes the structure version");
+
+  // renderer specific lookups are cached by renderer name
+  vtkRenderWindow *renderWindow = vtkRenderWindow::New();
+  node2->SetBoolProperty("visible", true);
+  mitk::VtkPropRenderer::Pointer rendererA =
+    mitk::VtkPropRenderer::New("renderer A", renderWindow, mitk::RenderingManager::GetInstance());
+  MITK_TEST_CONDITION(node2->GetVisibility(visible, rendererA, visibleHandle) && visible,
+                      "Renderer without specific list uses the renderer independent property");
+
+  node2->SetBoolProperty("visible", false, rendererA);
+  MITK_TEST_CONDITION(node2->GetVisibility(visible, rendererA, visibleHandle) && !visible,
+                      "New renderer specific list is found after the handle cached the renderer independent property");
+
+  rendererA = nullptr;
+  mitk::VtkPropRenderer::Pointer rendererB =
+    mitk::VtkPropRenderer::New("renderer B", renderWindow, mitk::RenderingManager::GetInstance());
+  MITK_TEST_CONDITION(node2->GetVisibility(visible, rendererB, visibleHandle) && visible,
+                      "Another renderer does not get the cached property of a destroyed renderer");
+  rendererB = nullptr;
+
+  mitk::VtkPropRenderer::Pointer rendererA2 =
+    mitk::VtkPropRenderer::New("renderer A", renderWindow, mitk::RenderingManager::GetInstance());
+  MITK_TEST_CONDITION(node2->GetVisibility(visible, rendererA2, visibleHandle) && !visible,
+                      "A renderer with the same name gets the renderer specific property");
+  rendererA2 = nullptr;
+  renderWindow->Delete();
+
+  // more nodes than the handle caches
+  std::vector<mitk::DataNode::Pointer> nodes;
+  for (int i = 0; i < 20; ++i)
+  {
+    mitk::DataNode::Pointer node = mitk::DataNode::New();
+    node->SetIntProperty("layer", i);
+    nodes.push_back(node);
+  }
+
+  mitk::PropertyHandle layerHandle("layer");
+  bool allLayersFound = true;
+  for (int pass = 0; pass < 2; ++pass)
+  {
+    for (int i = 0; i < 20; ++i)
+    {
+      int layer = -1;
+      allLayersFound = allLayersFound && nodes[i]->GetIntProperty(layerHandle, layer) && layer == i;
+    }
+  }
+  MITK_TEST_CONDITION(allLayersFound, "Get properties of more nodes than the handle caches");
+
+  MITK_TEST_END();
+}
@@ -158,6 +158,10 @@ public:
     CPPUNIT_ASSERT_MESSAGE(
       "Testing addinfo of already existing info (no overwrite) -> adding -> key should be changed.",
       service->GetInfo(prop2, "mime2", false).front()->GetKey() == "otherKey");
+    CPPUNIT_ASSERT_MESSAGE("Testing addinfo of already existing info (overwrite) -> old key is not found any more.",
+                           !checkExistance(service->GetInfoByKey("key2", false), info2));
+    CPPUNIT_ASSERT_MESSAGE("Testing addinfo of already existing info (overwrite) -> new key is found.",
+                           checkExistance(service->GetInfoByKey("otherKey", false), info2_otherKey));
 
     CPPUNIT_ASSERT_MESSAGE("Testing addinfo of info (other mime type; no overwrite) -> adding",
                            service->AddInfo(info2_new, false));
@@ -168,6 +172,20 @@ public:
                            service->AddInfo(info_newPropNKey, false));
     CPPUNIT_ASSERT_MESSAGE("Testing addinfo of info (new prop name; no overwrite) -> adding ->info exists.",
                            !service->GetInfo("newProp", "otherMime", false).empty());
+
+    // the service keeps its own copy, later changes of the added instance do not affect it
+    info_newPropNKey->SetNameAndKey("changedProp", "changedKey");
+    infoX->UseRegEx("changed(\\d*)", propXTemplate);
+    CPPUNIT_ASSERT_MESSAGE("Testing addinfo of info changed after adding -> old name is found.",
+                           !service->GetInfo("newProp", "otherMime", false).empty());
+    CPPUNIT_ASSERT_MESSAGE("Testing addinfo of info changed after adding -> old key is found.",
+                           !service->GetInfoByKey("newKey", false).empty());
+    CPPUNIT_ASSERT_MESSAGE("Testing addinfo of info changed after adding -> new name is not found.",
+                           !service->HasInfo("changedProp", false));
+    CPPUNIT_ASSERT_MESSAGE("Testing addinfo of regex info changed after adding -> old regex is used.",
+                           !service->GetInfo("prop101", "mimeX", false, true).empty());
+    CPPUNIT_ASSERT_MESSAGE("Testing addinfo of regex info changed after adding -> new regex is not used.",
+                           service->GetInfo("changed101", "mimeX", false, true).empty());
   }
 
   void GetInfo()
@@ -286,6 +304,11 @@ public:
     CPPUNIT_ASSERT_NO_THROW(service->RemoveInfo(prop5));
     CPPUNIT_ASSERT_MESSAGE("Check HasInfos (prop5)", !service->HasInfo(prop5, false));
 
+    CPPUNIT_ASSERT_NO_THROW(service->RemoveInfo(propX));
+    CPPUNIT_ASSERT_MESSAGE("Check HasInfos (prop101) after removing regex info", !service->HasInfo("prop101", true));
+    CPPUNIT_ASSERT_MESSAGE("Check GetInfoByKey (key101) after removing regex info",
+                           service->GetInfoByKey("key101", true).empty());
+
     CPPUNIT_ASSERT_NO_THROW(service->RemoveInfo("unknown_prop"));
   }
 
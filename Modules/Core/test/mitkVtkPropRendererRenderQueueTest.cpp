@@ -0,0 +1,255 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <mitkMapper.h>
+#include <mitkPointSet.h>
+#include <mitkProperties.h>
+#include <mitkStandaloneDataStorage.h>
+#include <mitkVtkPropRenderer.h>
+
+#include <vtkRenderWindow.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+  /** Records the nodes in the order in which the renderer lets their mappers render */
+  class RecordingMapper : public mitk::Mapper
+  {
+  public:
+    mitkClassMacro(RecordingMapper, mitk::Mapper);
+    itkFactorylessNewMacro(Self);
+
+    void SetRecord(std::vector<const mitk::DataNode *> *record) { m_Record = record; }
+    virtual bool IsVtkBased() const override { return false; }
+    virtual void MitkRender(mitk::BaseRenderer *, mitk::VtkPropRenderer::RenderType type) override
+    {
+      if (type == mitk::VtkPropRenderer::Opaque)
+        m_Record->push_back(this->GetDataNode());
+    }
+
+    virtual void ApplyColorAndOpacityProperties(mitk::BaseRenderer *, vtkActor *) override {}
+  protected:
+    RecordingMapper() : m_Record(nullptr) {}
+  private:
+    std::vector<const mitk::DataNode *> *m_Record;
+  };
+}
+
+class mitkVtkPropRendererRenderQueueTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkVtkPropRendererRenderQueueTestSuite);
+  MITK_TEST(Render_SortsNodesByLayer);
+  MITK_TEST(Render_SkipsHiddenNodes);
+  MITK_TEST(Render_SkipsRemovedNodes);
+  MITK_TEST(ComputeVisibleBoundingBox_FollowsGeometryMove);
+  MITK_TEST(ComputeVisibleBoundingBox_UsesVisibilityOfRenderer);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  vtkRenderWindow *m_RenderWindow;
+  mitk::VtkPropRenderer::Pointer m_Renderer;
+  mitk::StandaloneDataStorage::Pointer m_DataStorage;
+  std::vector<mitk::DataNode::Pointer> m_Nodes;
+  std::vector<const mitk::DataNode *> m_Rendered;
+
+  mitk::DataNode::Pointer AddNode(int layer, double x)
+  {
+    mitk::Point3D point;
+    point[0] = x;
+    point[1] = 2 * x;
+    point[2] = -x;
+    mitk::PointSet::Pointer pointSet = mitk::PointSet::New();
+    pointSet->InsertPoint(0, point);
+    point[0] += 1;
+    pointSet->InsertPoint(1, point);
+
+    mitk::DataNode::Pointer node = mitk::DataNode::New();
+    node->SetData(pointSet);
+    node->SetIntProperty("layer", layer);
+
+    RecordingMapper::Pointer mapper = RecordingMapper::New();
+    mapper->SetRecord(&m_Rendered);
+    node->SetMapper(m_Renderer->GetMapperID(), mapper);
+
+    m_DataStorage->Add(node);
+    m_Nodes.push_back(node);
+    return node;
+  }
+
+  std::vector<const mitk::DataNode *> Render()
+  {
+    m_Rendered.clear();
+    m_Renderer->Render(mitk::VtkPropRenderer::Opaque);
+    return m_Rendered;
+  }
+
+  void CheckBoundingBox(const mitk::BaseRenderer *renderer)
+  {
+    mitk::BoundingBox::Pointer expected = m_DataStorage->ComputeVisibleBoundingBox(renderer);
+    mitk::BoundingBox::Pointer cached = m_Renderer->ComputeVisibleBoundingBox(renderer);
+    CPPUNIT_ASSERT(mitk::Equal(expected->GetMinimum(), cached->GetMinimum(), mitk::eps, true));
+    CPPUNIT_ASSERT(mitk::Equal(expected->GetMaximum(), cached->GetMaximum(), mitk::eps, true));
+  }
+
+public:
+  void setUp() override
+  {
+    m_RenderWindow = vtkRenderWindow::New();
+    m_Renderer = mitk::VtkPropRenderer::New("render queue test", m_RenderWindow, mitk::RenderingManager::GetInstance());
+    m_DataStorage = mitk::StandaloneDataStorage::New();
+    m_Renderer->SetDataStorage(m_DataStorage);
+
+    AddNode(3, 1.0);
+    AddNode(1, 2.0);
+    AddNode(2, 3.0);
+    AddNode(1, 4.0);
+
+    m_Renderer->SetWorldGeometryToDataStorageBounds();
+  }
+
+  void tearDown() override
+  {
+    m_Nodes.clear();
+    m_Renderer = nullptr;
+    m_DataStorage = nullptr;
+    m_RenderWindow->Delete();
+  }
+
+  void Render_SortsNodesByLayer()
+  {
+    // nodes of the same layer keep the order in which they were added
+    std::vector<const mitk::DataNode *> rendered = Render();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), rendered.size());
+    CPPUNIT_ASSERT(rendered[0] == m_Nodes[1]);
+    CPPUNIT_ASSERT(rendered[1] == m_Nodes[3]);
+    CPPUNIT_ASSERT(rendered[2] == m_Nodes[2]);
+    CPPUNIT_ASSERT(rendered[3] == m_Nodes[0]);
+
+    // value change of the observed layer property
+    m_Nodes[0]->SetIntProperty("layer", 0);
+    rendered = Render();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), rendered.size());
+    CPPUNIT_ASSERT(rendered[0] == m_Nodes[0]);
+
+    // renderer specific layer in a new renderer specific list
+    m_Nodes[0]->SetIntProperty("layer", 5, m_Renderer);
+    rendered = Render();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), rendered.size());
+    CPPUNIT_ASSERT(rendered[3] == m_Nodes[0]);
+
+    // replaced layer property
+    m_Nodes[3]->ReplaceProperty("layer", mitk::IntProperty::New(4));
+    rendered = Render();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), rendered.size());
+    CPPUNIT_ASSERT(rendered[0] == m_Nodes[1]);
+    CPPUNIT_ASSERT(rendered[1] == m_Nodes[2]);
+    CPPUNIT_ASSERT(rendered[2] == m_Nodes[3]);
+    CPPUNIT_ASSERT(rendered[3] == m_Nodes[0]);
+  }
+
+  void Render_SkipsHiddenNodes()
+  {
+    m_Nodes[2]->SetVisibility(false);
+    std::vector<const mitk::DataNode *> rendered = Render();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), rendered.size());
+    CPPUNIT_ASSERT(std::find(rendered.begin(), rendered.end(), m_Nodes[2]) == rendered.end());
+
+    m_Nodes[2]->SetVisibility(true);
+    rendered = Render();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), rendered.size());
+    CPPUNIT_ASSERT(rendered[2] == m_Nodes[2]);
+
+    // only hidden in this renderer
+    m_Nodes[1]->SetVisibility(false, m_Renderer);
+    rendered = Render();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), rendered.size());
+    CPPUNIT_ASSERT(std::find(rendered.begin(), rendered.end(), m_Nodes[1]) == rendered.end());
+
+    m_Nodes[1]->GetPropertyList(m_Renderer)->DeleteProperty("visible");
+    rendered = Render();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), rendered.size());
+    CPPUNIT_ASSERT(rendered[0] == m_Nodes[1]);
+  }
+
+  void Render_SkipsRemovedNodes()
+  {
+    Render();
+    m_DataStorage->Remove(m_Nodes[3]);
+    std::vector<const mitk::DataNode *> rendered = Render();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), rendered.size());
+    CPPUNIT_ASSERT(std::find(rendered.begin(), rendered.end(), m_Nodes[3]) == rendered.end());
+
+    // a removed node is not observed any more
+    m_Nodes[3]->SetIntProperty("layer", 0);
+    m_Nodes[3]->SetVisibility(true);
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3), Render().size());
+
+    m_DataStorage->Add(m_Nodes[3]);
+    rendered = Render();
+    CPPUNIT_ASSERT_EQUAL(std::size_t(4), rendered.size());
+    CPPUNIT_ASSERT(rendered[0] == m_Nodes[3]);
+  }
+
+  void ComputeVisibleBoundingBox_FollowsGeometryMove()
+  {
+    CheckBoundingBox(m_Renderer);
+    CheckBoundingBox(nullptr);
+
+    // moving the geometry of a time step does not modify the data or its time geometry directly
+    mitk::Point3D origin;
+    origin[0] = 100;
+    origin[1] = -50;
+    origin[2] = 25;
+    m_Nodes[0]->GetData()->GetGeometry()->SetOrigin(origin);
+    CheckBoundingBox(m_Renderer);
+    CheckBoundingBox(nullptr);
+
+    // new points modify the data
+    mitk::Point3D point;
+    point[0] = point[1] = point[2] = -30;
+    static_cast<mitk::PointSet *>(m_Nodes[1]->GetData())->InsertPoint(2, point);
+    CheckBoundingBox(m_Renderer);
+
+    m_DataStorage->Remove(m_Nodes[0]);
+    CheckBoundingBox(m_Renderer);
+    CheckBoundingBox(nullptr);
+  }
+
+  void ComputeVisibleBoundingBox_UsesVisibilityOfRenderer()
+  {
+    // the far away node is only hidden in this renderer
+    mitk::DataNode::Pointer farAway = AddNode(1, 1000.0);
+    farAway->SetVisibility(false, m_Renderer);
+    CheckBoundingBox(m_Renderer);
+    CheckBoundingBox(nullptr);
+    CPPUNIT_ASSERT(m_Renderer->ComputeVisibleBoundingBox(m_Renderer)->GetMaximum()[0] < 1000.0);
+    CPPUNIT_ASSERT(m_Renderer->ComputeVisibleBoundingBox(nullptr)->GetMaximum()[0] > 1000.0);
+
+    // hidden everywhere
+    farAway->SetVisibility(false);
+    farAway->GetPropertyList(m_Renderer)->DeleteProperty("visible");
+    CheckBoundingBox(m_Renderer);
+    CheckBoundingBox(nullptr);
+    CPPUNIT_ASSERT(m_Renderer->ComputeVisibleBoundingBox(nullptr)->GetMaximum()[0] < 1000.0);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkVtkPropRendererRenderQueue)
@@ -35,7 +35,8 @@ namespace mitk
    used to keep the image alive -- the purpose of this class is undo and the undo
    stack should not keep things alive forever.
 
-   To save memory, zlib compression is used via CompressedImageContainer.
+   To save memory, zlib compression is used via CompressedImageContainer. Undo models with a
+   memory budget can move the compressed data into a temporary file via ReleaseMemory().
 
    @ingroup Undo
    @ingroup ToolManagerEtAl
@@ -81,6 +82,12 @@ namespace mitk
     Image::Pointer GetDiffImage();
 
     bool IsImageStillValid() { return m_ImageStillValid; }
+
+    /** \brief Returns the size of the compressed difference image held in memory. */
+    virtual std::size_t GetMemoryCost() override;
+
+    /** \brief Moves the compressed difference image into a temporary file, it is restored by GetDiffImage(). */
+    virtual void ReleaseMemory() override;
   };
 
 } // namespace mitk
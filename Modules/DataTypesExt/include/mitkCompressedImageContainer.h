@@ -25,6 +25,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <itkObject.h>
 
+#include <cstddef>
+#include <string>
 #include <vector>
 
 namespace mitk
@@ -59,6 +61,26 @@ namespace mitk
      */
     Image::Pointer GetImage();
 
+    /**
+     * \brief Returns the number of bytes of compressed data held in memory.
+     *
+     * Returns 0 after ReleaseMemory().
+     */
+    std::size_t GetMemoryCost() const;
+
+    /**
+     * \brief Moves the compressed data into a temporary file.
+     *
+     * The data is read back from the file on the next call of GetImage().
+     * If the file cannot be written, the data stays in memory.
+     */
+    void ReleaseMemory();
+
+    /**
+     * \brief True, if the compressed data was moved into a temporary file by ReleaseMemory().
+     */
+    bool IsMemoryReleased() const;
+
   protected:
     CompressedImageContainer(); // purposely hidden
     virtual ~CompressedImageContainer();
@@ -76,6 +98,16 @@ namespace mitk
     std::vector<std::pair<unsigned char *, unsigned long>> m_ByteBuffers;
 
     BaseGeometry::Pointer m_ImageGeometry;
+
+  private:
+    /// reads the compressed data back from m_FileName and removes the file
+    void RestoreMemory();
+
+    /// removes m_FileName, if the data was moved there
+    void RemoveFile();
+
+    /// temporary file holding the compressed data of all timesteps after ReleaseMemory()
+    std::string m_FileName;
   };
 
 } // namespace
@@ -69,3 +69,14 @@ mitk::Image::Pointer mitk::ApplyDiffImageOperation::GetDiffImage()
 
   return image;
 }
+
+std::size_t mitk::ApplyDiffImageOperation::GetMemoryCost()
+{
+  return zlibContainer.IsNotNull() ? zlibContainer->GetMemoryCost() : 0;
+}
+
+void mitk::ApplyDiffImageOperation::ReleaseMemory()
+{
+  if (zlibContainer.IsNotNull())
+    zlibContainer->ReleaseMemory();
+}
@@ -15,10 +15,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkCompressedImageContainer.h"
+#include "mitkExceptionMacro.h"
+#include "mitkIOUtil.h"
 #include "mitkImageReadAccessor.h"
 
 #include "itk_zlib.h"
 
+#include <cstdio>
+#include <fstream>
 #include <stdlib.h>
 
 mitk::CompressedImageContainer::CompressedImageContainer() : m_PixelType(nullptr), m_ImageGeometry(nullptr)
@@ -32,6 +36,8 @@ mitk::CompressedImageContainer::~CompressedImageContainer()
     free(iter->first);
   }
 
+  this->RemoveFile();
+
   delete m_PixelType;
 }
 
@@ -43,6 +49,7 @@ void mitk::CompressedImageContainer::SetImage(Image *image)
   }
 
   m_ByteBuffers.clear();
+  this->RemoveFile();
 
   // Compress diff image using zlib (will be restored on demand)
   // determine memory size occupied by voxel data
@@ -130,6 +137,11 @@ mitk::Image::Pointer mitk::CompressedImageContainer::GetImage()
   if (m_ByteBuffers.empty())
     return nullptr;
 
+  if (!m_FileName.empty())
+  {
+    this->RestoreMemory();
+  }
+
   // uncompress image data, create an Image
   Image::Pointer image = Image::New();
   unsigned int dims[20]; // more than 20 dimensions and bang
@@ -180,3 +192,91 @@ mitk::Image::Pointer mitk::CompressedImageContainer::GetImage()
 
   return image;
 }
+
+std::size_t mitk::CompressedImageContainer::GetMemoryCost() const
+{
+  if (!m_FileName.empty())
+    return 0;
+
+  std::size_t cost = 0;
+  for (auto iter = m_ByteBuffers.begin(); iter != m_ByteBuffers.end(); ++iter)
+  {
+    cost += iter->second;
+  }
+  return cost;
+}
+
+bool mitk::CompressedImageContainer::IsMemoryReleased() const
+{
+  return !m_FileName.empty();
+}
+
+void mitk::CompressedImageContainer::ReleaseMemory()
+{
+  if (!m_FileName.empty() || m_ByteBuffers.empty())
+    return;
+
+  std::ofstream stream;
+  try
+  {
+    m_FileName = IOUtil::CreateTemporaryFile(
+      stream, std::ios_base::out | std::ios_base::trunc | std::ios_base::binary, "MITK-CompressedImage-XXXXXX");
+  }
+  catch (const mitk::Exception &e)
+  {
+    MITK_WARN << "Could not create temporary file for compressed image, keeping it in memory: " << e.GetDescription();
+    return;
+  }
+
+  for (auto iter = m_ByteBuffers.begin(); iter != m_ByteBuffers.end(); ++iter)
+  {
+    stream.write(reinterpret_cast<const char *>(iter->first), iter->second);
+  }
+  stream.close();
+
+  if (stream.fail())
+  {
+    MITK_WARN << "Could not write compressed image to " << m_FileName << ", keeping it in memory";
+    this->RemoveFile();
+    return;
+  }
+
+  for (auto iter = m_ByteBuffers.begin(); iter != m_ByteBuffers.end(); ++iter)
+  {
+    free(iter->first);
+    iter->first = nullptr;
+  }
+}
+
+void mitk::CompressedImageContainer::RestoreMemory()
+{
+  std::ifstream stream(m_FileName.c_str(), std::ios_base::in | std::ios_base::binary);
+
+  for (auto iter = m_ByteBuffers.begin(); iter != m_ByteBuffers.end(); ++iter)
+  {
+    iter->first = (unsigned char *)malloc(iter->second);
+    stream.read(reinterpret_cast<char *>(iter->first), iter->second);
+  }
+
+  if (stream.fail())
+  {
+    for (auto iter = m_ByteBuffers.begin(); iter != m_ByteBuffers.end(); ++iter)
+    {
+      free(iter->first);
+      iter->first = nullptr;
+    }
+    mitkThrow() << "Could not read compressed image from " << m_FileName;
+  }
+
+  stream.close();
+  this->RemoveFile();
+}
+
+void mitk::CompressedImageContainer::RemoveFile()
+{
+  if (m_FileName.empty())
+    return;
+
+  std::remove(m_FileName.c_str());
+  m_FileName.clear();
+}
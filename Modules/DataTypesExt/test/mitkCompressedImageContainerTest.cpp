@@ -23,11 +23,32 @@ See LICENSE.txt or http://www.mitk.org for details.
 class mitkCompressedImageContainerTestClass
 {
 public:
-  static void Test(mitk::CompressedImageContainer *container, mitk::Image *image, unsigned int &numberFailed)
+  static void Test(mitk::CompressedImageContainer *container,
+                   mitk::Image *image,
+                   unsigned int &numberFailed,
+                   bool releaseMemory = false)
   {
-    container->SetImage(image);                                     // compress
+    container->SetImage(image); // compress
+
+    if (releaseMemory)
+    {
+      // move the compressed data into a temporary file, it is read back by GetImage()
+      container->ReleaseMemory();
+      if (!container->IsMemoryReleased() || container->GetMemoryCost() != 0)
+      {
+        ++numberFailed;
+        std::cerr << "  (EE) Compressed data still in memory after ReleaseMemory()" << std::endl;
+      }
+    }
+
     mitk::Image::Pointer uncompressedImage = container->GetImage(); // uncompress
 
+    if (container->IsMemoryReleased() || container->GetMemoryCost() == 0)
+    {
+      ++numberFailed;
+      std::cerr << "  (EE) Compressed data not in memory after GetImage()" << std::endl;
+    }
+
     // check dimensions
     if (image->GetDimension() != uncompressedImage->GetDimension())
     {
@@ -166,6 +187,9 @@ int mitkCompressedImageContainerTest(int argc, char *argv[])
   // some real work
   mitkCompressedImageContainerTestClass::Test(container, image, numberFailed);
 
+  std::cout << "Testing release of memory into a temporary file" << std::endl;
+  mitkCompressedImageContainerTestClass::Test(container, image, numberFailed, true);
+
   std::cout << "Testing destruction" << std::endl;
 
   // freeing
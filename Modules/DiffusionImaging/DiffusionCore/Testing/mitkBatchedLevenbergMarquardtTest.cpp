@@ -0,0 +1,184 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <itkBatchedLevenbergMarquardt.h>
+#include <itkDiffusionIntravoxelIncoherentMotionReconstructionImageFilter.h>
+#include <itkDiffusionKurtosisReconstructionImageFilter.h>
+
+class mitkBatchedLevenbergMarquardtTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkBatchedLevenbergMarquardtTestSuite);
+  MITK_TEST(FitIVIM_NoiseFreeSignal_RecoversParameters);
+  MITK_TEST(FitIVIM_SinglePrecision_RecoversParameters);
+  MITK_TEST(FitKurtosis_NoiseFreeSignal_RecoversParameters);
+  MITK_TEST(SearchGrid_PicksClosestPoint);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  static const unsigned int m_NumberOfVoxels = 50;
+
+  std::vector<double> m_BValues;
+
+  template <class TValue>
+  void FitIVIM(double tolerance)
+  {
+    typedef itk::IVIM_3param_batched<TValue> ModelType;
+    ModelType model;
+    model.bvalues.assign(m_BValues.begin(), m_BValues.end());
+    const unsigned int n = m_NumberOfVoxels;
+    const unsigned int numberOfMeasurements = m_BValues.size();
+
+    std::vector<TValue> measurements(numberOfMeasurements * n);
+    std::vector<TValue> weights(numberOfMeasurements * n, 1);
+    std::vector<TValue> values(3 * n);
+    std::vector<double> expected(3 * n);
+    for (unsigned int v = 0; v < n; ++v)
+    {
+      const double f = 0.05 + 0.3 * v / n;
+      const double D = 0.0005 + 0.002 * ((v * 7) % n) / n;
+      const double DStar = 0.01 + 0.08 * ((v * 13) % n) / n;
+      expected[v] = f;
+      expected[n + v] = D;
+      expected[2 * n + v] = DStar;
+      for (unsigned int s = 0; s < numberOfMeasurements; ++s)
+      {
+        measurements[s * n + v] = (1 - f) * exp(-m_BValues[s] * D) + f * exp(-m_BValues[s] * (D + DStar));
+      }
+
+      // thresholded measurements are ignored
+      if (v % 5 == 0)
+      {
+        measurements[2 * n + v] = 0;
+        weights[2 * n + v] = 0;
+      }
+    }
+
+    std::vector<TValue> grid;
+    for (TValue f : {0.0, 0.1, 0.3})
+      for (TValue D : {0.0005, 0.001, 0.002})
+        for (TValue DStar : {0.01, 0.04})
+        {
+          grid.push_back(f);
+          grid.push_back(D);
+          grid.push_back(DStar);
+        }
+
+    itk::BatchedLevenbergMarquardt<ModelType> fitter(model, n);
+    fitter.SetGrid(grid);
+    fitter.SearchGrid(measurements.data(), weights.data(), n, values.data());
+    fitter.Fit(measurements.data(), weights.data(), n, values.data());
+
+    for (unsigned int i = 0; i < 3 * n; ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, values[i] / expected[i], tolerance);
+    }
+  }
+
+public:
+  void setUp() override
+  {
+    m_BValues = {10, 20, 40, 60, 100, 150, 200, 300, 400, 600, 800, 1000};
+  }
+
+  void tearDown() override { m_BValues.clear(); }
+
+  void FitIVIM_NoiseFreeSignal_RecoversParameters() { this->FitIVIM<double>(1e-6); }
+
+  void FitIVIM_SinglePrecision_RecoversParameters() { this->FitIVIM<float>(1e-3); }
+
+  void FitKurtosis_NoiseFreeSignal_RecoversParameters()
+  {
+    typedef itk::kurtosis_batched_model<double, true> ModelType;
+    ModelType model;
+    model.bvalues = {400, 800, 1200, 1600, 2000};
+    vnl_vector_fixed<double, 2> bounds(0, 3);
+    model.set_K_bounds(bounds);
+    const unsigned int n = m_NumberOfVoxels;
+    const unsigned int numberOfMeasurements = model.bvalues.size();
+
+    // values are (D, K, S_0), the start values of S_0 are off by 10%,
+    // D * K * b stays below 3 so that the signal decays monotonically
+    std::vector<double> measurements(numberOfMeasurements * n);
+    std::vector<double> normalized(numberOfMeasurements * n);
+    std::vector<double> values(3 * n);
+    std::vector<double> expected(3 * n);
+    for (unsigned int v = 0; v < n; ++v)
+    {
+      const double D = 0.0006 + 0.0006 * v / n;
+      const double K = 0.3 + 0.9 * ((v * 7) % n) / n;
+      const double S0 = 800 + 400 * ((v * 13) % n) / n;
+      expected[v] = D;
+      expected[n + v] = K;
+      expected[2 * n + v] = S0;
+      values[2 * n + v] = 1.1 * S0;
+      for (unsigned int s = 0; s < numberOfMeasurements; ++s)
+      {
+        const double b = model.bvalues[s];
+        normalized[s * n + v] = exp(-b * D + b * b * D * D * K / 6);
+        measurements[s * n + v] = S0 * normalized[s * n + v];
+      }
+    }
+
+    std::vector<double> grid;
+    for (double D : {0.0005, 0.001, 0.002})
+      for (double K : {0.5, 1.0, 2.0})
+      {
+        grid.push_back(D);
+        grid.push_back(K);
+      }
+
+    itk::BatchedLevenbergMarquardt<ModelType> fitter(model, n);
+    fitter.SetGrid(grid, 2);
+    fitter.SearchGrid(normalized.data(), nullptr, n, values.data());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.1 * expected[2 * n], values[2 * n], 1e-9);
+
+    fitter.Fit(measurements.data(), nullptr, n, values.data());
+    for (unsigned int i = 0; i < 3 * n; ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, values[i] / expected[i], 1e-6);
+    }
+  }
+
+  void SearchGrid_PicksClosestPoint()
+  {
+    typedef itk::IVIM_d_and_f_batched<double> ModelType;
+    ModelType model;
+    model.bvalues.assign(m_BValues.begin(), m_BValues.end());
+    const unsigned int numberOfMeasurements = m_BValues.size();
+
+    // D = 0.001, f = 0.2 is a grid point, f = 0.14 is closest to f = 0.1
+    const double expected[][2] = {{0.001, 0.2}, {0.002, 0.14}};
+    std::vector<double> measurements(numberOfMeasurements * 2);
+    for (unsigned int s = 0; s < numberOfMeasurements; ++s)
+      for (unsigned int v = 0; v < 2; ++v)
+        measurements[s * 2 + v] = (1 - expected[v][1]) * exp(-m_BValues[s] * expected[v][0]);
+
+    itk::BatchedLevenbergMarquardt<ModelType> fitter(model, 2);
+    fitter.SetGrid({0.001, 0.2, 0.002, 0.1, 0.001, 0.5});
+    std::vector<double> values(4);
+    fitter.SearchGrid(measurements.data(), nullptr, 2, values.data());
+
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.001, values[0], 1e-12);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.2, values[2], 1e-12);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.002, values[1], 1e-12);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.1, values[3], 1e-12);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkBatchedLevenbergMarquardt)
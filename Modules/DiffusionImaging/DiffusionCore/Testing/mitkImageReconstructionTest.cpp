@@ -103,6 +103,19 @@ int mitkImageReconstructionTest(int argc, char* argv[])
             testImage->InitializeByItk( filter->GetOutput() );
             testImage->SetVolume( filter->GetOutput()->GetBufferPointer() );
             MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*testImage, *qballImage, 0.0001, true), "CSA Q-ball reconstruction test.");
+
+            MITK_DEBUG << "Voxelwise CSA Q-ball reconstruction";
+            FilterType::Pointer voxelwiseFilter = FilterType::New();
+            voxelwiseFilter->SetGradientImage( gradients, itkVectorImagePointer );
+            voxelwiseFilter->SetBValue( b_value );
+            voxelwiseFilter->SetLambda(0.006);
+            voxelwiseFilter->SetNormalizationMethod(FilterType::QBAR_SOLID_ANGLE);
+            voxelwiseFilter->UseBlockedReconstructionOff();
+            voxelwiseFilter->Update();
+            mitk::QBallImage::Pointer voxelwiseImage = mitk::QBallImage::New();
+            voxelwiseImage->InitializeByItk( voxelwiseFilter->GetOutput() );
+            voxelwiseImage->SetVolume( voxelwiseFilter->GetOutput()->GetBufferPointer() );
+            MITK_TEST_CONDITION_REQUIRED(mitk::Equal(*testImage, *voxelwiseImage, 0.0001, true), "Blocked equals voxelwise Q-ball reconstruction test.");
         }
 
         {
@@ -53,7 +53,8 @@ AnalyticalDiffusionQballReconstructionImageFilter<T,TG,TO,L,NODF>
     m_DirectionsDuplicated(false),
     m_Delta1(0.001),
     m_Delta2(0.001),
-    m_UseMrtrixBasis(false)
+    m_UseMrtrixBasis(false),
+    m_UseBlockedReconstruction(true)
 {
     // At least 1 inputs is necessary for a vector image.
     // For images added one at a time we need at least six
@@ -155,87 +156,92 @@ itk::AnalyticalDiffusionQballReconstructionImageFilter
 NOrderL, NrOdfDirections>
 ::PreNormalize( vnl_vector<TOdfPixelType> vec,
                 typename NumericTraits<ReferencePixelType>::AccumulateType b0 )
+{
+    PreNormalize(vec.data_block(), vec.size(), b0);
+    return vec;
+}
+
+template<
+        class TReferenceImagePixelType,
+        class TGradientImagePixelType,
+        class TOdfPixelType,
+        int NOrderL,
+        int NrOdfDirections>
+void
+itk::AnalyticalDiffusionQballReconstructionImageFilter
+<TReferenceImagePixelType, TGradientImagePixelType, TOdfPixelType,
+NOrderL, NrOdfDirections>
+::PreNormalize( TOdfPixelType* signal,
+                unsigned int size,
+                typename NumericTraits<ReferencePixelType>::AccumulateType b0 )
 {
     switch( m_NormalizationMethod )
     {
     case QBAR_STANDARD:
     {
-        int n = vec.size();
         double b0f = (double)b0;
-        for(int i=0; i<n; i++)
+        for(unsigned int i=0; i<size; i++)
         {
-            vec[i] = vec[i]/b0f;
+            signal[i] = signal[i]/b0f;
         }
-        return vec;
         break;
     }
     case QBAR_B_ZERO_B_VALUE:
     {
-        int n = vec.size();
-        for(int i=0; i<n; i++)
+        for(unsigned int i=0; i<size; i++)
         {
-            if (vec[i]<=0)
-                vec[i] = 0.001;
+            if (signal[i]<=0)
+                signal[i] = 0.001;
 
-            vec[i] = log(vec[i]);
+            signal[i] = log(signal[i]);
         }
-        return vec;
         break;
     }
     case QBAR_B_ZERO:
     {
-        return vec;
         break;
     }
     case QBAR_NONE:
     {
-        return vec;
         break;
     }
     case QBAR_ADC_ONLY:
     {
-        int n = vec.size();
-        for(int i=0; i<n; i++)
+        for(unsigned int i=0; i<size; i++)
         {
-            if (vec[i]<=0)
-                vec[i] = 0.001;
+            if (signal[i]<=0)
+                signal[i] = 0.001;
 
-            vec[i] = log(vec[i]);
+            signal[i] = log(signal[i]);
         }
-        return vec;
         break;
     }
     case QBAR_RAW_SIGNAL:
     {
-        return vec;
         break;
     }
     case QBAR_SOLID_ANGLE:
     case QBAR_NONNEG_SOLID_ANGLE:
     {
-        int n = vec.size();
         double b0f = (double)b0;
-        for(int i=0; i<n; i++)
+        for(unsigned int i=0; i<size; i++)
         {
-            vec[i] = vec[i]/b0f;
-
-            if (vec[i]<0)
-                vec[i] = m_Delta1;
-            else if (vec[i]<m_Delta1)
-                vec[i] = m_Delta1/2 + vec[i]*vec[i]/(2*m_Delta1);
-            else if (vec[i]>=1)
-                vec[i] = 1-m_Delta2/2;
-            else if (vec[i]>=1-m_Delta2)
-                vec[i] = 1-m_Delta2/2-(1-vec[i])*(1-vec[i])/(2*m_Delta2);
-
-            vec[i] = log(-log(vec[i]));
+            signal[i] = signal[i]/b0f;
+
+            if (signal[i]<0)
+                signal[i] = m_Delta1;
+            else if (signal[i]<m_Delta1)
+                signal[i] = m_Delta1/2 + signal[i]*signal[i]/(2*m_Delta1);
+            else if (signal[i]>=1)
+                signal[i] = 1-m_Delta2/2;
+            else if (signal[i]>=1-m_Delta2)
+                signal[i] = 1-m_Delta2/2-(1-signal[i])*(1-signal[i])/(2*m_Delta2);
+
+            signal[i] = log(-log(signal[i]));
         }
-        return vec;
         break;
     }
     }
-
-    return vec;
 }
 
 template< class T, class TG, class TO, int L, int NODF>
@@ -265,6 +271,9 @@ void AnalyticalDiffusionQballReconstructionImageFilter<T,TG,TO,L,NODF>
     }
 
     this->ComputeReconstructionMatrix();
+    m_ReconstructionMatrixTransposed = m_ReconstructionMatrix->transpose();
+    m_CoeffReconstructionMatrixTransposed = m_CoeffReconstructionMatrix->transpose();
+    m_SphericalHarmonicBasisMatrixTransposed = m_SphericalHarmonicBasisMatrix->transpose();
 
     typename GradientImagesType::Pointer img = static_cast< GradientImagesType * >(
                 this->ProcessObject::GetInput(0) );
@@ -297,11 +306,38 @@ void AnalyticalDiffusionQballReconstructionImageFilter<T,TG,TO,L,NODF>
         m_Lambda = 0.0;
 }
 
+template< class T, class TG, class TO, int L, int NODF>
+void AnalyticalDiffusionQballReconstructionImageFilter<T,TG,TO,L,NODF>
+::GetComponentIndices(std::vector<unsigned int>& baselineind, std::vector<unsigned int>& gradientind)
+{
+    for(GradientDirectionContainerType::ConstIterator gdcit = this->m_GradientDirectionContainer->Begin();
+        gdcit != this->m_GradientDirectionContainer->End(); ++gdcit)
+    {
+        if(gdcit.Value().one_norm() <= 0.0)
+            baselineind.push_back(gdcit.Index());
+        else
+            gradientind.push_back(gdcit.Index());
+    }
+
+    if( m_DirectionsDuplicated )
+    {
+        int gradIndSize = gradientind.size();
+        for(int i=0; i<gradIndSize; i++)
+            gradientind.push_back(gradientind[i]);
+    }
+}
+
 template< class T, class TG, class TO, int L, int NODF>
 void AnalyticalDiffusionQballReconstructionImageFilter<T,TG,TO,L,NODF>
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
                        ThreadIdType )
 {
+    if( m_UseBlockedReconstruction && m_NormalizationMethod != QBAR_NONNEG_SOLID_ANGLE )
+    {
+        this->BlockedThreadedGenerateData(outputRegionForThread);
+        return;
+    }
+
     typename OutputImageType::Pointer outputImage =
             static_cast< OutputImageType * >(this->ProcessObject::GetPrimaryOutput());
 
@@ -334,22 +370,7 @@ void AnalyticalDiffusionQballReconstructionImageFilter<T,TG,TO,L,NODF>
     // the baseline images
     std::vector<unsigned int> gradientind; // contains the indicies of
     // the gradient images
-
-    for(GradientDirectionContainerType::ConstIterator gdcit = this->m_GradientDirectionContainer->Begin();
-        gdcit != this->m_GradientDirectionContainer->End(); ++gdcit)
-    {
-        if(gdcit.Value().one_norm() <= 0.0)
-            baselineind.push_back(gdcit.Index());
-        else
-            gradientind.push_back(gdcit.Index());
-    }
-
-    if( m_DirectionsDuplicated )
-    {
-        int gradIndSize = gradientind.size();
-        for(int i=0; i<gradIndSize; i++)
-            gradientind.push_back(gradientind[i]);
-    }
+    this->GetComponentIndices(baselineind, gradientind);
 
     while( !git.IsAtEnd() )
     {
@@ -424,6 +445,121 @@ void AnalyticalDiffusionQballReconstructionImageFilter<T,TG,TO,L,NODF>
     std::cout << "One Thread finished reconstruction" << std::endl;
 }
 
+template< class T, class TG, class TO, int L, int NODF>
+void AnalyticalDiffusionQballReconstructionImageFilter<T,TG,TO,L,NODF>
+::BlockedThreadedGenerateData(const OutputImageRegionType& outputRegionForThread)
+{
+    typename OutputImageType::Pointer outputImage =
+            static_cast< OutputImageType * >(this->ProcessObject::GetPrimaryOutput());
+
+    ImageRegionIterator< OutputImageType > oit(outputImage, outputRegionForThread);
+    oit.GoToBegin();
+
+    ImageRegionIterator< BZeroImageType > oit2(m_BZeroImage, outputRegionForThread);
+    oit2.GoToBegin();
+
+    ImageRegionIterator< FloatImageType > oit3(m_ODFSumImage, outputRegionForThread);
+    oit3.GoToBegin();
+
+    ImageRegionIterator< CoefficientImageType > oit4(m_CoefficientImage, outputRegionForThread);
+    oit4.GoToBegin();
+
+    typedef ImageRegionConstIterator< GradientImagesType > GradientIteratorType;
+    typedef typename GradientImagesType::PixelType         GradientVectorType;
+    typedef typename NumericTraits<ReferencePixelType>::AccumulateType B0Type;
+
+    typename GradientImagesType::Pointer gradientImagePointer = static_cast< GradientImagesType * >(
+                this->ProcessObject::GetInput(0) );
+
+    GradientIteratorType git(gradientImagePointer, outputRegionForThread );
+    git.GoToBegin();
+
+    std::vector<unsigned int> baselineind;
+    std::vector<unsigned int> gradientind;
+    this->GetComponentIndices(baselineind, gradientind);
+
+    const unsigned int numberOfGradients = m_NumberOfGradientDirections;
+    const unsigned int numberOfCoefficients = m_NumberCoefficients;
+
+    // one row per voxel above threshold, allocated once per thread
+    std::vector<TO> signals(BlockSize * numberOfGradients);
+    std::vector<TO> coefficients(BlockSize * numberOfCoefficients);
+    std::vector<TO> odfs(BlockSize * NODF);
+    std::vector<B0Type> b0s(BlockSize);
+    std::vector<bool> reconstructed(BlockSize);
+
+    while( !git.IsAtEnd() )
+    {
+        // gather the normalized signals of the next block of voxels
+        unsigned int numberOfVoxels = 0;
+        unsigned int numberOfSignals = 0;
+        for( ; numberOfVoxels<BlockSize && !git.IsAtEnd(); ++numberOfVoxels, ++git )
+        {
+            GradientVectorType b = git.Get();
+
+            B0Type b0 = NumericTraits<ReferencePixelType>::Zero;
+            for(unsigned int i = 0; i < baselineind.size(); ++i)
+            {
+                b0 += b[baselineind[i]];
+            }
+            b0 /= this->m_NumberOfBaselineImages;
+            b0s[numberOfVoxels] = b0;
+
+            reconstructed[numberOfVoxels] = (b0 != 0) && (b0 >= m_Threshold);
+            if( reconstructed[numberOfVoxels] )
+            {
+                TO* signal = &signals[numberOfSignals * numberOfGradients];
+                for( unsigned int i = 0; i< numberOfGradients; i++ )
+                {
+                    signal[i] = static_cast<TO>(b[gradientind[i]]);
+                }
+                PreNormalize(signal, numberOfGradients, b0);
+                ++numberOfSignals;
+            }
+        }
+
+        // reconstruct the whole block
+        BlockedMatrixProduct(m_CoeffReconstructionMatrixTransposed, signals.data(), numberOfSignals, coefficients.data());
+        for( unsigned int s = 0; s < numberOfSignals; ++s )
+        {
+            coefficients[s * numberOfCoefficients] += 1.0/(2.0*sqrt(QBALL_ANAL_RECON_PI));
+        }
+
+        if(m_NormalizationMethod == QBAR_SOLID_ANGLE)
+            BlockedMatrixProduct(m_SphericalHarmonicBasisMatrixTransposed, coefficients.data(), numberOfSignals, odfs.data());
+        else
+            BlockedMatrixProduct(m_ReconstructionMatrixTransposed, signals.data(), numberOfSignals, odfs.data());
+
+        // scatter the results to the outputs
+        unsigned int signalIndex = 0;
+        for( unsigned int v = 0; v < numberOfVoxels; ++v )
+        {
+            OdfPixelType odf(0.0);
+            typename CoefficientImageType::PixelType coeffPixel(0.0);
+
+            if( reconstructed[v] )
+            {
+                odf = &odfs[signalIndex * NODF];
+                coeffPixel = &coefficients[signalIndex * numberOfCoefficients];
+                odf = Normalize(odf, b0s[v]);
+                ++signalIndex;
+            }
+
+            oit.Set( odf );
+            oit2.Set( b0s[v] );
+            float sum = 0;
+            for (unsigned int k=0; k<odf.Size(); k++)
+                sum += (float) odf[k];
+            oit3.Set( sum-1 );
+            oit4.Set(coeffPixel);
+            ++oit;
+            ++oit2;
+            ++oit3;
+            ++oit4;
+        }
+    }
+}
+
 template< class T, class TG, class TO, int L, int NODF>
 void AnalyticalDiffusionQballReconstructionImageFilter<T,TG,TO,L,NODF>
 ::tofile2(vnl_matrix<double> *pA, std::string fname)
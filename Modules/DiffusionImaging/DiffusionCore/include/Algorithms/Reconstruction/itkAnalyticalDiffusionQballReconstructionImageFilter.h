@@ -23,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vnl/algo/vnl_svd.h"
 #include "itkVectorContainer.h"
 #include "itkVectorImage.h"
+#include "itkBlockedMatrixProduct.h"
 
 
 namespace itk{
@@ -67,6 +68,10 @@ namespace itk{
  * \li BasisFunctionCenters - the centers of the basis functions are used for
  * the sRBF (spherical radial basis functions interpolation). If not set, they
  * will be defaulted to equal m_EquatorNrSamplingPoints
+ * \li UseBlockedReconstruction - gather the signals of blocks of voxels and
+ * reconstruct them with one matrix product per block (see BlockedMatrixProduct)
+ * instead of one matrix-vector product per voxel. On by default, the results
+ * equal the voxelwise reconstruction up to rounding.
  *
  * \par Template parameters
  * The class is templated over
@@ -192,6 +197,8 @@ public:
 
     OdfPixelType Normalize(OdfPixelType odf, typename NumericTraits<ReferencePixelType>::AccumulateType b0 );
     vnl_vector<TOdfPixelType> PreNormalize( vnl_vector<TOdfPixelType> vec, typename NumericTraits<ReferencePixelType>::AccumulateType b0  );
+    /** In-place version of PreNormalize for the signal of one voxel */
+    void PreNormalize( TOdfPixelType* signal, unsigned int size, typename NumericTraits<ReferencePixelType>::AccumulateType b0 );
 
     /** Threshold on the reference image data. The output ODF will be a null
    * pdf for pixels in the reference image that have a value less than this
@@ -217,6 +224,10 @@ public:
 
     itkSetMacro( UseMrtrixBasis, bool )
 
+    itkSetMacro( UseBlockedReconstruction, bool )
+    itkGetMacro( UseBlockedReconstruction, bool )
+    itkBooleanMacro( UseBlockedReconstruction )
+
 #ifdef ITK_USE_CONCEPT_CHECKING
     /** Begin concept checking */
     itkConceptMacro(ReferenceEqualityComparableCheck,
@@ -247,8 +258,17 @@ protected:
     void ThreadedGenerateData( const
                                OutputImageRegionType &outputRegionForThread, ThreadIdType);
 
+    /** Reconstructs blocks of voxels with BlockedMatrixProduct */
+    void BlockedThreadedGenerateData( const OutputImageRegionType &outputRegionForThread );
+
+    /** Number of voxels reconstructed at once by BlockedThreadedGenerateData */
+    static const unsigned int BlockSize = 256;
+
 private:
 
+    /** Fills the indices of the baseline and gradient components of the input */
+    void GetComponentIndices( std::vector<unsigned int>& baselineind, std::vector<unsigned int>& gradientind );
+
     OdfReconstructionMatrixType                       m_ReconstructionMatrix;
     OdfReconstructionMatrixType                       m_CoeffReconstructionMatrix;
     OdfReconstructionMatrixType                       m_SphericalHarmonicBasisMatrix;
@@ -274,6 +294,11 @@ private:
     TOdfPixelType                                     m_Delta1;
     TOdfPixelType                                     m_Delta2;
     bool                                              m_UseMrtrixBasis;
+    bool                                              m_UseBlockedReconstruction;
+    /** Transposed reconstruction matrices for BlockedMatrixProduct */
+    vnl_matrix< TOdfPixelType >                       m_ReconstructionMatrixTransposed;
+    vnl_matrix< TOdfPixelType >                       m_CoeffReconstructionMatrixTransposed;
+    vnl_matrix< TOdfPixelType >                       m_SphericalHarmonicBasisMatrixTransposed;
 };
 
 }
@@ -0,0 +1,360 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __itkBatchedLevenbergMarquardt_h_
+#define __itkBatchedLevenbergMarquardt_h_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace itk{
+
+/**
+ * \brief Levenberg-Marquardt least squares fit of a small model to many voxels at once.
+ *
+ * Measurements, weights and values of all voxels of a batch are stored in structure-of-arrays layout:
+ * measurement s of voxel v is found at s*numberOfVoxels + v, value p at p*numberOfVoxels + v.
+ * Each iteration evaluates the residuals and their closed-form derivatives measurement by measurement
+ * for all voxels that are still being fitted, so the inner loops run over voxels without virtual calls
+ * or allocations. Every voxel has its own damping factor and leaves the iterations as soon as its
+ * relative cost decrease falls below the tolerance or no step decreases its cost anymore.
+ *
+ * The start values can be chosen by SearchGrid(), which compares the measurements to the model signal
+ * tabulated at the points passed to SetGrid() and picks the closest point for every voxel.
+ *
+ * TModel has to provide
+ * - typedef ValueType (float or double),
+ * - static const unsigned int NumberOfParameters and NumberOfValues: the first NumberOfParameters
+ *   values are fitted, the remaining ones are per voxel constants that are passed to the model,
+ * - unsigned int GetNumberOfMeasurements() const,
+ * - ValueType Residual(unsigned int s, ValueType measurement, const ValueType* x) const,
+ * - ValueType Residual(unsigned int s, ValueType measurement, const ValueType* x, ValueType* derivatives) const,
+ *   which also stores the NumberOfParameters partial derivatives of the residual,
+ * - ValueType Tabulate(unsigned int s, const ValueType* x) const, the model signal compared
+ *   to the measurements passed to SearchGrid().
+ */
+template< class TModel >
+class BatchedLevenbergMarquardt
+{
+public:
+
+    typedef typename TModel::ValueType ValueType;
+
+    static const unsigned int NumberOfParameters = TModel::NumberOfParameters;
+    static const unsigned int NumberOfValues = TModel::NumberOfValues;
+
+    BatchedLevenbergMarquardt( const TModel& model, unsigned int maximumNumberOfVoxels )
+        : m_Model(model)
+        , m_MaximumNumberOfVoxels(maximumNumberOfVoxels)
+        , m_MaximumNumberOfIterations(100)
+        , m_Tolerance(0.0001)
+        , m_GridDimension(0)
+        , m_Active(maximumNumberOfVoxels)
+        , m_Cost(maximumNumberOfVoxels)
+        , m_Lambda(maximumNumberOfVoxels)
+        , m_TrialCost(maximumNumberOfVoxels)
+        , m_Trial(NumberOfValues*maximumNumberOfVoxels)
+        , m_Gradient(NumberOfParameters*maximumNumberOfVoxels)
+        , m_Hessian(NumberOfParameters*NumberOfParameters*maximumNumberOfVoxels)
+    {}
+
+    /** Maximum number of iterations per voxel (default 100) */
+    void SetMaximumNumberOfIterations( unsigned int iterations ) { m_MaximumNumberOfIterations = iterations; }
+
+    /** A voxel is converged when an accepted step decreases its cost by less than this fraction (default 0.0001) */
+    void SetTolerance( ValueType tolerance ) { m_Tolerance = tolerance; }
+
+    /**
+     * Set the grid points used by SearchGrid(), dimension values per point. SearchGrid() only sets
+     * the first dimension values of the voxels, the model signal of every point is tabulated here.
+     */
+    void SetGrid( const std::vector< ValueType >& points, unsigned int dimension = NumberOfParameters )
+    {
+        const unsigned int numberOfMeasurements = m_Model.GetNumberOfMeasurements();
+
+        m_GridDimension = dimension;
+        m_Grid = points;
+        m_Table.resize(points.size()/dimension * numberOfMeasurements);
+
+        ValueType x[NumberOfValues];
+        for (unsigned int g=0; g<points.size()/dimension; ++g)
+        {
+            std::fill(x, x+NumberOfValues, ValueType(0));
+            std::copy(points.begin() + g*dimension, points.begin() + (g+1)*dimension, x);
+            for (unsigned int s=0; s<numberOfMeasurements; ++s)
+                m_Table[g*numberOfMeasurements + s] = m_Model.Tabulate(s, x);
+        }
+    }
+
+    /**
+     * Set the first values of every voxel to the grid point whose tabulated signal is closest
+     * to the given measurements in the (weighted) least squares sense. weights may be null.
+     */
+    void SearchGrid( const ValueType* measurements, const ValueType* weights, unsigned int numberOfVoxels, ValueType* values )
+    {
+        const unsigned int numberOfMeasurements = m_Model.GetNumberOfMeasurements();
+        if (m_GridDimension==0 || m_Grid.empty())
+            return;
+
+        // m_Cost and m_TrialCost are not needed before Fit()
+        ValueType* bestCost = &m_Cost[0];
+        ValueType* cost = &m_TrialCost[0];
+        std::fill(bestCost, bestCost + numberOfVoxels, std::numeric_limits<ValueType>::max());
+        std::vector< unsigned int > best(numberOfVoxels, 0);
+
+        for (unsigned int g=0; g<m_Grid.size()/m_GridDimension; ++g)
+        {
+            const ValueType* table = &m_Table[g*numberOfMeasurements];
+            std::fill(cost, cost + numberOfVoxels, ValueType(0));
+            for (unsigned int s=0; s<numberOfMeasurements; ++s)
+            {
+                const ValueType t = table[s];
+                const ValueType* m = measurements + s*numberOfVoxels;
+                const ValueType* w = weights ? weights + s*numberOfVoxels : nullptr;
+                for (unsigned int v=0; v<numberOfVoxels; ++v)
+                {
+                    const ValueType d = w ? w[v]*(m[v]-t) : m[v]-t;
+                    cost[v] += d*d;
+                }
+            }
+            for (unsigned int v=0; v<numberOfVoxels; ++v)
+            {
+                if (cost[v]<bestCost[v])
+                {
+                    bestCost[v] = cost[v];
+                    best[v] = g;
+                }
+            }
+        }
+
+        for (unsigned int v=0; v<numberOfVoxels; ++v)
+            for (unsigned int p=0; p<m_GridDimension; ++p)
+                values[p*numberOfVoxels + v] = m_Grid[best[v]*m_GridDimension + p];
+    }
+
+    /**
+     * Fit the model to numberOfVoxels voxels, starting from and overwriting the first NumberOfParameters
+     * values. The residuals of a voxel are multiplied with its weights, weights may be null.
+     */
+    void Fit( const ValueType* measurements, const ValueType* weights, unsigned int numberOfVoxels, ValueType* values )
+    {
+        const unsigned int n = numberOfVoxels;
+
+        for (unsigned int v=0; v<n; ++v)
+        {
+            m_Active[v] = v;
+            m_Lambda[v] = 0.001;
+            for (unsigned int p=0; p<NumberOfValues; ++p)
+                m_Trial[p*m_MaximumNumberOfVoxels + v] = values[p*n + v];
+        }
+        unsigned int numberOfActive = n;
+        this->ComputeTrialCost(measurements, weights, n, numberOfActive);
+        std::copy(m_TrialCost.begin(), m_TrialCost.begin() + n, m_Cost.begin());
+
+        // voxels that already fit exactly
+        numberOfActive = 0;
+        for (unsigned int v=0; v<n; ++v)
+            if (m_Cost[v] > std::numeric_limits<ValueType>::min())
+                m_Active[numberOfActive++] = v;
+
+        for (unsigned int iteration=0; iteration<m_MaximumNumberOfIterations && numberOfActive>0; ++iteration)
+        {
+            this->ComputeNormalEquations(measurements, weights, n, numberOfActive, values);
+
+            // damped Gauss-Newton step of every active voxel
+            for (unsigned int i=0; i<numberOfActive; ++i)
+            {
+                const unsigned int v = m_Active[i];
+
+                ValueType a[NumberOfParameters][NumberOfParameters];
+                ValueType step[NumberOfParameters];
+                for (unsigned int p=0; p<NumberOfParameters; ++p)
+                {
+                    for (unsigned int q=0; q<NumberOfParameters; ++q)
+                        a[p][q] = m_Hessian[(p*NumberOfParameters + q)*m_MaximumNumberOfVoxels + i];
+                    a[p][p] += m_Lambda[v] * std::max(a[p][p], ValueType(1e-12));
+                    step[p] = -m_Gradient[p*m_MaximumNumberOfVoxels + i];
+                }
+
+                const bool solved = Solve(a, step);
+                for (unsigned int p=0; p<NumberOfValues; ++p)
+                {
+                    const ValueType value = values[p*n + v];
+                    m_Trial[p*m_MaximumNumberOfVoxels + i] = (p<NumberOfParameters && solved) ? value + step[p] : value;
+                }
+            }
+
+            this->ComputeTrialCost(measurements, weights, n, numberOfActive);
+
+            // accept or reject the steps and remove converged voxels
+            unsigned int numberOfRemaining = 0;
+            for (unsigned int i=0; i<numberOfActive; ++i)
+            {
+                const unsigned int v = m_Active[i];
+                bool converged;
+                if (m_TrialCost[i] < m_Cost[v])
+                {
+                    for (unsigned int p=0; p<NumberOfParameters; ++p)
+                        values[p*n + v] = m_Trial[p*m_MaximumNumberOfVoxels + i];
+                    converged = m_Cost[v] - m_TrialCost[i] <= m_Tolerance*m_Cost[v]
+                            || m_TrialCost[i] <= std::numeric_limits<ValueType>::min();
+                    m_Cost[v] = m_TrialCost[i];
+                    m_Lambda[v] *= 0.1;
+                }
+                else
+                {
+                    m_Lambda[v] *= 10;
+                    converged = !(m_Lambda[v] < 1e10);
+                }
+                if (!converged)
+                    m_Active[numberOfRemaining++] = v;
+            }
+            numberOfActive = numberOfRemaining;
+        }
+    }
+
+    /** Cost (sum of squared weighted residuals) of a voxel after the last Fit() */
+    ValueType GetCost( unsigned int voxel ) const { return m_Cost[voxel]; }
+
+protected:
+
+    /** Solve the small system a*x = b in place (Gaussian elimination with partial pivoting) */
+    static bool Solve( ValueType a[NumberOfParameters][NumberOfParameters], ValueType b[NumberOfParameters] )
+    {
+        for (unsigned int c=0; c<NumberOfParameters; ++c)
+        {
+            unsigned int pivot = c;
+            for (unsigned int r=c+1; r<NumberOfParameters; ++r)
+                if (std::abs(a[r][c]) > std::abs(a[pivot][c]))
+                    pivot = r;
+            if (!(std::abs(a[pivot][c]) > 0))
+                return false;
+            if (pivot!=c)
+            {
+                for (unsigned int k=0; k<NumberOfParameters; ++k)
+                    std::swap(a[c][k], a[pivot][k]);
+                std::swap(b[c], b[pivot]);
+            }
+            for (unsigned int r=c+1; r<NumberOfParameters; ++r)
+            {
+                const ValueType factor = a[r][c]/a[c][c];
+                for (unsigned int k=c; k<NumberOfParameters; ++k)
+                    a[r][k] -= factor*a[c][k];
+                b[r] -= factor*b[c];
+            }
+        }
+        for (int r=NumberOfParameters-1; r>=0; --r)
+        {
+            for (unsigned int k=r+1; k<NumberOfParameters; ++k)
+                b[r] -= a[r][k]*b[k];
+            b[r] /= a[r][r];
+        }
+        return true;
+    }
+
+    /** Sum of squared residuals of the trial values of the active voxels */
+    void ComputeTrialCost( const ValueType* measurements, const ValueType* weights, unsigned int n, unsigned int numberOfActive )
+    {
+        const unsigned int numberOfMeasurements = m_Model.GetNumberOfMeasurements();
+        std::fill(m_TrialCost.begin(), m_TrialCost.begin() + numberOfActive, ValueType(0));
+
+        for (unsigned int s=0; s<numberOfMeasurements; ++s)
+        {
+            const ValueType* m = measurements + s*n;
+            const ValueType* w = weights ? weights + s*n : nullptr;
+            for (unsigned int i=0; i<numberOfActive; ++i)
+            {
+                const unsigned int v = m_Active[i];
+                ValueType x[NumberOfValues];
+                for (unsigned int p=0; p<NumberOfValues; ++p)
+                    x[p] = m_Trial[p*m_MaximumNumberOfVoxels + i];
+                ValueType r = m_Model.Residual(s, m[v], x);
+                if (w)
+                    r *= w[v];
+                m_TrialCost[i] += r*r;
+            }
+        }
+    }
+
+    /** J^T*J and J^T*r at the current values of the active voxels */
+    void ComputeNormalEquations( const ValueType* measurements, const ValueType* weights, unsigned int n, unsigned int numberOfActive, const ValueType* values )
+    {
+        const unsigned int numberOfMeasurements = m_Model.GetNumberOfMeasurements();
+        const unsigned int stride = m_MaximumNumberOfVoxels;
+        for (unsigned int p=0; p<NumberOfParameters; ++p)
+        {
+            std::fill(m_Gradient.begin() + p*stride, m_Gradient.begin() + p*stride + numberOfActive, ValueType(0));
+            for (unsigned int q=0; q<NumberOfParameters; ++q)
+                std::fill(m_Hessian.begin() + (p*NumberOfParameters + q)*stride, m_Hessian.begin() + (p*NumberOfParameters + q)*stride + numberOfActive, ValueType(0));
+        }
+
+        for (unsigned int s=0; s<numberOfMeasurements; ++s)
+        {
+            const ValueType* m = measurements + s*n;
+            const ValueType* w = weights ? weights + s*n : nullptr;
+            for (unsigned int i=0; i<numberOfActive; ++i)
+            {
+                const unsigned int v = m_Active[i];
+                ValueType x[NumberOfValues];
+                for (unsigned int p=0; p<NumberOfValues; ++p)
+                    x[p] = values[p*n + v];
+                ValueType jacobian[NumberOfParameters];
+                ValueType r = m_Model.Residual(s, m[v], x, jacobian);
+                if (w)
+                {
+                    r *= w[v];
+                    for (unsigned int p=0; p<NumberOfParameters; ++p)
+                        jacobian[p] *= w[v];
+                }
+                for (unsigned int p=0; p<NumberOfParameters; ++p)
+                {
+                    m_Gradient[p*stride + i] += jacobian[p]*r;
+                    for (unsigned int q=p; q<NumberOfParameters; ++q)
+                        m_Hessian[(p*NumberOfParameters + q)*stride + i] += jacobian[p]*jacobian[q];
+                }
+            }
+        }
+
+        // mirror the upper triangle
+        for (unsigned int p=0; p<NumberOfParameters; ++p)
+            for (unsigned int q=0; q<p; ++q)
+                std::copy(m_Hessian.begin() + (q*NumberOfParameters + p)*stride, m_Hessian.begin() + (q*NumberOfParameters + p)*stride + numberOfActive,
+                          m_Hessian.begin() + (p*NumberOfParameters + q)*stride);
+    }
+
+    TModel m_Model;
+    unsigned int m_MaximumNumberOfVoxels;
+    unsigned int m_MaximumNumberOfIterations;
+    ValueType m_Tolerance;
+
+    unsigned int m_GridDimension;
+    std::vector< ValueType > m_Grid;
+    std::vector< ValueType > m_Table;
+
+    std::vector< unsigned int > m_Active;   ///< voxels that are still fitted
+    std::vector< ValueType > m_Cost;        ///< per voxel
+    std::vector< ValueType > m_Lambda;      ///< per voxel
+    std::vector< ValueType > m_TrialCost;   ///< per active voxel
+    std::vector< ValueType > m_Trial;       ///< per value and active voxel
+    std::vector< ValueType > m_Gradient;    ///< per parameter and active voxel
+    std::vector< ValueType > m_Hessian;     ///< per parameter pair and active voxel
+};
+
+}
+
+#endif //__itkBatchedLevenbergMarquardt_h_
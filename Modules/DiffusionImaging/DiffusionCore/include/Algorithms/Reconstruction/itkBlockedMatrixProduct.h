@@ -0,0 +1,97 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __itkBlockedMatrixProduct_h_
+#define __itkBlockedMatrixProduct_h_
+
+#include <vnl/vnl_matrix.h>
+#include <algorithm>
+
+namespace itk{
+
+/**
+ * \brief Multiplies a matrix with a block of vectors at once.
+ *
+ * Computes output_v = M * input_v for numberOfVectors vectors, which are stored one after the other
+ * in input (M.columns() values each) and output (M.rows() values each). The transposed matrix M^T
+ * has to be passed, so that the innermost loop runs over contiguous rows of M^T and of the output
+ * and can be vectorized by the compiler. Four vectors are processed together, so that every row
+ * of M^T is loaded once per four vectors instead of once per vector.
+ *
+ * The products are summed in the same order as in vnl_matrix * vnl_vector, results only differ
+ * if the compiler contracts multiplications and additions differently.
+ *
+ * Used by the Q-ball reconstruction filters to reconstruct blocks of voxels.
+ */
+template< class TValue >
+void BlockedMatrixProduct( const vnl_matrix< TValue >& transposedMatrix,
+                           const TValue* input,
+                           unsigned int numberOfVectors,
+                           TValue* output )
+{
+    const unsigned int inputSize = transposedMatrix.rows();
+    const unsigned int outputSize = transposedMatrix.columns();
+
+    std::fill(output, output + numberOfVectors*outputSize, TValue(0));
+
+    unsigned int v = 0;
+    for (; v+4<=numberOfVectors; v+=4)
+    {
+        const TValue* in0 = input + v*inputSize;
+        const TValue* in1 = in0 + inputSize;
+        const TValue* in2 = in1 + inputSize;
+        const TValue* in3 = in2 + inputSize;
+        TValue* out0 = output + v*outputSize;
+        TValue* out1 = out0 + outputSize;
+        TValue* out2 = out1 + outputSize;
+        TValue* out3 = out2 + outputSize;
+
+        for (unsigned int k=0; k<inputSize; ++k)
+        {
+            const TValue* row = transposedMatrix[k];
+            const TValue a0 = in0[k];
+            const TValue a1 = in1[k];
+            const TValue a2 = in2[k];
+            const TValue a3 = in3[k];
+            for (unsigned int i=0; i<outputSize; ++i)
+            {
+                const TValue m = row[i];
+                out0[i] += a0*m;
+                out1[i] += a1*m;
+                out2[i] += a2*m;
+                out3[i] += a3*m;
+            }
+        }
+    }
+
+    // remaining vectors
+    for (; v<numberOfVectors; ++v)
+    {
+        const TValue* in = input + v*inputSize;
+        TValue* out = output + v*outputSize;
+        for (unsigned int k=0; k<inputSize; ++k)
+        {
+            const TValue* row = transposedMatrix[k];
+            const TValue a = in[k];
+            for (unsigned int i=0; i<outputSize; ++i)
+                out[i] += a*row[i];
+        }
+    }
+}
+
+}
+
+#endif //__itkBlockedMatrixProduct_h_
@@ -25,6 +25,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vnl/algo/vnl_symmetric_eigensystem.h"
 
 #include "itkRegularizedIVIMReconstructionFilter.h"
+#include "itkBatchedLevenbergMarquardt.h"
 
 #include <mitkLogMacros.h>
 
@@ -39,7 +40,9 @@ DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, TOut>
     m_GradientDirectionContainer(nullptr),
     m_Method(IVIM_DSTAR_FIX),
     m_FitDStar(true),
-    m_Verbose(false)
+    m_Verbose(false),
+    m_UseBatchedFitting(true),
+    m_UseSinglePrecisionFitting(false)
 {
     this->SetNumberOfRequiredInputs( 1 );
 
@@ -198,11 +201,344 @@ MeasAndBvals DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, T
     return retval;
 }
 
+template< class TIn, class TOut>
+void DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, TOut>
+::NormalizeMeasurements(const typename InputImageType::PixelType &measvec, vnl_vector<double> &meas, vnl_vector<double> &allmeas) const
+{
+    typename NumericTraits<InputPixelType>::AccumulateType b0 = NumericTraits<InputPixelType>::Zero;
+
+    meas.set_size(m_Snap.N);
+    allmeas.set_size(m_Snap.N);
+    if(!m_Snap.iterated_sequence)
+    {
+        // Average the baseline image pixels
+        for(unsigned int i = 0; i < m_Snap.baselineind.size(); ++i)
+        {
+            b0 += measvec[m_Snap.baselineind[i]];
+        }
+        if(m_Snap.baselineind.size())
+            b0 /= m_Snap.baselineind.size();
+
+        // measurement vector
+        for(int i = 0; i < m_Snap.N; ++i)
+        {
+            allmeas[i] = measvec[m_Snap.gradientind[i]] / (b0+.0001);
+
+            if(measvec[m_Snap.gradientind[i]] > m_S0Thres)
+            {
+                meas[i] = measvec[m_Snap.gradientind[i]] / (b0+.0001);
+            }
+            else
+            {
+                meas[i] = IVIM_FOO;
+            }
+        }
+    }
+    else
+    {
+        // measurement vector
+        for(int i = 0; i < m_Snap.N; ++i)
+        {
+            b0 = measvec[m_Snap.baselineind[i]];
+
+            allmeas[i] = measvec[m_Snap.gradientind[i]] / (b0+.0001);
+
+            if(measvec[m_Snap.gradientind[i]] > m_S0Thres)
+            {
+                meas[i] = measvec[m_Snap.gradientind[i]] / (b0+.0001);
+            }
+            else
+            {
+                meas[i] = IVIM_FOO;
+            }
+        }
+    }
+}
+
+template< class TIn, class TOut>
+double DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, TOut>
+::SearchDStar(const MeasAndBvals &input, double D, double f) const
+{
+    IVIM_dstar_only f_dstar_only(input.N,D,f);
+    f_dstar_only.set_bvalues(input.bvals);
+    f_dstar_only.set_measurements(input.meas);
+
+    vnl_vector< double > x_dstar_only(1);
+    vnl_vector< double > fx_dstar_only(input.N);
+
+    double opt = 1111111111111111.0;
+    int opt_idx = -1;
+    int num_its = 100;
+    double min_val = .001;
+    double max_val = .15;
+    for(int i=0; i<num_its; i++)
+    {
+        x_dstar_only[0] = min_val + i * ((max_val-min_val) / num_its);
+        f_dstar_only.f(x_dstar_only, fx_dstar_only);
+        double err = fx_dstar_only.two_norm();
+        if(err<opt)
+        {
+            opt = err;
+            opt_idx = i;
+        }
+    }
+
+    return min_val + opt_idx * ((max_val-min_val) / num_its);
+}
+
+template< class TIn, class TOut>
+template< class TValue >
+void DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, TOut>
+::BatchedThreadedGenerateData(const OutputImageRegionType& outputRegionForThread)
+{
+    // coarse grid of start values, the former fixed start values are one of its points
+    const TValue fGrid[] = {0.0, 0.05, 0.1, 0.2, 0.3, 0.45};
+    const TValue dGrid[] = {0.0002, 0.0005, 0.001, 0.0015, 0.0025};
+    const TValue dstarGrid[] = {0.005, 0.01, 0.02, 0.04, 0.08};
+    std::vector<TValue> grid;
+
+    switch(m_Method)
+    {
+    case IVIM_FIT_ALL:
+    {
+        IVIM_3param_batched<TValue> model;
+        model.bvalues.assign(m_Snap.bvalues.begin(), m_Snap.bvalues.end());
+        for(TValue f : fGrid)
+            for(TValue D : dGrid)
+                for(TValue DStar : dstarGrid)
+                {
+                    grid.push_back(f);
+                    grid.push_back(D);
+                    grid.push_back(DStar);
+                }
+        this->BatchedFit(model, grid, outputRegionForThread);
+        break;
+    }
+    case IVIM_DSTAR_FIX:
+    {
+        IVIM_fixdstar_batched<TValue> model(m_DStar);
+        model.bvalues.assign(m_Snap.bvalues.begin(), m_Snap.bvalues.end());
+        for(TValue f : fGrid)
+            for(TValue D : dGrid)
+            {
+                grid.push_back(f);
+                grid.push_back(D);
+            }
+        this->BatchedFit(model, grid, outputRegionForThread);
+        break;
+    }
+    case IVIM_D_THEN_DSTAR:
+    {
+        IVIM_d_and_f_batched<TValue> model;
+        model.bvalues.assign(m_Snap.high_bvalues.begin(), m_Snap.high_bvalues.end());
+        for(TValue D : dGrid)
+            for(TValue f : fGrid)
+            {
+                grid.push_back(D);
+                grid.push_back(f);
+            }
+        this->BatchedFit(model, grid, outputRegionForThread);
+        break;
+    }
+    default:
+        itkExceptionMacro("Batched fitting is not available for the selected IVIM method.");
+    }
+}
+
+template< class TIn, class TOut>
+template< class TModel >
+void DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, TOut>
+::BatchedFit(const TModel &model, const std::vector<typename TModel::ValueType> &grid,
+             const OutputImageRegionType& outputRegionForThread)
+{
+    typedef typename TModel::ValueType ValueType;
+
+    typename OutputImageType::Pointer outputImage =
+            static_cast< OutputImageType * >(this->ProcessObject::GetPrimaryOutput());
+    ImageRegionIterator< OutputImageType > oit(outputImage, outputRegionForThread);
+    oit.GoToBegin();
+
+    typename OutputImageType::Pointer dImage =
+            static_cast< OutputImageType * >(this->ProcessObject::GetOutput(1));
+    ImageRegionIterator< OutputImageType > oit1(dImage, outputRegionForThread);
+    oit1.GoToBegin();
+
+    typename OutputImageType::Pointer dstarImage =
+            static_cast< OutputImageType * >(this->ProcessObject::GetOutput(2));
+    ImageRegionIterator< OutputImageType > oit2(dstarImage, outputRegionForThread);
+    oit2.GoToBegin();
+
+    typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >(
+                this->ProcessObject::GetInput(0) );
+    ImageRegionConstIterator< InputImageType > iit(inputImagePointer, outputRegionForThread );
+    iit.GoToBegin();
+
+    // IVIM_D_THEN_DSTAR fits D and f to the measurements above the b-value threshold first
+    const bool highOnly = m_Method == IVIM_D_THEN_DSTAR;
+    const unsigned int numberOfMeasurements = model.GetNumberOfMeasurements();
+    const unsigned int minimumNumberOfMeasurements = m_Method == IVIM_FIT_ALL ? 3 : 2;
+
+    BatchedLevenbergMarquardt<TModel> fitter(model, BlockSize);
+    fitter.SetTolerance(0.0001);
+    fitter.SetGrid(grid);
+
+    // per block buffers, the fitted voxels are stored in structure-of-arrays layout
+    std::vector< vnl_vector<double> > meas(BlockSize);
+    std::vector< vnl_vector<double> > allmeas(BlockSize);
+    std::vector<ValueType> measurements(numberOfMeasurements*BlockSize);
+    std::vector<ValueType> weights(numberOfMeasurements*BlockSize);
+    std::vector<ValueType> values(TModel::NumberOfValues*BlockSize);
+    std::vector<unsigned int> fitted(BlockSize);
+    std::vector<double> f(BlockSize);
+    std::vector<double> D(BlockSize);
+    std::vector<double> DStar(BlockSize);
+
+    while( !iit.IsAtEnd() )
+    {
+        unsigned int numberOfVoxels = 0;
+        unsigned int numberOfFitted = 0;
+        for(; numberOfVoxels<BlockSize && !iit.IsAtEnd(); ++numberOfVoxels, ++iit)
+        {
+            const unsigned int v = numberOfVoxels;
+            this->NormalizeMeasurements(iit.Get(), meas[v], allmeas[v]);
+            f[v] = 0;
+            D[v] = 0;
+            DStar[v] = 0;
+
+            unsigned int numberOfValid = 0;
+            unsigned int lastValid = 0;
+            for(unsigned int i=0; i<numberOfMeasurements; i++)
+            {
+                if(meas[v][highOnly ? m_Snap.high_indices[i] : i] != IVIM_FOO)
+                {
+                    ++numberOfValid;
+                    lastValid = i;
+                }
+            }
+
+            if(numberOfValid >= minimumNumberOfMeasurements)
+            {
+                fitted[numberOfFitted++] = v;
+            }
+            else if(highOnly && numberOfValid == 1)
+            {
+                D[v] = - log(meas[v][m_Snap.high_indices[lastValid]]) / m_Snap.high_bvalues[lastValid];
+            }
+        }
+
+        for(unsigned int i=0; i<numberOfMeasurements; i++)
+        {
+            for(unsigned int j=0; j<numberOfFitted; j++)
+            {
+                const double m = meas[fitted[j]][highOnly ? m_Snap.high_indices[i] : i];
+                measurements[i*numberOfFitted + j] = m != IVIM_FOO ? m : 0;
+                weights[i*numberOfFitted + j] = m != IVIM_FOO ? 1 : 0;
+            }
+        }
+
+        fitter.SearchGrid(measurements.data(), weights.data(), numberOfFitted, values.data());
+        fitter.Fit(measurements.data(), weights.data(), numberOfFitted, values.data());
+
+        for(unsigned int j=0; j<numberOfFitted; j++)
+        {
+            const unsigned int v = fitted[j];
+            const double x0 = values[j];
+            const double x1 = values[numberOfFitted + j];
+            switch(m_Method)
+            {
+            case IVIM_FIT_ALL:
+                f[v] = x0;
+                D[v] = x1;
+                DStar[v] = TModel::NumberOfValues > 2 ? values[2*numberOfFitted + j] : 0;
+                break;
+            case IVIM_DSTAR_FIX:
+                f[v] = x0;
+                D[v] = x1;
+                DStar[v] = m_DStar;
+                break;
+            default:
+                D[v] = x0;
+                f[v] = x1;
+                if(m_FitDStar)
+                {
+                    MeasAndBvals input2 = ApplyS0Threshold(meas[v], m_Snap.bvalues);
+                    if(input2.N >= 2)
+                        DStar[v] = this->SearchDStar(input2, D[v], f[v]);
+                }
+            }
+        }
+
+        for(unsigned int v=0; v<numberOfVoxels; v++)
+        {
+            double ceiledF = f[v];
+            IVIM_CEIL( ceiledF, 0.0, 1.0 );
+
+            oit.Set( ceiledF );
+            oit1.Set( D[v] );
+            oit2.Set( DStar[v] );
+
+            ++oit;
+            ++oit1;
+            ++oit2;
+        }
+
+        // the snapshot reports the last voxel, like the voxelwise fit
+        if(iit.IsAtEnd() && numberOfVoxels > 0)
+        {
+            const unsigned int last = numberOfVoxels-1;
+            m_Snap.meas = meas[last];
+            m_Snap.allmeas = allmeas[last];
+            m_Snap.currentFunceiled = f[last];
+            m_Snap.currentF = f[last];
+            IVIM_CEIL( m_Snap.currentF, 0.0, 1.0 );
+            m_Snap.currentD = D[last];
+            m_Snap.currentDStar = DStar[last];
+
+            MeasAndBvals input;
+            if(highOnly)
+            {
+                for(int i=0; i<m_Snap.Nhigh; i++)
+                {
+                    m_Snap.high_meas[i] = m_Snap.meas[m_Snap.high_indices.at(i)];
+                }
+                input = ApplyS0Threshold(m_Snap.high_meas, m_Snap.high_bvalues);
+            }
+            else
+            {
+                input = ApplyS0Threshold(m_Snap.meas, m_Snap.bvalues);
+            }
+            m_Snap.bvals1 = input.bvals;
+            m_Snap.meas1 = input.meas;
+
+            if(highOnly && m_FitDStar)
+            {
+                MeasAndBvals input2 = ApplyS0Threshold(m_Snap.meas, m_Snap.bvalues);
+                m_Snap.bvals2 = input2.bvals;
+                m_Snap.meas2 = input2.meas;
+            }
+        }
+    }
+
+    if(m_Verbose)
+    {
+        std::cout << "One Thread finished reconstruction" << std::endl;
+    }
+}
+
 template< class TIn, class TOut>
 void DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, TOut>
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread,
                        ThreadIdType )
 {
+    if(m_UseBatchedFitting
+            && (m_Method == IVIM_FIT_ALL || m_Method == IVIM_DSTAR_FIX || m_Method == IVIM_D_THEN_DSTAR))
+    {
+        if(m_UseSinglePrecisionFitting)
+            this->template BatchedThreadedGenerateData<float>(outputRegionForThread);
+        else
+            this->template BatchedThreadedGenerateData<double>(outputRegionForThread);
+        return;
+    }
 
     typename OutputImageType::Pointer outputImage =
             static_cast< OutputImageType * >(this->ProcessObject::GetPrimaryOutput());
@@ -270,54 +606,7 @@ void DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, TOut>
     {
         InputVectorType measvec = iit.Get();
 
-        typename NumericTraits<InputPixelType>::AccumulateType b0 = NumericTraits<InputPixelType>::Zero;
-
-        m_Snap.meas.set_size(m_Snap.N);
-        m_Snap.allmeas.set_size(m_Snap.N);
-        if(!m_Snap.iterated_sequence)
-        {
-            // Average the baseline image pixels
-            for(unsigned int i = 0; i < m_Snap.baselineind.size(); ++i)
-            {
-                b0 += measvec[m_Snap.baselineind[i]];
-            }
-            if(m_Snap.baselineind.size())
-                b0 /= m_Snap.baselineind.size();
-
-            // measurement vector
-            for(int i = 0; i < m_Snap.N; ++i)
-            {
-                m_Snap.allmeas[i] = measvec[m_Snap.gradientind[i]] / (b0+.0001);
-
-                if(measvec[m_Snap.gradientind[i]] > m_S0Thres)
-                {
-                    m_Snap.meas[i] = measvec[m_Snap.gradientind[i]] / (b0+.0001);
-                }
-                else
-                {
-                    m_Snap.meas[i] = IVIM_FOO;
-                }
-            }
-        }
-        else
-        {
-            // measurement vector
-            for(int i = 0; i < m_Snap.N; ++i)
-            {
-                b0 = measvec[m_Snap.baselineind[i]];
-
-                m_Snap.allmeas[i] = measvec[m_Snap.gradientind[i]] / (b0+.0001);
-
-                if(measvec[m_Snap.gradientind[i]] > m_S0Thres)
-                {
-                    m_Snap.meas[i] = measvec[m_Snap.gradientind[i]] / (b0+.0001);
-                }
-                else
-                {
-                    m_Snap.meas[i] = IVIM_FOO;
-                }
-            }
-        }
+        this->NormalizeMeasurements(measvec, m_Snap.meas, m_Snap.allmeas);
 
         m_Snap.currentF = 0;
         m_Snap.currentD = 0;
@@ -372,31 +661,7 @@ void DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, TOut>
                 m_Snap.meas2 = input2.meas;
                 if (input2.N < 2) break;
 
-                IVIM_dstar_only f_dstar_only(input2.N,m_Snap.currentD,m_Snap.currentF);
-                f_dstar_only.set_bvalues(input2.bvals);
-                f_dstar_only.set_measurements(input2.meas);
-
-                vnl_vector< double > x_dstar_only(1);
-                vnl_vector< double > fx_dstar_only(input2.N);
-
-                double opt = 1111111111111111.0;
-                int opt_idx = -1;
-                int num_its = 100;
-                double min_val = .001;
-                double max_val = .15;
-                for(int i=0; i<num_its; i++)
-                {
-                    x_dstar_only[0] = min_val + i * ((max_val-min_val) / num_its);
-                    f_dstar_only.f(x_dstar_only, fx_dstar_only);
-                    double err = fx_dstar_only.two_norm();
-                    if(err<opt)
-                    {
-                        opt = err;
-                        opt_idx = i;
-                    }
-                }
-
-                m_Snap.currentDStar = min_val + opt_idx * ((max_val-min_val) / num_its);
+                m_Snap.currentDStar = this->SearchDStar(input2, m_Snap.currentD, m_Snap.currentF);
                 //          IVIM_fixd f_fixd(input2.N,m_Snap.currentD);
                 //          f_fixd.set_bvalues(input2.bvals);
                 //          f_fixd.set_measurements(input2.meas);
@@ -550,31 +815,7 @@ void DiffusionIntravoxelIncoherentMotionReconstructionImageFilter<TIn, TOut>
                 m_Snap.meas2 = input2.meas;
                 if (input2.N < 2) break;
 
-                IVIM_dstar_only f_dstar_only(input2.N,m_Snap.currentD,m_Snap.currentF);
-                f_dstar_only.set_bvalues(input2.bvals);
-                f_dstar_only.set_measurements(input2.meas);
-
-                vnl_vector< double > x_dstar_only(1);
-                vnl_vector< double > fx_dstar_only(input2.N);
-
-                double opt = 1111111111111111.0;
-                int opt_idx = -1;
-                int num_its = 100;
-                double min_val = .001;
-                double max_val = .15;
-                for(int i=0; i<num_its; i++)
-                {
-                    x_dstar_only[0] = min_val + i * ((max_val-min_val) / num_its);
-                    f_dstar_only.f(x_dstar_only, fx_dstar_only);
-                    double err = fx_dstar_only.two_norm();
-                    if(err<opt)
-                    {
-                        opt = err;
-                        opt_idx = i;
-                    }
-                }
-
-                m_Snap.currentDStar = min_val + opt_idx * ((max_val-min_val) / num_its);
+                m_Snap.currentDStar = this->SearchDStar(input2, m_Snap.currentD, m_Snap.currentF);
             }
             // MITK_INFO << "choosing " << opt_idx << " => " << DStar;
             //          x_dstar_only[0] = 0.01;
@@ -30,6 +30,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vnl/algo/vnl_levenberg_marquardt.h"
 #include "vnl/vnl_math.h"
 
+#include <cmath>
+#include <vector>
+
 #define IVIM_CEIL(val,u,o) (val) =       \
   ( (val) < (u) ) ? ( (u) ) : ( ( (val)>(o) ) ? ( (o) ) : ( (val) ) );
 
@@ -190,6 +193,107 @@ namespace itk{
     double fixF;
   };
 
+  /** baseclass of the IVIM models for BatchedLevenbergMarquardt */
+  template< class TValue >
+  struct IVIM_batched_base
+  {
+    typedef TValue ValueType;
+
+    unsigned int GetNumberOfMeasurements() const { return bvalues.size(); }
+
+    std::vector<TValue> bvalues;
+  };
+
+  /** batched version of IVIM_3param, x = (f, D, DStar) */
+  template< class TValue >
+  struct IVIM_3param_batched : public IVIM_batched_base<TValue>
+  {
+    static const unsigned int NumberOfParameters = 3;
+    static const unsigned int NumberOfValues = 3;
+
+    TValue Tabulate(unsigned int s, const TValue* x) const
+    {
+      const TValue b = this->bvalues[s];
+      return (1-x[0])*std::exp(-b*x[1]) + x[0]*std::exp(-b*(x[1]+x[2]));
+    }
+
+    TValue Residual(unsigned int s, TValue measurement, const TValue* x) const
+    {
+      return Tabulate(s, x) - measurement;
+    }
+
+    TValue Residual(unsigned int s, TValue measurement, const TValue* x, TValue* derivatives) const
+    {
+      const TValue b = this->bvalues[s];
+      const TValue e1 = std::exp(-b*x[1]);
+      const TValue e2 = std::exp(-b*(x[1]+x[2]));
+      derivatives[0] = e2 - e1;
+      derivatives[1] = -b*((1-x[0])*e1 + x[0]*e2);
+      derivatives[2] = -b*x[0]*e2;
+      return (1-x[0])*e1 + x[0]*e2 - measurement;
+    }
+  };
+
+  /** batched version of IVIM_fixdstar, x = (f, D) */
+  template< class TValue >
+  struct IVIM_fixdstar_batched : public IVIM_batched_base<TValue>
+  {
+    static const unsigned int NumberOfParameters = 2;
+    static const unsigned int NumberOfValues = 2;
+
+    IVIM_fixdstar_batched(TValue DStar) : fixDStar(DStar) {}
+
+    TValue Tabulate(unsigned int s, const TValue* x) const
+    {
+      const TValue b = this->bvalues[s];
+      return (1-x[0])*std::exp(-b*x[1]) + x[0]*std::exp(-b*(x[1]+fixDStar));
+    }
+
+    TValue Residual(unsigned int s, TValue measurement, const TValue* x) const
+    {
+      return Tabulate(s, x) - measurement;
+    }
+
+    TValue Residual(unsigned int s, TValue measurement, const TValue* x, TValue* derivatives) const
+    {
+      const TValue b = this->bvalues[s];
+      const TValue e1 = std::exp(-b*x[1]);
+      const TValue e2 = std::exp(-b*(x[1]+fixDStar));
+      derivatives[0] = e2 - e1;
+      derivatives[1] = -b*((1-x[0])*e1 + x[0]*e2);
+      return (1-x[0])*e1 + x[0]*e2 - measurement;
+    }
+
+    TValue fixDStar;
+  };
+
+  /** batched version of IVIM_d_and_f, x = (D, f) */
+  template< class TValue >
+  struct IVIM_d_and_f_batched : public IVIM_batched_base<TValue>
+  {
+    static const unsigned int NumberOfParameters = 2;
+    static const unsigned int NumberOfValues = 2;
+
+    TValue Tabulate(unsigned int s, const TValue* x) const
+    {
+      return (1-x[1])*std::exp(-this->bvalues[s]*x[0]);
+    }
+
+    TValue Residual(unsigned int s, TValue measurement, const TValue* x) const
+    {
+      return Tabulate(s, x) - measurement;
+    }
+
+    TValue Residual(unsigned int s, TValue measurement, const TValue* x, TValue* derivatives) const
+    {
+      const TValue b = this->bvalues[s];
+      const TValue e = std::exp(-b*x[0]);
+      derivatives[0] = -b*(1-x[1])*e;
+      derivatives[1] = -e;
+      return (1-x[1])*e - measurement;
+    }
+  };
+
   struct MeasAndBvals
   {
     vnl_vector<double> meas;
@@ -303,6 +407,18 @@ namespace itk{
     void SetCrossPosition(typename InputImageType::IndexType crosspos){this->m_CrossPosition = crosspos;}
     void SetMethod(IVIM_Method method){m_Method = method;}
 
+    /** Fit blocks of voxels with BatchedLevenbergMarquardt instead of one vnl_levenberg_marquardt
+     * per voxel (default: on). Only used by IVIM_FIT_ALL, IVIM_DSTAR_FIX and IVIM_D_THEN_DSTAR. */
+    void SetUseBatchedFitting(bool batched){m_UseBatchedFitting = batched;}
+    bool GetUseBatchedFitting() const {return m_UseBatchedFitting;}
+
+    /** Run the batched fit in single instead of double precision (default: off) */
+    void SetUseSinglePrecisionFitting(bool single){m_UseSinglePrecisionFitting = single;}
+    bool GetUseSinglePrecisionFitting() const {return m_UseSinglePrecisionFitting;}
+
+    /** Number of voxels fitted together by the batched fit */
+    static const unsigned int BlockSize = 256;
+
     IVIMSnapshot GetSnapshot(){return m_Snap;}
 
     /** Return the gradient direction. idx is 0 based */
@@ -327,10 +443,24 @@ namespace itk{
 
     MeasAndBvals ApplyS0Threshold(vnl_vector<double> &meas, vnl_vector<double> &bvals);
 
+    /** Fit blocks of BlockSize voxels at once, see SetUseBatchedFitting() */
+    template< class TValue >
+    void BatchedThreadedGenerateData( const OutputImageRegionType &outputRegionForThread );
+
+    template< class TModel >
+    void BatchedFit( const TModel &model, const std::vector<typename TModel::ValueType> &grid,
+                     const OutputImageRegionType &outputRegionForThread );
+
   private:
 
     double myround(double number);
 
+    /** Divide the diffusion weighted measurements by their b0, thresholded measurements are set to IVIM_FOO in meas */
+    void NormalizeMeasurements(const typename InputImageType::PixelType &measvec, vnl_vector<double> &meas, vnl_vector<double> &allmeas) const;
+
+    /** Grid search for DStar with fixed D and f */
+    double SearchDStar(const MeasAndBvals &input, double D, double f) const;
+
     /** container to hold gradient directions */
     GradientDirectionContainerType::Pointer           m_GradientDirectionContainer;
 
@@ -369,6 +499,10 @@ namespace itk{
 
     typename InputImageType::IndexType m_CrossPosition;
 
+    bool m_UseBatchedFitting;
+
+    bool m_UseSinglePrecisionFitting;
+
   };
 
 }
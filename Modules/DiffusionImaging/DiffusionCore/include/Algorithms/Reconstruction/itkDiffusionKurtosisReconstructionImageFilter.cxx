@@ -29,6 +29,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkComposeImageFilter.h>
 #include <itkDiscreteGaussianImageFilter.h>
 
+#include "itkBatchedLevenbergMarquardt.h"
+
 template< class TInputPixelType>
 static void FitSingleVoxel( const itk::VariableLengthVector< TInputPixelType > &input,
                             const vnl_vector<double>& bvalues,
@@ -128,7 +130,9 @@ itk::DiffusionKurtosisReconstructionImageFilter<TInputPixelType, TOutputPixelTyp
     m_SmoothingSigma(1.5),
     m_MaxFitBValue( 3000 ),
     m_UseKBounds( false ),
-    m_ScaleForFitting( STRAIGHT )
+    m_ScaleForFitting( STRAIGHT ),
+    m_UseBatchedFitting( true ),
+    m_UseSinglePrecisionFitting( false )
 {
   this->m_InitialPosition = vnl_vector<double>(3, 0);
   this->m_InitialPosition[2] = 1000.0; // S_0
@@ -416,6 +420,25 @@ template< class TInputPixelType, class TOutputPixelType>
 void itk::DiffusionKurtosisReconstructionImageFilter<TInputPixelType, TOutputPixelType>
 ::ThreadedGenerateData(const OutputImageRegionType &outputRegionForThread, ThreadIdType /*threadId*/)
 {
+  if( this->m_UseBatchedFitting )
+  {
+    if( this->m_UseSinglePrecisionFitting )
+    {
+      if( this->m_OmitBZero )
+        this->template BatchedThreadedGenerateData< float, true >( outputRegionForThread );
+      else
+        this->template BatchedThreadedGenerateData< float, false >( outputRegionForThread );
+    }
+    else
+    {
+      if( this->m_OmitBZero )
+        this->template BatchedThreadedGenerateData< double, true >( outputRegionForThread );
+      else
+        this->template BatchedThreadedGenerateData< double, false >( outputRegionForThread );
+    }
+    return;
+  }
+
   typename OutputImageType::Pointer dImage = static_cast< OutputImageType * >(this->ProcessObject::GetOutput(0));
   itk::ImageRegionIteratorWithIndex< OutputImageType > dImageIt(dImage, outputRegionForThread);
   dImageIt.GoToBegin();
@@ -483,4 +506,181 @@ void itk::DiffusionKurtosisReconstructionImageFilter<TInputPixelType, TOutputPix
 
 }
 
+template< class TInputPixelType, class TOutputPixelType>
+template< class TValue, bool VFitUnweighted >
+void itk::DiffusionKurtosisReconstructionImageFilter<TInputPixelType, TOutputPixelType>
+::BatchedThreadedGenerateData(const OutputImageRegionType &outputRegionForThread)
+{
+  typedef kurtosis_batched_model< TValue, VFitUnweighted > ModelType;
+
+  typename OutputImageType::Pointer dImage = static_cast< OutputImageType * >(this->ProcessObject::GetOutput(0));
+  itk::ImageRegionIterator< OutputImageType > dImageIt(dImage, outputRegionForThread);
+  dImageIt.GoToBegin();
+
+  typename OutputImageType::Pointer kImage = static_cast< OutputImageType * >(this->ProcessObject::GetOutput(1));
+  itk::ImageRegionIterator< OutputImageType > kImageIt(kImage, outputRegionForThread);
+  kImageIt.GoToBegin();
+
+  itk::ImageRegionConstIterator< InputImageType > inputIter( m_ProcessedInputImage, outputRegionForThread );
+  inputIter.GoToBegin();
+
+  itk::ImageRegionConstIterator< MaskImageType > maskIter( this->m_MaskImage, outputRegionForThread );
+  maskIter.GoToBegin();
+
+  const bool logscale = static_cast<bool>( this->m_ScaleForFitting );
+
+  // select the measurements used in fitting like FitSingleVoxel does
+  ModelType model;
+  std::vector< unsigned int > fitIndices;
+  std::vector< unsigned int > unweightedIndices;
+  for( unsigned int i=0; i<this->m_BValues.size(); ++i )
+  {
+    const bool unweighted = this->m_BValues[i] < vnl_math::eps;
+    if( unweighted )
+      unweightedIndices.push_back( i );
+
+    if( !( VFitUnweighted && unweighted ) )
+    {
+      fitIndices.push_back( i );
+      model.bvalues.push_back( this->m_BValues[i] );
+    }
+  }
+  const unsigned int numberOfMeasurements = fitIndices.size();
+
+  model.set_fit_logscale( logscale );
+  if( this->m_UseKBounds )
+  {
+    model.set_K_bounds( this->m_KurtosisBounds );
+  }
+
+  // coarse grid of start values for ( D, K ), without the points inside the penalty margins of the bounds
+  const double dGrid[] = { 0.0003, 0.0006, 0.001, 0.0015, 0.002, 0.0028 };
+  const double kGrid[] = { 0, 0.5, 1, 1.5, 2, 3 };
+  std::vector< TValue > grid;
+  grid.push_back( this->m_InitialPosition[0] );
+  grid.push_back( this->m_InitialPosition[1] );
+  for( double D : dGrid )
+  {
+    for( double K : kGrid )
+    {
+      const double margin = 0.05 * ( this->m_KurtosisBounds[1] - this->m_KurtosisBounds[0] );
+      if( this->m_UseKBounds && ( K < this->m_KurtosisBounds[0] + margin || K > this->m_KurtosisBounds[1] - margin ) )
+        continue;
+
+      grid.push_back( D );
+      grid.push_back( K );
+    }
+  }
+
+  BatchedLevenbergMarquardt< ModelType > fitter( model, BlockSize );
+  fitter.SetGrid( grid, 2 );
+
+  // per block buffers, the fitted voxels are stored in structure-of-arrays layout
+  std::vector< TValue > gathered( numberOfMeasurements * BlockSize );
+  std::vector< TValue > reference( BlockSize );
+  std::vector< TValue > measurements( numberOfMeasurements * BlockSize );
+  std::vector< TValue > normalized( numberOfMeasurements * BlockSize );
+  std::vector< TValue > values( ModelType::NumberOfValues * BlockSize );
+  std::vector< unsigned int > fitted( BlockSize );
+  std::vector< double > D( BlockSize );
+  std::vector< double > K( BlockSize );
+
+  while( !inputIter.IsAtEnd() )
+  {
+    unsigned int numberOfVoxels = 0;
+    unsigned int numberOfFitted = 0;
+    for( ; numberOfVoxels < BlockSize && !inputIter.IsAtEnd(); ++numberOfVoxels, ++inputIter, ++maskIter )
+    {
+      const unsigned int v = numberOfVoxels;
+      D[v] = 0;
+      K[v] = 0;
+      if( maskIter.Get() <= 0 )
+        continue;
+
+      // voxels that are not fitted keep the initial position
+      D[v] = this->m_InitialPosition[0];
+      K[v] = this->m_InitialPosition[1];
+
+      const itk::VariableLengthVector< TInputPixelType > input = inputIter.Get();
+      bool skip = false;
+      TValue* row = &gathered[ numberOfFitted * numberOfMeasurements ];
+      for( unsigned int i=0; i<numberOfMeasurements; ++i )
+      {
+        row[i] = input.GetElement( fitIndices[i] );
+
+        // the logscale fit is skipped for measurements that would produce NaN values
+        if( logscale && row[i] < vnl_math::eps )
+          skip = true;
+      }
+      if( skip || numberOfMeasurements == 0 )
+        continue;
+
+      // S_0: the first measurement or the start value of the fit, which is estimated from the unweighted measurements
+      TValue s0 = this->m_InitialPosition.size() > 2 ? this->m_InitialPosition[2] : 1;
+      if( !VFitUnweighted )
+      {
+        s0 = row[0];
+      }
+      else if( !unweightedIndices.empty() )
+      {
+        TValue mean = 0;
+        for( unsigned int i=0; i<unweightedIndices.size(); ++i )
+          mean += input.GetElement( unweightedIndices[i] );
+        mean /= unweightedIndices.size();
+
+        if( mean > vnl_math::eps )
+          s0 = mean;
+      }
+
+      reference[ numberOfFitted ] = s0;
+      fitted[ numberOfFitted++ ] = v;
+    }
+
+    for( unsigned int i=0; i<numberOfMeasurements; ++i )
+    {
+      for( unsigned int j=0; j<numberOfFitted; ++j )
+      {
+        const TValue m = gathered[ j * numberOfMeasurements + i ];
+        const TValue s0 = reference[j];
+        if( logscale )
+        {
+          measurements[ i * numberOfFitted + j ] = std::log( m );
+          normalized[ i * numberOfFitted + j ] = s0 > 0 ? std::log( m / s0 ) : std::log( m );
+        }
+        else
+        {
+          measurements[ i * numberOfFitted + j ] = m;
+          normalized[ i * numberOfFitted + j ] = std::abs( s0 ) > vnl_math::eps ? m / s0 : m;
+        }
+      }
+    }
+
+    for( unsigned int j=0; j<numberOfFitted; ++j )
+    {
+      values[ j ] = this->m_InitialPosition[0];
+      values[ numberOfFitted + j ] = this->m_InitialPosition[1];
+      values[ 2 * numberOfFitted + j ] = reference[j];
+    }
+
+    fitter.SearchGrid( normalized.data(), nullptr, numberOfFitted, values.data() );
+    fitter.Fit( measurements.data(), nullptr, numberOfFitted, values.data() );
+
+    // regardless the fit type, the parameters are always in the first two values
+    for( unsigned int j=0; j<numberOfFitted; ++j )
+    {
+      D[ fitted[j] ] = values[ j ];
+      K[ fitted[j] ] = values[ numberOfFitted + j ];
+    }
+
+    for( unsigned int v=0; v<numberOfVoxels; ++v )
+    {
+      dImageIt.Set( D[v] );
+      kImageIt.Set( K[v] );
+
+      ++dImageIt;
+      ++kImageIt;
+    }
+  }
+}
+
 #endif // guards
@@ -26,6 +26,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vnl/algo/vnl_levenberg_marquardt.h>
 #include <vnl/vnl_least_squares_function.h>
 
+#include <cmath>
+#include <vector>
+
 namespace itk
 {
 
@@ -214,6 +217,142 @@ namespace itk
     }
   };
 
+  /** @struct kurtosis_batched_model
+      @brief The cost functions of kurtosis_fit_lsq_function and kurtosis_fit_omit_unweighted with closed-form derivatives,
+      for fitting blocks of voxels with BatchedLevenbergMarquardt
+
+      The values are x = ( D, K, S_0 ). S_0 is fitted if VFitUnweighted is set (kurtosis_fit_omit_unweighted), otherwise
+      it holds the first measurement of the voxel. In logscale, the measurements have to be passed logarithmized.
+      The tabulated signal used for the grid search is exp( -b * D + b^2 * D^2 * K / 6 ) (or its logarithm), i.e. the
+      signal normalized by S_0.
+      */
+  template< class TValue, bool VFitUnweighted >
+  struct kurtosis_batched_model
+  {
+    typedef TValue ValueType;
+
+    static const unsigned int NumberOfParameters = VFitUnweighted ? 3 : 2;
+    static const unsigned int NumberOfValues = 3;
+
+    kurtosis_batched_model()
+      : m_use_bounds(false),
+        m_use_logscale(false)
+    {}
+
+    void set_fit_logscale( bool flag )
+    {
+      this->m_use_logscale = flag;
+    }
+
+    /** same bounds as kurtosis_fit_lsq_function::set_K_bounds */
+    void set_K_bounds( const vnl_vector_fixed<double, 2> k_bounds )
+    {
+      m_use_bounds = true;
+
+      kurtosis_lower_bounds[0] = 0;
+      kurtosis_upper_bounds[0] = 4e-3;
+      kurtosis_lower_bounds[1] = k_bounds[0];
+      kurtosis_upper_bounds[1] = k_bounds[1];
+    }
+
+    unsigned int GetNumberOfMeasurements() const
+    {
+      return bvalues.size();
+    }
+
+    TValue Tabulate( unsigned int s, const TValue* x ) const
+    {
+      const TValue b = bvalues[s];
+      const TValue quotient = -b * x[0] + b*b * x[0] * x[0] * x[1] / 6;
+      return m_use_logscale ? quotient : std::exp( quotient );
+    }
+
+    TValue Residual( unsigned int s, TValue measurement, const TValue* x ) const
+    {
+      const TValue factor = measurement - M( x, Tabulate( s, x ) );
+      return factor * factor + penalty_term( x, nullptr );
+    }
+
+    TValue Residual( unsigned int s, TValue measurement, const TValue* x, TValue* derivatives ) const
+    {
+      const TValue b = bvalues[s];
+      const TValue diff = Tabulate( s, x );
+      const TValue model = M( x, diff );
+      const TValue factor = measurement - model;
+
+      // derivatives of the diffusion term quotient and of M
+      const TValue dq_dD = -b + b*b * x[0] * x[1] / 3;
+      const TValue dq_dK = b*b * x[0] * x[0] / 6;
+      const TValue scale = m_use_logscale ? 1 : model;
+
+      TValue penalty_derivatives[2];
+      const TValue penalty = penalty_term( x, penalty_derivatives );
+
+      derivatives[0] = -2 * factor * scale * dq_dD + penalty_derivatives[0];
+      derivatives[1] = -2 * factor * scale * dq_dK + penalty_derivatives[1];
+      if( VFitUnweighted )
+      {
+        derivatives[NumberOfParameters-1] = -2 * factor * ( m_use_logscale ? 1 / x[2] : diff );
+      }
+
+      return factor * factor + penalty;
+    }
+
+    std::vector<TValue> bvalues;
+
+  protected:
+
+    TValue M( const TValue* x, TValue diff ) const
+    {
+      if( m_use_logscale )
+        return std::log( x[2] ) + diff;
+      else
+        return x[2] * diff;
+    }
+
+    /** kurtosis_fit_lsq_function::penalty_term, also returns the derivatives if requested */
+    TValue penalty_term( const TValue* x, TValue* derivatives ) const
+    {
+      TValue penalty = 0;
+      if( derivatives )
+      {
+        derivatives[0] = derivatives[1] = 0;
+      }
+
+      if( !m_use_bounds )
+        return penalty;
+
+      for( unsigned int i=0; i< 2; i++)
+      {
+        const TValue penalty_boundary = 0.02 * (kurtosis_upper_bounds[i] - kurtosis_lower_bounds[i]);
+
+        if( x[i] < kurtosis_lower_bounds[i] + penalty_boundary )
+        {
+          const TValue term = 1e6 * std::exp( -1 * ( x[i] - kurtosis_lower_bounds[i]) / penalty_boundary );
+          penalty += term;
+          if( derivatives )
+            derivatives[i] = -term / penalty_boundary;
+        }
+        else if ( x[i] > kurtosis_upper_bounds[i] - penalty_boundary )
+        {
+          const TValue term = 1e6 * std::exp( -1 * ( kurtosis_upper_bounds[i] - x[i]) / penalty_boundary );
+          penalty += term;
+          if( derivatives )
+            derivatives[i] = term / penalty_boundary;
+        }
+      }
+
+      return penalty;
+    }
+
+    bool m_use_bounds;
+
+    bool m_use_logscale;
+
+    TValue kurtosis_upper_bounds[2];
+    TValue kurtosis_lower_bounds[2];
+  };
+
   enum FitScale
   {
     STRAIGHT = 0,
@@ -388,6 +527,21 @@ public:
     m_ScaleForFitting = scale;
   }
 
+  /** Fit blocks of voxels with BatchedLevenbergMarquardt instead of one vnl_levenberg_marquardt per voxel ( default = on ) */
+  void SetUseBatchedFitting( bool flag )
+  {
+    m_UseBatchedFitting = flag;
+  }
+
+  /** Run the batched fit in single instead of double precision ( default = off ) */
+  void SetUseSinglePrecisionFitting( bool flag )
+  {
+    m_UseSinglePrecisionFitting = flag;
+  }
+
+  /** Number of voxels fitted together by the batched fit */
+  static const unsigned int BlockSize = 256;
+
 protected:
   DiffusionKurtosisReconstructionImageFilter();
   virtual ~DiffusionKurtosisReconstructionImageFilter() {}
@@ -400,6 +554,10 @@ protected:
 
   void ThreadedGenerateData(const OutputImageRegionType &outputRegionForThread, ThreadIdType threadId) override;
 
+  /** Fit blocks of BlockSize voxels at once, see SetUseBatchedFitting */
+  template< class TValue, bool VFitUnweighted >
+  void BatchedThreadedGenerateData(const OutputImageRegionType &outputRegionForThread);
+
   double m_ReferenceBValue;
 
   vnl_vector<double> m_BValues;
@@ -423,6 +581,9 @@ protected:
 
   FitScale m_ScaleForFitting;
 
+  bool m_UseBatchedFitting;
+  bool m_UseSinglePrecisionFitting;
+
 private:
 
 
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkDiffusionMultiShellQballReconstructionImageFilter.h>
 
 #include <itkTimeProbe.h>
+#include <vnl/vnl_vector_ref.h>
 #include <itkPointShell.h>
 #include <mitkDiffusionFunctionCollection.h>
 
@@ -47,7 +48,8 @@ DiffusionMultiShellQballReconstructionImageFilter<T,TG,TO,L,NODF>
   m_BValue(1.0),
   m_Lambda(0.0),
   m_IsHemisphericalArrangementOfGradientDirections(false),
-  m_IsArithmeticProgession(false)
+  m_IsArithmeticProgession(false),
+  m_UseBlockedReconstruction(true)
 {
   // At least 1 inputs is necessary for a vector image.
   // For images added one at a time we need at least six
@@ -589,7 +591,10 @@ void DiffusionMultiShellQballReconstructionImageFilter<T,TG,TO,L,NODF>
   switch(m_ReconstructionType)
   {
   case Mode_Standard1Shell:
-    StandardOneShellReconstruction(outputRegionForThread);
+    if (m_UseBlockedReconstruction)
+      BlockedStandardOneShellReconstruction(outputRegionForThread);
+    else
+      StandardOneShellReconstruction(outputRegionForThread);
     break;
   case Mode_Analytical3Shells:
     AnalyticalThreeShellReconstruction(outputRegionForThread);
@@ -684,6 +689,103 @@ void DiffusionMultiShellQballReconstructionImageFilter<T,TG,TO,L,NODF>
   MITK_INFO << "One Thread finished reconstruction";
 }
 
+template< class T, class TG, class TO, int L, int NODF>
+void DiffusionMultiShellQballReconstructionImageFilter<T,TG,TO,L,NODF>
+::BlockedStandardOneShellReconstruction(const OutputImageRegionType& outputRegionForThread)
+{
+  typename OdfImageType::Pointer outputImage = static_cast< OdfImageType * >(ProcessObject::GetPrimaryOutput());
+  typename GradientImagesType::Pointer gradientImagePointer = static_cast< GradientImagesType * >( ProcessObject::GetInput(0) );
+
+  ImageRegionIterator< OdfImageType > oit(outputImage, outputRegionForThread);
+  oit.GoToBegin();
+
+  ImageRegionIterator< BZeroImageType > bzeroIterator(m_BZeroImage, outputRegionForThread);
+  bzeroIterator.GoToBegin();
+
+  typedef ImageRegionConstIterator< GradientImagesType > GradientIteratorType;
+  GradientIteratorType git(gradientImagePointer, outputRegionForThread );
+  git.GoToBegin();
+
+  BValueMapIteraotr it = m_BValueMap.begin();
+  it++; // skip b0 entry
+  IndiciesVector SignalIndicies = it->second;
+  IndiciesVector BZeroIndicies = m_BValueMap[0];
+
+  const unsigned int NumbersOfGradientIndicies = SignalIndicies.size();
+  const unsigned int NumberOfCoeffs = m_CoeffReconstructionMatrix->rows();
+  const unsigned int b0size = BZeroIndicies.size();
+
+  typedef typename GradientImagesType::PixelType         GradientVectorType;
+
+  // one row per voxel above threshold, allocated once per thread
+  std::vector<double> signals(BlockSize * NumbersOfGradientIndicies);
+  std::vector<double> coeffs(BlockSize * NumberOfCoeffs);
+  std::vector<double> odfs(BlockSize * NODF);
+  std::vector<bool> reconstructed(BlockSize);
+
+  while( ! git.IsAtEnd() )
+  {
+    // gather the normalized signals of the next block of voxels
+    unsigned int numberOfVoxels = 0;
+    unsigned int numberOfSignals = 0;
+    for( ; numberOfVoxels<BlockSize && !git.IsAtEnd(); ++numberOfVoxels, ++git )
+    {
+      GradientVectorType b = git.Get();
+
+      double b0average = 0;
+      for(unsigned int i = 0; i < b0size ; ++i)
+      {
+        b0average += b[BZeroIndicies[i]];
+      }
+      b0average /= b0size;
+      bzeroIterator.Set(b0average);
+      ++bzeroIterator;
+
+      reconstructed[numberOfVoxels] = (b0average != 0) && (b0average >= m_Threshold);
+      if( reconstructed[numberOfVoxels] )
+      {
+        vnl_vector_ref<double> SignalVector(NumbersOfGradientIndicies, &signals[numberOfSignals * NumbersOfGradientIndicies]);
+        for( unsigned int i = 0; i< NumbersOfGradientIndicies; i++ )
+        {
+          SignalVector[i] = static_cast<double>(b[SignalIndicies[i]]);
+        }
+
+        S_S0Normalization(SignalVector, b0average);
+        Projection1(SignalVector);
+        DoubleLogarithm(SignalVector);
+        ++numberOfSignals;
+      }
+    }
+
+    // approximate ODF coeffs and ODFs of the whole block
+    BlockedMatrixProduct(m_CoeffReconstructionMatrixTransposed, signals.data(), numberOfSignals, coeffs.data());
+    for( unsigned int s = 0; s < numberOfSignals; ++s )
+    {
+      coeffs[s * NumberOfCoeffs] = 1.0/(2.0*sqrt(M_PI));
+    }
+    BlockedMatrixProduct(m_ODFSphericalHarmonicBasisMatrixTransposed, coeffs.data(), numberOfSignals, odfs.data());
+
+    // scatter the ODFs to the output
+    unsigned int signalIndex = 0;
+    for( unsigned int v = 0; v < numberOfVoxels; ++v )
+    {
+      OdfPixelType odf(0.0);
+      if( reconstructed[v] )
+      {
+        const double* values = &odfs[signalIndex * NODF];
+        for( int i = 0; i < NODF; ++i )
+        {
+          odf[i] = static_cast<TO>(values[i]);
+        }
+        odf *= (M_PI*4/NODF);
+        ++signalIndex;
+      }
+      oit.Set( odf );
+      ++oit;
+    }
+  }
+}
+
 //#include "itkLevenbergMarquardtOptimizer.h"
 
 template< class T, class TG, class TO, int L, int NODF>
@@ -1065,6 +1167,9 @@ void DiffusionMultiShellQballReconstructionImageFilter<T,TG,TO,L,NOdfDirections>
   MatrixDoublePtr tempPtr (new vnl_matrix<double>( U->as_matrix() ));
   m_ODFSphericalHarmonicBasisMatrix  = new vnl_matrix<double>(NOdfDirections,NumberOfCoeffs);
   ComputeSphericalHarmonicsBasis(tempPtr.get(), m_ODFSphericalHarmonicBasisMatrix, LOrder);
+
+  m_CoeffReconstructionMatrixTransposed = m_CoeffReconstructionMatrix->transpose();
+  m_ODFSphericalHarmonicBasisMatrixTransposed = m_ODFSphericalHarmonicBasisMatrix->transpose();
 }
 
 template< class T, class TG, class TO, int L, int NOdfDirections>
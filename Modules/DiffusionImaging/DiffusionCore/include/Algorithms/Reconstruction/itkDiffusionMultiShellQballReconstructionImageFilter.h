@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define __itkDiffusionMultiShellQballReconstructionImageFilter_h_
 
 #include <itkImageToImageFilter.h>
+#include "itkBlockedMatrixProduct.h"
 
 namespace itk{
 /** \class DiffusionMultiShellQballReconstructionImageFilter
@@ -107,6 +108,12 @@ public:
     itkSetMacro( Lambda, double )
     itkGetMacro( Lambda, double )
 
+    /** Reconstruct blocks of voxels with one matrix product each (single shell only, on by default).
+     * The results equal the voxelwise reconstruction up to rounding. */
+    itkSetMacro( UseBlockedReconstruction, bool )
+    itkGetMacro( UseBlockedReconstruction, bool )
+    itkBooleanMacro( UseBlockedReconstruction )
+
 protected:
     DiffusionMultiShellQballReconstructionImageFilter();
     ~DiffusionMultiShellQballReconstructionImageFilter() { }
@@ -139,6 +146,15 @@ private:
     vnl_matrix< double > * m_CoeffReconstructionMatrix;
     vnl_matrix< double > * m_ODFSphericalHarmonicBasisMatrix;
 
+    /** Transposed matrices for BlockedMatrixProduct */
+    vnl_matrix< double > m_CoeffReconstructionMatrixTransposed;
+    vnl_matrix< double > m_ODFSphericalHarmonicBasisMatrixTransposed;
+
+    bool m_UseBlockedReconstruction;
+
+    /** Number of voxels reconstructed at once if m_UseBlockedReconstruction */
+    static const unsigned int BlockSize = 256;
+
     /** container to hold gradient directions */
     GradientDirectionContainerType::Pointer m_GradientDirectionContainer;
 
@@ -179,6 +195,7 @@ private:
     void Projection2( vnl_vector<double> & E1, vnl_vector<double> & E2, vnl_vector<double> & E3, double delta = 0.01);
     void Projection3( vnl_vector<double> & A, vnl_vector<double> & alpha, vnl_vector<double> & beta, double delta = 0.01);
     void StandardOneShellReconstruction(const OutputImageRegionType& outputRegionForThread);
+    void BlockedStandardOneShellReconstruction(const OutputImageRegionType& outputRegionForThread);
     void AnalyticalThreeShellReconstruction(const OutputImageRegionType& outputRegionForThread);
     void NumericalNShellReconstruction(const OutputImageRegionType& outputRegionForThread);
     void GenerateAveragedBZeroImage(const OutputImageRegionType& outputRegionForThread);
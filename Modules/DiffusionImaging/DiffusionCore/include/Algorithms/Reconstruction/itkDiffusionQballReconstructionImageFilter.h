@@ -24,6 +24,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vnl/algo/vnl_svd.h"
 #include "itkVectorContainer.h"
 #include "itkVectorImage.h"
+#include "itkBlockedMatrixProduct.h"
 
 namespace itk{
 /** \class DiffusionQballReconstructionImageFilter
@@ -76,6 +77,10 @@ namespace itk{
  * \li BasisFunctionCenters - the centers of the basis functions are used for
  * the sRBF (spherical radial basis functions interpolation). If not set, they
  * will be defaulted to equal m_EquatorNrSamplingPoints
+ * \li UseBlockedReconstruction - if the gradients are given in a single image,
+ * reconstruct blocks of voxels with one matrix product (see BlockedMatrixProduct)
+ * instead of one matrix-vector product per voxel. On by default, the results
+ * equal the voxelwise reconstruction up to rounding.
  *
  * \par Template parameters
  * The class is templated over
@@ -232,6 +237,9 @@ public:
   */
   vnl_vector<TOdfPixelType> PreNormalize( vnl_vector<TOdfPixelType> vec );
 
+  /** In-place version of PreNormalize for the signal of one voxel */
+  void PreNormalize( TOdfPixelType* signal, unsigned int size );
+
   /** Threshold on the reference image data. The output ODF will be a null
    * pdf for pixels in the reference image that have a value less than this
    * threshold. */
@@ -252,6 +260,11 @@ public:
 #endif
   itkGetConstReferenceMacro( BValue, TOdfPixelType);
 
+  /** Reconstruct blocks of voxels at once (only for gradients in a single image) */
+  itkSetMacro( UseBlockedReconstruction, bool );
+  itkGetMacro( UseBlockedReconstruction, bool );
+  itkBooleanMacro( UseBlockedReconstruction );
+
 #ifdef ITK_USE_CONCEPT_CHECKING
   /** Begin concept checking */
   itkConceptMacro(ReferenceEqualityComparableCheck,
@@ -284,6 +297,9 @@ protected:
   void ThreadedGenerateData( const
       OutputImageRegionType &outputRegionForThread, ThreadIdType);
 
+  /** Number of voxels reconstructed at once if m_UseBlockedReconstruction */
+  static const unsigned int BlockSize = 256;
+
   /** enum to indicate if the gradient image is specified as a single multi-
    * component image or as several separate images */
   typedef enum
@@ -329,6 +345,12 @@ private:
 
   /** Normalization method to be applied */
   Normalization                                     m_NormalizationMethod;
+
+  /** Reconstruct blocks of voxels with BlockedMatrixProduct */
+  bool                                              m_UseBlockedReconstruction;
+
+  /** Transposed m_ReconstructionMatrix for BlockedMatrixProduct */
+  vnl_matrix< TOdfPixelType >                       m_ReconstructionMatrixTransposed;
 };
 
 }
@@ -47,7 +47,8 @@ namespace itk {
     m_Threshold(NumericTraits< ReferencePixelType >::NonpositiveMin()),
     m_BValue(1.0),
     m_GradientImageTypeEnumeration(Else),
-    m_DirectionsDuplicated(false)
+    m_DirectionsDuplicated(false),
+    m_UseBlockedReconstruction(true)
   {
     // At least 1 inputs is necessary for a vector image.
     // For images added one at a time we need at least six
@@ -94,6 +95,7 @@ namespace itk {
     // Compute reconstruction matrix that is multiplied to the data-vector
     // each voxel in order to reconstruct the ODFs
     this->ComputeReconstructionMatrix();
+    m_ReconstructionMatrixTransposed = m_ReconstructionMatrix->transpose();
 
     // Allocate the b-zero image
     m_BZeroImage = BZeroImageType::New();
@@ -212,6 +214,23 @@ namespace itk {
     return vec;
   }
 
+  template< class TReferenceImagePixelType,
+  class TGradientImagePixelType,
+  class TOdfPixelType,
+    int NrOdfDirections,
+    int NrBasisFunctionCenters >
+    void itk::DiffusionQballReconstructionImageFilter<TReferenceImagePixelType, TGradientImagePixelType, TOdfPixelType, NrOdfDirections, NrBasisFunctionCenters>::PreNormalize( TOdfPixelType* signal, unsigned int size )
+  {
+    // only the log of the signal is computed before reconstruction, see the vnl_vector version
+    if( m_NormalizationMethod == QBR_B_ZERO_B_VALUE )
+    {
+      for(unsigned int i=0; i<size; i++)
+      {
+        signal[i] = log(signal[i]);
+      }
+    }
+  }
+
   template< class TReferenceImagePixelType,
   class TGradientImagePixelType,
   class TOdfPixelType,
@@ -364,8 +383,73 @@ namespace itk {
           gradientind.push_back(gradientind[i]);
       }
 
+      // Reconstruct blocks of voxels at once: gather the signals of the voxels
+      // above threshold, multiply them with the reconstruction matrix in one
+      // go and scatter the ODFs to the output
+      if( m_UseBlockedReconstruction )
+      {
+        typedef typename NumericTraits<ReferencePixelType>::AccumulateType B0Type;
+        std::vector<TOdfPixelType> signals(BlockSize * m_NumberOfGradientDirections);
+        std::vector<TOdfPixelType> odfs(BlockSize * NrOdfDirections);
+        std::vector<B0Type> b0s(BlockSize);
+        std::vector<bool> reconstructed(BlockSize);
+
+        while( !git.IsAtEnd() )
+        {
+          unsigned int numberOfVoxels = 0;
+          unsigned int numberOfSignals = 0;
+          for( ; numberOfVoxels<BlockSize && !git.IsAtEnd(); ++numberOfVoxels, ++git )
+          {
+            GradientVectorType b = git.Get();
+
+            B0Type b0 = NumericTraits<ReferencePixelType>::Zero;
+            for(unsigned int i = 0; i < baselineind.size(); ++i)
+            {
+              b0 += b[baselineind[i]];
+            }
+            b0 /= this->m_NumberOfBaselineImages;
+            b0s[numberOfVoxels] = b0;
+
+            reconstructed[numberOfVoxels] = (b0 != 0) && (b0 >= m_Threshold);
+            if( reconstructed[numberOfVoxels] )
+            {
+              TOdfPixelType* signal = &signals[numberOfSignals * m_NumberOfGradientDirections];
+              for( unsigned int i = 0; i< m_NumberOfGradientDirections; i++ )
+              {
+                signal[i] = static_cast<TOdfPixelType>(b[gradientind[i]]);
+              }
+              PreNormalize(signal, m_NumberOfGradientDirections);
+              ++numberOfSignals;
+            }
+          }
+
+          BlockedMatrixProduct(m_ReconstructionMatrixTransposed, signals.data(), numberOfSignals, odfs.data());
+
+          unsigned int signalIndex = 0;
+          for( unsigned int v = 0; v < numberOfVoxels; ++v )
+          {
+            OdfPixelType odf(0.0);
+            if( reconstructed[v] )
+            {
+              odf = &odfs[signalIndex * NrOdfDirections];
+              odf = Normalize(odf, b0s[v]);
+              ++signalIndex;
+            }
+
+            for (unsigned int i=0; i<odf.Size(); i++)
+                if (odf.GetElement(i)!=odf.GetElement(i))
+                    odf.Fill(0.0);
+
+            oit.Set( odf );
+            ++oit;
+            oit2.Set( b0s[v] );
+            ++oit2;
+          }
+        }
+      }
+
       // Following loop does the actual reconstruction work in each voxel
-      // (Tuch, Q-Ball Reconstruction [1])
+      // (Tuch, Q-Ball Reconstruction [1]), nothing left to do after the blocked reconstruction
       while( !git.IsAtEnd() )
       {
         // current vector of diffusion measurements
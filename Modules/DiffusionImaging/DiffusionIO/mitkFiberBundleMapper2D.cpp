@@ -98,7 +98,7 @@ void mitk::FiberBundleMapper2D::Update(mitk::BaseRenderer * renderer)
             fiberBundle->RequestUpdate2D();
         }
 
-        if ( localStorage->m_LastUpdateTime<renderer->GetCurrentWorldPlaneGeometryUpdateTime() || localStorage->m_LastUpdateTime<fiberBundle->GetUpdateTime2D() )
+        if ( localStorage->m_LastUpdateTime<renderer->GetCurrentWorldPlaneGeometryUpdateTime() || localStorage->m_LastUpdateTime<fiberBundle->GetUpdateTime2D() || localStorage->m_SliceThickness!=thickness )
         {
             this->UpdateShaderParameter(renderer);
             this->GenerateDataForRenderer( renderer );
@@ -141,11 +141,23 @@ void mitk::FiberBundleMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rend
     if ( node == NULL )
         return;
 
-    vtkSmartPointer<vtkPolyData> fiberPolyData = fiberBundle->GetFiberPolyData();
-    if (fiberPolyData == NULL)
-        return;
+    // the shader discards fragments outside of the slab |normal*x - w| <= thickness (with the same unnormalized
+    // normal), so only fibers with a bounding box in this slab are passed to the renderer
+    mitk::PlaneGeometry::ConstPointer planeGeo = renderer->GetSliceNavigationController()->GetCurrentPlaneGeometry();
+    float thickness = 2.0;
+    node->GetPropertyValue("Fiber2DSliceThickness", thickness);
+    double normal[3];
+    double offset = 0;
+    for (int c=0; c<3; c++)
+    {
+        normal[c] = planeGeo->GetNormal()[c];
+        offset += planeGeo->GetOrigin()[c]*normal[c];
+    }
+
+    std::vector< vtkIdType > fibers = fiberBundle->GetFiberBounds()->GetFibersNearPlane(normal, offset, thickness);
+    vtkSmartPointer<vtkPolyData> fiberPolyData = fiberBundle->GetFibers().CreatePolyData(fibers, fiberBundle->GetFiberColors());
+    localStorage->m_SliceThickness = thickness;
 
-    fiberPolyData->GetPointData()->AddArray(fiberBundle->GetFiberColors());
     localStorage->m_FiberMapper->ScalarVisibilityOn();
     localStorage->m_FiberMapper->SetScalarModeToUsePointFieldData();
     localStorage->m_FiberMapper->SetLookupTable(m_lut);  //apply the properties after the slice was set
@@ -195,4 +207,5 @@ mitk::FiberBundleMapper2D::FBXLocalStorage::FBXLocalStorage()
 {
     m_PointActor = vtkSmartPointer<vtkActor>::New();
     m_FiberMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+    m_SliceThickness = -1;
 }
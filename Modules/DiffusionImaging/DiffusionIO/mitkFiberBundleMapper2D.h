@@ -72,6 +72,8 @@ public:
         vtkSmartPointer<vtkPolyDataMapper> m_FiberMapper;
         vtkSmartPointer<vtkPlane> m_SlicingPlane;  //needed later when optimized 2D mapper
         vtkSmartPointer<vtkPolyData> m_SlicedResult; //might be depricated in optimized 2D mapper
+        /** \brief Slice thickness the fibers were selected for. */
+        float m_SliceThickness;
 
         /** \brief Timestamp of last update of stored data. */
         itk::TimeStamp m_LastUpdateTime;
@@ -92,7 +94,7 @@ protected:
     FiberBundleMapper2D();
     virtual ~FiberBundleMapper2D();
 
-    /** Does the actual resampling, without rendering. */
+    /** Selects the fibers with a bounding box inside of the slab that is visible through the clipping shader, without rendering. */
     virtual void GenerateDataForRenderer(mitk::BaseRenderer*) override;
 
     void UpdateShaderParameter(mitk::BaseRenderer*);
@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkFiberBundleMapper3D.h"
 #include <mitkProperties.h>
+#include <mitkRenderingManager.h>
 
 #include <vtkPropAssembly.h>
 #include <vtkPointData.h>
@@ -28,6 +29,28 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkTubeFilter.h>
 #include <vtkRibbonFilter.h>
 #include <vtkLookupTable.h>
+#include <vtkMath.h>
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    /** Size of a pixel in mm at the center of the geometry. */
+    double GetPixelSize(mitk::BaseRenderer* renderer, const mitk::BaseGeometry* geometry)
+    {
+        vtkCamera* camera = renderer->GetVtkRenderer()->GetActiveCamera();
+        if (renderer->GetSizeY()<=0)
+            return 0;
+        if (camera->GetParallelProjection())
+            return 2*camera->GetParallelScale()/renderer->GetSizeY();
+
+        double position[3];
+        camera->GetPosition(position);
+        mitk::Point3D center = geometry->GetCenter();
+        double distance = std::sqrt(vtkMath::Distance2BetweenPoints(position, center.GetDataPointer()));
+        return 2*distance*std::tan(0.5*vtkMath::RadiansFromDegrees(camera->GetViewAngle()))/renderer->GetSizeY();
+    }
+}
 
 mitk::FiberBundleMapper3D::FiberBundleMapper3D()
     : m_TubeRadius(0.0)
@@ -61,45 +84,62 @@ void mitk::FiberBundleMapper3D::InternalGenerateData(mitk::BaseRenderer *rendere
     if (fiberBundle == NULL)
         return;
 
-    vtkSmartPointer<vtkPolyData> fiberPolyData = fiberBundle->GetFiberPolyData();
-    if (fiberPolyData == NULL)
-        return;
-
-    fiberPolyData->GetPointData()->AddArray(fiberBundle->GetFiberColors());
     float tmpopa;
     this->GetDataNode()->GetOpacity(tmpopa, NULL);
     FBXLocalStorage3D *localStorage = m_LocalStorageHandler.GetLocalStorage(renderer);
 
-    if (m_TubeRadius>0.0)
-    {
-        vtkSmartPointer<vtkTubeFilter> tubeFilter = vtkSmartPointer<vtkTubeFilter>::New();
-        tubeFilter->SetInputData(fiberPolyData);
-        tubeFilter->SetNumberOfSides(m_TubeSides);
-        tubeFilter->SetRadius(m_TubeRadius);
-        tubeFilter->Update();
-        fiberPolyData = tubeFilter->GetOutput();
-    }
-    else if (m_RibbonWidth>0.0)
-    {
-        vtkSmartPointer<vtkRibbonFilter> tubeFilter = vtkSmartPointer<vtkRibbonFilter>::New();
-        tubeFilter->SetInputData(fiberPolyData);
-        tubeFilter->SetWidth(m_RibbonWidth);
-        tubeFilter->Update();
-        fiberPolyData = tubeFilter->GetOutput();
-    }
-
-    if (tmpopa<1)
+    if (localStorage->m_NumberOfFibers>=0)
     {
-        vtkSmartPointer<vtkDepthSortPolyData> depthSort = vtkSmartPointer<vtkDepthSortPolyData>::New();
-        depthSort->SetInputData( fiberPolyData );
-        depthSort->SetCamera( renderer->GetVtkRenderer()->GetActiveCamera() );
-        depthSort->SetDirectionToFrontToBack();
-        depthSort->Update();
-        localStorage->m_FiberMapper->SetInputConnection(depthSort->GetOutputPort());
+        // interaction: plain lines of the prefix of the level
+        vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetLevelPolyData(renderer, localStorage->m_Level, localStorage->m_NumberOfFibers);
+        if (fiberPolyData == NULL)
+            return;
+        localStorage->m_FiberMapper->SetInputData(fiberPolyData);
     }
     else
     {
-        localStorage->m_FiberMapper->SetInputData(fiberPolyData);
+        if (localStorage->m_FinalPolyData==NULL || localStorage->m_FinalLevel!=localStorage->m_Level || localStorage->m_FinalUpdateTime<fiberBundle->GetUpdateTime3D())
+        {
+            vtkSmartPointer<vtkPolyData> fiberPolyData = this->GetLevelPolyData(renderer, localStorage->m_Level, -1);
+            if (fiberPolyData == NULL)
+                return;
+
+            if (m_TubeRadius>0.0)
+            {
+                vtkSmartPointer<vtkTubeFilter> tubeFilter = vtkSmartPointer<vtkTubeFilter>::New();
+                tubeFilter->SetInputData(fiberPolyData);
+                tubeFilter->SetNumberOfSides(m_TubeSides);
+                tubeFilter->SetRadius(m_TubeRadius);
+                tubeFilter->Update();
+                fiberPolyData = tubeFilter->GetOutput();
+            }
+            else if (m_RibbonWidth>0.0)
+            {
+                vtkSmartPointer<vtkRibbonFilter> tubeFilter = vtkSmartPointer<vtkRibbonFilter>::New();
+                tubeFilter->SetInputData(fiberPolyData);
+                tubeFilter->SetWidth(m_RibbonWidth);
+                tubeFilter->Update();
+                fiberPolyData = tubeFilter->GetOutput();
+            }
+
+            localStorage->m_FinalPolyData = fiberPolyData;
+            localStorage->m_FinalLevel = localStorage->m_Level;
+            localStorage->m_FinalUpdateTime.Modified();
+        }
+
+        if (tmpopa<1)
+        {
+            vtkSmartPointer<vtkDepthSortPolyData> depthSort = vtkSmartPointer<vtkDepthSortPolyData>::New();
+            depthSort->SetInputData( localStorage->m_FinalPolyData );
+            depthSort->SetCamera( renderer->GetVtkRenderer()->GetActiveCamera() );
+            depthSort->SetDirectionToFrontToBack();
+            depthSort->Update();
+            localStorage->m_FiberMapper->SetInputConnection(depthSort->GetOutputPort());
+        }
+        else
+        {
+            localStorage->m_FiberMapper->SetInputData(localStorage->m_FinalPolyData);
+        }
     }
 
     if (m_Lighting)
@@ -195,8 +235,43 @@ void mitk::FiberBundleMapper3D::GenerateDataForRenderer( mitk::BaseRenderer *ren
         fiberBundle->RequestUpdate3D();
     }
 
-    if (localStorage->m_LastUpdateTime>=fiberBundle->GetUpdateTime3D())
+    // choose the level of detail
+    int level = 0;
+    vtkIdType numberOfFibers = -1;
+    if (this->IsLODEnabled(renderer))
+    {
+        if (localStorage->m_LevelOfDetail==nullptr || localStorage->m_LastUpdateTime<fiberBundle->GetUpdateTime3D())
+        {
+            // fibers or colors changed
+            localStorage->m_LevelOfDetail = fiberBundle->GetLevelOfDetail();
+            localStorage->m_LevelColors.assign(localStorage->m_LevelOfDetail->GetNumberOfLevels(), vtkSmartPointer<vtkUnsignedCharArray>());
+            localStorage->m_FinalPolyData = NULL;
+        }
+
+        float pixelError = 0.5;
+        node->GetFloatProperty("lod.pixelerror", pixelError);
+        level = localStorage->m_LevelOfDetail->SelectLevel(pixelError*GetPixelSize(renderer, fiberBundle->GetGeometry()));
+
+        if (mitk::RenderingManager::GetInstance()->GetNextLOD(renderer)==0)
+        {
+            int interactivePoints = 1000000;
+            node->GetIntProperty("lod.interactivepoints", interactivePoints);
+            level = std::max(1, level);
+            numberOfFibers = localStorage->m_LevelOfDetail->GetNumberOfFibers(level, interactivePoints);
+        }
+    }
+    else if (localStorage->m_LevelOfDetail!=nullptr)
+    {
+        // the cached poly data may refer to the levels
+        localStorage->m_LevelOfDetail = nullptr;
+        localStorage->m_LevelColors.clear();
+        localStorage->m_FinalPolyData = NULL;
+    }
+
+    if (localStorage->m_LastUpdateTime>=fiberBundle->GetUpdateTime3D() && localStorage->m_Level==level && localStorage->m_NumberOfFibers==numberOfFibers)
         return;
+    localStorage->m_Level = level;
+    localStorage->m_NumberOfFibers = numberOfFibers;
 
     // Calculate time step of the input data for the specified renderer (integer value)
     // this method is implemented in mitkMapper
@@ -205,6 +280,37 @@ void mitk::FiberBundleMapper3D::GenerateDataForRenderer( mitk::BaseRenderer *ren
 }
 
 
+bool mitk::FiberBundleMapper3D::IsLODEnabled(mitk::BaseRenderer* renderer) const
+{
+    const mitk::FiberBundle* fiberBundle = dynamic_cast<const mitk::FiberBundle*>(GetDataNode()->GetData());
+    bool lod = false;
+    int interactivePoints = 1000000;
+    GetDataNode()->GetBoolProperty("lod.enable", lod, renderer);
+    GetDataNode()->GetIntProperty("lod.interactivepoints", interactivePoints, renderer);
+    return lod && fiberBundle!=NULL && fiberBundle->GetFibers().GetNumberOfPoints()>interactivePoints;
+}
+
+vtkSmartPointer<vtkPolyData> mitk::FiberBundleMapper3D::GetLevelPolyData(mitk::BaseRenderer *renderer, int level, vtkIdType numberOfFibers)
+{
+    mitk::FiberBundle* fiberBundle = dynamic_cast<mitk::FiberBundle*> (GetDataNode()->GetData());
+    FBXLocalStorage3D *localStorage = m_LocalStorageHandler.GetLocalStorage(renderer);
+
+    if (level==0)
+    {
+        vtkSmartPointer<vtkPolyData> fiberPolyData = fiberBundle->GetFiberPolyData();
+        if (fiberPolyData != NULL)
+            fiberPolyData->GetPointData()->AddArray(fiberBundle->GetFiberColors());
+        return fiberPolyData;
+    }
+
+    // the poly data refers to the level and its colors, both are kept in the local storage
+    if (localStorage->m_LevelColors[level]==NULL)
+        localStorage->m_LevelColors[level] = localStorage->m_LevelOfDetail->GetColors(level, fiberBundle->GetFiberColors());
+    if (numberOfFibers<0)
+        numberOfFibers = localStorage->m_LevelOfDetail->GetLevel(level).GetNumberOfFibers();
+    return localStorage->m_LevelOfDetail->CreatePolyData(level, numberOfFibers, localStorage->m_LevelColors[level]);
+}
+
 void mitk::FiberBundleMapper3D::SetDefaultProperties(mitk::DataNode* node, mitk::BaseRenderer* renderer, bool overwrite)
 {
     Superclass::SetDefaultProperties(node, renderer, overwrite);
@@ -225,6 +331,10 @@ void mitk::FiberBundleMapper3D::SetDefaultProperties(mitk::DataNode* node, mitk:
     node->AddProperty( "light.ambientcolor", mitk::ColorProperty::New(1,1,1), renderer, overwrite);
     node->AddProperty( "light.diffusecolor", mitk::ColorProperty::New(1,1,1), renderer, overwrite);
     node->AddProperty( "light.specularcolor", mitk::ColorProperty::New(1,1,1), renderer, overwrite);
+
+    node->AddProperty( "lod.enable", mitk::BoolProperty::New( true ), renderer, overwrite);
+    node->AddProperty( "lod.pixelerror", mitk::FloatProperty::New( 0.5 ), renderer, overwrite);
+    node->AddProperty( "lod.interactivepoints", mitk::IntProperty::New( 1000000 ), renderer, overwrite);
 }
 
 vtkProp* mitk::FiberBundleMapper3D::GetVtkProp(mitk::BaseRenderer *renderer)
@@ -247,5 +357,8 @@ mitk::FiberBundleMapper3D::FBXLocalStorage3D::FBXLocalStorage3D()
     m_FiberActor = vtkSmartPointer<vtkActor>::New();
     m_FiberMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
     m_FiberAssembly = vtkSmartPointer<vtkPropAssembly>::New();
+    m_Level = 0;
+    m_NumberOfFibers = -1;
+    m_FinalLevel = -1;
 }
 
@@ -23,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkFiberBundle.h>
 
 #include <vtkSmartPointer.h>
+#include <memory>
 
 class vtkPropAssembly;
 class vtkPolyDataMapper;
@@ -33,6 +34,11 @@ namespace mitk {
 
 //##Documentation
 //## @brief Mapper for FiberBundle
+//##
+//## Tractograms with more points than "lod.interactivepoints" are rendered from the level of detail hierarchy of the
+//## fiber bundle (see FiberLevelOfDetail) if "lod.enable" is set. The level is chosen so that the simplification error
+//## stays below "lod.pixelerror" pixels. During interaction only the prefix of the level that fits into the point budget
+//## is drawn without tubes and ribbons, the complete level is rendered when the RenderingManager requests the next LOD.
 //## @ingroup Mapper
 
 class FiberBundleMapper3D : public VtkMapper
@@ -49,6 +55,7 @@ public:
     static void SetDefaultProperties(DataNode* node, BaseRenderer* renderer = NULL, bool overwrite = false );
     static void SetVtkMapperImmediateModeRendering(vtkMapper *mapper);
     virtual void GenerateDataForRenderer(mitk::BaseRenderer* renderer) override;
+    virtual bool IsLODEnabled(mitk::BaseRenderer* renderer) const override;
     //=========================================================
 
     class  FBXLocalStorage3D : public mitk::Mapper::BaseLocalStorage
@@ -61,6 +68,17 @@ public:
 
         vtkSmartPointer<vtkPropAssembly> m_FiberAssembly;
 
+        /** \brief Level of detail hierarchy of the fiber bundle and the fiber colors of its levels. */
+        std::shared_ptr< const FiberLevelOfDetail > m_LevelOfDetail;
+        std::vector< vtkSmartPointer<vtkUnsignedCharArray> > m_LevelColors;
+        /** \brief Rendered level and number of fibers of this level, a negative number means all fibers. */
+        int m_Level;
+        vtkIdType m_NumberOfFibers;
+        /** \brief Complete level after tube and ribbon filters, it is reused when an interaction ends. */
+        vtkSmartPointer<vtkPolyData> m_FinalPolyData;
+        int m_FinalLevel;
+        itk::TimeStamp m_FinalUpdateTime;
+
         /** \brief Timestamp of last update of stored data. */
         itk::TimeStamp m_LastUpdateTime;
         /** \brief Constructor of the local storage. Do as much actions as possible in here to avoid double executions. */
@@ -80,6 +98,8 @@ protected:
     FiberBundleMapper3D();
     virtual ~FiberBundleMapper3D();
     void InternalGenerateData(mitk::BaseRenderer *renderer);
+    /** \brief Fibers of the level with the fiber colors, level 0 is the fiber bundle itself. */
+    vtkSmartPointer<vtkPolyData> GetLevelPolyData(mitk::BaseRenderer *renderer, int level, vtkIdType numberOfFibers);
 
     void UpdateVtkObjects(); //??
 
@@ -32,7 +32,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkTrackvis.h>
 #include <mitkCustomMimeType.h>
 #include "mitkDiffusionIOMimeTypes.h"
-#include <vtkTransformPolyDataFilter.h>
 #include <boost/lexical_cast.hpp>
 
 
@@ -107,50 +106,44 @@ std::vector<itk::SmartPointer<mitk::BaseData> > mitk::FiberBundleTckReader::Read
                 mitkThrow() << "Could not parse header size from " << filename;
             std::fseek ( filePointer , header_size , SEEK_SET );
 
-            vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-            vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-            vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
+            // the streamlines are stored as float triples, separated by a NaN triple and terminated by an Inf triple;
+            // the points are read in blocks and copied into the compact fiber container of the bundle
+            mitk::FiberContainer fibers;
+            std::vector< float > fiber;
+            const size_t blockSize = 4096;
+            std::vector< float > block(3*blockSize);
 
-            float tmp[3];
-            count = 1;
-            int fiber_length = 0;
-            while (std::fread((char*)tmp, 1, 12, filePointer)==12)
+            bool end = false;
+            size_t numRead = 0;
+            while (!end && (numRead = std::fread(block.data(), 3*sizeof(float), blockSize, filePointer))>0)
             {
-              if (std::isinf(tmp[0]) || std::isinf(tmp[1]) || std::isinf(tmp[1]))
-                break;
-              else if (std::isnan(tmp[0]) || std::isnan(tmp[1]) || std::isnan(tmp[2]))
+              for (size_t i=0; i<numRead; ++i)
               {
-                count++;
-                fiber_length = 0;
-                vtkNewCells->InsertNextCell(container);
-                container = vtkSmartPointer<vtkPolyLine>::New();
-              }
-              else
-              {
-                fiber_length++;
-                vtkIdType id = vtkNewPoints->InsertNextPoint(tmp);
-                container->GetPointIds()->InsertNextId(id);
+                const float* tmp = &block[3*i];
+                if (std::isinf(tmp[0]) || std::isinf(tmp[1]) || std::isinf(tmp[2]))
+                {
+                  end = true;
+                  break;
+                }
+                else if (std::isnan(tmp[0]) || std::isnan(tmp[1]) || std::isnan(tmp[2]))
+                {
+                  if (!fiber.empty())
+                    fibers.AddFiber(fiber.data(), fiber.size()/3);
+                  fiber.clear();
+                }
+                else
+                {
+                  // transform from RAS (MRtrix) to LPS (MITK)
+                  fiber.push_back(-tmp[0]);
+                  fiber.push_back(-tmp[1]);
+                  fiber.push_back(tmp[2]);
+                }
               }
             }
+            std::fclose(filePointer);
 
-            vtkSmartPointer<vtkPolyData> fiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-            fiberPolyData->SetPoints(vtkNewPoints);
-            fiberPolyData->SetLines(vtkNewCells);
-
-            // transform polydata from RAS (MRtrix) to LPS (MITK)
-            mitk::Geometry3D::Pointer geometry = mitk::Geometry3D::New();
-            vtkSmartPointer< vtkMatrix4x4 > matrix = vtkSmartPointer< vtkMatrix4x4 >::New();
-            matrix->Identity();
-            matrix->SetElement(0,0,-matrix->GetElement(0,0));
-            matrix->SetElement(1,1,-matrix->GetElement(1,1));
-            geometry->SetIndexToWorldTransformByVtkMatrix(matrix);
-
-            vtkSmartPointer<vtkTransformPolyDataFilter> transformFilter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-            transformFilter->SetInputData(fiberPolyData);
-            transformFilter->SetTransform(geometry->GetVtkTransform());
-            transformFilter->Update();
-
-            FiberBundle::Pointer fib = FiberBundle::New(transformFilter->GetOutput());
+            FiberBundle::Pointer fib = FiberBundle::New();
+            fib->SetFibers(std::move(fibers));
             result.push_back(fib.GetPointer());
         }
 
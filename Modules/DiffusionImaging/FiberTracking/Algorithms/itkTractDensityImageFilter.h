@@ -25,7 +25,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 namespace itk{
 
 /**
-* \brief Generates tract density images from input fiberbundles (Calamante 2010).   */
+* \brief Generates tract density images from input fiberbundles (Calamante 2010).
+*
+* The density of a voxel is the length of the fiber segments inside of the voxel multiplied by the fiber weights (see mitk::FiberRasterizer).   */
 
 template< class OutputImageType >
 class TractDensityImageFilter : public ImageSource< OutputImageType >
@@ -49,23 +51,21 @@ public:
   itkGetMacro( InvertImage, bool)                               ///< voxelvalue = 1-voxelvalue
   itkSetMacro( BinaryOutput, bool)                              ///< generate binary fiber envelope
   itkGetMacro( BinaryOutput, bool)                              ///< generate binary fiber envelope
-  itkSetMacro( OutputAbsoluteValues, bool)                      ///< output absolute values of the number of fibers per voxel
-  itkGetMacro( OutputAbsoluteValues, bool)                      ///< output absolute values of the number of fibers per voxel
+  itkSetMacro( OutputAbsoluteValues, bool)                      ///< output absolute values, i.e. the weighted fiber length in mm per voxel
+  itkGetMacro( OutputAbsoluteValues, bool)                      ///< output absolute values, i.e. the weighted fiber length in mm per voxel
   itkSetMacro( UseImageGeometry, bool)                          ///< use input image geometry to initialize output image
   itkGetMacro( UseImageGeometry, bool)                          ///< use input image geometry to initialize output image
   itkSetMacro( FiberBundle, mitk::FiberBundle::Pointer)        ///< input fiber bundle
   itkSetMacro( InputImage, typename OutputImageType::Pointer)   ///< use input image geometry to initialize output image
   itkSetMacro( UseTrilinearInterpolation, bool )
-  itkSetMacro( DoFiberResampling, bool )
-  itkSetMacro( WorkOnFiberCopy, bool )
+  itkSetMacro( DoFiberResampling, bool )                        ///< deprecated, the fibers are not resampled anymore
+  itkSetMacro( WorkOnFiberCopy, bool )                          ///< deprecated, the input fibers are not modified
   itkGetMacro( MaxDensity, OutPixelType)
 
   void GenerateData();
 
 protected:
 
-  itk::Point<float, 3> GetItkPoint(double point[3]);
-
   TractDensityImageFilter();
   virtual ~TractDensityImageFilter();
 
@@ -64,8 +64,6 @@ public:
 
 protected:
 
-  itk::Point<float, 3> GetItkPoint(double point[3]);
-
   TractsToFiberEndingsImageFilter();
   virtual ~TractsToFiberEndingsImageFilter();
 
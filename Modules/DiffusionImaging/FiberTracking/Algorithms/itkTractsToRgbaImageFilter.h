@@ -60,8 +60,6 @@ public:
 
 protected:
 
-  itk::Point<float, 3> GetItkPoint(double point[3]);
-
   TractsToRgbaImageFilter();
   virtual ~TractsToRgbaImageFilter();
 
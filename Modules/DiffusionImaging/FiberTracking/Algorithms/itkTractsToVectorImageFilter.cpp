@@ -1,4 +1,5 @@
 #include "itkTractsToVectorImageFilter.h"
+#include <mitkFiberRasterizer.h>
 
 // VTK
 #include <vtkPolyLine.h>
@@ -153,81 +154,40 @@ void TractsToVectorImageFilter< PixelType >::GenerateData()
     else
         minSpacing = m_OutImageSpacing[2];
 
-    if (m_UseWorkingCopy)
-        m_FiberBundle = m_FiberBundle->GetDeepCopy();
+    // collect the fiber directions in every voxel of the mask
+    mitk::FiberRasterizer rasterizer;
+    rasterizer.SetReferenceGeometry(m_MaskImage.GetPointer());
+    rasterizer.SetMaskImage(m_MaskImage);
+    rasterizer.SetFiberBundle(m_FiberBundle);
+    rasterizer.SetMaps(mitk::FiberRasterizer::DIRECTIONS);
 
-    // resample fiber bundle for sufficient voxel coverage
-    m_FiberBundle->ResampleLinear(minSpacing/10);
+    MITK_INFO << "Generating directions from tractogram";
+    rasterizer.Update();
 
-    // iterate over all fibers
-    vtkSmartPointer<vtkPolyData> fiberPolyData = m_FiberBundle->GetFiberPolyData();
-    int numFibers = m_FiberBundle->GetNumFibers();
     m_DirectionsContainer = ContainerType::New();
-
     VectorContainer< unsigned int, std::vector< double > >::Pointer peakLengths = VectorContainer< unsigned int, std::vector< double > >::New();
-
-    MITK_INFO << "Generating directions from tractogram";
-    boost::progress_display disp(numFibers);
-    for( int i=0; i<numFibers; i++ )
+    for (unsigned long idx=0; idx<rasterizer.GetNumberOfVoxels(); idx++)
     {
-        ++disp;
-        vtkCell* cell = fiberPolyData->GetCell(i);
-        int numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
-        if (numPoints<2)
+        const unsigned long numDirections = rasterizer.GetNumberOfDirections(idx);
+        if (numDirections==0)
             continue;
 
-        vnl_vector_fixed<double, 3> dir;
-        itk::Point<double, 3> worldPos;
-        vnl_vector<double> v;
-
-
-        float fiberWeight = m_FiberBundle->GetFiberWeight(i);
-
-        for( int j=0; j<numPoints-1; j++)
+        // the segment parts are weighted with their length inside of the voxel
+        const mitk::FiberRasterizer::Direction* voxelDirections = rasterizer.GetDirections(idx);
+        DirectionContainerType::Pointer dirCont = DirectionContainerType::New();
+        std::vector< double > lengths;
+        lengths.reserve(numDirections);
+        for (unsigned long k=0; k<numDirections; k++)
         {
-            // get current position along fiber in world coordinates
-            double* temp = points->GetPoint(j);
-            worldPos = GetItkPoint(temp);
-            itk::Index<3> index;
-            m_MaskImage->TransformPhysicalPointToIndex(worldPos, index);
-            if (!m_MaskImage->GetLargestPossibleRegion().IsInside(index) || m_MaskImage->GetPixel(index)==0)
-                continue;
-
-            // get fiber tangent direction at this position
-            v = GetVnlVector(temp);
-            dir = GetVnlVector(points->GetPoint(j+1))-v;
-            if (dir.is_zero())
-                continue;
-            dir.normalize();
-
-            // add direction to container
-            unsigned int idx = index[0] + outImageSize[0]*(index[1] + outImageSize[1]*index[2]);
-            DirectionContainerType::Pointer dirCont;
-            if (m_DirectionsContainer->IndexExists(idx))
-            {
-                peakLengths->ElementAt(idx).push_back(fiberWeight);
-
-                dirCont = m_DirectionsContainer->GetElement(idx);
-                if (dirCont.IsNull())
-                {
-                    dirCont = DirectionContainerType::New();
-                    dirCont->push_back(dir);
-                    m_DirectionsContainer->InsertElement(idx, dirCont);
-                }
-                else
-                    dirCont->push_back(dir);
-            }
-            else
-            {
-                dirCont = DirectionContainerType::New();
-                dirCont->push_back(dir);
-                m_DirectionsContainer->InsertElement(idx, dirCont);
-
-                std::vector< double > lengths; lengths.push_back(fiberWeight);
-                peakLengths->InsertElement(idx, lengths);
-            }
+            DirectionType dir;
+            dir[0] = voxelDirections[k].m_Direction[0];
+            dir[1] = voxelDirections[k].m_Direction[1];
+            dir[2] = voxelDirections[k].m_Direction[2];
+            dirCont->push_back(dir);
+            lengths.push_back(voxelDirections[k].m_Length);
         }
+        m_DirectionsContainer->InsertElement(idx, dirCont);
+        peakLengths->InsertElement(idx, lengths);
     }
 
     vtkSmartPointer<vtkCellArray> m_VtkCellArray = vtkSmartPointer<vtkCellArray>::New();
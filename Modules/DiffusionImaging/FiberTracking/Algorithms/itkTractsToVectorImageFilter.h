@@ -51,8 +51,8 @@ public:
     itkGetMacro( AngularThreshold, float)                               ///< cluster directions that are closer together than the specified threshold
     itkSetMacro( NormalizeVectors, bool)                                ///< Normalize vectors to length 1
     itkGetMacro( NormalizeVectors, bool)                                ///< Normalize vectors to length 1
-    itkSetMacro( UseWorkingCopy, bool)                                  ///< Do not modify input fiber bundle. Use a copy.
-    itkGetMacro( UseWorkingCopy, bool)                                  ///< Do not modify input fiber bundle. Use a copy.
+    itkSetMacro( UseWorkingCopy, bool)                                  ///< deprecated, the input fiber bundle is not modified
+    itkGetMacro( UseWorkingCopy, bool)                                  ///< deprecated, the input fiber bundle is not modified
     itkSetMacro( MaxNumDirections, unsigned long)                       ///< If more directions are extracted, only the largest are kept.
     itkGetMacro( MaxNumDirections, unsigned long)                       ///< If more directions are extracted, only the largest are kept.
     itkSetMacro( MaskImage, ItkUcharImgType::Pointer)                   ///< only process voxels inside mask
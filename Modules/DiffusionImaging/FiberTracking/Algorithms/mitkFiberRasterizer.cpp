@@ -0,0 +1,419 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFiberRasterizer.h"
+#include <mitkExceptionMacro.h>
+#include <itkContinuousIndex.h>
+#include <omp.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    /** Upper limit for the memory of the per-thread accumulation buffers. Fewer threads are used for larger outputs. */
+    const unsigned long long MaxBufferMemory = 1ull << 30;
+
+    /**
+      * Visits the voxels intersected by the segment from a to b, given in voxel coordinates where voxel k covers [k, k+1).
+      * The visitor receives the voxel and the part [t0, t1] of the segment parameter range [0, 1] inside of the voxel.
+      * Parts outside of the grid are skipped.
+      */
+    template< class VisitorType >
+    void TraverseSegment(const double a[3], const double b[3], const int size[3], VisitorType& visit)
+    {
+        double delta[3];
+        double t0 = 0;
+        double t1 = 1;
+        for (int c=0; c<3; c++)
+        {
+            delta[c] = b[c]-a[c];
+            if (delta[c]==0)
+            {
+                if (a[c]<0 || a[c]>=size[c])
+                    return;
+                continue;
+            }
+            double ta = -a[c]/delta[c];
+            double tb = (size[c]-a[c])/delta[c];
+            if (ta>tb)
+                std::swap(ta, tb);
+            t0 = std::max(t0, ta);
+            t1 = std::min(t1, tb);
+        }
+        if (t0>=t1)
+            return;
+
+        int index[3];
+        int step[3];
+        double tMax[3];
+        double tDelta[3];
+        for (int c=0; c<3; c++)
+        {
+            const double q = a[c] + t0*delta[c];
+            // a start point on a voxel border belongs to the voxel the segment enters
+            index[c] = delta[c]<0 ? (int)std::ceil(q)-1 : (int)std::floor(q);
+            index[c] = std::max(0, std::min(size[c]-1, index[c]));
+            if (delta[c]>0)
+            {
+                step[c] = 1;
+                tMax[c] = (index[c]+1-a[c])/delta[c];
+                tDelta[c] = 1/delta[c];
+            }
+            else if (delta[c]<0)
+            {
+                step[c] = -1;
+                tMax[c] = (index[c]-a[c])/delta[c];
+                tDelta[c] = -1/delta[c];
+            }
+            else
+            {
+                step[c] = 0;
+                tMax[c] = std::numeric_limits<double>::infinity();
+                tDelta[c] = 0;
+            }
+        }
+
+        double t = t0;
+        while (true)
+        {
+            int c = 0;
+            if (tMax[1]<tMax[c])
+                c = 1;
+            if (tMax[2]<tMax[c])
+                c = 2;
+            const double tNext = std::min(tMax[c], t1);
+            if (tNext>t)
+                visit(index, t, tNext);
+            if (tNext>=t1)
+                break;
+
+            index[c] += step[c];
+            if (index[c]<0 || index[c]>=size[c])
+                break;
+            t = tNext;
+            tMax[c] += tDelta[c];
+        }
+    }
+}
+
+mitk::FiberRasterizer::FiberRasterizer()
+    : m_FiberBundle(nullptr)
+    , m_MaskImage(nullptr)
+    , m_UpsamplingFactor(1)
+    , m_Maps(DENSITY)
+    , m_UseTrilinearInterpolation(false)
+{
+    m_ReferenceCorner.Fill(0.0);
+    m_ReferenceSpacing.Fill(1.0);
+    m_ReferenceExtent.Fill(0.0);
+    m_Direction.SetIdentity();
+    this->UpdateGrid();
+}
+
+void mitk::FiberRasterizer::SetReferenceGeometry(const itk::ImageBase<3>* reference)
+{
+    itk::ContinuousIndex<double, 3> corner;
+    for (int i=0; i<3; i++)
+    {
+        corner[i] = reference->GetLargestPossibleRegion().GetIndex()[i] - 0.5;
+        m_ReferenceExtent[i] = reference->GetLargestPossibleRegion().GetSize()[i];
+    }
+    reference->TransformContinuousIndexToPhysicalPoint(corner, m_ReferenceCorner);
+    m_ReferenceSpacing = reference->GetSpacing();
+    m_Direction = reference->GetDirection();
+    this->UpdateGrid();
+}
+
+void mitk::FiberRasterizer::SetReferenceGeometry(const mitk::BaseGeometry* geometry)
+{
+    mitk::BaseGeometry::BoundsArrayType bounds = geometry->GetBounds();
+    for (int i=0; i<3; i++)
+    {
+        m_ReferenceCorner[i] = geometry->GetOrigin()[i] + bounds.GetElement(2*i);
+        m_ReferenceSpacing[i] = geometry->GetSpacing()[i];
+        m_ReferenceExtent[i] = geometry->GetExtent(i);
+
+        mitk::VnlVector column = geometry->GetMatrixColumn(i);
+        column.normalize();
+        for (int j=0; j<3; j++)
+            m_Direction[j][i] = column[j];
+    }
+    this->UpdateGrid();
+}
+
+void mitk::FiberRasterizer::SetUpsamplingFactor(float factor)
+{
+    m_UpsamplingFactor = factor;
+    this->UpdateGrid();
+}
+
+void mitk::FiberRasterizer::UpdateGrid()
+{
+    itk::ImageRegion<3>::SizeType size;
+    itk::Vector<double, 3> halfVoxel;
+    for (int i=0; i<3; i++)
+    {
+        m_Spacing[i] = m_ReferenceSpacing[i]/m_UpsamplingFactor;
+        // tolerance for fractional upsampling factors that exactly subdivide the reference
+        size[i] = m_ReferenceExtent[i]>0 ? std::max(1.0, std::ceil(m_ReferenceExtent[i]*m_UpsamplingFactor - 0.001)) : 0;
+        halfVoxel[i] = 0.5*m_Spacing[i];
+    }
+    m_Region.SetSize(size);
+    m_Origin = m_ReferenceCorner + m_Direction*halfVoxel;
+}
+
+void mitk::FiberRasterizer::CopyGeometry(itk::ImageBase<3>* image) const
+{
+    image->SetSpacing( m_Spacing );
+    image->SetOrigin( m_Origin );
+    image->SetDirection( m_Direction );
+    image->SetRegions( m_Region );
+}
+
+void mitk::FiberRasterizer::Update()
+{
+    if (m_FiberBundle.IsNull())
+        mitkThrow() << "No fiber bundle set.";
+    if (m_Region.GetNumberOfPixels()==0)
+        mitkThrow() << "The output grid is empty.";
+    if ((m_Maps & DIRECTIONS) && m_MaskImage.IsNotNull() && m_MaskImage->GetLargestPossibleRegion().GetSize()!=m_Region.GetSize())
+        mitkThrow() << "The mask image has to be defined on the output grid.";
+
+    const FiberContainer& fibers = m_FiberBundle->GetFibers();
+    const int numFibers = fibers.GetNumberOfFibers();
+    const itk::SizeValueType numVoxels = m_Region.GetNumberOfPixels();
+
+    unsigned int valuesPerVoxel = 0;
+    if (m_Maps & DENSITY)
+        valuesPerVoxel += 1;
+    if (m_Maps & ENDINGS)
+        valuesPerVoxel += 1;
+    if (m_Maps & COLOR)
+        valuesPerVoxel += 4;
+
+    int numThreads = omp_get_max_threads();
+    const unsigned long long threadMemory = (unsigned long long)numVoxels*valuesPerVoxel*sizeof(float);
+    if (threadMemory>0)
+        numThreads = (int)std::min<unsigned long long>(numThreads, std::max<unsigned long long>(1, MaxBufferMemory/threadMemory));
+    numThreads = std::max(1, std::min(numThreads, numFibers));
+
+    // every thread gets a contiguous range of fibers with about the same number of points,
+    // so the directions are collected in fiber order
+    std::vector< int > begins(numThreads+1, numFibers);
+    for (int t=0; t<numThreads; t++)
+    {
+        const vtkIdType target = fibers.GetNumberOfPoints()*t/numThreads;
+        int lo = 0;
+        int hi = numFibers;
+        while (lo<hi)
+        {
+            const int mid = lo + (hi-lo)/2;
+            if (fibers.GetOffset(mid)<target)
+                lo = mid+1;
+            else
+                hi = mid;
+        }
+        begins[t] = lo;
+    }
+
+    std::vector< std::vector< float > > density(numThreads);
+    std::vector< std::vector< float > > endings(numThreads);
+    std::vector< std::vector< float > > colors(numThreads);
+    std::vector< std::vector< std::pair< unsigned long, Direction > > > directions(numThreads);
+
+    MITK_INFO << "Rasterizing " << numFibers << " fibers into " << m_Region.GetSize() << " voxels using " << numThreads << " threads";
+#pragma omp parallel for num_threads(numThreads)
+    for (int t=0; t<numThreads; t++)
+    {
+        if (m_Maps & DENSITY)
+            density[t].resize(numVoxels, 0);
+        if (m_Maps & ENDINGS)
+            endings[t].resize(numVoxels, 0);
+        if (m_Maps & COLOR)
+            colors[t].resize(4*numVoxels, 0);
+        this->RasterizeFibers(begins[t], begins[t+1],
+                              density[t].empty() ? nullptr : density[t].data(),
+                              endings[t].empty() ? nullptr : endings[t].data(),
+                              colors[t].empty() ? nullptr : colors[t].data(),
+                              directions[t]);
+    }
+
+    // merge the thread buffers into the buffers of the first thread, in blocks of voxels because
+    // the number of voxels may exceed the range of the int loop variable OpenMP 2.0 requires
+    const itk::SizeValueType blockSize = 1 << 16;
+    const int numBlocks = (int)((numVoxels + blockSize - 1) / blockSize);
+#pragma omp parallel for
+    for (int b=0; b<numBlocks; b++)
+    {
+        const itk::SizeValueType blockEnd = std::min(numVoxels, (b+1)*blockSize);
+        for (itk::SizeValueType v=b*blockSize; v<blockEnd; v++)
+        {
+            for (int t=1; t<numThreads; t++)
+            {
+                if (m_Maps & DENSITY)
+                    density[0][v] += density[t][v];
+                if (m_Maps & ENDINGS)
+                    endings[0][v] += endings[t][v];
+                if (m_Maps & COLOR)
+                    for (int c=0; c<4; c++)
+                        colors[0][4*v+c] += colors[t][4*v+c];
+            }
+        }
+    }
+    m_Density.swap(density[0]);
+    m_Endings.swap(endings[0]);
+    m_Colors.swap(colors[0]);
+
+    m_Directions.clear();
+    m_DirectionOffsets.clear();
+    if (m_Maps & DIRECTIONS)
+        this->GroupDirections(directions);
+}
+
+void mitk::FiberRasterizer::RasterizeFibers(int begin, int end, float* density, float* endings, float* colors, std::vector< std::pair< unsigned long, Direction > >& directions) const
+{
+    const FiberContainer& fibers = m_FiberBundle->GetFibers();
+    const int size[3] = { (int)m_Region.GetSize()[0], (int)m_Region.GetSize()[1], (int)m_Region.GetSize()[2] };
+    const unsigned char* mask = ((m_Maps & DIRECTIONS) && m_MaskImage.IsNotNull()) ? m_MaskImage->GetBufferPointer() : nullptr;
+
+    // world to voxel coordinates, voxel k covers [k, k+1)
+    vnl_matrix_fixed< double, 3, 3 > worldToVoxel(m_Direction.GetInverse());
+    for (int r=0; r<3; r++)
+        for (int c=0; c<3; c++)
+            worldToVoxel[r][c] /= m_Spacing[r];
+    auto toVoxel = [&](const float* p, double* v)
+    {
+        const double d[3] = { p[0]-m_Origin[0], p[1]-m_Origin[1], p[2]-m_Origin[2] };
+        for (int r=0; r<3; r++)
+            v[r] = worldToVoxel[r][0]*d[0] + worldToVoxel[r][1]*d[1] + worldToVoxel[r][2]*d[2] + 0.5;
+    };
+    auto addEnding = [&](const float* p)
+    {
+        double v[3];
+        toVoxel(p, v);
+        const int x = (int)std::floor(v[0]);
+        const int y = (int)std::floor(v[1]);
+        const int z = (int)std::floor(v[2]);
+        if (x>=0 && x<size[0] && y>=0 && y<size[1] && z>=0 && z<size[2])
+            endings[x + size[0]*(y + (itk::SizeValueType)size[1]*z)] += 1;
+    };
+
+    for (int i=begin; i<end; i++)
+    {
+        const vtkIdType numPoints = fibers.GetNumberOfPoints(i);
+        const float* points = fibers.GetPoints(i);
+        if (numPoints<=0)
+            continue;
+
+        if (endings!=nullptr)
+        {
+            addEnding(points);
+            if (numPoints>=2)
+                addEnding(points + 3*(numPoints-1));
+        }
+        if (density==nullptr && colors==nullptr && !(m_Maps & DIRECTIONS))
+            continue;
+
+        const float weight = m_FiberBundle->GetFiberWeight(i);
+        double a[3];
+        double b[3];
+        toVoxel(points, b);
+        for (vtkIdType j=0; j<numPoints-1; j++)
+        {
+            const float* p = points + 3*j;
+            std::copy(b, b+3, a);
+            toVoxel(p+3, b);
+
+            float dir[3] = { p[3]-p[0], p[4]-p[1], p[5]-p[2] };
+            const float length = std::sqrt(dir[0]*dir[0] + dir[1]*dir[1] + dir[2]*dir[2]);
+            if (length<=0)
+                continue;
+            for (int c=0; c<3; c++)
+                dir[c] /= length;
+
+            auto visit = [&](const int* index, double t0, double t1)
+            {
+                const float l = (t1-t0)*length*weight;
+                const itk::SizeValueType voxel = index[0] + size[0]*(index[1] + (itk::SizeValueType)size[1]*index[2]);
+
+                if (density!=nullptr && !m_UseTrilinearInterpolation)
+                    density[voxel] += l;
+                else if (density!=nullptr)
+                {
+                    // trilinear weights of the part center with respect to the voxel centers
+                    int base[3];
+                    float frac[3];
+                    for (int c=0; c<3; c++)
+                    {
+                        const double center = a[c] + 0.5*(t0+t1)*(b[c]-a[c]) - 0.5;
+                        base[c] = (int)std::floor(center);
+                        frac[c] = center - base[c];
+                    }
+                    for (int n=0; n<8; n++)
+                    {
+                        const int x = base[0] + (n&1);
+                        const int y = base[1] + ((n>>1)&1);
+                        const int z = base[2] + ((n>>2)&1);
+                        if (x<0 || x>=size[0] || y<0 || y>=size[1] || z<0 || z>=size[2])
+                            continue;
+                        const float fx = (n&1) ? frac[0] : 1-frac[0];
+                        const float fy = ((n>>1)&1) ? frac[1] : 1-frac[1];
+                        const float fz = ((n>>2)&1) ? frac[2] : 1-frac[2];
+                        density[x + size[0]*(y + (itk::SizeValueType)size[1]*z)] += fx*fy*fz*l;
+                    }
+                }
+
+                if (colors!=nullptr)
+                {
+                    for (int c=0; c<3; c++)
+                        colors[4*voxel+c] += std::fabs(dir[c])*l;
+                    colors[4*voxel+3] += l;
+                }
+
+                if ((m_Maps & DIRECTIONS) && (mask==nullptr || mask[voxel]!=0))
+                {
+                    Direction direction;
+                    std::copy(dir, dir+3, direction.m_Direction);
+                    direction.m_Length = l;
+                    directions.push_back(std::make_pair(voxel, direction));
+                }
+            };
+            TraverseSegment(a, b, size, visit);
+        }
+    }
+}
+
+void mitk::FiberRasterizer::GroupDirections(std::vector< std::vector< std::pair< unsigned long, Direction > > >& threadDirections)
+{
+    const itk::SizeValueType numVoxels = m_Region.GetNumberOfPixels();
+    m_DirectionOffsets.assign(numVoxels+1, 0);
+    for (const auto& directions : threadDirections)
+        for (const auto& direction : directions)
+            m_DirectionOffsets[direction.first+1]++;
+    for (itk::SizeValueType v=0; v<numVoxels; v++)
+        m_DirectionOffsets[v+1] += m_DirectionOffsets[v];
+
+    // the threads cover consecutive fiber ranges, so this keeps the fiber order within every voxel
+    m_Directions.resize(m_DirectionOffsets.back());
+    std::vector< unsigned long > next(m_DirectionOffsets.begin(), m_DirectionOffsets.end()-1);
+    for (auto& directions : threadDirections)
+    {
+        for (const auto& direction : directions)
+            m_Directions[next[direction.first]++] = direction.second;
+        std::vector< std::pair< unsigned long, Direction > >().swap(directions);
+    }
+}
@@ -0,0 +1,127 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITK_FiberRasterizer_H
+#define _MITK_FiberRasterizer_H
+
+#include <MitkFiberTrackingExports.h>
+#include <mitkFiberBundle.h>
+#include <itkImage.h>
+#include <vector>
+
+namespace mitk {
+
+/**
+  * \brief Rasterizes a fiber bundle into voxel maps in a single parallel pass over the fibers.
+  *
+  * Every fiber segment is traversed voxel by voxel (3D DDA) and each voxel receives the exact length of
+  * the segment part inside of it, so the fibers do not need to be resampled. The maps selected with SetMaps()
+  * are accumulated in per-thread buffers that are merged after the traversal:
+  *
+  * - DENSITY: fiber length in mm per voxel, multiplied by the fiber weight.
+  * - ENDINGS: number of fiber end points per voxel.
+  * - COLOR: four values per voxel, the absolute x, y and z components of the segment directions and the total length, both weighted with segment length and fiber weight.
+  * - DIRECTIONS: the unit direction and weighted length of every segment part, grouped by voxel (fixels).
+  *
+  * The output grid is either a reference image grid or the bounding box of the fiber bundle, refined by the
+  * upsampling factor. Buffers are stored in ITK order (x fastest).
+  */
+class MITKFIBERTRACKING_EXPORT FiberRasterizer
+{
+public:
+
+    enum MapType {
+        DENSITY = 1,
+        ENDINGS = 2,
+        COLOR = 4,
+        DIRECTIONS = 8
+    };
+
+    /** \brief Segment part inside of a voxel, see DIRECTIONS. */
+    struct Direction
+    {
+        float m_Direction[3];
+        float m_Length;
+    };
+
+    typedef itk::Image<unsigned char, 3>  ItkUcharImgType;
+
+    FiberRasterizer();
+
+    /** \brief The output voxels subdivide the voxels of the reference image by the upsampling factor. */
+    void SetReferenceGeometry(const itk::ImageBase<3>* reference);
+    /** \brief The output grid starts at the corner of the bounding box of the fibers and uses the spacing of the geometry divided by the upsampling factor. */
+    void SetReferenceGeometry(const mitk::BaseGeometry* geometry);
+
+    void SetUpsamplingFactor(float factor);
+    void SetFiberBundle(mitk::FiberBundle::Pointer fib){ m_FiberBundle = fib; }
+    /** \brief Combination of MapType flags. */
+    void SetMaps(unsigned int maps){ m_Maps = maps; }
+    /** \brief Distribute the density of a segment part to the eight voxels around its center instead of the voxel containing it. */
+    void SetUseTrilinearInterpolation(bool interpolate){ m_UseTrilinearInterpolation = interpolate; }
+    /** \brief Directions are only collected in voxels inside of the mask. The mask has to be defined on the output grid. */
+    void SetMaskImage(ItkUcharImgType::Pointer mask){ m_MaskImage = mask; }
+
+    void Update();
+
+    /** \brief Applies the output grid to the image. The image is not allocated. */
+    void CopyGeometry(itk::ImageBase<3>* image) const;
+    itk::ImageRegion<3> GetRegion() const { return m_Region; }
+    itk::Vector<double, 3> GetSpacing() const { return m_Spacing; }
+    itk::Point<double, 3> GetOrigin() const { return m_Origin; }
+    itk::Matrix<double, 3, 3> GetDirection() const { return m_Direction; }
+    unsigned long GetNumberOfVoxels() const { return m_Region.GetNumberOfPixels(); }
+
+    const std::vector< float >& GetDensity() const { return m_Density; }
+    const std::vector< float >& GetEndings() const { return m_Endings; }
+    const std::vector< float >& GetColors() const { return m_Colors; }
+
+    unsigned long GetNumberOfDirections(unsigned long voxel) const { return m_DirectionOffsets[voxel+1] - m_DirectionOffsets[voxel]; }
+    const Direction* GetDirections(unsigned long voxel) const { return m_Directions.data() + m_DirectionOffsets[voxel]; }
+
+protected:
+
+    /** \brief Derives the output grid from the reference grid and the upsampling factor. */
+    void UpdateGrid();
+    /** \brief Rasterizes the fibers of the range into the buffers of one thread. */
+    void RasterizeFibers(int begin, int end, float* density, float* endings, float* colors, std::vector< std::pair< unsigned long, Direction > >& directions) const;
+    void GroupDirections(std::vector< std::vector< std::pair< unsigned long, Direction > > >& threadDirections);
+
+    mitk::FiberBundle::Pointer  m_FiberBundle;
+    ItkUcharImgType::Pointer    m_MaskImage;
+    float                       m_UpsamplingFactor;
+    unsigned int                m_Maps;
+    bool                        m_UseTrilinearInterpolation;
+
+    itk::Point<double, 3>       m_ReferenceCorner;      ///< outer corner of the first reference voxel
+    itk::Vector<double, 3>      m_ReferenceSpacing;
+    itk::Vector<double, 3>      m_ReferenceExtent;      ///< number of reference voxels, not necessarily integer for fiber bundle geometries
+
+    itk::ImageRegion<3>         m_Region;
+    itk::Vector<double, 3>      m_Spacing;
+    itk::Point<double, 3>       m_Origin;
+    itk::Matrix<double, 3, 3>   m_Direction;
+
+    std::vector< float >            m_Density;
+    std::vector< float >            m_Endings;
+    std::vector< float >            m_Colors;
+    std::vector< Direction >        m_Directions;
+    std::vector< unsigned long >    m_DirectionOffsets;
+};
+
+}
+
+#endif // _MITK_FiberRasterizer_H
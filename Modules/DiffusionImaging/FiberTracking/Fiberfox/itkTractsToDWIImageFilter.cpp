@@ -777,25 +777,26 @@ namespace itk
     density_calculator->SetOutputAbsoluteValues(true);
     density_calculator->SetWorkOnFiberCopy(false);
     density_calculator->Update();
-    float max_density = density_calculator->GetMaxDensity();
+    // the density is the fiber length per voxel, convert it to the number of fiber segments
+    float max_density = density_calculator->GetMaxDensity()*volumeAccuracy/minSpacing;
     
     if (m_mmRadius>0) 
     { 
       m_SegmentVolume = M_PI*m_mmRadius*m_mmRadius*minSpacing/volumeAccuracy; 
       stringstream stream;
-      stream << fixed << setprecision(2) << max_density * 100 * m_SegmentVolume;
+      stream << fixed << setprecision(2) << max_density * m_SegmentVolume;
       string s = stream.str();
       PrintToLog("\nMax. fiber volume: " + s + "mm².", false, true, true);
     }
     else
     {
       stringstream stream;
-      stream << fixed << setprecision(2) << max_density * 100 * m_SegmentVolume;
+      stream << fixed << setprecision(2) << max_density * m_SegmentVolume;
       string s = stream.str();
       PrintToLog("\nMax. fiber volume: " + s + "mm² (before rescaling to voxel volume).", false, true, true);
     }
     float voxel_volume = m_WorkingSpacing[0]*m_WorkingSpacing[1]*m_WorkingSpacing[2];
-    float new_seg_vol = voxel_volume/(max_density * 100.0);
+    float new_seg_vol = voxel_volume/max_density;
     float new_fib_radius = 1000*std::sqrt(new_seg_vol*volumeAccuracy/(minSpacing*M_PI));
     stringstream stream;
     stream << fixed << setprecision(2) << new_fib_radius;
@@ -0,0 +1,72 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFiberBounds.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+mitk::FiberBounds::FiberBounds(const FiberContainer& fibers)
+{
+    const int numFibers = fibers.GetNumberOfFibers();
+    m_Bounds.resize(6*numFibers);
+
+#pragma omp parallel for
+    for (int i=0; i<numFibers; i++)
+    {
+        const float* points = fibers.GetPoints(i);
+        const vtkIdType numPoints = fibers.GetNumberOfPoints(i);
+        float* bounds = m_Bounds.data() + 6*i;
+        if (numPoints<=0)
+        {
+            // empty fibers are never close to anything
+            std::fill(bounds, bounds+3, 0);
+            std::fill(bounds+3, bounds+6, -std::numeric_limits<float>::max());
+            continue;
+        }
+
+        float minPoint[3] = {points[0], points[1], points[2]};
+        float maxPoint[3] = {points[0], points[1], points[2]};
+        for (vtkIdType j=1; j<numPoints; j++)
+            for (int c=0; c<3; c++)
+            {
+                minPoint[c] = std::min(minPoint[c], points[3*j+c]);
+                maxPoint[c] = std::max(maxPoint[c], points[3*j+c]);
+            }
+        for (int c=0; c<3; c++)
+        {
+            bounds[c] = 0.5*(minPoint[c]+maxPoint[c]);
+            bounds[c+3] = 0.5*(maxPoint[c]-minPoint[c]);
+        }
+    }
+}
+
+std::vector< vtkIdType > mitk::FiberBounds::GetFibersNearPlane(const double normal[3], double offset, double distance) const
+{
+    std::vector< vtkIdType > fibers;
+    const vtkIdType numFibers = m_Bounds.size()/6;
+    for (vtkIdType i=0; i<numFibers; i++)
+    {
+        const float* bounds = m_Bounds.data() + 6*i;
+        // distance of the box center to the plane and projected half size of the box
+        const double centerDistance = std::fabs(normal[0]*bounds[0] + normal[1]*bounds[1] + normal[2]*bounds[2] - offset);
+        const double radius = std::fabs(normal[0])*bounds[3] + std::fabs(normal[1])*bounds[4] + std::fabs(normal[2])*bounds[5];
+        if (centerDistance<=radius+distance)
+            fibers.push_back(i);
+    }
+    return fibers;
+}
@@ -0,0 +1,49 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITK_FiberBounds_H
+#define _MITK_FiberBounds_H
+
+#include <MitkFiberTrackingExports.h>
+#include <mitkFiberContainer.h>
+
+#include <vector>
+
+namespace mitk {
+
+/**
+   * \brief Bounding boxes of the fibers of a tractogram, used to select the fibers close to a plane.
+   *
+   * Needs six floats per fiber, independent of the number of points, and does not refer to the fibers
+   * after the constructor.
+   */
+class MITKFIBERTRACKING_EXPORT FiberBounds
+{
+public:
+
+    explicit FiberBounds(const FiberContainer& fibers);
+
+    /** \brief Indices of the fibers with a bounding box that intersects the slab {x | |normal*x - offset| <= distance}. */
+    std::vector< vtkIdType > GetFibersNearPlane(const double normal[3], double offset, double distance) const;
+
+private:
+
+    std::vector< float >                    m_Bounds;       ///< center and half size of the bounding box of every fiber
+};
+
+} // namespace mitk
+
+#endif /*  _MITK_FiberBounds_H */
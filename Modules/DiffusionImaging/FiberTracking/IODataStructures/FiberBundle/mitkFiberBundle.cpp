@@ -38,8 +38,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkParametricFunctionSource.h>
 #include <vtkParametricSpline.h>
 #include <vtkPolygon.h>
-#include <vtkCleanPolyData.h>
 #include <cmath>
+#include <algorithm>
 #include <boost/progress.hpp>
 #include <vtkTransformPolyDataFilter.h>
 #include <mitkTransferFunction.h>
@@ -51,21 +51,29 @@ const char* mitk::FiberBundle::FIBER_ID_ARRAY = "Fiber_IDs";
 
 using namespace std;
 
+namespace
+{
+    void AppendPoint(std::vector< float >& fiber, const vnl_vector_fixed< double, 3 >& point)
+    {
+        fiber.push_back(point[0]);
+        fiber.push_back(point[1]);
+        fiber.push_back(point[2]);
+    }
+}
+
 mitk::FiberBundle::FiberBundle( vtkPolyData* fiberPolyData )
     : m_NumFibers(0)
 {
     m_FiberWeights = vtkSmartPointer<vtkFloatArray>::New();
     m_FiberWeights->SetName("FIBER_WEIGHTS");
 
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
     if (fiberPolyData != nullptr)
     {
-        m_FiberPolyData = fiberPolyData;
+        m_Fibers = FiberContainer(fiberPolyData);
         this->ColorFibersByOrientation();
     }
 
     this->UpdateFiberGeometry();
-    this->GenerateFiberIds();
 }
 
 mitk::FiberBundle::~FiberBundle()
@@ -75,7 +83,8 @@ mitk::FiberBundle::~FiberBundle()
 
 mitk::FiberBundle::Pointer mitk::FiberBundle::GetDeepCopy()
 {
-    mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New(m_FiberPolyData);
+    mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New();
+    newFib->SetFibers(m_Fibers);
     newFib->SetFiberColors(this->m_FiberColors);
     newFib->SetFiberWeights(this->m_FiberWeights);
     return newFib;
@@ -83,36 +92,22 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::GetDeepCopy()
 
 vtkSmartPointer<vtkPolyData> mitk::FiberBundle::GeneratePolyDataByIds(std::vector<long> fiberIds)
 {
-    vtkSmartPointer<vtkPolyData> newFiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    vtkSmartPointer<vtkCellArray> newLineSet = vtkSmartPointer<vtkCellArray>::New();
-    vtkSmartPointer<vtkPoints> newPointSet = vtkSmartPointer<vtkPoints>::New();
+    FiberContainer newFibers;
+    newFibers.Reserve(fiberIds.size(), 0);
 
     auto finIt = fiberIds.begin();
     while ( finIt != fiberIds.end() )
     {
-        if (*finIt < 0 || *finIt>GetNumFibers()){
+        if (*finIt < 0 || *finIt>=GetNumFibers()){
             MITK_INFO << "FiberID can not be negative or >NumFibers!!! check id Extraction!" << *finIt;
             break;
         }
 
-        vtkSmartPointer<vtkCell> fiber = m_FiberIdDataSet->GetCell(*finIt);//->DeepCopy(fiber);
-        vtkSmartPointer<vtkPoints> fibPoints = fiber->GetPoints();
-        vtkSmartPointer<vtkPolyLine> newFiber = vtkSmartPointer<vtkPolyLine>::New();
-        newFiber->GetPointIds()->SetNumberOfIds( fibPoints->GetNumberOfPoints() );
-
-        for(int i=0; i<fibPoints->GetNumberOfPoints(); i++)
-        {
-            newFiber->GetPointIds()->SetId(i, newPointSet->GetNumberOfPoints());
-            newPointSet->InsertNextPoint(fibPoints->GetPoint(i)[0], fibPoints->GetPoint(i)[1], fibPoints->GetPoint(i)[2]);
-        }
-
-        newLineSet->InsertNextCell(newFiber);
+        newFibers.AddFiber(m_Fibers, *finIt);
         ++finIt;
     }
 
-    newFiberPolyData->SetPoints(newPointSet);
-    newFiberPolyData->SetLines(newLineSet);
-    return newFiberPolyData;
+    return newFibers.CreatePolyData();
 }
 
 // merge two fiber bundles
@@ -125,62 +120,33 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundle(mitk::FiberBundle* fib)
     }
     MITK_INFO << "Adding fibers";
 
-    vtkSmartPointer<vtkPolyData> vNewPolyData = vtkSmartPointer<vtkPolyData>::New();
-    vtkSmartPointer<vtkCellArray> vNewLines = vtkSmartPointer<vtkCellArray>::New();
-    vtkSmartPointer<vtkPoints> vNewPoints = vtkSmartPointer<vtkPoints>::New();
+    const FiberContainer& fibers = fib->GetFibers();
+    FiberContainer newFibers;
+    newFibers.Reserve(m_Fibers.GetNumberOfFibers()+fibers.GetNumberOfFibers(), m_Fibers.GetNumberOfPoints()+fibers.GetNumberOfPoints());
 
     // add current fiber bundle
     vtkSmartPointer<vtkFloatArray> weights = vtkSmartPointer<vtkFloatArray>::New();
     weights->SetNumberOfValues(this->GetNumFibers()+fib->GetNumFibers());
 
     unsigned int counter = 0;
-    for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+    for (int i=0; i<m_Fibers.GetNumberOfFibers(); i++)
     {
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        int numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
-
-        vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-        for (int j=0; j<numPoints; j++)
-        {
-            double p[3];
-            points->GetPoint(j, p);
-
-            vtkIdType id = vNewPoints->InsertNextPoint(p);
-            container->GetPointIds()->InsertNextId(id);
-        }
+        newFibers.AddFiber(m_Fibers, i);
         weights->InsertValue(counter, this->GetFiberWeight(i));
-        vNewLines->InsertNextCell(container);
         counter++;
     }
 
     // add new fiber bundle
-    for (int i=0; i<fib->GetFiberPolyData()->GetNumberOfCells(); i++)
+    for (int i=0; i<fibers.GetNumberOfFibers(); i++)
     {
-        vtkCell* cell = fib->GetFiberPolyData()->GetCell(i);
-        int numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
-
-        vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-        for (int j=0; j<numPoints; j++)
-        {
-            double p[3];
-            points->GetPoint(j, p);
-
-            vtkIdType id = vNewPoints->InsertNextPoint(p);
-            container->GetPointIds()->InsertNextId(id);
-        }
+        newFibers.AddFiber(fibers, i);
         weights->InsertValue(counter, fib->GetFiberWeight(i));
-        vNewLines->InsertNextCell(container);
         counter++;
     }
 
-    // initialize PolyData
-    vNewPolyData->SetPoints(vNewPoints);
-    vNewPolyData->SetLines(vNewLines);
-
     // initialize fiber bundle
-    mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New(vNewPolyData);
+    mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New();
+    newFib->SetFibers(std::move(newFibers));
     newFib->SetFiberWeights(weights);
     return newFib;
 }
@@ -197,7 +163,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::SubtractBundle(mitk::FiberBundle*
     std::vector< std::vector< itk::Point<float, 3> > > points1;
     for( int i=0; i<m_NumFibers; i++ )
     {
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
+        vtkCell* cell = GetFiberPolyData()->GetCell(i);
         int numPoints = cell->GetNumberOfPoints();
         vtkPoints* points = cell->GetPoints();
 
@@ -268,7 +234,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::SubtractBundle(mitk::FiberBundle*
 
     for( int i : ids )
     {
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
+        vtkCell* cell = GetFiberPolyData()->GetCell(i);
         int numPoints = cell->GetNumberOfPoints();
         vtkPoints* points = cell->GetPoints();
 
@@ -307,29 +273,57 @@ itk::Point<float, 3> mitk::FiberBundle::GetItkPoint(double point[3])
  */
 void mitk::FiberBundle::SetFiberPolyData(vtkSmartPointer<vtkPolyData> fiberPD, bool updateGeometry)
 {
-    if (fiberPD == nullptr)
-        this->m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    else
-    {
-        m_FiberPolyData->DeepCopy(fiberPD);
-        ColorFibersByOrientation();
-    }
+    this->SetFibers(FiberContainer(fiberPD), updateGeometry);
+}
 
-    m_NumFibers = m_FiberPolyData->GetNumberOfLines();
+/*
+ * set fibers (additional flag to recompute fiber geometry, default = true)
+ */
+void mitk::FiberBundle::SetFibers(FiberContainer fibers, bool updateGeometry)
+{
+    m_Fibers = std::move(fibers);
+    m_FiberPolyData = nullptr;
+    m_LevelOfDetail = nullptr;
+    m_FiberBounds = nullptr;
+    m_FiberIdDataSet = nullptr;
+    ColorFibersByOrientation();
+
+    m_NumFibers = m_Fibers.GetNumberOfFibers();
 
     if (updateGeometry)
         UpdateFiberGeometry();
-    GenerateFiberIds();
 }
 
 /*
- * return vtkPolyData
+ * return vtkPolyData view on the fibers, it is created on the first call after the fibers changed
  */
 vtkSmartPointer<vtkPolyData> mitk::FiberBundle::GetFiberPolyData() const
 {
+    if (m_FiberPolyData == nullptr)
+        m_FiberPolyData = m_Fibers.CreatePolyData();
     return m_FiberPolyData;
 }
 
+/*
+ * return level of detail hierarchy of the fibers, it is built on the first call after the fibers changed
+ */
+std::shared_ptr< const mitk::FiberLevelOfDetail > mitk::FiberBundle::GetLevelOfDetail() const
+{
+    if (m_LevelOfDetail == nullptr)
+        m_LevelOfDetail = std::make_shared< const FiberLevelOfDetail >(m_Fibers);
+    return m_LevelOfDetail;
+}
+
+/*
+ * return bounding boxes of the fibers, they are computed on the first call after the fibers changed
+ */
+std::shared_ptr< const mitk::FiberBounds > mitk::FiberBundle::GetFiberBounds() const
+{
+    if (m_FiberBounds == nullptr)
+        m_FiberBounds = std::make_shared< const FiberBounds >(m_Fibers);
+    return m_FiberBounds;
+}
+
 void mitk::FiberBundle::ColorFibersByOrientation()
 {
     //===== FOR WRITING A TEST ========================
@@ -340,32 +334,26 @@ void mitk::FiberBundle::ColorFibersByOrientation()
     //  + one fiber with 0 points
     //=================================================
 
-    vtkPoints* extrPoints = nullptr;
-    extrPoints = m_FiberPolyData->GetPoints();
-    int numOfPoints = 0;
-    if (extrPoints!=nullptr)
-        numOfPoints = extrPoints->GetNumberOfPoints();
+    int numOfPoints = m_Fibers.GetNumberOfPoints();
 
     //colors and alpha value for each single point, RGBA = 4 components
-    unsigned char rgba[4] = {0,0,0,0};
     int componentSize = 4;
     m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-    m_FiberColors->Allocate(numOfPoints * componentSize);
     m_FiberColors->SetNumberOfComponents(componentSize);
+    m_FiberColors->SetNumberOfTuples(numOfPoints);
     m_FiberColors->SetName("FIBER_COLORS");
 
-    int numOfFibers = m_FiberPolyData->GetNumberOfLines();
+    int numOfFibers = m_Fibers.GetNumberOfFibers();
     if (numOfFibers < 1)
         return;
+    std::fill_n(m_FiberColors->GetPointer(0), numOfPoints * componentSize, 0);
 
-    /* extract single fibers of fiberBundle */
-    vtkCellArray* fiberList = m_FiberPolyData->GetLines();
-    fiberList->InitTraversal();
+    /* extract single fibers of fiberBundle, the fibers are colored independently */
+#pragma omp parallel for
     for (int fi=0; fi<numOfFibers; ++fi) {
 
-        vtkIdType* idList; // contains the point id's of the line
-        vtkIdType pointsPerFiber; // number of points for current line
-        fiberList->GetNextCell(pointsPerFiber, idList);
+        const float* points = m_Fibers.GetPoints(fi); // x, y, z values of the points of the current line
+        int pointsPerFiber = m_Fibers.GetNumberOfPoints(fi); // number of points for current line
 
         /* single fiber checkpoints: is number of points valid */
         if (pointsPerFiber > 1)
@@ -373,13 +361,15 @@ void mitk::FiberBundle::ColorFibersByOrientation()
             /* operate on points of single fiber */
             for (int i=0; i <pointsPerFiber; ++i)
             {
+                unsigned char* rgba = m_FiberColors->GetPointer(componentSize * (m_Fibers.GetOffset(fi) + i));
+
                 /* process all points elastV[0]ept starting and endpoint for calculating color value take current point, previous point and next point */
                 if (i<pointsPerFiber-1 && i > 0)
                 {
                     /* The color value of the current point is influenced by the previous point and next point. */
-                    vnl_vector_fixed< double, 3 > currentPntvtk(extrPoints->GetPoint(idList[i])[0], extrPoints->GetPoint(idList[i])[1],extrPoints->GetPoint(idList[i])[2]);
-                    vnl_vector_fixed< double, 3 > nextPntvtk(extrPoints->GetPoint(idList[i+1])[0], extrPoints->GetPoint(idList[i+1])[1], extrPoints->GetPoint(idList[i+1])[2]);
-                    vnl_vector_fixed< double, 3 > prevPntvtk(extrPoints->GetPoint(idList[i-1])[0], extrPoints->GetPoint(idList[i-1])[1], extrPoints->GetPoint(idList[i-1])[2]);
+                    vnl_vector_fixed< double, 3 > currentPntvtk(points[3*i], points[3*i+1], points[3*i+2]);
+                    vnl_vector_fixed< double, 3 > nextPntvtk(points[3*i+3], points[3*i+4], points[3*i+5]);
+                    vnl_vector_fixed< double, 3 > prevPntvtk(points[3*i-3], points[3*i-2], points[3*i-1]);
 
                     vnl_vector_fixed< double, 3 > diff1;
                     diff1 = currentPntvtk - nextPntvtk;
@@ -400,8 +390,8 @@ void mitk::FiberBundle::ColorFibersByOrientation()
                 {
                     /* First point has no previous point, therefore only diff1 is taken */
 
-                    vnl_vector_fixed< double, 3 > currentPntvtk(extrPoints->GetPoint(idList[i])[0], extrPoints->GetPoint(idList[i])[1],extrPoints->GetPoint(idList[i])[2]);
-                    vnl_vector_fixed< double, 3 > nextPntvtk(extrPoints->GetPoint(idList[i+1])[0], extrPoints->GetPoint(idList[i+1])[1], extrPoints->GetPoint(idList[i+1])[2]);
+                    vnl_vector_fixed< double, 3 > currentPntvtk(points[3*i], points[3*i+1], points[3*i+2]);
+                    vnl_vector_fixed< double, 3 > nextPntvtk(points[3*i+3], points[3*i+4], points[3*i+5]);
 
                     vnl_vector_fixed< double, 3 > diff1;
                     diff1 = currentPntvtk - nextPntvtk;
@@ -415,8 +405,8 @@ void mitk::FiberBundle::ColorFibersByOrientation()
                 else if (i==pointsPerFiber-1)
                 {
                     /* Last point has no next point, therefore only diff2 is taken */
-                    vnl_vector_fixed< double, 3 > currentPntvtk(extrPoints->GetPoint(idList[i])[0], extrPoints->GetPoint(idList[i])[1],extrPoints->GetPoint(idList[i])[2]);
-                    vnl_vector_fixed< double, 3 > prevPntvtk(extrPoints->GetPoint(idList[i-1])[0], extrPoints->GetPoint(idList[i-1])[1], extrPoints->GetPoint(idList[i-1])[2]);
+                    vnl_vector_fixed< double, 3 > currentPntvtk(points[3*i], points[3*i+1], points[3*i+2]);
+                    vnl_vector_fixed< double, 3 > prevPntvtk(points[3*i-3], points[3*i-2], points[3*i-1]);
 
                     vnl_vector_fixed< double, 3 > diff2;
                     diff2 = currentPntvtk - prevPntvtk;
@@ -427,7 +417,6 @@ void mitk::FiberBundle::ColorFibersByOrientation()
                     rgba[2] = (unsigned char) (255.0 * std::fabs(diff2[2]));
                     rgba[3] = (unsigned char) (255.0);
                 }
-                m_FiberColors->InsertTupleValue(idList[i], rgba);
             }
         }
         else if (pointsPerFiber == 1)
@@ -453,7 +442,7 @@ void mitk::FiberBundle::ColorFibersByCurvature(bool minMaxNorm)
     unsigned char rgba[4] = {0,0,0,0};
     int componentSize = 4;
     m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-    m_FiberColors->Allocate(m_FiberPolyData->GetNumberOfPoints() * componentSize);
+    m_FiberColors->Allocate(m_Fibers.GetNumberOfPoints() * componentSize);
     m_FiberColors->SetNumberOfComponents(componentSize);
     m_FiberColors->SetName("FIBER_COLORS");
 
@@ -468,11 +457,11 @@ void mitk::FiberBundle::ColorFibersByCurvature(bool minMaxNorm)
     double min = 1;
     double max = 0;
     MITK_INFO << "Coloring fibers by curvature";
-    boost::progress_display disp(m_FiberPolyData->GetNumberOfCells());
-    for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+    boost::progress_display disp(m_Fibers.GetNumberOfFibers());
+    for (int i=0; i<m_Fibers.GetNumberOfFibers(); i++)
     {
         ++disp;
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
+        vtkCell* cell = GetFiberPolyData()->GetCell(i);
         int numPoints = cell->GetNumberOfPoints();
         vtkPoints* points = cell->GetPoints();
 
@@ -545,9 +534,9 @@ void mitk::FiberBundle::ColorFibersByCurvature(bool minMaxNorm)
         }
     }
     unsigned int count = 0;
-    for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+    for (int i=0; i<m_Fibers.GetNumberOfFibers(); i++)
     {
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
+        vtkCell* cell = GetFiberPolyData()->GetCell(i);
         int numPoints = cell->GetNumberOfPoints();
         for (int j=0; j<numPoints; j++)
         {
@@ -601,14 +590,14 @@ template <typename TPixel>
 void mitk::FiberBundle::ColorFibersByScalarMap(const mitk::PixelType, mitk::Image::Pointer image, bool opacity)
 {
     m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-    m_FiberColors->Allocate(m_FiberPolyData->GetNumberOfPoints() * 4);
+    m_FiberColors->Allocate(m_Fibers.GetNumberOfPoints() * 4);
     m_FiberColors->SetNumberOfComponents(4);
     m_FiberColors->SetName("FIBER_COLORS");
 
     mitk::ImagePixelReadAccessor<TPixel,3> readimage(image, image->GetVolumeData(0));
 
     unsigned char rgba[4] = {0,0,0,0};
-    vtkPoints* pointSet = m_FiberPolyData->GetPoints();
+    vtkPoints* pointSet = GetFiberPolyData()->GetPoints();
 
     mitk::LookupTable::Pointer mitkLookup = mitk::LookupTable::New();
     vtkSmartPointer<vtkLookupTable> lookupTable = vtkSmartPointer<vtkLookupTable>::New();
@@ -617,7 +606,7 @@ void mitk::FiberBundle::ColorFibersByScalarMap(const mitk::PixelType, mitk::Imag
     mitkLookup->SetVtkLookupTable(lookupTable);
     mitkLookup->SetType(mitk::LookupTable::JET);
 
-    for(long i=0; i<m_FiberPolyData->GetNumberOfPoints(); ++i)
+    for(long i=0; i<m_Fibers.GetNumberOfPoints(); ++i)
     {
         Point3D px;
         px[0] = pointSet->GetPoint(i)[0];
@@ -644,12 +633,12 @@ void mitk::FiberBundle::ColorFibersByScalarMap(const mitk::PixelType, mitk::Imag
 void mitk::FiberBundle::SetFiberColors(float r, float g, float b, float alpha)
 {
     m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
-    m_FiberColors->Allocate(m_FiberPolyData->GetNumberOfPoints() * 4);
+    m_FiberColors->Allocate(m_Fibers.GetNumberOfPoints() * 4);
     m_FiberColors->SetNumberOfComponents(4);
     m_FiberColors->SetName("FIBER_COLORS");
 
     unsigned char rgba[4] = {0,0,0,0};
-    for(long i=0; i<m_FiberPolyData->GetNumberOfPoints(); ++i)
+    for(long i=0; i<m_Fibers.GetNumberOfPoints(); ++i)
     {
         rgba[0] = (unsigned char) r;
         rgba[1] = (unsigned char) g;
@@ -663,11 +652,8 @@ void mitk::FiberBundle::SetFiberColors(float r, float g, float b, float alpha)
 
 void mitk::FiberBundle::GenerateFiberIds()
 {
-    if (m_FiberPolyData == nullptr)
-        return;
-
     vtkSmartPointer<vtkIdFilter> idFiberFilter = vtkSmartPointer<vtkIdFilter>::New();
-    idFiberFilter->SetInputData(m_FiberPolyData);
+    idFiberFilter->SetInputData(this->GetFiberPolyData());
     idFiberFilter->CellIdsOn();
     //  idFiberFilter->PointIdsOn(); // point id's are not needed
     idFiberFilter->SetIdsArrayName(FIBER_ID_ARRAY);
@@ -680,7 +666,7 @@ void mitk::FiberBundle::GenerateFiberIds()
 
 mitk::FiberBundle::Pointer mitk::FiberBundle::ExtractFiberSubset(ItkUcharImgType* mask, bool anyPoint, bool invert, bool bothEnds, float fraction)
 {
-    vtkSmartPointer<vtkPolyData> PolyData = m_FiberPolyData;
+    mitk::FiberBundle::Pointer fibCopy = this;
     if (anyPoint)
     {
         float minSpacing = 1;
@@ -691,28 +677,27 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::ExtractFiberSubset(ItkUcharImgType
         else
             minSpacing = mask->GetSpacing()[2];
 
-        mitk::FiberBundle::Pointer fibCopy = this->GetDeepCopy();
+        fibCopy = this->GetDeepCopy();
         fibCopy->ResampleLinear(minSpacing/5);
-        PolyData = fibCopy->GetFiberPolyData();
     }
-    vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-    vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+    const FiberContainer& fibers = fibCopy->GetFibers();
+
+    // the fibers are tested independently, the selected ones are copied afterwards in their original order
+    std::vector< unsigned char > extract(m_NumFibers, 0);
 
     MITK_INFO << "Extracting fibers";
     boost::progress_display disp(m_NumFibers);
+#pragma omp parallel for
     for (int i=0; i<m_NumFibers; i++)
     {
+#pragma omp critical
         ++disp;
 
-        vtkCell* cell = PolyData->GetCell(i);
-        int numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
-
-        vtkCell* cellOriginal = m_FiberPolyData->GetCell(i);
-        int numPointsOriginal = cellOriginal->GetNumberOfPoints();
-        vtkPoints* pointsOriginal = cellOriginal->GetPoints();
+        int numPoints = fibers.GetNumberOfPoints(i);
+        const float* points = fibers.GetPoints(i);
 
-        vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
+        int numPointsOriginal = m_Fibers.GetNumberOfPoints(i);
+        const float* pointsOriginal = m_Fibers.GetPoints(i);
 
         if (numPoints>1 && numPointsOriginal)
         {
@@ -724,7 +709,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::ExtractFiberSubset(ItkUcharImgType
                 {
                     for (int j=0; j<numPoints; j++)
                     {
-                        double* p = points->GetPoint(j);
+                        const float* p = points + 3*j;
 
                         itk::Point<float, 3> itkP;
                         itkP[0] = p[0]; itkP[1] = p[1]; itkP[2] = p[2];
@@ -746,21 +731,14 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::ExtractFiberSubset(ItkUcharImgType
                         current_fraction = (float)inside/(inside+outside);
 
                     if (current_fraction>fraction)
-                    {
-                        for (int k=0; k<numPoints; k++)
-                        {
-                            double* p = points->GetPoint(k);
-                            vtkIdType id = vtkNewPoints->InsertNextPoint(p);
-                            container->GetPointIds()->InsertNextId(id);
-                        }
-                    }
+                        extract[i] = 1;
                 }
                 else
                 {
                     bool includeFiber = true;
                     for (int j=0; j<numPoints; j++)
                     {
-                        double* p = points->GetPoint(j);
+                        const float* p = points + 3*j;
 
                         itk::Point<float, 3> itkP;
                         itkP[0] = p[0]; itkP[1] = p[1]; itkP[2] = p[2];
@@ -777,26 +755,18 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::ExtractFiberSubset(ItkUcharImgType
                             outside++;
                     }
                     if (includeFiber)
-                    {
-
-                        for (int k=0; k<numPoints; k++)
-                        {
-                            double* p = points->GetPoint(k);
-                            vtkIdType id = vtkNewPoints->InsertNextPoint(p);
-                            container->GetPointIds()->InsertNextId(id);
-                        }
-                    }
+                        extract[i] = 1;
                 }
             }
             else
             {
-                double* start = pointsOriginal->GetPoint(0);
+                const float* start = pointsOriginal;
                 itk::Point<float, 3> itkStart;
                 itkStart[0] = start[0]; itkStart[1] = start[1]; itkStart[2] = start[2];
                 itk::Index<3> idxStart;
                 mask->TransformPhysicalPointToIndex(itkStart, idxStart);
 
-                double* end = pointsOriginal->GetPoint(numPointsOriginal-1);
+                const float* end = pointsOriginal + 3*(numPointsOriginal-1);
                 itk::Point<float, 3> itkEnd;
                 itkEnd[0] = end[0]; itkEnd[1] = end[1]; itkEnd[2] = end[2];
                 itk::Index<3> idxEnd;
@@ -807,62 +777,46 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::ExtractFiberSubset(ItkUcharImgType
                     if (bothEnds)
                     {
                         if ( !mask->GetPixel(idxStart)>0 && !mask->GetPixel(idxEnd)>0 )
-                        {
-                            for (int j=0; j<numPointsOriginal; j++)
-                            {
-                                double* p = pointsOriginal->GetPoint(j);
-                                vtkIdType id = vtkNewPoints->InsertNextPoint(p);
-                                container->GetPointIds()->InsertNextId(id);
-                            }
-                        }
+                            extract[i] = 1;
                     }
                     else if ( !mask->GetPixel(idxStart)>0 || !mask->GetPixel(idxEnd)>0 )
-                    {
-                        for (int j=0; j<numPointsOriginal; j++)
-                        {
-                            double* p = pointsOriginal->GetPoint(j);
-                            vtkIdType id = vtkNewPoints->InsertNextPoint(p);
-                            container->GetPointIds()->InsertNextId(id);
-                        }
-                    }
+                        extract[i] = 1;
                 }
                 else
                 {
                     if (bothEnds)
                     {
                         if ( mask->GetPixel(idxStart)>0 && mask->GetPixel(idxEnd)>0 && mask->GetLargestPossibleRegion().IsInside(idxStart) && mask->GetLargestPossibleRegion().IsInside(idxEnd) )
-                        {
-                            for (int j=0; j<numPointsOriginal; j++)
-                            {
-                                double* p = pointsOriginal->GetPoint(j);
-                                vtkIdType id = vtkNewPoints->InsertNextPoint(p);
-                                container->GetPointIds()->InsertNextId(id);
-                            }
-                        }
+                            extract[i] = 1;
                     }
                     else if ( (mask->GetPixel(idxStart)>0 && mask->GetLargestPossibleRegion().IsInside(idxStart)) || (mask->GetPixel(idxEnd)>0 && mask->GetLargestPossibleRegion().IsInside(idxEnd)) )
-                    {
-                        for (int j=0; j<numPointsOriginal; j++)
-                        {
-                            double* p = pointsOriginal->GetPoint(j);
-                            vtkIdType id = vtkNewPoints->InsertNextPoint(p);
-                            container->GetPointIds()->InsertNextId(id);
-                        }
-                    }
+                        extract[i] = 1;
                 }
             }
         }
-
-        vtkNewCells->InsertNextCell(container);
     }
 
-    if (vtkNewCells->GetNumberOfCells()<=0)
+    if (m_NumFibers<=0)
         return nullptr;
 
-    vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
-    newPolyData->SetPoints(vtkNewPoints);
-    newPolyData->SetLines(vtkNewCells);
-    return mitk::FiberBundle::New(newPolyData);
+    // the any-point test copies the resampled fibers, the endpoint test the original ones
+    const FiberContainer& source = anyPoint ? fibers : m_Fibers;
+    FiberContainer newFibers;
+    std::vector< float > weights;
+    for (int i=0; i<m_NumFibers; i++)
+    {
+        if (extract[i])
+        {
+            newFibers.AddFiber(source, i);
+            weights.push_back(this->GetFiberWeight(i));
+        }
+    }
+
+    mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New();
+    newFib->SetFibers(std::move(newFibers));
+    for (unsigned int i=0; i<weights.size(); i++)
+        newFib->SetFiberWeight(i, weights.at(i));
+    return newFib;
 }
 
 mitk::FiberBundle::Pointer mitk::FiberBundle::RemoveFibersOutside(ItkUcharImgType* mask, bool invert)
@@ -1045,7 +999,7 @@ std::vector<long> mitk::FiberBundle::ExtractFiberIdSubset(DataNode *roi, DataSto
             for (int i=0; i<m_NumFibers; i++)
             {
                 ++disp ;
-                vtkCell* cell = m_FiberPolyData->GetCell(i);
+                vtkCell* cell = GetFiberPolyData()->GetCell(i);
                 int numPoints = cell->GetNumberOfPoints();
                 vtkPoints* points = cell->GetPoints();
 
@@ -1091,7 +1045,7 @@ std::vector<long> mitk::FiberBundle::ExtractFiberIdSubset(DataNode *roi, DataSto
             for (int i=0; i<m_NumFibers; i++)
             {
                 ++disp ;
-                vtkCell* cell = m_FiberPolyData->GetCell(i);
+                vtkCell* cell = GetFiberPolyData()->GetCell(i);
                 int numPoints = cell->GetNumberOfPoints();
                 vtkPoints* points = cell->GetPoints();
 
@@ -1129,19 +1083,13 @@ std::vector<long> mitk::FiberBundle::ExtractFiberIdSubset(DataNode *roi, DataSto
 
 void mitk::FiberBundle::UpdateFiberGeometry()
 {
-    vtkSmartPointer<vtkCleanPolyData> cleaner = vtkSmartPointer<vtkCleanPolyData>::New();
-    cleaner->SetInputData(m_FiberPolyData);
-    cleaner->PointMergingOff();
-    cleaner->Update();
-    m_FiberPolyData = cleaner->GetOutput();
-
     m_FiberLengths.clear();
     m_MeanFiberLength = 0;
     m_MedianFiberLength = 0;
     m_LengthStDev = 0;
-    m_NumFibers = m_FiberPolyData->GetNumberOfCells();
+    m_NumFibers = m_Fibers.GetNumberOfFibers();
 
-    if (m_FiberColors==nullptr || m_FiberColors->GetNumberOfTuples()!=m_FiberPolyData->GetNumberOfPoints())
+    if (m_FiberColors==nullptr || m_FiberColors->GetNumberOfTuples()!=m_Fibers.GetNumberOfPoints())
         this->ColorFibersByOrientation();
 
     if (m_FiberWeights->GetSize()!=m_NumFibers)
@@ -1164,39 +1112,24 @@ void mitk::FiberBundle::UpdateFiberGeometry()
         return;
     }
     double b[6];
-    m_FiberPolyData->GetBounds(b);
+    m_Fibers.GetBounds(b);
 
     // calculate statistics
-    for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
-    {
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        int p = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
-        float length = 0;
-        for (int j=0; j<p-1; j++)
-        {
-            double p1[3];
-            points->GetPoint(j, p1);
-            double p2[3];
-            points->GetPoint(j+1, p2);
+    m_FiberLengths.resize(m_NumFibers);
+#pragma omp parallel for
+    for (int i=0; i<m_NumFibers; i++)
+        m_FiberLengths[i] = m_Fibers.GetLength(i);
 
-            float dist = std::sqrt((p1[0]-p2[0])*(p1[0]-p2[0])+(p1[1]-p2[1])*(p1[1]-p2[1])+(p1[2]-p2[2])*(p1[2]-p2[2]));
-            length += dist;
-        }
-        m_FiberLengths.push_back(length);
+    m_MinFiberLength = m_FiberLengths.at(0);
+    m_MaxFiberLength = m_FiberLengths.at(0);
+    for (int i=0; i<m_NumFibers; i++)
+    {
+        float length = m_FiberLengths.at(i);
         m_MeanFiberLength += length;
-        if (i==0)
-        {
+        if (length<m_MinFiberLength)
             m_MinFiberLength = length;
+        if (length>m_MaxFiberLength)
             m_MaxFiberLength = length;
-        }
-        else
-        {
-            if (length<m_MinFiberLength)
-                m_MinFiberLength = length;
-            if (length>m_MaxFiberLength)
-                m_MaxFiberLength = length;
-        }
     }
     m_MeanFiberLength /= m_NumFibers;
 
@@ -1251,7 +1184,7 @@ void mitk::FiberBundle::SetFiberWeight(unsigned int fiber, float weight)
 
 void mitk::FiberBundle::SetFiberColors(vtkSmartPointer<vtkUnsignedCharArray> fiberColors)
 {
-    for(long i=0; i<m_FiberPolyData->GetNumberOfPoints(); ++i)
+    for(long i=0; i<m_Fibers.GetNumberOfPoints(); ++i)
     {
         unsigned char source[4] = {0,0,0,0};
         fiberColors->GetTupleValue(i, source);
@@ -1372,7 +1305,7 @@ void mitk::FiberBundle::TransformFibers(double rx, double ry, double rz, double
 
     for (int i=0; i<m_NumFibers; i++)
     {
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
+        vtkCell* cell = GetFiberPolyData()->GetCell(i);
         int numPoints = cell->GetNumberOfPoints();
         vtkPoints* points = cell->GetPoints();
 
@@ -1394,10 +1327,10 @@ void mitk::FiberBundle::TransformFibers(double rx, double ry, double rz, double
         vtkNewCells->InsertNextCell(container);
     }
 
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
-    this->SetFiberPolyData(m_FiberPolyData, true);
+    vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+    newPolyData->SetPoints(vtkNewPoints);
+    newPolyData->SetLines(vtkNewCells);
+    this->SetFiberPolyData(newPolyData, true);
 }
 
 void mitk::FiberBundle::RotateAroundAxis(double x, double y, double z)
@@ -1432,7 +1365,7 @@ void mitk::FiberBundle::RotateAroundAxis(double x, double y, double z)
 
     for (int i=0; i<m_NumFibers; i++)
     {
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
+        vtkCell* cell = GetFiberPolyData()->GetCell(i);
         int numPoints = cell->GetNumberOfPoints();
         vtkPoints* points = cell->GetPoints();
 
@@ -1454,10 +1387,10 @@ void mitk::FiberBundle::RotateAroundAxis(double x, double y, double z)
         vtkNewCells->InsertNextCell(container);
     }
 
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
-    this->SetFiberPolyData(m_FiberPolyData, true);
+    vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+    newPolyData->SetPoints(vtkNewPoints);
+    newPolyData->SetLines(vtkNewCells);
+    this->SetFiberPolyData(newPolyData, true);
 }
 
 void mitk::FiberBundle::ScaleFibers(double x, double y, double z, bool subtractCenter)
@@ -1474,7 +1407,7 @@ void mitk::FiberBundle::ScaleFibers(double x, double y, double z, bool subtractC
     for (int i=0; i<m_NumFibers; i++)
     {
         ++disp ;
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
+        vtkCell* cell = GetFiberPolyData()->GetCell(i);
         int numPoints = cell->GetNumberOfPoints();
         vtkPoints* points = cell->GetPoints();
 
@@ -1499,10 +1432,10 @@ void mitk::FiberBundle::ScaleFibers(double x, double y, double z, bool subtractC
         vtkNewCells->InsertNextCell(container);
     }
 
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
-    this->SetFiberPolyData(m_FiberPolyData, true);
+    vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+    newPolyData->SetPoints(vtkNewPoints);
+    newPolyData->SetLines(vtkNewCells);
+    this->SetFiberPolyData(newPolyData, true);
 }
 
 void mitk::FiberBundle::TranslateFibers(double x, double y, double z)
@@ -1512,7 +1445,7 @@ void mitk::FiberBundle::TranslateFibers(double x, double y, double z)
 
     for (int i=0; i<m_NumFibers; i++)
     {
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
+        vtkCell* cell = GetFiberPolyData()->GetCell(i);
         int numPoints = cell->GetNumberOfPoints();
         vtkPoints* points = cell->GetPoints();
 
@@ -1529,10 +1462,10 @@ void mitk::FiberBundle::TranslateFibers(double x, double y, double z)
         vtkNewCells->InsertNextCell(container);
     }
 
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
-    this->SetFiberPolyData(m_FiberPolyData, true);
+    vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+    newPolyData->SetPoints(vtkNewPoints);
+    newPolyData->SetLines(vtkNewCells);
+    this->SetFiberPolyData(newPolyData, true);
 }
 
 void mitk::FiberBundle::MirrorFibers(unsigned int axis)
@@ -1549,7 +1482,7 @@ void mitk::FiberBundle::MirrorFibers(unsigned int axis)
     for (int i=0; i<m_NumFibers; i++)
     {
         ++disp;
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
+        vtkCell* cell = GetFiberPolyData()->GetCell(i);
         int numPoints = cell->GetNumberOfPoints();
         vtkPoints* points = cell->GetPoints();
 
@@ -1564,10 +1497,10 @@ void mitk::FiberBundle::MirrorFibers(unsigned int axis)
         vtkNewCells->InsertNextCell(container);
     }
 
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
-    this->SetFiberPolyData(m_FiberPolyData, true);
+    vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+    newPolyData->SetPoints(vtkNewPoints);
+    newPolyData->SetLines(vtkNewCells);
+    this->SetFiberPolyData(newPolyData, true);
 }
 
 void mitk::FiberBundle::RemoveDir(vnl_vector_fixed<double,3> dir, double threshold)
@@ -1576,11 +1509,11 @@ void mitk::FiberBundle::RemoveDir(vnl_vector_fixed<double,3> dir, double thresho
     vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
     vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
 
-    boost::progress_display disp(m_FiberPolyData->GetNumberOfCells());
-    for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+    boost::progress_display disp(m_Fibers.GetNumberOfFibers());
+    for (int i=0; i<m_Fibers.GetNumberOfFibers(); i++)
     {
         ++disp ;
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
+        vtkCell* cell = GetFiberPolyData()->GetCell(i);
         int numPoints = cell->GetNumberOfPoints();
         vtkPoints* points = cell->GetPoints();
 
@@ -1623,11 +1556,10 @@ void mitk::FiberBundle::RemoveDir(vnl_vector_fixed<double,3> dir, double thresho
         }
     }
 
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
-
-    this->SetFiberPolyData(m_FiberPolyData, true);
+    vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+    newPolyData->SetPoints(vtkNewPoints);
+    newPolyData->SetLines(vtkNewCells);
+    this->SetFiberPolyData(newPolyData, true);
 
     //    UpdateColorCoding();
     //    UpdateFiberGeometry();
@@ -1642,11 +1574,11 @@ bool mitk::FiberBundle::ApplyCurvatureThreshold(float minRadius, bool deleteFibe
     vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
 
     MITK_INFO << "Applying curvature threshold";
-    boost::progress_display disp(m_FiberPolyData->GetNumberOfCells());
-    for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+    boost::progress_display disp(m_Fibers.GetNumberOfFibers());
+    for (int i=0; i<m_Fibers.GetNumberOfFibers(); i++)
     {
         ++disp ;
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
+        vtkCell* cell = GetFiberPolyData()->GetCell(i);
         int numPoints = cell->GetNumberOfPoints();
         vtkPoints* points = cell->GetPoints();
 
@@ -1706,10 +1638,10 @@ bool mitk::FiberBundle::ApplyCurvatureThreshold(float minRadius, bool deleteFibe
     if (vtkNewCells->GetNumberOfCells()<=0)
         return false;
 
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
-    this->SetFiberPolyData(m_FiberPolyData, true);
+    vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+    newPolyData->SetPoints(vtkNewPoints);
+    newPolyData->SetLines(vtkNewCells);
+    this->SetFiberPolyData(newPolyData, true);
     return true;
 }
 
@@ -1728,40 +1660,29 @@ bool mitk::FiberBundle::RemoveShortFibers(float lengthInMM)
         return false;
     }
 
-    vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-    vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
+    FiberContainer newFibers;
+    std::vector< float > weights;
     float min = m_MaxFiberLength;
 
     boost::progress_display disp(m_NumFibers);
     for (int i=0; i<m_NumFibers; i++)
     {
         ++disp;
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        int numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
-
         if (m_FiberLengths.at(i)>=lengthInMM)
         {
-            vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-            for (int j=0; j<numPoints; j++)
-            {
-                double* p = points->GetPoint(j);
-                vtkIdType id = vtkNewPoints->InsertNextPoint(p);
-                container->GetPointIds()->InsertNextId(id);
-            }
-            vtkNewCells->InsertNextCell(container);
+            newFibers.AddFiber(m_Fibers, i);
+            weights.push_back(m_FiberWeights->GetValue(i));
             if (m_FiberLengths.at(i)<min)
                 min = m_FiberLengths.at(i);
         }
     }
 
-    if (vtkNewCells->GetNumberOfCells()<=0)
+    if (newFibers.GetNumberOfFibers()<=0)
         return false;
 
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
-    this->SetFiberPolyData(m_FiberPolyData, true);
+    this->SetFibers(std::move(newFibers), true);
+    for (unsigned int i=0; i<weights.size(); i++)
+        this->SetFiberWeight(i, weights.at(i));
     return true;
 }
 
@@ -1781,7 +1702,7 @@ bool mitk::FiberBundle::RemoveLongFibers(float lengthInMM)
     for (int i=0; i<m_NumFibers; i++)
     {
         ++disp;
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
+        vtkCell* cell = GetFiberPolyData()->GetCell(i);
         int numPoints = cell->GetNumberOfPoints();
         vtkPoints* points = cell->GetPoints();
 
@@ -1801,10 +1722,10 @@ bool mitk::FiberBundle::RemoveLongFibers(float lengthInMM)
     if (vtkNewCells->GetNumberOfCells()<=0)
         return false;
 
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkNewPoints);
-    m_FiberPolyData->SetLines(vtkNewCells);
-    this->SetFiberPolyData(m_FiberPolyData, true);
+    vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+    newPolyData->SetPoints(vtkNewPoints);
+    newPolyData->SetLines(vtkNewCells);
+    this->SetFiberPolyData(newPolyData, true);
     return true;
 }
 
@@ -1836,7 +1757,7 @@ void mitk::FiberBundle::ResampleSpline(float pointDistance, double tension, doub
             length = m_FiberLengths.at(i);
             weight = m_FiberWeights->GetValue(i);
             ++disp;
-            vtkCell* cell = m_FiberPolyData->GetCell(i);
+            vtkCell* cell = GetFiberPolyData()->GetCell(i);
             int numPoints = cell->GetNumberOfPoints();
             vtkPoints* points = cell->GetPoints();
             for (int j=0; j<numPoints; j++)
@@ -1886,10 +1807,10 @@ void mitk::FiberBundle::ResampleSpline(float pointDistance, double tension, doub
     }
 
     SetFiberWeights(newFiberWeights);
-    m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-    m_FiberPolyData->SetPoints(vtkSmoothPoints);
-    m_FiberPolyData->SetLines(vtkSmoothCells);
-    this->SetFiberPolyData(m_FiberPolyData, true);
+    vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+    newPolyData->SetPoints(vtkSmoothPoints);
+    newPolyData->SetLines(vtkSmoothCells);
+    this->SetFiberPolyData(newPolyData, true);
 }
 
 void mitk::FiberBundle::ResampleSpline(float pointDistance)
@@ -1899,58 +1820,38 @@ void mitk::FiberBundle::ResampleSpline(float pointDistance)
 
 unsigned long mitk::FiberBundle::GetNumberOfPoints()
 {
-    unsigned long points = 0;
-    for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
-    {
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        points += cell->GetNumberOfPoints();
-    }
-    return points;
+    return m_Fibers.GetNumberOfPoints();
 }
 
 void mitk::FiberBundle::Compress(float error)
 {
-    vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-    vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-
     MITK_INFO << "Compressing fibers";
     unsigned long numRemovedPoints = 0;
-    boost::progress_display disp(m_FiberPolyData->GetNumberOfCells());
-    vtkSmartPointer<vtkFloatArray> newFiberWeights = vtkSmartPointer<vtkFloatArray>::New();
-    newFiberWeights->SetName("FIBER_WEIGHTS");
-    newFiberWeights->SetNumberOfValues(m_NumFibers);
-
-#pragma omp parallel for
-    for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
-    {
+    boost::progress_display disp(m_NumFibers);
 
-        std::vector< vnl_vector_fixed< double, 3 > > vertices;
-        float weight = 1;
+    // every thread writes the compressed fibers into separate buffers, which keeps the fiber order
+    std::vector< std::vector< float > > newFibers(m_NumFibers);
 
+#pragma omp parallel for reduction(+:numRemovedPoints)
+    for (int i=0; i<m_NumFibers; i++)
+    {
 #pragma omp critical
-        {
-            ++disp;
-            weight = m_FiberWeights->GetValue(i);
-            vtkCell* cell = m_FiberPolyData->GetCell(i);
-            int numPoints = cell->GetNumberOfPoints();
-            vtkPoints* points = cell->GetPoints();
+        ++disp;
 
-            for (int j=0; j<numPoints; j++)
-            {
-                double cand[3];
-                points->GetPoint(j, cand);
-                vnl_vector_fixed< double, 3 > candV;
-                candV[0]=cand[0]; candV[1]=cand[1]; candV[2]=cand[2];
-                vertices.push_back(candV);
-            }
-        }
+        int numPoints = m_Fibers.GetNumberOfPoints(i);
+        const float* points = m_Fibers.GetPoints(i);
+        if (numPoints<=0)
+            continue;
+
+        std::vector< vnl_vector_fixed< double, 3 > > vertices;
+        vertices.reserve(numPoints);
+        for (int j=0; j<numPoints; j++)
+            vertices.push_back(vnl_vector_fixed< double, 3 >(points[3*j], points[3*j+1], points[3*j+2]));
 
         // calculate curvatures
-        int numPoints = vertices.size();
         std::vector< int > removedPoints; removedPoints.resize(numPoints, 0);
         removedPoints[0]=-1; removedPoints[numPoints-1]=-1;
 
-        vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
         int remCounter = 0;
 
         bool pointFound = true;
@@ -2010,81 +1911,52 @@ void mitk::FiberBundle::Compress(float error)
             }
         }
 
+        std::vector< float >& newFiber = newFibers[i];
+        newFiber.reserve(3*(numPoints-remCounter));
         for (int j=0; j<numPoints; j++)
         {
             if (removedPoints[j]<=0)
-            {
-#pragma omp critical
-                {
-                    vtkIdType id = vtkNewPoints->InsertNextPoint(vertices.at(j).data_block());
-                    container->GetPointIds()->InsertNextId(id);
-                }
-            }
+                AppendPoint(newFiber, vertices.at(j));
         }
 
-#pragma omp critical
-        {
-            newFiberWeights->SetValue(vtkNewCells->GetNumberOfCells(), weight);
-            numRemovedPoints += remCounter;
-            vtkNewCells->InsertNextCell(container);
-        }
+        numRemovedPoints += remCounter;
     }
 
-    if (vtkNewCells->GetNumberOfCells()>0)
+    if (m_NumFibers>0)
     {
         MITK_INFO << "Removed points: " << numRemovedPoints;
-        SetFiberWeights(newFiberWeights);
-        m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-        m_FiberPolyData->SetPoints(vtkNewPoints);
-        m_FiberPolyData->SetLines(vtkNewCells);
-        this->SetFiberPolyData(m_FiberPolyData, true);
+        this->SetFibers(FiberContainer(newFibers), true);
     }
 }
 
 void mitk::FiberBundle::ResampleLinear(double pointDistance)
 {
-    vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
-    vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
-
     MITK_INFO << "Resampling fibers (linear)";
-    boost::progress_display disp(m_FiberPolyData->GetNumberOfCells());
-    vtkSmartPointer<vtkFloatArray> newFiberWeights = vtkSmartPointer<vtkFloatArray>::New();
-    newFiberWeights->SetName("FIBER_WEIGHTS");
-    newFiberWeights->SetNumberOfValues(m_NumFibers);
+    boost::progress_display disp(m_NumFibers);
+
+    // every thread writes the resampled fibers into separate buffers, which keeps the fiber order
+    std::vector< std::vector< float > > newFibers(m_NumFibers);
 
 #pragma omp parallel for
-    for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+    for (int i=0; i<m_NumFibers; i++)
     {
-
-        std::vector< vnl_vector_fixed< double, 3 > > vertices;
-        float weight = 1;
-
 #pragma omp critical
-        {
-            ++disp;
-            weight = m_FiberWeights->GetValue(i);
-            vtkCell* cell = m_FiberPolyData->GetCell(i);
-            int numPoints = cell->GetNumberOfPoints();
-            vtkPoints* points = cell->GetPoints();
+        ++disp;
 
-            for (int j=0; j<numPoints; j++)
-            {
-                double cand[3];
-                points->GetPoint(j, cand);
-                vnl_vector_fixed< double, 3 > candV;
-                candV[0]=cand[0]; candV[1]=cand[1]; candV[2]=cand[2];
-                vertices.push_back(candV);
-            }
-        }
+        int numPoints = m_Fibers.GetNumberOfPoints(i);
+        const float* points = m_Fibers.GetPoints(i);
+        if (numPoints<=0)
+            continue;
 
-        vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
+        std::vector< vnl_vector_fixed< double, 3 > > vertices;
+        vertices.reserve(numPoints);
+        for (int j=0; j<numPoints; j++)
+            vertices.push_back(vnl_vector_fixed< double, 3 >(points[3*j], points[3*j+1], points[3*j+2]));
+
+        std::vector< float >& newFiber = newFibers[i];
         vnl_vector_fixed< double, 3 > lastV = vertices.at(0);
+        AppendPoint(newFiber, lastV);
 
-#pragma omp critical
-        {
-            vtkIdType id = vtkNewPoints->InsertNextPoint(lastV.data_block());
-            container->GetPointIds()->InsertNextId(id);
-        }
         for (unsigned int j=1; j<vertices.size(); j++)
         {
             vnl_vector_fixed< double, 3 > vec = vertices.at(j) - lastV;
@@ -2121,38 +1993,16 @@ void mitk::FiberBundle::ResampleLinear(double pointDistance)
                     j--;
                 }
                 
-#pragma omp critical
-                {
-                    vtkIdType id = vtkNewPoints->InsertNextPoint(newV.data_block());
-                    container->GetPointIds()->InsertNextId(id);
-                }
+                AppendPoint(newFiber, newV);
                 lastV = newV;
             }
             else if (j==vertices.size()-1)
-            {
-#pragma omp critical
-                {
-                    vtkIdType id = vtkNewPoints->InsertNextPoint(vertices.at(j).data_block());
-                    container->GetPointIds()->InsertNextId(id);
-                }
-            }
-        }
-
-#pragma omp critical
-        {
-            newFiberWeights->SetValue(vtkNewCells->GetNumberOfCells(), weight);
-            vtkNewCells->InsertNextCell(container);
+                AppendPoint(newFiber, vertices.at(j));
         }
     }
 
-    if (vtkNewCells->GetNumberOfCells()>0)
-    {
-        SetFiberWeights(newFiberWeights);
-        m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-        m_FiberPolyData->SetPoints(vtkNewPoints);
-        m_FiberPolyData->SetLines(vtkNewCells);
-        this->SetFiberPolyData(m_FiberPolyData, true);
-    }
+    if (m_NumFibers>0)
+        this->SetFibers(FiberContainer(newFibers), true);
 }
 
 // reapply selected colorcoding in case PolyData structure has changed
@@ -2171,15 +2021,14 @@ bool mitk::FiberBundle::Equals(mitk::FiberBundle* fib, double eps)
         return false;
     }
 
+    const FiberContainer& fibers2 = fib->GetFibers();
     for (int i=0; i<m_NumFibers; i++)
     {
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        int numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
+        int numPoints = m_Fibers.GetNumberOfPoints(i);
+        const float* points = m_Fibers.GetPoints(i);
 
-        vtkCell* cell2 = fib->GetFiberPolyData()->GetCell(i);
-        int numPoints2 = cell2->GetNumberOfPoints();
-        vtkPoints* points2 = cell2->GetPoints();
+        int numPoints2 = fibers2.GetNumberOfPoints(i);
+        const float* points2 = fibers2.GetPoints(i);
 
         if (numPoints2!=numPoints)
         {
@@ -2190,8 +2039,8 @@ bool mitk::FiberBundle::Equals(mitk::FiberBundle* fib, double eps)
 
         for (int j=0; j<numPoints; j++)
         {
-            double* p1 = points->GetPoint(j);
-            double* p2 = points2->GetPoint(j);
+            const float* p1 = points + 3*j;
+            const float* p2 = points2 + 3*j;
             if (fabs(p1[0]-p2[0])>eps || fabs(p1[1]-p2[1])>eps || fabs(p1[2]-p2[2])>eps)
             {
                 MITK_INFO << "Unequal points in fiber " << i << " at position " << j << "!";
@@ -26,6 +26,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkPlanarFigure.h>
 #include <mitkPixelTypeTraits.h>
 #include <mitkPlanarFigureComposite.h>
+#include <mitkFiberContainer.h>
+#include <mitkFiberBounds.h>
+#include <mitkFiberLevelOfDetail.h>
+#include <memory>
 
 
 //includes storing fiberdata
@@ -114,6 +118,12 @@ public:
     void SetFiberWeights(vtkSmartPointer<vtkFloatArray> weights);
     void SetFiberPolyData(vtkSmartPointer<vtkPolyData>, bool updateGeometry = true);
     vtkSmartPointer<vtkPolyData> GetFiberPolyData() const;
+    void SetFibers(FiberContainer fibers, bool updateGeometry = true);
+    const FiberContainer& GetFibers() const { return m_Fibers; }
+    /** \brief Level of detail hierarchy for rendering, it is built on the first call after the fibers changed. */
+    std::shared_ptr< const FiberLevelOfDetail > GetLevelOfDetail() const;
+    /** \brief Bounding boxes of the fibers, they are computed on the first call after the fibers changed. */
+    std::shared_ptr< const FiberBounds > GetFiberBounds() const;
     itkGetMacro( NumFibers, int)
     //itkGetMacro( FiberSampling, int)
     int GetNumFibers() const {return m_NumFibers;}
@@ -152,7 +162,14 @@ protected:
 private:
 
     // actual fiber container
-    vtkSmartPointer<vtkPolyData>  m_FiberPolyData;
+    FiberContainer                m_Fibers;
+
+    // vtk view on m_Fibers, created on demand
+    mutable vtkSmartPointer<vtkPolyData>  m_FiberPolyData;
+    // rendering hierarchy of m_Fibers, created on demand
+    mutable std::shared_ptr< const FiberLevelOfDetail > m_LevelOfDetail;
+    // bounding boxes of m_Fibers, created on demand
+    mutable std::shared_ptr< const FiberBounds > m_FiberBounds;
 
     // contains fiber ids
     vtkSmartPointer<vtkDataSet>   m_FiberIdDataSet;
@@ -0,0 +1,286 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFiberContainer.h"
+
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPointData.h>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+#include <utility>
+
+mitk::FiberContainer::FiberContainer()
+    : m_Offsets(1, 0)
+{
+    m_Points = vtkSmartPointer<vtkFloatArray>::New();
+    m_Points->SetNumberOfComponents(3);
+}
+
+mitk::FiberContainer::FiberContainer(vtkPolyData* polyData)
+    : FiberContainer()
+{
+    if (polyData==nullptr || polyData->GetPoints()==nullptr || polyData->GetLines()==nullptr)
+        return;
+
+    vtkPoints* points = polyData->GetPoints();
+    vtkCellArray* lines = polyData->GetLines();
+
+    // collect the position of every non-empty line in the connectivity array
+    std::vector< vtkIdType > locations;
+    locations.reserve(lines->GetNumberOfCells());
+    m_Offsets.reserve(lines->GetNumberOfCells()+1);
+    const vtkIdType* connectivity = lines->GetPointer();
+    const vtkIdType size = lines->GetNumberOfConnectivityEntries();
+    for (vtkIdType location=0; location<size; location += connectivity[location]+1)
+    {
+        if (connectivity[location]<=0)
+            continue;
+        locations.push_back(location);
+        m_Offsets.push_back(m_Offsets.back() + connectivity[location]);
+    }
+
+    m_Points->SetNumberOfTuples(m_Offsets.back());
+    vtkFloatArray* floatPoints = vtkFloatArray::SafeDownCast(points->GetData());
+
+#pragma omp parallel for
+    for (int i=0; i<(int)locations.size(); i++)
+    {
+        const vtkIdType* cell = connectivity + locations[i];
+        float* out = this->GetPoints(i);
+        for (vtkIdType j=0; j<cell[0]; j++)
+        {
+            if (floatPoints!=nullptr)
+                std::memcpy(out + 3*j, floatPoints->GetPointer(3*cell[j+1]), 3*sizeof(float));
+            else
+            {
+                double p[3];
+                points->GetData()->GetTuple(cell[j+1], p);
+                out[3*j] = p[0]; out[3*j+1] = p[1]; out[3*j+2] = p[2];
+            }
+        }
+    }
+}
+
+mitk::FiberContainer::FiberContainer(const std::vector< std::vector< float > >& fibers)
+    : FiberContainer()
+{
+    m_Offsets.reserve(fibers.size()+1);
+    for (const auto& fiber : fibers)
+        m_Offsets.push_back(m_Offsets.back() + fiber.size()/3);
+    m_Points->SetNumberOfTuples(m_Offsets.back());
+
+#pragma omp parallel for
+    for (int i=0; i<(int)fibers.size(); i++)
+        if (!fibers[i].empty())
+            std::memcpy(this->GetPoints(i), fibers[i].data(), fibers[i].size()*sizeof(float));
+}
+
+mitk::FiberContainer::FiberContainer(const FiberContainer& other)
+    : m_Offsets(other.m_Offsets)
+{
+    m_Points = vtkSmartPointer<vtkFloatArray>::New();
+    m_Points->DeepCopy(other.m_Points);
+}
+
+mitk::FiberContainer::FiberContainer(FiberContainer&& other)
+    : m_Points(other.m_Points)
+    , m_Offsets(std::move(other.m_Offsets))
+{
+    other.m_Points = vtkSmartPointer<vtkFloatArray>::New();
+    other.m_Points->SetNumberOfComponents(3);
+    other.m_Offsets.assign(1, 0);
+}
+
+mitk::FiberContainer& mitk::FiberContainer::operator=(const FiberContainer& other)
+{
+    if (this!=&other)
+    {
+        m_Points = vtkSmartPointer<vtkFloatArray>::New();
+        m_Points->DeepCopy(other.m_Points);
+        m_Offsets = other.m_Offsets;
+    }
+    return *this;
+}
+
+mitk::FiberContainer& mitk::FiberContainer::operator=(FiberContainer&& other)
+{
+    if (this!=&other)
+    {
+        m_Points = other.m_Points;
+        m_Offsets = std::move(other.m_Offsets);
+        other.m_Points = vtkSmartPointer<vtkFloatArray>::New();
+        other.m_Points->SetNumberOfComponents(3);
+        other.m_Offsets.assign(1, 0);
+    }
+    return *this;
+}
+
+void mitk::FiberContainer::Reserve(vtkIdType numberOfFibers, vtkIdType numberOfPoints)
+{
+    m_Offsets.reserve(numberOfFibers+1);
+    // Resize keeps the points that are already stored, Allocate would not
+    if (3*numberOfPoints>m_Points->GetSize())
+        m_Points->Resize(numberOfPoints);
+}
+
+vtkIdType mitk::FiberContainer::AddFiber(const float* points, vtkIdType numberOfPoints)
+{
+    if (numberOfPoints>0)
+    {
+        float* out = m_Points->WritePointer(3*m_Offsets.back(), 3*numberOfPoints);
+        std::memcpy(out, points, 3*numberOfPoints*sizeof(float));
+    }
+    m_Offsets.push_back(m_Offsets.back() + numberOfPoints);
+    return this->GetNumberOfFibers()-1;
+}
+
+vtkIdType mitk::FiberContainer::AddFiber(const FiberContainer& other, vtkIdType fiber)
+{
+    if (&other==this)
+    {
+        // adding points may reallocate the point array the fiber is read from
+        std::vector< float > points(other.GetPoints(fiber), other.GetPoints(fiber) + 3*other.GetNumberOfPoints(fiber));
+        return this->AddFiber(points.data(), other.GetNumberOfPoints(fiber));
+    }
+    return this->AddFiber(other.GetPoints(fiber), other.GetNumberOfPoints(fiber));
+}
+
+float mitk::FiberContainer::GetLength(vtkIdType fiber) const
+{
+    const float* p = this->GetPoints(fiber);
+    const vtkIdType numPoints = this->GetNumberOfPoints(fiber);
+    float length = 0;
+    for (vtkIdType j=0; j<numPoints-1; j++, p+=3)
+    {
+        const double dx = p[0]-p[3];
+        const double dy = p[1]-p[4];
+        const double dz = p[2]-p[5];
+        const float dist = std::sqrt(dx*dx+dy*dy+dz*dz);
+        length += dist;
+    }
+    return length;
+}
+
+void mitk::FiberContainer::GetBounds(double bounds[6]) const
+{
+    bounds[0] = bounds[2] = bounds[4] = 1;
+    bounds[1] = bounds[3] = bounds[5] = -1;
+    if (this->GetNumberOfPoints()<=0)
+        return;
+
+    const float* p = m_Points->GetPointer(0);
+    for (int c=0; c<3; c++)
+        bounds[2*c] = bounds[2*c+1] = p[c];
+    for (vtkIdType i=1; i<this->GetNumberOfPoints(); i++)
+    {
+        p += 3;
+        for (int c=0; c<3; c++)
+        {
+            bounds[2*c] = std::min(bounds[2*c], (double)p[c]);
+            bounds[2*c+1] = std::max(bounds[2*c+1], (double)p[c]);
+        }
+    }
+}
+
+vtkSmartPointer<vtkPolyData> mitk::FiberContainer::CreatePolyData() const
+{
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(m_Points);
+
+    // legacy cell layout: number of points followed by the point ids, for every fiber
+    const int numFibers = this->GetNumberOfFibers();
+    vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    connectivity->SetNumberOfValues(this->GetNumberOfPoints() + numFibers);
+    vtkIdType* cells = connectivity->GetPointer(0);
+
+#pragma omp parallel for
+    for (int i=0; i<numFibers; i++)
+    {
+        vtkIdType* cell = cells + m_Offsets[i] + i;
+        cell[0] = this->GetNumberOfPoints(i);
+        for (vtkIdType j=0; j<cell[0]; j++)
+            cell[j+1] = m_Offsets[i] + j;
+    }
+
+    vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+    lines->SetCells(numFibers, connectivity);
+
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetLines(lines);
+    return polyData;
+}
+
+vtkSmartPointer<vtkPolyData> mitk::FiberContainer::CreatePolyData(const std::vector< vtkIdType >& fibers, vtkDataArray* pointData) const
+{
+    const int numFibers = fibers.size();
+    std::vector< vtkIdType > offsets(numFibers+1, 0);
+    for (int i=0; i<numFibers; i++)
+        offsets[i+1] = offsets[i] + this->GetNumberOfPoints(fibers[i]);
+
+    vtkSmartPointer<vtkFloatArray> pointArray = vtkSmartPointer<vtkFloatArray>::New();
+    pointArray->SetNumberOfComponents(3);
+    pointArray->SetNumberOfTuples(offsets.back());
+    vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    connectivity->SetNumberOfValues(offsets.back() + numFibers);
+    vtkIdType* cells = connectivity->GetPointer(0);
+
+    // the tuples are copied bytewise, the arrays have the same type
+    vtkSmartPointer<vtkDataArray> tupleArray;
+    const char* tuplesIn = nullptr;
+    char* tuplesOut = nullptr;
+    vtkIdType tupleSize = 0;
+    if (pointData!=nullptr)
+    {
+        tupleArray.TakeReference(pointData->NewInstance());
+        tupleArray->SetName(pointData->GetName());
+        tupleArray->SetNumberOfComponents(pointData->GetNumberOfComponents());
+        tupleArray->SetNumberOfTuples(offsets.back());
+        tupleSize = pointData->GetNumberOfComponents()*pointData->GetDataTypeSize();
+        tuplesIn = static_cast<const char*>(pointData->GetVoidPointer(0));
+        tuplesOut = static_cast<char*>(tupleArray->GetVoidPointer(0));
+    }
+
+#pragma omp parallel for
+    for (int i=0; i<numFibers; i++)
+    {
+        const vtkIdType numPoints = this->GetNumberOfPoints(fibers[i]);
+        std::memcpy(pointArray->GetPointer(3*offsets[i]), this->GetPoints(fibers[i]), 3*numPoints*sizeof(float));
+
+        vtkIdType* cell = cells + offsets[i] + i;
+        cell[0] = numPoints;
+        for (vtkIdType j=0; j<numPoints; j++)
+            cell[j+1] = offsets[i] + j;
+
+        if (tuplesOut!=nullptr)
+            std::memcpy(tuplesOut + offsets[i]*tupleSize, tuplesIn + m_Offsets[fibers[i]]*tupleSize, numPoints*tupleSize);
+    }
+
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(pointArray);
+    vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+    lines->SetCells(numFibers, connectivity);
+
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetLines(lines);
+    if (tupleArray!=nullptr)
+        polyData->GetPointData()->AddArray(tupleArray);
+    return polyData;
+}
@@ -0,0 +1,96 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITK_FiberContainer_H
+#define _MITK_FiberContainer_H
+
+#include <MitkFiberTrackingExports.h>
+
+#include <vtkSmartPointer.h>
+#include <vtkFloatArray.h>
+#include <vtkPolyData.h>
+#include <vector>
+
+namespace mitk {
+
+/**
+   * \brief Compact storage of the fibers of a tractogram.
+   *
+   * The points of all fibers are stored one after the other in a single float array with three
+   * components (x, y, z). Fiber i consists of the points GetOffset(i) to GetOffset(i+1)-1, so
+   * algorithms can process the fibers in parallel with plain pointers instead of materializing
+   * a vtkCell per fiber.
+   *
+   * The point array is a vtkFloatArray. CreatePolyData() wraps it into a vtkPolyData without
+   * copying the points, only the line connectivity is generated. Copies of a container are deep
+   * copies, use the move operations to hand a container over.
+   */
+class MITKFIBERTRACKING_EXPORT FiberContainer
+{
+public:
+
+    FiberContainer();
+    /** \brief Copies the lines of the poly data. Points that are not part of a line and lines without points are dropped. */
+    explicit FiberContainer(vtkPolyData* polyData);
+    /** \brief Concatenates the fibers, each given as consecutive x, y, z values. Empty fibers are kept, so that the fiber indices do not change. */
+    explicit FiberContainer(const std::vector< std::vector< float > >& fibers);
+
+    FiberContainer(const FiberContainer& other);
+    FiberContainer(FiberContainer&& other);
+    FiberContainer& operator=(const FiberContainer& other);
+    FiberContainer& operator=(FiberContainer&& other);
+
+    /** \brief Preallocates memory, so that fibers can be added without reallocations. */
+    void Reserve(vtkIdType numberOfFibers, vtkIdType numberOfPoints);
+
+    /** \brief Appends a fiber of numberOfPoints x, y, z triples and returns its index. */
+    vtkIdType AddFiber(const float* points, vtkIdType numberOfPoints);
+    /** \brief Appends a fiber of another container and returns its index. */
+    vtkIdType AddFiber(const FiberContainer& other, vtkIdType fiber);
+
+    vtkIdType GetNumberOfFibers() const { return static_cast<vtkIdType>(m_Offsets.size()) - 1; }
+    vtkIdType GetNumberOfPoints() const { return m_Offsets.back(); }
+    vtkIdType GetNumberOfPoints(vtkIdType fiber) const { return m_Offsets[fiber+1] - m_Offsets[fiber]; }
+    vtkIdType GetOffset(vtkIdType fiber) const { return m_Offsets[fiber]; }
+
+    /** \brief Returns the x, y, z values of the points of the fiber. */
+    float* GetPoints(vtkIdType fiber) { return m_Points->GetPointer(3*m_Offsets[fiber]); }
+    const float* GetPoints(vtkIdType fiber) const { return m_Points->GetPointer(3*m_Offsets[fiber]); }
+
+    /** \brief Sum of the distances between consecutive points of the fiber. */
+    float GetLength(vtkIdType fiber) const;
+    void GetBounds(double bounds[6]) const;
+
+    vtkFloatArray* GetPointArray() const { return m_Points; }
+
+    /** \brief Creates poly data with one line per fiber. The points share the point array of this container. */
+    vtkSmartPointer<vtkPolyData> CreatePolyData() const;
+    /**
+     * \brief Creates poly data that only contains the selected fibers. The points of these fibers are copied,
+     * so the renderer does not upload the points of the other fibers. If pointData is given, the tuples that belong
+     * to the copied points are added as point data array of the same name.
+     */
+    vtkSmartPointer<vtkPolyData> CreatePolyData(const std::vector< vtkIdType >& fibers, vtkDataArray* pointData = nullptr) const;
+
+private:
+
+    vtkSmartPointer<vtkFloatArray>  m_Points;
+    std::vector< vtkIdType >        m_Offsets;
+};
+
+} // namespace mitk
+
+#endif /*  _MITK_FiberContainer_H */
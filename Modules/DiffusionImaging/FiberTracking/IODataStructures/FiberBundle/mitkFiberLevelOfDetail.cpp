@@ -0,0 +1,251 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFiberLevelOfDetail.h"
+
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPointData.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    const int MaxNumberOfLevels = 8;
+    const float FinestError = 0.1;
+
+    float GetSegmentDistance(const float* p, const float* a, const float* b)
+    {
+        float ab[3] = {b[0]-a[0], b[1]-a[1], b[2]-a[2]};
+        float ap[3] = {p[0]-a[0], p[1]-a[1], p[2]-a[2]};
+        const float squaredLength = ab[0]*ab[0] + ab[1]*ab[1] + ab[2]*ab[2];
+        float t = 0;
+        if (squaredLength>0)
+            t = std::max(0.0f, std::min(1.0f, (ap[0]*ab[0] + ap[1]*ab[1] + ap[2]*ab[2])/squaredLength));
+        for (int c=0; c<3; c++)
+            ap[c] -= t*ab[c];
+        return std::sqrt(ap[0]*ap[0] + ap[1]*ap[1] + ap[2]*ap[2]);
+    }
+
+    /**
+      * Runs the Douglas-Peucker recursion down to single segments. Every point gets the largest tolerance for which it
+      * is still kept, i.e. the minimum of its own split distance and the split distances of all enclosing splits, so the
+      * simplification for any error e consists of the points with a significance above e.
+      */
+    void ComputeSignificance(const float* points, vtkIdType numPoints, float* significance)
+    {
+        if (numPoints<=0)
+            return;
+        significance[0] = significance[numPoints-1] = std::numeric_limits<float>::max();
+
+        struct Range { vtkIdType first; vtkIdType last; float bound; };
+        std::vector< Range > stack(1, {0, numPoints-1, std::numeric_limits<float>::max()});
+        while (!stack.empty())
+        {
+            Range range = stack.back();
+            stack.pop_back();
+            if (range.last-range.first<2)
+                continue;
+
+            vtkIdType split = range.first+1;
+            float maxDistance = -1;
+            for (vtkIdType j=range.first+1; j<range.last; j++)
+            {
+                const float distance = GetSegmentDistance(points+3*j, points+3*range.first, points+3*range.last);
+                if (distance>maxDistance)
+                {
+                    maxDistance = distance;
+                    split = j;
+                }
+            }
+            const float bound = std::min(maxDistance, range.bound);
+            significance[split] = bound;
+            stack.push_back({range.first, split, bound});
+            stack.push_back({split, range.last, bound});
+        }
+    }
+
+    /** Permutation of 0..n-1 in bit-reversed order, every prefix samples the index range uniformly. */
+    std::vector< vtkIdType > GetBitReversedOrder(vtkIdType n)
+    {
+        int bits = 0;
+        while ((vtkIdType(1)<<bits) < n)
+            bits++;
+
+        std::vector< vtkIdType > order;
+        order.reserve(n);
+        for (vtkIdType i=0; i<(vtkIdType(1)<<bits); i++)
+        {
+            vtkIdType reversed = 0;
+            for (int b=0; b<bits; b++)
+                if (i & (vtkIdType(1)<<b))
+                    reversed |= vtkIdType(1)<<(bits-1-b);
+            if (reversed<n)
+                order.push_back(reversed);
+        }
+        return order;
+    }
+}
+
+mitk::FiberLevelOfDetail::FiberLevelOfDetail(const FiberContainer& fibers)
+{
+    const int numFibers = fibers.GetNumberOfFibers();
+    std::vector< float > significance(fibers.GetNumberOfPoints());
+
+#pragma omp parallel for
+    for (int i=0; i<numFibers; i++)
+    {
+        const float* points = fibers.GetPoints(i);
+        const vtkIdType numPoints = fibers.GetNumberOfPoints(i);
+        ComputeSignificance(points, numPoints, significance.data() + fibers.GetOffset(i));
+    }
+
+    const std::vector< vtkIdType > order = GetBitReversedOrder(numFibers);
+    vtkIdType previousNumPoints = fibers.GetNumberOfPoints();
+    for (int level=1; level<=MaxNumberOfLevels && numFibers>0; level++)
+    {
+        const float error = FinestError*std::pow(2.0f, level-1);
+
+        std::vector< vtkIdType > offsets(numFibers+1, 0);
+#pragma omp parallel for
+        for (int i=0; i<numFibers; i++)
+        {
+            const float* fiberSignificance = significance.data() + fibers.GetOffset(order[i]);
+            offsets[i+1] = std::count_if(fiberSignificance, fiberSignificance + fibers.GetNumberOfPoints(order[i]), [error](float s){ return s>error; });
+        }
+        for (int i=0; i<numFibers; i++)
+            offsets[i+1] += offsets[i];
+
+        // the first level is always created, it provides the reordered fibers
+        if (level>1 && offsets.back()>0.9*previousNumPoints)
+            break;
+        previousNumPoints = offsets.back();
+
+        std::vector< std::vector< float > > levelFibers(numFibers);
+        std::vector< vtkIdType > pointIds(offsets.back());
+#pragma omp parallel for
+        for (int i=0; i<numFibers; i++)
+        {
+            const vtkIdType fiber = order[i];
+            const float* points = fibers.GetPoints(fiber);
+            const float* fiberSignificance = significance.data() + fibers.GetOffset(fiber);
+            levelFibers[i].reserve(3*(offsets[i+1]-offsets[i]));
+            vtkIdType* ids = pointIds.data() + offsets[i];
+            for (vtkIdType j=0; j<fibers.GetNumberOfPoints(fiber); j++)
+                if (fiberSignificance[j]>error)
+                {
+                    levelFibers[i].insert(levelFibers[i].end(), points+3*j, points+3*j+3);
+                    *ids++ = fibers.GetOffset(fiber) + j;
+                }
+        }
+
+        m_Levels.emplace_back(levelFibers);
+        m_Errors.push_back(error);
+        m_PointIds.push_back(std::move(pointIds));
+    }
+}
+
+int mitk::FiberLevelOfDetail::SelectLevel(float tolerance) const
+{
+    int level = 0;
+    while (level+1<this->GetNumberOfLevels() && this->GetError(level+1)<=tolerance)
+        level++;
+    return level;
+}
+
+vtkIdType mitk::FiberLevelOfDetail::GetNumberOfFibers(int level, vtkIdType maxPoints) const
+{
+    const FiberContainer& fibers = this->GetLevel(level);
+
+    // largest n with GetOffset(n)<=maxPoints, GetOffset(GetNumberOfFibers()) is the total number of points
+    vtkIdType first = 0;
+    vtkIdType last = fibers.GetNumberOfFibers();
+    while (first<last)
+    {
+        const vtkIdType n = first + (last-first+1)/2;
+        if (fibers.GetOffset(n)<=maxPoints)
+            first = n;
+        else
+            last = n-1;
+    }
+    return first;
+}
+
+vtkSmartPointer<vtkUnsignedCharArray> mitk::FiberLevelOfDetail::GetColors(int level, vtkUnsignedCharArray* colors) const
+{
+    if (colors==nullptr)
+        return nullptr;
+
+    const std::vector< vtkIdType >& pointIds = m_PointIds.at(level-1);
+    const int numComponents = colors->GetNumberOfComponents();
+    vtkSmartPointer<vtkUnsignedCharArray> levelColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    levelColors->SetName(colors->GetName());
+    levelColors->SetNumberOfComponents(numComponents);
+    levelColors->SetNumberOfTuples(pointIds.size());
+
+    const unsigned char* in = colors->GetPointer(0);
+    unsigned char* out = levelColors->GetPointer(0);
+#pragma omp parallel for
+    for (int i=0; i<(int)pointIds.size(); i++)
+        std::copy(in + numComponents*pointIds[i], in + numComponents*(pointIds[i]+1), out + numComponents*i);
+    return levelColors;
+}
+
+vtkSmartPointer<vtkPolyData> mitk::FiberLevelOfDetail::CreatePolyData(int level, vtkIdType numberOfFibers, vtkUnsignedCharArray* colors) const
+{
+    const FiberContainer& fibers = this->GetLevel(level);
+    numberOfFibers = std::max(vtkIdType(0), std::min(numberOfFibers, fibers.GetNumberOfFibers()));
+    const vtkIdType numPoints = fibers.GetOffset(numberOfFibers);
+
+    // views on the first points, the arrays do not free the memory
+    vtkSmartPointer<vtkFloatArray> pointArray = vtkSmartPointer<vtkFloatArray>::New();
+    pointArray->SetNumberOfComponents(3);
+    pointArray->SetArray(fibers.GetPointArray()->GetPointer(0), 3*numPoints, 1);
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetData(pointArray);
+
+    vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    connectivity->SetNumberOfValues(numPoints + numberOfFibers);
+    vtkIdType* cells = connectivity->GetPointer(0);
+
+#pragma omp parallel for
+    for (int i=0; i<(int)numberOfFibers; i++)
+    {
+        vtkIdType* cell = cells + fibers.GetOffset(i) + i;
+        cell[0] = fibers.GetNumberOfPoints(i);
+        for (vtkIdType j=0; j<cell[0]; j++)
+            cell[j+1] = fibers.GetOffset(i) + j;
+    }
+
+    vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+    lines->SetCells(numberOfFibers, connectivity);
+
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetLines(lines);
+
+    if (colors!=nullptr)
+    {
+        vtkSmartPointer<vtkUnsignedCharArray> colorArray = vtkSmartPointer<vtkUnsignedCharArray>::New();
+        colorArray->SetName(colors->GetName());
+        colorArray->SetNumberOfComponents(colors->GetNumberOfComponents());
+        colorArray->SetArray(colors->GetPointer(0), colors->GetNumberOfComponents()*numPoints, 1);
+        polyData->GetPointData()->AddArray(colorArray);
+    }
+    return polyData;
+}
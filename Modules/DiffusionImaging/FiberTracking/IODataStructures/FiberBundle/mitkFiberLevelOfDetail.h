@@ -0,0 +1,83 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITK_FiberLevelOfDetail_H
+#define _MITK_FiberLevelOfDetail_H
+
+#include <MitkFiberTrackingExports.h>
+#include <mitkFiberContainer.h>
+
+#include <vtkSmartPointer.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkPolyData.h>
+#include <vector>
+
+namespace mitk {
+
+/**
+   * \brief Level of detail hierarchy of a tractogram for rendering.
+   *
+   * Level 0 are the original fibers, they are not stored here. Every coarser level k contains all fibers,
+   * simplified with the Douglas-Peucker algorithm so that no removed point is further than GetError(k) mm
+   * away from the simplified fiber (the error bound of FiberBundle::Compress). The error doubles from level
+   * to level, starting with 0.1 mm. No further levels are created once a level removes less than 10% of the
+   * remaining points.
+   *
+   * The fibers of a level are stored in bit-reversed order of their original index, so that each prefix of
+   * a level is a spatially uniform subset of the tractogram. CreatePolyData() renders such a prefix without
+   * copying points, which allows to limit the number of rendered points during interaction.
+   *
+   * The hierarchy is built completely in the constructor and does not refer to the fibers afterwards.
+   */
+class MITKFIBERTRACKING_EXPORT FiberLevelOfDetail
+{
+public:
+
+    explicit FiberLevelOfDetail(const FiberContainer& fibers);
+
+    /** \brief Number of levels including the original fibers (level 0). */
+    int GetNumberOfLevels() const { return m_Levels.size()+1; }
+    /** \brief Fibers of level 1 or coarser, in bit-reversed order. */
+    const FiberContainer& GetLevel(int level) const { return m_Levels.at(level-1); }
+    /** \brief Maximum distance in mm between the original and the simplified fibers. */
+    float GetError(int level) const { return level>0 ? m_Errors.at(level-1) : 0; }
+
+    /** \brief Coarsest level with an error that does not exceed the tolerance (in mm). */
+    int SelectLevel(float tolerance) const;
+    /** \brief Number of fibers of the largest prefix of the level with at most maxPoints points. */
+    vtkIdType GetNumberOfFibers(int level, vtkIdType maxPoints) const;
+
+    /** \brief Gathers the per-point colors of the original fibers (e.g. FiberBundle::GetFiberColors()) for the points of the level. */
+    vtkSmartPointer<vtkUnsignedCharArray> GetColors(int level, vtkUnsignedCharArray* colors) const;
+
+    /**
+     * \brief Creates poly data of the first numberOfFibers fibers of the level.
+     *
+     * Points and colors (see GetColors()) are not copied, the poly data is only valid as long as this object
+     * and the color array exist.
+     */
+    vtkSmartPointer<vtkPolyData> CreatePolyData(int level, vtkIdType numberOfFibers, vtkUnsignedCharArray* colors = nullptr) const;
+
+private:
+
+    std::vector< FiberContainer >           m_Levels;
+    std::vector< float >                    m_Errors;
+    std::vector< std::vector< vtkIdType > > m_PointIds;     ///< original point of every point of a level
+};
+
+} // namespace mitk
+
+#endif /*  _MITK_FiberLevelOfDetail_H */
@@ -10,6 +10,9 @@ SET(MODULE_CUSTOM_TESTS
   mitkFiberfoxSignalGenerationTest.cpp
   mitkMachineLearningTrackingTest.cpp
   mitkFiberProcessingTest.cpp
+  mitkFiberContainerTest.cpp
+  mitkFiberRasterizerTest.cpp
+  mitkFiberLevelOfDetailTest.cpp
 )
 
 
@@ -0,0 +1,143 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkFiberBundle.h>
+#include <mitkFiberContainer.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkPolyLine.h>
+#include <omp.h>
+#include <algorithm>
+#include <cmath>
+#include "mitkTestFixture.h"
+
+class mitkFiberContainerTestSuite : public mitk::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(mitkFiberContainerTestSuite);
+    MITK_TEST(PolyDataRoundTrip);
+    MITK_TEST(PolyDataViewSharesPoints);
+    MITK_TEST(ParallelProcessingKeepsFiberOrder);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+
+    /** Fibers along helices of different radius, the points of the poly data are not stored in fiber order. */
+    vtkSmartPointer<vtkPolyData> m_PolyData;
+
+public:
+
+    void setUp() override
+    {
+        const int numFibers = 50;
+        vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+        vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+        for (int i=0; i<numFibers; i++)
+        {
+            vtkSmartPointer<vtkPolyLine> line = vtkSmartPointer<vtkPolyLine>::New();
+            for (int j=0; j<20+i; j++)
+            {
+                double t = 0.2*j;
+                double p[3] = { (1+0.1*i)*cos(t), (1+0.1*i)*sin(t), 0.5*t + i };
+                line->GetPointIds()->InsertNextId(points->InsertNextPoint(p));
+            }
+            // reverse every second fiber, so that its point ids are descending
+            if (i%2)
+            {
+                vtkIdList* ids = line->GetPointIds();
+                for (int j=0; j<ids->GetNumberOfIds()/2; j++)
+                {
+                    vtkIdType tmp = ids->GetId(j);
+                    ids->SetId(j, ids->GetId(ids->GetNumberOfIds()-1-j));
+                    ids->SetId(ids->GetNumberOfIds()-1-j, tmp);
+                }
+            }
+            lines->InsertNextCell(line);
+        }
+        m_PolyData = vtkSmartPointer<vtkPolyData>::New();
+        m_PolyData->SetPoints(points);
+        m_PolyData->SetLines(lines);
+    }
+
+    void tearDown() override
+    {
+        m_PolyData = nullptr;
+    }
+
+    void PolyDataRoundTrip()
+    {
+        mitk::FiberContainer fibers(m_PolyData);
+        CPPUNIT_ASSERT_EQUAL(m_PolyData->GetNumberOfLines(), fibers.GetNumberOfFibers());
+        CPPUNIT_ASSERT_EQUAL(m_PolyData->GetNumberOfPoints(), fibers.GetNumberOfPoints());
+
+        for (vtkIdType i=0; i<fibers.GetNumberOfFibers(); i++)
+        {
+            vtkCell* cell = m_PolyData->GetCell(i);
+            CPPUNIT_ASSERT_EQUAL(cell->GetNumberOfPoints(), fibers.GetNumberOfPoints(i));
+            for (vtkIdType j=0; j<cell->GetNumberOfPoints(); j++)
+                for (int c=0; c<3; c++)
+                    CPPUNIT_ASSERT_DOUBLES_EQUAL(cell->GetPoints()->GetPoint(j)[c], fibers.GetPoints(i)[3*j+c], 1e-6);
+        }
+
+        mitk::FiberContainer copy(fibers.CreatePolyData());
+        CPPUNIT_ASSERT_EQUAL(fibers.GetNumberOfFibers(), copy.GetNumberOfFibers());
+        for (vtkIdType i=0; i<fibers.GetNumberOfFibers(); i++)
+            CPPUNIT_ASSERT_EQUAL(fibers.GetOffset(i), copy.GetOffset(i));
+        CPPUNIT_ASSERT(std::equal(fibers.GetPoints(0), fibers.GetPoints(0)+3*fibers.GetNumberOfPoints(), copy.GetPoints(0)));
+    }
+
+    void PolyDataViewSharesPoints()
+    {
+        mitk::FiberBundle::Pointer fib = mitk::FiberBundle::New(m_PolyData);
+        vtkSmartPointer<vtkPolyData> view = fib->GetFiberPolyData();
+        CPPUNIT_ASSERT(view->GetPoints()->GetData()==fib->GetFibers().GetPointArray());
+        CPPUNIT_ASSERT(view==fib->GetFiberPolyData());
+        CPPUNIT_ASSERT_EQUAL((vtkIdType)fib->GetNumFibers(), view->GetNumberOfLines());
+
+        // passing the view back in creates a new container and a new view
+        fib->SetFiberPolyData(view);
+        CPPUNIT_ASSERT(view!=fib->GetFiberPolyData());
+        CPPUNIT_ASSERT_EQUAL(view->GetNumberOfPoints(), (vtkIdType)fib->GetNumberOfPoints());
+    }
+
+    void ParallelProcessingKeepsFiberOrder()
+    {
+        int numThreads = omp_get_max_threads();
+        omp_set_num_threads(1);
+        mitk::FiberBundle::Pointer reference = mitk::FiberBundle::New(m_PolyData);
+        for (int i=0; i<reference->GetNumFibers(); i++)
+            reference->SetFiberWeight(i, i);
+        reference->ResampleLinear(0.3);
+        reference->Compress(0.05);
+        reference->RemoveShortFibers(15);
+
+        omp_set_num_threads(4);
+        mitk::FiberBundle::Pointer fib = mitk::FiberBundle::New(m_PolyData);
+        for (int i=0; i<fib->GetNumFibers(); i++)
+            fib->SetFiberWeight(i, i);
+        fib->ResampleLinear(0.3);
+        fib->Compress(0.05);
+        fib->RemoveShortFibers(15);
+        omp_set_num_threads(numThreads);
+
+        CPPUNIT_ASSERT_MESSAGE("Should be equal", reference->Equals(fib, 0));
+        for (int i=0; i<fib->GetNumFibers(); i++)
+            CPPUNIT_ASSERT_EQUAL(reference->GetFiberWeight(i), fib->GetFiberWeight(i));
+    }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkFiberContainer)
@@ -0,0 +1,207 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkFiberBounds.h>
+#include <mitkFiberBundle.h>
+#include <mitkFiberContainer.h>
+#include <mitkFiberLevelOfDetail.h>
+#include <vtkPointData.h>
+#include <vtkCellArray.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include "mitkTestFixture.h"
+
+class mitkFiberLevelOfDetailTestSuite : public mitk::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(mitkFiberLevelOfDetailTestSuite);
+    MITK_TEST(LevelsKeepErrorBound);
+    MITK_TEST(PrefixFitsPointBudget);
+    MITK_TEST(PlaneSelectionContainsIntersectedFibers);
+    MITK_TEST(SubsetPolyDataCopiesColors);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+
+    /** Densely sampled helices of different radius, fiber i starts at z=i. */
+    mitk::FiberBundle::Pointer m_FiberBundle;
+
+    float GetSegmentDistance(const float* p, const float* a, const float* b)
+    {
+        double ab[3] = {b[0]-a[0], b[1]-a[1], b[2]-a[2]};
+        double ap[3] = {p[0]-a[0], p[1]-a[1], p[2]-a[2]};
+        double t = ab[0]*ap[0] + ab[1]*ap[1] + ab[2]*ap[2];
+        double squaredLength = ab[0]*ab[0] + ab[1]*ab[1] + ab[2]*ab[2];
+        t = squaredLength>0 ? std::max(0.0, std::min(1.0, t/squaredLength)) : 0;
+        return std::sqrt(std::pow(ap[0]-t*ab[0], 2) + std::pow(ap[1]-t*ab[1], 2) + std::pow(ap[2]-t*ab[2], 2));
+    }
+
+public:
+
+    void setUp() override
+    {
+        std::vector< std::vector< float > > fibers(100);
+        for (int i=0; i<(int)fibers.size(); i++)
+            for (int j=0; j<200; j++)
+            {
+                double t = 0.05*j;
+                fibers[i].push_back((1+0.1*i)*cos(t));
+                fibers[i].push_back((1+0.1*i)*sin(t));
+                fibers[i].push_back(0.5*t + i);
+            }
+        m_FiberBundle = mitk::FiberBundle::New();
+        m_FiberBundle->SetFibers(mitk::FiberContainer(fibers));
+    }
+
+    void tearDown() override
+    {
+        m_FiberBundle = nullptr;
+    }
+
+    void LevelsKeepErrorBound()
+    {
+        const mitk::FiberContainer& original = m_FiberBundle->GetFibers();
+        std::shared_ptr< const mitk::FiberLevelOfDetail > lod = m_FiberBundle->GetLevelOfDetail();
+        CPPUNIT_ASSERT(lod==m_FiberBundle->GetLevelOfDetail());
+        CPPUNIT_ASSERT(lod->GetNumberOfLevels()>2);
+
+        std::map< float, vtkIdType > fiberByStart;
+        for (vtkIdType i=0; i<original.GetNumberOfFibers(); i++)
+            fiberByStart[original.GetPoints(i)[2]] = i;
+
+        vtkIdType previousNumPoints = original.GetNumberOfPoints();
+        for (int level=1; level<lod->GetNumberOfLevels(); level++)
+        {
+            const mitk::FiberContainer& fibers = lod->GetLevel(level);
+            CPPUNIT_ASSERT_EQUAL(original.GetNumberOfFibers(), fibers.GetNumberOfFibers());
+            CPPUNIT_ASSERT(fibers.GetNumberOfPoints()<previousNumPoints);
+            if (level>1)
+                CPPUNIT_ASSERT_EQUAL(2*lod->GetError(level-1), lod->GetError(level));
+            CPPUNIT_ASSERT_EQUAL(level, lod->SelectLevel(lod->GetError(level)+0.01));
+            previousNumPoints = fibers.GetNumberOfPoints();
+
+            // the end points are kept, they identify the original fiber
+            for (vtkIdType i=0; i<fibers.GetNumberOfFibers(); i++)
+            {
+                const float* simplified = fibers.GetPoints(i);
+                const vtkIdType fiber = fiberByStart.at(simplified[2]);
+                for (vtkIdType j=0; j<original.GetNumberOfPoints(fiber); j++)
+                {
+                    float distance = GetSegmentDistance(original.GetPoints(fiber)+3*j, simplified, simplified);
+                    for (vtkIdType k=0; k<fibers.GetNumberOfPoints(i)-1; k++)
+                        distance = std::min(distance, GetSegmentDistance(original.GetPoints(fiber)+3*j, simplified+3*k, simplified+3*k+3));
+                    CPPUNIT_ASSERT(distance<=lod->GetError(level)+1e-4);
+                }
+            }
+        }
+        CPPUNIT_ASSERT_EQUAL(0, lod->SelectLevel(0.05));
+
+        // the hierarchy is rebuilt for new fibers
+        m_FiberBundle->SetFibers(mitk::FiberContainer(original));
+        CPPUNIT_ASSERT(lod!=m_FiberBundle->GetLevelOfDetail());
+    }
+
+    void PrefixFitsPointBudget()
+    {
+        std::shared_ptr< const mitk::FiberLevelOfDetail > lod = m_FiberBundle->GetLevelOfDetail();
+        const int level = 1;
+        const mitk::FiberContainer& fibers = lod->GetLevel(level);
+
+        const vtkIdType budget = fibers.GetNumberOfPoints()/3;
+        const vtkIdType numFibers = lod->GetNumberOfFibers(level, budget);
+        CPPUNIT_ASSERT(fibers.GetOffset(numFibers)<=budget);
+        CPPUNIT_ASSERT(fibers.GetOffset(numFibers+1)>budget);
+        CPPUNIT_ASSERT_EQUAL(fibers.GetNumberOfFibers(), lod->GetNumberOfFibers(level, fibers.GetNumberOfPoints()));
+        CPPUNIT_ASSERT_EQUAL(vtkIdType(0), lod->GetNumberOfFibers(level, 0));
+
+        // the prefix is spread over the whole tractogram
+        double bounds[6];
+        fibers.GetBounds(bounds);
+        float minZ = bounds[5];
+        float maxZ = bounds[4];
+        for (vtkIdType i=0; i<numFibers; i++)
+        {
+            minZ = std::min(minZ, fibers.GetPoints(i)[2]);
+            maxZ = std::max(maxZ, fibers.GetPoints(i)[2]);
+        }
+        CPPUNIT_ASSERT(minZ<10 && maxZ>90);
+
+        vtkSmartPointer<vtkUnsignedCharArray> colors = lod->GetColors(level, m_FiberBundle->GetFiberColors());
+        CPPUNIT_ASSERT_EQUAL(fibers.GetNumberOfPoints(), colors->GetNumberOfTuples());
+        vtkSmartPointer<vtkPolyData> polyData = lod->CreatePolyData(level, numFibers, colors);
+        CPPUNIT_ASSERT_EQUAL(numFibers, polyData->GetNumberOfLines());
+        CPPUNIT_ASSERT_EQUAL(fibers.GetOffset(numFibers), polyData->GetNumberOfPoints());
+        CPPUNIT_ASSERT_EQUAL(fibers.GetOffset(numFibers), polyData->GetPointData()->GetArray("FIBER_COLORS")->GetNumberOfTuples());
+        CPPUNIT_ASSERT(static_cast<void*>(fibers.GetPointArray()->GetPointer(0))==polyData->GetPoints()->GetVoidPointer(0));
+    }
+
+    void PlaneSelectionContainsIntersectedFibers()
+    {
+        const mitk::FiberContainer& fibers = m_FiberBundle->GetFibers();
+        std::shared_ptr< const mitk::FiberBounds > bounds = m_FiberBundle->GetFiberBounds();
+        CPPUNIT_ASSERT(bounds==m_FiberBundle->GetFiberBounds());
+
+        // oblique, unnormalized plane
+        const double normal[3] = {0.5, 0, 2};
+        const double offset = 80;
+        const double distance = 0.5;
+        std::vector< vtkIdType > selected = bounds->GetFibersNearPlane(normal, offset, distance);
+        CPPUNIT_ASSERT(!selected.empty());
+        CPPUNIT_ASSERT((vtkIdType)selected.size()<fibers.GetNumberOfFibers()/2);
+
+        for (vtkIdType i=0; i<fibers.GetNumberOfFibers(); i++)
+        {
+            bool inside = false;
+            for (vtkIdType j=0; j<fibers.GetNumberOfPoints(i); j++)
+            {
+                const float* p = fibers.GetPoints(i) + 3*j;
+                inside |= std::fabs(normal[0]*p[0] + normal[1]*p[1] + normal[2]*p[2] - offset)<=distance;
+            }
+            if (inside)
+                CPPUNIT_ASSERT(std::find(selected.begin(), selected.end(), i)!=selected.end());
+        }
+    }
+
+    void SubsetPolyDataCopiesColors()
+    {
+        const mitk::FiberContainer& fibers = m_FiberBundle->GetFibers();
+        m_FiberBundle->ColorFibersByCurvature();
+        vtkUnsignedCharArray* colors = m_FiberBundle->GetFiberColors();
+
+        std::vector< vtkIdType > selected = {3, 17, 42};
+        vtkSmartPointer<vtkPolyData> polyData = fibers.CreatePolyData(selected, colors);
+        CPPUNIT_ASSERT_EQUAL(vtkIdType(3), polyData->GetNumberOfLines());
+        CPPUNIT_ASSERT_EQUAL(3*fibers.GetNumberOfPoints(0), polyData->GetNumberOfPoints());
+
+        vtkDataArray* subsetColors = polyData->GetPointData()->GetArray("FIBER_COLORS");
+        CPPUNIT_ASSERT(subsetColors!=nullptr);
+        vtkIdType point = 0;
+        for (vtkIdType fiber : selected)
+            for (vtkIdType j=0; j<fibers.GetNumberOfPoints(fiber); j++, point++)
+            {
+                double p[3];
+                polyData->GetPoint(point, p);
+                for (int c=0; c<3; c++)
+                    CPPUNIT_ASSERT_EQUAL((float)p[c], fibers.GetPoints(fiber)[3*j+c]);
+                for (int c=0; c<4; c++)
+                    CPPUNIT_ASSERT_EQUAL(colors->GetComponent(fibers.GetOffset(fiber)+j, c), subsetColors->GetComponent(point, c));
+            }
+    }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkFiberLevelOfDetail)
@@ -0,0 +1,204 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkFiberBundle.h>
+#include <mitkFiberRasterizer.h>
+#include <vtkPoints.h>
+#include <vtkCellArray.h>
+#include <vtkPolyLine.h>
+#include <omp.h>
+#include <cmath>
+#include "mitkTestFixture.h"
+
+class mitkFiberRasterizerTestSuite : public mitk::TestFixture
+{
+
+    CPPUNIT_TEST_SUITE(mitkFiberRasterizerTestSuite);
+    MITK_TEST(DensityIsExactIntersectionLength);
+    MITK_TEST(UpsamplingKeepsTotalLength);
+    MITK_TEST(CombinedMapsMatchSingleMaps);
+    MITK_TEST(ResultDoesNotDependOnThreads);
+    CPPUNIT_TEST_SUITE_END();
+
+private:
+
+    typedef itk::Image<float, 3> ItkFloatImgType;
+
+    /** 10x10x10 voxels with 1mm spacing, voxel k covers [k-0.5, k+0.5). */
+    ItkFloatImgType::Pointer m_Reference;
+    /** A fiber along x and oblique fibers that partly leave the reference grid. */
+    mitk::FiberBundle::Pointer m_FiberBundle;
+
+    void AddFiber(vtkPoints* points, vtkCellArray* lines, const std::vector< double >& coordinates)
+    {
+        vtkSmartPointer<vtkPolyLine> line = vtkSmartPointer<vtkPolyLine>::New();
+        for (unsigned int j=0; j<coordinates.size(); j+=3)
+            line->GetPointIds()->InsertNextId(points->InsertNextPoint(coordinates[j], coordinates[j+1], coordinates[j+2]));
+        lines->InsertNextCell(line);
+    }
+
+    double GetLength(const std::vector< float >& values, unsigned int stride, unsigned int component)
+    {
+        double sum = 0;
+        for (unsigned int i=component; i<values.size(); i+=stride)
+            sum += values[i];
+        return sum;
+    }
+
+public:
+
+    void setUp() override
+    {
+        m_Reference = ItkFloatImgType::New();
+        ItkFloatImgType::RegionType region;
+        region.SetSize(0, 10);
+        region.SetSize(1, 10);
+        region.SetSize(2, 10);
+        m_Reference->SetRegions(region);
+        ItkFloatImgType::SpacingType spacing;
+        spacing.Fill(1.0);
+        m_Reference->SetSpacing(spacing);
+        ItkFloatImgType::PointType origin;
+        origin.Fill(0.0);
+        m_Reference->SetOrigin(origin);
+
+        vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+        vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+        AddFiber(points, lines, {0.2,2,3, 3.0,2,3, 5.7,2,3});
+        for (int i=0; i<20; i++)
+            AddFiber(points, lines, {-2.0+0.3*i,1.1,0.4, 4.3,5.2+0.1*i,3.9, 11.0,7.3,8.8-0.2*i});
+        vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+        polyData->SetPoints(points);
+        polyData->SetLines(lines);
+        m_FiberBundle = mitk::FiberBundle::New(polyData);
+        m_FiberBundle->SetFiberWeight(0, 2);
+    }
+
+    void tearDown() override
+    {
+        m_Reference = nullptr;
+        m_FiberBundle = nullptr;
+    }
+
+    void DensityIsExactIntersectionLength()
+    {
+        mitk::FiberBundle::Pointer fib = mitk::FiberBundle::New(m_FiberBundle->GeneratePolyDataByIds({0}));
+        fib->SetFiberWeight(0, 2);
+
+        mitk::FiberRasterizer rasterizer;
+        rasterizer.SetReferenceGeometry(m_Reference.GetPointer());
+        rasterizer.SetFiberBundle(fib);
+        rasterizer.SetMaps(mitk::FiberRasterizer::DENSITY | mitk::FiberRasterizer::ENDINGS);
+        rasterizer.Update();
+
+        const std::vector< float >& density = rasterizer.GetDensity();
+        const std::vector< float >& endings = rasterizer.GetEndings();
+        const unsigned int offset = 10*(2 + 10*3);
+        const float expected[] = {0.3, 1, 1, 1, 1, 1, 0.2, 0, 0, 0};
+        for (int x=0; x<10; x++)
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(2*expected[x], density[offset+x], 1e-5);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(11.0, GetLength(density, 1, 0), 1e-4);
+        CPPUNIT_ASSERT_EQUAL(1.0f, endings[offset]);
+        CPPUNIT_ASSERT_EQUAL(1.0f, endings[offset+6]);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, GetLength(endings, 1, 0), 1e-6);
+    }
+
+    void UpsamplingKeepsTotalLength()
+    {
+        mitk::FiberRasterizer rasterizer;
+        rasterizer.SetReferenceGeometry(m_Reference.GetPointer());
+        rasterizer.SetFiberBundle(m_FiberBundle);
+        rasterizer.Update();
+        const double length = GetLength(rasterizer.GetDensity(), 1, 0);
+
+        // the upsampled grid covers the same volume
+        rasterizer.SetUpsamplingFactor(2.5);
+        rasterizer.Update();
+        CPPUNIT_ASSERT_EQUAL((itk::SizeValueType)25, rasterizer.GetRegion().GetSize()[0]);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.4, rasterizer.GetSpacing()[0], 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(-0.3, rasterizer.GetOrigin()[0], 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(length, GetLength(rasterizer.GetDensity(), 1, 0), 1e-3);
+
+        rasterizer.SetUseTrilinearInterpolation(true);
+        rasterizer.Update();
+        // weights of neighbors outside of the grid are lost
+        CPPUNIT_ASSERT(GetLength(rasterizer.GetDensity(), 1, 0) < length);
+        CPPUNIT_ASSERT(GetLength(rasterizer.GetDensity(), 1, 0) > 0.5*length);
+    }
+
+    void CombinedMapsMatchSingleMaps()
+    {
+        mitk::FiberRasterizer combined;
+        combined.SetReferenceGeometry(m_Reference.GetPointer());
+        combined.SetFiberBundle(m_FiberBundle);
+        combined.SetMaps(mitk::FiberRasterizer::DENSITY | mitk::FiberRasterizer::ENDINGS | mitk::FiberRasterizer::COLOR | mitk::FiberRasterizer::DIRECTIONS);
+        combined.Update();
+
+        const unsigned int maps[] = {mitk::FiberRasterizer::DENSITY, mitk::FiberRasterizer::ENDINGS, mitk::FiberRasterizer::COLOR, mitk::FiberRasterizer::DIRECTIONS};
+        for (unsigned int map : maps)
+        {
+            mitk::FiberRasterizer single;
+            single.SetReferenceGeometry(m_Reference.GetPointer());
+            single.SetFiberBundle(m_FiberBundle);
+            single.SetMaps(map);
+            single.Update();
+            CPPUNIT_ASSERT(map!=mitk::FiberRasterizer::DENSITY || single.GetDensity()==combined.GetDensity());
+            CPPUNIT_ASSERT(map!=mitk::FiberRasterizer::ENDINGS || single.GetEndings()==combined.GetEndings());
+            CPPUNIT_ASSERT(map!=mitk::FiberRasterizer::COLOR || single.GetColors()==combined.GetColors());
+            CPPUNIT_ASSERT(map==mitk::FiberRasterizer::DENSITY || single.GetDensity().empty());
+        }
+
+        // the alpha channel and the direction lengths add up to the density
+        for (unsigned long v=0; v<combined.GetNumberOfVoxels(); v++)
+        {
+            double length = 0;
+            for (unsigned long k=0; k<combined.GetNumberOfDirections(v); k++)
+                length += combined.GetDirections(v)[k].m_Length;
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(combined.GetDensity()[v], length, 1e-4);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(combined.GetDensity()[v], combined.GetColors()[4*v+3], 1e-4);
+        }
+    }
+
+    void ResultDoesNotDependOnThreads()
+    {
+        int numThreads = omp_get_max_threads();
+        omp_set_num_threads(1);
+        mitk::FiberRasterizer reference;
+        reference.SetReferenceGeometry(m_Reference.GetPointer());
+        reference.SetFiberBundle(m_FiberBundle);
+        reference.SetMaps(mitk::FiberRasterizer::DENSITY | mitk::FiberRasterizer::DIRECTIONS);
+        reference.Update();
+
+        omp_set_num_threads(4);
+        mitk::FiberRasterizer rasterizer;
+        rasterizer.SetReferenceGeometry(m_Reference.GetPointer());
+        rasterizer.SetFiberBundle(m_FiberBundle);
+        rasterizer.SetMaps(mitk::FiberRasterizer::DENSITY | mitk::FiberRasterizer::DIRECTIONS);
+        rasterizer.Update();
+        omp_set_num_threads(numThreads);
+
+        for (unsigned long v=0; v<reference.GetNumberOfVoxels(); v++)
+        {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(reference.GetDensity()[v], rasterizer.GetDensity()[v], 1e-5);
+            CPPUNIT_ASSERT_EQUAL(reference.GetNumberOfDirections(v), rasterizer.GetNumberOfDirections(v));
+            for (unsigned long k=0; k<reference.GetNumberOfDirections(v); k++)
+                CPPUNIT_ASSERT_EQUAL(reference.GetDirections(v)[k].m_Length, rasterizer.GetDirections(v)[k].m_Length);
+        }
+    }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkFiberRasterizer)
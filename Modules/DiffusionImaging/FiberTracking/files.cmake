@@ -4,6 +4,9 @@ set(CPP_FILES
 
   ## IO datastructures
   IODataStructures/FiberBundle/mitkFiberBundle.cpp
+  IODataStructures/FiberBundle/mitkFiberBounds.cpp
+  IODataStructures/FiberBundle/mitkFiberContainer.cpp
+  IODataStructures/FiberBundle/mitkFiberLevelOfDetail.cpp
   IODataStructures/FiberBundle/mitkTrackvis.cpp
   IODataStructures/PlanarFigureComposite/mitkPlanarFigureComposite.cpp
 
@@ -18,6 +21,7 @@ set(CPP_FILES
   Algorithms/GibbsTracking/mitkSphereInterpolator.cpp
 
   Algorithms/itkStreamlineTrackingFilter.cpp
+  Algorithms/mitkFiberRasterizer.cpp
   Algorithms/TrackingHandlers/mitkTrackingDataHandler.cpp
   Algorithms/TrackingHandlers/mitkTrackingHandlerTensor.cpp
   Algorithms/TrackingHandlers/mitkTrackingHandlerPeaks.cpp
@@ -27,10 +31,14 @@ set(CPP_FILES
 set(H_FILES
   # DataStructures -> FiberBundle
   IODataStructures/FiberBundle/mitkFiberBundle.h
+  IODataStructures/FiberBundle/mitkFiberBounds.h
+  IODataStructures/FiberBundle/mitkFiberContainer.h
+  IODataStructures/FiberBundle/mitkFiberLevelOfDetail.h
   IODataStructures/FiberBundle/mitkTrackvis.h
   IODataStructures/mitkFiberfoxParameters.h
 
   # Algorithms
+  Algorithms/mitkFiberRasterizer.h
   Algorithms/itkTractDensityImageFilter.h
   Algorithms/itkTractsToFiberEndingsImageFilter.h
   Algorithms/itkTractsToRgbaImageFilter.h
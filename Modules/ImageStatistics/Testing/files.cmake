@@ -3,6 +3,7 @@ set(MODULE_TESTS
   mitkPointSetStatisticsCalculatorTest.cpp
   mitkPointSetDifferenceStatisticsCalculatorTest.cpp
   mitkImageStatisticsTextureAnalysisTest.cpp
+  mitkPlanarFigureSliceStatisticsCalculatorTest.cpp
 )
 
 set(MODULE_CUSTOM_TESTS
@@ -0,0 +1,215 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkPlanarFigureSliceStatisticsCalculator.h"
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+#include <mitkPlanarPolygon.h>
+#include <mitkIOUtil.h>
+
+#include <mitkImageStatisticsCalculator.h>
+#include <mitkPlanarFigureMaskGenerator.h>
+
+#include <cmath>
+
+/**
+ * \brief Test class for mitkPlanarFigureSliceStatisticsCalculator
+ *
+ * This test covers:
+ * - statistics of figures with pixel aligned corners are equal to the statistics of ImageStatisticsCalculator
+ * - the statistics follow a figure that is moved within the slice
+ * - open figures are rejected
+ */
+class mitkPlanarFigureSliceStatisticsCalculatorTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkPlanarFigureSliceStatisticsCalculatorTestSuite);
+  MITK_TEST(TestRectangle);
+  MITK_TEST(TestPolygon);
+  MITK_TEST(TestMovedFigure);
+  MITK_TEST(TestOpenFigure);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+
+  void setUp() override;
+  void tearDown() override;
+
+  void TestRectangle();
+  void TestPolygon();
+  void TestMovedFigure();
+  void TestOpenFigure();
+
+private:
+
+  mitk::Image::Pointer m_TestImage;
+  mitk::PlaneGeometry::Pointer m_Geometry;
+
+  mitk::PlanarPolygon::Pointer CreatePolygon(const std::vector<mitk::Point2D> &points);
+
+  void VerifyStatistics(mitk::PlanarFigure::Pointer figure,
+                        const mitk::PlanarFigureSliceStatisticsCalculator::Statistics &statistics);
+};
+
+void mitkPlanarFigureSliceStatisticsCalculatorTestSuite::setUp()
+{
+  std::string filename = this->GetTestDataFilePath("ImageStatisticsTestData/testimage.dcm");
+  if (filename.empty())
+  {
+    MITK_TEST_FAILED_MSG( << "Could not find test file" )
+  }
+
+  m_TestImage = mitk::IOUtil::LoadImage(filename);
+  MITK_TEST_CONDITION_REQUIRED( m_TestImage.IsNotNull(), "Loaded an mitk::Image" );
+
+  m_Geometry = m_TestImage->GetSlicedGeometry()->GetPlaneGeometry(0);
+  MITK_TEST_CONDITION_REQUIRED( m_Geometry.IsNotNull(), "Getting image geometry" );
+}
+
+void mitkPlanarFigureSliceStatisticsCalculatorTestSuite::tearDown()
+{
+  m_TestImage = nullptr;
+  m_Geometry = nullptr;
+}
+
+mitk::PlanarPolygon::Pointer mitkPlanarFigureSliceStatisticsCalculatorTestSuite::CreatePolygon(const std::vector<mitk::Point2D> &points)
+{
+  mitk::PlanarPolygon::Pointer figure = mitk::PlanarPolygon::New();
+  figure->SetPlaneGeometry( m_Geometry );
+  figure->PlaceFigure( points[0] );
+  for (unsigned int i = 1; i < points.size(); ++i)
+  {
+    figure->SetControlPoint( i, points[i], true );
+  }
+  figure->GetPolyLine(0);
+  return figure;
+}
+
+void mitkPlanarFigureSliceStatisticsCalculatorTestSuite::VerifyStatistics(mitk::PlanarFigure::Pointer figure,
+  const mitk::PlanarFigureSliceStatisticsCalculator::Statistics &statistics)
+{
+  mitk::ImageStatisticsCalculator::Pointer statisticsCalculator = mitk::ImageStatisticsCalculator::New();
+  statisticsCalculator->SetInputImage( m_TestImage );
+
+  mitk::PlanarFigureMaskGenerator::Pointer planFigMaskGen = mitk::PlanarFigureMaskGenerator::New();
+  planFigMaskGen->SetInputImage( m_TestImage );
+  planFigMaskGen->SetPlanarFigure( figure );
+  statisticsCalculator->SetMask( planFigMaskGen.GetPointer() );
+
+  mitk::ImageStatisticsCalculator::StatisticsContainer::Pointer exact = statisticsCalculator->GetStatistics();
+
+  MITK_TEST_CONDITION( statistics.N == static_cast<unsigned long>(exact->GetN()),
+                       "Number of pixels '" << statistics.N << "' is equal to the exact value '" << exact->GetN() << "'" );
+  MITK_TEST_CONDITION( std::fabs(statistics.Mean - exact->GetMean()) < 1e-6,
+                       "Mean '" << statistics.Mean << "' is equal to the exact value '" << exact->GetMean() << "'" );
+  MITK_TEST_CONDITION( std::fabs(statistics.Std - exact->GetStd()) < 1e-6,
+                       "Std '" << statistics.Std << "' is equal to the exact value '" << exact->GetStd() << "'" );
+  MITK_TEST_CONDITION( std::fabs(statistics.RMS - exact->GetRMS()) < 1e-6,
+                       "RMS '" << statistics.RMS << "' is equal to the exact value '" << exact->GetRMS() << "'" );
+}
+
+void mitkPlanarFigureSliceStatisticsCalculatorTestSuite::TestRectangle()
+{
+  /*****************************
+   * axis aligned rectangle, corners on pixel borders
+   * -> table lookup of the rectangle, same pixels as the mask generator
+   ******************************/
+  std::vector<mitk::Point2D> points(4);
+  points[0][0] = 2.5;  points[0][1] = 1.5;
+  points[1][0] = 12.5; points[1][1] = 1.5;
+  points[2][0] = 12.5; points[2][1] = 6.5;
+  points[3][0] = 2.5;  points[3][1] = 6.5;
+  mitk::PlanarPolygon::Pointer figure = this->CreatePolygon(points);
+
+  mitk::PlanarFigureSliceStatisticsCalculator::Pointer calculator = mitk::PlanarFigureSliceStatisticsCalculator::New();
+  calculator->SetInputImage( m_TestImage );
+  calculator->SetPlanarFigure( figure.GetPointer() );
+  mitk::PlanarFigureSliceStatisticsCalculator::Statistics statistics = calculator->GetStatistics();
+
+  MITK_TEST_CONDITION( statistics.N == 50, "Rectangle covers 50 pixels" );
+  this->VerifyStatistics( figure.GetPointer(), statistics );
+}
+
+void mitkPlanarFigureSliceStatisticsCalculatorTestSuite::TestPolygon()
+{
+  /*****************************
+   * L-shaped polygon, corners on pixel borders
+   * -> scanline intervals, same pixels as the mask generator
+   ******************************/
+  std::vector<mitk::Point2D> points(6);
+  points[0][0] = 1.5;  points[0][1] = 1.5;
+  points[1][0] = 11.5; points[1][1] = 1.5;
+  points[2][0] = 11.5; points[2][1] = 4.5;
+  points[3][0] = 5.5;  points[3][1] = 4.5;
+  points[4][0] = 5.5;  points[4][1] = 12.5;
+  points[5][0] = 1.5;  points[5][1] = 12.5;
+  mitk::PlanarPolygon::Pointer figure = this->CreatePolygon(points);
+
+  mitk::PlanarFigureSliceStatisticsCalculator::Pointer calculator = mitk::PlanarFigureSliceStatisticsCalculator::New();
+  calculator->SetInputImage( m_TestImage );
+  calculator->SetPlanarFigure( figure.GetPointer() );
+  mitk::PlanarFigureSliceStatisticsCalculator::Statistics statistics = calculator->GetStatistics();
+
+  MITK_TEST_CONDITION( statistics.N == 62, "Polygon covers 62 pixels" );
+  this->VerifyStatistics( figure.GetPointer(), statistics );
+}
+
+void mitkPlanarFigureSliceStatisticsCalculatorTestSuite::TestMovedFigure()
+{
+  /*****************************
+   * figure is moved like during an interaction, the tables of the slice are reused
+   * -> statistics of the new position
+   ******************************/
+  std::vector<mitk::Point2D> points(4);
+  points[0][0] = 9.5;  points[0][1] = 3.5;
+  points[1][0] = 10.5; points[1][1] = 3.5;
+  points[2][0] = 10.5; points[2][1] = 4.5;
+  points[3][0] = 9.5;  points[3][1] = 4.5;
+  mitk::PlanarPolygon::Pointer figure = this->CreatePolygon(points);
+
+  mitk::PlanarFigureSliceStatisticsCalculator::Pointer calculator = mitk::PlanarFigureSliceStatisticsCalculator::New();
+  calculator->SetInputImage( m_TestImage );
+  calculator->SetPlanarFigure( figure.GetPointer() );
+  this->VerifyStatistics( figure.GetPointer(), calculator->GetStatistics() );
+
+  for (unsigned int i = 0; i < points.size(); ++i)
+  {
+    points[i][0] += 2.0;
+    points[i][1] += 3.0;
+    figure->SetControlPoint( i, points[i], true );
+  }
+  figure->GetPolyLine(0);
+  this->VerifyStatistics( figure.GetPointer(), calculator->GetStatistics() );
+}
+
+void mitkPlanarFigureSliceStatisticsCalculatorTestSuite::TestOpenFigure()
+{
+  std::vector<mitk::Point2D> points(3);
+  points[0][0] = 2.5;  points[0][1] = 1.5;
+  points[1][0] = 12.5; points[1][1] = 1.5;
+  points[2][0] = 12.5; points[2][1] = 6.5;
+  mitk::PlanarPolygon::Pointer figure = this->CreatePolygon(points);
+  figure->SetClosed(false);
+
+  mitk::PlanarFigureSliceStatisticsCalculator::Pointer calculator = mitk::PlanarFigureSliceStatisticsCalculator::New();
+  calculator->SetInputImage( m_TestImage );
+  calculator->SetPlanarFigure( figure.GetPointer() );
+
+  MITK_TEST_FOR_EXCEPTION_BEGIN(mitk::Exception)
+  calculator->GetStatistics();
+  MITK_TEST_FOR_EXCEPTION_END(mitk::Exception)
+}
+
+MITK_TEST_SUITE_REGISTRATION(mitkPlanarFigureSliceStatisticsCalculator)
@@ -11,6 +11,7 @@ set(CPP_FILES
   mitkHistogramStatisticsCalculator.cpp
   mitkMaskUtilities.cpp
   mitkIgnorePixelMaskGenerator.cpp
+  mitkPlanarFigureSliceStatisticsCalculator.cpp
 )
 
 set(H_FILES
@@ -30,4 +31,5 @@ set(H_FILES
   mitkIgnorePixelMaskGenerator.h
   mitkMinMaxImageFilterWithIndex.h
   mitkMinMaxLabelmageFilterWithIndex.h
+  mitkPlanarFigureSliceStatisticsCalculator.h
 )
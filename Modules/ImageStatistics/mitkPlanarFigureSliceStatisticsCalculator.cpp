@@ -0,0 +1,375 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkPlanarFigureSliceStatisticsCalculator.h>
+#include <mitkImageAccessByItk.h>
+#include <mitkImageTimeSelector.h>
+#include <mitkExtractImageFilter.h>
+#include <mitkPlaneGeometry.h>
+
+#include <itkImageRegionConstIterator.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    /** polyline edge in the index coordinates of the slice, y0 < y1 */
+    struct Edge
+    {
+        double x0;
+        double y0;
+        double x1;
+        double y1;
+
+        double GetX(double y) const
+        {
+            return x0 + (y - y0) * (x1 - x0) / (y1 - y0);
+        }
+    };
+
+    typedef std::vector< mitk::Point2D > IndexPolygonType;
+
+    /** Sum of all pixels (x, y) with x0<=x<=x1 and y0<=y<=y1 */
+    double GetTableSum(const std::vector<double> &table, unsigned int width, int x0, int y0, int x1, int y1)
+    {
+        const unsigned int stride = width + 1;
+        return table[(y1 + 1) * stride + x1 + 1] - table[y0 * stride + x1 + 1]
+            - table[(y1 + 1) * stride + x0] + table[y0 * stride + x0];
+    }
+
+    /** Indicates if the polygon has four corners and only edges parallel to the slice axes */
+    bool IsAxisAlignedRectangle(const IndexPolygonType &polygon)
+    {
+        if (polygon.size() != 4)
+        {
+            return false;
+        }
+
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+            const mitk::Point2D &p = polygon[i];
+            const mitk::Point2D &q = polygon[(i + 1) % 4];
+            if (std::fabs(p[0] - q[0]) > mitk::eps && std::fabs(p[1] - q[1]) > mitk::eps)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool GetPrincipalAxis(const mitk::BaseGeometry *geometry, mitk::Vector3D vector, unsigned int &axis)
+    {
+        vector.Normalize();
+        for (unsigned int i = 0; i < 3; ++i)
+        {
+            mitk::Vector3D axisVector = geometry->GetAxisVector(i);
+            axisVector.Normalize();
+
+            if (std::fabs(std::fabs(axisVector * vector) - 1.0) < mitk::eps)
+            {
+                axis = i;
+                return true;
+            }
+        }
+
+        return false;
+    }
+}
+
+namespace mitk
+{
+
+PlanarFigureSliceStatisticsCalculator::PlanarFigureSliceStatisticsCalculator()
+{
+}
+
+void PlanarFigureSliceStatisticsCalculator::SetInputImage(mitk::Image::Pointer image)
+{
+    if (image != m_InputImage)
+    {
+        m_InputImage = image;
+        m_Tables.clear();
+        this->Modified();
+    }
+}
+
+void PlanarFigureSliceStatisticsCalculator::SetPlanarFigure(mitk::PlanarFigure::Pointer planarFigure)
+{
+    if (planarFigure != m_PlanarFigure)
+    {
+        m_PlanarFigure = planarFigure;
+        this->Modified();
+    }
+}
+
+template < typename TPixel, unsigned int VImageDimension >
+void PlanarFigureSliceStatisticsCalculator::InternalBuildTables(
+  const itk::Image< TPixel, VImageDimension > *image, SliceTables *tables)
+{
+    typedef itk::Image< TPixel, VImageDimension > ImageType;
+
+    const typename ImageType::SizeType size = image->GetBufferedRegion().GetSize();
+    tables->Width = size[0];
+    tables->Height = size[1];
+
+    const unsigned int stride = tables->Width + 1;
+    tables->Sum.assign(stride * (tables->Height + 1), 0.);
+    tables->SumOfSquares.assign(stride * (tables->Height + 1), 0.);
+
+    // the iterator runs row by row, x is the fastest index
+    itk::ImageRegionConstIterator< ImageType > it(image, image->GetBufferedRegion());
+    for (unsigned int y = 0; y < tables->Height; ++y)
+    {
+        double rowSum = 0.;
+        double rowSumOfSquares = 0.;
+        for (unsigned int x = 0; x < tables->Width; ++x, ++it)
+        {
+            const double value = static_cast<double>(it.Get());
+            rowSum += value;
+            rowSumOfSquares += value * value;
+
+            const unsigned int entry = (y + 1) * stride + x + 1;
+            tables->Sum[entry] = tables->Sum[entry - stride] + rowSum;
+            tables->SumOfSquares[entry] = tables->SumOfSquares[entry - stride] + rowSumOfSquares;
+        }
+    }
+}
+
+void PlanarFigureSliceStatisticsCalculator::UpdateTables(SliceTables &tables, unsigned int timeStep,
+  unsigned int axis, unsigned int slice)
+{
+    mitk::ImageTimeSelector::Pointer imgTimeSel = mitk::ImageTimeSelector::New();
+    imgTimeSel->SetInput(m_InputImage);
+    imgTimeSel->SetTimeNr(timeStep);
+    imgTimeSel->UpdateLargestPossibleRegion();
+    mitk::Image::Pointer timeSliceImage = imgTimeSel->GetOutput();
+
+    mitk::Image::Pointer imageSlice = timeSliceImage;
+    if (timeSliceImage->GetDimension() == 3)
+    {
+        ExtractImageFilter::Pointer imageExtractor = ExtractImageFilter::New();
+        imageExtractor->SetInput(timeSliceImage);
+        imageExtractor->SetSliceDimension(axis);
+        imageExtractor->SetSliceIndex(slice);
+        imageExtractor->Update();
+        imageSlice = imageExtractor->GetOutput();
+    }
+    else if (timeSliceImage->GetDimension() != 2)
+    {
+        mitkThrow() << "Unsupported image dimension. Dimension is: " << timeSliceImage->GetDimension() << ". Only 2D and 3D images are supported.";
+    }
+
+    AccessFixedDimensionByItk_1(imageSlice, InternalBuildTables, 2, &tables)
+
+    tables.Axis = axis;
+    tables.Slice = slice;
+    tables.ImageUpdateTime = m_InputImage->GetMTime();
+}
+
+PlanarFigureSliceStatisticsCalculator::Statistics PlanarFigureSliceStatisticsCalculator::GetStatistics(unsigned int timeStep)
+{
+    if (m_InputImage.IsNull())
+    {
+        mitkThrow() << "Image is not set.";
+    }
+
+    if (m_PlanarFigure.IsNull())
+    {
+        mitkThrow() << "PlanarFigure is not set.";
+    }
+
+    if (!m_PlanarFigure->IsClosed())
+    {
+        mitkThrow() << "Statistics are only available for closed figures.";
+    }
+
+    if (timeStep >= m_InputImage->GetTimeSteps())
+    {
+        mitkThrow() << "Time step " << timeStep << " does not exist.";
+    }
+
+    const PlaneGeometry *planarFigureGeometry = m_PlanarFigure->GetPlaneGeometry();
+    const BaseGeometry *imageGeometry = m_InputImage->GetGeometry(timeStep);
+    if (planarFigureGeometry == nullptr || imageGeometry == nullptr)
+    {
+        mitkThrow() << "Planar figure or image geometry is not initialized.";
+    }
+
+    // find principal direction and slice of the figure in the image
+    unsigned int axis;
+    if (!GetPrincipalAxis(imageGeometry, planarFigureGeometry->GetNormal(), axis))
+    {
+        mitkThrow() << "Non-aligned planar figures not supported!";
+    }
+
+    itk::Index<3> index;
+    imageGeometry->WorldToIndex(planarFigureGeometry->GetOrigin(), index);
+    if (index[axis] < 0 || index[axis] >= static_cast<itk::IndexValueType>(imageGeometry->GetExtent(axis)))
+    {
+        mitkThrow() << "Figure at least partially outside of image bounds!";
+    }
+    const unsigned int slice = index[axis];
+
+    unsigned int i0 = 0;
+    unsigned int i1 = 1;
+    if (axis == 0)
+    {
+        i0 = 1;
+        i1 = 2;
+    }
+    else if (axis == 1)
+    {
+        i1 = 2;
+    }
+
+    // polylines in the index coordinates of the slice
+    std::vector< IndexPolygonType > polygons;
+    for (unsigned int i = 0; i < std::min<unsigned int>(m_PlanarFigure->GetPolyLinesSize(), 2); ++i)
+    {
+        const PlanarFigure::PolyLineType polyline = m_PlanarFigure->GetPolyLine(i);
+        IndexPolygonType polygon;
+        for (PlanarFigure::PolyLineType::const_iterator it = polyline.begin(); it != polyline.end(); ++it)
+        {
+            Point3D point3D;
+            planarFigureGeometry->Map(*it, point3D);
+            if (!imageGeometry->IsInside(point3D))
+            {
+                mitkThrow() << "Figure at least partially outside of image bounds!";
+            }
+            imageGeometry->WorldToIndex(point3D, point3D);
+
+            Point2D point;
+            point[0] = point3D[i0];
+            point[1] = point3D[i1];
+            polygon.push_back(point);
+        }
+        if (!polygon.empty())
+        {
+            polygons.push_back(polygon);
+        }
+    }
+
+    if (m_Tables.size() != m_InputImage->GetTimeSteps())
+    {
+        m_Tables.assign(m_InputImage->GetTimeSteps(), SliceTables());
+        for (std::vector<SliceTables>::iterator it = m_Tables.begin(); it != m_Tables.end(); ++it)
+        {
+            it->ImageUpdateTime = 0;
+        }
+    }
+
+    SliceTables &tables = m_Tables[timeStep];
+    if (tables.ImageUpdateTime < m_InputImage->GetMTime() || tables.Axis != axis || tables.Slice != slice)
+    {
+        this->UpdateTables(tables, timeStep, axis, slice);
+    }
+
+    // pixel (x, y) is inside if its center is inside the polygon. Rows and scanline intervals are half-open,
+    // [y0, y1) and [xa, xb), so that pixel centers on the border are counted once for adjacent figures.
+    const int width = tables.Width;
+    const int height = tables.Height;
+    unsigned long n = 0;
+    double sum = 0.;
+    double sumOfSquares = 0.;
+
+    if (polygons.size() == 1 && IsAxisAlignedRectangle(polygons[0]))
+    {
+        const IndexPolygonType &rectangle = polygons[0];
+        const double minX = std::min(std::min(rectangle[0][0], rectangle[1][0]), rectangle[2][0]);
+        const double maxX = std::max(std::max(rectangle[0][0], rectangle[1][0]), rectangle[2][0]);
+        const double minY = std::min(std::min(rectangle[0][1], rectangle[1][1]), rectangle[2][1]);
+        const double maxY = std::max(std::max(rectangle[0][1], rectangle[1][1]), rectangle[2][1]);
+
+        const int x0 = std::max(0, static_cast<int>(std::ceil(minX)));
+        const int x1 = std::min(width - 1, static_cast<int>(std::ceil(maxX)) - 1);
+        const int y0 = std::max(0, static_cast<int>(std::ceil(minY)));
+        const int y1 = std::min(height - 1, static_cast<int>(std::ceil(maxY)) - 1);
+
+        if (x0 <= x1 && y0 <= y1)
+        {
+            n = static_cast<unsigned long>(x1 - x0 + 1) * (y1 - y0 + 1);
+            sum = GetTableSum(tables.Sum, width, x0, y0, x1, y1);
+            sumOfSquares = GetTableSum(tables.SumOfSquares, width, x0, y0, x1, y1);
+        }
+    }
+    else
+    {
+        // scanline conversion with an active edge list, edges are sorted by their first row
+        std::vector< Edge > edges;
+        for (std::vector< IndexPolygonType >::const_iterator polygon = polygons.begin(); polygon != polygons.end(); ++polygon)
+        {
+            for (unsigned int i = 0; i < polygon->size(); ++i)
+            {
+                const Point2D &p = (*polygon)[i];
+                const Point2D &q = (*polygon)[(i + 1) % polygon->size()];
+                if (p[1] == q[1])
+                {
+                    continue;
+                }
+                Edge edge = p[1] < q[1] ? Edge{ p[0], p[1], q[0], q[1] } : Edge{ q[0], q[1], p[0], p[1] };
+                edges.push_back(edge);
+            }
+        }
+        std::sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) { return a.y0 < b.y0; });
+
+        std::vector< Edge > activeEdges;
+        std::vector< double > crossings;
+        std::vector< Edge >::const_iterator nextEdge = edges.begin();
+        const int firstRow = edges.empty() ? 0 : std::max(0, static_cast<int>(std::ceil(edges.front().y0)));
+
+        for (int y = firstRow; y < height && (nextEdge != edges.end() || !activeEdges.empty()); ++y)
+        {
+            // an edge covers the rows y0 <= y < y1
+            while (nextEdge != edges.end() && nextEdge->y0 <= y)
+            {
+                activeEdges.push_back(*nextEdge);
+                ++nextEdge;
+            }
+            activeEdges.erase(std::remove_if(activeEdges.begin(), activeEdges.end(),
+              [y](const Edge &edge) { return edge.y1 <= y; }), activeEdges.end());
+
+            crossings.clear();
+            for (std::vector< Edge >::const_iterator edge = activeEdges.begin(); edge != activeEdges.end(); ++edge)
+            {
+                crossings.push_back(edge->GetX(y));
+            }
+            std::sort(crossings.begin(), crossings.end());
+
+            for (unsigned int i = 0; i + 1 < crossings.size(); i += 2)
+            {
+                const int x0 = std::max(0, static_cast<int>(std::ceil(crossings[i])));
+                const int x1 = std::min(width - 1, static_cast<int>(std::ceil(crossings[i + 1])) - 1);
+                if (x0 <= x1)
+                {
+                    n += x1 - x0 + 1;
+                    sum += GetTableSum(tables.Sum, width, x0, y, x1, y);
+                    sumOfSquares += GetTableSum(tables.SumOfSquares, width, x0, y, x1, y);
+                }
+            }
+        }
+    }
+
+    Statistics statistics;
+    statistics.N = n;
+    statistics.Mean = n > 0 ? sum / n : 0.;
+    statistics.Variance = n > 1 ? std::max(0., (sumOfSquares - sum * sum / n) / (n - 1)) : 0.;
+    statistics.Std = std::sqrt(statistics.Variance);
+    statistics.RMS = std::sqrt(statistics.Mean * statistics.Mean + statistics.Variance);
+    return statistics;
+}
+
+}
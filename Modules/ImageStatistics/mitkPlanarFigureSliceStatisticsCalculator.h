@@ -0,0 +1,108 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKPLANARFIGURESLICESTATISTICSCALCULATOR
+#define MITKPLANARFIGURESLICESTATISTICSCALCULATOR
+
+#include <MitkImageStatisticsExports.h>
+#include <mitkImage.h>
+#include <mitkPlanarFigure.h>
+#include <itkImage.h>
+#include <itkObject.h>
+
+#include <vector>
+
+namespace mitk
+{
+/**
+* \class PlanarFigureSliceStatisticsCalculator
+* \brief Computes N, mean, standard deviation and RMS of the pixels inside a closed planar figure fast enough to
+* update them while the figure is dragged.
+*
+* For every time step the image slice that contains the planar figure is extracted once and summed-area tables of the
+* pixel values and of their squares are built. As long as the figure stays in this slice, the statistics are computed
+* from the tables only: an axis aligned rectangle needs four table lookups, all other figures (circles, polygons,
+* figures with a hole) four lookups per scanline interval of every covered image row. The tables are rebuilt if the
+* figure moves to another slice or the image is modified.
+*
+* A pixel is inside the figure if its center is inside the figure polyline (even-odd rule, a second polyline is a hole).
+* At the border of the figure this may differ from the mask of PlanarFigureMaskGenerator. Exact statistics (and all
+* statistics that need a histogram or the pixel order) are computed with ImageStatisticsCalculator once the
+* interaction has ended.
+*/
+class MITKIMAGESTATISTICS_EXPORT PlanarFigureSliceStatisticsCalculator: public itk::Object
+{
+public:
+    /** Standard Self typedef */
+    typedef PlanarFigureSliceStatisticsCalculator   Self;
+    typedef itk::Object                             Superclass;
+    typedef itk::SmartPointer< Self >               Pointer;
+    typedef itk::SmartPointer< const Self >         ConstPointer;
+
+    /** Method for creation through the object factory. */
+    itkNewMacro(Self)
+
+    /** Runtime information support. */
+    itkTypeMacro(PlanarFigureSliceStatisticsCalculator, itk::Object)
+
+    struct Statistics
+    {
+        unsigned long N;
+        double Mean;
+        /** unbiased estimate, like ImageStatisticsCalculator */
+        double Variance;
+        double Std;
+        double RMS;
+    };
+
+    void SetInputImage(mitk::Image::Pointer image);
+
+    void SetPlanarFigure(mitk::PlanarFigure::Pointer planarFigure);
+
+    /**
+     * @brief GetStatistics computes the statistics of the planar figure for the given time step.
+     * Throws if the figure is not closed, not aligned with the image axes or (partially) outside of the image.
+     */
+    Statistics GetStatistics(unsigned int timeStep = 0);
+
+protected:
+    PlanarFigureSliceStatisticsCalculator();
+
+private:
+    /** summed-area tables of one slice, table entry (x+1, y+1) is the sum over all pixels (i, j) with i<=x and j<=y */
+    struct SliceTables
+    {
+        unsigned int Axis;
+        unsigned int Slice;
+        unsigned long ImageUpdateTime;
+        unsigned int Width;
+        unsigned int Height;
+        std::vector<double> Sum;
+        std::vector<double> SumOfSquares;
+    };
+
+    template < typename TPixel, unsigned int VImageDimension >
+    void InternalBuildTables(const itk::Image< TPixel, VImageDimension > *image, SliceTables *tables);
+
+    void UpdateTables(SliceTables &tables, unsigned int timeStep, unsigned int axis, unsigned int slice);
+
+    mitk::Image::Pointer m_InputImage;
+    mitk::PlanarFigure::Pointer m_PlanarFigure;
+    std::vector<SliceTables> m_Tables;
+};
+}
+
+#endif // MITKPLANARFIGURESLICESTATISTICSCALCULATOR
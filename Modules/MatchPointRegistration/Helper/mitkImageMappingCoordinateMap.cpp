@@ -0,0 +1,369 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkImageMappingCoordinateMap.h"
+
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+#include <mitkPixelTypeMultiplex.h>
+
+#include <itkMultiThreader.h>
+
+#include "mapRegistration.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+namespace
+{
+  typedef ::map::core::Registration<3, 3> ConcreteRegistrationType;
+  typedef ::map::core::continuous::Elements<3>::PointType MAPPointType;
+
+  /** Number of voxels of an image geometry along each axis.*/
+  void getGridSize(const mitk::BaseGeometry* geometry, unsigned int size[3])
+  {
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      size[i] = static_cast<unsigned int>(geometry->GetExtent(i) + 0.5);
+    }
+  }
+
+  struct GenerateJob
+  {
+    const ConcreteRegistrationType* m_Registration;
+    unsigned int m_ResultSize[3];
+    unsigned int m_InputSize[3];
+    vnl_matrix_fixed<double, 3, 3> m_ResultIndexToWorld;
+    vnl_vector_fixed<double, 3> m_ResultOrigin;
+    vnl_matrix_fixed<double, 3, 3> m_InputWorldToIndex;
+    vnl_vector_fixed<double, 3> m_InputOrigin;
+    float* m_Indices;
+    unsigned char* m_States;
+  };
+
+  void mapVoxel(const GenerateJob* job, unsigned long voxel, unsigned int x, unsigned int y, unsigned int z)
+  {
+    vnl_vector_fixed<double, 3> index(x, y, z);
+    vnl_vector_fixed<double, 3> world = job->m_ResultOrigin + job->m_ResultIndexToWorld * index;
+
+    MAPPointType targetPoint;
+    MAPPointType movingPoint;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      targetPoint[i] = world[i];
+    }
+
+    float* continuousIndex = job->m_Indices + 3 * voxel;
+    if (!job->m_Registration->mapPointInverse(targetPoint, movingPoint))
+    {
+      std::fill(continuousIndex, continuousIndex + 3, 0.f);
+      job->m_States[voxel] = mitk::ImageMappingCoordinateMap::MappingError;
+      return;
+    }
+
+    vnl_vector_fixed<double, 3> moving(movingPoint[0], movingPoint[1], movingPoint[2]);
+    vnl_vector_fixed<double, 3> inputIndex = job->m_InputWorldToIndex * (moving - job->m_InputOrigin);
+
+    job->m_States[voxel] = mitk::ImageMappingCoordinateMap::Inside;
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      continuousIndex[i] = inputIndex[i];
+      //same test as itk::ImageFunction::IsInsideBuffer, voxels cover [index-0.5, index+0.5)
+      if (inputIndex[i] < -0.5 || inputIndex[i] >= job->m_InputSize[i] - 0.5)
+      {
+        job->m_States[voxel] = mitk::ImageMappingCoordinateMap::OutsideInput;
+      }
+    }
+  }
+
+  ITK_THREAD_RETURN_TYPE GenerateCallback(void* arg)
+  {
+    itk::MultiThreader::ThreadInfoStruct* info = static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+    const GenerateJob* job = static_cast<const GenerateJob*>(info->UserData);
+
+    const unsigned long sliceSize = static_cast<unsigned long>(job->m_ResultSize[0]) * job->m_ResultSize[1];
+    for (unsigned int z = info->ThreadID; z < job->m_ResultSize[2]; z += info->NumberOfThreads)
+    {
+      unsigned long voxel = z * sliceSize;
+      for (unsigned int y = 0; y < job->m_ResultSize[1]; ++y)
+      {
+        for (unsigned int x = 0; x < job->m_ResultSize[0]; ++x, ++voxel)
+        {
+          mapVoxel(job, voxel, x, y, z);
+        }
+      }
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  struct ApplyJob
+  {
+    const mitk::ImageMappingCoordinateMap* m_Map;
+    unsigned int m_InputSize[3];
+    bool m_UseLinearInterpolation;
+    double m_PaddingValue;
+    double m_ErrorValue;
+    std::vector<const void*> m_Inputs;
+    std::vector<void*> m_Results;
+  };
+
+  /** Number of voxels that are gathered for all time steps before the next block is processed.*/
+  const unsigned long BlockSize = 4096;
+
+  template <typename TPixel>
+  TPixel castValue(double value)
+  {
+    //like itk::ResampleImageFilter, values outside of the pixel range are clamped
+    if (value < static_cast<double>(std::numeric_limits<TPixel>::lowest()))
+    {
+      return std::numeric_limits<TPixel>::lowest();
+    }
+    if (value > static_cast<double>(std::numeric_limits<TPixel>::max()))
+    {
+      return std::numeric_limits<TPixel>::max();
+    }
+    return static_cast<TPixel>(value);
+  }
+
+  template <typename TPixel>
+  ITK_THREAD_RETURN_TYPE ApplyCallback(void* arg)
+  {
+    itk::MultiThreader::ThreadInfoStruct* info = static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+    const ApplyJob* job = static_cast<const ApplyJob*>(info->UserData);
+
+    const unsigned long numberOfVoxels = job->m_Map->GetNumberOfVoxels();
+    const long strideY = job->m_InputSize[0];
+    const long strideZ = strideY * job->m_InputSize[1];
+    const TPixel padding = castValue<TPixel>(job->m_PaddingValue);
+    const TPixel error = castValue<TPixel>(job->m_ErrorValue);
+
+    for (unsigned long begin = info->ThreadID * BlockSize; begin < numberOfVoxels; begin += info->NumberOfThreads * BlockSize)
+    {
+      const unsigned long end = std::min(begin + BlockSize, numberOfVoxels);
+      for (std::size_t t = 0; t < job->m_Inputs.size(); ++t)
+      {
+        const TPixel* input = static_cast<const TPixel*>(job->m_Inputs[t]);
+        TPixel* result = static_cast<TPixel*>(job->m_Results[t]);
+
+        for (unsigned long voxel = begin; voxel < end; ++voxel)
+        {
+          const mitk::ImageMappingCoordinateMap::VoxelState state = job->m_Map->GetState(voxel);
+          if (state != mitk::ImageMappingCoordinateMap::Inside)
+          {
+            result[voxel] = state == mitk::ImageMappingCoordinateMap::OutsideInput ? padding : error;
+            continue;
+          }
+
+          const float* index = job->m_Map->GetIndex(voxel);
+          if (!job->m_UseLinearInterpolation)
+          {
+            //like itk::NearestNeighborInterpolateImageFunction (round half up)
+            long offset = 0;
+            for (unsigned int i = 0; i < 3; ++i)
+            {
+              //the index is stored in single precision and may round up to the voxel behind the border
+              const long size = job->m_InputSize[i];
+              const long nearest = std::max(0L, std::min(size - 1, static_cast<long>(std::floor(index[i] + 0.5))));
+              offset += nearest * (i == 0 ? 1 : (i == 1 ? strideY : strideZ));
+            }
+            result[voxel] = input[offset];
+            continue;
+          }
+
+          //like itk::LinearInterpolateImageFunction, neighbors outside of the buffer are replaced by the border voxels
+          long lower[3];
+          long upper[3];
+          double weight[3];
+          for (unsigned int i = 0; i < 3; ++i)
+          {
+            const long size = job->m_InputSize[i];
+            lower[i] = std::max(0L, std::min(size - 1, static_cast<long>(std::floor(index[i]))));
+            upper[i] = std::min(size - 1, lower[i] + 1);
+            weight[i] = std::max(0.0, std::min(1.0, static_cast<double>(index[i]) - lower[i]));
+          }
+
+          double value = 0;
+          for (unsigned int corner = 0; corner < 8; ++corner)
+          {
+            double w = 1;
+            long offset = 0;
+            const long* x = (corner & 1) ? upper : lower;
+            const long* y = (corner & 2) ? upper : lower;
+            const long* z = (corner & 4) ? upper : lower;
+            w *= (corner & 1) ? weight[0] : 1 - weight[0];
+            w *= (corner & 2) ? weight[1] : 1 - weight[1];
+            w *= (corner & 4) ? weight[2] : 1 - weight[2];
+            if (w == 0)
+            {
+              continue;
+            }
+            offset = x[0] + y[1] * strideY + z[2] * strideZ;
+            value += w * input[offset];
+          }
+          result[voxel] = castValue<TPixel>(value);
+        }
+      }
+    }
+
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  template <typename TPixel>
+  void applyMap(const mitk::PixelType&, ApplyJob* job)
+  {
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetSingleMethod(ApplyCallback<TPixel>, job);
+    threader->SingleMethodExecute();
+  }
+
+  bool equalGeometries(const mitk::BaseGeometry* geometry1, const mitk::BaseGeometry* geometry2)
+  {
+    return geometry1 && geometry2 && mitk::Equal(*geometry1, *geometry2, mitk::eps, false);
+  }
+}
+
+mitk::ImageMappingCoordinateMap::ImageMappingCoordinateMap() : m_Registration(NULL), m_RegistrationMTime(0)
+{
+  std::fill(m_InputSize, m_InputSize + 3, 0);
+}
+
+mitk::ImageMappingCoordinateMap::~ImageMappingCoordinateMap()
+{
+}
+
+void mitk::ImageMappingCoordinateMap::Generate(const RegistrationType* registration, const BaseGeometry* inputGeometry, const BaseGeometry* resultGeometry)
+{
+  if (!registration)
+  {
+    mitkThrow() << "Cannot generate coordinate map. Passed registration pointer is NULL.";
+  }
+  if (!inputGeometry || !resultGeometry)
+  {
+    mitkThrow() << "Cannot generate coordinate map. Passed geometry pointer is NULL.";
+  }
+
+  GenerateJob job;
+  job.m_Registration = dynamic_cast<const ConcreteRegistrationType*>(registration);
+  if (!job.m_Registration)
+  {
+    mitkThrow() << "Cannot generate coordinate map. Only 3D registrations are supported.";
+  }
+
+  getGridSize(resultGeometry, job.m_ResultSize);
+  getGridSize(inputGeometry, job.m_InputSize);
+  job.m_ResultIndexToWorld = resultGeometry->GetIndexToWorldTransform()->GetMatrix().GetVnlMatrix();
+  job.m_InputWorldToIndex = inputGeometry->GetIndexToWorldTransform()->GetMatrix().GetInverse();
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    job.m_ResultOrigin[i] = resultGeometry->GetOrigin()[i];
+    job.m_InputOrigin[i] = inputGeometry->GetOrigin()[i];
+  }
+
+  const unsigned long numberOfVoxels = static_cast<unsigned long>(job.m_ResultSize[0]) * job.m_ResultSize[1] * job.m_ResultSize[2];
+  m_Indices.assign(3 * numberOfVoxels, 0.f);
+  m_States.assign(numberOfVoxels, Inside);
+  job.m_Indices = m_Indices.data();
+  job.m_States = m_States.data();
+
+  if (numberOfVoxels > 0)
+  {
+    //lazy kernels generate their field with the first mapped point, this must not happen in several threads at once
+    mapVoxel(&job, 0, 0, 0, 0);
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetSingleMethod(GenerateCallback, &job);
+    threader->SingleMethodExecute();
+  }
+
+  m_Registration = registration;
+  m_RegistrationMTime = registration->GetMTime();
+  m_InputGeometry = inputGeometry->Clone().GetPointer();
+  m_ResultGeometry = resultGeometry->Clone().GetPointer();
+  std::copy(job.m_InputSize, job.m_InputSize + 3, m_InputSize);
+}
+
+bool mitk::ImageMappingCoordinateMap::Fits(const RegistrationType* registration, const BaseGeometry* inputGeometry, const BaseGeometry* resultGeometry) const
+{
+  return registration && registration == m_Registration && registration->GetMTime() == m_RegistrationMTime &&
+    equalGeometries(inputGeometry, m_InputGeometry) && equalGeometries(resultGeometry, m_ResultGeometry);
+}
+
+unsigned long mitk::ImageMappingCoordinateMap::GetNumberOfVoxels(VoxelState state) const
+{
+  return std::count(m_States.begin(), m_States.end(), static_cast<unsigned char>(state));
+}
+
+void mitk::ImageMappingCoordinateMap::Apply(const Image* input, Image* result, bool useLinearInterpolation,
+  bool throwOnOutOfInputAreaError, double paddingValue, bool throwOnMappingError, double errorValue) const
+{
+  if (!input || !result)
+  {
+    mitkThrow() << "Cannot apply coordinate map. Passed image pointer is NULL.";
+  }
+  if (m_ResultGeometry.IsNull())
+  {
+    mitkThrow() << "Cannot apply coordinate map. Map was not generated.";
+  }
+  if (input->GetPixelType() != result->GetPixelType() || input->GetPixelType().GetNumberOfComponents() != 1)
+  {
+    mitkThrow() << "Cannot apply coordinate map. Input and result must have the same scalar pixel type.";
+  }
+  if (input->GetTimeSteps() != result->GetTimeSteps())
+  {
+    mitkThrow() << "Cannot apply coordinate map. Input and result must have the same number of time steps.";
+  }
+  unsigned int resultSize[3];
+  getGridSize(m_ResultGeometry, resultSize);
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    if (input->GetDimension(i) != m_InputSize[i] || result->GetDimension(i) != resultSize[i])
+    {
+      mitkThrow() << "Cannot apply coordinate map. Image size does not match the grids of the map.";
+    }
+  }
+
+  //the map does not depend on the pixel values, so errors are detected before anything is mapped
+  if (throwOnMappingError && this->GetNumberOfVoxels(MappingError) > 0)
+  {
+    mitkThrow() << "Cannot map image. Registration does not cover " << this->GetNumberOfVoxels(MappingError) << " voxels of the result.";
+  }
+  if (throwOnOutOfInputAreaError && this->GetNumberOfVoxels(OutsideInput) > 0)
+  {
+    mitkThrow() << "Cannot map image. " << this->GetNumberOfVoxels(OutsideInput) << " voxels of the result are mapped outside of the input image.";
+  }
+
+  ApplyJob job;
+  job.m_Map = this;
+  std::copy(m_InputSize, m_InputSize + 3, job.m_InputSize);
+  job.m_UseLinearInterpolation = useLinearInterpolation;
+  job.m_PaddingValue = paddingValue;
+  job.m_ErrorValue = errorValue;
+
+  std::vector<std::unique_ptr<ImageReadAccessor> > inputAccessors;
+  std::vector<std::unique_ptr<ImageWriteAccessor> > resultAccessors;
+  for (unsigned int t = 0; t < input->GetTimeSteps(); ++t)
+  {
+    inputAccessors.emplace_back(new ImageReadAccessor(input, input->GetVolumeData(t)));
+    resultAccessors.emplace_back(new ImageWriteAccessor(result, result->GetVolumeData(t)));
+    job.m_Inputs.push_back(inputAccessors.back()->GetData());
+    job.m_Results.push_back(resultAccessors.back()->GetData());
+  }
+
+  mitkPixelTypeMultiplex1(applyMap, input->GetPixelType(), &job);
+}
@@ -0,0 +1,103 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef MITK_IMAGE_MAPPING_COORDINATE_MAP_H
+#define MITK_IMAGE_MAPPING_COORDINATE_MAP_H
+
+#include <mitkImage.h>
+#include <mitkBaseGeometry.h>
+
+#include <mapRegistrationBase.h>
+
+#include <vector>
+
+#include "MitkMatchPointRegistrationExports.h"
+
+namespace mitk
+{
+  /** Map that stores for every voxel of a result grid the continuous index in the grid of the input image,
+   * where the inverse kernel of a registration maps the voxel to.
+   * The registration is evaluated only once when the map is generated. Afterwards the map can be applied to all
+   * time steps of an image and to other images on the same input grid (see ImageMappingHelper::map). Only
+   * nearest neighbor and linear interpolation are supported, the values are gathered in parallel.
+   * The continuous indices are stored in single precision (12 bytes per voxel plus one byte for the voxel state).
+   * Only 3D registrations are supported.
+   */
+  class MITKMATCHPOINTREGISTRATION_EXPORT ImageMappingCoordinateMap : public itk::LightObject
+  {
+  public:
+    mitkClassMacroItkParent(ImageMappingCoordinateMap, itk::LightObject);
+
+    itkFactorylessNewMacro(Self);
+
+    typedef ::map::core::RegistrationBase RegistrationType;
+
+    /** State of a result voxel.*/
+    enum VoxelState
+    {
+      Inside = 0, //< voxel is mapped into the input grid
+      OutsideInput = 1, //< voxel is mapped outside of the input grid (padding)
+      MappingError = 2 //< inverse kernel does not cover the voxel
+    };
+
+    /**Evaluates the inverse kernel of the registration for every voxel of the result geometry.
+     * @pre registration must be a valid 3D registration
+     * @pre inputGeometry and resultGeometry must be valid image geometries*/
+    void Generate(const RegistrationType* registration, const BaseGeometry* inputGeometry, const BaseGeometry* resultGeometry);
+
+    /**Indicates if the map was generated for the registration (in its current modification state) and the geometries.*/
+    bool Fits(const RegistrationType* registration, const BaseGeometry* inputGeometry, const BaseGeometry* resultGeometry) const;
+
+    /**Maps all time steps of the input into the corresponding time steps of the result.
+     * @pre input and result must have scalar pixels of the same type and the same number of time steps.
+     * @pre every time step of the input must have the input geometry of the map and the result the result geometry.
+     * @remark Throws if throwOnOutOfInputAreaError or throwOnMappingError is set and a voxel is mapped outside of
+     * the input grid or not covered by the registration.*/
+    void Apply(const Image* input, Image* result, bool useLinearInterpolation,
+      bool throwOnOutOfInputAreaError, double paddingValue, bool throwOnMappingError, double errorValue) const;
+
+    unsigned long GetNumberOfVoxels() const { return m_States.size(); }
+    unsigned long GetNumberOfVoxels(VoxelState state) const;
+
+    /**Continuous index (3 values) of a result voxel in the input grid.*/
+    const float* GetIndex(unsigned long voxel) const { return &m_Indices[3*voxel]; }
+    VoxelState GetState(unsigned long voxel) const { return static_cast<VoxelState>(m_States[voxel]); }
+
+    /**Approximate memory consumption in bytes.*/
+    unsigned long GetMemorySize() const { return m_Indices.size()*sizeof(float) + m_States.size(); }
+
+  protected:
+    ImageMappingCoordinateMap();
+    virtual ~ImageMappingCoordinateMap();
+
+  private:
+    ImageMappingCoordinateMap(const Self&); //purposely not implemented
+    void operator=(const Self&); //purposely not implemented
+
+    const RegistrationType* m_Registration;
+    unsigned long m_RegistrationMTime;
+    BaseGeometry::ConstPointer m_InputGeometry;
+    BaseGeometry::ConstPointer m_ResultGeometry;
+
+    unsigned int m_InputSize[3];
+    std::vector<float> m_Indices;
+    std::vector<unsigned char> m_States;
+  };
+
+}
+
+#endif
@@ -29,6 +29,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mapRegistration.h"
 
 #include "mitkImageMappingHelper.h"
+#include "mitkImageMappingCoordinateMap.h"
 #include "mitkRegistrationHelper.h"
 
 template <typename TImage >
@@ -137,7 +138,8 @@ void doMITKMap(const ::itk::Image<TPixelType,VImageDimension>* input, mitk::Imag
     {
       origin[i] = static_cast<typename ResultImageDescriptorType::PointType::ValueType>(geoOrigin[i]);
       fieldSpacing[i] = static_cast<typename ResultImageDescriptorType::SpacingType::ValueType>(geoSpacing[i]);
-      size[i] = static_cast<typename ResultImageDescriptorType::SizeType::SizeValueType>(geoBounds[(2*i)+1]-geoBounds[2*i])*fieldSpacing[i];
+      //the bounds of an image geometry are given in voxels, so their difference already is the voxel count
+      size[i] = static_cast<typename ResultImageDescriptorType::SizeType::SizeValueType>(geoBounds[(2*i)+1]-geoBounds[2*i]+0.5);
     }
 
     //Matrix extraction
@@ -222,18 +224,104 @@ void doMITKMap(const ::itk::Image<TPixelType,VImageDimension>* input, mitk::Imag
   mitk::CastToMitkImage<>(spTask->getResultImage(),result);
 }
 
+/**Checks if the image can be mapped with an ImageMappingCoordinateMap instead of a mapping task per time step.*/
+bool canUseCoordinateMap(const mitk::ImageMappingHelper::InputImageType* input, const mitk::ImageMappingHelper::RegistrationType* registration,
+  mitk::ImageMappingInterpolator::Type interpolatorType)
+{
+  if (input->GetDimension() < 3 || input->GetDimension() > 4 || input->GetPixelType().GetNumberOfComponents() != 1)
+  {
+    return false;
+  }
+  if (registration->getMovingDimensions() != 3 || registration->getTargetDimensions() != 3)
+  {
+    return false;
+  }
+  if (interpolatorType != mitk::ImageMappingInterpolator::NearestNeighbor && interpolatorType != mitk::ImageMappingInterpolator::Linear &&
+    interpolatorType != mitk::ImageMappingInterpolator::UserDefined)
+  {
+    return false;
+  }
+
+  //one map is used for all time steps
+  for (unsigned int i = 1; i<input->GetTimeSteps(); ++i)
+  {
+    if (!mitk::Equal(*(input->GetGeometry(0)), *(input->GetGeometry(i)), mitk::eps, false))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
 mitk::ImageMappingHelper::ResultImageType::Pointer
-  mitk::ImageMappingHelper::map(const InputImageType* input, const RegistrationType* registration,
-  bool throwOnOutOfInputAreaError, const double& paddingValue, const ResultImageGeometryType* resultGeometry,
+  mapByCoordinateMap(const mitk::ImageMappingHelper::InputImageType* input, const mitk::ImageMappingCoordinateMap* coordinateMap,
+  bool throwOnOutOfInputAreaError, const double& paddingValue, const mitk::ImageMappingHelper::ResultImageGeometryType* resultGeometry,
   bool throwOnMappingError, const double& errorValue, mitk::ImageMappingInterpolator::Type interpolatorType)
 {
-  if (!registration)
+  mitk::TimeGeometry::Pointer mappedTimeGeometry = input->GetTimeGeometry()->Clone();
+
+  for (unsigned int i = 0; i<input->GetTimeSteps(); ++i)
   {
-    mitkThrow() << "Cannot map image. Passed registration wrapper pointer is NULL.";
+    mitk::ImageMappingHelper::ResultImageGeometryType::Pointer mappedGeometry = resultGeometry->Clone();
+    mappedTimeGeometry->SetTimeStepGeometry(mappedGeometry,i);
   }
-  if (!input)
-  {
-    mitkThrow() << "Cannot map image. Passed image pointer is NULL.";
+
+  mitk::ImageMappingHelper::ResultImageType::Pointer result = mitk::Image::New();
+  result->Initialize(input->GetPixelType(),*mappedTimeGeometry, 1, input->GetTimeSteps());
+
+  //user defined interpolation falls back to linear, like in generateInterpolator
+  coordinateMap->Apply(input, result, interpolatorType != mitk::ImageMappingInterpolator::NearestNeighbor,
+    throwOnOutOfInputAreaError, paddingValue, throwOnMappingError, errorValue);
+  return result;
+}
+
+mitk::ImageMappingHelper::ResultImageType::Pointer
+  doMap(const mitk::ImageMappingHelper::InputImageType* input, const mitk::ImageMappingHelper::RegistrationType* registration,
+  const mitk::ImageMappingHelper::MITKRegistrationType* wrapper,
+  bool throwOnOutOfInputAreaError, const double& paddingValue, const mitk::ImageMappingHelper::ResultImageGeometryType* resultGeometry,
+  bool throwOnMappingError, const double& errorValue, mitk::ImageMappingInterpolator::Type interpolatorType)
+{
+  typedef mitk::ImageMappingHelper::InputImageType InputImageType;
+  typedef mitk::ImageMappingHelper::ResultImageType ResultImageType;
+  typedef mitk::ImageMappingHelper::ResultImageGeometryType ResultImageGeometryType;
+
+  if (!resultGeometry && input->GetTimeSteps()>1)
+  { //like the mapping task, use the input grid
+    resultGeometry = input->GetGeometry(0);
+  }
+
+  if (canUseCoordinateMap(input, registration, interpolatorType))
+  { //evaluate the registration once for all time steps. A map cached by the wrapper is also used for single time steps,
+    //because it spares the evaluation of the registration completely.
+    const ResultImageGeometryType* inputGeometry = input->GetGeometry(0);
+    const ResultImageGeometryType* gridGeometry = resultGeometry ? resultGeometry : inputGeometry;
+
+    mitk::ImageMappingCoordinateMap::ConstPointer coordinateMap;
+    if (wrapper)
+    {
+      coordinateMap = wrapper->GetCachedCoordinateMap();
+      if (coordinateMap.IsNotNull() && !coordinateMap->Fits(registration, inputGeometry, gridGeometry))
+      {
+        coordinateMap = NULL;
+      }
+    }
+
+    if (coordinateMap.IsNull() && input->GetTimeSteps()>1)
+    {
+      mitk::ImageMappingCoordinateMap::Pointer newMap = mitk::ImageMappingCoordinateMap::New();
+      newMap->Generate(registration, inputGeometry, gridGeometry);
+      coordinateMap = newMap;
+
+      if (wrapper)
+      {
+        wrapper->SetCachedCoordinateMap(newMap);
+      }
+    }
+
+    if (coordinateMap.IsNotNull())
+    {
+      return mapByCoordinateMap(input, coordinateMap, throwOnOutOfInputAreaError, paddingValue, gridGeometry, throwOnMappingError, errorValue, interpolatorType);
+    }
   }
 
   ResultImageType::Pointer result;
@@ -274,6 +362,23 @@ mitk::ImageMappingHelper::ResultImageType::Pointer
   return result;
 }
 
+mitk::ImageMappingHelper::ResultImageType::Pointer
+  mitk::ImageMappingHelper::map(const InputImageType* input, const RegistrationType* registration,
+  bool throwOnOutOfInputAreaError, const double& paddingValue, const ResultImageGeometryType* resultGeometry,
+  bool throwOnMappingError, const double& errorValue, mitk::ImageMappingInterpolator::Type interpolatorType)
+{
+  if (!registration)
+  {
+    mitkThrow() << "Cannot map image. Passed registration wrapper pointer is NULL.";
+  }
+  if (!input)
+  {
+    mitkThrow() << "Cannot map image. Passed image pointer is NULL.";
+  }
+
+  return doMap(input, registration, NULL, throwOnOutOfInputAreaError, paddingValue, resultGeometry, throwOnMappingError, errorValue, interpolatorType);
+}
+
 mitk::ImageMappingHelper::ResultImageType::Pointer
   mitk::ImageMappingHelper::map(const InputImageType* input, const MITKRegistrationType* registration,
   bool throwOnOutOfInputAreaError, const double& paddingValue, const ResultImageGeometryType* resultGeometry,
@@ -292,8 +397,7 @@ mitk::ImageMappingHelper::ResultImageType::Pointer
     mitkThrow() << "Cannot map image. Passed image pointer is NULL.";
   }
 
-  ResultImageType::Pointer result = map(input, registration->GetRegistration(), throwOnOutOfInputAreaError, paddingValue, resultGeometry, throwOnMappingError, errorValue);
-  return result;
+  return doMap(input, registration->GetRegistration(), registration, throwOnOutOfInputAreaError, paddingValue, resultGeometry, throwOnMappingError, errorValue, interpolatorType);
 }
 
 
@@ -65,6 +65,9 @@ namespace mitk
      * @pre Dimensionality of the registration must match with the input imageinput must be valid
      * @remark Depending in the settings of throwOnOutOfInputAreaError and throwOnMappingError it may also throw
      * due to inconsistencies in the mapping process. See parameter description.
+     * @remark Images with several time steps are mapped with an ImageMappingCoordinateMap if the registration is 3D, the pixels are scalar,
+     * all time steps share one geometry and nearest neighbor or linear interpolation is requested. The registration is then evaluated only
+     * once for all time steps.
      * @result Pointer to the resulting mapped image.h*/
     MITKMATCHPOINTREGISTRATION_EXPORT ResultImageType::Pointer map(const InputImageType* input, const RegistrationType* registration,
       bool throwOnOutOfInputAreaError = false, const double& paddingValue = 0,
@@ -86,6 +89,9 @@ namespace mitk
      * @pre Dimensionality of the registration must match with the input imageinput must be valid
      * @remark Depending in the settings of throwOnOutOfInputAreaError and throwOnMappingError it may also throw
      * due to inconsistencies in the mapping process. See parameter description.
+     * @remark The coordinate map generated for images with several time steps is cached by the wrapper (see
+     * MAPRegistrationWrapper::GetCachedCoordinateMap) and reused for all further images (also with a single time step)
+     * that have the same input and result geometry.
      * @result Pointer to the resulting mapped image.h*/
     MITKMATCHPOINTREGISTRATION_EXPORT ResultImageType::Pointer map(const InputImageType* input, const MITKRegistrationType* registration,
       bool throwOnOutOfInputAreaError = false, const double& paddingValue = 0,
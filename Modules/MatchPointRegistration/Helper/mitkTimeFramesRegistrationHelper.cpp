@@ -20,6 +20,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImageTimeSelector.h>
 #include <mitkImageReadAccessor.h>
 
+#include <itkMutexLockHolder.h>
+#include <itkSimpleFastMutexLock.h>
+
+#include <mapMetaPropertyAlgorithmInterface.h>
+#include <mapMetaProperty.h>
+
 #include <mitkMaskedAlgorithmHelper.h>
 #include <mitkAlgorithmHelper.h>
 
@@ -36,75 +42,374 @@ mitk::TimeFramesRegistrationHelper::GetFrameImage(const mitk::Image* image,
   return frameImage;
 };
 
+/** State of the frame processing that is shared by all threads.*/
+struct mitk::TimeFramesRegistrationHelper::FrameScheduler
+{
+  typedef std::vector<RegistrationAlgorithmPointer> AlgorithmVectorType;
+
+  TimeFramesRegistrationHelper* m_Helper;
+  AlgorithmVectorType m_Algorithms;
+
+  Image::Pointer m_TargetFrame;
+  Image::ConstPointer m_TargetMask;
+  double m_ProgressDelta;
+
+  /** Guards all following members.*/
+  itk::SimpleFastMutexLock m_Mutex;
+  /** Next frame that should be registered.*/
+  unsigned int m_NextFrame;
+  /** Next frame that should be added to the result image.*/
+  unsigned int m_NextPublishedFrame;
+  /** Indicates that a thread adds frames to the result image. Frames are added and their events invoked without
+   * holding the mutex, this flag keeps them in ascending order.*/
+  bool m_Publishing;
+  std::vector<bool> m_Ignored;
+  std::vector<Image::Pointer> m_MappedFrames;
+  bool m_Failed;
+  std::string m_ErrorMessage;
+};
+
+namespace
+{
+  /** Name of the meta property that controls the number of threads of an algorithm.*/
+  const char* const NUMBER_OF_THREADS_PROPERTY = "NumberOfThreads";
+
+  typedef ::map::algorithm::facet::MetaPropertyAlgorithmInterface MetaPropertyInterfaceType;
+
+  template <typename TValue>
+  ::map::core::MetaPropertyBase::Pointer createNumberOfThreadsProperty(const ::map::algorithm::MetaPropertyInfo* info,
+    unsigned int numberOfThreads)
+  {
+    if (info->getTypeInfo() == typeid(TValue))
+    {
+      return ::map::core::MetaProperty<TValue>::New(static_cast<TValue>(numberOfThreads)).GetPointer();
+    }
+    return NULL;
+  }
+
+  /** Sets the number of threads of an algorithm that offers a writable meta property "NumberOfThreads".
+   * Only this algorithm instance is affected, other algorithms and filters keep the ITK default.
+   * @return the previous value of the property, or NULL if the algorithm has no such property.*/
+  ::map::core::MetaPropertyBase::Pointer setAlgorithmNumberOfThreads(
+    ::map::algorithm::RegistrationAlgorithmBase* algorithm, unsigned int numberOfThreads)
+  {
+    MetaPropertyInterfaceType* metaInterface = dynamic_cast<MetaPropertyInterfaceType*>(algorithm);
+    if (!metaInterface)
+    {
+      return NULL;
+    }
+
+    MetaPropertyInterfaceType::MetaPropertyVectorType infos = metaInterface->getPropertyInfos();
+    for (MetaPropertyInterfaceType::MetaPropertyVectorType::const_iterator pos = infos.begin(); pos != infos.end(); ++pos)
+    {
+      if ((*pos)->getName() != NUMBER_OF_THREADS_PROPERTY || !(*pos)->isReadable() || !(*pos)->isWritable())
+      {
+        continue;
+      }
+
+      ::map::core::MetaPropertyBase::Pointer property = createNumberOfThreadsProperty<int>(*pos, numberOfThreads);
+      if (property.IsNull())
+      {
+        property = createNumberOfThreadsProperty<unsigned int>(*pos, numberOfThreads);
+      }
+      if (property.IsNull())
+      {
+        property = createNumberOfThreadsProperty<long>(*pos, numberOfThreads);
+      }
+      if (property.IsNull())
+      {
+        property = createNumberOfThreadsProperty<unsigned long>(*pos, numberOfThreads);
+      }
+
+      MetaPropertyInterfaceType::MetaPropertyPointer previous = metaInterface->getProperty(*pos);
+      if (property.IsNotNull() && previous.IsNotNull() && metaInterface->setProperty(*pos, property))
+      {
+        return previous;
+      }
+    }
+    return NULL;
+  }
+
+  void restoreAlgorithmNumberOfThreads(::map::algorithm::RegistrationAlgorithmBase* algorithm,
+    const ::map::core::MetaPropertyBase* previous)
+  {
+    MetaPropertyInterfaceType* metaInterface = dynamic_cast<MetaPropertyInterfaceType*>(algorithm);
+    if (metaInterface && previous)
+    {
+      metaInterface->setProperty(NUMBER_OF_THREADS_PROPERTY, previous);
+    }
+  }
+}
+
 void
 mitk::TimeFramesRegistrationHelper::Generate()
 {
   CheckValidInputs();
 
+  FrameScheduler scheduler;
+  scheduler.m_Helper = this;
+
   //prepare processing
-  mitk::Image::Pointer targetFrame = GetFrameImage(this->m_4DImage, 0);
+  //target frame and mask are extracted once and shared by all frame registrations
+  scheduler.m_TargetFrame = GetFrameImage(this->m_4DImage, 0);
 
   this->m_Registered4DImage = this->m_4DImage->Clone();
 
-  Image::ConstPointer mask;
-
   if (m_TargetMask.IsNotNull())
   {
     if (m_TargetMask->GetTimeSteps() > 1)
     {
-      mask = GetFrameImage(m_TargetMask, 0);
+      scheduler.m_TargetMask = GetFrameImage(m_TargetMask, 0);
     }
     else
     {
-      mask = m_TargetMask;
+      scheduler.m_TargetMask = m_TargetMask;
     }
   }
 
-  double progressDelta = 1.0 / ((this->m_4DImage->GetTimeSteps() - 1) * 3.0);
+  scheduler.m_ProgressDelta = 1.0 / ((this->m_4DImage->GetTimeSteps() - 1) * 3.0);
   m_Progress = 0.0;
 
-  //process the frames
+  scheduler.m_NextFrame = 1;
+  scheduler.m_NextPublishedFrame = 1;
+  scheduler.m_Publishing = false;
+  scheduler.m_Ignored.assign(this->m_4DImage->GetTimeSteps(), false);
+  scheduler.m_MappedFrames.resize(this->m_4DImage->GetTimeSteps());
+  scheduler.m_Failed = false;
+
+  unsigned int numberOfProcessedFrames = 0;
   for (unsigned int i = 1; i < this->m_4DImage->GetTimeSteps(); ++i)
   {
-    Image::Pointer movingFrame = GetFrameImage(this->m_4DImage, i);
-    Image::Pointer mappedFrame;
+    scheduler.m_Ignored[i] = std::find(m_IgnoreList.begin(), m_IgnoreList.end(), i) != m_IgnoreList.end();
+    if (!scheduler.m_Ignored[i])
+    {
+      ++numberOfProcessedFrames;
+    }
+  }
 
-    IgnoreListType::iterator finding = std::find(m_IgnoreList.begin(), m_IgnoreList.end(), i);
+  //the first thread uses the algorithm itself, every further thread a copy
+  scheduler.m_Algorithms.push_back(m_Algorithm);
+  const unsigned int numberOfThreads = std::max(1u, std::min(m_NumberOfConcurrentFrames, numberOfProcessedFrames));
+  while (scheduler.m_Algorithms.size() < numberOfThreads)
+  {
+    RegistrationAlgorithmPointer algorithm = this->CloneAlgorithm();
+    if (algorithm.IsNull())
+    {
+      MITK_WARN << "Registration algorithm cannot be copied. Frames will be registered sequentially.";
+      scheduler.m_Algorithms.resize(1);
+      break;
+    }
+    scheduler.m_Algorithms.push_back(algorithm);
+  }
 
+  //process the frames
+  if (scheduler.m_Algorithms.size() == 1)
+  {
+    this->ProcessFrames(&scheduler, m_Algorithm);
+  }
+  else
+  {
+    unsigned int threadsPerFrame = m_NumberOfThreadsPerFrame;
+    if (threadsPerFrame == 0)
+    {
+      threadsPerFrame = std::max<unsigned int>(1, itk::MultiThreader::GetGlobalDefaultNumberOfThreads() / scheduler.m_Algorithms.size());
+    }
 
-    if (finding == m_IgnoreList.end())
+    //the budget is applied to every algorithm instance, the set algorithm gets its own value back afterwards
+    std::vector< ::map::core::MetaPropertyBase::Pointer> previousNumberOfThreads;
+    for (AlgorithmVectorType::const_iterator pos = scheduler.m_Algorithms.begin(); pos != scheduler.m_Algorithms.end(); ++pos)
     {
-      //frame should be processed
-      RegistrationPointer reg = DoFrameRegistration(movingFrame, targetFrame, mask);
+      previousNumberOfThreads.push_back(setAlgorithmNumberOfThreads(*pos, threadsPerFrame));
+    }
+    if (previousNumberOfThreads.front().IsNull())
+    {
+      MITK_DEBUG << "Registration algorithm has no property " << NUMBER_OF_THREADS_PROPERTY
+                 << ". Every concurrent frame uses the ITK default number of threads.";
+    }
+
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads(scheduler.m_Algorithms.size());
+    threader->SetSingleMethod(FrameThreadCallback, &scheduler);
+    threader->SingleMethodExecute();
+
+    restoreAlgorithmNumberOfThreads(m_Algorithm, previousNumberOfThreads.front());
+  }
+
+  if (scheduler.m_Failed)
+  {
+    this->m_Registered4DImage = NULL;
+    mitkThrow() << scheduler.m_ErrorMessage;
+  }
+};
+
+ITK_THREAD_RETURN_TYPE
+mitk::TimeFramesRegistrationHelper::FrameThreadCallback(void* arg)
+{
+  itk::MultiThreader::ThreadInfoStruct* info = static_cast<itk::MultiThreader::ThreadInfoStruct*>(arg);
+  FrameScheduler* scheduler = static_cast<FrameScheduler*>(info->UserData);
+
+  if (info->ThreadID < scheduler->m_Algorithms.size())
+  {
+    scheduler->m_Helper->ProcessFrames(scheduler, scheduler->m_Algorithms[info->ThreadID]);
+  }
 
-      m_Progress += progressDelta;
-      this->InvokeEvent(::mitk::FrameRegistrationEvent(0,
-                        "Registred frame #" +::map::core::convert::toStr(i)));
+  return ITK_THREAD_RETURN_VALUE;
+};
 
-      mappedFrame = DoFrameMapping(movingFrame, reg, targetFrame);
+void
+mitk::TimeFramesRegistrationHelper::ProcessFrames(FrameScheduler* scheduler, RegistrationAlgorithmBaseType* algorithm)
+{
+  while (true)
+  {
+    //ignored frames are published without processing
+    PublishFrames(scheduler);
 
-      m_Progress += progressDelta;
-      this->InvokeEvent(::mitk::FrameMappingEvent(0,
-                        "Mapped frame #" + ::map::core::convert::toStr(i)));
+    unsigned int frame = 0;
+    Image::Pointer movingFrame;
 
-      mitk::ImageReadAccessor accessor(mappedFrame, mappedFrame->GetVolumeData(0, 0, nullptr,
-                                       mitk::Image::ReferenceMemory));
+    {
+      itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(scheduler->m_Mutex);
 
+      while (scheduler->m_NextFrame < scheduler->m_Ignored.size() && scheduler->m_Ignored[scheduler->m_NextFrame])
+      {
+        ++scheduler->m_NextFrame;
+      }
 
-      this->m_Registered4DImage->SetVolume(accessor.GetData(), i);
-      this->m_Registered4DImage->GetTimeGeometry()->SetTimeStepGeometry(mappedFrame->GetGeometry(), i);
+      if (scheduler->m_Failed || scheduler->m_NextFrame >= scheduler->m_Ignored.size())
+      {
+        return;
+      }
 
-      m_Progress += progressDelta;
+      frame = scheduler->m_NextFrame++;
+      movingFrame = GetFrameImage(this->m_4DImage, frame);
     }
-    else
+
+    Image::Pointer mappedFrame;
+    std::string errorMessage;
+    try
+    {
+      RegistrationPointer reg = DoFrameRegistration(movingFrame, scheduler->m_TargetFrame, scheduler->m_TargetMask, algorithm);
+      mappedFrame = DoFrameMapping(movingFrame, reg, scheduler->m_TargetFrame);
+    }
+    catch (const std::exception& e)
+    {
+      errorMessage = "Cannot register frame #" + ::map::core::convert::toStr(frame) + ". Details: " + e.what();
+    }
+    catch (...)
+    {
+      errorMessage = "Cannot register frame #" + ::map::core::convert::toStr(frame) + ". Unknown error.";
+    }
+
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lock(scheduler->m_Mutex);
+    if (mappedFrame.IsNull())
     {
-      m_Progress += 3 * progressDelta;
+      //only the error of the first failed frame is reported
+      if (!scheduler->m_Failed)
+      {
+        scheduler->m_Failed = true;
+        scheduler->m_ErrorMessage = errorMessage;
+      }
+      return;
     }
 
-    this->InvokeEvent(::itk::ProgressEvent());
+    scheduler->m_MappedFrames[frame] = mappedFrame;
+  }
+};
+
+void
+mitk::TimeFramesRegistrationHelper::PublishFrames(FrameScheduler* scheduler)
+{
+  typedef std::vector<std::pair<unsigned int, Image::Pointer> > FrameVectorType;
 
+  scheduler->m_Mutex.Lock();
+  if (scheduler->m_Publishing)
+  {
+    //the publishing thread also adds the frames that were finished meanwhile
+    scheduler->m_Mutex.Unlock();
+    return;
   }
+  scheduler->m_Publishing = true;
+
+  while (true)
+  {
+    //collect the frames that directly follow the last added frame, ignored frames have no image
+    FrameVectorType frames;
+    while (!scheduler->m_Failed && scheduler->m_NextPublishedFrame < scheduler->m_Ignored.size())
+    {
+      const unsigned int i = scheduler->m_NextPublishedFrame;
+      if (scheduler->m_Ignored[i])
+      {
+        frames.push_back(std::make_pair(i, Image::Pointer()));
+      }
+      else if (scheduler->m_MappedFrames[i].IsNotNull())
+      {
+        frames.push_back(std::make_pair(i, scheduler->m_MappedFrames[i]));
+        scheduler->m_MappedFrames[i] = NULL;
+      }
+      else
+      {
+        //frame is still processed
+        break;
+      }
+      ++scheduler->m_NextPublishedFrame;
+    }
+
+    if (frames.empty())
+    {
+      scheduler->m_Publishing = false;
+      scheduler->m_Mutex.Unlock();
+      return;
+    }
+
+    //observers are called without holding the mutex, so they cannot block the other frames
+    scheduler->m_Mutex.Unlock();
+    std::string errorMessage;
+    try
+    {
+      for (FrameVectorType::const_iterator pos = frames.begin(); pos != frames.end(); ++pos)
+      {
+        const unsigned int i = pos->first;
+        const Image::Pointer& mappedFrame = pos->second;
 
+        if (mappedFrame.IsNull())
+        {
+          m_Progress += 3 * scheduler->m_ProgressDelta;
+        }
+        else
+        {
+          m_Progress += scheduler->m_ProgressDelta;
+          this->InvokeEvent(::mitk::FrameRegistrationEvent(0,
+                            "Registred frame #" +::map::core::convert::toStr(i)));
+
+          m_Progress += scheduler->m_ProgressDelta;
+          this->InvokeEvent(::mitk::FrameMappingEvent(0,
+                            "Mapped frame #" + ::map::core::convert::toStr(i)));
+
+          mitk::ImageReadAccessor accessor(mappedFrame, mappedFrame->GetVolumeData(0, 0, nullptr,
+                                           mitk::Image::ReferenceMemory));
+
+
+          this->m_Registered4DImage->SetVolume(accessor.GetData(), i);
+          this->m_Registered4DImage->GetTimeGeometry()->SetTimeStepGeometry(mappedFrame->GetGeometry(), i);
+
+          m_Progress += scheduler->m_ProgressDelta;
+        }
+
+        this->InvokeEvent(::itk::ProgressEvent());
+      }
+    }
+    catch (const std::exception& e)
+    {
+      errorMessage = std::string("Cannot add registered frame to the result image. Details: ") + e.what();
+    }
+    scheduler->m_Mutex.Lock();
+
+    if (!errorMessage.empty() && !scheduler->m_Failed)
+    {
+      scheduler->m_Failed = true;
+      scheduler->m_ErrorMessage = errorMessage;
+    }
+  }
 };
 
 mitk::Image::Pointer
@@ -136,15 +441,20 @@ mitk::TimeFramesRegistrationHelper::ClearIgnoreList()
 
 mitk::TimeFramesRegistrationHelper::RegistrationPointer
 mitk::TimeFramesRegistrationHelper::DoFrameRegistration(const mitk::Image* movingFrame,
-    const mitk::Image* targetFrame, const mitk::Image* targetMask) const
+    const mitk::Image* targetFrame, const mitk::Image* targetMask, RegistrationAlgorithmBaseType* algorithm) const
 {
-  mitk::MITKAlgorithmHelper algHelper(m_Algorithm);
+  if (!algorithm)
+  {
+    algorithm = m_Algorithm;
+  }
+
+  mitk::MITKAlgorithmHelper algHelper(algorithm);
   algHelper.SetAllowImageCasting(true);
   algHelper.SetData(movingFrame, targetFrame);
 
   if (targetMask)
   {
-    mitk::MaskedAlgorithmHelper maskHelper(m_Algorithm);
+    mitk::MaskedAlgorithmHelper maskHelper(algorithm);
     maskHelper.SetMasks(NULL, targetMask);
   }
 
@@ -158,6 +468,41 @@ mitk::Image::Pointer mitk::TimeFramesRegistrationHelper::DoFrameMapping(
                                       targetFrame->GetGeometry(), !m_AllowUnregPixels, m_ErrorValue, m_InterpolatorType);
 };
 
+mitk::TimeFramesRegistrationHelper::RegistrationAlgorithmPointer
+mitk::TimeFramesRegistrationHelper::CloneAlgorithm() const
+{
+  RegistrationAlgorithmPointer clone = dynamic_cast<RegistrationAlgorithmBaseType*>(m_Algorithm->CreateAnother().GetPointer());
+
+  if (clone.IsNull())
+  {
+    return NULL;
+  }
+
+  typedef ::map::algorithm::facet::MetaPropertyAlgorithmInterface MetaPropertyInterfaceType;
+  MetaPropertyInterfaceType* pSource = dynamic_cast<MetaPropertyInterfaceType*>(m_Algorithm.GetPointer());
+  MetaPropertyInterfaceType* pClone = dynamic_cast<MetaPropertyInterfaceType*>(clone.GetPointer());
+
+  if (pSource && pClone)
+  {
+    MetaPropertyInterfaceType::MetaPropertyVectorType infos = pSource->getPropertyInfos();
+
+    for (MetaPropertyInterfaceType::MetaPropertyVectorType::const_iterator pos = infos.begin(); pos != infos.end(); ++pos)
+    {
+      if ((*pos)->isReadable() && (*pos)->isWritable())
+      {
+        MetaPropertyInterfaceType::MetaPropertyPointer prop = pSource->getProperty(*pos);
+        if (prop.IsNotNull() && !pClone->setProperty(*pos, prop))
+        {
+          //a copy that behaves differently would silently change the results
+          return NULL;
+        }
+      }
+    }
+  }
+
+  return clone;
+};
+
 bool
 mitk::TimeFramesRegistrationHelper::HasOutdatedResult() const
 {
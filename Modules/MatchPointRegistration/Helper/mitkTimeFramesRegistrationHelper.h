@@ -26,6 +26,8 @@
 #include <mapRegistrationBase.h>
 #include <mapEvents.h>
 
+#include <itkMultiThreader.h>
+
 #include "MitkMatchPointRegistrationExports.h"
 
 namespace mitk
@@ -43,6 +45,11 @@ namespace mitk
    * - mitk::FrameRegistrationEvent: when ever a frame was registered.
    * - mitk::FrameMappingEvent: when ever a frame was mapped registered.
    * - itk::ProgressEvent: when ever a new frame was added to the result image.
+   *
+   * Several frames can be registered concurrently (see SetNumberOfConcurrentFrames). The first frame in flight is
+   * registered with the set algorithm, all others with copies of it (same class and meta properties). The events are
+   * nevertheless invoked frame by frame in ascending order, because a frame is only added to the result image after
+   * all preceding frames were added.
    */
   class MITKMATCHPOINTREGISTRATION_EXPORT TimeFramesRegistrationHelper : public itk::Object
   {
@@ -82,6 +89,18 @@ namespace mitk
     itkSetMacro(InterpolatorType, mitk::ImageMappingInterpolator::Type);
     itkGetConstMacro(InterpolatorType, mitk::ImageMappingInterpolator::Type);
 
+    /** Number of frames that are registered at the same time. Default is 1 (sequential processing).
+     * If the algorithm cannot be copied, the frames are registered sequentially.*/
+    itkSetMacro(NumberOfConcurrentFrames, unsigned int);
+    itkGetConstMacro(NumberOfConcurrentFrames, unsigned int);
+
+    /** Number of threads every concurrently processed frame may use. It is applied to each algorithm instance via its
+     * meta property "NumberOfThreads"; algorithms without that property keep their own setting. The ITK default number
+     * of threads is not changed. 0 (default) splits the ITK default number of threads evenly between the concurrent
+     * frames. Only relevant if more than one frame is registered at the same time.*/
+    itkSetMacro(NumberOfThreadsPerFrame, unsigned int);
+    itkGetConstMacro(NumberOfThreadsPerFrame, unsigned int);
+
     /** cleares the ignore list. Therefore all frames will be processed.*/
     void ClearIgnoreList();
     void SetIgnoreList(const IgnoreListType& il);
@@ -109,7 +128,8 @@ namespace mitk
 
   protected:
     TimeFramesRegistrationHelper() : m_Progress(0), m_AllowUndefPixels(true), m_PaddingValue(0),
-      m_AllowUnregPixels(true), m_ErrorValue(0), m_InterpolatorType(mitk::ImageMappingInterpolator::Linear)
+      m_AllowUnregPixels(true), m_ErrorValue(0), m_InterpolatorType(mitk::ImageMappingInterpolator::Linear),
+      m_NumberOfConcurrentFrames(1), m_NumberOfThreadsPerFrame(0)
     {
       m_4DImage = NULL;
       m_TargetMask = NULL;
@@ -118,8 +138,10 @@ namespace mitk
 
     ~TimeFramesRegistrationHelper() {};
 
+    /** Registers the frame with the passed algorithm. If algorithm is NULL, m_Algorithm is used.*/
     RegistrationPointer DoFrameRegistration(const mitk::Image* movingFrame,
-                                            const mitk::Image* targetFrame, const mitk::Image* targetMask) const;
+                                            const mitk::Image* targetFrame, const mitk::Image* targetMask,
+                                            RegistrationAlgorithmBaseType* algorithm = NULL) const;
 
     mitk::Image::Pointer DoFrameMapping(const mitk::Image* movingFrame, const RegistrationType* reg,
                                         const mitk::Image* targetFrame) const;
@@ -131,9 +153,24 @@ namespace mitk
 
     mitk::Image::Pointer GetFrameImage(const mitk::Image* image, mitk::TimePointType timePoint) const;
 
+    /** Creates a new instance of the algorithm class and copies all meta properties of m_Algorithm.
+     * @return the copy or NULL if the algorithm cannot be copied.*/
+    RegistrationAlgorithmPointer CloneAlgorithm() const;
+
     RegistrationAlgorithmPointer m_Algorithm;
 
   private:
+    struct FrameScheduler;
+
+    static ITK_THREAD_RETURN_TYPE FrameThreadCallback(void* arg);
+    /** Registers and maps frames until all frames are processed or an error occured.*/
+    void ProcessFrames(FrameScheduler* scheduler, RegistrationAlgorithmBaseType* algorithm);
+    /** Adds all processed frames to the result image that directly follow the last added frame and invokes their
+     * events in ascending frame order. Observers are called without holding the scheduler mutex. If another thread
+     * already adds frames, it also takes over the frames that are ready now and the call returns immediately.
+     * @pre the scheduler mutex must not be locked by the calling thread.*/
+    void PublishFrames(FrameScheduler* scheduler);
+
     Image::ConstPointer m_4DImage;
     Image::ConstPointer m_TargetMask;
     Image::Pointer m_Registered4DImage;
@@ -150,6 +187,8 @@ namespace mitk
     double m_ErrorValue;
     /** Type of interpolator. Only relevant for images and if m_doGeometryRefinement is false. */
     mitk::ImageMappingInterpolator::Type m_InterpolatorType;
+    unsigned int m_NumberOfConcurrentFrames;
+    unsigned int m_NumberOfThreadsPerFrame;
 
     double m_Progress;
   };
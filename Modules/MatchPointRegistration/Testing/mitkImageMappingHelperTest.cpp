@@ -0,0 +1,238 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include "mitkTestFixture.h"
+
+#include "mitkImageMappingHelper.h"
+#include "mitkMAPRegistrationWrapper.h"
+
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <itkEuler3DTransform.h>
+
+#include <mapRegistration.h>
+#include <mapRegistrationManipulator.h>
+#include <mapPreCachedRegistrationKernel.h>
+#include <mapNullRegistrationKernel.h>
+
+#include <cmath>
+#include <sstream>
+
+/** Compares the mapping of images with several time steps, which uses one ImageMappingCoordinateMap for all time steps,
+ * with the mapping of every time step by its own MatchPoint mapping task.*/
+class mitkImageMappingHelperTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkImageMappingHelperTestSuite);
+  MITK_TEST(Map_NearestNeighbor_CoordinateMapEqualsMappingTask);
+  MITK_TEST(Map_Linear_CoordinateMapEqualsMappingTask);
+  MITK_TEST(Map_Wrapper_CachesCoordinateMap);
+  MITK_TEST(Map_ThrowOnOutOfInputArea);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef ::map::core::Registration<3, 3> MAPRegistrationType;
+
+  static const unsigned int m_TimeSteps = 3;
+
+  MAPRegistrationType::Pointer m_Registration;
+  mitk::Image::Pointer m_Input;
+  std::vector<mitk::Image::Pointer> m_InputTimeSteps;
+  mitk::BaseGeometry::Pointer m_ResultGeometry;
+
+  static mitk::Image::Pointer CreateImage(unsigned int dimension, const unsigned int* dimensions,
+    const mitk::Vector3D& spacing, const mitk::Point3D& origin)
+  {
+    mitk::Image::Pointer image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<float>(), dimension, dimensions);
+    image->SetSpacing(spacing);
+    image->SetOrigin(origin);
+    return image;
+  }
+
+  static void FillTimeStep(mitk::Image* image, unsigned int timeStep, unsigned int t)
+  {
+    mitk::ImageWriteAccessor access(image, image->GetVolumeData(timeStep));
+    float* pixels = static_cast<float*>(access.GetData());
+    for (unsigned int z = 0; z < image->GetDimension(2); ++z)
+      for (unsigned int y = 0; y < image->GetDimension(1); ++y)
+        for (unsigned int x = 0; x < image->GetDimension(0); ++x)
+          *pixels++ = static_cast<float>((x * 7 + y * 13 + z * 29 + t * 101) % 97) + 0.25f * t;
+  }
+
+  void CheckEqual(const mitk::Image* mapped, unsigned int timeStep, const mitk::Image* expected, double tolerance)
+  {
+    CPPUNIT_ASSERT_EQUAL(expected->GetDimension(0), mapped->GetDimension(0));
+    CPPUNIT_ASSERT_EQUAL(expected->GetDimension(1), mapped->GetDimension(1));
+    CPPUNIT_ASSERT_EQUAL(expected->GetDimension(2), mapped->GetDimension(2));
+    CPPUNIT_ASSERT(mitk::Equal(*(expected->GetGeometry()), *(mapped->GetGeometry(timeStep)), mitk::eps, true));
+
+    mitk::ImageReadAccessor mappedAccess(mapped, mapped->GetVolumeData(timeStep));
+    mitk::ImageReadAccessor expectedAccess(expected, expected->GetVolumeData(0));
+    const float* mappedPixels = static_cast<const float*>(mappedAccess.GetData());
+    const float* expectedPixels = static_cast<const float*>(expectedAccess.GetData());
+
+    const unsigned int numberOfVoxels = expected->GetDimension(0) * expected->GetDimension(1) * expected->GetDimension(2);
+    for (unsigned int i = 0; i < numberOfVoxels; ++i)
+    {
+      if (std::abs(mappedPixels[i] - expectedPixels[i]) > tolerance)
+      {
+        std::ostringstream message;
+        message << "Voxel " << i << " of time step " << timeStep << ": coordinate map " << mappedPixels[i]
+                << ", mapping task " << expectedPixels[i];
+        CPPUNIT_FAIL(message.str());
+      }
+    }
+  }
+
+  /** Maps the 4D input at once and every time step on its own and compares the results voxel by voxel.
+   * Returns the number of voxels with the padding value in the first time step.*/
+  unsigned int CompareWithMappingTask(mitk::ImageMappingInterpolator::Type interpolatorType, double tolerance)
+  {
+    const double paddingValue = -1000;
+    const double errorValue = -2000;
+
+    mitk::Image::Pointer mapped = mitk::ImageMappingHelper::map(m_Input, m_Registration.GetPointer(), false,
+      paddingValue, m_ResultGeometry, false, errorValue, interpolatorType);
+    CPPUNIT_ASSERT_EQUAL(static_cast<unsigned int>(m_TimeSteps), mapped->GetTimeSteps());
+
+    unsigned int numberOfPaddedVoxels = 0;
+    for (unsigned int t = 0; t < m_TimeSteps; ++t)
+    {
+      //single time steps are mapped by a MatchPoint mapping task
+      mitk::Image::Pointer expected = mitk::ImageMappingHelper::map(m_InputTimeSteps[t], m_Registration.GetPointer(),
+        false, paddingValue, m_ResultGeometry, false, errorValue, interpolatorType);
+      CheckEqual(mapped, t, expected, tolerance);
+
+      if (t == 0)
+      {
+        mitk::ImageReadAccessor access(expected);
+        const float* pixels = static_cast<const float*>(access.GetData());
+        const unsigned int numberOfVoxels = expected->GetDimension(0) * expected->GetDimension(1) * expected->GetDimension(2);
+        for (unsigned int i = 0; i < numberOfVoxels; ++i)
+        {
+          //transform based kernels cover every point, so there are no mapping errors
+          CPPUNIT_ASSERT(pixels[i] != errorValue);
+          if (pixels[i] == paddingValue)
+          {
+            ++numberOfPaddedVoxels;
+          }
+        }
+      }
+    }
+    return numberOfPaddedVoxels;
+  }
+
+public:
+  void setUp() override
+  {
+    typedef itk::Euler3DTransform< ::map::core::continuous::ScalarType> TransformType;
+    TransformType::Pointer transform = TransformType::New();
+    transform->SetRotation(0.13, -0.07, 0.21);
+    TransformType::OutputVectorType translation;
+    translation[0] = 2.3;
+    translation[1] = -1.7;
+    translation[2] = 0.6;
+    transform->SetTranslation(translation);
+
+    m_Registration = MAPRegistrationType::New();
+    ::map::core::RegistrationManipulator<MAPRegistrationType> manipulator(m_Registration);
+    ::map::core::PreCachedRegistrationKernel<3, 3>::Pointer kernel = ::map::core::PreCachedRegistrationKernel<3, 3>::New();
+    kernel->setTransformModel(transform);
+    manipulator.setInverseMapping(kernel);
+    manipulator.setDirectMapping(::map::core::NullRegistrationKernel<3, 3>::New());
+
+    mitk::Vector3D inputSpacing;
+    inputSpacing[0] = 1.0;
+    inputSpacing[1] = 1.3;
+    inputSpacing[2] = 1.7;
+    mitk::Point3D inputOrigin;
+    inputOrigin[0] = 0.5;
+    inputOrigin[1] = -2.0;
+    inputOrigin[2] = 1.0;
+    const unsigned int inputDimensions[4] = {12, 10, 8, m_TimeSteps};
+
+    m_Input = CreateImage(4, inputDimensions, inputSpacing, inputOrigin);
+    m_InputTimeSteps.clear();
+    for (unsigned int t = 0; t < m_TimeSteps; ++t)
+    {
+      FillTimeStep(m_Input, t, t);
+      m_InputTimeSteps.push_back(CreateImage(3, inputDimensions, inputSpacing, inputOrigin));
+      FillTimeStep(m_InputTimeSteps.back(), 0, t);
+    }
+
+    //a different grid that partly lies outside of the mapped input (padding)
+    mitk::Vector3D resultSpacing;
+    resultSpacing[0] = 1.1;
+    resultSpacing[1] = 0.9;
+    resultSpacing[2] = 1.2;
+    mitk::Point3D resultOrigin;
+    resultOrigin[0] = -3.1;
+    resultOrigin[1] = 2.2;
+    resultOrigin[2] = -1.4;
+    const unsigned int resultDimensions[3] = {14, 12, 9};
+    m_ResultGeometry = CreateImage(3, resultDimensions, resultSpacing, resultOrigin)->GetGeometry()->Clone();
+  }
+
+  void tearDown() override
+  {
+    m_Registration = NULL;
+    m_Input = NULL;
+    m_InputTimeSteps.clear();
+    m_ResultGeometry = NULL;
+  }
+
+  void Map_NearestNeighbor_CoordinateMapEqualsMappingTask()
+  {
+    CPPUNIT_ASSERT(CompareWithMappingTask(mitk::ImageMappingInterpolator::NearestNeighbor, 0.0) > 0);
+  }
+
+  void Map_Linear_CoordinateMapEqualsMappingTask()
+  {
+    //the coordinate map stores the continuous indices in single precision
+    CPPUNIT_ASSERT(CompareWithMappingTask(mitk::ImageMappingInterpolator::Linear, 1e-3) > 0);
+  }
+
+  void Map_Wrapper_CachesCoordinateMap()
+  {
+    mitk::MAPRegistrationWrapper::Pointer wrapper = mitk::MAPRegistrationWrapper::New();
+    wrapper->SetRegistration(m_Registration);
+    CPPUNIT_ASSERT(wrapper->GetCachedCoordinateMap().IsNull());
+
+    mitk::Image::Pointer mapped = mitk::ImageMappingHelper::map(m_Input, wrapper.GetPointer(), false, 0,
+      m_ResultGeometry, false, 0, mitk::ImageMappingInterpolator::Linear);
+    mitk::ImageMappingCoordinateMap::ConstPointer coordinateMap = wrapper->GetCachedCoordinateMap();
+    CPPUNIT_ASSERT(coordinateMap.IsNotNull());
+
+    //a single time step reuses the cached map and gives the same result
+    mitk::Image::Pointer mappedTimeStep = mitk::ImageMappingHelper::map(m_InputTimeSteps[1], wrapper.GetPointer(),
+      false, 0, m_ResultGeometry, false, 0, mitk::ImageMappingInterpolator::Linear);
+    CPPUNIT_ASSERT(wrapper->GetCachedCoordinateMap() == coordinateMap);
+    CheckEqual(mapped, 1, mappedTimeStep, 0.0);
+
+    wrapper->ReleaseCachedCoordinateMap();
+    CPPUNIT_ASSERT(wrapper->GetCachedCoordinateMap().IsNull());
+  }
+
+  void Map_ThrowOnOutOfInputArea()
+  {
+    CPPUNIT_ASSERT_THROW(mitk::ImageMappingHelper::map(m_Input, m_Registration.GetPointer(), true, 0,
+      m_ResultGeometry, false, 0, mitk::ImageMappingInterpolator::Linear), mitk::Exception);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkImageMappingHelper)
@@ -19,6 +19,43 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkTimeFramesRegistrationHelper.h"
 
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <itkCommand.h>
+
+#include <mapDummyImageRegistrationAlgorithm.h>
+#include <mapAlgorithmIdentificationInterface.h>
+
+#include <sstream>
+
+namespace
+{
+  mapGenerateAlgorithmUIDPolicyMacro(TestIdentityRegIDPolicy, "de.dkfz.dipp", "Identity", "1.0.0", "");
+
+  typedef ::map::algorithm::DummyImageRegistrationAlgorithm< ::map::core::discrete::Elements<3>::InternalImageType,
+    ::map::core::discrete::Elements<3>::InternalImageType, TestIdentityRegIDPolicy> IdentityAlgorithmType;
+
+  struct EventRecord
+  {
+    std::vector<std::string> Events;
+    std::vector<itk::ThreadIdType> DefaultNumberOfThreads;
+  };
+
+  void RecordEvent(itk::Object*, const itk::EventObject& event, void* clientData)
+  {
+    EventRecord* record = static_cast<EventRecord*>(clientData);
+    std::string text = event.GetEventName();
+    const ::map::events::AnyMatchPointEvent* mapEvent = dynamic_cast<const ::map::events::AnyMatchPointEvent*>(&event);
+    if (mapEvent)
+    {
+      text += ": " + mapEvent->getComment();
+    }
+    record->Events.push_back(text);
+    record->DefaultNumberOfThreads.push_back(itk::MultiThreader::GetGlobalDefaultNumberOfThreads());
+  }
+}
+
 class mitkTimeFramesRegistrationHelperTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkTimeFramesRegistrationHelperTestSuite);
@@ -29,6 +66,9 @@ class mitkTimeFramesRegistrationHelperTestSuite : public mitk::TestFixture
   MITK_TEST(SetAllowUnregPixels_GetAllowUnregPixels);
   MITK_TEST(SetInterpolatorType_GetInterpolatorType);
   MITK_TEST(Set_Get_Clear_IgnoreList);
+  MITK_TEST(SetNumberOfConcurrentFrames_GetNumberOfConcurrentFrames);
+  MITK_TEST(SetNumberOfThreadsPerFrame_GetNumberOfThreadsPerFrame);
+  MITK_TEST(Generate_ConcurrentFramesEqualSequentialFrames);
   CPPUNIT_TEST_SUITE_END();
 private:
   mitk::TimeFramesRegistrationHelper::Pointer frameRegHelper;
@@ -106,6 +146,104 @@ public:
     CPPUNIT_ASSERT(frameRegHelper->GetIgnoreList().empty());
   }
 
+  void SetNumberOfConcurrentFrames_GetNumberOfConcurrentFrames()
+  {
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Check getter on default value", 1u,
+                                 frameRegHelper->GetNumberOfConcurrentFrames());
+    frameRegHelper->SetNumberOfConcurrentFrames(4);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Check getter on changed value", 4u,
+                                 frameRegHelper->GetNumberOfConcurrentFrames());
+  }
+
+  void SetNumberOfThreadsPerFrame_GetNumberOfThreadsPerFrame()
+  {
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Check getter on default value", 0u,
+                                 frameRegHelper->GetNumberOfThreadsPerFrame());
+    frameRegHelper->SetNumberOfThreadsPerFrame(2);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Check getter on changed value", 2u,
+                                 frameRegHelper->GetNumberOfThreadsPerFrame());
+  }
+
+  /** Registers the frames of a 4D image with the identity and returns the result and the invoked events.*/
+  mitk::Image::Pointer GenerateRegisteredImage(const mitk::Image* image, unsigned int numberOfConcurrentFrames,
+    EventRecord& record)
+  {
+    mitk::TimeFramesRegistrationHelper::Pointer helper = mitk::TimeFramesRegistrationHelper::New();
+    helper->Set4DImage(image);
+    helper->SetAlgorithm(IdentityAlgorithmType::New().GetPointer());
+    mitk::TimeFramesRegistrationHelper::IgnoreListType ignoredFrames;
+    ignoredFrames.push_back(2);
+    helper->SetIgnoreList(ignoredFrames);
+    helper->SetNumberOfConcurrentFrames(numberOfConcurrentFrames);
+    helper->SetNumberOfThreadsPerFrame(1);
+
+    itk::CStyleCommand::Pointer command = itk::CStyleCommand::New();
+    command->SetClientData(&record);
+    command->SetCallback(RecordEvent);
+    helper->AddObserver(itk::AnyEvent(), command);
+
+    mitk::Image::Pointer result = helper->GetRegisteredImage();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, helper->GetProgress(), 1e-6);
+    return result;
+  }
+
+  void Generate_ConcurrentFramesEqualSequentialFrames()
+  {
+    const unsigned int dimensions[4] = {10, 9, 6, 7};
+    mitk::Image::Pointer image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<float>(), 4, dimensions);
+    for (unsigned int t = 0; t < dimensions[3]; ++t)
+    {
+      mitk::ImageWriteAccessor access(image, image->GetVolumeData(t));
+      float* pixels = static_cast<float*>(access.GetData());
+      for (unsigned int i = 0; i < dimensions[0] * dimensions[1] * dimensions[2]; ++i)
+      {
+        pixels[i] = static_cast<float>((i * 13 + t * 31) % 101);
+      }
+    }
+
+    //frame 2 is not registered
+    const itk::ThreadIdType defaultNumberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+    EventRecord sequentialRecord;
+    mitk::Image::Pointer sequential = GenerateRegisteredImage(image, 1, sequentialRecord);
+    EventRecord concurrentRecord;
+    mitk::Image::Pointer concurrent = GenerateRegisteredImage(image, 3, concurrentRecord);
+
+    //registration, mapping and progress event for every registered frame, progress event for the ignored frame
+    CPPUNIT_ASSERT_EQUAL(std::size_t(3 * (dimensions[3] - 2) + 1), sequentialRecord.Events.size());
+    CPPUNIT_ASSERT(sequentialRecord.Events == concurrentRecord.Events);
+
+    //the thread budget is not applied via the ITK default number of threads
+    CPPUNIT_ASSERT_EQUAL(defaultNumberOfThreads, itk::MultiThreader::GetGlobalDefaultNumberOfThreads());
+    for (std::size_t i = 0; i < concurrentRecord.DefaultNumberOfThreads.size(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL(defaultNumberOfThreads, concurrentRecord.DefaultNumberOfThreads[i]);
+    }
+
+    CPPUNIT_ASSERT(sequential.IsNotNull());
+    CPPUNIT_ASSERT(concurrent.IsNotNull());
+    CPPUNIT_ASSERT_EQUAL(dimensions[3], concurrent->GetTimeSteps());
+    for (unsigned int t = 0; t < dimensions[3]; ++t)
+    {
+      CPPUNIT_ASSERT(mitk::Equal(*(sequential->GetGeometry(t)), *(concurrent->GetGeometry(t)), mitk::eps, true));
+
+      mitk::ImageReadAccessor sequentialAccess(sequential, sequential->GetVolumeData(t));
+      mitk::ImageReadAccessor concurrentAccess(concurrent, concurrent->GetVolumeData(t));
+      const float* sequentialPixels = static_cast<const float*>(sequentialAccess.GetData());
+      const float* concurrentPixels = static_cast<const float*>(concurrentAccess.GetData());
+      for (unsigned int i = 0; i < dimensions[0] * dimensions[1] * dimensions[2]; ++i)
+      {
+        if (sequentialPixels[i] != concurrentPixels[i])
+        {
+          std::ostringstream message;
+          message << "Voxel " << i << " of frame " << t << ": sequential " << sequentialPixels[i] << ", concurrent "
+                  << concurrentPixels[i];
+          CPPUNIT_FAIL(message.str());
+        }
+      }
+    }
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkTimeFramesRegistrationHelper)
\ No newline at end of file
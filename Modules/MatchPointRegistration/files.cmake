@@ -8,6 +8,7 @@ set(CPP_FILES
   Helper/mitkMaskedAlgorithmHelper.cpp
   Helper/mitkRegistrationHelper.cpp
   Helper/mitkImageMappingHelper.cpp
+  Helper/mitkImageMappingCoordinateMap.cpp
   Helper/mitkPointSetMappingHelper.cpp
   Helper/mitkResultNodeGenerationHelper.cpp
   Helper/mitkTimeFramesRegistrationHelper.cpp
@@ -35,6 +36,7 @@ set(H_FILES
   Helper/mitkMaskedAlgorithmHelper.h
   Helper/mitkRegistrationHelper.h
   Helper/mitkImageMappingHelper.h
+  Helper/mitkImageMappingCoordinateMap.h
   Helper/mitkPointSetMappingHelper.h
   Helper/mitkResultNodeGenerationHelper.h
   Helper/mitkTimeFramesRegistrationHelper.h
@@ -18,6 +18,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mapExceptionObjectMacros.h>
 
+#include <itkMutexLockHolder.h>
+
 mitk::MAPRegistrationWrapper::MAPRegistrationWrapper()
 {
 }
@@ -114,6 +116,29 @@ const map::core::RegistrationBase* mitk::MAPRegistrationWrapper::GetRegistration
 void mitk::MAPRegistrationWrapper::SetRegistration(map::core::RegistrationBase* pReg)
 {
   m_spRegistration = pReg;
+  this->ReleaseCachedCoordinateMap();
+}
+
+mitk::ImageMappingCoordinateMap::ConstPointer mitk::MAPRegistrationWrapper::GetCachedCoordinateMap() const
+{
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_CachedCoordinateMapMutex);
+  return m_CachedCoordinateMap;
+}
+
+void mitk::MAPRegistrationWrapper::SetCachedCoordinateMap(const ImageMappingCoordinateMap* map) const
+{
+  ImageMappingCoordinateMap::ConstPointer previousMap;
+  {
+    itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_CachedCoordinateMapMutex);
+    previousMap = m_CachedCoordinateMap;
+    m_CachedCoordinateMap = map;
+  }
+  //the previous map is freed outside of the lock
+}
+
+void mitk::MAPRegistrationWrapper::ReleaseCachedCoordinateMap() const
+{
+  this->SetCachedCoordinateMap(NULL);
 }
 
 void mitk::MAPRegistrationWrapper::PrintSelf (std::ostream &os, itk::Indent indent) const
@@ -22,6 +22,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkBaseData.h>
 #include <mitkGeometry3D.h>
 
+//ITK
+#include <itkMutexLock.h>
+
 //MatchPoint
 #include <mapRegistrationBase.h>
 #include <mapRegistration.h>
@@ -29,6 +32,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mapContinuousElements.h>
 
 //MITK
+#include "mitkImageMappingCoordinateMap.h"
 #include "MitkMatchPointRegistrationExports.h"
 
 namespace mitk
@@ -255,6 +259,17 @@ public:
 
   void SetRegistration(map::core::RegistrationBase* pReg);
 
+  /*! Coordinate map of the last image mapping with this registration (see ImageMappingHelper::map).
+  It is reused for further images with the same input and result geometry and is dropped if a new
+  registration is set. The cache does not change the registration, therefore it can be set on const
+  instances. Access to the cache is thread safe.
+  @return the cached map or NULL if no map was cached.*/
+  ImageMappingCoordinateMap::ConstPointer GetCachedCoordinateMap() const;
+  void SetCachedCoordinateMap(const ImageMappingCoordinateMap* map) const;
+  /*! Drops the cached coordinate map to free its memory (see ImageMappingCoordinateMap::GetMemorySize).
+  Mappings that still use the map keep it alive until they are finished.*/
+  void ReleaseCachedCoordinateMap() const;
+
 protected:
     virtual void PrintSelf (std::ostream &os, itk::Indent indent) const;
 
@@ -263,6 +278,9 @@ protected:
 
     map::core::RegistrationBase::Pointer m_spRegistration;
 
+    mutable ImageMappingCoordinateMap::ConstPointer m_CachedCoordinateMap;
+    mutable itk::SimpleMutexLock m_CachedCoordinateMapMutex;
+
 private:
 
     MAPRegistrationWrapper& operator = (const MAPRegistrationWrapper&);
@@ -2,4 +2,9 @@ set(MODULE_TESTS
    mitkOpenIGTLinkClientServerTest.cpp
    mitkOpenIGTLinkImageFactoryTest.cpp
    mitkOpenIGTLinkIGTLImageMessageFilterTest.cpp
+   mitkIGTLMessageQueueTest.cpp
+)
+
+set(MODULE_BENCHMARK_TESTS
+   mitkOpenIGTLinkClientServerTest.cpp
 )
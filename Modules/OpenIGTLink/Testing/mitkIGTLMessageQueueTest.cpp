@@ -0,0 +1,188 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+
+#include <mitkIGTLMessageQueue.h>
+#include <mitkIGTLMeasurements.h>
+
+#include <igtlStatusMessage.h>
+
+#include <thread>
+#include <chrono>
+
+class mitkIGTLMessageQueueTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkIGTLMessageQueueTestSuite);
+  MITK_TEST(Test_DefaultPolicy_KeepsLatestMessage);
+  MITK_TEST(Test_InfiniteBuffering_KeepsAllMessages);
+  MITK_TEST(Test_DropOldestPolicy_KeepsBoundedNumberOfMessages);
+  MITK_TEST(Test_Channels_AreIndependent);
+  MITK_TEST(Test_WaitForSendMessage_ReturnsPushedMessage);
+  MITK_TEST(Test_InterruptSendWait_WakesUpWaitingThread);
+  MITK_TEST(Test_ChannelStatistics_AreAccumulated);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::IGTLMessageQueue::Pointer m_Queue;
+
+  igtl::MessageBase::Pointer CreateTrackingMessage()
+  {
+    igtl::TrackingDataMessage::Pointer msg = igtl::TrackingDataMessage::New();
+    return msg.GetPointer();
+  }
+
+  igtl::MessageBase::Pointer CreateImageMessage(int depth)
+  {
+    igtl::ImageMessage::Pointer msg = igtl::ImageMessage::New();
+    msg->SetDimensions(4, 4, depth);
+    return msg.GetPointer();
+  }
+
+public:
+  void setUp() override
+  {
+    m_Queue = mitk::IGTLMessageQueue::New();
+  }
+
+  void tearDown() override
+  {
+    m_Queue = nullptr;
+  }
+
+  void Test_DefaultPolicy_KeepsLatestMessage()
+  {
+    igtl::MessageBase::Pointer first = CreateTrackingMessage();
+    igtl::MessageBase::Pointer second = CreateTrackingMessage();
+    m_Queue->PushMessage(first);
+    m_Queue->PushMessage(second);
+
+    CPPUNIT_ASSERT_EQUAL(1u, m_Queue->GetSize(mitk::IGTLMessageQueue::TrackingDataChannel));
+    CPPUNIT_ASSERT_EQUAL(1ul, m_Queue->GetNumberOfDroppedMessages(mitk::IGTLMessageQueue::TrackingDataChannel));
+    CPPUNIT_ASSERT_MESSAGE("The latest message was not kept",
+      m_Queue->PullTrackingMessage().GetPointer() == second.GetPointer());
+    CPPUNIT_ASSERT(m_Queue->PullTrackingMessage().IsNull());
+  }
+
+  void Test_InfiniteBuffering_KeepsAllMessages()
+  {
+    m_Queue->EnableInfiniteBuffering(true);
+    for (int i = 0; i < 10; ++i)
+      m_Queue->PushMessage(CreateTrackingMessage());
+
+    CPPUNIT_ASSERT_EQUAL(10u, m_Queue->GetSize(mitk::IGTLMessageQueue::TrackingDataChannel));
+    CPPUNIT_ASSERT_EQUAL(0ul, m_Queue->GetNumberOfDroppedMessages(mitk::IGTLMessageQueue::TrackingDataChannel));
+  }
+
+  void Test_DropOldestPolicy_KeepsBoundedNumberOfMessages()
+  {
+    m_Queue->SetBufferingPolicy(mitk::IGTLMessageQueue::TrackingDataChannel,
+      mitk::IGTLMessageQueue::DropOldest, 3);
+
+    std::vector<igtl::MessageBase::Pointer> messages;
+    for (int i = 0; i < 5; ++i)
+    {
+      messages.push_back(CreateTrackingMessage());
+      m_Queue->PushMessage(messages.back());
+    }
+
+    CPPUNIT_ASSERT_EQUAL(3u, m_Queue->GetSize(mitk::IGTLMessageQueue::TrackingDataChannel));
+    CPPUNIT_ASSERT_EQUAL(2ul, m_Queue->GetNumberOfDroppedMessages(mitk::IGTLMessageQueue::TrackingDataChannel));
+    CPPUNIT_ASSERT_MESSAGE("The oldest messages were not dropped",
+      m_Queue->PullTrackingMessage().GetPointer() == messages[2].GetPointer());
+  }
+
+  void Test_Channels_AreIndependent()
+  {
+    m_Queue->SetBufferingPolicy(mitk::IGTLMessageQueue::Image3dChannel, mitk::IGTLMessageQueue::KeepAll);
+
+    CPPUNIT_ASSERT(m_Queue->PushMessage(CreateImageMessage(1)) == mitk::IGTLMessageQueue::Image2dChannel);
+    CPPUNIT_ASSERT(m_Queue->PushMessage(CreateImageMessage(8)) == mitk::IGTLMessageQueue::Image3dChannel);
+    CPPUNIT_ASSERT(m_Queue->PushMessage(CreateImageMessage(8)) == mitk::IGTLMessageQueue::Image3dChannel);
+    CPPUNIT_ASSERT(m_Queue->PushMessage(CreateTrackingMessage()) == mitk::IGTLMessageQueue::TrackingDataChannel);
+    CPPUNIT_ASSERT(m_Queue->PushMessage(igtl::StatusMessage::New().GetPointer()) == mitk::IGTLMessageQueue::MiscChannel);
+
+    CPPUNIT_ASSERT_EQUAL(5, m_Queue->GetSize());
+    CPPUNIT_ASSERT_EQUAL(2u, m_Queue->GetSize(mitk::IGTLMessageQueue::Image3dChannel));
+    CPPUNIT_ASSERT(m_Queue->PullTrackingMessage().IsNotNull());
+    CPPUNIT_ASSERT(m_Queue->PullImage2dMessage().IsNotNull());
+    CPPUNIT_ASSERT(m_Queue->PullMiscMessage().IsNotNull());
+    CPPUNIT_ASSERT_EQUAL(2, m_Queue->GetSize());
+  }
+
+  void Test_WaitForSendMessage_ReturnsPushedMessage()
+  {
+    igtl::MessageBase::Pointer sent = CreateTrackingMessage();
+    std::thread producer([this, sent]()
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      m_Queue->PushSendMessage(sent);
+    });
+
+    igtl::MessageBase::Pointer received = m_Queue->WaitForSendMessage();
+    producer.join();
+
+    CPPUNIT_ASSERT_MESSAGE("The waiting thread did not receive the sent message",
+      received.GetPointer() == sent.GetPointer());
+  }
+
+  void Test_InterruptSendWait_WakesUpWaitingThread()
+  {
+    std::thread interrupter([this]()
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      m_Queue->InterruptSendWait();
+    });
+
+    igtl::MessageBase::Pointer received = m_Queue->WaitForSendMessage();
+    interrupter.join();
+
+    CPPUNIT_ASSERT(received.IsNull());
+
+    // an interrupted queue does not block anymore until the wait is resumed
+    CPPUNIT_ASSERT(m_Queue->WaitForSendMessage().IsNull());
+    m_Queue->ResumeSendWait();
+    m_Queue->PushSendMessage(CreateTrackingMessage());
+    CPPUNIT_ASSERT(m_Queue->WaitForSendMessage().IsNotNull());
+  }
+
+  void Test_ChannelStatistics_AreAccumulated()
+  {
+    mitk::IGTLMeasurements* measurements = mitk::IGTLMeasurements::GetInstance();
+    CPPUNIT_ASSERT(measurements != nullptr);
+
+    measurements->ResetChannelStatistics();
+    measurements->SetStarted(true);
+    measurements->AddChannelMessage("TDATA", 100, 1.0, 2.0);
+    measurements->AddChannelMessage("TDATA", 100, 1.5, 4.0);
+    measurements->AddChannelMessage("TDATA", 100, 2.0);
+    measurements->SetStarted(false);
+    measurements->AddChannelMessage("TDATA", 100, 3.0, 100.0);
+
+    mitk::IGTLMeasurements::ChannelStatistics statistics = measurements->GetChannelStatistics("TDATA");
+    measurements->ResetChannelStatistics();
+
+    CPPUNIT_ASSERT_EQUAL(3ul, statistics.NumberOfMessages);
+    CPPUNIT_ASSERT_EQUAL(300ull, statistics.NumberOfBytes);
+    CPPUNIT_ASSERT_EQUAL(2ul, statistics.NumberOfLatencySamples);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, statistics.MeanLatency, 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(4.0, statistics.MaximumLatency, 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, statistics.GetMessagesPerSecond(), 1e-9);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkIGTLMessageQueue)
@@ -26,11 +26,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkIGTLServer.h"
 #include "mitkIGTLClient.h"
 #include "mitkIGTLMessageFactory.h"
+#include "mitkIGTLMeasurements.h"
 
 //IGTL
 #include "igtlStatusMessage.h"
 #include "igtlClientSocket.h"
 #include "igtlServerSocket.h"
+#include "igtlTrackingDataMessage.h"
+#include "igtlImageMessage.h"
 
 static int PORT = 35352;
 static const std::string HOSTNAME = "localhost";
@@ -49,6 +52,7 @@ class mitkOpenIGTLinkClientServerTestSuite : public mitk::TestFixture
 #endif
   //MITK_TEST(Test_SendingMessageFromServerToOneClient_Successful);
   //MITK_TEST(Test_SendingMessageFromServerToMultipleClients_Successful);
+  MITK_BENCHMARK(Test_LoopbackTrackingDataDuringImageBurst_Benchmark);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -255,6 +259,87 @@ public:
     testMessagesEqual(sentMessage, receivedMessage2);
     testMessagesEqual(receivedMessage2, receivedMessage1);
   }
+
+  /**
+  * Sends tracking data at about 100 Hz while the server also sends a burst of
+  * large 3D images and prints the latency and throughput of both channels as
+  * measured by the client. The mean latency of the tracking data has to stay
+  * below the sending interval, i.e. tracking data must not wait behind the
+  * images or for a polling cycle of the device.
+  */
+  void Test_LoopbackTrackingDataDuringImageBurst_Benchmark()
+  {
+    const int numberOfTrackingMessages = 200;
+    const int numberOfImages = 20;
+    const int trackingIntervalInMilliseconds = 10;
+
+    mitk::IGTLMeasurements* measurements = mitk::IGTLMeasurements::GetInstance();
+    CPPUNIT_ASSERT(measurements != nullptr);
+    measurements->ResetChannelStatistics();
+    measurements->SetStarted(true);
+
+    // the benchmark wants to see every message
+    m_Server->GetMessageQueue()->SetBufferingPolicy(mitk::IGTLMessageQueue::SendChannel,
+      mitk::IGTLMessageQueue::KeepAll);
+    m_Client_One->GetMessageQueue()->SetBufferingPolicy(mitk::IGTLMessageQueue::TrackingDataChannel,
+      mitk::IGTLMessageQueue::KeepAll);
+
+    CPPUNIT_ASSERT_MESSAGE("Server not connected to Client.", m_Server->OpenConnection());
+    CPPUNIT_ASSERT_MESSAGE("Client 1 not connected to Server.", m_Client_One->OpenConnection());
+    m_Server->StartCommunication();
+    m_Client_One->StartCommunication();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    igtl::TimeStamp::Pointer timeStamp = igtl::TimeStamp::New();
+    for (int i = 0; i < numberOfTrackingMessages; ++i)
+    {
+      if (i % (numberOfTrackingMessages / numberOfImages) == 0)
+      {
+        igtl::ImageMessage::Pointer image = igtl::ImageMessage::New();
+        image->SetDimensions(256, 256, 64);
+        image->SetScalarType(igtl::ImageMessage::TYPE_UINT8);
+        image->AllocateScalars();
+        timeStamp->GetTime();
+        image->SetTimeStamp(timeStamp);
+        m_Server->SendMessage(image.GetPointer());
+      }
+
+      igtl::TrackingDataMessage::Pointer tracking = igtl::TrackingDataMessage::New();
+      igtl::TrackingDataElement::Pointer element = igtl::TrackingDataElement::New();
+      element->SetName("Tool");
+      tracking->AddTrackingDataElement(element);
+      timeStamp->GetTime();
+      tracking->SetTimeStamp(timeStamp);
+      m_Server->SendMessage(tracking.GetPointer());
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(trackingIntervalInMilliseconds));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    CPPUNIT_ASSERT(m_Client_One->StopCommunication());
+    CPPUNIT_ASSERT(m_Server->StopCommunication());
+    CPPUNIT_ASSERT(m_Client_One->CloseConnection());
+    CPPUNIT_ASSERT(m_Server->CloseConnection());
+    measurements->SetStarted(false);
+
+    for (const std::string& channel : measurements->GetChannelNames())
+    {
+      mitk::IGTLMeasurements::ChannelStatistics statistics = measurements->GetChannelStatistics(channel);
+      MITK_INFO << channel << ": " << statistics.NumberOfMessages << " messages, "
+        << statistics.GetMessagesPerSecond() << " msg/s, "
+        << statistics.GetBytesPerSecond() / (1024 * 1024) << " MB/s, latency mean "
+        << statistics.MeanLatency << " ms, max " << statistics.MaximumLatency << " ms";
+    }
+
+    mitk::IGTLMeasurements::ChannelStatistics trackingStatistics =
+      measurements->GetChannelStatistics(mitk::IGTLMessageQueue::GetChannelName(mitk::IGTLMessageQueue::TrackingDataChannel));
+    measurements->ResetChannelStatistics();
+
+    CPPUNIT_ASSERT_EQUAL((unsigned long)numberOfTrackingMessages, trackingStatistics.NumberOfMessages);
+    CPPUNIT_ASSERT_EQUAL((unsigned long)numberOfTrackingMessages, trackingStatistics.NumberOfLatencySamples);
+    CPPUNIT_ASSERT_MESSAGE("Tracking data was delayed by the image burst.",
+      trackingStatistics.MeanLatency < trackingIntervalInMilliseconds);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkOpenIGTLinkClientServer)
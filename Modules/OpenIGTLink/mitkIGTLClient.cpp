@@ -81,7 +81,6 @@ bool mitk::IGTLClient::OpenConnection()
 
 void mitk::IGTLClient::Receive()
 {
-  MITK_INFO << "Trying to receive message";
   //try to receive a message, if the socket is not present anymore stop the
   //communication
   unsigned int status = this->ReceivePrivate(this->m_Socket);
@@ -98,8 +97,8 @@ void mitk::IGTLClient::Send()
 {
   igtl::MessageBase::Pointer curMessage;
 
-  //get the latest message from the queue
-  curMessage = this->m_MessageQueue->PullSendMessage();
+  //wait for the next message of the queue
+  curMessage = this->m_MessageQueue->WaitForSendMessage();
 
   // there is no message => return
   if (curMessage.IsNull())
@@ -116,6 +115,9 @@ void mitk::IGTLClient::StopCommunicationWithSocket(igtl::Socket* /*socket*/)
   m_StopCommunicationMutex->Lock();
   m_StopCommunication = true;
   m_StopCommunicationMutex->Unlock();
+  //wake up the sending and connecting threads so that they can finish
+  m_MessageQueue->InterruptSendWait();
+  this->WakeUpCommunication();
 }
 
 unsigned int mitk::IGTLClient::GetNumberOfConnections()
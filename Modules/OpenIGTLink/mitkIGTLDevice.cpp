@@ -18,7 +18,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 //#include "mitkIGTException.h"
 //#include "mitkIGTTimeStamp.h"
 #include <itkMutexLockHolder.h>
-#include <itksys/SystemTools.hxx>
 #include <cstring>
 
 #include <igtlTransformMessage.h>
@@ -32,6 +31,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 //TODO: Which timeout is acceptable and also needed to transmit image data? Is there a maximum data limit?
 static const int SOCKET_SEND_RECEIVE_TIMEOUT_MSEC = 100;
 typedef itk::MutexLockHolder<itk::FastMutexLock> MutexLockHolder;
+typedef itk::MutexLockHolder<itk::SimpleMutexLock> WakeUpLockHolder;
+typedef itk::MutexLockHolder<itk::SimpleFastMutexLock> MeasurementLockHolder;
 
 mitk::IGTLDevice::IGTLDevice(bool ReadFully) :
 //  m_Data(mitk::DeviceDataUnspecified),
@@ -40,7 +41,10 @@ m_Name("Unspecified Device"),
 m_StopCommunication(false),
 m_Hostname("127.0.0.1"),
 m_PortNumber(-1),
-m_MultiThreader(nullptr), m_SendThreadID(0), m_ReceiveThreadID(0), m_ConnectThreadID(0)
+m_MultiThreader(nullptr), m_SendThreadID(0), m_ReceiveThreadID(0), m_ConnectThreadID(0),
+m_WakeUpCount(0),
+m_MaximumNumberOfPooledMessages(4),
+m_Measurements(nullptr)
 {
   m_ReadFully = ReadFully;
   m_StopCommunicationMutex = itk::FastMutexLock::New();
@@ -59,6 +63,10 @@ m_MultiThreader(nullptr), m_SendThreadID(0), m_ReceiveThreadID(0), m_ConnectThre
 
   m_MessageFactory = mitk::IGTLMessageFactory::New();
   m_MessageQueue = mitk::IGTLMessageQueue::New();
+
+  m_WakeUpCondition = itk::ConditionVariable::New();
+  m_MeasurementTimeStamp = igtl::TimeStamp::New();
+  m_MessageTimeStamp = igtl::TimeStamp::New();
 }
 
 mitk::IGTLDevice::~IGTLDevice()
@@ -120,11 +128,100 @@ bool mitk::IGTLDevice::TestConnection()
   return true;
 }
 
+unsigned long mitk::IGTLDevice::GetWakeUpCount()
+{
+  WakeUpLockHolder lock(m_WakeUpMutex);
+  return m_WakeUpCount;
+}
+
+void mitk::IGTLDevice::WaitForWakeUp(unsigned long wakeUpCount)
+{
+  WakeUpLockHolder lock(m_WakeUpMutex);
+  while (m_WakeUpCount == wakeUpCount)
+  {
+    // a stop before the wait is not missed: it is requested before the wake up,
+    // which has to wait for this thread to release the wake up mutex
+    m_StopCommunicationMutex->Lock();
+    const bool stop = m_StopCommunication;
+    m_StopCommunicationMutex->Unlock();
+    if (stop)
+    {
+      return;
+    }
+    m_WakeUpCondition->Wait(&m_WakeUpMutex);
+  }
+}
+
+void mitk::IGTLDevice::WakeUpCommunication()
+{
+  WakeUpLockHolder lock(m_WakeUpMutex);
+  ++m_WakeUpCount;
+  m_WakeUpCondition->Broadcast();
+}
+
+igtl::MessageBase::Pointer mitk::IGTLDevice::CreateReceiveMessage(igtl::MessageHeader* header)
+{
+  // only image messages are large enough to be worth reusing and their
+  // content is completely rewritten when they are unpacked
+  if (m_MaximumNumberOfPooledMessages == 0)
+  {
+    m_MessagePool.clear();
+    return m_MessageFactory->CreateInstance(header);
+  }
+  if (std::strcmp(header->GetDeviceType(), "IMAGE") != 0)
+  {
+    return m_MessageFactory->CreateInstance(header);
+  }
+
+  // a message is free if the pool holds the only reference to it, thus,
+  // it was neither queued nor kept by a consumer
+  for (auto& pooled : m_MessagePool)
+  {
+    if (pooled->GetReferenceCount() == 1)
+    {
+      return pooled;
+    }
+  }
+
+  igtl::MessageBase::Pointer msg = m_MessageFactory->CreateInstance(header);
+  if (msg.IsNotNull() && m_MessagePool.size() < m_MaximumNumberOfPooledMessages)
+  {
+    m_MessagePool.push_back(msg);
+  }
+  return msg;
+}
+
+void mitk::IGTLDevice::AddChannelMeasurement(const char* channel, igtl::MessageBase* msg)
+{
+  if (m_Measurements == nullptr || !m_Measurements->GetStarted())
+    return;
+
+  // this is called by the sending and the receiving thread
+  MeasurementLockHolder lock(m_MeasurementMutex);
+  m_MeasurementTimeStamp->GetTime();
+  double now = m_MeasurementTimeStamp->GetTimeStamp();
+
+  // messages without a time stamp have no known latency
+  double latency = -1.0;
+  msg->GetTimeStamp(m_MessageTimeStamp);
+  double messageTime = m_MessageTimeStamp->GetTimeStamp();
+  if (messageTime > 0.0)
+  {
+    latency = (now - messageTime) * 1000.0;
+  }
+
+  m_Measurements->AddChannelMessage(channel, msg->GetPackSize(), now, latency);
+}
+
 unsigned int mitk::IGTLDevice::ReceivePrivate(igtl::Socket* socket)
 {
-  // Create a message buffer to receive header
-  igtl::MessageHeader::Pointer headerMsg;
-  headerMsg = igtl::MessageHeader::New();
+  // Create a message buffer to receive header, it is reused until it is
+  // pushed into the command queue
+  if (m_ReceiveHeader.IsNull())
+  {
+    m_ReceiveHeader = igtl::MessageHeader::New();
+  }
+  igtl::MessageHeader::Pointer headerMsg = m_ReceiveHeader;
 
   // Initialize receive buffer
   headerMsg->InitPack();
@@ -133,10 +230,6 @@ unsigned int mitk::IGTLDevice::ReceivePrivate(igtl::Socket* socket)
   int r =
     socket->Receive(headerMsg->GetPackPointer(), headerMsg->GetPackSize(), 0);
 
-  //MITK_INFO << "Server received r = " << r;
-
-  MITK_INFO << "Received r = " << r;
-
   if (r == 0) //connection error
   {
     // an error was received, therefore the communication with this socket
@@ -156,21 +249,6 @@ unsigned int mitk::IGTLDevice::ReceivePrivate(igtl::Socket* socket)
 
     if (crcCheck & igtl::MessageHeader::UNPACK_HEADER)
     {
-      // Allocate a time stamp
-      igtl::TimeStamp::Pointer ts;
-      ts = igtl::TimeStamp::New();
-
-      // Get time stamp
-      igtlUint32 sec;
-      igtlUint32 nanosec;
-
-      headerMsg->GetTimeStamp(ts);
-      ts->GetTimeStamp(&sec, &nanosec);
-
-      //      std::cerr << "Time stamp: "
-      //                << sec << "."
-      //                << nanosec << std::endl;
-
       //      std::cerr << "Dev type and name: " << headerMsg->GetDeviceType() << " "
       //                << headerMsg->GetDeviceName() << std::endl;
 
@@ -184,14 +262,17 @@ unsigned int mitk::IGTLDevice::ReceivePrivate(igtl::Socket* socket)
         std::strstr(curDevType, "STP_") != nullptr ||
         std::strstr(curDevType, "RTS_") != nullptr)
       {
+        m_ReceiveHeader = nullptr;
         this->m_MessageQueue->PushCommandMessage(headerMsg);
+        this->AddChannelMeasurement(
+          IGTLMessageQueue::GetChannelName(IGTLMessageQueue::CommandChannel), headerMsg);
         this->InvokeEvent(CommandReceivedEvent());
         return IGTL_STATUS_OK;
       }
 
-      //Create a message according to the header message
-      igtl::MessageBase::Pointer curMessage;
-      curMessage = m_MessageFactory->CreateInstance(headerMsg);
+      //Create a message according to the header message, the receive buffer
+      //of an image message is reused if possible
+      igtl::MessageBase::Pointer curMessage = this->CreateReceiveMessage(headerMsg);
 
       //check if the curMessage is created properly, if not the message type is
       //not supported and the message has to be skipped
@@ -228,11 +309,14 @@ unsigned int mitk::IGTLDevice::ReceivePrivate(igtl::Socket* socket)
         if (std::strstr(curDevType, "STT_") != nullptr)
         {
           this->m_MessageQueue->PushCommandMessage(curMessage);
+          this->AddChannelMeasurement(
+            IGTLMessageQueue::GetChannelName(IGTLMessageQueue::CommandChannel), curMessage);
           this->InvokeEvent(CommandReceivedEvent());
         }
         else
         {
-          this->m_MessageQueue->PushMessage(curMessage);
+          IGTLMessageQueue::MessageChannel channel = this->m_MessageQueue->PushMessage(curMessage);
+          this->AddChannelMeasurement(IGTLMessageQueue::GetChannelName(channel), curMessage);
           this->InvokeEvent(MessageReceivedEvent());
         }
         return IGTL_STATUS_OK;
@@ -292,6 +376,8 @@ unsigned int mitk::IGTLDevice::SendMessagePrivate(igtl::MessageBase::Pointer msg
 
   if (sendSuccess)
   {
+    this->AddChannelMeasurement(
+      IGTLMessageQueue::GetChannelName(IGTLMessageQueue::SendChannel), msg);
     this->InvokeEvent(MessageSentEvent());
     return IGTL_STATUS_OK;
   }
@@ -328,8 +414,8 @@ void mitk::IGTLDevice::RunCommunication(void (IGTLDevice::*ComFunction)(void), i
       localStopCommunication = m_StopCommunication;
       this->m_StopCommunicationMutex->Unlock();
 
-      // time to relax, this sets the maximum ever possible framerate to 1000 Hz
-      itksys::SystemTools::Delay(1);
+      // there is no need to relax here, the communication functions block
+      // until there is something to do or the communication is stopped
     }
   }
   catch (...)
@@ -364,6 +450,10 @@ bool mitk::IGTLDevice::StartCommunication()
   this->m_StopCommunication = false;
   this->m_StopCommunicationMutex->Unlock();
 
+  // allow the communication threads to block while they have nothing to do
+  this->m_MessageQueue->ResumeSendWait();
+  m_Measurements = mitk::IGTLMeasurements::GetInstance();
+
   // transfer the execution rights to tracking thread
   m_SendingFinishedMutex->Unlock();
   m_ReceivingFinishedMutex->Unlock();
@@ -389,6 +479,9 @@ bool mitk::IGTLDevice::StopCommunication()
     m_StopCommunicationMutex->Lock();
     m_StopCommunication = true;
     m_StopCommunicationMutex->Unlock();
+    // wake up the threads that are waiting for something to do
+    m_MessageQueue->InterruptSendWait();
+    this->WakeUpCommunication();
     // we have to wait here that the other thread recognizes the STOP-command
     // and executes it
     m_SendingFinishedMutex->Lock();
@@ -448,6 +541,8 @@ bool mitk::IGTLDevice::SendRTSMessage(const char* type)
 void mitk::IGTLDevice::Connect()
 {
   MITK_DEBUG << "mitk::IGTLDevice::Connect();";
+  // there is nothing to connect, thus wait until the communication is stopped
+  this->WaitForWakeUp(this->GetWakeUpCount());
 }
 
 igtl::ImageMessage::Pointer mitk::IGTLDevice::GetNextImage2dMessage()
@@ -22,18 +22,24 @@ See LICENSE.txt or http://www.mitk.org for details.
 //itk
 #include "itkObject.h"
 #include "itkFastMutexLock.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkConditionVariable.h"
 #include "itkMultiThreader.h"
 
 //igtl
 #include "igtlSocket.h"
 #include "igtlMessageBase.h"
 #include "igtlTransformMessage.h"
+#include "igtlMessageHeader.h"
+
+#include <vector>
 
 //mitkIGTL
 #include "MitkOpenIGTLinkExports.h"
 #include "mitkIGTLMessageFactory.h"
 #include "mitkIGTLMessageQueue.h"
 #include "mitkIGTLMessage.h"
+#include "mitkIGTLMeasurements.h"
 
 namespace mitk {
   /**
@@ -55,6 +61,12 @@ namespace mitk {
   * call StopCommunication() (to arrive in Ready state) or CloseConnection()
   * (to arrive in the Setup state).
   *
+  * The communication threads do not poll. The sending thread waits until a
+  * message is added to the send queue and the receiving thread blocks in the
+  * socket until data arrives or the socket times out. If the measurements
+  * (mitk::IGTLMeasurements) are started, the latency and throughput of every
+  * channel of the message queue is recorded.
+  *
   * \ingroup OpenIGTLink
   *
   */
@@ -254,6 +266,14 @@ namespace mitk {
     */
     virtual unsigned int GetNumberOfConnections() = 0;
 
+    /**
+    * \brief Sets the maximum number of received image messages that are kept
+    * for reuse. Reusing a message avoids reallocating its receive buffer if
+    * the consumer already released it. Default is 4, 0 disables the reuse.
+    */
+    itkSetMacro(MaximumNumberOfPooledMessages, unsigned int);
+    itkGetConstMacro(MaximumNumberOfPooledMessages, unsigned int);
+
   protected:
     /**
      * \brief Sends a message.
@@ -322,6 +342,39 @@ namespace mitk {
     */
     void SetState(IGTLDeviceState state);
 
+    /**
+    * \brief Returns the number of calls of WakeUpCommunication() so far.
+    * Read it before checking whether there is something to do and pass it to
+    * WaitForWakeUp(), so that a wake up in between is not missed.
+    */
+    unsigned long GetWakeUpCount();
+
+    /**
+    * \brief Blocks the calling communication thread until
+    * WakeUpCommunication() is called after wakeUpCount was read, or until
+    * the communication is stopped. StopCommunication() wakes up all
+    * waiting threads.
+    */
+    void WaitForWakeUp(unsigned long wakeUpCount);
+
+    /**
+    * \brief Wakes up all communication threads waiting in WaitForWakeUp()
+    */
+    void WakeUpCommunication();
+
+    /**
+    * \brief Returns a message with the type of the given header whose buffer
+    * can be reused, or a new message from the factory. Only image messages
+    * are reused.
+    */
+    igtl::MessageBase::Pointer CreateReceiveMessage(igtl::MessageHeader* header);
+
+    /**
+    * \brief Adds a received or sent message to the channel statistics of the
+    * measurements if they are started.
+    */
+    void AddChannelMeasurement(const char* channel, igtl::MessageBase* msg);
+
     IGTLDevice();
     virtual ~IGTLDevice();
 
@@ -369,6 +422,24 @@ namespace mitk {
     int m_ConnectThreadID;
     /** Always try to read the full message. */
     bool m_ReadFully;
+
+    /** wakes up communication threads that have nothing to do */
+    itk::ConditionVariable::Pointer m_WakeUpCondition;
+    itk::SimpleMutexLock m_WakeUpMutex;
+    /** incremented by every wake up, each waiter compares it with the count it started with */
+    unsigned long m_WakeUpCount;
+
+    /** header of the next received message, reused until it is queued */
+    igtl::MessageHeader::Pointer m_ReceiveHeader;
+    /** received image messages whose buffers can be reused */
+    std::vector<igtl::MessageBase::Pointer> m_MessagePool;
+    unsigned int m_MaximumNumberOfPooledMessages;
+
+    /** measurements of the module, set when the communication is started */
+    mitk::IGTLMeasurements* m_Measurements;
+    igtl::TimeStamp::Pointer m_MeasurementTimeStamp;
+    igtl::TimeStamp::Pointer m_MessageTimeStamp;
+    itk::SimpleFastMutexLock m_MeasurementMutex;
   };
 
   /**
@@ -25,8 +25,38 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "usGetModuleContext.h"
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+
+#include <itkMutexLockHolder.h>
+
+typedef itk::MutexLockHolder<itk::FastMutexLock> MutexLockHolder;
+
+mitk::IGTLMeasurements::ChannelStatistics::ChannelStatistics()
+  : NumberOfMessages(0), NumberOfBytes(0), NumberOfLatencySamples(0),
+  LastLatency(0.0), MeanLatency(0.0), MaximumLatency(0.0),
+  FirstMessageTime(0.0), LastMessageTime(0.0)
+{
+}
+
+double mitk::IGTLMeasurements::ChannelStatistics::GetMessagesPerSecond() const
+{
+  double duration = LastMessageTime - FirstMessageTime;
+  if (NumberOfMessages < 2 || duration <= 0.0)
+    return 0.0;
+  return (NumberOfMessages - 1) / duration;
+}
+
+double mitk::IGTLMeasurements::ChannelStatistics::GetBytesPerSecond() const
+{
+  double duration = LastMessageTime - FirstMessageTime;
+  if (NumberOfMessages < 2 || duration <= 0.0)
+    return 0.0;
+  return NumberOfBytes / duration;
+}
 
 mitk::IGTLMeasurements::IGTLMeasurements()
+  : m_ChannelStatisticsMutex(itk::FastMutexLock::New()),
+  m_IsStarted(false)
 {
 }
 
@@ -124,9 +154,63 @@ bool mitk::IGTLMeasurements::ExportData(std::string filename)
 void mitk::IGTLMeasurements::Reset()
 {
   m_MeasurementPoints.clear();
+  this->ResetChannelStatistics();
 }
 
 void mitk::IGTLMeasurements::SetStarted(bool started)
 {
   m_IsStarted = started;
 }
+
+bool mitk::IGTLMeasurements::GetStarted() const
+{
+  return m_IsStarted;
+}
+
+void mitk::IGTLMeasurements::AddChannelMessage(const std::string& channel,
+  unsigned long long bytes, double time, double latency)
+{
+  if (!m_IsStarted)
+    return;
+
+  MutexLockHolder lock(*m_ChannelStatisticsMutex);
+  ChannelStatistics& statistics = m_ChannelStatistics[channel];
+
+  if (statistics.NumberOfMessages == 0)
+    statistics.FirstMessageTime = time;
+  statistics.LastMessageTime = time;
+  ++statistics.NumberOfMessages;
+  statistics.NumberOfBytes += bytes;
+
+  if (latency >= 0.0)
+  {
+    ++statistics.NumberOfLatencySamples;
+    statistics.LastLatency = latency;
+    statistics.MaximumLatency = std::max(statistics.MaximumLatency, latency);
+    statistics.MeanLatency += (latency - statistics.MeanLatency) / statistics.NumberOfLatencySamples;
+  }
+}
+
+mitk::IGTLMeasurements::ChannelStatistics mitk::IGTLMeasurements::GetChannelStatistics(const std::string& channel)
+{
+  MutexLockHolder lock(*m_ChannelStatisticsMutex);
+  auto it = m_ChannelStatistics.find(channel);
+  if (it == m_ChannelStatistics.end())
+    return ChannelStatistics();
+  return it->second;
+}
+
+std::vector<std::string> mitk::IGTLMeasurements::GetChannelNames()
+{
+  MutexLockHolder lock(*m_ChannelStatisticsMutex);
+  std::vector<std::string> names;
+  for (auto& entry : m_ChannelStatistics)
+    names.push_back(entry.first);
+  return names;
+}
+
+void mitk::IGTLMeasurements::ResetChannelStatistics()
+{
+  MutexLockHolder lock(*m_ChannelStatisticsMutex);
+  m_ChannelStatistics.clear();
+}
@@ -23,8 +23,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "MitkOpenIGTLinkExports.h"
 #include "itkObject.h"
+#include "itkFastMutexLock.h"
 #include "mitkCommon.h"
 
+#include <map>
+#include <list>
+#include <vector>
+#include <string>
+
 namespace mitk {
 
    ///**
@@ -99,6 +105,61 @@ namespace mitk {
 
     void SetStarted(bool started);
 
+    /**
+    * \brief Latency and throughput counters of a single message channel
+    */
+    struct ChannelStatistics
+    {
+      ChannelStatistics();
+
+      /** \brief Returns the mean number of messages per second */
+      double GetMessagesPerSecond() const;
+
+      /** \brief Returns the mean number of bytes per second */
+      double GetBytesPerSecond() const;
+
+      unsigned long NumberOfMessages;
+      unsigned long long NumberOfBytes;
+      /** \brief number of messages with a valid time stamp */
+      unsigned long NumberOfLatencySamples;
+      /** \brief latencies in milliseconds */
+      double LastLatency;
+      double MeanLatency;
+      double MaximumLatency;
+      /** \brief receive or send times of the first and last message in seconds */
+      double FirstMessageTime;
+      double LastMessageTime;
+    };
+
+    /**
+    * \brief Adds a message to the counters of the given channel.
+    *
+    * The counters are only updated if the measurements were started.
+    * \param bytes size of the message
+    * \param time local receive or send time in seconds
+    * \param latency latency in milliseconds, a negative value means that the
+    * latency is unknown
+    */
+    void AddChannelMessage(const std::string& channel, unsigned long long bytes,
+      double time, double latency = -1.0);
+
+    /**
+    * \brief Returns the counters of the given channel
+    */
+    ChannelStatistics GetChannelStatistics(const std::string& channel);
+
+    /**
+    * \brief Returns the names of all channels with at least one message
+    */
+    std::vector<std::string> GetChannelNames();
+
+    /**
+    * \brief clears the counters of all channels
+    */
+    void ResetChannelStatistics();
+
+    bool GetStarted() const;
+
   private:
     // Only our module activator class should be able to instantiate
     // a SingletonOneService object.
@@ -123,6 +184,11 @@ namespace mitk {
 
     MeasurementPoints                               m_MeasurementPoints;
 
+    typedef std::map<std::string, ChannelStatistics> ChannelStatisticsMap;
+
+    ChannelStatisticsMap                            m_ChannelStatistics;
+    itk::FastMutexLock::Pointer                     m_ChannelStatisticsMutex;
+
     bool m_IsStarted;
   };
 } // namespace mitk
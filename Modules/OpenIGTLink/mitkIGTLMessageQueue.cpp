@@ -16,211 +16,192 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkIGTLMessageQueue.h"
 #include <string>
+#include <algorithm>
 #include "igtlMessageBase.h"
 
-void mitk::IGTLMessageQueue::PushSendMessage(igtl::MessageBase::Pointer message)
+typedef itk::MutexLockHolder<itk::SimpleMutexLock> ChannelLockHolder;
+typedef itk::MutexLockHolder<itk::SimpleFastMutexLock> LatestMessageLockHolder;
+
+const char* mitk::IGTLMessageQueue::GetChannelName(MessageChannel channel)
+{
+  switch (channel)
+  {
+  case CommandChannel: return "COMMAND";
+  case Image2dChannel: return "IMAGE2D";
+  case Image3dChannel: return "IMAGE3D";
+  case TransformChannel: return "TRANSFORM";
+  case TrackingDataChannel: return "TDATA";
+  case StringChannel: return "STRING";
+  case MiscChannel: return "OTHER";
+  case SendChannel: return "SEND";
+  default: return "";
+  }
+}
+
+void mitk::IGTLMessageQueue::MakeRoom(ChannelQueue& queue)
 {
-  this->m_Mutex->Lock();
-  if (this->m_BufferingType == IGTLMessageQueue::Infinit)
-    m_SendQueue.clear();
+  std::size_t maximumSize;
+  switch (queue.Policy)
+  {
+  case KeepLatest:
+    maximumSize = 1;
+    break;
+  case DropOldest:
+    maximumSize = std::max(queue.MaximumSize, 1u);
+    break;
+  default:
+    return;
+  }
 
-  m_SendQueue.push_back(message);
-  this->m_Mutex->Unlock();
+  while (queue.Messages.size() >= maximumSize)
+  {
+    queue.Messages.pop_front();
+    ++queue.NumberOfDroppedMessages;
+  }
 }
 
-void mitk::IGTLMessageQueue::PushCommandMessage(igtl::MessageBase::Pointer message)
+void mitk::IGTLMessageQueue::PushToChannel(MessageChannel channel, igtl::MessageBase* message)
 {
-  this->m_Mutex->Lock();
-  if (this->m_BufferingType == IGTLMessageQueue::Infinit)
-    m_CommandQueue.clear();
+  ChannelQueue& queue = m_Channels[channel];
+  ChannelLockHolder lock(queue.Mutex);
+  MakeRoom(queue);
+  queue.Messages.push_back(message);
+}
 
-  m_CommandQueue.push_back(message);
-  this->m_Mutex->Unlock();
+igtl::MessageBase::Pointer mitk::IGTLMessageQueue::PullFromChannel(MessageChannel channel)
+{
+  igtl::MessageBase::Pointer ret = nullptr;
+  ChannelQueue& queue = m_Channels[channel];
+  ChannelLockHolder lock(queue.Mutex);
+  if (!queue.Messages.empty())
+  {
+    ret = queue.Messages.front();
+    queue.Messages.pop_front();
+  }
+  return ret;
 }
 
-void mitk::IGTLMessageQueue::PushMessage(igtl::MessageBase::Pointer msg)
+void mitk::IGTLMessageQueue::PushSendMessage(igtl::MessageBase::Pointer message)
 {
-  this->m_Mutex->Lock();
+  this->PushToChannel(SendChannel, message);
+  m_SendCondition->Signal();
+}
 
-  std::stringstream infolog;
+void mitk::IGTLMessageQueue::PushCommandMessage(igtl::MessageBase::Pointer message)
+{
+  this->PushToChannel(CommandChannel, message);
+}
 
-  infolog << "Received message of type ";
+mitk::IGTLMessageQueue::MessageChannel mitk::IGTLMessageQueue::PushMessage(igtl::MessageBase::Pointer msg)
+{
+  MessageChannel channel = MiscChannel;
 
   if (dynamic_cast<igtl::TrackingDataMessage*>(msg.GetPointer()) != nullptr)
   {
-    if (this->m_BufferingType == IGTLMessageQueue::Infinit)
-      m_TrackingDataQueue.clear();
-
-    this->m_TrackingDataQueue.push_back(dynamic_cast<igtl::TrackingDataMessage*>(msg.GetPointer()));
-
-    infolog << "TDATA";
+    channel = TrackingDataChannel;
   }
   else if (dynamic_cast<igtl::TransformMessage*>(msg.GetPointer()) != nullptr)
   {
-    if (this->m_BufferingType == IGTLMessageQueue::Infinit)
-      m_TransformQueue.clear();
-
-    this->m_TransformQueue.push_back(dynamic_cast<igtl::TransformMessage*>(msg.GetPointer()));
-
-    infolog << "TRANSFORM";
+    channel = TransformChannel;
   }
   else if (dynamic_cast<igtl::StringMessage*>(msg.GetPointer()) != nullptr)
   {
-    if (this->m_BufferingType == IGTLMessageQueue::Infinit)
-      m_StringQueue.clear();
-
-    this->m_StringQueue.push_back(dynamic_cast<igtl::StringMessage*>(msg.GetPointer()));
-
-    infolog << "STRING";
+    channel = StringChannel;
   }
-  else if (dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()) != nullptr)
+  else if (igtl::ImageMessage* imageMsg = dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()))
   {
-    igtl::ImageMessage::Pointer imageMsg = dynamic_cast<igtl::ImageMessage*>(msg.GetPointer());
-    int* dim = new int[3];
+    int dim[3];
     imageMsg->GetDimensions(dim);
-    if (dim[2] > 1)
-    {
-      if (this->m_BufferingType == IGTLMessageQueue::Infinit)
-        m_Image3dQueue.clear();
-
-      this->m_Image3dQueue.push_back(dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()));
-
-      infolog << "IMAGE3D";
-    }
-    else
-    {
-      if (this->m_BufferingType == IGTLMessageQueue::Infinit)
-        m_Image2dQueue.clear();
-
-      this->m_Image2dQueue.push_back(dynamic_cast<igtl::ImageMessage*>(msg.GetPointer()));
-
-      infolog << "IMAGE2D";
-    }
+    channel = dim[2] > 1 ? Image3dChannel : Image2dChannel;
   }
-  else
-  {
-    if (this->m_BufferingType == IGTLMessageQueue::Infinit)
-      m_MiscQueue.clear();
-
-    this->m_MiscQueue.push_back(msg);
 
-    infolog << "OTHER";
-  }
+  this->PushToChannel(channel, msg);
 
+  LatestMessageLockHolder lock(m_LatestMessageMutex);
   m_Latest_Message = msg;
 
-  MITK_INFO << infolog.str();
-
-  this->m_Mutex->Unlock();
+  return channel;
 }
 
 igtl::MessageBase::Pointer mitk::IGTLMessageQueue::PullSendMessage()
 {
+  return this->PullFromChannel(SendChannel);
+}
+
+igtl::MessageBase::Pointer mitk::IGTLMessageQueue::WaitForSendMessage()
+{
+  ChannelQueue& queue = m_Channels[SendChannel];
+  ChannelLockHolder lock(queue.Mutex);
+  while (queue.Messages.empty() && !m_SendWaitInterrupted)
+  {
+    m_SendCondition->Wait(&queue.Mutex);
+  }
+
   igtl::MessageBase::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_SendQueue.size() > 0)
+  if (!queue.Messages.empty())
   {
-    ret = this->m_SendQueue.front();
-    this->m_SendQueue.pop_front();
+    ret = queue.Messages.front();
+    queue.Messages.pop_front();
   }
-  this->m_Mutex->Unlock();
   return ret;
 }
 
+void mitk::IGTLMessageQueue::InterruptSendWait()
+{
+  ChannelLockHolder lock(m_Channels[SendChannel].Mutex);
+  m_SendWaitInterrupted = true;
+  m_SendCondition->Broadcast();
+}
+
+void mitk::IGTLMessageQueue::ResumeSendWait()
+{
+  ChannelLockHolder lock(m_Channels[SendChannel].Mutex);
+  m_SendWaitInterrupted = false;
+}
+
 igtl::MessageBase::Pointer mitk::IGTLMessageQueue::PullMiscMessage()
 {
-  igtl::MessageBase::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_MiscQueue.size() > 0)
-  {
-    ret = this->m_MiscQueue.front();
-    this->m_MiscQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->PullFromChannel(MiscChannel);
 }
 
 igtl::ImageMessage::Pointer mitk::IGTLMessageQueue::PullImage2dMessage()
 {
-  igtl::ImageMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_Image2dQueue.size() > 0)
-  {
-    ret = this->m_Image2dQueue.front();
-    this->m_Image2dQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  igtl::MessageBase::Pointer msg = this->PullFromChannel(Image2dChannel);
+  return static_cast<igtl::ImageMessage*>(msg.GetPointer());
 }
 
 igtl::ImageMessage::Pointer mitk::IGTLMessageQueue::PullImage3dMessage()
 {
-  igtl::ImageMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_Image3dQueue.size() > 0)
-  {
-    ret = this->m_Image3dQueue.front();
-    this->m_Image3dQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  igtl::MessageBase::Pointer msg = this->PullFromChannel(Image3dChannel);
+  return static_cast<igtl::ImageMessage*>(msg.GetPointer());
 }
 
 igtl::TrackingDataMessage::Pointer mitk::IGTLMessageQueue::PullTrackingMessage()
 {
-  igtl::TrackingDataMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_TrackingDataQueue.size() > 0)
-  {
-    ret = this->m_TrackingDataQueue.front();
-    this->m_TrackingDataQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  igtl::MessageBase::Pointer msg = this->PullFromChannel(TrackingDataChannel);
+  return static_cast<igtl::TrackingDataMessage*>(msg.GetPointer());
 }
 
 igtl::MessageBase::Pointer mitk::IGTLMessageQueue::PullCommandMessage()
 {
-  igtl::MessageBase::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_CommandQueue.size() > 0)
-  {
-    ret = this->m_CommandQueue.front();
-    this->m_CommandQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  return this->PullFromChannel(CommandChannel);
 }
 
 igtl::StringMessage::Pointer mitk::IGTLMessageQueue::PullStringMessage()
 {
-  igtl::StringMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_StringQueue.size() > 0)
-  {
-    ret = this->m_StringQueue.front();
-    this->m_StringQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  igtl::MessageBase::Pointer msg = this->PullFromChannel(StringChannel);
+  return static_cast<igtl::StringMessage*>(msg.GetPointer());
 }
 
 igtl::TransformMessage::Pointer mitk::IGTLMessageQueue::PullTransformMessage()
 {
-  igtl::TransformMessage::Pointer ret = nullptr;
-  this->m_Mutex->Lock();
-  if (this->m_TransformQueue.size() > 0)
-  {
-    ret = this->m_TransformQueue.front();
-    this->m_TransformQueue.pop_front();
-  }
-  this->m_Mutex->Unlock();
-  return ret;
+  igtl::MessageBase::Pointer msg = this->PullFromChannel(TransformChannel);
+  return static_cast<igtl::TransformMessage*>(msg.GetPointer());
 }
 
 std::string mitk::IGTLMessageQueue::GetNextMsgInformationString()
 {
-  this->m_Mutex->Lock();
+  LatestMessageLockHolder lock(m_LatestMessageMutex);
   std::stringstream s;
   if (this->m_Latest_Message != nullptr)
   {
@@ -231,13 +212,12 @@ std::string mitk::IGTLMessageQueue::GetNextMsgInformationString()
   {
     s << "No Msg";
   }
-  this->m_Mutex->Unlock();
   return s.str();
 }
 
 std::string mitk::IGTLMessageQueue::GetNextMsgDeviceType()
 {
-  this->m_Mutex->Lock();
+  LatestMessageLockHolder lock(m_LatestMessageMutex);
   std::stringstream s;
   if (m_Latest_Message != nullptr)
   {
@@ -247,13 +227,12 @@ std::string mitk::IGTLMessageQueue::GetNextMsgDeviceType()
   {
     s << "";
   }
-  this->m_Mutex->Unlock();
   return s.str();
 }
 
 std::string mitk::IGTLMessageQueue::GetLatestMsgInformationString()
 {
-  this->m_Mutex->Lock();
+  LatestMessageLockHolder lock(m_LatestMessageMutex);
   std::stringstream s;
   if (m_Latest_Message != nullptr)
   {
@@ -264,13 +243,12 @@ std::string mitk::IGTLMessageQueue::GetLatestMsgInformationString()
   {
     s << "No Msg";
   }
-  this->m_Mutex->Unlock();
   return s.str();
 }
 
 std::string mitk::IGTLMessageQueue::GetLatestMsgDeviceType()
 {
-  this->m_Mutex->Lock();
+  LatestMessageLockHolder lock(m_LatestMessageMutex);
   std::stringstream s;
   if (m_Latest_Message != nullptr)
   {
@@ -280,33 +258,66 @@ std::string mitk::IGTLMessageQueue::GetLatestMsgDeviceType()
   {
     s << "";
   }
-  this->m_Mutex->Unlock();
   return s.str();
 }
 
 int mitk::IGTLMessageQueue::GetSize()
 {
-  return (this->m_CommandQueue.size() + this->m_Image2dQueue.size() + this->m_Image3dQueue.size() + this->m_MiscQueue.size()
-    + this->m_StringQueue.size() + this->m_TrackingDataQueue.size() + this->m_TransformQueue.size());
+  // the send channel is not part of the receive queue
+  int size = 0;
+  for (int channel = 0; channel < SendChannel; ++channel)
+  {
+    size += this->GetSize(static_cast<MessageChannel>(channel));
+  }
+  return size;
+}
+
+unsigned int mitk::IGTLMessageQueue::GetSize(MessageChannel channel)
+{
+  ChannelLockHolder lock(m_Channels[channel].Mutex);
+  return m_Channels[channel].Messages.size();
+}
+
+unsigned long mitk::IGTLMessageQueue::GetNumberOfDroppedMessages(MessageChannel channel)
+{
+  ChannelLockHolder lock(m_Channels[channel].Mutex);
+  return m_Channels[channel].NumberOfDroppedMessages;
+}
+
+void mitk::IGTLMessageQueue::SetBufferingPolicy(MessageChannel channel,
+  BufferingPolicy policy, unsigned int maximumSize)
+{
+  ChannelLockHolder lock(m_Channels[channel].Mutex);
+  m_Channels[channel].Policy = policy;
+  m_Channels[channel].MaximumSize = std::max(maximumSize, 1u);
+}
+
+mitk::IGTLMessageQueue::BufferingPolicy mitk::IGTLMessageQueue::GetBufferingPolicy(MessageChannel channel)
+{
+  ChannelLockHolder lock(m_Channels[channel].Mutex);
+  return m_Channels[channel].Policy;
 }
 
 void mitk::IGTLMessageQueue::EnableInfiniteBuffering(bool enable)
 {
-  this->m_Mutex->Lock();
   if (enable)
     this->m_BufferingType = IGTLMessageQueue::BufferingType::Infinit;
   else
     this->m_BufferingType = IGTLMessageQueue::BufferingType::NoBuffering;
-  this->m_Mutex->Unlock();
+
+  for (int channel = 0; channel < NumberOfChannels; ++channel)
+  {
+    this->SetBufferingPolicy(static_cast<MessageChannel>(channel), enable ? KeepAll : KeepLatest);
+  }
 }
 
 mitk::IGTLMessageQueue::IGTLMessageQueue()
+  : m_SendWaitInterrupted(false)
 {
-  this->m_Mutex = itk::FastMutexLock::New();
-  this->m_BufferingType = IGTLMessageQueue::Infinit;
+  this->m_SendCondition = itk::ConditionVariable::New();
+  this->m_BufferingType = IGTLMessageQueue::NoBuffering;
 }
 
 mitk::IGTLMessageQueue::~IGTLMessageQueue()
 {
-  this->m_Mutex->Unlock();
-}
\ No newline at end of file
+}
@@ -20,7 +20,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "MitkOpenIGTLinkExports.h"
 
 #include "itkObject.h"
-#include "itkFastMutexLock.h"
+#include "itkSimpleFastMutexLock.h"
+#include "itkConditionVariable.h"
+#include "itkMutexLockHolder.h"
 #include "mitkCommon.h"
 
 #include <deque>
@@ -37,6 +39,11 @@ namespace mitk {
   * \class IGTLMessageQueue
   * \brief Thread safe message queue to store OpenIGTLink messages.
   *
+  * Every message type is stored in a channel of its own which is guarded by
+  * its own lock. Thus, a burst of large image messages does not block the
+  * delivery of tracking data. The buffering policy can be configured per
+  * channel.
+  *
   * \ingroup OpenIGTLink
   */
   class MITKOPENIGTLINK_EXPORT IGTLMessageQueue : public itk::Object
@@ -53,12 +60,38 @@ namespace mitk {
        */
     enum BufferingType { Infinit, NoBuffering };
 
+    /**
+    * \brief Buffering policy of a single channel
+    *
+    * KeepAll stores every message, KeepLatest only stores the newest message
+    * and DropOldest stores up to the maximum channel size and drops the
+    * oldest messages if the channel is full.
+    */
+    enum BufferingPolicy { KeepAll, KeepLatest, DropOldest };
+
+    /**
+    * \brief The channels of the queue, one per message type
+    */
+    enum MessageChannel
+    {
+      CommandChannel,
+      Image2dChannel,
+      Image3dChannel,
+      TransformChannel,
+      TrackingDataChannel,
+      StringChannel,
+      MiscChannel,
+      SendChannel,
+      NumberOfChannels
+    };
+
     void PushSendMessage(igtl::MessageBase::Pointer message);
 
     /**
     * \brief Adds the message to the queue
+    * \return the channel the message was stored in
     */
-    void PushMessage(igtl::MessageBase::Pointer message);
+    MessageChannel PushMessage(igtl::MessageBase::Pointer message);
 
     /**
     * \brief Adds the message to the queue
@@ -76,11 +109,56 @@ namespace mitk {
     igtl::TransformMessage::Pointer PullTransformMessage();
     igtl::MessageBase::Pointer PullSendMessage();
 
+    /**
+    * \brief Returns and removes the oldest message from the send channel.
+    *
+    * Blocks until a message is available or the wait is interrupted by
+    * InterruptSendWait(). Returns nullptr in the latter case.
+    */
+    igtl::MessageBase::Pointer WaitForSendMessage();
+
+    /**
+    * \brief Wakes up all threads waiting in WaitForSendMessage(). Until
+    * ResumeSendWait() is called, WaitForSendMessage() does not block anymore.
+    */
+    void InterruptSendWait();
+
+    /**
+    * \brief Allows WaitForSendMessage() to block again.
+    */
+    void ResumeSendWait();
+
     /**
     * \brief Get the number of messages in the queue
     */
     int GetSize();
 
+    /**
+    * \brief Get the number of messages in the given channel
+    */
+    unsigned int GetSize(MessageChannel channel);
+
+    /**
+    * \brief Returns the number of messages that were dropped by the buffering
+    * policy of the given channel
+    */
+    unsigned long GetNumberOfDroppedMessages(MessageChannel channel);
+
+    /**
+    * \brief Sets the buffering policy of the given channel.
+    * \param maximumSize maximum number of stored messages, only used by the
+    * DropOldest policy
+    */
+    void SetBufferingPolicy(MessageChannel channel, BufferingPolicy policy,
+      unsigned int maximumSize = 1);
+
+    BufferingPolicy GetBufferingPolicy(MessageChannel channel);
+
+    /**
+    * \brief Returns a short name of the given channel, e.g. "TDATA"
+    */
+    static const char* GetChannelName(MessageChannel channel);
+
     /**
     * \brief Returns a string with information about the oldest message in the
     * queue
@@ -104,8 +182,9 @@ namespace mitk {
     std::string GetLatestMsgDeviceType();
 
     /**
-    * \brief Sets infinite buffering on/off.
-    * Initiale value is enabled.
+    * \brief Sets infinite buffering on/off for all channels.
+    * If enabled, all channels keep every message. Otherwise only the latest
+    * message is kept. Initial value is disabled.
     */
     void EnableInfiniteBuffering(bool enable);
 
@@ -113,25 +192,45 @@ namespace mitk {
     IGTLMessageQueue();
     virtual ~IGTLMessageQueue();
 
-  protected:
     /**
-    * \brief Mutex to take car of the queue
+    * \brief A single channel of the queue
     */
-    itk::FastMutexLock::Pointer m_Mutex;
+    struct ChannelQueue
+    {
+      ChannelQueue() : Policy(KeepLatest), MaximumSize(1), NumberOfDroppedMessages(0) {}
 
+      itk::SimpleMutexLock Mutex;
+      std::deque< igtl::MessageBase::Pointer > Messages;
+      BufferingPolicy Policy;
+      unsigned int MaximumSize;
+      unsigned long NumberOfDroppedMessages;
+    };
+
+    void PushToChannel(MessageChannel channel, igtl::MessageBase* message);
+    igtl::MessageBase::Pointer PullFromChannel(MessageChannel channel);
+
+    /**
+    * \brief Removes the oldest messages of the channel until there is room
+    * for one more message. The channel mutex has to be locked.
+    */
+    static void MakeRoom(ChannelQueue& queue);
+
+  protected:
     /**
-    * \brief the queue that stores pointer to the inserted messages
+    * \brief the channels that store pointer to the inserted messages
     */
-    std::deque< igtl::MessageBase::Pointer > m_CommandQueue;
-    std::deque< igtl::ImageMessage::Pointer > m_Image2dQueue;
-    std::deque< igtl::ImageMessage::Pointer > m_Image3dQueue;
-    std::deque< igtl::TransformMessage::Pointer > m_TransformQueue;
-    std::deque< igtl::TrackingDataMessage::Pointer > m_TrackingDataQueue;
-    std::deque< igtl::StringMessage::Pointer > m_StringQueue;
-    std::deque< igtl::MessageBase::Pointer > m_MiscQueue;
+    ChannelQueue m_Channels[NumberOfChannels];
 
-    std::deque< igtl::MessageBase::Pointer> m_SendQueue;
+    /**
+    * \brief signaled whenever a message is added to the send channel
+    */
+    itk::ConditionVariable::Pointer m_SendCondition;
+    bool m_SendWaitInterrupted;
 
+    /**
+    * \brief Mutex to guard the latest message
+    */
+    itk::SimpleFastMutexLock m_LatestMessageMutex;
     igtl::MessageBase::Pointer m_Latest_Message;
 
     /**
@@ -17,7 +17,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkIGTLServer.h"
 #include <stdio.h>
 
-#include <itksys/SystemTools.hxx>
 #include <itkMutexLockHolder.h>
 
 #include <igtlServerSocket.h>
@@ -25,6 +24,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <igtlImageMessage.h>
 #include <igtl_status.h>
 
+//timeout of a single wait for new clients, this limits how long stopping the
+//communication takes
+static const unsigned long SERVER_CONNECTION_WAIT_MSEC = 50;
+
 mitk::IGTLServer::IGTLServer(bool ReadFully) :
 IGTLDevice(ReadFully)
 {
@@ -94,7 +97,7 @@ void mitk::IGTLServer::Connect()
   igtl::Socket::Pointer socket;
   //check if another igtl device wants to connect to this socket
   socket =
-    ((igtl::ServerSocket*)(this->m_Socket.GetPointer()))->WaitForConnection(1);
+    ((igtl::ServerSocket*)(this->m_Socket.GetPointer()))->WaitForConnection(SERVER_CONNECTION_WAIT_MSEC);
   //if there is a new connection the socket is not null
   if (socket.IsNotNull())
   {
@@ -104,6 +107,8 @@ void mitk::IGTLServer::Connect()
     this->m_RegisteredClients.push_back(socket);
     m_SentListMutex->Unlock();
     m_ReceiveListMutex->Unlock();
+    //the receiving thread might wait for the first client
+    this->WakeUpCommunication();
     //inform observers about this new client
     this->InvokeEvent(NewClientConnectionEvent());
     MITK_INFO("IGTLServer") << "Connected to a new client: " << socket;
@@ -118,7 +123,17 @@ void mitk::IGTLServer::Receive()
   //the server can be connected with several clients, therefore it has to check
   //all registered clients
   SocketListIteratorType it;
+  //a client that connects after this line wakes up the wait below
+  const unsigned long wakeUpCount = this->GetWakeUpCount();
   m_ReceiveListMutex->Lock();
+  if (this->m_RegisteredClients.empty())
+  {
+    //there is nothing to receive, wait until a client connects or the
+    //communication is stopped
+    m_ReceiveListMutex->Unlock();
+    this->WaitForWakeUp(wakeUpCount);
+    return;
+  }
   auto it_end = this->m_RegisteredClients.end();
   for (it = this->m_RegisteredClients.begin(); it != it_end; ++it)
   {
@@ -152,8 +167,8 @@ void mitk::IGTLServer::Send()
 {
   igtl::MessageBase::Pointer curMessage;
 
-  //get the latest message from the queue
-  curMessage = this->m_MessageQueue->PullSendMessage();
+  //wait for the next message of the queue
+  curMessage = this->m_MessageQueue->WaitForSendMessage();
 
   // there is no message => return
   if (curMessage.IsNull())
@@ -385,8 +385,13 @@ void QmitkIGTLDeviceSetupConnectionWidget::OnBufferIncomingMessages(int state)
 {
   if (this->m_IGTLDevice.IsNotNull())
   {
-    this->m_IGTLDevice->EnableInfiniteBufferingMode(
-      this->m_IGTLDevice->GetMessageQueue(), (bool)state);
+    mitk::IGTLMessageQueue::Pointer queue = this->m_IGTLDevice->GetMessageQueue();
+    mitk::IGTLMessageQueue::BufferingPolicy policy = state ?
+      mitk::IGTLMessageQueue::KeepAll : mitk::IGTLMessageQueue::KeepLatest;
+    for (int channel = 0; channel < mitk::IGTLMessageQueue::SendChannel; ++channel)
+    {
+      queue->SetBufferingPolicy(static_cast<mitk::IGTLMessageQueue::MessageChannel>(channel), policy);
+    }
   }
 }
 
@@ -394,8 +399,8 @@ void QmitkIGTLDeviceSetupConnectionWidget::OnBufferOutgoingMessages(int state)
 {
   if (this->m_IGTLDevice.IsNotNull())
   {
-    this->m_IGTLDevice->EnableInfiniteBufferingMode(
-      this->m_IGTLDevice->GetMessageQueue(), (bool)state);
+    this->m_IGTLDevice->GetMessageQueue()->SetBufferingPolicy(mitk::IGTLMessageQueue::SendChannel,
+      state ? mitk::IGTLMessageQueue::KeepAll : mitk::IGTLMessageQueue::KeepLatest);
   }
 }
 
@@ -17,6 +17,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImageSerializer.h"
 #include "mitkIOUtil.h"
 #include "mitkImage.h"
+#include "mitkItkImageIO.h"
 #include <Poco/Path.h>
 
 MITK_REGISTER_SERIALIZER(ImageSerializer)
@@ -49,7 +50,10 @@ std::string mitk::ImageSerializer::Serialize()
 
   try
   {
-    IOUtil::Save(image, fullname);
+    // scenes may hold many large images, compress them with all cores
+    IFileWriter::Options options;
+    options[ItkImageIO::OPTION_COMPRESSION()] = us::Any(ItkImageIO::COMPRESSION_PARALLEL());
+    IOUtil::Save(image, fullname, options);
   }
   catch (std::exception &e)
   {
@@ -16,10 +16,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkDiffSliceOperation.h"
 
+#include <mitkException.h>
 #include <mitkImage.h>
 
 #include <itkCommand.h>
 
+#include <vtkImageData.h>
+
 mitk::DiffSliceOperation::DiffSliceOperation() : Operation(1)
 {
   m_TimeStep = 0;
@@ -86,7 +89,20 @@ mitk::DiffSliceOperation::~DiffSliceOperation()
 
 mitk::Image::Pointer mitk::DiffSliceOperation::GetSlice()
 {
-  Image::Pointer image = m_zlibSliceContainer->GetImage();
+  if (m_zlibSliceContainer.IsNull())
+    return nullptr;
+
+  Image::Pointer image;
+  try
+  {
+    image = m_zlibSliceContainer->GetImage();
+  }
+  catch (const mitk::Exception &e)
+  {
+    // the released slice could not be read back, the operation cannot be executed anymore
+    MITK_ERROR << "Could not restore the slice of the operation: " << e.GetDescription();
+    m_zlibSliceContainer = nullptr;
+  }
   return image;
 }
 
@@ -100,3 +116,20 @@ void mitk::DiffSliceOperation::OnImageDeleted()
   // if our imageVolume is removed e.g. from the datastorage the operation is no lnger valid
   m_ImageIsValid = false;
 }
+
+std::size_t mitk::DiffSliceOperation::GetMemoryCost()
+{
+  std::size_t cost = m_zlibSliceContainer.IsNotNull() ? m_zlibSliceContainer->GetMemoryCost() : 0;
+  if (m_Slice != nullptr)
+  {
+    // vtkDataObject reports kibibytes
+    cost += static_cast<std::size_t>(m_Slice->GetActualMemorySize()) * 1024;
+  }
+  return cost;
+}
+
+void mitk::DiffSliceOperation::ReleaseMemory()
+{
+  if (m_zlibSliceContainer.IsNotNull())
+    m_zlibSliceContainer->ReleaseMemory();
+}
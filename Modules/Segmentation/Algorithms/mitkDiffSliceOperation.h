@@ -38,6 +38,8 @@ namespace mitk
      currentWorldGeometry   specifies the axis where the slice has to be applied in the volume.
 
     This Operation can be used to realize undo-redo functionality for e.g. segmentation purposes.
+    The slice is kept zlib compressed. Undo models with a memory budget can move it into a
+    temporary file via ReleaseMemory().
   */
   class MITKSEGMENTATION_EXPORT DiffSliceOperation : public Operation
   {
@@ -70,7 +72,8 @@ namespace mitk
     mitk::Image *GetImage() { return this->m_Image; }
     /** \brief Set thee slice to be applied.*/
     void SetImage(vtkImageData *slice) { this->m_Slice = slice; }
-    /** \brief Get the slice that is applied in the operation.*/
+    /** \brief Get the slice that is applied in the operation.
+      Returns nullptr and makes the operation invalid if the slice cannot be restored after ReleaseMemory().*/
     Image::Pointer GetSlice();
 
     /** \brief Get timeStep.*/
@@ -85,6 +88,12 @@ namespace mitk
     void SetCurrentWorldGeometry(BaseGeometry *worldGeometry) { this->m_WorldGeometry = worldGeometry; }
     /** \brief Get the axis where the slice has to be applied in the volume.*/
     BaseGeometry *GetWorldGeometry() { return this->m_WorldGeometry; }
+    /** \brief Returns the size of the compressed slice (and of the vtkImageData slice, if set) in memory.*/
+    virtual std::size_t GetMemoryCost() override;
+
+    /** \brief Moves the compressed slice into a temporary file, it is restored by GetSlice().*/
+    virtual void ReleaseMemory() override;
+
   protected:
     virtual ~DiffSliceOperation();
 
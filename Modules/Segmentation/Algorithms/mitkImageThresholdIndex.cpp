@@ -0,0 +1,383 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkImageThresholdIndex.h"
+
+#include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
+#include "mitkLabel.h"
+#include "mitkPixelTypeMultiplex.h"
+
+#include <itkMutexLockHolder.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+  const unsigned int BRICK_SIZE = mitk::ImageThresholdIndex::BrickSize;
+
+  unsigned int GetNumberOfBricks(unsigned int dimension) { return (dimension + BRICK_SIZE - 1) / BRICK_SIZE; }
+  bool Intersects(double minimum, double maximum, double first, double second)
+  {
+    return !(maximum < std::min(first, second) || minimum > std::max(first, second));
+  }
+
+  struct ThresholdParameters
+  {
+    const unsigned int *Dimensions;
+    bool Incremental;
+    /** Previous lower and upper, new lower and upper threshold */
+    const double *Thresholds;
+  };
+}
+
+// Computes the ranges of all bricks in the slab of bricks with z index brickZ. The maximum of a brick with NaN voxels
+// is NaN, so that the brick is never taken as completely inside of the thresholds.
+template <typename TPixel>
+static void ComputeSlabRanges(const mitk::PixelType &,
+                              const void *data,
+                              const unsigned int *dimensions,
+                              unsigned int brickZ,
+                              double *ranges)
+{
+  const TPixel *pixels = static_cast<const TPixel *>(data);
+  const unsigned int bricksX = GetNumberOfBricks(dimensions[0]);
+  const unsigned int bricksY = GetNumberOfBricks(dimensions[1]);
+
+  std::vector<TPixel> minimum(bricksX * bricksY, std::numeric_limits<TPixel>::max());
+  std::vector<TPixel> maximum(bricksX * bricksY, std::numeric_limits<TPixel>::lowest());
+  std::vector<bool> hasNaN(bricksX * bricksY, false);
+
+  const unsigned int endZ = std::min(dimensions[2], (brickZ + 1) * BRICK_SIZE);
+  for (unsigned int z = brickZ * BRICK_SIZE; z < endZ; ++z)
+  {
+    for (unsigned int y = 0; y < dimensions[1]; ++y)
+    {
+      const TPixel *row = pixels + (static_cast<size_t>(z) * dimensions[1] + y) * dimensions[0];
+      const unsigned int brickRow = (y / BRICK_SIZE) * bricksX;
+      for (unsigned int brickX = 0; brickX < bricksX; ++brickX)
+      {
+        TPixel &brickMinimum = minimum[brickRow + brickX];
+        TPixel &brickMaximum = maximum[brickRow + brickX];
+        bool brickHasNaN = false;
+        const unsigned int endX = std::min(dimensions[0], (brickX + 1) * BRICK_SIZE);
+        for (unsigned int x = brickX * BRICK_SIZE; x < endX; ++x)
+        {
+          if (row[x] < brickMinimum)
+            brickMinimum = row[x];
+          if (row[x] > brickMaximum)
+            brickMaximum = row[x];
+          // only true for NaN
+          if (row[x] != row[x])
+            brickHasNaN = true;
+        }
+        if (brickHasNaN)
+          hasNaN[brickRow + brickX] = true;
+      }
+    }
+  }
+
+  double *slabRanges = ranges + 2 * static_cast<size_t>(brickZ) * bricksX * bricksY;
+  for (size_t i = 0; i < minimum.size(); ++i)
+  {
+    slabRanges[2 * i] = static_cast<double>(minimum[i]);
+    slabRanges[2 * i + 1] =
+      hasNaN[i] ? std::numeric_limits<double>::quiet_NaN() : static_cast<double>(maximum[i]);
+  }
+}
+
+template <typename TPixel, typename TMaskPixel>
+static void ThresholdBricks(const TPixel *pixels,
+                            TMaskPixel *mask,
+                            const unsigned int *dimensions,
+                            const std::vector<double> &ranges,
+                            bool incremental,
+                            const double *thresholds)
+{
+  // compare like itk::BinaryThresholdImageFilter, which converts the thresholds to the pixel type
+  const double previousLower = static_cast<TPixel>(thresholds[0]);
+  const double previousUpper = static_cast<TPixel>(thresholds[1]);
+  const TPixel lower = static_cast<TPixel>(thresholds[2]);
+  const TPixel upper = static_cast<TPixel>(thresholds[3]);
+
+  const unsigned int bricks[3] = {
+    GetNumberOfBricks(dimensions[0]), GetNumberOfBricks(dimensions[1]), GetNumberOfBricks(dimensions[2])};
+
+  size_t brick = 0;
+  for (unsigned int brickZ = 0; brickZ < bricks[2]; ++brickZ)
+  {
+    for (unsigned int brickY = 0; brickY < bricks[1]; ++brickY)
+    {
+      for (unsigned int brickX = 0; brickX < bricks[0]; ++brickX, ++brick)
+      {
+        const double minimum = ranges[2 * brick];
+        const double maximum = ranges[2 * brick + 1];
+
+        // voxels can only change if their value lies between an old and the corresponding new threshold
+        if (incremental && !(previousLower != lower && Intersects(minimum, maximum, previousLower, lower)) &&
+            !(previousUpper != upper && Intersects(minimum, maximum, previousUpper, upper)))
+        {
+          continue;
+        }
+
+        // NaN voxels are never inside, like in itk::BinaryThresholdImageFilter. Bricks with NaN voxels have the
+        // maximum NaN, so both comparisons with it are false.
+        const bool allInside = minimum >= lower && maximum <= upper;
+        const bool allOutside = maximum < lower || minimum > upper;
+
+        const unsigned int endX = std::min(dimensions[0], (brickX + 1) * BRICK_SIZE);
+        const unsigned int endY = std::min(dimensions[1], (brickY + 1) * BRICK_SIZE);
+        const unsigned int endZ = std::min(dimensions[2], (brickZ + 1) * BRICK_SIZE);
+        for (unsigned int z = brickZ * BRICK_SIZE; z < endZ; ++z)
+        {
+          for (unsigned int y = brickY * BRICK_SIZE; y < endY; ++y)
+          {
+            const size_t row = (static_cast<size_t>(z) * dimensions[1] + y) * dimensions[0];
+            if (allInside || allOutside)
+            {
+              std::fill(mask + row + brickX * BRICK_SIZE, mask + row + endX, allInside ? 1 : 0);
+              continue;
+            }
+
+            for (unsigned int x = brickX * BRICK_SIZE; x < endX; ++x)
+            {
+              mask[row + x] = (lower <= pixels[row + x] && pixels[row + x] <= upper) ? 1 : 0;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+template <typename TPixel>
+static void ThresholdBricks(const mitk::PixelType &,
+                            const void *data,
+                            const mitk::Image *mask,
+                            void *maskData,
+                            const std::vector<double> &ranges,
+                            const ThresholdParameters &parameters)
+{
+  if (mask->GetPixelType().GetComponentType() == itk::ImageIOBase::UCHAR)
+  {
+    ThresholdBricks(static_cast<const TPixel *>(data),
+                    static_cast<unsigned char *>(maskData),
+                    parameters.Dimensions,
+                    ranges,
+                    parameters.Incremental,
+                    parameters.Thresholds);
+  }
+  else
+  {
+    ThresholdBricks(static_cast<const TPixel *>(data),
+                    static_cast<mitk::Label::PixelType *>(maskData),
+                    parameters.Dimensions,
+                    ranges,
+                    parameters.Incremental,
+                    parameters.Thresholds);
+  }
+}
+
+mitk::ImageThresholdIndex::ImageThresholdIndex()
+  : m_InputMTime(0), m_Abort(false), m_MultiThreader(itk::MultiThreader::New()), m_ThreadID(-1)
+{
+  m_Dimensions[0] = m_Dimensions[1] = m_Dimensions[2] = 0;
+}
+
+mitk::ImageThresholdIndex::~ImageThresholdIndex()
+{
+  this->StopIndexing();
+}
+
+void mitk::ImageThresholdIndex::SetInput(const Image *image)
+{
+  if (image == m_Input.GetPointer() && (image == nullptr || image->GetMTime() == m_InputMTime))
+  {
+    return;
+  }
+
+  this->StopIndexing();
+
+  m_Input = image;
+  m_InputMTime = 0;
+  m_Volumes.clear();
+  m_Ranges.clear();
+  this->Modified();
+
+  if (image == nullptr || !image->IsInitialized() ||
+      image->GetPixelType().GetPixelType() != itk::ImageIOBase::SCALAR || image->GetDimension() < 2)
+  {
+    return;
+  }
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    m_Dimensions[i] = image->GetDimension(i);
+  }
+  for (unsigned int timeStep = 0; timeStep < image->GetTimeSteps(); ++timeStep)
+  {
+    m_Volumes.push_back(image->GetVolumeData(timeStep));
+  }
+  m_Ranges.resize(m_Volumes.size());
+  m_InputMTime = image->GetMTime();
+
+  m_Abort = false;
+  m_ThreadID = m_MultiThreader->SpawnThread(this->IndexerThread, this);
+}
+
+const mitk::Image *mitk::ImageThresholdIndex::GetInput() const
+{
+  return m_Input;
+}
+
+bool mitk::ImageThresholdIndex::IsReady(unsigned int timeStep)
+{
+  if (m_Input.IsNull() || m_Input->GetMTime() != m_InputMTime)
+  {
+    return false;
+  }
+
+  itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+  return timeStep < m_Ranges.size() && !m_Ranges[timeStep].empty();
+}
+
+bool mitk::ImageThresholdIndex::ThresholdMask(Image *mask, unsigned int timeStep, double lower, double upper)
+{
+  const double thresholds[4] = {lower, upper, lower, upper};
+  return this->Threshold(mask, timeStep, false, thresholds);
+}
+
+bool mitk::ImageThresholdIndex::UpdateMask(Image *mask,
+                                           unsigned int timeStep,
+                                           double previousLower,
+                                           double previousUpper,
+                                           double lower,
+                                           double upper)
+{
+  const double thresholds[4] = {previousLower, previousUpper, lower, upper};
+  return this->Threshold(mask, timeStep, true, thresholds);
+}
+
+bool mitk::ImageThresholdIndex::Threshold(Image *mask, unsigned int timeStep, bool incremental, const double *thresholds)
+{
+  if (mask == nullptr || !mask->IsInitialized() || timeStep >= mask->GetTimeSteps() ||
+      !this->IsReady(timeStep))
+  {
+    return false;
+  }
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    if (mask->GetDimension(i) != m_Dimensions[i])
+    {
+      return false;
+    }
+  }
+
+  const PixelType maskPixelType = mask->GetPixelType();
+  if (maskPixelType.GetPixelType() != itk::ImageIOBase::SCALAR ||
+      (maskPixelType.GetComponentType() != itk::ImageIOBase::UCHAR &&
+       maskPixelType.GetComponentType() != MapPixelComponentType<Label::PixelType>::value))
+  {
+    return false;
+  }
+
+  // the indexer never touches the ranges of a time step once they are set
+  const RangesType &ranges = m_Ranges[timeStep];
+  {
+    ImageReadAccessor inputAccess(m_Input, m_Volumes[timeStep]);
+    ImageWriteAccessor maskAccess(mask, mask->GetVolumeData(timeStep));
+
+    ThresholdParameters parameters = {m_Dimensions, incremental, thresholds};
+    mitkPixelTypeMultiplex5(ThresholdBricks,
+                            m_Input->GetPixelType(),
+                            inputAccess.GetData(),
+                            mask,
+                            maskAccess.GetData(),
+                            ranges,
+                            parameters);
+  }
+  mask->Modified();
+
+  return true;
+}
+
+void mitk::ImageThresholdIndex::StopIndexing()
+{
+  if (m_ThreadID >= 0)
+  {
+    m_Mutex.Lock();
+    m_Abort = true;
+    m_Mutex.Unlock();
+
+    m_MultiThreader->TerminateThread(m_ThreadID);
+    m_ThreadID = -1;
+  }
+}
+
+ITK_THREAD_RETURN_TYPE mitk::ImageThresholdIndex::IndexerThread(void *pInfoStruct)
+{
+  /* extract this pointer from Thread Info structure */
+  struct itk::MultiThreader::ThreadInfoStruct *pInfo = (struct itk::MultiThreader::ThreadInfoStruct *)pInfoStruct;
+  if (pInfo == nullptr || pInfo->UserData == nullptr)
+  {
+    return ITK_THREAD_RETURN_VALUE;
+  }
+  ImageThresholdIndex *index = static_cast<ImageThresholdIndex *>(pInfo->UserData);
+
+  try
+  {
+    index->ComputeRanges();
+  }
+  catch (const mitk::Exception &e)
+  {
+    MITK_ERROR << "Could not index image for thresholding: " << e.GetDescription();
+  }
+
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+void mitk::ImageThresholdIndex::ComputeRanges()
+{
+  const unsigned int bricksZ = GetNumberOfBricks(m_Dimensions[2]);
+  const size_t numberOfBricks =
+    static_cast<size_t>(GetNumberOfBricks(m_Dimensions[0])) * GetNumberOfBricks(m_Dimensions[1]) * bricksZ;
+
+  for (size_t timeStep = 0; timeStep < m_Volumes.size(); ++timeStep)
+  {
+    RangesType ranges(2 * numberOfBricks);
+    {
+      ImageReadAccessor access(m_Input, m_Volumes[timeStep]);
+      for (unsigned int brickZ = 0; brickZ < bricksZ; ++brickZ)
+      {
+        {
+          itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+          if (m_Abort)
+          {
+            return;
+          }
+        }
+
+        mitkPixelTypeMultiplex4(
+          ComputeSlabRanges, m_Input->GetPixelType(), access.GetData(), m_Dimensions, brickZ, &ranges[0]);
+      }
+    }
+
+    itk::MutexLockHolder<itk::SimpleMutexLock> lock(m_Mutex);
+    m_Ranges[timeStep].swap(ranges);
+  }
+}
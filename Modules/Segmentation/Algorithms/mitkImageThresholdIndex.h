@@ -0,0 +1,117 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkImageThresholdIndex_h_Included
+#define mitkImageThresholdIndex_h_Included
+
+#include <MitkSegmentationExports.h>
+
+#include <mitkImage.h>
+
+#include <itkMultiThreader.h>
+#include <itkMutexLock.h>
+
+#include <vector>
+
+namespace mitk
+{
+  /**
+    \brief Gray value range of every brick of 8x8x8 voxels of an image, used to rethreshold only those parts of a
+    binary mask that change when the thresholds are moved.
+
+    When the interval [lower, upper] replaces [previousLower, previousUpper], a voxel can only change its membership
+    if its value lies between the old and the new lower or between the old and the new upper threshold. UpdateMask()
+    skips all bricks whose value range does not touch these intervals and fills bricks that are completely inside or
+    outside of the new interval without comparing single voxels.
+
+    The ranges of all time steps are computed by a background thread that is started by SetInput(). Until the index of
+    a time step is ready (or if the input was modified since), ThresholdMask() and UpdateMask() return false and the
+    caller has to threshold the volume on its own.
+
+    Voxels are compared like itk::BinaryThresholdImageFilter does, i.e. the thresholds are converted to the pixel type
+    of the input first. Masks must have the size of the input and the pixel type unsigned char or
+    mitk::Label::PixelType.
+
+    \ingroup ToolManagerEtAl
+  */
+  class MITKSEGMENTATION_EXPORT ImageThresholdIndex : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(ImageThresholdIndex, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    /**
+      \brief Sets the image to be thresholded and starts indexing its time steps in the background.
+
+      Setting the current input again does nothing unless the image was modified meanwhile.
+    */
+    void SetInput(const Image *image);
+    const Image *GetInput() const;
+
+    /** \brief Returns true if the index of the time step can be used. */
+    bool IsReady(unsigned int timeStep);
+
+    /** \brief Sets the time step of mask to 1 where lower <= value <= upper and to 0 elsewhere. */
+    bool ThresholdMask(Image *mask, unsigned int timeStep, double lower, double upper);
+
+    /**
+      \brief Like ThresholdMask(), but expects that mask holds the result of thresholding with the previous interval
+      and only touches bricks whose voxels may be affected by the change.
+    */
+    bool UpdateMask(Image *mask,
+                    unsigned int timeStep,
+                    double previousLower,
+                    double previousUpper,
+                    double lower,
+                    double upper);
+
+    /** \brief Number of voxels per brick edge */
+    static const unsigned int BrickSize = 8;
+
+  protected:
+    ImageThresholdIndex();
+    virtual ~ImageThresholdIndex();
+
+  private:
+    /** Minimum and maximum of every brick, x fastest. The maximum is NaN for bricks with NaN voxels. */
+    typedef std::vector<double> RangesType;
+
+    static ITK_THREAD_RETURN_TYPE IndexerThread(void *pInfoStruct);
+
+    /** Computes the ranges of all time steps until m_Abort is set */
+    void ComputeRanges();
+
+    bool Threshold(Image *mask, unsigned int timeStep, bool incremental, const double *thresholds);
+
+    void StopIndexing();
+
+    Image::ConstPointer m_Input;
+    unsigned long m_InputMTime;
+    /** Volumes of all time steps, requested by SetInput() so that the indexer does not modify the input */
+    std::vector<Image::ImageDataItemPointer> m_Volumes;
+    unsigned int m_Dimensions[3];
+
+    itk::SimpleMutexLock m_Mutex;
+    /** Ranges of each time step, empty until the time step is indexed */
+    std::vector<RangesType> m_Ranges;
+    bool m_Abort;
+
+    itk::MultiThreader::Pointer m_MultiThreader;
+    int m_ThreadID;
+  };
+}
+
+#endif
@@ -0,0 +1,245 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkIncrementalRegionGrower.h"
+
+#include "mitkImageReadAccessor.h"
+#include "mitkPixelTypeMultiplex.h"
+
+#include <algorithm>
+#include <limits>
+
+template <typename TPixel>
+static void CopyValues(const mitk::PixelType &, const void *data, size_t numberOfPixels, std::vector<double> *values)
+{
+  const TPixel *pixels = static_cast<const TPixel *>(data);
+  values->assign(pixels, pixels + numberOfPixels);
+}
+
+template <typename TPixel>
+static double ConvertTo(double value)
+{
+  return static_cast<double>(static_cast<TPixel>(value));
+}
+
+mitk::IncrementalRegionGrower::IncrementalRegionGrower()
+  : m_ComponentType(itk::ImageIOBase::UNKNOWNCOMPONENTTYPE),
+    m_Valid(false),
+    m_Lower(0),
+    m_Upper(0),
+    m_NumberOfVisitedPixels(0)
+{
+  m_Dimensions[0] = m_Dimensions[1] = m_Dimensions[2] = 0;
+  m_Seed.Fill(0);
+  m_BoundingBoxMinimum.Fill(0);
+  m_BoundingBoxMaximum.Fill(-1);
+}
+
+mitk::IncrementalRegionGrower::~IncrementalRegionGrower()
+{
+}
+
+void mitk::IncrementalRegionGrower::SetInput(const Image *image)
+{
+  if (image == nullptr || !image->IsInitialized() ||
+      image->GetPixelType().GetPixelType() != itk::ImageIOBase::SCALAR)
+  {
+    mitkThrow() << "Region growing needs a scalar image";
+  }
+
+  size_t numberOfPixels = 1;
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    m_Dimensions[i] = image->GetDimension(i);
+    numberOfPixels *= m_Dimensions[i];
+  }
+
+  ImageReadAccessor access(image, image->GetVolumeData(0));
+  mitkPixelTypeMultiplex3(CopyValues, image->GetPixelType(), access.GetData(), numberOfPixels, &m_Values);
+  m_ComponentType = image->GetPixelType().GetComponentType();
+
+  m_Region.assign(numberOfPixels, 0);
+  m_Valid = false;
+  this->Modified();
+}
+
+void mitk::IncrementalRegionGrower::SetSeed(const itk::Index<3> &seed)
+{
+  if (seed != m_Seed)
+  {
+    m_Seed = seed;
+    m_Valid = false;
+    this->Modified();
+  }
+}
+
+double mitk::IncrementalRegionGrower::ConvertThreshold(double threshold) const
+{
+  switch (m_ComponentType)
+  {
+    case itk::ImageIOBase::CHAR:
+      return ConvertTo<char>(threshold);
+    case itk::ImageIOBase::UCHAR:
+      return ConvertTo<unsigned char>(threshold);
+    case itk::ImageIOBase::SHORT:
+      return ConvertTo<short>(threshold);
+    case itk::ImageIOBase::USHORT:
+      return ConvertTo<unsigned short>(threshold);
+    case itk::ImageIOBase::INT:
+      return ConvertTo<int>(threshold);
+    case itk::ImageIOBase::UINT:
+      return ConvertTo<unsigned int>(threshold);
+    case itk::ImageIOBase::LONG:
+      return ConvertTo<long>(threshold);
+    case itk::ImageIOBase::ULONG:
+      return ConvertTo<unsigned long>(threshold);
+    case itk::ImageIOBase::FLOAT:
+      return ConvertTo<float>(threshold);
+    default:
+      return threshold;
+  }
+}
+
+void mitk::IncrementalRegionGrower::Reset()
+{
+  std::fill(m_Region.begin(), m_Region.end(), 0);
+  m_FrontBelow = std::priority_queue<FrontPixel>();
+  m_FrontAbove = std::priority_queue<FrontPixel, std::vector<FrontPixel>, std::greater<FrontPixel>>();
+  m_BoundingBoxMinimum.Fill(std::numeric_limits<itk::IndexValueType>::max());
+  m_BoundingBoxMaximum.Fill(-1);
+}
+
+void mitk::IncrementalRegionGrower::Join(size_t offset)
+{
+  m_Region[offset] = 1;
+
+  const itk::IndexValueType position[3] = {
+    static_cast<itk::IndexValueType>(offset % m_Dimensions[0]),
+    static_cast<itk::IndexValueType>((offset / m_Dimensions[0]) % m_Dimensions[1]),
+    static_cast<itk::IndexValueType>(offset / (static_cast<size_t>(m_Dimensions[0]) * m_Dimensions[1]))};
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    m_BoundingBoxMinimum[i] = std::min(m_BoundingBoxMinimum[i], position[i]);
+    m_BoundingBoxMaximum[i] = std::max(m_BoundingBoxMaximum[i], position[i]);
+  }
+}
+
+void mitk::IncrementalRegionGrower::Visit(size_t offset, std::vector<size_t> &joining)
+{
+  if (m_Region[offset] != 0)
+  {
+    return;
+  }
+  ++m_NumberOfVisitedPixels;
+
+  const double value = m_Values[offset];
+  if (m_Lower <= value && value <= m_Upper)
+  {
+    this->Join(offset);
+    joining.push_back(offset);
+    return;
+  }
+
+  // NaN is rejected forever
+  m_Region[offset] = 2;
+  if (value < m_Lower)
+  {
+    m_FrontBelow.push(FrontPixel(value, offset));
+  }
+  else if (value > m_Upper)
+  {
+    m_FrontAbove.push(FrontPixel(value, offset));
+  }
+}
+
+void mitk::IncrementalRegionGrower::Update(double lower, double upper)
+{
+  lower = this->ConvertThreshold(lower);
+  upper = this->ConvertThreshold(upper);
+  m_NumberOfVisitedPixels = 0;
+
+  std::vector<size_t> joining;
+
+  if (!m_Valid || lower > m_Lower || upper < m_Upper)
+  {
+    this->Reset();
+    m_Lower = lower;
+    m_Upper = upper;
+    m_Valid = true;
+
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      if (m_Seed[i] < 0 || m_Seed[i] >= static_cast<itk::IndexValueType>(m_Dimensions[i]))
+      {
+        return;
+      }
+    }
+    this->Visit(m_Seed[0] + m_Dimensions[0] * (m_Seed[1] + static_cast<size_t>(m_Dimensions[1]) * m_Seed[2]), joining);
+  }
+  else
+  {
+    m_Lower = lower;
+    m_Upper = upper;
+  }
+
+  // rejected pixels that are inside of the widened interval
+  while (!m_FrontBelow.empty() && m_FrontBelow.top().first >= m_Lower)
+  {
+    ++m_NumberOfVisitedPixels;
+    this->Join(m_FrontBelow.top().second);
+    joining.push_back(m_FrontBelow.top().second);
+    m_FrontBelow.pop();
+  }
+  while (!m_FrontAbove.empty() && m_FrontAbove.top().first <= m_Upper)
+  {
+    ++m_NumberOfVisitedPixels;
+    this->Join(m_FrontAbove.top().second);
+    joining.push_back(m_FrontAbove.top().second);
+    m_FrontAbove.pop();
+  }
+
+  const size_t strides[3] = {1, m_Dimensions[0], static_cast<size_t>(m_Dimensions[0]) * m_Dimensions[1]};
+  while (!joining.empty())
+  {
+    const size_t offset = joining.back();
+    joining.pop_back();
+
+    for (unsigned int i = 0; i < 3; ++i)
+    {
+      const size_t position = (offset / strides[i]) % m_Dimensions[i];
+      if (position > 0)
+      {
+        this->Visit(offset - strides[i], joining);
+      }
+      if (position + 1 < m_Dimensions[i])
+      {
+        this->Visit(offset + strides[i], joining);
+      }
+    }
+  }
+}
+
+bool mitk::IncrementalRegionGrower::GetBoundingBox(itk::Index<3> &minimum, itk::Index<3> &maximum) const
+{
+  if (!m_Valid || m_BoundingBoxMaximum[0] < m_BoundingBoxMinimum[0])
+  {
+    return false;
+  }
+
+  minimum = m_BoundingBoxMinimum;
+  maximum = m_BoundingBoxMaximum;
+  return true;
+}
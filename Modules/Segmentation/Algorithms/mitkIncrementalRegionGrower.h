@@ -0,0 +1,104 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkIncrementalRegionGrower_h_Included
+#define mitkIncrementalRegionGrower_h_Included
+
+#include <MitkSegmentationExports.h>
+
+#include <mitkImage.h>
+
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace mitk
+{
+  /**
+    \brief Seeded region growing with an interval of gray values that can be changed interactively.
+
+    Computes the same region as itk::ConnectedThresholdImageFilter with face connectivity: all pixels with
+    lower <= value <= upper that are connected to the seed. Besides the region, the grower keeps the pixels at its
+    border that were rejected, sorted by their value. When the interval is widened, only the border pixels that now
+    fall into the interval are visited, and the region grows from there. Narrowing the interval or moving the seed
+    restarts the growing.
+
+    Images with up to three dimensions are supported. The thresholds are converted to the pixel type of the input
+    before comparing, like itk::ConnectedThresholdImageFilter does.
+
+    \ingroup ToolManagerEtAl
+  */
+  class MITKSEGMENTATION_EXPORT IncrementalRegionGrower : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(IncrementalRegionGrower, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    /** \brief Copies the gray values of the first time step of image, throws mitk::Exception for non-scalar images */
+    void SetInput(const Image *image);
+
+    void SetSeed(const itk::Index<3> &seed);
+    const itk::Index<3> &GetSeed() const { return m_Seed; }
+
+    /** \brief Computes the region for the interval [lower, upper], reusing the previous region if possible. */
+    void Update(double lower, double upper);
+
+    /** \brief Returns 1 for pixels of the region, 2 for rejected pixels at its border and 0 elsewhere, x fastest. */
+    const std::vector<unsigned char> &GetRegion() const { return m_Region; }
+
+    /** \brief Returns false if the region is empty, i.e. if the seed is outside of the interval. */
+    bool GetBoundingBox(itk::Index<3> &minimum, itk::Index<3> &maximum) const;
+
+    /** \brief Number of pixels visited by the last call of Update(), for testing. */
+    size_t GetNumberOfVisitedPixels() const { return m_NumberOfVisitedPixels; }
+
+  protected:
+    IncrementalRegionGrower();
+    virtual ~IncrementalRegionGrower();
+
+  private:
+    typedef std::pair<double, size_t> FrontPixel;
+
+    void Reset();
+    double ConvertThreshold(double threshold) const;
+
+    /** Adds the pixel to the region, to a front or (for NaN values) nowhere */
+    void Visit(size_t offset, std::vector<size_t> &joining);
+    void Join(size_t offset);
+
+    std::vector<double> m_Values;
+    unsigned int m_Dimensions[3];
+    int m_ComponentType;
+    itk::Index<3> m_Seed;
+
+    std::vector<unsigned char> m_Region;
+    bool m_Valid;
+    double m_Lower;
+    double m_Upper;
+
+    /** Rejected neighbours of the region below the lower threshold, highest value first */
+    std::priority_queue<FrontPixel> m_FrontBelow;
+    /** Rejected neighbours of the region above the upper threshold, lowest value first */
+    std::priority_queue<FrontPixel, std::vector<FrontPixel>, std::greater<FrontPixel>> m_FrontAbove;
+
+    itk::Index<3> m_BoundingBoxMinimum;
+    itk::Index<3> m_BoundingBoxMaximum;
+    size_t m_NumberOfVisitedPixels;
+  };
+}
+
+#endif
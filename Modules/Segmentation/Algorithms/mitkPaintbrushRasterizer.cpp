@@ -0,0 +1,325 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkPaintbrushRasterizer.h"
+
+#include "mitkExceptionMacro.h"
+#include "mitkImageWriteAccessor.h"
+#include "mitkLabelSetImage.h"
+#include "mitkPixelTypeMultiplex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+  /** Tolerance for pixel centers on the border of a stroke, in pixels */
+  const double BORDER_TOLERANCE = 1e-6;
+
+  struct PaintRules
+  {
+    double PaintingPixelValue;
+    bool IsLabelSetImage;
+    bool Erase;
+    double ActivePixelValue;
+    /** Locked labels of the active layer, indexed by label value */
+    std::vector<bool> Locked;
+
+    bool IsLocked(double pixelValue) const
+    {
+      return pixelValue >= 0 && pixelValue < Locked.size() && Locked[static_cast<size_t>(pixelValue)];
+    }
+  };
+
+  /** Restricts [lower, upper] to the values of u that satisfy minimum <= a * u + b <= maximum */
+  void ClipLinear(double a, double b, double minimum, double maximum, double &lower, double &upper)
+  {
+    if (a == 0)
+    {
+      if (b < minimum || b > maximum)
+      {
+        lower = std::numeric_limits<double>::infinity();
+        upper = -std::numeric_limits<double>::infinity();
+      }
+      return;
+    }
+
+    double first = (minimum - b) / a;
+    double second = (maximum - b) / a;
+    if (a < 0)
+    {
+      std::swap(first, second);
+    }
+    lower = std::max(lower, first);
+    upper = std::min(upper, second);
+  }
+}
+
+template <typename TPixel>
+static void PaintSpans(const mitk::PixelType &,
+                       void *data,
+                       int width,
+                       const std::vector<mitk::PaintbrushRasterizer::Span> &spans,
+                       const PaintRules &rules)
+{
+  const TPixel paintingPixelValue = static_cast<TPixel>(rules.PaintingPixelValue);
+  for (const auto &span : spans)
+  {
+    TPixel *pixel = static_cast<TPixel *>(data) + static_cast<size_t>(span.Y) * width + span.X0;
+    TPixel *end = pixel + (span.X1 - span.X0 + 1);
+
+    // if image is not a LabelSetImage just paint or erase
+    if (!rules.IsLabelSetImage)
+    {
+      std::fill(pixel, end, paintingPixelValue);
+    }
+    // paint, but do not overwrite locked pixels
+    else if (!rules.Erase)
+    {
+      for (; pixel != end; ++pixel)
+      {
+        if (!rules.IsLocked(*pixel))
+          *pixel = paintingPixelValue;
+      }
+    }
+    // erase, but only active label (regardless of locked state)
+    else
+    {
+      for (; pixel != end; ++pixel)
+      {
+        if (*pixel == rules.ActivePixelValue)
+          *pixel = paintingPixelValue;
+      }
+    }
+  }
+}
+
+mitk::PaintbrushRasterizer::Region::Region()
+{
+  Minimum[0] = Minimum[1] = 0;
+  Maximum[0] = Maximum[1] = -1;
+}
+
+bool mitk::PaintbrushRasterizer::Region::IsEmpty() const
+{
+  return Minimum[0] > Maximum[0] || Minimum[1] > Maximum[1];
+}
+
+void mitk::PaintbrushRasterizer::Region::Include(const Region &other)
+{
+  if (other.IsEmpty())
+    return;
+
+  if (this->IsEmpty())
+  {
+    *this = other;
+    return;
+  }
+
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    Minimum[i] = std::min(Minimum[i], other.Minimum[i]);
+    Maximum[i] = std::max(Maximum[i], other.Maximum[i]);
+  }
+}
+
+mitk::PaintbrushRasterizer::PaintbrushRasterizer() : m_Size(1)
+{
+}
+
+mitk::PaintbrushRasterizer::~PaintbrushRasterizer()
+{
+}
+
+void mitk::PaintbrushRasterizer::SetSize(int size)
+{
+  if (size != m_Size)
+  {
+    m_Size = size;
+    this->Modified();
+  }
+}
+
+const std::vector<mitk::PaintbrushRasterizer::Span> &mitk::PaintbrushRasterizer::GetStamp()
+{
+  auto cached = m_Stamps.find(m_Size);
+  if (cached != m_Stamps.end())
+    return cached->second;
+
+  std::vector<Span> &stamp = m_Stamps[m_Size];
+
+  // In half pixels the brush center and the radius are integers and the comparison is exact:
+  // (2 * dx - center)^2 + (2 * dy - center)^2 <= size^2
+  const int center = (m_Size % 2 == 0) ? 1 : 0;
+  const int extent = std::max(m_Size, 0) / 2 + 1;
+  for (int dy = -extent; dy <= extent; ++dy)
+  {
+    Span span = {dy, std::numeric_limits<int>::max(), std::numeric_limits<int>::min()};
+    const int y = 2 * dy - center;
+    for (int dx = -extent; dx <= extent; ++dx)
+    {
+      const int x = 2 * dx - center;
+      if (x * x + y * y <= m_Size * m_Size)
+      {
+        span.X0 = std::min(span.X0, dx);
+        span.X1 = std::max(span.X1, dx);
+      }
+    }
+    if (span.X0 <= span.X1)
+      stamp.push_back(span);
+  }
+
+  return stamp;
+}
+
+void mitk::PaintbrushRasterizer::RasterizeStroke(const int from[2], const int to[2], std::vector<Span> &spans)
+{
+  spans.clear();
+
+  const std::vector<Span> &stamp = this->GetStamp();
+  if (stamp.empty())
+    return;
+
+  const int top = std::min(from[1], to[1]) + stamp.front().Y;
+  const int bottom = std::max(from[1], to[1]) + stamp.back().Y;
+  spans.reserve(bottom - top + 1);
+
+  // The stroke is the union of the brushes at both ends and the rectangle between the brush centers. It is convex,
+  // so each row of it is a single span.
+  const double center = (m_Size % 2 == 0) ? 0.5 : 0.0;
+  const double radius = 0.5 * m_Size;
+  const double direction[2] = {static_cast<double>(to[0] - from[0]), static_cast<double>(to[1] - from[1])};
+  const double lengthSquared = direction[0] * direction[0] + direction[1] * direction[1];
+  const double length = std::sqrt(lengthSquared);
+
+  for (int y = top; y <= bottom; ++y)
+  {
+    Span span = {y, std::numeric_limits<int>::max(), std::numeric_limits<int>::min()};
+
+    const int *ends[2] = {from, to};
+    for (const int *end : ends)
+    {
+      const int dy = y - end[1];
+      if (dy >= stamp.front().Y && dy <= stamp.back().Y)
+      {
+        const Span &row = stamp[dy - stamp.front().Y];
+        span.X0 = std::min(span.X0, end[0] + row.X0);
+        span.X1 = std::max(span.X1, end[0] + row.X1);
+      }
+    }
+
+    if (lengthSquared > 0)
+    {
+      // u is the x offset of a pixel center to the brush center at from
+      const double startX = from[0] + center;
+      const double offsetY = y - (from[1] + center);
+      double lower = -std::numeric_limits<double>::infinity();
+      double upper = std::numeric_limits<double>::infinity();
+
+      // between the brush centers: 0 <= offset * direction <= length^2
+      ClipLinear(direction[0], direction[1] * offsetY, 0.0, lengthSquared, lower, upper);
+      // within the radius of the line: |offset * normal| <= radius with normal = (-direction[1], direction[0])/length
+      ClipLinear(-direction[1], direction[0] * offsetY, -radius * length, radius * length, lower, upper);
+
+      if (lower <= upper)
+      {
+        const double x0 = std::ceil(startX + lower - BORDER_TOLERANCE);
+        const double x1 = std::floor(startX + upper + BORDER_TOLERANCE);
+        if (x0 <= x1)
+        {
+          span.X0 = std::min(span.X0, static_cast<int>(x0));
+          span.X1 = std::max(span.X1, static_cast<int>(x1));
+        }
+      }
+    }
+
+    if (span.X0 <= span.X1)
+      spans.push_back(span);
+  }
+}
+
+mitk::PaintbrushRasterizer::Region mitk::PaintbrushRasterizer::PaintStroke(
+  Image *slice, Image *workingImage, const int from[2], const int to[2], int paintingPixelValue)
+{
+  Region region;
+  if (slice == nullptr || !slice->IsInitialized())
+    return region;
+
+  if (slice->GetPixelType().GetPixelType() != itk::ImageIOBase::SCALAR)
+  {
+    mitkThrow() << "PaintbrushRasterizer only supports scalar slices.";
+  }
+
+  this->RasterizeStroke(from, to, m_Spans);
+
+  // only the part of the stroke within the slice is painted
+  const int width = static_cast<int>(slice->GetDimension(0));
+  const int height = static_cast<int>(slice->GetDimension(1));
+  auto clipped = m_Spans.begin();
+  for (const auto &span : m_Spans)
+  {
+    if (span.Y < 0 || span.Y >= height || span.X1 < 0 || span.X0 >= width)
+      continue;
+
+    Span inside = {span.Y, std::max(span.X0, 0), std::min(span.X1, width - 1)};
+    Region row;
+    row.Minimum[0] = inside.X0;
+    row.Maximum[0] = inside.X1;
+    row.Minimum[1] = row.Maximum[1] = inside.Y;
+    region.Include(row);
+    *clipped++ = inside;
+  }
+  m_Spans.erase(clipped, m_Spans.end());
+
+  if (region.IsEmpty())
+    return region;
+
+  PaintRules rules;
+  rules.PaintingPixelValue = paintingPixelValue;
+  rules.IsLabelSetImage = false;
+  rules.Erase = false;
+  rules.ActivePixelValue = 0;
+
+  LabelSetImage *labelImage = dynamic_cast<LabelSetImage *>(workingImage);
+  if (labelImage)
+  {
+    const unsigned int activeLayer = labelImage->GetActiveLayer();
+    rules.IsLabelSetImage = true;
+    rules.Erase = paintingPixelValue == labelImage->GetExteriorLabel()->GetValue();
+    rules.ActivePixelValue = labelImage->GetActiveLabel(activeLayer)->GetValue();
+
+    const LabelSet *labelSet = labelImage->GetLabelSet(activeLayer);
+    for (auto label = labelSet->IteratorConstBegin(); label != labelSet->IteratorConstEnd(); ++label)
+    {
+      if (label->second->GetLocked())
+      {
+        if (label->first >= rules.Locked.size())
+          rules.Locked.resize(label->first + 1, false);
+        rules.Locked[label->first] = true;
+      }
+    }
+  }
+
+  {
+    ImageWriteAccessor access(slice, slice->GetVolumeData(0));
+    mitkPixelTypeMultiplex4(PaintSpans, slice->GetPixelType(), access.GetData(), width, m_Spans, rules);
+  }
+  slice->GetVolumeData(0)->Modified();
+  slice->Modified();
+
+  return region;
+}
@@ -0,0 +1,104 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkPaintbrushRasterizer_h_Included
+#define mitkPaintbrushRasterizer_h_Included
+
+#include <MitkSegmentationExports.h>
+
+#include <mitkImage.h>
+
+#include <map>
+#include <vector>
+
+namespace mitk
+{
+  /**
+    \brief Paints circular brushes and the strokes between them into a 2D slice by scanlines.
+
+    Used by mitk::PaintbrushTool. The pixels covered by a brush of a given size are computed once and kept as
+    scanline spans (the brush stamp). A stroke from one brush position to the next covers the capsule around the
+    line between both positions, i.e. all pixels whose center is within the brush radius of that line, so fast mouse
+    movements leave no gaps. Only the pixels of the stroke are read and written, which makes the costs independent of
+    the slice size.
+
+    Brush positions are pixel indices of the slice. Like the contour shown by mitk::PaintbrushTool, the brush is
+    centered on the pixel for odd sizes and on the lower right corner of the pixel for even sizes. A pixel belongs to
+    the brush if its center is not further away from the brush center than half of the size.
+
+    Painting follows the rules of mitk::ContourModelUtils::FillSliceInSlice(): for an mitk::LabelSetImage, locked
+    labels are not painted over and erasing (painting the exterior label) only removes the active label.
+
+    \ingroup ToolManagerEtAl
+  */
+  class MITKSEGMENTATION_EXPORT PaintbrushRasterizer : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(PaintbrushRasterizer, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    /** \brief Pixels [X0, X1] of row Y */
+    struct Span
+    {
+      int Y;
+      int X0;
+      int X1;
+    };
+
+    /** \brief Bounding box [Minimum, Maximum] of the written pixels, empty if Minimum is greater than Maximum */
+    struct Region
+    {
+      Region();
+
+      bool IsEmpty() const;
+      void Include(const Region &other);
+
+      int Minimum[2];
+      int Maximum[2];
+    };
+
+    /** \brief Diameter of the brush in pixels, see mitk::PaintbrushTool::SetSize() */
+    void SetSize(int size);
+    int GetSize() const { return m_Size; }
+
+    /** \brief Spans of the brush relative to the brush position, one per row and sorted by row */
+    const std::vector<Span> &GetStamp();
+
+    /** \brief Computes the spans of the stroke between two brush positions, one per row and sorted by row. */
+    void RasterizeStroke(const int from[2], const int to[2], std::vector<Span> &spans);
+
+    /**
+      \brief Paints the stroke between two brush positions into the first volume of the 2D slice.
+
+      workingImage is the image the slice was extracted from, it decides about the label rules. Returns the region of
+      the slice covered by the stroke, the slice is only modified if this region is not empty.
+      Throws mitk::Exception if the slice is not a scalar image.
+    */
+    Region PaintStroke(Image *slice, Image *workingImage, const int from[2], const int to[2], int paintingPixelValue);
+
+  protected:
+    PaintbrushRasterizer();
+    virtual ~PaintbrushRasterizer();
+
+  private:
+    int m_Size;
+    /** Stamps of all sizes used so far */
+    std::map<int, std::vector<Span>> m_Stamps;
+    std::vector<Span> m_Spans;
+  };
+}
+
+#endif
@@ -52,7 +52,9 @@ mitk::BinaryThresholdTool::BinaryThresholdTool()
   : m_SensibleMinimumThresholdValue(-100),
     m_SensibleMaximumThresholdValue(+100),
     m_CurrentThresholdValue(0.0),
-    m_IsFloatImage(false)
+    m_IsFloatImage(false),
+    m_ThresholdIndex(ImageThresholdIndex::New()),
+    m_PreviewIsValid(false)
 {
   m_ThresholdFeedbackNode = DataNode::New();
   m_ThresholdFeedbackNode->SetProperty("color", ColorProperty::New(0.0, 1.0, 0.0));
@@ -95,6 +97,8 @@ void mitk::BinaryThresholdTool::Activated()
 
   if (m_NodeForThresholding.IsNotNull())
   {
+    // index the gray values while the user looks at the first preview
+    m_ThresholdIndex->SetInput(dynamic_cast<Image *>(m_OriginalImageNode->GetData()));
     SetupPreviewNode();
   }
   else
@@ -109,6 +113,7 @@ void mitk::BinaryThresholdTool::Deactivated()
     mitk::MessageDelegate<mitk::BinaryThresholdTool>(this, &mitk::BinaryThresholdTool::OnRoiDataChanged);
   m_NodeForThresholding = NULL;
   m_OriginalImageNode = NULL;
+  m_ThresholdIndex->SetInput(nullptr);
   try
   {
     if (DataStorage *storage = m_ToolManager->GetDataStorage())
@@ -166,6 +171,8 @@ void mitk::BinaryThresholdTool::SetupPreviewNode()
   pixel[1] = 1.0f;
   pixel[2] = 0.0f;
 
+  m_PreviewIsValid = false;
+
   if (m_NodeForThresholding.IsNotNull())
   {
     Image::Pointer image = dynamic_cast<Image *>(m_NodeForThresholding->GetData());
@@ -390,8 +397,17 @@ void mitk::BinaryThresholdTool::UpdatePreview()
   mitk::Image::Pointer previewImage = dynamic_cast<mitk::Image *>(m_ThresholdFeedbackNode->GetData());
   if (thresholdImage && previewImage)
   {
+    const bool previewWasValid = m_PreviewIsValid;
+    m_PreviewIsValid = false;
+
     for (unsigned int timeStep = 0; timeStep < thresholdImage->GetTimeSteps(); ++timeStep)
     {
+      if (this->UpdatePreviewWithIndex(
+            previewImage, timeStep, previewWasValid, m_CurrentThresholdValue, m_SensibleMaximumThresholdValue))
+      {
+        continue;
+      }
+
       ImageTimeSelector::Pointer timeSelector = ImageTimeSelector::New();
       timeSelector->SetInput(thresholdImage);
       timeSelector->SetTimeNr(timeStep);
@@ -408,6 +424,27 @@ void mitk::BinaryThresholdTool::UpdatePreview()
       }
     }
 
+    m_PreviewIsValid = true;
+    m_PreviewThresholds[0] = m_CurrentThresholdValue;
+    m_PreviewThresholds[1] = m_SensibleMaximumThresholdValue;
+
     RenderingManager::GetInstance()->RequestUpdateAll();
   }
 }
+
+bool mitk::BinaryThresholdTool::UpdatePreviewWithIndex(
+  Image *previewImage, unsigned int timeStep, bool previewWasValid, double lower, double upper)
+{
+  // the index covers the original image, not a region of interest cut out of it
+  if (m_NodeForThresholding != m_OriginalImageNode || m_ThresholdIndex->GetInput() != m_NodeForThresholding->GetData())
+  {
+    return false;
+  }
+
+  if (previewWasValid)
+  {
+    return m_ThresholdIndex->UpdateMask(
+      previewImage, timeStep, m_PreviewThresholds[0], m_PreviewThresholds[1], lower, upper);
+  }
+  return m_ThresholdIndex->ThresholdMask(previewImage, timeStep, lower, upper);
+}
@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkAutoSegmentationTool.h"
 #include "mitkCommon.h"
 #include "mitkDataNode.h"
+#include "mitkImageThresholdIndex.h"
 #include <MitkSegmentationExports.h>
 
 #include <itkImage.h>
@@ -71,6 +72,14 @@ namespace mitk
     void OnRoiDataChanged();
     void UpdatePreview();
 
+    /**
+      \brief Thresholds the time step of the preview with m_ThresholdIndex if possible, returns false otherwise.
+
+      If previewWasValid, only the parts that change compared to m_PreviewThresholds are updated.
+    */
+    bool UpdatePreviewWithIndex(
+      Image *previewImage, unsigned int timeStep, bool previewWasValid, double lower, double upper);
+
     template <typename TPixel, unsigned int VImageDimension>
     void ITKThresholding(itk::Image<TPixel, VImageDimension> *originalImage,
                          mitk::Image *segmentation,
@@ -92,6 +101,12 @@ namespace mitk
     bool m_IsFloatImage;
 
     bool m_IsOldBinary = false;
+
+    /** Gray value ranges of the original image, built in the background when the tool is activated */
+    ImageThresholdIndex::Pointer m_ThresholdIndex;
+    /** Thresholds the preview was computed with, if m_PreviewIsValid */
+    bool m_PreviewIsValid;
+    double m_PreviewThresholds[2];
   };
 
 } // namespace
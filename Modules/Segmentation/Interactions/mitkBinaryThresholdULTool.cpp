@@ -51,7 +51,9 @@ mitk::BinaryThresholdULTool::BinaryThresholdULTool()
   : m_SensibleMinimumThresholdValue(-100),
     m_SensibleMaximumThresholdValue(+100),
     m_CurrentLowerThresholdValue(1),
-    m_CurrentUpperThresholdValue(1)
+    m_CurrentUpperThresholdValue(1),
+    m_ThresholdIndex(ImageThresholdIndex::New()),
+    m_PreviewIsValid(false)
 {
   m_ThresholdFeedbackNode = DataNode::New();
   m_ThresholdFeedbackNode->SetProperty("color", ColorProperty::New(0.0, 1.0, 0.0));
@@ -94,6 +96,8 @@ void mitk::BinaryThresholdULTool::Activated()
 
   if (m_NodeForThresholding.IsNotNull())
   {
+    // index the gray values while the user looks at the first preview
+    m_ThresholdIndex->SetInput(dynamic_cast<Image *>(m_OriginalImageNode->GetData()));
     SetupPreviewNode();
   }
   else
@@ -108,6 +112,7 @@ void mitk::BinaryThresholdULTool::Deactivated()
     mitk::MessageDelegate<mitk::BinaryThresholdULTool>(this, &mitk::BinaryThresholdULTool::OnRoiDataChanged);
   m_NodeForThresholding = NULL;
   m_OriginalImageNode = NULL;
+  m_ThresholdIndex->SetInput(nullptr);
   try
   {
     if (DataStorage *storage = m_ToolManager->GetDataStorage())
@@ -155,6 +160,8 @@ void mitk::BinaryThresholdULTool::SetupPreviewNode()
   pixel[1] = 1.0f;
   pixel[2] = 0.0f;
 
+  m_PreviewIsValid = false;
+
   if (m_NodeForThresholding.IsNotNull())
   {
     Image::Pointer image = dynamic_cast<Image *>(m_NodeForThresholding->GetData());
@@ -384,8 +391,17 @@ void mitk::BinaryThresholdULTool::UpdatePreview()
   mitk::Image::Pointer previewImage = dynamic_cast<mitk::Image *>(m_ThresholdFeedbackNode->GetData());
   if (thresholdImage && previewImage)
   {
+    const bool previewWasValid = m_PreviewIsValid;
+    m_PreviewIsValid = false;
+
     for (unsigned int timeStep = 0; timeStep < thresholdImage->GetTimeSteps(); ++timeStep)
     {
+      if (this->UpdatePreviewWithIndex(
+            previewImage, timeStep, previewWasValid, m_CurrentLowerThresholdValue, m_CurrentUpperThresholdValue))
+      {
+        continue;
+      }
+
       ImageTimeSelector::Pointer timeSelector = ImageTimeSelector::New();
       timeSelector->SetInput(thresholdImage);
       timeSelector->SetTimeNr(timeStep);
@@ -405,6 +421,27 @@ void mitk::BinaryThresholdULTool::UpdatePreview()
                       (previewImage, m_CurrentLowerThresholdValue, m_CurrentUpperThresholdValue, timeStep));
       }
     }
+    m_PreviewIsValid = true;
+    m_PreviewThresholds[0] = m_CurrentLowerThresholdValue;
+    m_PreviewThresholds[1] = m_CurrentUpperThresholdValue;
+
     RenderingManager::GetInstance()->RequestUpdateAll();
   }
 }
+
+bool mitk::BinaryThresholdULTool::UpdatePreviewWithIndex(
+  Image *previewImage, unsigned int timeStep, bool previewWasValid, double lower, double upper)
+{
+  // the index covers the original image, not a region of interest cut out of it
+  if (m_NodeForThresholding != m_OriginalImageNode || m_ThresholdIndex->GetInput() != m_NodeForThresholding->GetData())
+  {
+    return false;
+  }
+
+  if (previewWasValid)
+  {
+    return m_ThresholdIndex->UpdateMask(
+      previewImage, timeStep, m_PreviewThresholds[0], m_PreviewThresholds[1], lower, upper);
+  }
+  return m_ThresholdIndex->ThresholdMask(previewImage, timeStep, lower, upper);
+}
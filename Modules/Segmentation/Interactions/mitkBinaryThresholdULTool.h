@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkAutoSegmentationTool.h"
 #include "mitkCommon.h"
 #include "mitkDataNode.h"
+#include "mitkImageThresholdIndex.h"
 #include <MitkSegmentationExports.h>
 
 #include <itkBinaryThresholdImageFilter.h>
@@ -72,6 +73,14 @@ namespace mitk
     void OnRoiDataChanged();
     void UpdatePreview();
 
+    /**
+      \brief Thresholds the time step of the preview with m_ThresholdIndex if possible, returns false otherwise.
+
+      If previewWasValid, only the parts that change compared to m_PreviewThresholds are updated.
+    */
+    bool UpdatePreviewWithIndex(
+      Image *previewImage, unsigned int timeStep, bool previewWasValid, double lower, double upper);
+
     DataNode::Pointer m_ThresholdFeedbackNode;
     DataNode::Pointer m_OriginalImageNode;
     DataNode::Pointer m_NodeForThresholding;
@@ -83,6 +92,12 @@ namespace mitk
 
     bool m_IsOldBinary = false;
 
+    /** Gray value ranges of the original image, built in the background when the tool is activated */
+    ImageThresholdIndex::Pointer m_ThresholdIndex;
+    /** Thresholds the preview was computed with, if m_PreviewIsValid */
+    bool m_PreviewIsValid;
+    double m_PreviewThresholds[2];
+
     typedef itk::Image<int, 3> ImageType;
     typedef itk::Image<Tool::DefaultSegmentationDataType, 3> SegmentationType; // this is sure for new segmentations
     typedef itk::BinaryThresholdImageFilter<ImageType, SegmentationType> ThresholdFilterType;
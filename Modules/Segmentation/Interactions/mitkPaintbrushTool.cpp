@@ -23,7 +23,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkOverwriteSliceImageFilter.h"
 #include "mitkToolManager.h"
 
-#include "mitkContourModelUtils.h"
 #include "mitkLabelSetImage.h"
 #include "mitkLevelWindowProperty.h"
 
@@ -43,6 +42,8 @@ mitk::PaintbrushTool::PaintbrushTool(int paintingPixelValue)
   m_WorkingNode = DataNode::New();
   m_WorkingNode->SetProperty("levelwindow", mitk::LevelWindowProperty::New(mitk::LevelWindow(0, 1)));
   m_WorkingNode->SetProperty("binary", mitk::BoolProperty::New(true));
+
+  m_Rasterizer = PaintbrushRasterizer::New();
 }
 
 mitk::PaintbrushTool::~PaintbrushTool()
@@ -293,6 +294,11 @@ void mitk::PaintbrushTool::OnMousePressed(StateMachineAction *, InteractionEvent
 
   m_WorkingSlice->GetGeometry()->WorldToIndex(positionEvent->GetPositionInWorld(), m_LastPosition);
 
+  // the first stroke only paints the brush at the pressed pixel
+  m_LastPosition[0] = ROUND(m_LastPosition[0]);
+  m_LastPosition[1] = ROUND(m_LastPosition[1]);
+  m_DirtyRegion = PaintbrushRasterizer::Region();
+
   // create new working node
   // a fresh node is needed to only display the actual drawing process for
   // the undo function
@@ -394,9 +400,6 @@ void mitk::PaintbrushTool::MouseMoved(mitk::InteractionEvent *interactionEvent,
 
   if (leftMouseButtonPressed)
   {
-    const double dist = indexCoordinates.EuclideanDistanceTo(m_LastPosition);
-    const double radius = static_cast<double>(m_Size) / 2.0;
-
     DataNode *workingNode(m_ToolManager->GetWorkingData(0));
     Image::Pointer image = dynamic_cast<Image *>(workingNode->GetData());
     LabelSetImage *labelImage = dynamic_cast<LabelSetImage *>(image.GetPointer());
@@ -407,64 +410,15 @@ void mitk::PaintbrushTool::MouseMoved(mitk::InteractionEvent *interactionEvent,
       activeColor = labelImage->GetActiveLabel(labelImage->GetActiveLayer())->GetValue();
     }
 
-    // m_PaintingPixelValue only decides whether to paint or erase
-    mitk::ContourModelUtils::FillContourInSlice(
-      contour, timestep, m_WorkingSlice, image, m_PaintingPixelValue * activeColor);
-
-    m_WorkingNode->SetData(m_WorkingSlice);
-    m_WorkingNode->Modified();
-
-    // if points are >= radius away draw rectangle to fill empty holes
-    // in between the 2 points
-    if (dist > radius)
-    {
-      const mitk::Point3D &currentPos = indexCoordinates;
-      mitk::Point3D direction;
-      mitk::Point3D vertex;
-      mitk::Point3D normal;
-
-      direction[0] = indexCoordinates[0] - m_LastPosition[0];
-      direction[1] = indexCoordinates[1] - m_LastPosition[1];
-      direction[2] = indexCoordinates[2] - m_LastPosition[2];
-
-      direction[0] = direction.GetVnlVector().normalize()[0];
-      direction[1] = direction.GetVnlVector().normalize()[1];
-      direction[2] = direction.GetVnlVector().normalize()[2];
-
-      // 90 degrees rotation of direction
-      normal[0] = -1.0 * direction[1];
-      normal[1] = direction[0];
-
-      contour->Clear();
-
-      // upper left corner
-      vertex[0] = m_LastPosition[0] + (normal[0] * radius);
-      vertex[1] = m_LastPosition[1] + (normal[1] * radius);
+    // paint the brush and fill the gap to the last position, only the pixels of the stroke are touched
+    const int from[2] = {static_cast<int>(m_LastPosition[0]), static_cast<int>(m_LastPosition[1])};
+    const int to[2] = {static_cast<int>(indexCoordinates[0]), static_cast<int>(indexCoordinates[1])};
+    m_Rasterizer->SetSize(m_Size);
 
-      contour->AddVertex(vertex);
-
-      // upper right corner
-      vertex[0] = currentPos[0] + (normal[0] * radius);
-      vertex[1] = currentPos[1] + (normal[1] * radius);
-
-      contour->AddVertex(vertex);
-
-      // lower right corner
-      vertex[0] = currentPos[0] - (normal[0] * radius);
-      vertex[1] = currentPos[1] - (normal[1] * radius);
-
-      contour->AddVertex(vertex);
-
-      // lower left corner
-      vertex[0] = m_LastPosition[0] - (normal[0] * radius);
-      vertex[1] = m_LastPosition[1] - (normal[1] * radius);
-
-      contour->AddVertex(vertex);
-
-      mitk::ContourModelUtils::FillContourInSlice(contour, timestep, m_WorkingSlice, image, m_PaintingPixelValue * activeColor);
-      m_WorkingNode->SetData(m_WorkingSlice);
-      m_WorkingNode->Modified();
-    }
+    // m_PaintingPixelValue only decides whether to paint or erase
+    PaintbrushRasterizer::Region region =
+      m_Rasterizer->PaintStroke(m_WorkingSlice, image, from, to, m_PaintingPixelValue * activeColor);
+    m_DirtyRegion.Include(region);
   }
   else
   {
@@ -508,7 +462,12 @@ void mitk::PaintbrushTool::OnMouseReleased(StateMachineAction *, InteractionEven
   if (!positionEvent)
     return;
 
-  this->WriteBackSegmentationResult(positionEvent, m_WorkingSlice->Clone());
+  // nothing to write back if the stroke did not touch the slice
+  if (!m_DirtyRegion.IsEmpty())
+  {
+    this->WriteBackSegmentationResult(positionEvent, m_WorkingSlice->Clone());
+  }
+  m_DirtyRegion = PaintbrushRasterizer::Region();
 
   // deactivate visibility of helper node
   m_WorkingNode->SetVisibility(false);
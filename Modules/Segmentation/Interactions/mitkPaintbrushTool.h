@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkCommon.h"
 #include "mitkFeedbackContourTool.h"
 #include "mitkLegacyAdaptors.h"
+#include "mitkPaintbrushRasterizer.h"
 #include "mitkPointOperation.h"
 #include "mitkPointSet.h"
 #include <MitkSegmentationExports.h>
@@ -42,6 +43,9 @@ namespace mitk
 
    Simple paintbrush drawing tool. Right now there are only circular pens of varying size.
 
+   While the mouse is dragged, the pen is painted into the working slice by a PaintbrushRasterizer, which fills the
+   stroke between the last and the current mouse position and only touches the pixels of that stroke.
+
 
    \warning Only to be instantiated by mitk::ToolManager.
    $Author: maleike $
@@ -101,6 +105,10 @@ namespace mitk
     PlaneGeometry::Pointer m_CurrentPlane;
     DataNode::Pointer m_WorkingNode;
     mitk::Point3D m_LastPosition;
+
+    PaintbrushRasterizer::Pointer m_Rasterizer;
+    /** Pixels of the working slice painted since the mouse was pressed */
+    PaintbrushRasterizer::Region m_DirtyRegion;
   };
 
 } // namespace
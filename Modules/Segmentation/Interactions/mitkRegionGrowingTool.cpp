@@ -38,9 +38,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkITKImageImport.h"
 #include "mitkImageAccessByItk.h"
 #include <itkConnectedComponentImageFilter.h>
-#include <itkConnectedThresholdImageFilter.h>
 #include <itkImageRegionIteratorWithIndex.h>
-#include <itkNeighborhoodIterator.h>
+
+#include <algorithm>
 
 namespace mitk
 {
@@ -57,7 +57,8 @@ mitk::RegionGrowingTool::RegionGrowingTool()
     m_VisibleWindow(0),
     m_MouseDistanceScaleFactor(0.5),
     m_FillFeedbackContour(true),
-    m_ConnectedComponentValue(1)
+    m_ConnectedComponentValue(1),
+    m_RegionGrower(IncrementalRegionGrower::New())
 {
 }
 
@@ -184,79 +185,141 @@ void mitk::RegionGrowingTool::IsInsideSegmentation(itk::Image<TPixel, imageDimen
   }
 }
 
-// Do the region growing (i.e. call an ITK filter that does it)
+// Replaces every pixel within radius of region by the majority of its neighborhood. Neighbors outside of the image
+// are replaced by the closest pixel inside (the default boundary condition of itk::NeighborhoodIterator), which
+// allows counting the votes separately along each axis. Pixels further away from region have no votes.
 template <typename TPixel, unsigned int imageDimension>
-void mitk::RegionGrowingTool::StartRegionGrowing(itk::Image<TPixel, imageDimension> *inputImage,
-                                                 itk::Index<imageDimension> seedIndex,
-                                                 std::array<ScalarType, 2> thresholds,
-                                                 mitk::Image::Pointer &outputImage)
+static void SmoothByMajorityVote(itk::Image<TPixel, imageDimension> *image,
+                                 itk::ImageRegion<imageDimension> region,
+                                 long radius)
 {
-  MITK_DEBUG << "Starting region growing at index " << seedIndex << " with lower threshold " << thresholds[0]
-             << " and upper threshold " << thresholds[1];
+  typedef itk::Image<TPixel, imageDimension> ImageType;
 
-  typedef itk::Image<TPixel, imageDimension> InputImageType;
-  typedef itk::Image<DefaultSegmentationDataType, imageDimension> OutputImageType;
+  const itk::ImageRegion<imageDimension> largestRegion = image->GetLargestPossibleRegion();
+  region.PadByRadius(radius);
+  if (!region.Crop(largestRegion))
+  {
+    return;
+  }
 
-  typedef itk::ConnectedThresholdImageFilter<InputImageType, OutputImageType> RegionGrowingFilterType;
-  typename RegionGrowingFilterType::Pointer regionGrower = RegionGrowingFilterType::New();
+  std::vector<unsigned int> votes(region.GetNumberOfPixels());
+  itk::ImageRegionIterator<ImageType> iterator(image, region);
+  size_t i = 0;
+  for (iterator.GoToBegin(); !iterator.IsAtEnd(); ++iterator, ++i)
+  {
+    votes[i] = iterator.Get() > 0 ? 1 : 0;
+  }
 
-  // perform region growing in desired segmented region
-  regionGrower->SetInput(inputImage);
-  regionGrower->AddSeed(seedIndex);
+  // sum up the votes along one axis after the other, with a sliding window over each line of the region
+  std::vector<unsigned int> line;
+  size_t stride = 1;
+  for (unsigned int axis = 0; axis < imageDimension; ++axis)
+  {
+    const long length = region.GetSize(axis);
+    const long regionStart = region.GetIndex(axis);
+    const long imageStart = largestRegion.GetIndex(axis);
+    const long imageEnd = imageStart + static_cast<long>(largestRegion.GetSize(axis)) - 1;
+    line.resize(length + 2 * radius);
+
+    const size_t numberOfLines = votes.size() / length;
+    for (size_t lineNumber = 0; lineNumber < numberOfLines; ++lineNumber)
+    {
+      const size_t first = (lineNumber / stride) * stride * length + lineNumber % stride;
+      for (long k = -radius; k < length + radius; ++k)
+      {
+        const long position = std::min(std::max(regionStart + k, imageStart), imageEnd) - regionStart;
+        line[k + radius] = (position >= 0 && position < length) ? votes[first + position * stride] : 0;
+      }
 
-  regionGrower->SetLower(thresholds[0]);
-  regionGrower->SetUpper(thresholds[1]);
+      unsigned int sum = 0;
+      for (long k = 0; k < 2 * radius; ++k)
+      {
+        sum += line[k];
+      }
+      for (long k = 0; k < length; ++k)
+      {
+        sum += line[k + 2 * radius];
+        votes[first + k * stride] = sum;
+        sum -= line[k];
+      }
+    }
+    stride *= length;
+  }
 
-  try
+  size_t neighborhoodSize = 1;
+  for (unsigned int axis = 0; axis < imageDimension; ++axis)
   {
-    regionGrower->Update();
+    neighborhoodSize *= 2 * radius + 1;
   }
-  catch (...)
+
+  i = 0;
+  for (iterator.GoToBegin(); !iterator.IsAtEnd(); ++iterator, ++i)
   {
-    return; // Should we do something?
+    iterator.Set(2 * votes[i] > neighborhoodSize ? 1 : 0);
   }
+}
 
-  typename OutputImageType::Pointer resultImage = regionGrower->GetOutput();
+// Do the region growing (i.e. let m_RegionGrower do it)
+template <typename TPixel, unsigned int imageDimension>
+void mitk::RegionGrowingTool::StartRegionGrowing(itk::Image<TPixel, imageDimension> *inputImage,
+                                                 itk::Index<imageDimension> seedIndex,
+                                                 std::array<ScalarType, 2> thresholds,
+                                                 mitk::Image::Pointer &outputImage)
+{
+  MITK_DEBUG << "Starting region growing at index " << seedIndex << " with lower threshold " << thresholds[0]
+             << " and upper threshold " << thresholds[1];
 
-  // Smooth result: Every pixel is replaced by the majority of the neighborhood
-  typedef itk::NeighborhoodIterator<OutputImageType> NeighborhoodIteratorType;
-  typedef itk::ImageRegionIterator<OutputImageType> ImageIteratorType;
+  typedef itk::Image<DefaultSegmentationDataType, imageDimension> OutputImageType;
 
-  typename NeighborhoodIteratorType::RadiusType radius;
-  radius.Fill(2); // for now, maybe make this something the user can adjust in the preferences?
+  typename OutputImageType::Pointer resultImage = OutputImageType::New();
+  resultImage->CopyInformation(inputImage);
+  resultImage->SetRegions(inputImage->GetLargestPossibleRegion());
+  resultImage->Allocate();
+  resultImage->FillBuffer(0);
 
-  NeighborhoodIteratorType neighborhoodIterator(radius, resultImage, resultImage->GetRequestedRegion());
-  ImageIteratorType imageIterator(resultImage, resultImage->GetRequestedRegion());
+  itk::Index<3> seed;
+  seed.Fill(0);
+  for (unsigned int i = 0; i < imageDimension; ++i)
+  {
+    seed[i] = seedIndex[i];
+  }
+  m_RegionGrower->SetSeed(seed);
 
-  for (neighborhoodIterator.GoToBegin(), imageIterator.GoToBegin(); !neighborhoodIterator.IsAtEnd();
-       ++neighborhoodIterator, ++imageIterator)
+  // grows from the previous result while the user only widens the threshold window
+  m_RegionGrower->Update(thresholds[0], thresholds[1]);
+
+  itk::Index<3> minimum;
+  itk::Index<3> maximum;
+  if (m_RegionGrower->GetBoundingBox(minimum, maximum))
   {
-    DefaultSegmentationDataType voteYes(0);
-    DefaultSegmentationDataType voteNo(0);
+    typename OutputImageType::RegionType boundingBox;
+    for (unsigned int i = 0; i < imageDimension; ++i)
+    {
+      boundingBox.SetIndex(i, minimum[i]);
+      boundingBox.SetSize(i, maximum[i] - minimum[i] + 1);
+    }
 
-    for (unsigned int i = 0; i < neighborhoodIterator.Size(); ++i)
+    const std::vector<unsigned char> &region = m_RegionGrower->GetRegion();
+    const typename OutputImageType::SizeType size = resultImage->GetLargestPossibleRegion().GetSize();
+    itk::ImageRegionIteratorWithIndex<OutputImageType> resultIterator(resultImage, boundingBox);
+    for (resultIterator.GoToBegin(); !resultIterator.IsAtEnd(); ++resultIterator)
     {
-      if (neighborhoodIterator.GetPixel(i) > 0)
+      size_t offset = 0;
+      for (int i = imageDimension - 1; i >= 0; --i)
       {
-        voteYes += 1;
+        offset = offset * size[i] + resultIterator.GetIndex()[i];
       }
-      else
+      if (region[offset] == 1)
       {
-        voteNo += 1;
+        resultIterator.Set(1);
       }
     }
 
-    if (voteYes > voteNo)
-    {
-      imageIterator.Set(1);
-    }
-    else
-    {
-      imageIterator.Set(0);
-    }
+    // Smooth result: Every pixel is replaced by the majority of the neighborhood
+    SmoothByMajorityVote(resultImage.GetPointer(), boundingBox, 2); // for now, maybe make this something the user can
+                                                                    // adjust in the preferences?
   }
-
-  if (resultImage.IsNull())
+  else
   {
     MITK_DEBUG << "Region growing result is empty.";
   }
@@ -438,6 +501,7 @@ void mitk::RegionGrowingTool::OnMousePressedOutside(StateMachineAction *, Intera
     m_Thresholds[1] = m_InitialThresholds[1];
 
     // Perform region growing
+    m_RegionGrower->SetInput(m_ReferenceSlice);
     mitk::Image::Pointer resultImage = mitk::Image::New();
     AccessFixedDimensionByItk_3(
       m_ReferenceSlice, StartRegionGrowing, 2, indexInWorkingSlice2D, m_Thresholds, resultImage);
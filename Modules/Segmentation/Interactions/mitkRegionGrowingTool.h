@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define mitkRegionGrowingTool_h_Included
 
 #include "mitkFeedbackContourTool.h"
+#include "mitkIncrementalRegionGrower.h"
 #include "mitkLegacyAdaptors.h"
 #include <MitkSegmentationExports.h>
 #include <array>
@@ -128,7 +129,8 @@ namespace mitk
                               bool *result);
 
     /**
-     * @brief Template that calls an ITK filter to do the region growing.
+     * @brief Template that grows the region with m_RegionGrower and smoothes the result.
+     * m_RegionGrower has to be initialized with the reference slice before.
      */
     template <typename TPixel, unsigned int imageDimension>
     void StartRegionGrowing(itk::Image<TPixel, imageDimension> *itkImage,
@@ -153,6 +155,7 @@ namespace mitk
     int m_PaintingPixelValue;
     bool m_FillFeedbackContour;
     int m_ConnectedComponentValue;
+    IncrementalRegionGrower::Pointer m_RegionGrower;
   };
 
 } // namespace
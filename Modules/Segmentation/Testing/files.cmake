@@ -4,10 +4,13 @@ set(MODULE_TESTS
   mitkContourModelSetToImageFilterTest.cpp
   mitkDataNodeSegmentationTest.cpp
   mitkFeatureBasedEdgeDetectionFilterTest.cpp
+  mitkImageThresholdIndexTest.cpp
   mitkImageToContourFilterTest.cpp
+  mitkIncrementalRegionGrowerTest.cpp
   mitkSegmentationInterpolationTest.cpp
   mitkOverwriteSliceFilterTest.cpp
   mitkOverwriteSliceFilterObliquePlaneTest.cpp
+  mitkPaintbrushRasterizerTest.cpp
 #  mitkToolManagerTest.cpp
   mitkToolManagerProviderTest.cpp
   mitkManualSegmentationToSurfaceFilterTest.cpp #new cpp unit style
@@ -0,0 +1,203 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <mitkImageReadAccessor.h>
+#include <mitkImageThresholdIndex.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <itksys/SystemTools.hxx>
+
+#include <limits>
+
+class mitkImageThresholdIndexTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkImageThresholdIndexTestSuite);
+  MITK_TEST(ThresholdMask_EqualsVoxelwiseThreshold);
+  MITK_TEST(UpdateMask_EqualsVoxelwiseThreshold);
+  MITK_TEST(ModifiedInput_IsNotReady);
+  MITK_TEST(ThresholdMask_NaNVoxelsAreOutside);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  // not a multiple of the brick size to cover partial bricks
+  static const unsigned int m_Size = 21;
+
+  mitk::Image::Pointer m_Image;
+  mitk::Image::Pointer m_Mask;
+  mitk::ImageThresholdIndex::Pointer m_Index;
+
+  static short GetValue(unsigned int x, unsigned int y, unsigned int z)
+  {
+    // smooth in most bricks, noisy in a few of them
+    return static_cast<short>(x + 2 * y + 3 * z + ((x * 7 + y * 13 + z * 17) % 11 == 0 ? 40 : 0));
+  }
+
+  void WaitUntilReady()
+  {
+    for (int i = 0; i < 1000 && !m_Index->IsReady(0); ++i)
+    {
+      itksys::SystemTools::Delay(10);
+    }
+    CPPUNIT_ASSERT(m_Index->IsReady(0));
+  }
+
+  void AssertMaskEquals(double lower, double upper)
+  {
+    mitk::ImageReadAccessor access(m_Mask);
+    const unsigned char *mask = static_cast<const unsigned char *>(access.GetData());
+    for (unsigned int z = 0; z < m_Size; ++z)
+    {
+      for (unsigned int y = 0; y < m_Size; ++y)
+      {
+        for (unsigned int x = 0; x < m_Size; ++x)
+        {
+          const short value = GetValue(x, y, z);
+          const unsigned char expected = (lower <= value && value <= upper) ? 1 : 0;
+          CPPUNIT_ASSERT_EQUAL(expected, mask[(z * m_Size + y) * m_Size + x]);
+        }
+      }
+    }
+  }
+
+  static bool IsNaNVoxel(unsigned int x, unsigned int y, unsigned int z)
+  {
+    const unsigned int brickSize = mitk::ImageThresholdIndex::BrickSize;
+    return (x == 3 && y == 3 && z == 3) || (x / brickSize == 1 && y / brickSize == 1 && z / brickSize == 1);
+  }
+
+  // all voxels but the NaN voxels have the mask value insideValue
+  void AssertNaNMaskEquals(bool insideValue)
+  {
+    mitk::ImageReadAccessor access(m_Mask);
+    const unsigned char *mask = static_cast<const unsigned char *>(access.GetData());
+    for (unsigned int z = 0; z < m_Size; ++z)
+    {
+      for (unsigned int y = 0; y < m_Size; ++y)
+      {
+        for (unsigned int x = 0; x < m_Size; ++x)
+        {
+          const unsigned char expected = (insideValue && !IsNaNVoxel(x, y, z)) ? 1 : 0;
+          CPPUNIT_ASSERT_EQUAL(expected, mask[(z * m_Size + y) * m_Size + x]);
+        }
+      }
+    }
+  }
+
+public:
+  void setUp() override
+  {
+    unsigned int dimensions[3] = {m_Size, m_Size, m_Size};
+    m_Image = mitk::Image::New();
+    m_Image->Initialize(mitk::MakeScalarPixelType<short>(), 3, dimensions);
+    {
+      mitk::ImageWriteAccessor access(m_Image);
+      short *pixels = static_cast<short *>(access.GetData());
+      for (unsigned int z = 0; z < m_Size; ++z)
+        for (unsigned int y = 0; y < m_Size; ++y)
+          for (unsigned int x = 0; x < m_Size; ++x)
+            pixels[(z * m_Size + y) * m_Size + x] = GetValue(x, y, z);
+    }
+
+    m_Mask = mitk::Image::New();
+    m_Mask->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 3, dimensions);
+
+    m_Index = mitk::ImageThresholdIndex::New();
+    m_Index->SetInput(m_Image);
+  }
+
+  void tearDown() override
+  {
+    m_Index = nullptr;
+    m_Mask = nullptr;
+    m_Image = nullptr;
+  }
+
+  void ThresholdMask_EqualsVoxelwiseThreshold()
+  {
+    this->WaitUntilReady();
+
+    CPPUNIT_ASSERT(m_Index->ThresholdMask(m_Mask, 0, 30, 55));
+    this->AssertMaskEquals(30, 55);
+
+    // thresholds are truncated to the pixel type
+    CPPUNIT_ASSERT(m_Index->ThresholdMask(m_Mask, 0, 10.7, 20.2));
+    this->AssertMaskEquals(10, 20);
+  }
+
+  void UpdateMask_EqualsVoxelwiseThreshold()
+  {
+    this->WaitUntilReady();
+
+    CPPUNIT_ASSERT(m_Index->ThresholdMask(m_Mask, 0, 30, 55));
+    CPPUNIT_ASSERT(m_Index->UpdateMask(m_Mask, 0, 30, 55, 25, 50));
+    this->AssertMaskEquals(25, 50);
+
+    // disjoint intervals
+    CPPUNIT_ASSERT(m_Index->UpdateMask(m_Mask, 0, 25, 50, 80, 200));
+    this->AssertMaskEquals(80, 200);
+
+    // empty interval
+    CPPUNIT_ASSERT(m_Index->UpdateMask(m_Mask, 0, 80, 200, 60, 40));
+    this->AssertMaskEquals(60, 40);
+    CPPUNIT_ASSERT(m_Index->UpdateMask(m_Mask, 0, 60, 40, 0, 45));
+    this->AssertMaskEquals(0, 45);
+  }
+
+  void ModifiedInput_IsNotReady()
+  {
+    this->WaitUntilReady();
+
+    m_Image->Modified();
+    CPPUNIT_ASSERT(!m_Index->IsReady(0));
+    CPPUNIT_ASSERT(!m_Index->ThresholdMask(m_Mask, 0, 30, 55));
+
+    m_Index->SetInput(m_Image);
+    this->WaitUntilReady();
+    CPPUNIT_ASSERT(!m_Index->IsReady(1));
+  }
+
+  void ThresholdMask_NaNVoxelsAreOutside()
+  {
+    // a constant image with a single NaN voxel in the first brick and a brick of NaN voxels
+    unsigned int dimensions[3] = {m_Size, m_Size, m_Size};
+    mitk::Image::Pointer image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<float>(), 3, dimensions);
+    {
+      mitk::ImageWriteAccessor access(image);
+      float *pixels = static_cast<float *>(access.GetData());
+      for (unsigned int z = 0; z < m_Size; ++z)
+        for (unsigned int y = 0; y < m_Size; ++y)
+          for (unsigned int x = 0; x < m_Size; ++x)
+            pixels[(z * m_Size + y) * m_Size + x] = IsNaNVoxel(x, y, z) ? std::numeric_limits<float>::quiet_NaN() : 1;
+    }
+    m_Index->SetInput(image);
+    this->WaitUntilReady();
+
+    CPPUNIT_ASSERT(m_Index->ThresholdMask(m_Mask, 0, 0, 2));
+    this->AssertNaNMaskEquals(true);
+    CPPUNIT_ASSERT(m_Index->UpdateMask(m_Mask, 0, 0, 2, 0.5, 3));
+    this->AssertNaNMaskEquals(true);
+    CPPUNIT_ASSERT(m_Index->UpdateMask(m_Mask, 0, 0.5, 3, 2, 3));
+    this->AssertNaNMaskEquals(false);
+    CPPUNIT_ASSERT(m_Index->UpdateMask(m_Mask, 0, 2, 3, -1, 1));
+    this->AssertNaNMaskEquals(true);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkImageThresholdIndex)
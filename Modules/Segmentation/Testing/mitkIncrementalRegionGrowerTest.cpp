@@ -0,0 +1,134 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <mitkITKImageImport.h>
+#include <mitkIncrementalRegionGrower.h>
+
+#include <itkConnectedThresholdImageFilter.h>
+#include <itkImageRegionConstIterator.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+class mitkIncrementalRegionGrowerTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkIncrementalRegionGrowerTestSuite);
+  MITK_TEST(Update_EqualsConnectedThresholdFilter);
+  MITK_TEST(Update_WidenedInterval_VisitsOnlyNewPixels);
+  MITK_TEST(Update_SeedOutsideOfInterval_IsEmpty);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<short, 2> ImageType;
+
+  ImageType::Pointer m_ItkImage;
+  mitk::Image::Pointer m_Image;
+  mitk::IncrementalRegionGrower::Pointer m_Grower;
+
+  void AssertRegionEqualsFilter(double lower, double upper)
+  {
+    typedef itk::ConnectedThresholdImageFilter<ImageType, ImageType> FilterType;
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput(m_ItkImage);
+    ImageType::IndexType seed;
+    seed[0] = m_Grower->GetSeed()[0];
+    seed[1] = m_Grower->GetSeed()[1];
+    filter->AddSeed(seed);
+    filter->SetLower(static_cast<short>(lower));
+    filter->SetUpper(static_cast<short>(upper));
+    filter->SetReplaceValue(1);
+    filter->Update();
+
+    const std::vector<unsigned char> &region = m_Grower->GetRegion();
+    itk::ImageRegionConstIterator<ImageType> iterator(filter->GetOutput(), filter->GetOutput()->GetRequestedRegion());
+    size_t offset = 0;
+    for (iterator.GoToBegin(); !iterator.IsAtEnd(); ++iterator, ++offset)
+    {
+      CPPUNIT_ASSERT_EQUAL(iterator.Get() == 1, region[offset] == 1);
+    }
+  }
+
+public:
+  void setUp() override
+  {
+    m_ItkImage = ImageType::New();
+    ImageType::SizeType size;
+    size[0] = 40;
+    size[1] = 30;
+    m_ItkImage->SetRegions(size);
+    m_ItkImage->Allocate();
+
+    // rings of increasing values around the center, with a wall of high values in column 25
+    itk::ImageRegionIteratorWithIndex<ImageType> iterator(m_ItkImage, m_ItkImage->GetLargestPossibleRegion());
+    for (iterator.GoToBegin(); !iterator.IsAtEnd(); ++iterator)
+    {
+      const long x = iterator.GetIndex()[0] - 12;
+      const long y = iterator.GetIndex()[1] - 15;
+      iterator.Set(iterator.GetIndex()[0] == 25 ? 500 : static_cast<short>((x * x + y * y) / 8));
+    }
+
+    m_Image = mitk::ImportItkImage(m_ItkImage)->Clone();
+
+    m_Grower = mitk::IncrementalRegionGrower::New();
+    m_Grower->SetInput(m_Image);
+    itk::Index<3> seed = {{12, 15, 0}};
+    m_Grower->SetSeed(seed);
+  }
+
+  void tearDown() override
+  {
+    m_Grower = nullptr;
+    m_Image = nullptr;
+    m_ItkImage = nullptr;
+  }
+
+  void Update_EqualsConnectedThresholdFilter()
+  {
+    // widening, narrowing, shifting and widening again
+    const double intervals[][2] = {{0, 10}, {-3, 20}, {-3, 60}, {5, 60}, {-10, 600}, {0, 30.9}, {0, 45}};
+    for (const auto &interval : intervals)
+    {
+      m_Grower->Update(interval[0], interval[1]);
+      this->AssertRegionEqualsFilter(interval[0], interval[1]);
+    }
+  }
+
+  void Update_WidenedInterval_VisitsOnlyNewPixels()
+  {
+    m_Grower->Update(0, 40);
+    const size_t visitedFirst = m_Grower->GetNumberOfVisitedPixels();
+
+    m_Grower->Update(0, 41);
+    this->AssertRegionEqualsFilter(0, 41);
+    CPPUNIT_ASSERT(m_Grower->GetNumberOfVisitedPixels() < visitedFirst / 4);
+  }
+
+  void Update_SeedOutsideOfInterval_IsEmpty()
+  {
+    itk::Index<3> minimum;
+    itk::Index<3> maximum;
+
+    m_Grower->Update(1, 10);
+    CPPUNIT_ASSERT(!m_Grower->GetBoundingBox(minimum, maximum));
+
+    m_Grower->Update(0, 10);
+    CPPUNIT_ASSERT(m_Grower->GetBoundingBox(minimum, maximum));
+    this->AssertRegionEqualsFilter(0, 10);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkIncrementalRegionGrower)
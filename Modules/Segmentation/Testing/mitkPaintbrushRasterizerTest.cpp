@@ -0,0 +1,272 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+#include <mitkLabelSetImage.h>
+#include <mitkPaintbrushRasterizer.h>
+
+#include <algorithm>
+#include <cstring>
+
+class mitkPaintbrushRasterizerTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkPaintbrushRasterizerTestSuite);
+  MITK_TEST(GetStamp_CoversPixelsWithinRadius);
+  MITK_TEST(RasterizeStroke_CoversPixelsWithinRadiusOfLine);
+  MITK_TEST(PaintStroke_IsClippedToSlice);
+  MITK_TEST(PaintStroke_KeepsLockedLabels);
+  MITK_TEST(PaintStroke_ErasesOnlyActiveLabel);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  static const unsigned int m_Width = 20;
+  static const unsigned int m_Height = 15;
+
+  mitk::Image::Pointer m_Slice;
+  mitk::PaintbrushRasterizer::Pointer m_Rasterizer;
+
+  static bool Contains(const std::vector<mitk::PaintbrushRasterizer::Span> &spans, int x, int y)
+  {
+    for (const auto &span : spans)
+    {
+      if (span.Y == y && span.X0 <= x && x <= span.X1)
+        return true;
+    }
+    return false;
+  }
+
+  // distance of the pixel center to the line between the brush centers is at most half of the size
+  static bool IsInside(int size, const int from[2], const int to[2], int x, int y)
+  {
+    const double center = (size % 2 == 0) ? 0.5 : 0.0;
+    const double start[2] = {from[0] + center, from[1] + center};
+    const double direction[2] = {static_cast<double>(to[0] - from[0]), static_cast<double>(to[1] - from[1])};
+    const double lengthSquared = direction[0] * direction[0] + direction[1] * direction[1];
+    double t = 0;
+    if (lengthSquared > 0)
+    {
+      t = ((x - start[0]) * direction[0] + (y - start[1]) * direction[1]) / lengthSquared;
+      t = std::max(0.0, std::min(1.0, t));
+    }
+    const double dx = start[0] + t * direction[0] - x;
+    const double dy = start[1] + t * direction[1] - y;
+    return dx * dx + dy * dy <= 0.25 * size * size + 1e-9;
+  }
+
+  // slice of a label set image with the labels 0, 1 and 2 in diagonal stripes
+  static mitk::Image::Pointer CreateLabelSlice()
+  {
+    unsigned int dimensions[2] = {m_Width, m_Height};
+    mitk::Image::Pointer slice = mitk::Image::New();
+    slice->Initialize(mitk::MakeScalarPixelType<mitk::LabelSetImage::PixelType>(), 2, dimensions);
+    mitk::ImageWriteAccessor access(slice);
+    mitk::LabelSetImage::PixelType *pixels = static_cast<mitk::LabelSetImage::PixelType *>(access.GetData());
+    for (unsigned int y = 0; y < m_Height; ++y)
+    {
+      for (unsigned int x = 0; x < m_Width; ++x)
+      {
+        pixels[y * m_Width + x] = static_cast<mitk::LabelSetImage::PixelType>((x + y) % 3);
+      }
+    }
+    return slice;
+  }
+
+  // label set image with the unlocked labels 1, 2 and 3, label 1 is active
+  mitk::LabelSetImage::Pointer CreateLabelSetImage()
+  {
+    mitk::LabelSetImage::Pointer labelSetImage = mitk::LabelSetImage::New();
+    labelSetImage->Initialize(m_Slice);
+
+    mitk::LabelSet *labelSet = labelSetImage->GetActiveLabelSet();
+    for (mitk::Label::PixelType value = 1; value <= 3; ++value)
+    {
+      mitk::Label::Pointer label = mitk::Label::New();
+      label->SetValue(value);
+      label->SetLocked(false);
+      labelSet->AddLabel(label);
+    }
+    labelSet->SetActiveLabel(1);
+    return labelSetImage;
+  }
+
+  /** Paints a stroke into a label slice and checks every pixel: pixels of the stroke with a label in replacedLabels
+   * get paintingPixelValue, all other pixels keep their label */
+  void CheckLabelStroke(mitk::LabelSetImage *labelSetImage,
+                        int paintingPixelValue,
+                        const std::vector<mitk::LabelSetImage::PixelType> &replacedLabels)
+  {
+    mitk::Image::Pointer slice = CreateLabelSlice();
+    m_Rasterizer->SetSize(7);
+    const int from[2] = {3, 4};
+    const int to[2] = {15, 9};
+    CPPUNIT_ASSERT(!m_Rasterizer->PaintStroke(slice, labelSetImage, from, to, paintingPixelValue).IsEmpty());
+
+    std::vector<mitk::PaintbrushRasterizer::Span> spans;
+    m_Rasterizer->RasterizeStroke(from, to, spans);
+
+    mitk::ImageReadAccessor access(slice);
+    const mitk::LabelSetImage::PixelType *pixels =
+      static_cast<const mitk::LabelSetImage::PixelType *>(access.GetData());
+    for (unsigned int y = 0; y < m_Height; ++y)
+    {
+      for (unsigned int x = 0; x < m_Width; ++x)
+      {
+        mitk::LabelSetImage::PixelType expected = static_cast<mitk::LabelSetImage::PixelType>((x + y) % 3);
+        if (Contains(spans, x, y) &&
+            std::find(replacedLabels.begin(), replacedLabels.end(), expected) != replacedLabels.end())
+        {
+          expected = static_cast<mitk::LabelSetImage::PixelType>(paintingPixelValue);
+        }
+        CPPUNIT_ASSERT_EQUAL(expected, pixels[y * m_Width + x]);
+      }
+    }
+  }
+
+public:
+  void setUp() override
+  {
+    unsigned int dimensions[2] = {m_Width, m_Height};
+    m_Slice = mitk::Image::New();
+    m_Slice->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 2, dimensions);
+    {
+      mitk::ImageWriteAccessor access(m_Slice);
+      std::memset(access.GetData(), 0, m_Width * m_Height);
+    }
+
+    m_Rasterizer = mitk::PaintbrushRasterizer::New();
+  }
+
+  void tearDown() override
+  {
+    m_Rasterizer = nullptr;
+    m_Slice = nullptr;
+  }
+
+  void GetStamp_CoversPixelsWithinRadius()
+  {
+    const int origin[2] = {0, 0};
+    for (int size = 1; size <= 12; ++size)
+    {
+      m_Rasterizer->SetSize(size);
+      const std::vector<mitk::PaintbrushRasterizer::Span> &stamp = m_Rasterizer->GetStamp();
+      for (int y = -size; y <= size; ++y)
+      {
+        for (int x = -size; x <= size; ++x)
+        {
+          CPPUNIT_ASSERT_EQUAL(IsInside(size, origin, origin, x, y), Contains(stamp, x, y));
+        }
+      }
+    }
+
+    m_Rasterizer->SetSize(1);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), m_Rasterizer->GetStamp().size());
+  }
+
+  void RasterizeStroke_CoversPixelsWithinRadiusOfLine()
+  {
+    const int strokes[][4] = {{0, 0, 0, 0}, {0, 0, 9, 0}, {0, 0, 0, -7}, {-3, 2, 8, 7}, {5, -4, -6, 3}, {1, 1, 2, 9}};
+    std::vector<mitk::PaintbrushRasterizer::Span> spans;
+    for (int size = 1; size <= 8; ++size)
+    {
+      m_Rasterizer->SetSize(size);
+      for (const auto &stroke : strokes)
+      {
+        const int from[2] = {stroke[0], stroke[1]};
+        const int to[2] = {stroke[2], stroke[3]};
+        m_Rasterizer->RasterizeStroke(from, to, spans);
+
+        for (size_t i = 1; i < spans.size(); ++i)
+        {
+          CPPUNIT_ASSERT_EQUAL(spans[i - 1].Y + 1, spans[i].Y);
+        }
+        for (int y = -20; y <= 20; ++y)
+        {
+          for (int x = -20; x <= 20; ++x)
+          {
+            CPPUNIT_ASSERT_EQUAL(IsInside(size, from, to, x, y), Contains(spans, x, y));
+          }
+        }
+      }
+    }
+  }
+
+  void PaintStroke_IsClippedToSlice()
+  {
+    m_Rasterizer->SetSize(5);
+    const int from[2] = {-1, 3};
+    const int to[2] = {6, 3};
+    mitk::PaintbrushRasterizer::Region region = m_Rasterizer->PaintStroke(m_Slice, m_Slice, from, to, 1);
+
+    CPPUNIT_ASSERT_EQUAL(0, region.Minimum[0]);
+    CPPUNIT_ASSERT_EQUAL(8, region.Maximum[0]);
+    CPPUNIT_ASSERT_EQUAL(1, region.Minimum[1]);
+    CPPUNIT_ASSERT_EQUAL(5, region.Maximum[1]);
+
+    std::vector<mitk::PaintbrushRasterizer::Span> spans;
+    m_Rasterizer->RasterizeStroke(from, to, spans);
+
+    mitk::ImageReadAccessor access(m_Slice);
+    const unsigned char *pixels = static_cast<const unsigned char *>(access.GetData());
+    for (unsigned int y = 0; y < m_Height; ++y)
+    {
+      for (unsigned int x = 0; x < m_Width; ++x)
+      {
+        const unsigned char expected = Contains(spans, x, y) ? 1 : 0;
+        CPPUNIT_ASSERT_EQUAL(expected, pixels[y * m_Width + x]);
+      }
+    }
+
+    // strokes outside of the slice leave it untouched
+    const unsigned long mTime = m_Slice->GetMTime();
+    const int outside[2] = {-10, -10};
+    CPPUNIT_ASSERT(m_Rasterizer->PaintStroke(m_Slice, m_Slice, outside, outside, 1).IsEmpty());
+    CPPUNIT_ASSERT_EQUAL(mTime, m_Slice->GetMTime());
+  }
+
+  void PaintStroke_KeepsLockedLabels()
+  {
+    mitk::LabelSetImage::Pointer labelSetImage = CreateLabelSetImage();
+    CheckLabelStroke(labelSetImage, 3, {0, 1, 2});
+
+    labelSetImage->GetActiveLabelSet()->GetLabel(2)->SetLocked(true);
+    CheckLabelStroke(labelSetImage, 3, {0, 1});
+
+    // the exterior label can be locked as well
+    labelSetImage->GetActiveLabelSet()->GetLabel(0)->SetLocked(true);
+    CheckLabelStroke(labelSetImage, 3, {1});
+  }
+
+  void PaintStroke_ErasesOnlyActiveLabel()
+  {
+    // erasing is painting the exterior label
+    mitk::LabelSetImage::Pointer labelSetImage = CreateLabelSetImage();
+    const int exterior = labelSetImage->GetExteriorLabel()->GetValue();
+    CheckLabelStroke(labelSetImage, exterior, {1});
+
+    labelSetImage->GetActiveLabelSet()->SetActiveLabel(2);
+    CheckLabelStroke(labelSetImage, exterior, {2});
+
+    // the active label is erased even if it is locked
+    labelSetImage->GetActiveLabelSet()->GetLabel(2)->SetLocked(true);
+    CheckLabelStroke(labelSetImage, exterior, {2});
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkPaintbrushRasterizer)
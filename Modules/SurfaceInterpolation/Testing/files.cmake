@@ -6,3 +6,8 @@ set(MODULE_TESTS
   mitkReduceContourSetFilterTest.cpp
   mitkSurfaceInterpolationControllerTest.cpp
 )
+
+# tests that also provide benchmarks, run with the argument "benchmark" if MITK_ENABLE_BENCHMARK_TESTING is ON
+set(MODULE_BENCHMARK_TESTS
+  mitkSurfaceInterpolationControllerTest.cpp
+)
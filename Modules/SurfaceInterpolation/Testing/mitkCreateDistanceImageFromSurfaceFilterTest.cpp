@@ -22,6 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkTestingMacros.h>
 
 #include <vtkDebugLeaks.h>
+#include <vtkRegularPolygonSource.h>
 
 class mitkCreateDistanceImageFromSurfaceFilterTestSuite : public mitk::TestFixture
 {
@@ -29,6 +30,7 @@ class mitkCreateDistanceImageFromSurfaceFilterTestSuite : public mitk::TestFixtu
   vtkDebugLeaks::SetExitError(0);
   MITK_TEST(TestCreateDistanceImageForLiver);
   MITK_TEST(TestCreateDistanceImageForTube);
+  MITK_TEST(TestIncrementalUpdate);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -42,6 +44,48 @@ public:
     result->Graft(input);
   }
 
+  // Creates the contours with normals of a sphere with radius 20 around (32, 32, 32)
+  std::vector<mitk::Surface::Pointer> CreateSphereContours(const std::vector<double> &offsets)
+  {
+    mitk::ComputeContourSetNormalsFilter::Pointer normalsFilter = mitk::ComputeContourSetNormalsFilter::New();
+    for (unsigned int i = 0; i < offsets.size(); ++i)
+    {
+      vtkSmartPointer<vtkRegularPolygonSource> polygonSource = vtkSmartPointer<vtkRegularPolygonSource>::New();
+      polygonSource->SetNumberOfSides(30);
+      polygonSource->SetCenter(32.0, 32.0, 32.0 + offsets[i]);
+      polygonSource->SetRadius(std::sqrt(400.0 - offsets[i] * offsets[i]));
+      polygonSource->SetNormal(0.0, 0.0, 1.0);
+      polygonSource->GeneratePolylineOff();
+      polygonSource->Update();
+      mitk::Surface::Pointer contour = mitk::Surface::New();
+      contour->SetVtkPolyData(polygonSource->GetOutput());
+      normalsFilter->SetInput(i, contour);
+    }
+    normalsFilter->Update();
+
+    std::vector<mitk::Surface::Pointer> contours;
+    for (unsigned int i = 0; i < offsets.size(); ++i)
+    {
+      mitk::Surface::Pointer contour = normalsFilter->GetOutput(i);
+      contour->DisconnectPipeline();
+      contours.push_back(contour);
+    }
+    return contours;
+  }
+
+  mitk::Image::Pointer CreateDistanceImage(const std::vector<mitk::Surface::Pointer> &contours,
+                                           itk::ImageBase<3>::Pointer referenceImage)
+  {
+    mitk::CreateDistanceImageFromSurfaceFilter::Pointer filter = mitk::CreateDistanceImageFromSurfaceFilter::New();
+    filter->SetReferenceImage(referenceImage);
+    for (unsigned int i = 0; i < contours.size(); ++i)
+    {
+      filter->SetInput(i, contours.at(i));
+    }
+    filter->Update();
+    return filter->GetOutput();
+  }
+
   // Interpolate the shape of a liver
   void TestCreateDistanceImageForLiver()
   {
@@ -131,6 +175,53 @@ public:
     CPPUNIT_ASSERT_MESSAGE("HolesDistanceImages are not equal!",
                            mitk::Equal(*(holesDistanceImageReference), *(holeDistanceImage), 0.0001, true));
   }
+
+  // The distance images of incremental updates are equal to the ones of a new filter
+  void TestIncrementalUpdate()
+  {
+    unsigned int dimensions[] = {64, 64, 64};
+    mitk::Image::Pointer image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 3, dimensions);
+    itk::ImageBase<3>::Pointer itkImage = itk::ImageBase<3>::New();
+    AccessFixedDimensionByItk_1(image, GetImageBase, 3, itkImage);
+
+    // The outer contours come first, so that the bounds and the spacing of the distance image stay the same
+    double offsetArray[] = {-18.0, 18.0, 0.0, -9.0, 9.0, -13.0, 4.0};
+    std::vector<double> offsets(offsetArray, offsetArray + 7);
+    std::vector<mitk::Surface::Pointer> contours = CreateSphereContours(offsets);
+
+    mitk::CreateDistanceImageFromSurfaceFilter::Pointer filter = mitk::CreateDistanceImageFromSurfaceFilter::New();
+    filter->SetReferenceImage(itkImage.GetPointer());
+    filter->IncrementalUpdateOn();
+    for (unsigned int i = 0; i < 5; ++i)
+    {
+      filter->SetInput(i, contours.at(i));
+    }
+    filter->Update();
+    CPPUNIT_ASSERT_MESSAGE("First update solves the whole system", !filter->GetLastUpdateWasIncremental());
+
+    // Add two contours
+    filter->SetInput(5, contours.at(5));
+    filter->SetInput(6, contours.at(6));
+    filter->Update();
+    CPPUNIT_ASSERT_MESSAGE("Added contours update the system", filter->GetLastUpdateWasIncremental());
+    CPPUNIT_ASSERT_MESSAGE("Distance images are equal after adding contours",
+                           mitk::Equal(*(CreateDistanceImage(contours, itkImage.GetPointer())),
+                                       *(filter->GetOutput()),
+                                       0.0001,
+                                       true));
+
+    // Remove the last contour, the other contour that was added with it is added again
+    filter->RemoveInputs(contours.at(6));
+    filter->Update();
+    contours.pop_back();
+    CPPUNIT_ASSERT_MESSAGE("Removed contour updates the system", filter->GetLastUpdateWasIncremental());
+    CPPUNIT_ASSERT_MESSAGE("Distance images are equal after removing a contour",
+                           mitk::Equal(*(CreateDistanceImage(contours, itkImage.GetPointer())),
+                                       *(filter->GetOutput()),
+                                       0.0001,
+                                       true));
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkCreateDistanceImageFromSurfaceFilter)
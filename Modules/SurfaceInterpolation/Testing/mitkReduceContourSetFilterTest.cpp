@@ -21,16 +21,50 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkTestFixture.h>
 #include <mitkTestingMacros.h>
 
+#include <vtkCellArray.h>
+#include <vtkMath.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+#include <cmath>
+
 class mitkReduceContourSetFilterTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkReduceContourSetFilterTestSuite);
   MITK_TEST(TestReduceContourWithNthPoint);
   MITK_TEST(TestReduceContourWithDouglasPeuker);
+  MITK_TEST(TestIntersectionContours);
   CPPUNIT_TEST_SUITE_END();
 
 private:
   mitk::ReduceContourSetFilter::Pointer m_ContourReducer;
 
+  // Circle with radius 20 around center in the plane spanned by u and v
+  mitk::Surface::Pointer CreateCircle(const double center[3], const double u[3], const double v[3])
+  {
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    vtkSmartPointer<vtkCellArray> polygons = vtkSmartPointer<vtkCellArray>::New();
+    const unsigned int numberOfPoints = 40;
+    polygons->InsertNextCell(numberOfPoints);
+    for (unsigned int i = 0; i < numberOfPoints; ++i)
+    {
+      double angle = 2.0 * vtkMath::Pi() * i / numberOfPoints;
+      double point[3];
+      for (unsigned int d = 0; d < 3; ++d)
+      {
+        point[d] = center[d] + 20.0 * (std::cos(angle) * u[d] + std::sin(angle) * v[d]);
+      }
+      polygons->InsertCellPoint(points->InsertNextPoint(point));
+    }
+    vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+    polyData->SetPoints(points);
+    polyData->SetPolys(polygons);
+
+    mitk::Surface::Pointer surface = mitk::Surface::New();
+    surface->SetVtkPolyData(polyData);
+    return surface;
+  }
+
 public:
   void setUp() override
   {
@@ -74,6 +108,37 @@ public:
       "Unequal contours",
       mitk::Equal(*(reducedContour->GetVtkPolyData()), *(reference->GetVtkPolyData()), 0.000001, true));
   }
+
+  // Contours lying in the plane of another contour are removed, all others are reduced
+  void TestIntersectionContours()
+  {
+    const double x[3] = {1, 0, 0};
+    const double y[3] = {0, 1, 0};
+    const double z[3] = {0, 0, 1};
+    const double tilted[3] = {0, 0.6, 0.8};
+
+    const double center0[3] = {0, 0, 0};
+    const double center1[3] = {0, 0, 0.2};
+    const double center2[3] = {0, 0, 10};
+    const double center3[3] = {100, 0, 0};
+    const double center4[3] = {0, 0, 5};
+
+    // Two axial contours closer than half of the minimum spacing to each other, one further axial, one sagittal and
+    // one oblique contour
+    m_ContourReducer->SetInput(0, CreateCircle(center0, x, y));
+    m_ContourReducer->SetInput(1, CreateCircle(center1, x, y));
+    m_ContourReducer->SetInput(2, CreateCircle(center2, x, y));
+    m_ContourReducer->SetInput(3, CreateCircle(center3, y, z));
+    m_ContourReducer->SetInput(4, CreateCircle(center4, x, tilted));
+    m_ContourReducer->SetMinSpacing(1.0);
+    m_ContourReducer->SetMaxSpacing(1.0);
+    m_ContourReducer->SetReductionType(mitk::ReduceContourSetFilter::NTH_POINT);
+    m_ContourReducer->SetStepSize(5);
+    m_ContourReducer->Update();
+
+    CPPUNIT_ASSERT_MESSAGE("Intersection contours are removed", m_ContourReducer->GetNumberOfIndexedOutputs() == 3);
+    CPPUNIT_ASSERT_MESSAGE("Remaining contours are reduced", m_ContourReducer->GetNumberOfPointsAfterReduction() == 24);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkReduceContourSetFilter)
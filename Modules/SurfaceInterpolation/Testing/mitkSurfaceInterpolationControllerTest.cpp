@@ -24,6 +24,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImagePixelWriteAccessor.h"
 #include "mitkImageTimeSelector.h"
 
+#include <chrono>
+
 class mitkSurfaceInterpolationControllerTestSuite : public mitk::TestFixture
 {
   CPPUNIT_TEST_SUITE(mitkSurfaceInterpolationControllerTestSuite);
@@ -45,6 +47,7 @@ class mitkSurfaceInterpolationControllerTestSuite : public mitk::TestFixture
 
   MITK_TEST(TestAddNewContour);
   MITK_TEST(TestRemoveContour);
+  MITK_BENCHMARK(TestAddContourLatency_Benchmark);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -557,6 +560,86 @@ public:
     return true;
   }
 
+  /** Prints the time to add a contour and interpolate the surface again, like after each stroke while segmenting
+   * a sphere slice by slice. */
+  void TestAddContourLatency_Benchmark()
+  {
+    const double radius = 40.0;
+    const double center = 64.0;
+
+    unsigned int dimensions[] = {128, 128, 128};
+    mitk::Image::Pointer segmentation = createImage(dimensions);
+    {
+      mitk::ImagePixelWriteAccessor<unsigned char, 3> writeAccess(segmentation);
+      itk::Index<3> index;
+      for (index[2] = 0; index[2] < 128; ++index[2])
+        for (index[1] = 0; index[1] < 128; ++index[1])
+          for (index[0] = 0; index[0] < 128; ++index[0])
+          {
+            double x = index[0] - center;
+            double y = index[1] - center;
+            double z = index[2] - center;
+            writeAccess.SetPixelByIndex(index, x * x + y * y + z * z <= radius * radius ? 1 : 0);
+          }
+    }
+
+    m_Controller->SetCurrentInterpolationSession(segmentation);
+    m_Controller->SetMinSpacing(1.0);
+    m_Controller->SetMaxSpacing(1.0);
+    m_Controller->SetDistanceImageVolume(50000);
+
+    // A sagittal and an axial contour span the bounds of the sphere, the axial contours between them do not change
+    // the size of the distance image
+    vtkSmartPointer<vtkRegularPolygonSource> polygonSource = vtkSmartPointer<vtkRegularPolygonSource>::New();
+    polygonSource->SetNumberOfSides(60);
+    polygonSource->SetCenter(center, center, center);
+    polygonSource->SetRadius(radius);
+    polygonSource->SetNormal(1.0, 0.0, 0.0);
+    polygonSource->Update();
+    mitk::Surface::Pointer contour = mitk::Surface::New();
+    contour->SetVtkPolyData(polygonSource->GetOutput());
+    m_Controller->AddNewContour(contour);
+
+    double totalSeconds = 0;
+    unsigned int numberOfMeasurements = 0;
+    for (int offset = 0; offset < 40; offset += 3)
+    {
+      for (int sign = 1; sign >= -1; sign -= 2)
+      {
+        if (offset == 0 && sign == -1)
+          continue;
+
+        polygonSource = vtkSmartPointer<vtkRegularPolygonSource>::New();
+        polygonSource->SetNumberOfSides(60);
+        polygonSource->SetCenter(center, center, center + sign * offset);
+        polygonSource->SetRadius(std::sqrt(radius * radius - offset * offset));
+        polygonSource->SetNormal(0.0, 0.0, 1.0);
+        polygonSource->Update();
+        contour = mitk::Surface::New();
+        contour->SetVtkPolyData(polygonSource->GetOutput());
+
+        auto start = std::chrono::steady_clock::now();
+        m_Controller->AddNewContour(contour);
+        m_Controller->Interpolate();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        MITK_INFO << m_Controller->GetNumberOfContours() << " contours: " << seconds * 1000.0 << " ms";
+        CPPUNIT_ASSERT(m_Controller->GetInterpolationResult().IsNotNull());
+
+        // The first interpolation solves the whole system
+        if (m_Controller->GetNumberOfContours() > 2)
+        {
+          totalSeconds += seconds;
+          ++numberOfMeasurements;
+        }
+      }
+    }
+
+    MITK_INFO << "Mean latency of adding a contour: " << totalSeconds * 1000.0 / numberOfMeasurements << " ms";
+
+    m_Controller->RemoveInterpolationSession(segmentation);
+  }
+
   void TestSetCurrentInterpolationSession4D()
   {
     /*unsigned int testDimensions[] = {10, 10, 10, 5};
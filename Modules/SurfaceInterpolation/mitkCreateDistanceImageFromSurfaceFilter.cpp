@@ -26,7 +26,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkImageRegionIteratorWithIndex.h"
 #include "itkNeighborhoodIterator.h"
 
+#include <algorithm>
+#include <map>
 #include <queue>
+#include <set>
 
 void mitk::CreateDistanceImageFromSurfaceFilter::CreateEmptyDistanceImage()
 {
@@ -109,10 +112,12 @@ void mitk::CreateDistanceImageFromSurfaceFilter::CreateEmptyDistanceImage()
 }
 
 mitk::CreateDistanceImageFromSurfaceFilter::CreateDistanceImageFromSurfaceFilter()
+  : m_IncrementalUpdate(false), m_LastUpdateWasIncremental(false)
 {
   m_DistanceImageVolume = 50000;
   this->m_UseProgressBar = false;
   this->m_ProgressStepSize = 5;
+  m_SolvedSystem.Spacing = 0.0;
 
   mitk::Image::Pointer output = mitk::Image::New();
   this->SetNthOutput(0, output.GetPointer());
@@ -127,19 +132,46 @@ void mitk::CreateDistanceImageFromSurfaceFilter::GenerateData()
   this->PreprocessContourPoints();
   this->CreateEmptyDistanceImage();
 
-  // First of all we have to build the equation-system from the existing contour-edge-points
-  this->CreateSolutionMatrixAndFunctionValues();
+  // The distance function is zero at the contour points, so the narrowband starts at the first one
+  PointType seedPoint = m_Centers.at(0);
+
+  m_LastUpdateWasIncremental = m_IncrementalUpdate && this->UpdateSolutionIncrementally();
+
+  if (!m_LastUpdateWasIncremental)
+  {
+    // First of all we have to build the equation-system from the existing contour-edge-points
+    this->CreateSolutionMatrixAndFunctionValues();
+  }
 
   if (this->m_UseProgressBar)
     mitk::ProgressBar::GetInstance()->Progress(1);
 
-  m_Weights = m_SolutionMatrix.partialPivLu().solve(m_FunctionValues);
+  if (!m_LastUpdateWasIncremental && m_IncrementalUpdate)
+  {
+    // Keep the decomposition for the next update, the matrix itself is not needed anymore
+    Eigen::PartialPivLU<Eigen::MatrixXd> decomposition(m_SolutionMatrix);
+    m_SolutionMatrix.resize(0, 0);
+    m_Weights = decomposition.solve(m_FunctionValues);
+    m_SolvedSystem.MatrixLU = decomposition.matrixLU();
+    m_SolvedSystem.RowPermutation = decomposition.permutationP().indices();
+    this->StoreSolvedSystem();
+  }
+  else if (!m_LastUpdateWasIncremental)
+  {
+    m_Weights = m_SolutionMatrix.partialPivLu().solve(m_FunctionValues);
+  }
 
   if (this->m_UseProgressBar)
     mitk::ProgressBar::GetInstance()->Progress(2);
 
+  m_CenterMatrix.resize(3, m_Centers.size());
+  for (unsigned int i = 0; i < m_Centers.size(); ++i)
+  {
+    m_CenterMatrix.col(i) << m_Centers[i][0], m_Centers[i][1], m_Centers[i][2];
+  }
+
   // The last step is to create the distance map with the interpolated distance function
-  this->FillDistanceImage();
+  this->FillDistanceImage(seedPoint);
 
   if (this->m_UseProgressBar)
     mitk::ProgressBar::GetInstance()->Progress(2);
@@ -172,6 +204,8 @@ void mitk::CreateDistanceImageFromSurfaceFilter::PreprocessContourPoints()
   PointType currentPoint;
   PointType normal;
 
+  std::set<std::array<double, 3>> contourPoints;
+
   for (unsigned int i = 0; i < numberOfInputs; i++)
   {
     currentSurface = const_cast<Surface *>(this->GetInput(i));
@@ -203,9 +237,9 @@ void mitk::CreateDistanceImageFromSurfaceFilter::PreprocessContourPoints()
 
         currentPoint.copy_in(p);
 
-        int count = std::count(m_Centers.begin(), m_Centers.end(), currentPoint);
+        std::array<double, 3> contourPoint = {{p[0], p[1], p[2]}};
 
-        if (count == 0)
+        if (contourPoints.insert(contourPoint).second)
         {
           double currentNormal[3];
           currentCellNormals->GetTuple(cell[j], currentNormal);
@@ -290,7 +324,7 @@ void mitk::CreateDistanceImageFromSurfaceFilter::CreateSolutionMatrixAndFunction
   }
 }
 
-void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
+void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage(const PointType &seedPoint)
 {
   /*
   * Now we must calculate the distance for each pixel. But instead of calculating the distance value
@@ -307,7 +341,7 @@ void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
   typedef itk::NeighborhoodIterator<DistanceImageType> NeighborhoodImageIterator;
 
   std::queue<DistanceImageType::IndexType> narrowbandPoints;
-  PointType currentPoint = m_Centers.at(0);
+  PointType currentPoint = seedPoint;
   double distance = this->CalculateDistanceValue(currentPoint);
 
   // create itk::Point from vnl_vector
@@ -425,23 +459,204 @@ void mitk::CreateDistanceImageFromSurfaceFilter::FillDistanceImage()
 
 double mitk::CreateDistanceImageFromSurfaceFilter::CalculateDistanceValue(PointType p)
 {
-  double distanceValue(0);
-  PointType p1;
-  PointType p2;
-  double norm;
+  // Sum of the weighted RBF values Phi(r) = r for all centers
+  Eigen::Vector3d point(p[0], p[1], p[2]);
+  return (m_CenterMatrix.colwise() - point).colwise().norm().dot(m_Weights.transpose());
+}
 
-  CenterList::iterator centerIter;
+bool mitk::CreateDistanceImageFromSurfaceFilter::UpdateSolutionIncrementally()
+{
+  // The inner and outer centers are moved by the spacing, i.e. all of them change with the spacing
+  if (m_SolvedSystem.Centers.empty() || m_SolvedSystem.Spacing != m_DistanceImageSpacing)
+    return false;
 
-  unsigned int count(0);
-  for (centerIter = m_Centers.begin(); centerIter != m_Centers.end(); centerIter++)
+  std::map<CenterKey, unsigned int> contourPoints;
+  for (unsigned int i = 0; i < m_Centers.size(); ++i)
   {
-    p1 = *centerIter;
-    p2 = p - p1;
-    norm = p2.two_norm();
-    distanceValue = distanceValue + (norm * m_Weights[count]);
-    ++count;
+    CenterKey key = {
+      {m_Centers[i][0], m_Centers[i][1], m_Centers[i][2], m_Normals[i][0], m_Normals[i][1], m_Normals[i][2]}};
+    contourPoints.insert(std::make_pair(key, i));
   }
-  return distanceValue;
+
+  // The decomposition is kept up to the first block with a center of a removed contour point
+  unsigned int numberOfKeptCenters = m_SolvedSystem.Centers.size();
+  for (unsigned int i = 0; i < m_SolvedSystem.Keys.size(); ++i)
+  {
+    if (contourPoints.count(m_SolvedSystem.Keys[i]) == 0)
+    {
+      numberOfKeptCenters =
+        *(std::upper_bound(m_SolvedSystem.BlockStarts.begin(), m_SolvedSystem.BlockStarts.end(), i) - 1);
+      break;
+    }
+  }
+
+  // The centers of the later blocks that still exist are appended again, followed by the new contour points
+  CenterList addedCenters;
+  std::vector<CenterKey> addedKeys;
+  std::vector<double> addedFunctionValues;
+  for (unsigned int i = numberOfKeptCenters; i < m_SolvedSystem.Keys.size(); ++i)
+  {
+    if (contourPoints.count(m_SolvedSystem.Keys[i]) != 0)
+    {
+      addedCenters.push_back(m_SolvedSystem.Centers[i]);
+      addedKeys.push_back(m_SolvedSystem.Keys[i]);
+      addedFunctionValues.push_back(m_SolvedSystem.FunctionValues[i]);
+    }
+  }
+
+  std::set<CenterKey> solvedKeys(m_SolvedSystem.Keys.begin(), m_SolvedSystem.Keys.end());
+  for (auto contourPoint = contourPoints.begin(); contourPoint != contourPoints.end(); ++contourPoint)
+  {
+    if (solvedKeys.count(contourPoint->first) != 0)
+      continue;
+
+    // The contour point itself and its inner and outer point, like in CreateSolutionMatrixAndFunctionValues()
+    PointType point = m_Centers[contourPoint->second];
+    PointType normal = m_Normals[contourPoint->second];
+    addedCenters.push_back(point);
+    addedFunctionValues.push_back(0.0);
+    addedCenters.push_back(point - normal * m_DistanceImageSpacing);
+    addedFunctionValues.push_back(-m_DistanceImageSpacing);
+    addedCenters.push_back(point + normal * m_DistanceImageSpacing);
+    addedFunctionValues.push_back(m_DistanceImageSpacing);
+    addedKeys.insert(addedKeys.end(), 3, contourPoint->first);
+  }
+
+  // Appending k centers costs O(n^2 k), solving the whole system O(n^3)
+  if (numberOfKeptCenters == 0 || 2 * addedCenters.size() > numberOfKeptCenters + addedCenters.size())
+    return false;
+
+  this->TruncateSolvedSystem(numberOfKeptCenters);
+
+  if (!addedCenters.empty())
+    this->AddCentersToSolvedSystem(addedCenters, addedKeys, addedFunctionValues);
+
+  Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic> permutation(m_SolvedSystem.RowPermutation);
+  m_Weights = permutation * m_SolvedSystem.FunctionValues;
+  m_SolvedSystem.MatrixLU.triangularView<Eigen::UnitLower>().solveInPlace(m_Weights);
+  m_SolvedSystem.MatrixLU.triangularView<Eigen::Upper>().solveInPlace(m_Weights);
+
+  // The blocks are pivoted on their own only, so the solution has to be checked
+  unsigned int numberOfCenters = m_SolvedSystem.Centers.size();
+  Eigen::Matrix<double, 3, Eigen::Dynamic> centers(3, numberOfCenters);
+  for (unsigned int i = 0; i < numberOfCenters; ++i)
+  {
+    centers.col(i) << m_SolvedSystem.Centers[i][0], m_SolvedSystem.Centers[i][1], m_SolvedSystem.Centers[i][2];
+  }
+
+  double squaredResidual(0);
+  for (unsigned int i = 0; i < numberOfCenters; ++i)
+  {
+    double residual = (centers.colwise() - centers.col(i)).colwise().norm().dot(m_Weights.transpose()) -
+                      m_SolvedSystem.FunctionValues[i];
+    squaredResidual += residual * residual;
+  }
+
+  if (std::sqrt(squaredResidual) > 1e-6 * m_SolvedSystem.FunctionValues.norm())
+  {
+    MITK_DEBUG << "mitk::CreateDistanceImageFromSurfaceFilter: Residual of the updated solution is too large, the "
+                  "equation system is solved again.";
+    this->ResetIncrementalUpdate();
+    return false;
+  }
+
+  m_Centers = m_SolvedSystem.Centers;
+  m_FunctionValues = m_SolvedSystem.FunctionValues;
+  return true;
+}
+
+void mitk::CreateDistanceImageFromSurfaceFilter::StoreSolvedSystem()
+{
+  // The inner and outer centers follow the contour points in the same order
+  unsigned int numberOfContourPoints = m_Normals.size();
+
+  m_SolvedSystem.Centers = m_Centers;
+  m_SolvedSystem.Keys.resize(m_Centers.size());
+  for (unsigned int i = 0; i < m_Centers.size(); ++i)
+  {
+    const PointType &point = m_Centers[i % numberOfContourPoints];
+    const PointType &normal = m_Normals[i % numberOfContourPoints];
+    CenterKey key = {{point[0], point[1], point[2], normal[0], normal[1], normal[2]}};
+    m_SolvedSystem.Keys[i] = key;
+  }
+  m_SolvedSystem.BlockStarts.assign(1, 0);
+  m_SolvedSystem.FunctionValues = m_FunctionValues;
+  m_SolvedSystem.Spacing = m_DistanceImageSpacing;
+}
+
+void mitk::CreateDistanceImageFromSurfaceFilter::TruncateSolvedSystem(unsigned int numberOfCenters)
+{
+  if (numberOfCenters == m_SolvedSystem.Centers.size())
+    return;
+
+  // The factors of the leading blocks do not depend on the later ones
+  Eigen::MatrixXd matrixLU = m_SolvedSystem.MatrixLU.topLeftCorner(numberOfCenters, numberOfCenters);
+  m_SolvedSystem.MatrixLU.swap(matrixLU);
+  m_SolvedSystem.RowPermutation.conservativeResize(numberOfCenters);
+  m_SolvedSystem.FunctionValues.conservativeResize(numberOfCenters);
+  m_SolvedSystem.Centers.resize(numberOfCenters);
+  m_SolvedSystem.Keys.resize(numberOfCenters);
+  m_SolvedSystem.BlockStarts.erase(
+    std::lower_bound(m_SolvedSystem.BlockStarts.begin(), m_SolvedSystem.BlockStarts.end(), numberOfCenters),
+    m_SolvedSystem.BlockStarts.end());
+}
+
+void mitk::CreateDistanceImageFromSurfaceFilter::AddCentersToSolvedSystem(const CenterList &centers,
+                                                                          const std::vector<CenterKey> &keys,
+                                                                          const std::vector<double> &functionValues)
+{
+  unsigned int numberOfSolvedCenters = m_SolvedSystem.Centers.size();
+  unsigned int numberOfNewCenters = centers.size();
+
+  // The columns of the new centers, the matrix is symmetric
+  Eigen::MatrixXd coupling(numberOfSolvedCenters, numberOfNewCenters);
+  Eigen::MatrixXd newBlock(numberOfNewCenters, numberOfNewCenters);
+  for (unsigned int j = 0; j < numberOfNewCenters; ++j)
+  {
+    for (unsigned int i = 0; i < numberOfSolvedCenters; ++i)
+      coupling(i, j) = (m_SolvedSystem.Centers[i] - centers[j]).two_norm();
+    for (unsigned int i = 0; i < numberOfNewCenters; ++i)
+      newBlock(i, j) = (centers[i] - centers[j]).two_norm();
+  }
+
+  // Bordered decomposition: the upper right block of U is L^-1 P B, the lower left block of L is B^T U^-1
+  // and the new diagonal block is the decomposition of the Schur complement C - B^T A^-1 B
+  Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic> permutation(m_SolvedSystem.RowPermutation);
+  Eigen::MatrixXd upperBlock = permutation * coupling;
+  m_SolvedSystem.MatrixLU.triangularView<Eigen::UnitLower>().solveInPlace(upperBlock);
+  m_SolvedSystem.MatrixLU.triangularView<Eigen::Upper>().transpose().solveInPlace(coupling);
+  Eigen::PartialPivLU<Eigen::MatrixXd> schurComplement(newBlock - coupling.transpose() * upperBlock);
+
+  unsigned int numberOfCenters = numberOfSolvedCenters + numberOfNewCenters;
+  Eigen::MatrixXd matrixLU(numberOfCenters, numberOfCenters);
+  matrixLU.topLeftCorner(numberOfSolvedCenters, numberOfSolvedCenters) = m_SolvedSystem.MatrixLU;
+  matrixLU.topRightCorner(numberOfSolvedCenters, numberOfNewCenters) = upperBlock;
+  matrixLU.bottomLeftCorner(numberOfNewCenters, numberOfSolvedCenters) =
+    schurComplement.permutationP() * coupling.transpose();
+  matrixLU.bottomRightCorner(numberOfNewCenters, numberOfNewCenters) = schurComplement.matrixLU();
+  m_SolvedSystem.MatrixLU.swap(matrixLU);
+
+  m_SolvedSystem.RowPermutation.conservativeResize(numberOfCenters);
+  m_SolvedSystem.RowPermutation.tail(numberOfNewCenters) =
+    schurComplement.permutationP().indices().array() + static_cast<int>(numberOfSolvedCenters);
+
+  m_SolvedSystem.BlockStarts.push_back(numberOfSolvedCenters);
+  m_SolvedSystem.Centers.insert(m_SolvedSystem.Centers.end(), centers.begin(), centers.end());
+  m_SolvedSystem.Keys.insert(m_SolvedSystem.Keys.end(), keys.begin(), keys.end());
+  m_SolvedSystem.FunctionValues.conservativeResize(numberOfCenters);
+  for (unsigned int i = 0; i < numberOfNewCenters; ++i)
+    m_SolvedSystem.FunctionValues[numberOfSolvedCenters + i] = functionValues[i];
+}
+
+void mitk::CreateDistanceImageFromSurfaceFilter::ResetIncrementalUpdate()
+{
+  m_SolvedSystem.Centers.clear();
+  m_SolvedSystem.Keys.clear();
+  m_SolvedSystem.BlockStarts.clear();
+  m_SolvedSystem.FunctionValues.resize(0);
+  m_SolvedSystem.MatrixLU.resize(0, 0);
+  m_SolvedSystem.RowPermutation.resize(0);
+  m_SolvedSystem.Spacing = 0.0;
 }
 
 void mitk::CreateDistanceImageFromSurfaceFilter::GenerateOutputInformation()
@@ -29,6 +29,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <Eigen/Dense>
 
+#include <array>
+
 namespace mitk
 {
   /**
@@ -61,6 +63,13 @@ namespace mitk
          adjusted by calling SetDistanceImageVolume(unsigned int volume) which specifies the number ob pixels enclosed
   by the image.
 
+         If incremental updates are switched on (SetIncrementalUpdate()), the filter keeps the LU decomposition of
+         the interpolation matrix. As long as the spacing of the distance image does not change, the centers of new
+         contour points are appended to the decomposition as a new block, which costs O(n^2 k) instead of O(n^3)
+         for k new centers. If contour points were removed, the decomposition is truncated before the first block
+         that contains one of their centers and the remaining centers of the later blocks are appended again.
+         If the residual of the updated solution is too large, the system is solved from scratch.
+
   \ingroup Process
 
   $Author: fetzer$
@@ -124,6 +133,25 @@ namespace mitk
 
     void SetReferenceImage(itk::ImageBase<3>::Pointer referenceImage);
 
+    /**
+      \brief Set whether the interpolation matrix should be updated incrementally between two updates
+
+      The decomposition is kept by Reset(), use ResetIncrementalUpdate() to release it.
+    */
+    itkSetMacro(IncrementalUpdate, bool);
+    itkGetMacro(IncrementalUpdate, bool);
+    itkBooleanMacro(IncrementalUpdate);
+
+    /**
+      \brief Returns true if the weights of the last update were computed by updating the previous solution
+    */
+    itkGetMacro(LastUpdateWasIncremental, bool);
+
+    /**
+      \brief Discards the equation system which is kept for incremental updates
+    */
+    void ResetIncrementalUpdate();
+
   protected:
     CreateDistanceImageFromSurfaceFilter();
     virtual ~CreateDistanceImageFromSurfaceFilter();
@@ -131,10 +159,45 @@ namespace mitk
     virtual void GenerateOutputInformation() override;
 
   private:
+    /** A surface point and its normal, all centers created for this point share the key */
+    typedef std::array<double, 6> CenterKey;
+
+    /**
+    * The LU decomposition of the solved equation system, which is updated by incremental updates.
+    * Its blocks are the centers that were appended together, each block is pivoted on its own.
+    */
+    struct SolvedSystem
+    {
+      CenterList Centers;
+      std::vector<CenterKey> Keys;
+      std::vector<unsigned int> BlockStarts;
+      Eigen::VectorXd FunctionValues;
+      Eigen::MatrixXd MatrixLU;
+      Eigen::VectorXi RowPermutation;
+      double Spacing;
+    };
+
     void CreateSolutionMatrixAndFunctionValues();
     double CalculateDistanceValue(PointType p);
 
-    void FillDistanceImage();
+    /**
+    * \brief Solves the equation system by updating the solved system of the last update. Returns false if this
+    * is not possible or more expensive than solving the whole system.
+    */
+    bool UpdateSolutionIncrementally();
+
+    /** \brief Stores the centers and function values of the solved system for the next update */
+    void StoreSolvedSystem();
+
+    /** \brief Keeps the given number of leading centers of the solved system, which has to be a block start */
+    void TruncateSolvedSystem(unsigned int numberOfCenters);
+
+    /** \brief Appends the given centers as a new block to the solved system */
+    void AddCentersToSolvedSystem(const CenterList &centers,
+                                  const std::vector<CenterKey> &keys,
+                                  const std::vector<double> &functionValues);
+
+    void FillDistanceImage(const PointType &seedPoint);
 
     /**
     * \brief This method fills the given variables with the minimum and
@@ -166,6 +229,13 @@ namespace mitk
     Eigen::VectorXd m_FunctionValues;
     Eigen::VectorXd m_Weights;
 
+    // The centers as columns of a matrix for the evaluation of the distance function
+    Eigen::Matrix<double, 3, Eigen::Dynamic> m_CenterMatrix;
+
+    bool m_IncrementalUpdate;
+    bool m_LastUpdateWasIncremental;
+    SolvedSystem m_SolvedSystem;
+
     DistanceImageType::Pointer m_DistanceImageITK;
     itk::ImageBase<3>::Pointer m_ReferenceImage;
 
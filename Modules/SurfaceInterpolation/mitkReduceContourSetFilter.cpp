@@ -16,9 +16,21 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkReduceContourSetFilter.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+struct mitk::ReduceContourSetFilter::ReductionScheduler
+{
+  std::vector<vtkPolyData *> Inputs;
+  std::vector<vtkSmartPointer<vtkPolyData>> Outputs;
+  std::vector<unsigned int> NumberOfPointsAfterReduction;
+  std::atomic<unsigned int> NextInput;
+  ReduceContourSetFilter *Filter;
+};
+
 mitk::ReduceContourSetFilter::ReduceContourSetFilter()
 {
-  m_MaxSegmentLenght = 0;
   m_StepSize = 10;
   m_Tolerance = -1;
   m_ReductionType = DOUGLAS_PEUCKER;
@@ -52,73 +64,62 @@ void mitk::ReduceContourSetFilter::GenerateData()
   unsigned int numberOfInputs = this->GetNumberOfIndexedInputs();
   unsigned int numberOfOutputs(0);
 
-  vtkSmartPointer<vtkPolyData> newPolyData;
-  vtkSmartPointer<vtkCellArray> newPolygons;
-  vtkSmartPointer<vtkPoints> newPoints;
-
   // For the purpose of evaluation
   //  unsigned int numberOfPointsBefore (0);
   m_NumberOfPointsAfterReduction = 0;
 
-  for (unsigned int i = 0; i < numberOfInputs; i++)
+  // First of all set tolerance if none is specified, before the inputs are reduced in parallel
+  if (m_ReductionType == DOUGLAS_PEUCKER && m_Tolerance < 0)
   {
-    mitk::Surface *currentSurface = const_cast<mitk::Surface *>(this->GetInput(i));
-    vtkSmartPointer<vtkPolyData> polyData = currentSurface->GetVtkPolyData();
-
-    newPolyData = vtkSmartPointer<vtkPolyData>::New();
-    newPolygons = vtkSmartPointer<vtkCellArray>::New();
-    newPoints = vtkSmartPointer<vtkPoints>::New();
-
-    vtkSmartPointer<vtkCellArray> existingPolys = polyData->GetPolys();
-
-    vtkSmartPointer<vtkPoints> existingPoints = polyData->GetPoints();
-
-    existingPolys->InitTraversal();
-
-    vtkIdType *cell(nullptr);
-    vtkIdType cellSize(0);
-
-    for (existingPolys->InitTraversal(); existingPolys->GetNextCell(cellSize, cell);)
+    if (m_MaxSpacing > 0)
+    {
+      m_Tolerance = m_MinSpacing;
+    }
+    else
     {
-      bool incorporatePolygon =
-        this->CheckForIntersection(cell, cellSize, existingPoints, /*numberOfIntersections, intersectionPoints, */ i);
-      if (!incorporatePolygon)
-        continue;
+      m_Tolerance = 1.5;
+    }
+  }
 
-      vtkSmartPointer<vtkPolygon> newPolygon = vtkSmartPointer<vtkPolygon>::New();
+  this->BuildPlaneIndex();
 
-      if (m_ReductionType == NTH_POINT)
-      {
-        this->ReduceNumberOfPointsByNthPoint(cellSize, cell, existingPoints, newPolygon, newPoints);
-        if (newPolygon->GetPointIds()->GetNumberOfIds() != 0)
-        {
-          newPolygons->InsertNextCell(newPolygon);
-        }
-      }
-      else if (m_ReductionType == DOUGLAS_PEUCKER)
-      {
-        this->ReduceNumberOfPointsByDouglasPeucker(cellSize, cell, existingPoints, newPolygon, newPoints);
-        if (newPolygon->GetPointIds()->GetNumberOfIds() > 3)
-        {
-          newPolygons->InsertNextCell(newPolygon);
-        }
-      }
+  ReductionScheduler scheduler;
+  scheduler.Filter = this;
+  scheduler.NextInput = 0;
+  for (unsigned int i = 0; i < numberOfInputs; i++)
+  {
+    mitk::Surface *currentSurface = const_cast<mitk::Surface *>(this->GetInput(i));
+    scheduler.Inputs.push_back(currentSurface->GetVtkPolyData());
+  }
+  scheduler.Outputs.resize(numberOfInputs);
+  scheduler.NumberOfPointsAfterReduction.resize(numberOfInputs, 0);
 
-      // Again for evaluation
-      //      numberOfPointsBefore += cellSize;
-      m_NumberOfPointsAfterReduction += newPolygon->GetPointIds()->GetNumberOfIds();
-    }
+  // Each output only depends on its own input and the planes of the other inputs
+  unsigned int numberOfThreads =
+    std::min<unsigned int>(numberOfInputs, itk::MultiThreader::GetGlobalDefaultNumberOfThreads());
+  if (numberOfThreads > 1)
+  {
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetSingleMethod(ReductionThreadCallback, &scheduler);
+    threader->SingleMethodExecute();
+  }
+  else
+  {
+    this->ReduceInputs(&scheduler);
+  }
 
-    if (newPolygons->GetNumberOfCells() != 0)
-    {
-      newPolyData->SetPolys(newPolygons);
-      newPolyData->SetPoints(newPoints);
-      newPolyData->BuildLinks();
+  for (unsigned int i = 0; i < numberOfInputs; i++)
+  {
+    // Again for evaluation
+    m_NumberOfPointsAfterReduction += scheduler.NumberOfPointsAfterReduction[i];
 
+    if (scheduler.Outputs[i] != nullptr)
+    {
       this->SetNumberOfIndexedOutputs(numberOfOutputs + 1);
       mitk::Surface::Pointer surface = mitk::Surface::New();
       this->SetNthOutput(numberOfOutputs, surface.GetPointer());
-      surface->SetVtkPolyData(newPolyData);
+      surface->SetVtkPolyData(scheduler.Outputs[i]);
       numberOfOutputs++;
     }
   }
@@ -137,6 +138,80 @@ void mitk::ReduceContourSetFilter::GenerateData()
     mitk::ProgressBar::GetInstance()->Progress(this->m_ProgressStepSize);
 }
 
+ITK_THREAD_RETURN_TYPE mitk::ReduceContourSetFilter::ReductionThreadCallback(void *arg)
+{
+  itk::MultiThreader::ThreadInfoStruct *info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+  ReductionScheduler *scheduler = static_cast<ReductionScheduler *>(info->UserData);
+  scheduler->Filter->ReduceInputs(scheduler);
+  return ITK_THREAD_RETURN_VALUE;
+}
+
+void mitk::ReduceContourSetFilter::ReduceInputs(ReductionScheduler *scheduler)
+{
+  unsigned int numberOfInputs = scheduler->Inputs.size();
+  for (unsigned int i = scheduler->NextInput++; i < numberOfInputs; i = scheduler->NextInput++)
+  {
+    scheduler->Outputs[i] = this->ReduceInput(i, scheduler->Inputs[i], scheduler->NumberOfPointsAfterReduction[i]);
+  }
+}
+
+vtkSmartPointer<vtkPolyData> mitk::ReduceContourSetFilter::ReduceInput(unsigned int inputIndex,
+                                                                      vtkPolyData *polyData,
+                                                                      unsigned int &numberOfPointsAfterReduction)
+{
+  vtkSmartPointer<vtkPolyData> newPolyData = vtkSmartPointer<vtkPolyData>::New();
+  vtkSmartPointer<vtkCellArray> newPolygons = vtkSmartPointer<vtkCellArray>::New();
+  vtkSmartPointer<vtkPoints> newPoints = vtkSmartPointer<vtkPoints>::New();
+
+  vtkSmartPointer<vtkCellArray> existingPolys = polyData->GetPolys();
+
+  vtkSmartPointer<vtkPoints> existingPoints = polyData->GetPoints();
+
+  vtkIdType *cell(nullptr);
+  vtkIdType cellSize(0);
+
+  numberOfPointsAfterReduction = 0;
+
+  for (existingPolys->InitTraversal(); existingPolys->GetNextCell(cellSize, cell);)
+  {
+    bool incorporatePolygon = this->CheckForIntersection(
+      cell, cellSize, existingPoints, /*numberOfIntersections, intersectionPoints, */ inputIndex);
+    if (!incorporatePolygon)
+      continue;
+
+    vtkSmartPointer<vtkPolygon> newPolygon = vtkSmartPointer<vtkPolygon>::New();
+
+    if (m_ReductionType == NTH_POINT)
+    {
+      this->ReduceNumberOfPointsByNthPoint(cellSize, cell, existingPoints, newPolygon, newPoints);
+      if (newPolygon->GetPointIds()->GetNumberOfIds() != 0)
+      {
+        newPolygons->InsertNextCell(newPolygon);
+      }
+    }
+    else if (m_ReductionType == DOUGLAS_PEUCKER)
+    {
+      this->ReduceNumberOfPointsByDouglasPeucker(cellSize, cell, existingPoints, newPolygon, newPoints);
+      if (newPolygon->GetPointIds()->GetNumberOfIds() > 3)
+      {
+        newPolygons->InsertNextCell(newPolygon);
+      }
+    }
+
+    // Again for evaluation
+    //      numberOfPointsBefore += cellSize;
+    numberOfPointsAfterReduction += newPolygon->GetPointIds()->GetNumberOfIds();
+  }
+
+  if (newPolygons->GetNumberOfCells() == 0)
+    return nullptr;
+
+  newPolyData->SetPolys(newPolygons);
+  newPolyData->SetPoints(newPoints);
+  newPolyData->BuildLinks();
+  return newPolyData;
+}
+
 void mitk::ReduceContourSetFilter::ReduceNumberOfPointsByNthPoint(
   vtkIdType cellSize, vtkIdType *cell, vtkPoints *points, vtkPolygon *reducedPolygon, vtkPoints *reducedPoints)
 {
@@ -212,19 +287,6 @@ void mitk::ReduceContourSetFilter::ReduceNumberOfPointsByDouglasPeucker(
   reduced ones
   */
 
-  // First of all set tolerance if none is specified
-  if (m_Tolerance < 0)
-  {
-    if (m_MaxSpacing > 0)
-    {
-      m_Tolerance = m_MinSpacing;
-    }
-    else
-    {
-      m_Tolerance = 1.5;
-    }
-  }
-
   std::stack<LineSegment> lineSegments;
 
   // 1. Divide in line segments
@@ -314,10 +376,6 @@ void mitk::ReduceContourSetFilter::ReduceNumberOfPointsByDouglasPeucker(
     {
       // double temp[3];
       int segmentLenght = currentSegment.EndIndex - currentSegment.StartIndex;
-      if (segmentLenght > (int)m_MaxSegmentLenght)
-      {
-        m_MaxSegmentLenght = (unsigned int)segmentLenght;
-      }
 
       //      MITK_INFO<<"Lenght: "<<abs(segmentLenght);
       if (abs(segmentLenght) > 25)
@@ -355,33 +413,21 @@ void mitk::ReduceContourSetFilter::ReduceNumberOfPointsByDouglasPeucker(
   }
 }
 
-bool mitk::ReduceContourSetFilter::CheckForIntersection(
-  vtkIdType *currentCell,
-  vtkIdType currentCellSize,
-  vtkPoints *currentPoints,
-  /* vtkIdType numberOfIntersections, vtkIdType* intersectionPoints,*/ unsigned int currentInputIndex)
+void mitk::ReduceContourSetFilter::BuildPlaneIndex()
 {
-  /*
-  If we check the current cell for intersections then we have to consider three possibilies:
-  1. There is another cell among all the other input surfaces which intersects the current polygon:
-  - That means we have to save the intersection points because these points should not be eliminated
-  2. There current polygon exists just because of an intersection of another polygon with the current plane defined by
-  the current polygon
-  - That means the current polygon should not be incorporated and all of its points should be eliminated
-  3. There is no intersection
-  - That mean we can just reduce the current polygons points without considering any intersections
-  */
+  m_InputPlanes.clear();
+  m_ObliquePlanes.clear();
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    m_AxisAlignedPlanes[axis].clear();
+    m_MaximumPlaneTilt[axis] = 0.0;
+  }
 
   for (unsigned int i = 0; i < this->GetNumberOfIndexedInputs(); i++)
   {
-    // Don't check for intersection with the polygon itself
-    if (i == currentInputIndex)
-      continue;
-
     // Get the next polydata to check for intersection
     vtkSmartPointer<vtkPolyData> poly = const_cast<Surface *>(this->GetInput(i))->GetVtkPolyData();
     vtkSmartPointer<vtkCellArray> polygonArray = poly->GetPolys();
-    polygonArray->InitTraversal();
     vtkIdType anotherInputPolygonSize(0);
     vtkIdType *anotherInputPolygonIDs(nullptr);
 
@@ -391,102 +437,222 @@ bool mitk::ReduceContourSetFilter::CheckForIntersection(
     - Calculate the distance of each point of the current polygon to the plane
     - If the maximum distance is not bigger than 1.5 of the maximum spacing AND the minimal distance is not bigger
     than 0.5 of the minimum spacing then the current contour is an intersection contour
+
+    Because we are considering the plane defined by the acual input polygon only the first cell is used
     */
 
-    for (polygonArray->InitTraversal(); polygonArray->GetNextCell(anotherInputPolygonSize, anotherInputPolygonIDs);)
+    polygonArray->InitTraversal();
+    if (!polygonArray->GetNextCell(anotherInputPolygonSize, anotherInputPolygonIDs))
+      continue;
+
+    // Choosing three plane points to calculate the plane vectors
+    double p1[3];
+    double p2[3];
+    double p3[3];
+
+    // The plane vectors
+    double v1[3];
+    double v2[3] = {0};
+
+    InputPlane plane;
+    plane.InputIndex = i;
+
+    // Create first Vector
+    poly->GetPoint(anotherInputPolygonIDs[0], p1);
+    poly->GetPoint(anotherInputPolygonIDs[1], p2);
+
+    v1[0] = p2[0] - p1[0];
+    v1[1] = p2[1] - p1[1];
+    v1[2] = p2[2] - p1[2];
+
+    // Find 3rd point for 2nd vector (The angle between the two plane vectors should be bigger than 30 degrees)
+    for (vtkIdType j = 2; j < anotherInputPolygonSize; j++)
     {
-      // Choosing three plane points to calculate the plane vectors
-      double p1[3];
-      double p2[3];
-      double p3[3];
+      poly->GetPoint(anotherInputPolygonIDs[j], p3);
 
-      // The plane vectors
-      double v1[3];
-      double v2[3] = {0};
-      // The plane normal
-      double normal[3];
+      v2[0] = p3[0] - p1[0];
+      v2[1] = p3[1] - p1[1];
+      v2[2] = p3[2] - p1[2];
 
-      // Create first Vector
-      poly->GetPoint(anotherInputPolygonIDs[0], p1);
-      poly->GetPoint(anotherInputPolygonIDs[1], p2);
+      // Calculate the angle between the two vector for the current point
+      double dotV1V2 = vtkMath::Dot(v1, v2);
+      double absV1 = sqrt(vtkMath::Dot(v1, v1));
+      double absV2 = sqrt(vtkMath::Dot(v2, v2));
+      double cosV1V2 = dotV1V2 / (absV1 * absV2);
 
-      v1[0] = p2[0] - p1[0];
-      v1[1] = p2[1] - p1[1];
-      v1[2] = p2[2] - p1[2];
+      double arccos = acos(cosV1V2);
+      double degree = vtkMath::DegreesFromRadians(arccos);
 
-      // Find 3rd point for 2nd vector (The angle between the two plane vectors should be bigger than 30 degrees)
+      // If angle is bigger than 30 degrees break
+      if (degree > 30)
+        break;
 
-      double maxDistance(0);
-      double minDistance(10000);
+    } // for (to find 3rd point)
 
-      for (vtkIdType j = 2; j < anotherInputPolygonSize; j++)
-      {
-        poly->GetPoint(anotherInputPolygonIDs[j], p3);
+    // Calculate normal of the plane by taking the cross product of the two vectors
+    vtkMath::Cross(v1, v2, plane.Normal);
+    vtkMath::Normalize(plane.Normal);
+
+    // Determine position of the plane
+    plane.Lambda = vtkMath::Dot(plane.Normal, p1);
+
+    unsigned int planeIndex = m_InputPlanes.size();
+    m_InputPlanes.push_back(plane);
+
+    // Planes that are (almost) orthogonal to an axis are sorted by their position along it. Degenerated planes
+    // (zero or invalid normal) are oblique and always tested.
+    unsigned int axis = 0;
+    for (unsigned int d = 1; d < 3; ++d)
+    {
+      if (std::fabs(plane.Normal[d]) > std::fabs(plane.Normal[axis]))
+        axis = d;
+    }
+    double tilt = (std::fabs(plane.Normal[0]) + std::fabs(plane.Normal[1]) + std::fabs(plane.Normal[2])) /
+                    std::fabs(plane.Normal[axis]) -
+                  1.0;
+    if (tilt < 0.01)
+    {
+      m_AxisAlignedPlanes[axis].push_back(std::make_pair(plane.Lambda / plane.Normal[axis], planeIndex));
+      m_MaximumPlaneTilt[axis] = std::max(m_MaximumPlaneTilt[axis], tilt);
+    }
+    else
+    {
+      m_ObliquePlanes.push_back(planeIndex);
+    }
+  }
+
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    std::sort(m_AxisAlignedPlanes[axis].begin(), m_AxisAlignedPlanes[axis].end());
+  }
+}
+
+bool mitk::ReduceContourSetFilter::CheckForIntersection(
+  vtkIdType *currentCell,
+  vtkIdType currentCellSize,
+  vtkPoints *currentPoints,
+  /* vtkIdType numberOfIntersections, vtkIdType* intersectionPoints,*/ unsigned int currentInputIndex)
+{
+  /*
+  If we check the current cell for intersections then we have to consider three possibilies:
+  1. There is another cell among all the other input surfaces which intersects the current polygon:
+  - That means we have to save the intersection points because these points should not be eliminated
+  2. There current polygon exists just because of an intersection of another polygon with the current plane defined by
+  the current polygon
+  - That means the current polygon should not be incorporated and all of its points should be eliminated
+  3. There is no intersection
+  - That mean we can just reduce the current polygons points without considering any intersections
+  */
 
-        v2[0] = p3[0] - p1[0];
-        v2[1] = p3[1] - p1[1];
-        v2[2] = p3[2] - p1[2];
+  // An intersection contour has at least one point closer than 0.5 of the minimum spacing to the other plane
+  double maxMinDistance = 0.5 * m_MinSpacing;
+  if (!(maxMinDistance > 0) || currentCellSize == 0 || m_InputPlanes.empty())
+    return true;
 
-        // Calculate the angle between the two vector for the current point
-        double dotV1V2 = vtkMath::Dot(v1, v2);
-        double absV1 = sqrt(vtkMath::Dot(v1, v1));
-        double absV2 = sqrt(vtkMath::Dot(v2, v2));
-        double cosV1V2 = dotV1V2 / (absV1 * absV2);
+  std::vector<double> cellPoints(3 * currentCellSize);
+  double boundsMin[3];
+  double boundsMax[3];
+  for (vtkIdType k = 0; k < currentCellSize; k++)
+  {
+    double *currentPoint = &cellPoints[3 * k];
+    currentPoints->GetPoint(currentCell[k], currentPoint);
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      boundsMin[d] = k == 0 ? currentPoint[d] : std::min(boundsMin[d], currentPoint[d]);
+      boundsMax[d] = k == 0 ? currentPoint[d] : std::max(boundsMax[d], currentPoint[d]);
+    }
+  }
+
+  // Margin for rounding errors, the index only has to be conservative
+  const double margin = 1e-6;
 
-        double arccos = acos(cosV1V2);
-        double degree = vtkMath::DegreesFromRadians(arccos);
+  std::vector<unsigned int> candidates;
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    if (m_AxisAlignedPlanes[axis].empty())
+      continue;
+
+    // normal * x = lambda can be written as x[axis] + sum(normal[i] / normal[axis] * x[i]) = position, so the
+    // position of a plane close to the bounding box is within the box extended by the tilt times the other coordinates
+    double otherCoordinates(0);
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      if (d != axis)
+        otherCoordinates = std::max(otherCoordinates, std::max(std::fabs(boundsMin[d]), std::fabs(boundsMax[d])));
+    }
+    // |normal[axis]| >= 1 / (1 + tilt)
+    double extension =
+      maxMinDistance * (1.0 + m_MaximumPlaneTilt[axis]) + m_MaximumPlaneTilt[axis] * otherCoordinates + margin;
+
+    auto first = std::lower_bound(m_AxisAlignedPlanes[axis].begin(),
+                                  m_AxisAlignedPlanes[axis].end(),
+                                  std::make_pair(boundsMin[axis] - extension, 0u));
+    for (auto plane = first; plane != m_AxisAlignedPlanes[axis].end() && plane->first <= boundsMax[axis] + extension;
+         ++plane)
+    {
+      candidates.push_back(plane->second);
+    }
+  }
 
-        // If angle is bigger than 30 degrees break
-        if (degree > 30)
-          break;
+  for (unsigned int i = 0; i < m_ObliquePlanes.size(); ++i)
+  {
+    // Distance interval of the bounding box to the plane
+    const InputPlane &plane = m_InputPlanes[m_ObliquePlanes[i]];
+    double centerDistance(-plane.Lambda);
+    double radius(0);
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      centerDistance += plane.Normal[d] * 0.5 * (boundsMin[d] + boundsMax[d]);
+      radius += std::fabs(plane.Normal[d]) * 0.5 * (boundsMax[d] - boundsMin[d]);
+    }
+    if (centerDistance - radius >= maxMinDistance + margin || centerDistance + radius <= -maxMinDistance - margin)
+      continue;
 
-      } // for (to find 3rd point)
+    candidates.push_back(m_ObliquePlanes[i]);
+  }
 
-      // Calculate normal of the plane by taking the cross product of the two vectors
-      vtkMath::Cross(v1, v2, normal);
-      vtkMath::Normalize(normal);
+  for (unsigned int i = 0; i < candidates.size(); ++i)
+  {
+    const InputPlane &plane = m_InputPlanes[candidates[i]];
 
-      // Determine position of the plane
-      double lambda = vtkMath::Dot(normal, p1);
+    // Don't check for intersection with the polygon itself
+    if (plane.InputIndex == currentInputIndex)
+      continue;
 
-      /*
-      Calculate the distance to the plane for each point of the current polygon
-      If the distance is zero then save the currentPoint as intersection point
-      */
-      for (vtkIdType k = 0; k < currentCellSize; k++)
-      {
-        double currentPoint[3];
-        currentPoints->GetPoint(currentCell[k], currentPoint);
+    double maxDistance(0);
+    double minDistance(10000);
 
-        double tempPoint[3];
-        tempPoint[0] = normal[0] * currentPoint[0];
-        tempPoint[1] = normal[1] * currentPoint[1];
-        tempPoint[2] = normal[2] * currentPoint[2];
+    /*
+    Calculate the distance to the plane for each point of the current polygon
+    If the distance is zero then save the currentPoint as intersection point
+    */
+    for (vtkIdType k = 0; k < currentCellSize; k++)
+    {
+      const double *currentPoint = &cellPoints[3 * k];
 
-        double temp = tempPoint[0] + tempPoint[1] + tempPoint[2] - lambda;
-        double distance = fabs(temp);
+      double tempPoint[3];
+      tempPoint[0] = plane.Normal[0] * currentPoint[0];
+      tempPoint[1] = plane.Normal[1] * currentPoint[1];
+      tempPoint[2] = plane.Normal[2] * currentPoint[2];
 
-        if (distance > maxDistance)
-        {
-          maxDistance = distance;
-        }
-        if (distance < minDistance)
-        {
-          minDistance = distance;
-        }
-      } // for (to calculate distance and intersections with currentPolygon)
+      double temp = tempPoint[0] + tempPoint[1] + tempPoint[2] - plane.Lambda;
+      double distance = fabs(temp);
 
-      if (maxDistance < 1.5 * m_MaxSpacing && minDistance < 0.5 * m_MinSpacing)
+      if (distance > maxDistance)
       {
-        return false;
+        maxDistance = distance;
       }
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+      }
+    } // for (to calculate distance and intersections with currentPolygon)
 
-      // Because we are considering the plane defined by the acual input polygon only one iteration is sufficient
-      // We do not need to consider each cell of the plane
-      break;
-    } // for (to traverse through all cells of actualInputPolyData)
-
-  } // for (to iterate through all inputs)
+    if (maxDistance < 1.5 * m_MaxSpacing && minDistance < 0.5 * m_MinSpacing)
+    {
+      return false;
+    }
+  } // for (to iterate through all candidate planes)
 
   return true;
 }
@@ -29,7 +29,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vtkPolygon.h"
 #include "vtkSmartPointer.h"
 
+#include <itkMultiThreader.h>
+
 #include <stack>
+#include <utility>
+#include <vector>
 
 namespace mitk
 {
@@ -48,6 +52,10 @@ namespace mitk
     max
     spacing of the original image must be provided.
 
+    A contour is an intersection contour if it lies in the plane of another input contour. The planes of all inputs
+    are computed once per update and indexed along the axis their normal is aligned with, so a polygon is only
+    tested against the planes that pass its bounding box. The inputs are reduced in parallel.
+
     The output is a mitk::Surface.
 
     $Author: fetzer$
@@ -107,6 +115,29 @@ namespace mitk
     virtual void GenerateOutputInformation() override;
 
   private:
+    /** The plane of the first polygon of an input: Normal * x = Lambda */
+    struct InputPlane
+    {
+      double Normal[3];
+      double Lambda;
+      unsigned int InputIndex;
+    };
+
+    struct ReductionScheduler;
+
+    static ITK_THREAD_RETURN_TYPE ReductionThreadCallback(void *arg);
+
+    /** Reduces inputs until all inputs of the scheduler are processed */
+    void ReduceInputs(ReductionScheduler *scheduler);
+
+    /** Returns the reduced polygons of the input or nullptr if no polygon remains */
+    vtkSmartPointer<vtkPolyData> ReduceInput(unsigned int inputIndex,
+                                             vtkPolyData *polyData,
+                                             unsigned int &numberOfPointsAfterReduction);
+
+    /** Computes the planes of all inputs and sorts the axis aligned ones into m_AxisAlignedPlanes */
+    void BuildPlaneIndex();
+
     void ReduceNumberOfPointsByNthPoint(
       vtkIdType cellSize, vtkIdType *cell, vtkPoints *points, vtkPolygon *reducedPolygon, vtkPoints *reducedPoints);
 
@@ -122,10 +153,16 @@ namespace mitk
     double m_MinSpacing;
     double m_MaxSpacing;
 
+    std::vector<InputPlane> m_InputPlanes;
+    // For each axis the positions of the planes along it and their index in m_InputPlanes
+    std::vector<std::pair<double, unsigned int>> m_AxisAlignedPlanes[3];
+    // For each axis the maximum of |normal[i] / normal[axis]| summed over the other axes i
+    double m_MaximumPlaneTilt[3];
+    std::vector<unsigned int> m_ObliquePlanes;
+
     Reduction_Type m_ReductionType;
     unsigned int m_StepSize;
     double m_Tolerance;
-    unsigned int m_MaxSegmentLenght;
 
     bool m_UseProgressBar;
     unsigned int m_ProgressStepSize;
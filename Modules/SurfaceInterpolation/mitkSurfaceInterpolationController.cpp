@@ -92,6 +92,8 @@ mitk::SurfaceInterpolationController::SurfaceInterpolationController()
   m_NormalsFilter->SetProgressStepSize(1);
   m_InterpolateSurfaceFilter->SetUseProgressBar(true);
   m_InterpolateSurfaceFilter->SetProgressStepSize(7);
+  // Contours are added one by one while segmenting, so the equation system is updated instead of solved again
+  m_InterpolateSurfaceFilter->IncrementalUpdateOn();
 
   m_Contours = Surface::New();
 
@@ -486,6 +488,7 @@ void mitk::SurfaceInterpolationController::RemoveInterpolationSession(mitk::Imag
     if (m_SelectedSegmentation == segmentationImage)
     {
       m_NormalsFilter->SetSegmentationBinaryImage(nullptr);
+      m_InterpolateSurfaceFilter->ResetIncrementalUpdate();
       m_SelectedSegmentation = nullptr;
     }
     m_ListOfInterpolationSessions.erase(segmentationImage);
@@ -511,6 +514,7 @@ void mitk::SurfaceInterpolationController::RemoveAllInterpolationSessions()
   }
 
   m_SegmentationObserverTags.clear();
+  m_InterpolateSurfaceFilter->ResetIncrementalUpdate();
   m_SelectedSegmentation = nullptr;
   m_ListOfInterpolationSessions.clear();
 }
@@ -632,6 +636,7 @@ void mitk::SurfaceInterpolationController::OnSegmentationDeleted(const itk::Obje
     if (m_SelectedSegmentation == tempImage)
     {
       m_NormalsFilter->SetSegmentationBinaryImage(nullptr);
+      m_InterpolateSurfaceFilter->ResetIncrementalUpdate();
       m_SelectedSegmentation = nullptr;
     }
     m_SegmentationObserverTags.erase(tempImage);
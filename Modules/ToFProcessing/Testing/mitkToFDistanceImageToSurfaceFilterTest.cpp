@@ -379,6 +379,38 @@ int mitkToFDistanceImageToSurfaceFilterTest(int /* argc */, char* /*argv*/[])
   }
   MITK_TEST_CONDITION_REQUIRED(compareToInput,"Testing backward transformation compared to original image with interpixeldistance");
 
+  // test fixed grid topology: one vertex per pixel, mesh is reused for subsequent updates
+  filter->SetKeepFixedGridTopology(true);
+  MITK_TEST_CONDITION_REQUIRED(filter->GetKeepFixedGridTopology(),"Testing Set/GetKeepFixedGridTopology()");
+  filter->Modified();
+  filter->Update();
+  vtkPolyData* gridMesh = filter->GetOutput()->GetVtkPolyData();
+  MITK_TEST_CONDITION_REQUIRED(gridMesh->GetNumberOfPoints()==dimX*dimY,"Test if fixed grid has one vertex per pixel");
+  bool gridPointsEqual = true;
+  for (unsigned int i=0; i<result->GetNumberOfPoints(); i++)
+  {
+    double* res = result->GetPoint(i);
+    ToFPoint3D resultPoint;
+    resultPoint[0] = res[0];
+    resultPoint[1] = res[1];
+    resultPoint[2] = res[2];
+    ToFPoint3D pixel = mitk::ToFProcessingCommon::CartesianToIndexCoordinatesWithInterpixdist(resultPoint,focalLength,interPixelDistance,principalPoint);
+    vtkIdType pixelID = (int) (pixel[0]+0.5) + ((int) (pixel[1]+0.5))*dimX;
+    double* gridPoint = gridMesh->GetPoint(pixelID);
+    ToFPoint3D gridResultPoint;
+    gridResultPoint[0] = gridPoint[0];
+    gridResultPoint[1] = gridPoint[1];
+    gridResultPoint[2] = gridPoint[2];
+    if (!mitk::Equal(gridResultPoint, resultPoint, 1e-3))
+    {
+      gridPointsEqual = false;
+    }
+  }
+  MITK_TEST_CONDITION_REQUIRED(gridPointsEqual,"Test if fixed grid vertices are equal to the points of the default mode");
+  filter->Modified();
+  filter->Update();
+  MITK_TEST_CONDITION_REQUIRED(filter->GetOutput()->GetVtkPolyData()==gridMesh,"Test if fixed grid mesh is updated in place");
+
   //clean up
   delete point;
   //  expectedResult->Delete();
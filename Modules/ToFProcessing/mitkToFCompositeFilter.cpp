@@ -17,25 +17,26 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkToFCompositeFilter.h>
 #include <mitkInstantiateAccessFunctions.h>
 #include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
 
 #include <itkImage.h>
 
+#include <algorithm>
+#include <memory>
+
 mitk::ToFCompositeFilter::ToFCompositeFilter() : m_SegmentationMask(nullptr), m_ImageWidth(0), m_ImageHeight(0), m_ImageSize(0),
 m_IplDistanceImage(nullptr), m_IplOutputImage(nullptr), m_ItkInputImage(nullptr), m_ApplyTemporalMedianFilter(false), m_ApplyAverageFilter(false),
-  m_ApplyMedianFilter(false), m_ApplyThresholdFilter(false), m_ApplyMaskSegmentation(false), m_ApplyBilateralFilter(false), m_DataBuffer(nullptr),
-m_DataBufferCurrentIndex(0), m_DataBufferMaxSize(0), m_TemporalMedianFilterNumOfFrames(10), m_ThresholdFilterMin(1),
+  m_ApplyMedianFilter(false), m_ApplyThresholdFilter(false), m_ApplyMaskSegmentation(false), m_ApplyBilateralFilter(false),
+m_DataBufferCurrentIndex(0), m_DataBufferMaxSize(0), m_DataBufferFillCount(0), m_DataBufferImageSize(0), m_TemporalMedianFilterNumOfFrames(10), m_ThresholdFilterMin(1),
 m_ThresholdFilterMax(7000), m_BilateralFilterDomainSigma(2), m_BilateralFilterRangeSigma(60), m_BilateralFilterKernelRadius(0)
 {
+  m_BilateralFilter = BilateralFilterType::New();
 }
 
 mitk::ToFCompositeFilter::~ToFCompositeFilter()
 {
   cvReleaseImage(&(this->m_IplDistanceImage));
   cvReleaseImage(&(this->m_IplOutputImage));
-  if (m_DataBuffer!=nullptr)
-  {
-    delete [] m_DataBuffer;
-  }
 }
 
 void mitk::ToFCompositeFilter::SetInput(  mitk::Image* distanceImage )
@@ -51,30 +52,33 @@ void mitk::ToFCompositeFilter::SetInput( unsigned int idx,  mitk::Image* distanc
   }
   else
   {
-    if (idx==0) //create IPL image holding distance data
+    if (idx==0) //create IPL images holding distance data, reallocated only if the resolution changes
     {
       if (!distanceImage->IsEmpty())
       {
-        this->m_ImageWidth = distanceImage->GetDimension(0);
-        this->m_ImageHeight = distanceImage->GetDimension(1);
-        this->m_ImageSize = this->m_ImageWidth * this->m_ImageHeight * sizeof(float);
-
-        if (this->m_IplDistanceImage != nullptr)
-        {
-          cvReleaseImage(&(this->m_IplDistanceImage));
-        }
-        ImageReadAccessor distImgAcc(distanceImage, distanceImage->GetSliceData(0,0,0));
-        float* distanceFloatData = (float*) distImgAcc.GetData();
-        this->m_IplDistanceImage = cvCreateImage(cvSize(this->m_ImageWidth, this->m_ImageHeight), IPL_DEPTH_32F, 1);
-        memcpy(this->m_IplDistanceImage->imageData, (void*)distanceFloatData, this->m_ImageSize);
+        int width = distanceImage->GetDimension(0);
+        int height = distanceImage->GetDimension(1);
 
-        if (this->m_IplOutputImage != nullptr)
+        if (this->m_IplDistanceImage == nullptr || width != this->m_ImageWidth || height != this->m_ImageHeight)
         {
-          cvReleaseImage(&(this->m_IplOutputImage));
+          this->m_ImageWidth = width;
+          this->m_ImageHeight = height;
+          this->m_ImageSize = this->m_ImageWidth * this->m_ImageHeight * sizeof(float);
+
+          if (this->m_IplDistanceImage != nullptr)
+          {
+            cvReleaseImage(&(this->m_IplDistanceImage));
+          }
+          this->m_IplDistanceImage = cvCreateImage(cvSize(this->m_ImageWidth, this->m_ImageHeight), IPL_DEPTH_32F, 1);
+
+          if (this->m_IplOutputImage != nullptr)
+          {
+            cvReleaseImage(&(this->m_IplOutputImage));
+          }
+          this->m_IplOutputImage = cvCreateImage(cvSize(this->m_ImageWidth, this->m_ImageHeight), IPL_DEPTH_32F, 1);
+
+          CreateItkImage(this->m_ItkInputImage);
         }
-        this->m_IplOutputImage = cvCreateImage(cvSize(this->m_ImageWidth, this->m_ImageHeight), IPL_DEPTH_32F, 1);
-
-        CreateItkImage(this->m_ItkInputImage);
       }
     }
     this->ProcessObject::SetNthInput(idx, distanceImage);   // Process object is not const-correct so the const_cast is required here
@@ -97,53 +101,73 @@ void mitk::ToFCompositeFilter::SetInput( unsigned int idx,  mitk::Image* distanc
 
 void mitk::ToFCompositeFilter::GenerateData()
 {
-  // copy input 1...n to output 1...n
+  // copy input 1...n to output 1...n, output 0 is written by the filter pipeline below.
+  // Outputs are only reinitialized if the image layout changed to avoid reallocating them for every frame.
   for (unsigned int idx=0; idx<this->GetNumberOfOutputs(); idx++)
   {
     mitk::Image::Pointer outputImage = this->GetOutput(idx);
     mitk::Image::Pointer inputImage = this->GetInput(idx);
     if (outputImage.IsNotNull()&&inputImage.IsNotNull())
     {
-      ImageReadAccessor inputAcc(inputImage, inputImage->GetSliceData());
-      outputImage->CopyInformation(inputImage);
-      outputImage->Initialize(inputImage->GetPixelType(),inputImage->GetDimension(),inputImage->GetDimensions());
-      outputImage->SetSlice(inputAcc.GetData());
+      bool layoutChanged = !outputImage->IsInitialized()
+        || outputImage->GetPixelType() != inputImage->GetPixelType()
+        || outputImage->GetDimension() != inputImage->GetDimension();
+      for (unsigned int d = 0; !layoutChanged && d < inputImage->GetDimension(); ++d)
+      {
+        layoutChanged = outputImage->GetDimension(d) != inputImage->GetDimension(d);
+      }
+      if (layoutChanged)
+      {
+        outputImage->CopyInformation(inputImage);
+        outputImage->Initialize(inputImage->GetPixelType(),inputImage->GetDimension(),inputImage->GetDimensions());
+      }
+      if (idx > 0)
+      {
+        ImageReadAccessor inputAcc(inputImage, inputImage->GetSliceData());
+        outputImage->SetSlice(inputAcc.GetData());
+      }
     }
   }
-  //mitk::Image::Pointer outputDistanceImage = this->GetOutput();
-  ImageReadAccessor outputAcc(this->GetOutput(), this->GetOutput()->GetSliceData(0, 0, 0) );
+  ImageWriteAccessor outputAcc(this->GetOutput(), this->GetOutput()->GetSliceData(0, 0, 0) );
   float* outputDistanceFloatData = (float*) outputAcc.GetData();
 
-  //mitk::Image::Pointer inputDistanceImage = this->GetInput();
   ImageReadAccessor inputAcc(this->GetInput(), this->GetInput()->GetSliceData(0, 0, 0) );
+  const float* distanceFloatData = (const float*)inputAcc.GetData();
 
-  // copy initial distance image to ipl image
-  float* distanceFloatData = (float*)inputAcc.GetData();
-  memcpy(this->m_IplDistanceImage->imageData, (void*)distanceFloatData, this->m_ImageSize);
-  if (m_ApplyThresholdFilter||m_ApplyMaskSegmentation)
-  {
-    ProcessSegmentation(this->m_IplDistanceImage);
-  }
-  if (this->m_ApplyTemporalMedianFilter||this->m_ApplyAverageFilter)
+  const char* segmentationMask = nullptr;
+  std::unique_ptr<ImageReadAccessor> segMaskAcc;
+  if (m_ApplyMaskSegmentation && m_SegmentationMask.IsNotNull())
   {
-    ProcessStreamedQuickSelectMedianImageFilter(this->m_IplDistanceImage);
+    segMaskAcc.reset(new ImageReadAccessor(m_SegmentationMask, m_SegmentationMask->GetSliceData(0,0,0)));
+    segmentationMask = (const char*)segMaskAcc->GetData();
   }
+
+  // the spatial filters need a neighborhood and therefore read from the working buffer, the
+  // remaining stages are fused into one pass that writes either into the working buffer or,
+  // if no spatial filter is active, directly into the output
+  bool spatialFiltering = this->m_ApplyMedianFilter || this->m_ApplyBilateralFilter;
+  float* pixelPassTarget = spatialFiltering ? (float*)this->m_IplDistanceImage->imageData : outputDistanceFloatData;
+  ProcessFusedPixelPass(distanceFloatData, pixelPassTarget, segmentationMask, this->m_ApplyThresholdFilter);
+
   if (this->m_ApplyMedianFilter)
   {
     ProcessCVMedianFilter(this->m_IplDistanceImage, this->m_IplOutputImage);
-    memcpy( this->m_IplDistanceImage->imageData, this->m_IplOutputImage->imageData, this->m_ImageSize );
+    // swap working and output buffer instead of copying the filtered data back
+    std::swap(this->m_IplDistanceImage, this->m_IplOutputImage);
   }
   if (this->m_ApplyBilateralFilter)
   {
-      float* itkFloatData = this->m_ItkInputImage->GetBufferPointer();
-      memcpy(itkFloatData, this->m_IplDistanceImage->imageData, this->m_ImageSize );
-      ItkImageType2D::Pointer itkOutputImage = ProcessItkBilateralFilter(this->m_ItkInputImage);
-      memcpy( this->m_IplDistanceImage->imageData, itkOutputImage->GetBufferPointer(), this->m_ImageSize );
-
-    //ProcessCVBilateralFilter(this->m_IplDistanceImage, this->m_OutputIplImage, domainSigma, rangeSigma, kernelRadius);
-    //memcpy( distanceFloatData, this->m_OutputIplImage->imageData, distanceImageSize );
+    // let the ITK image share the working buffer instead of copying into it
+    this->m_ItkInputImage->GetPixelContainer()->SetImportPointer((float*)this->m_IplDistanceImage->imageData,
+      this->m_ImageWidth * this->m_ImageHeight, false);
+    this->m_ItkInputImage->Modified();
+    ItkImageType2D::Pointer itkOutputImage = ProcessItkBilateralFilter(this->m_ItkInputImage);
+    memcpy( outputDistanceFloatData, itkOutputImage->GetBufferPointer(), this->m_ImageSize );
+  }
+  else if (this->m_ApplyMedianFilter)
+  {
+    memcpy( outputDistanceFloatData, this->m_IplDistanceImage->imageData, this->m_ImageSize );
   }
-  memcpy( outputDistanceFloatData, this->m_IplDistanceImage->imageData, this->m_ImageSize );
 }
 
 void mitk::ToFCompositeFilter::CreateOutputsForAllInputs()
@@ -213,15 +237,12 @@ void mitk::ToFCompositeFilter::ProcessSegmentation(IplImage* inputIplImage)
 
 ItkImageType2D::Pointer mitk::ToFCompositeFilter::ProcessItkBilateralFilter(ItkImageType2D::Pointer inputItkImage)
 {
-  ItkImageType2D::Pointer outputItkImage;
-  BilateralFilterType::Pointer bilateralFilter = BilateralFilterType::New();
-  bilateralFilter->SetInput(inputItkImage);
-  bilateralFilter->SetDomainSigma(m_BilateralFilterDomainSigma);
-  bilateralFilter->SetRangeSigma(m_BilateralFilterRangeSigma);
-  //bilateralFilter->SetRadius(m_BilateralFilterKernelRadius);
-  outputItkImage = bilateralFilter->GetOutput();
-  outputItkImage->Update();
-  return outputItkImage;
+  m_BilateralFilter->SetInput(inputItkImage);
+  m_BilateralFilter->SetDomainSigma(m_BilateralFilterDomainSigma);
+  m_BilateralFilter->SetRangeSigma(m_BilateralFilterRangeSigma);
+  //m_BilateralFilter->SetRadius(m_BilateralFilterKernelRadius);
+  m_BilateralFilter->Update();
+  return m_BilateralFilter->GetOutput();
 }
 
 void mitk::ToFCompositeFilter::ProcessCVBilateralFilter(IplImage* inputIplImage, IplImage* outputIplImage)
@@ -240,77 +261,111 @@ void mitk::ToFCompositeFilter::ProcessCVMedianFilter(IplImage* inputIplImage, Ip
 void mitk::ToFCompositeFilter::ProcessStreamedQuickSelectMedianImageFilter(IplImage* inputIplImage)
 {
   float* data = (float*)inputIplImage->imageData;
+  ProcessFusedPixelPass(data, data, nullptr, false);
+}
 
-  int imageSize = inputIplImage->width * inputIplImage->height;
-  float* tmpArray;
-
-  if (this->m_TemporalMedianFilterNumOfFrames == 0)
+void mitk::ToFCompositeFilter::InitializeTemporalBuffers(int imageSize)
+{
+  if (m_TemporalMedianFilterNumOfFrames == this->m_DataBufferMaxSize && imageSize == this->m_DataBufferImageSize)
   {
     return;
   }
+  this->m_DataBufferMaxSize = m_TemporalMedianFilterNumOfFrames;
+  this->m_DataBufferImageSize = imageSize;
+  this->m_DataBufferCurrentIndex = 0;
+  this->m_DataBufferFillCount = 0;
+
+  std::size_t bufferSize = static_cast<std::size_t>(this->m_DataBufferMaxSize) * imageSize;
+  this->m_DataBuffer.assign(bufferSize, 0.0f);
+  this->m_SortedWindows.assign(bufferSize, 0.0f);
+  this->m_RunningSums.assign(imageSize, 0.0);
+}
 
-  if (m_TemporalMedianFilterNumOfFrames != this->m_DataBufferMaxSize) // reset
+float mitk::ToFCompositeFilter::UpdateSortedWindow(float* window, int count, int capacity, float oldValue, float newValue)
+{
+  int pos = count;
+  if (count == capacity)
   {
-    //delete current buffer
-    for( int i=0; i<this->m_DataBufferMaxSize; i++ ) {
-      delete[] this->m_DataBuffer[i];
-    }
-    if (this->m_DataBuffer != nullptr)
+    // locate the value leaving the window and close the gap
+    pos = 0;
+    while (pos < count - 1 && window[pos] != oldValue)
     {
-      delete[] this->m_DataBuffer;
+      ++pos;
     }
-
-    this->m_DataBufferMaxSize = m_TemporalMedianFilterNumOfFrames;
-
-    // create new buffer with current size
-    this->m_DataBuffer = new float*[this->m_DataBufferMaxSize];
-    for(int i=0; i<this->m_DataBufferMaxSize; i++)
+    for (; pos < count - 1; ++pos)
     {
-      this->m_DataBuffer[i] = nullptr;
+      window[pos] = window[pos+1];
     }
-    this->m_DataBufferCurrentIndex = 0;
+    pos = count - 1;
   }
-
-  int currentBufferSize = this->m_DataBufferMaxSize;
-  tmpArray = new float[this->m_DataBufferMaxSize];
-
-  // copy data to buffer
-  if (this->m_DataBuffer[this->m_DataBufferCurrentIndex] == nullptr)
+  else
   {
-    this->m_DataBuffer[this->m_DataBufferCurrentIndex] = new float[imageSize];
-    currentBufferSize = this->m_DataBufferCurrentIndex + 1;
+    ++count;
   }
-
-  for(int j=0; j<imageSize; j++)
+  // insertion step keeps the window sorted
+  while (pos > 0 && window[pos-1] > newValue)
   {
-    this->m_DataBuffer[this->m_DataBufferCurrentIndex][j] = data[j];
+    window[pos] = window[pos-1];
+    --pos;
   }
+  window[pos] = newValue;
+  return window[(count-1)/2];
+}
+
+void mitk::ToFCompositeFilter::ProcessFusedPixelPass(const float* inputData, float* outputData, const char* segmentationMask, bool applyThreshold)
+{
+  const int imageSize = this->m_ImageWidth * this->m_ImageHeight;
+  const bool applyMask = this->m_ApplyMaskSegmentation && segmentationMask != nullptr;
+  const bool applyTemporal = (this->m_ApplyTemporalMedianFilter || this->m_ApplyAverageFilter) && this->m_TemporalMedianFilterNumOfFrames > 0;
+  const float thresholdMin = static_cast<float>(this->m_ThresholdFilterMin);
+  const float thresholdMax = static_cast<float>(this->m_ThresholdFilterMax);
 
-  float tmpValue = 0.0f;
-  for(int i=0; i<imageSize; i++)
+  if (!applyTemporal)
   {
-    if (m_ApplyAverageFilter)
+    for (int i=0; i<imageSize; i++)
     {
-      tmpValue = 0.0f;
-      for(int j=0; j<currentBufferSize; j++)
-      {
-          tmpValue+=this->m_DataBuffer[j][i];
-      }
-      data[i] = tmpValue/currentBufferSize;
-    }
-    else if (m_ApplyTemporalMedianFilter)
-    {
-      for(int j=0; j<currentBufferSize; j++)
-      {
-        tmpArray[j] = this->m_DataBuffer[j][i];
-      }
-      data[i] = quick_select(tmpArray, currentBufferSize);
+      float value = inputData[i];
+      if (applyThreshold && (value <= thresholdMin || value >= thresholdMax))
+        value = 0.0f;
+      if (applyMask && segmentationMask[i] == 0)
+        value = 0.0f;
+      outputData[i] = value;
     }
+    return;
   }
 
-  this->m_DataBufferCurrentIndex = (this->m_DataBufferCurrentIndex + 1) % this->m_DataBufferMaxSize;
+  this->InitializeTemporalBuffers(imageSize);
+
+  const int capacity = this->m_DataBufferMaxSize;
+  const int count = this->m_DataBufferFillCount;
+  const int newCount = std::min(count + 1, capacity);
+  float* currentFrame = &this->m_DataBuffer[static_cast<std::size_t>(this->m_DataBufferCurrentIndex) * imageSize];
+  const bool useAverage = this->m_ApplyAverageFilter;
+
+  for (int i=0; i<imageSize; i++)
+  {
+    float value = inputData[i];
+    if (applyThreshold && (value <= thresholdMin || value >= thresholdMax))
+      value = 0.0f;
+    if (applyMask && segmentationMask[i] == 0)
+      value = 0.0f;
+
+    // the ring buffer slot still holds the value leaving the window if the buffer is full
+    const float oldValue = currentFrame[i];
+    currentFrame[i] = value;
+
+    // running sum and sorted window are both kept up to date so that switching between
+    // average and median does not need to rebuild any state
+    if (count == capacity)
+      this->m_RunningSums[i] -= oldValue;
+    this->m_RunningSums[i] += value;
+    float median = UpdateSortedWindow(&this->m_SortedWindows[static_cast<std::size_t>(i) * capacity], count, capacity, oldValue, value);
+
+    outputData[i] = useAverage ? static_cast<float>(this->m_RunningSums[i] / newCount) : median;
+  }
 
-  delete[] tmpArray;
+  this->m_DataBufferFillCount = newCount;
+  this->m_DataBufferCurrentIndex = (this->m_DataBufferCurrentIndex + 1) % capacity;
 }
 
 #define ELEM_SWAP(a,b) { register float t=(a);(a)=(b);(b)=t; }
@@ -22,6 +22,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <cv.h>
 #include <itkBilateralImageFilter.h>
 
+#include <vector>
+
 typedef itk::Image<float, 2> ItkImageType2D;
 typedef itk::Image<float, 3> ItkImageType3D;
 typedef itk::BilateralImageFilter<ItkImageType2D,ItkImageType2D> BilateralFilterType;
@@ -39,6 +41,11 @@ namespace mitk
   * - spatial median filter
   * - bilateral filter
   *
+  * All buffers used by the pipeline are allocated once per image resolution and reused for every frame. Threshold,
+  * mask segmentation and the temporal filters are fused into a single pass over the frame. The temporal median is
+  * maintained incrementally: for each pixel a sorted window of the last n values is kept, so that a new frame only
+  * requires removing the oldest and inserting the newest value instead of a full selection per pixel.
+  *
   * @ingroup ToFProcessing
   */
   class MITKTOFPROCESSING_EXPORT ToFCompositeFilter : public ImageToImageFilter
@@ -153,6 +160,24 @@ namespace mitk
     */
     void ProcessStreamedQuickSelectMedianImageFilter(IplImage* inputIplImage);
     /*!
+    \brief Fused per-pixel pass: copies the input frame into the working buffer while applying
+    threshold, mask segmentation and the temporal median/average filter
+    \param inputData distance data of the current frame
+    \param outputData working buffer receiving the processed frame, may be equal to inputData
+    \param segmentationMask optional mask, pixels with value 0 are set to 0
+    \param applyThreshold if true, pixels outside of the threshold filter range are set to 0
+    */
+    void ProcessFusedPixelPass(const float* inputData, float* outputData, const char* segmentationMask, bool applyThreshold);
+    /*!
+    \brief (Re-)allocates the buffers of the temporal filters if the number of frames or the image size changed
+    */
+    void InitializeTemporalBuffers(int imageSize);
+    /*!
+    \brief Inserts value into the sorted window of a pixel, replacing oldValue if the window is full.
+    \return the (lower) median of the updated window
+    */
+    static float UpdateSortedWindow(float* window, int count, int capacity, float oldValue, float newValue);
+    /*!
     \brief Quickselect algorithm
     * This Quickselect routine is based on the algorithm described in
     * "Numerical recipes in C", Second Edition,
@@ -183,9 +208,15 @@ namespace mitk
     bool m_ApplyMaskSegmentation; ///< Flag indicating if a mask segmentation is performed
     bool m_ApplyBilateralFilter; ///< Flag indicating if the bilateral filter is currently active for processing the distance image
 
-    float** m_DataBuffer; ///< Buffer used for calculating the pixel-wise median over the last n (m_TemporalMedianFilterNumOfFrames) number of frames
+    std::vector<float> m_DataBuffer; ///< Ring buffer holding the last n (m_TemporalMedianFilterNumOfFrames) frames, frame-major
+    std::vector<float> m_SortedWindows; ///< Pixel-major sorted windows of the last n values of each pixel used for the incremental temporal median
+    std::vector<double> m_RunningSums; ///< Pixel-wise sum of the values in m_DataBuffer used for the temporal average
     int m_DataBufferCurrentIndex; ///< Current index in the buffer of the temporal median filter
     int m_DataBufferMaxSize; ///< Maximal size for the buffer of the temporal median filter (m_DataBuffer)
+    int m_DataBufferFillCount; ///< Number of frames currently held in m_DataBuffer
+    int m_DataBufferImageSize; ///< Number of pixels per frame the temporal buffers were allocated for
+
+    BilateralFilterType::Pointer m_BilateralFilter; ///< Bilateral filter instance reused for every frame
 
     int m_TemporalMedianFilterNumOfFrames; ///< Number of frames to be used in the calculation of the temporal median
     int m_ThresholdFilterMin; ///< Lower threshold of the threshold filter. Pixels with values below will be assigned value 0 when applying the threshold filter
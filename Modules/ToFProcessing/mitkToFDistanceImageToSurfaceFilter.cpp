@@ -30,11 +30,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkIdList.h>
 
 #include <math.h>
+#include <memory>
 #include <vtkMath.h>
 
 mitk::ToFDistanceImageToSurfaceFilter::ToFDistanceImageToSurfaceFilter() :
   m_IplScalarImage(nullptr), m_CameraIntrinsics(), m_TextureImageWidth(0), m_TextureImageHeight(0), m_InterPixelDistance(), m_TextureIndex(0),
-  m_GenerateTriangularMesh(true), m_TriangulationThreshold(0.0)
+  m_GenerateTriangularMesh(true), m_TriangulationThreshold(0.0), m_KeepFixedGridTopology(false), m_GridWidth(0), m_GridHeight(0)
 {
   m_InterPixelDistance.Fill(0.045);
   m_CameraIntrinsics = mitk::CameraIntrinsics::New();
@@ -89,8 +90,56 @@ mitk::Image* mitk::ToFDistanceImageToSurfaceFilter::GetInput( unsigned int idx )
   return static_cast< mitk::Image*>(this->ProcessObject::GetInput(idx));
 }
 
+mitk::ToFProcessingCommon::ToFPoint3D mitk::ToFDistanceImageToSurfaceFilter::ComputeCartesianCoordinates(unsigned int i, unsigned int j,
+  ToFProcessingCommon::ToFScalarType distance, const ToFProcessingCommon::ToFPoint2D& focalLengthInPixelUnits,
+  ToFProcessingCommon::ToFScalarType focalLengthInMm, const ToFProcessingCommon::ToFPoint2D& principalPoint) const
+{
+  mitk::ToFProcessingCommon::ToFPoint3D cartesianCoordinates;
+  switch (m_ReconstructionMode)
+  {
+  case WithOutInterPixelDistance:
+  {
+    cartesianCoordinates = mitk::ToFProcessingCommon::IndexToCartesianCoordinates(i,j,distance,focalLengthInPixelUnits,principalPoint);
+    break;
+  }
+  case WithInterPixelDistance:
+  {
+    cartesianCoordinates = mitk::ToFProcessingCommon::IndexToCartesianCoordinatesWithInterpixdist(i,j,distance,focalLengthInMm,m_InterPixelDistance,principalPoint);
+    break;
+  }
+  case Kinect:
+  {
+    cartesianCoordinates = mitk::ToFProcessingCommon::KinectIndexToCartesianCoordinates(i,j,distance,focalLengthInPixelUnits,principalPoint);
+    break;
+  }
+  default:
+  {
+    MITK_ERROR << "Incorrect reconstruction mode!";
+  }
+  }
+  return cartesianCoordinates;
+}
+
+bool mitk::ToFDistanceImageToSurfaceFilter::IsCellBelowTriangulationThreshold(const double* pointXY, const double* pointX_1Y,
+  const double* pointXY_1, const double* pointX_1Y_1) const
+{
+  return (mitk::Equal(m_TriangulationThreshold, 0.0)) || ((vtkMath::Distance2BetweenPoints(pointXY, pointX_1Y) <= m_TriangulationThreshold)
+                                                          && (vtkMath::Distance2BetweenPoints(pointXY, pointXY_1) <= m_TriangulationThreshold)
+                                                          && (vtkMath::Distance2BetweenPoints(pointX_1Y, pointX_1Y_1) <= m_TriangulationThreshold)
+                                                          && (vtkMath::Distance2BetweenPoints(pointXY_1, pointX_1Y_1) <= m_TriangulationThreshold));
+}
+
 void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
 {
+  if (m_KeepFixedGridTopology)
+  {
+    this->GenerateFixedGridData();
+    return;
+  }
+  // a mesh built in fixed grid mode must not be modified in place by a later update
+  m_GridMesh = nullptr;
+  m_GridWidth = m_GridHeight = 0;
+
   mitk::Surface::Pointer output = this->GetOutput();
   assert(output);
   mitk::Image::Pointer input = this->GetInput();
@@ -99,7 +148,8 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
   int xDimension = input->GetDimension(0);
   int yDimension = input->GetDimension(1);
   unsigned int size = xDimension*yDimension; //size of the image-array
-  std::vector<bool> isPointValid;
+  // every pixel is written below, so the buffer of the previous frame is only resized
+  std::vector<bool>& isPointValid = m_IsPointValid;
   isPointValid.resize(size);
   vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
   points->SetDataTypeToDouble();
@@ -138,7 +188,7 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
   float* inputFloatData = (float*)inputAcc.GetData();
   //calculate world coordinates
   mitk::ToFProcessingCommon::ToFPoint2D focalLengthInPixelUnits;
-  mitk::ToFProcessingCommon::ToFScalarType focalLengthInMm;
+  mitk::ToFProcessingCommon::ToFScalarType focalLengthInMm = 0.0;
   if((m_ReconstructionMode == WithOutInterPixelDistance) || (m_ReconstructionMode == Kinect))
   {
     focalLengthInPixelUnits[0] = m_CameraIntrinsics->GetFocalLengthX();
@@ -171,29 +221,8 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
       unsigned int completeIndexX = i*spacing[0]+origin[0];
       unsigned int completeIndexY = j*spacing[1]+origin[1];
 
-      mitk::ToFProcessingCommon::ToFPoint3D cartesianCoordinates;
-      switch (m_ReconstructionMode)
-      {
-      case WithOutInterPixelDistance:
-      {
-        cartesianCoordinates = mitk::ToFProcessingCommon::IndexToCartesianCoordinates(completeIndexX,completeIndexY,distance,focalLengthInPixelUnits,principalPoint);
-        break;
-      }
-      case WithInterPixelDistance:
-      {
-        cartesianCoordinates = mitk::ToFProcessingCommon::IndexToCartesianCoordinatesWithInterpixdist(completeIndexX,completeIndexY,distance,focalLengthInMm,m_InterPixelDistance,principalPoint);
-        break;
-      }
-      case Kinect:
-      {
-        cartesianCoordinates = mitk::ToFProcessingCommon::KinectIndexToCartesianCoordinates(completeIndexX,completeIndexY,distance,focalLengthInPixelUnits,principalPoint);
-        break;
-      }
-      default:
-      {
-        MITK_ERROR << "Incorrect reconstruction mode!";
-      }
-      }
+      mitk::ToFProcessingCommon::ToFPoint3D cartesianCoordinates = this->ComputeCartesianCoordinates(completeIndexX, completeIndexY, distance,
+        focalLengthInPixelUnits, focalLengthInMm, principalPoint);
       //Epsilon here, because we may have small float values like 0.00000001 which in fact represents 0.
       if (distance<=mitk::eps)
       {
@@ -245,10 +274,7 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
               points->GetPoint(xy_1V, pointXY_1);
               points->GetPoint(x_1y_1V, pointX_1Y_1);
 
-              if( (mitk::Equal(m_TriangulationThreshold, 0.0)) || ((vtkMath::Distance2BetweenPoints(pointXY, pointX_1Y) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointXY, pointXY_1) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointX_1Y, pointX_1Y_1) <= m_TriangulationThreshold)
-                                                                   && (vtkMath::Distance2BetweenPoints(pointXY_1, pointX_1Y_1) <= m_TriangulationThreshold)))
+              if (this->IsCellBelowTriangulationThreshold(pointXY, pointX_1Y, pointXY_1, pointX_1Y_1))
               {
                 polys->InsertNextCell(3);
                 polys->InsertCellPoint(x_1yV);
@@ -302,6 +328,217 @@ void mitk::ToFDistanceImageToSurfaceFilter::GenerateData()
   output->SetVtkPolyData(mesh);
 }
 
+void mitk::ToFDistanceImageToSurfaceFilter::GenerateFixedGridData()
+{
+  // cell states of the pixel grid, a pixel (i,j) with i,j >= 1 owns the quad to its upper left
+  enum { NoCell = 0, VertexCell = 1, TriangleCells = 2 };
+
+  mitk::Surface::Pointer output = this->GetOutput();
+  assert(output);
+  mitk::Image::Pointer input = this->GetInput();
+  assert(input);
+  int xDimension = input->GetDimension(0);
+  int yDimension = input->GetDimension(1);
+  unsigned int size = xDimension*yDimension;
+
+  bool resolutionChanged = m_GridMesh == nullptr || xDimension != m_GridWidth || yDimension != m_GridHeight;
+  if (resolutionChanged)
+  {
+    m_GridWidth = xDimension;
+    m_GridHeight = yDimension;
+
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetDataTypeToFloat();
+    points->SetNumberOfPoints(size);
+
+    vtkSmartPointer<vtkFloatArray> scalarArray = vtkSmartPointer<vtkFloatArray>::New();
+    scalarArray->SetNumberOfComponents(1);
+    scalarArray->SetNumberOfTuples(size);
+
+    //Texture coordinates only depend on the resolution and are computed once
+    vtkSmartPointer<vtkFloatArray> textureCoords = vtkSmartPointer<vtkFloatArray>::New();
+    textureCoords->SetNumberOfComponents(2);
+    textureCoords->SetNumberOfTuples(size);
+    float* tCoords = textureCoords->GetPointer(0);
+    for (int j=0; j<yDimension; j++)
+    {
+      for (int i=0; i<xDimension; i++)
+      {
+        unsigned int pixelID = i+j*xDimension;
+        tCoords[2*pixelID] = ((float)i)/xDimension;
+        tCoords[2*pixelID+1] = ((float)j)/yDimension;
+      }
+    }
+
+    //In fixed grid mode every pixel has its own vertex
+    m_VertexIdList = vtkSmartPointer<vtkIdList>::New();
+    m_VertexIdList->SetNumberOfIds(size);
+    for(unsigned int i = 0; i < size; ++i)
+    {
+      m_VertexIdList->SetId(i, i);
+    }
+
+    m_GridMesh = vtkSmartPointer<vtkPolyData>::New();
+    m_GridMesh->SetPoints(points);
+    m_GridMesh->SetPolys(vtkSmartPointer<vtkCellArray>::New());
+    m_GridMesh->SetVerts(vtkSmartPointer<vtkCellArray>::New());
+    m_GridMesh->GetPointData()->SetScalars(scalarArray);
+    m_GridMesh->GetPointData()->SetTCoords(textureCoords);
+
+    m_GridCellStates.assign(size, NoCell);
+  }
+
+  float* scalarFloatData = nullptr;
+  std::unique_ptr<ImageReadAccessor> scalarAcc;
+  if (this->m_IplScalarImage)
+  {
+    scalarFloatData = (float*)this->m_IplScalarImage->imageData;
+  }
+  else if (this->GetInput(m_TextureIndex))
+  {
+    scalarAcc.reset(new ImageReadAccessor(this->GetInput(m_TextureIndex)));
+    scalarFloatData = (float*)scalarAcc->GetData();
+  }
+
+  ImageReadAccessor inputAcc(input, input->GetSliceData(0,0,0));
+  float* inputFloatData = (float*)inputAcc.GetData();
+
+  mitk::ToFProcessingCommon::ToFPoint2D focalLengthInPixelUnits;
+  mitk::ToFProcessingCommon::ToFScalarType focalLengthInMm = 0.0;
+  focalLengthInPixelUnits[0] = m_CameraIntrinsics->GetFocalLengthX();
+  focalLengthInPixelUnits[1] = m_CameraIntrinsics->GetFocalLengthY();
+  if (m_ReconstructionMode == WithInterPixelDistance)
+  {
+    focalLengthInMm = (m_CameraIntrinsics->GetFocalLengthX()*m_InterPixelDistance[0]+m_CameraIntrinsics->GetFocalLengthY()*m_InterPixelDistance[1])/2.0;
+  }
+  mitk::ToFProcessingCommon::ToFPoint2D principalPoint;
+  principalPoint[0] = m_CameraIntrinsics->GetPrincipalPointX();
+  principalPoint[1] = m_CameraIntrinsics->GetPrincipalPointY();
+
+  mitk::Point3D origin = input->GetGeometry()->GetOrigin();
+  mitk::Vector3D spacing = input->GetGeometry()->GetSpacing();
+
+  vtkPoints* points = m_GridMesh->GetPoints();
+  float* pointData = static_cast<vtkFloatArray*>(points->GetData())->GetPointer(0);
+  vtkFloatArray* scalarArray = static_cast<vtkFloatArray*>(m_GridMesh->GetPointData()->GetScalars());
+  float* scalarData = scalarArray->GetPointer(0);
+
+  //First pass: update the point coordinates in place, row by row
+  std::vector<bool>& isPointValid = m_IsPointValid;
+  isPointValid.resize(size);
+  for (int j=0; j<yDimension; j++)
+  {
+    unsigned int completeIndexY = j*spacing[1]+origin[1];
+    for (int i=0; i<xDimension; i++)
+    {
+      unsigned int pixelID = i+j*xDimension;
+      mitk::ToFProcessingCommon::ToFScalarType distance = (double)inputFloatData[pixelID];
+      float* point = pointData + 3*pixelID;
+      if (distance<=mitk::eps)
+      {
+        isPointValid[pixelID] = false;
+        point[0] = point[1] = point[2] = 0.0f;
+      }
+      else
+      {
+        isPointValid[pixelID] = true;
+        unsigned int completeIndexX = i*spacing[0]+origin[0];
+        mitk::ToFProcessingCommon::ToFPoint3D cartesianCoordinates = this->ComputeCartesianCoordinates(completeIndexX, completeIndexY, distance,
+          focalLengthInPixelUnits, focalLengthInMm, principalPoint);
+        point[0] = cartesianCoordinates[0];
+        point[1] = cartesianCoordinates[1];
+        point[2] = cartesianCoordinates[2];
+      }
+      scalarData[pixelID] = scalarFloatData ? scalarFloatData[pixelID] : 0.0f;
+    }
+  }
+
+  //Second pass: determine the cell state of each pixel and check whether the topology changed
+  bool topologyChanged = resolutionChanged;
+  for (int j=0; j<yDimension; j++)
+  {
+    for (int i=0; i<xDimension; i++)
+    {
+      unsigned int xy = i+j*xDimension;
+      unsigned char state = NoCell;
+      if (isPointValid[xy])
+      {
+        if (!m_GenerateTriangularMesh)
+        {
+          state = VertexCell;
+        }
+        else if ((i >= 1) && (j >= 1))
+        {
+          unsigned int x_1y = xy-1;
+          unsigned int xy_1 = xy-xDimension;
+          unsigned int x_1y_1 = xy_1-1;
+          if (isPointValid[x_1y]&&isPointValid[x_1y_1]&&isPointValid[xy_1])
+          {
+            double pointXY[3], pointX_1Y[3], pointXY_1[3], pointX_1Y_1[3];
+            points->GetPoint(xy, pointXY);
+            points->GetPoint(x_1y, pointX_1Y);
+            points->GetPoint(xy_1, pointXY_1);
+            points->GetPoint(x_1y_1, pointX_1Y_1);
+            state = this->IsCellBelowTriangulationThreshold(pointXY, pointX_1Y, pointXY_1, pointX_1Y_1) ? TriangleCells : VertexCell;
+          }
+        }
+      }
+      if (state != m_GridCellStates[xy])
+      {
+        m_GridCellStates[xy] = state;
+        topologyChanged = true;
+      }
+    }
+  }
+
+  //Cells are only rebuilt if the set of valid cells differs from the previous frame
+  if (topologyChanged)
+  {
+    vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+    vtkSmartPointer<vtkCellArray> vertices = vtkSmartPointer<vtkCellArray>::New();
+    for (unsigned int xy = 0; xy < size; ++xy)
+    {
+      if (m_GridCellStates[xy] == TriangleCells)
+      {
+        vtkIdType x_1y = xy-1;
+        vtkIdType xy_1 = xy-xDimension;
+        vtkIdType x_1y_1 = xy_1-1;
+
+        polys->InsertNextCell(3);
+        polys->InsertCellPoint(x_1y);
+        polys->InsertCellPoint(xy);
+        polys->InsertCellPoint(x_1y_1);
+
+        polys->InsertNextCell(3);
+        polys->InsertCellPoint(x_1y_1);
+        polys->InsertCellPoint(xy);
+        polys->InsertCellPoint(xy_1);
+      }
+      else if (m_GridCellStates[xy] == VertexCell)
+      {
+        vertices->InsertNextCell(1);
+        vertices->InsertCellPoint(xy);
+      }
+    }
+    m_GridMesh->SetPolys(polys);
+    m_GridMesh->SetVerts(vertices);
+  }
+
+  points->Modified();
+  scalarArray->Modified();
+  m_GridMesh->Modified();
+
+  if (output->GetVtkPolyData() != m_GridMesh.GetPointer())
+  {
+    output->SetVtkPolyData(m_GridMesh);
+  }
+  else
+  {
+    output->CalculateBoundingBox();
+    output->Modified();
+  }
+}
+
 void mitk::ToFDistanceImageToSurfaceFilter::CreateOutputsForAllInputs()
 {
   this->SetNumberOfOutputs(this->GetNumberOfInputs());  // create outputs for all inputs
@@ -28,6 +28,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <vtkSmartPointer.h>
 #include <vtkIdList.h>
+#include <vtkPolyData.h>
+
+#include <vector>
 
 namespace mitk
 {
@@ -82,6 +85,19 @@ namespace mitk
     itkSetMacro(GenerateTriangularMesh,bool);
     itkGetMacro(GenerateTriangularMesh,bool);
 
+    /**
+     * @brief SetKeepFixedGridTopology If enabled, the output surface holds one
+     * vertex per image pixel (vertex ID == pixel ID) and is reused between updates
+     * as long as the image resolution does not change. Point coordinates, scalars
+     * and texture coordinates are then updated in place and the cells are only
+     * rebuilt if the set of valid pixels or triangles changed. Vertices of invalid
+     * pixels are kept at the origin and are not referenced by any cell.
+     * Default is false, i.e. only valid pixels are inserted as vertices.
+     */
+    itkSetMacro(KeepFixedGridTopology,bool);
+    itkGetMacro(KeepFixedGridTopology,bool);
+    itkBooleanMacro(KeepFixedGridTopology);
+
 
     /**
      * @brief The ReconstructionModeType enum: Defines the reconstruction mode, if using no interpixeldistances and focal lenghts in pixel units  or interpixeldistances and focal length in mm. The Kinect option defines a special reconstruction mode for the kinect.
@@ -171,6 +187,20 @@ namespace mitk
     * \warning any additional outputs that exist before the method is called are deleted
     */
     void CreateOutputsForAllInputs();
+    /*!
+    \brief Generates the output surface on a fixed pixel grid, see SetKeepFixedGridTopology()
+    */
+    void GenerateFixedGridData();
+    /*!
+    \brief Computes the 3D coordinates of the pixel (i,j) according to the current reconstruction mode
+    */
+    ToFProcessingCommon::ToFPoint3D ComputeCartesianCoordinates(unsigned int i, unsigned int j, ToFProcessingCommon::ToFScalarType distance,
+      const ToFProcessingCommon::ToFPoint2D& focalLengthInPixelUnits, ToFProcessingCommon::ToFScalarType focalLengthInMm,
+      const ToFProcessingCommon::ToFPoint2D& principalPoint) const;
+    /*!
+    \brief Returns true if the squared distances between the four corners of a grid cell are below the triangulation threshold
+    */
+    bool IsCellBelowTriangulationThreshold(const double* pointXY, const double* pointX_1Y, const double* pointXY_1, const double* pointX_1Y_1) const;
 
     IplImage* m_IplScalarImage; ///< Scalar image used for surface texturing
 
@@ -189,6 +219,13 @@ namespace mitk
 
     double m_TriangulationThreshold;
 
+    bool m_KeepFixedGridTopology; ///< If true, the output mesh is updated in place on a fixed pixel grid
+    vtkSmartPointer<vtkPolyData> m_GridMesh; ///< Mesh reused between updates in fixed grid mode
+    int m_GridWidth; ///< Width of the image m_GridMesh was built for
+    int m_GridHeight; ///< Height of the image m_GridMesh was built for
+    std::vector<unsigned char> m_GridCellStates; ///< Per pixel cell state (none, vertex, triangles) of the current m_GridMesh topology
+    std::vector<bool> m_IsPointValid; ///< Per pixel flag if the distance is valid, reused between updates
+
   };
 } //END mitk namespace
 #endif
@@ -0,0 +1,86 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkUSImageFramePool.h"
+#include "mitkTestingMacros.h"
+
+
+class mitkUSImageFramePoolTestClass
+{
+public:
+
+  static void TestInstantiation()
+  {
+    mitk::USImageFramePool::Pointer pool = mitk::USImageFramePool::New();
+    MITK_TEST_CONDITION_REQUIRED(pool.IsNotNull(), "USImageFramePool should not be null after instantiation");
+    MITK_TEST_CONDITION_REQUIRED(pool->GetNumberOfFrames() == 0, "USImageFramePool should be empty after instantiation");
+  }
+
+  static void TestRecycling()
+  {
+    mitk::USImageFramePool::Pointer pool = mitk::USImageFramePool::New();
+    unsigned int dimensions[2] = { 64, 32 };
+    mitk::PixelType pixelType = mitk::MakeScalarPixelType<unsigned char>();
+
+    mitk::Image::Pointer first = pool->AcquireFrame(pixelType, 2, dimensions);
+    MITK_TEST_CONDITION_REQUIRED(first.IsNotNull() && first->GetDimension(0) == 64 && first->GetDimension(1) == 32,
+      "Acquired frame should have the requested layout");
+
+    mitk::Image::Pointer second = pool->AcquireFrame(pixelType, 2, dimensions);
+    MITK_TEST_CONDITION_REQUIRED(second.IsNotNull() && second != first, "Frame in use must not be handed out again");
+    MITK_TEST_CONDITION_REQUIRED(pool->GetNumberOfFramesInUse() == 2, "Two frames should be in use");
+
+    mitk::Image* firstFrame = first.GetPointer();
+    first = nullptr;
+    mitk::Image::Pointer third = pool->AcquireFrame(pixelType, 2, dimensions);
+    MITK_TEST_CONDITION_REQUIRED(third.GetPointer() == firstFrame, "Released frame should be recycled");
+    MITK_TEST_CONDITION_REQUIRED(pool->GetNumberOfFrames() == 2, "Recycling should not allocate a new frame");
+  }
+
+  static void TestExhaustion()
+  {
+    mitk::USImageFramePool::Pointer pool = mitk::USImageFramePool::New();
+    pool->SetMaximumNumberOfFrames(1);
+    unsigned int dimensions[2] = { 16, 16 };
+    mitk::PixelType pixelType = mitk::MakeScalarPixelType<float>();
+
+    mitk::Image::Pointer first = pool->AcquireFrame(pixelType, 2, dimensions);
+    mitk::Image::Pointer second = pool->AcquireFrame(pixelType, 2, dimensions);
+    MITK_TEST_CONDITION_REQUIRED(first.IsNotNull() && second.IsNull(), "Exhausted pool should not hand out a frame");
+    MITK_TEST_CONDITION_REQUIRED(pool->GetNumberOfDroppedFrames() == 1, "Exhausted request should be counted as dropped");
+
+    first = nullptr;
+    unsigned int otherDimensions[2] = { 8, 8 };
+    mitk::Image::Pointer resized = pool->AcquireFrame(pixelType, 2, otherDimensions);
+    MITK_TEST_CONDITION_REQUIRED(resized.IsNotNull() && resized->GetDimension(0) == 8,
+      "Free frame with different layout should be replaced");
+    MITK_TEST_CONDITION_REQUIRED(pool->GetNumberOfFrames() == 1, "Pool should not exceed its maximum size");
+  }
+};
+
+/**
+* This function is testing methods of the class USImageFramePool.
+*/
+int mitkUSImageFramePoolTest(int /* argc */, char* /*argv*/[])
+{
+  MITK_TEST_BEGIN("mitkUSImageFramePoolTest");
+
+    mitkUSImageFramePoolTestClass::TestInstantiation();
+    mitkUSImageFramePoolTestClass::TestRecycling();
+    mitkUSImageFramePoolTestClass::TestExhaustion();
+
+  MITK_TEST_END();
+}
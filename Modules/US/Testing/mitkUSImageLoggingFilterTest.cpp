@@ -15,6 +15,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkUSImageLoggingFilter.h"
+#include "mitkUSImageStreamReader.h"
+#include "mitkUSImageStreamSource.h"
 #include <mitkTestingMacros.h>
 #include <mitkTestFixture.h>
 #include <mitkTestingConfig.h>
@@ -40,6 +42,7 @@ class mitkUSImageLoggingFilterTestSuite : public mitk::TestFixture
   MITK_TEST(TestSavingAfterMupltipleUpdateCalls);
   MITK_TEST(TestFilterWithEmptyImages);
   MITK_TEST(TestFilterWithInvalidPath);
+  MITK_TEST(TestStreamingAndPlayback);
   //MITK_TEST(TestJpgFileExtension); //bug 19614
   CPPUNIT_TEST_SUITE_END();
 
@@ -162,6 +165,51 @@ public:
                                mitk::Exception);
   }
 
+  void TestStreamingAndPlayback()
+  {
+  std::string streamFileName = m_TemporaryTestDirectory + "/USImageLoggingFilterTest.usstream";
+  m_TestFilter->SetInput(m_RandomSingleSliceImage);
+  m_TestFilter->StartStreaming(streamFileName);
+  CPPUNIT_ASSERT_MESSAGE("Testing if streaming is active", m_TestFilter->GetIsStreaming());
+
+  for(int i=0; i<3; i++)
+    {
+    m_TestFilter->Modified();
+    m_TestFilter->Update();
+    m_TestFilter->AddMessageToCurrentImage("message");
+    itksys::SystemTools::Delay(10);
+    }
+  m_TestFilter->StopStreaming();
+  CPPUNIT_ASSERT_MESSAGE("Testing if streaming was stopped", !m_TestFilter->GetIsStreaming());
+
+  std::vector<std::string> filenames;
+  std::string csvFileName;
+  m_TestFilter->SaveImages(m_TemporaryTestDirectory,filenames,csvFileName);
+  CPPUNIT_ASSERT_MESSAGE("Testing if no images were kept in memory while streaming",filenames.empty());
+  std::remove(csvFileName.c_str());
+
+  mitk::USImageStreamReader::Pointer reader = mitk::USImageStreamReader::New();
+  reader->Open(streamFileName);
+  unsigned int numberOfFrames = m_TestFilter->GetStreamRecorder()->GetNumberOfRecordedFrames();
+  CPPUNIT_ASSERT_MESSAGE("Testing if all frames were recorded",numberOfFrames == 3);
+  CPPUNIT_ASSERT_MESSAGE("Testing if all frames can be read",reader->GetNumberOfFrames() == numberOfFrames);
+  CPPUNIT_ASSERT_MESSAGE("Testing if messages can be read",reader->GetMessages().size() == 3);
+  CPPUNIT_ASSERT_MESSAGE("Testing seek by timestamp",reader->GetFrameIndexForTimeStamp(reader->GetTimeStamp(1)) == 1);
+
+  mitk::Image::Pointer frame = reader->ReadFrame(2);
+  CPPUNIT_ASSERT_MESSAGE("Testing if read frame equals input",mitk::Equal(*frame, *m_RandomSingleSliceImage, mitk::eps, true));
+
+  mitk::USImageStreamSource::Pointer source = mitk::USImageStreamSource::New();
+  source->SetStreamFile(streamFileName);
+  source->SeekToTimeStamp(reader->GetTimeStamp(2));
+  CPPUNIT_ASSERT_MESSAGE("Testing playback of last frame",source->GetNextImage()->IsInitialized());
+  CPPUNIT_ASSERT_MESSAGE("Testing end of playback",!source->GetNextImage()->IsInitialized());
+
+  reader->Close();
+  source = nullptr;
+  std::remove(streamFileName.c_str());
+  }
+
   void TestJpgFileExtension()
   {
   CPPUNIT_ASSERT_MESSAGE("Testing setting of jpg extension.",m_TestFilter->SetImageFilesExtension(".jpg"));
@@ -26,12 +26,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 
 mitk::USImageLoggingFilter::USImageLoggingFilter() : m_SystemTimeClock(RealTimeClock::New()),
-                                                     m_ImageExtension(".nrrd")
+                                                     m_ImageExtension(".nrrd"),
+                                                     m_StreamRecorder(mitk::USImageStreamRecorder::New())
 {
 }
 
 mitk::USImageLoggingFilter::~USImageLoggingFilter()
 {
+  m_StreamRecorder->Stop();
 }
 
 void mitk::USImageLoggingFilter::GenerateData()
@@ -45,6 +47,13 @@ void mitk::USImageLoggingFilter::GenerateData()
     return;
     }
 
+  //when streaming, the recorder copies the image into its bounded queue, no clone is kept
+  if (m_StreamRecorder->GetIsRecording())
+    {
+    m_StreamRecorder->AddFrame(inputImage, m_SystemTimeClock->GetCurrentStamp());
+    return;
+    }
+
   //a clone is needed for a output and to store it.
   mitk::Image::Pointer inputClone = inputImage->Clone();
 
@@ -83,6 +92,11 @@ void mitk::USImageLoggingFilter::GenerateData()
 
 void mitk::USImageLoggingFilter::AddMessageToCurrentImage(std::string message)
 {
+  if (m_StreamRecorder->GetIsRecording())
+  {
+    m_StreamRecorder->AddMessage(message);
+    return;
+  }
   m_LoggedMessages.insert(std::make_pair(static_cast<int>(m_LoggedImages.size()-1),message));
 }
 
@@ -163,3 +177,18 @@ bool mitk::USImageLoggingFilter::SetImageFilesExtension(std::string extension)
   }
   return false;
  }
+
+void mitk::USImageLoggingFilter::StartStreaming(std::string fileName)
+{
+  m_StreamRecorder->Start(fileName);
+}
+
+void mitk::USImageLoggingFilter::StopStreaming()
+{
+  m_StreamRecorder->Stop();
+}
+
+bool mitk::USImageLoggingFilter::GetIsStreaming() const
+{
+  return m_StreamRecorder->GetIsRecording();
+}
@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <MitkUSExports.h>
 #include <mitkImageToImageFilter.h>
 #include <mitkRealTimeClock.h>
+#include "mitkUSImageStreamRecorder.h"
 
 
 namespace mitk {
@@ -29,6 +30,11 @@ namespace mitk {
    *  add messages. All data (images, timestamps and messages) is written to the harddisc when
    *  the method SaveImages(...) is called.
    *
+   *  For long sessions the images can instead be streamed to a single file by a background
+   *  thread (see StartStreaming()). No clones are kept in memory then and SaveImages(...) has
+   *  nothing to write. The stream can be read with mitk::USImageStreamReader or played back
+   *  with mitk::USImageStreamSource.
+   *
    *  Caution: only supports logging of one input at the moment, multiple inputs are ignored!
    *
    *  \ingroup US
@@ -76,6 +82,22 @@ namespace mitk {
      */
     bool SetImageFilesExtension(std::string extension);
 
+    /** Starts streaming all following images with their timestamps and messages to the given file.
+     *  Images are written by a background thread. If writing cannot keep up, images are dropped
+     *  instead of growing the memory usage (see GetStreamRecorder()).
+     *  @throw mitk::Exception Throws an exception if the file cannot be opened.
+     */
+    void StartStreaming(std::string fileName);
+
+    /** Writes all pending images and closes the stream file. */
+    void StopStreaming();
+
+    /** @return Returns true if images are currently streamed to a file. */
+    bool GetIsStreaming() const;
+
+    /** @return Returns the recorder used for streaming, e.g. for querying the number of dropped frames. */
+    itkGetMacro(StreamRecorder, mitk::USImageStreamRecorder::Pointer);
+
 
   protected:
     USImageLoggingFilter();
@@ -88,6 +110,7 @@ namespace mitk {
     std::map<int, std::string> m_LoggedMessages; ///< (Optional) messages for every logged image
     std::vector<double> m_LoggedMITKSystemTimes; ///< Logged system times for every logged image
     std::string m_ImageExtension; ///< stores the image extension, default is ".nrrd"
+    mitk::USImageStreamRecorder::Pointer m_StreamRecorder; ///< background writer used while streaming
 
   };
 } // namespace mitk
@@ -16,6 +16,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkUSImageSource.h"
 #include "mitkProperties.h"
+#include "mitkImageWriteAccessor.h"
+
+#include <cstring>
 
 const char* mitk::USImageSource::IMAGE_PROPERTY_IDENTIFIER = "id_nummer";
 
@@ -24,6 +27,8 @@ mitk::USImageSource::USImageSource()
   m_MitkToOpenCVFilter(nullptr),
   m_ImageFilter(mitk::BasicCombinationOpenCVImageFilter::New()),
   m_CurrentImageId(0),
+  m_FramePool(mitk::USImageFramePool::New()),
+  m_Clock(itk::RealTimeClock::New()),
   m_ImageFilterMutex(itk::FastMutexLock::New())
 {
 }
@@ -59,16 +64,16 @@ mitk::Image::Pointer mitk::USImageSource::GetNextImage()
 
     if (!image.empty())
     {
+      double filterStartTime = m_Clock->GetTimeInSeconds();
+
       m_ImageFilterMutex->Lock();
       m_ImageFilter->FilterImage(image, m_CurrentImageId);
       m_ImageFilterMutex->Unlock();
 
       // convert to MITK image
-      this->m_OpenCVToMitkFilter->SetOpenCVMat(image);
-      this->m_OpenCVToMitkFilter->Update();
+      result = this->ConvertToPooledImage(image);
 
-      // OpenCVToMitkImageFilter returns a standard mitk::image.
-      result = this->m_OpenCVToMitkFilter->GetOutput();
+      m_FilterStatistics.AddFrame((m_Clock->GetTimeInSeconds() - filterStartTime) * 1000.0);
     }
   }
   // Get next image without filtering
@@ -115,3 +120,64 @@ void mitk::USImageSource::GetNextRawImage(cv::Mat& image)
   m_MitkToOpenCVFilter->SetImage(mitkImg);
   image = m_MitkToOpenCVFilter->GetOpenCVMat();
 }
+
+const mitk::USImageStageStatistics& mitk::USImageSource::GetFilterStatistics() const
+{
+  return m_FilterStatistics;
+}
+
+mitk::Image::Pointer mitk::USImageSource::ConvertToPooledImage(const cv::Mat& image)
+{
+  if (image.empty())
+  {
+    return nullptr;
+  }
+
+  mitk::PixelType pixelType = mitk::MakeScalarPixelType<unsigned char>();
+  bool isSupported = image.channels() == 1 && image.dims == 2;
+  switch (image.depth())
+  {
+  case CV_8U: pixelType = mitk::MakeScalarPixelType<unsigned char>(); break;
+  case CV_8S: pixelType = mitk::MakeScalarPixelType<char>(); break;
+  case CV_16U: pixelType = mitk::MakeScalarPixelType<unsigned short>(); break;
+  case CV_16S: pixelType = mitk::MakeScalarPixelType<short>(); break;
+  case CV_32F: pixelType = mitk::MakeScalarPixelType<float>(); break;
+  case CV_64F: pixelType = mitk::MakeScalarPixelType<double>(); break;
+  default: isSupported = false;
+  }
+
+  mitk::Image::Pointer frame;
+  if (isSupported)
+  {
+    unsigned int dimensions[2] = { static_cast<unsigned int>(image.cols), static_cast<unsigned int>(image.rows) };
+    frame = m_FramePool->AcquireFrame(pixelType, 2, dimensions);
+  }
+
+  if (frame.IsNull())
+  {
+    // fall back to the (allocating) conversion filter
+    this->m_OpenCVToMitkFilter->SetOpenCVMat(image);
+    this->m_OpenCVToMitkFilter->Update();
+    return this->m_OpenCVToMitkFilter->GetOutput();
+  }
+
+  {
+    mitk::ImageWriteAccessor frameAccessor(frame, frame->GetSliceData(0, 0, 0));
+    char* frameData = static_cast<char*>(frameAccessor.GetData());
+    const size_t rowSize = image.cols * image.elemSize();
+    if (image.isContinuous())
+    {
+      std::memcpy(frameData, image.data, rowSize * image.rows);
+    }
+    else
+    {
+      for (int row = 0; row < image.rows; ++row)
+      {
+        std::memcpy(frameData + row * rowSize, image.ptr(row), rowSize);
+      }
+    }
+  }
+  frame->Modified();
+
+  return frame;
+}
@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 // ITK
 #include <itkProcessObject.h>
 #include <itkFastMutexLock.h>
+#include <itkRealTimeClock.h>
 
 // MITK
 #include <MitkUSExports.h>
@@ -27,6 +28,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkBasicCombinationOpenCVImageFilter.h"
 #include "mitkOpenCVToMitkImageFilter.h"
 #include "mitkImageToOpenCVImageFilter.h"
+#include "mitkUSImageFramePool.h"
+#include "mitkUSImageStageStatistics.h"
 
 // OpenCV
 #include "cv.h"
@@ -39,6 +42,11 @@ namespace mitk {
   * get the next image from the image source. This image will be filtered by
   * the filter set with mitk::USImageSource::SetImageFilter().
   *
+  * Filtered single channel frames are written into images of a
+  * mitk::USImageFramePool instead of allocating a new image for each frame.
+  * A returned image is therefore only recycled after every consumer released
+  * its reference to it.
+  *
   * \ingroup US
   */
   class MITKUS_EXPORT USImageSource : public itk::Object
@@ -63,6 +71,16 @@ namespace mitk {
     */
     mitk::Image::Pointer GetNextImage();
 
+    /**
+    * \brief Pool holding the frames returned by mitk::USImageSource::GetNextImage().
+    */
+    itkGetMacro(FramePool, mitk::USImageFramePool::Pointer);
+
+    /**
+    * \brief Frame counters and latencies of the OpenCV filtering and conversion stage.
+    */
+    const USImageStageStatistics& GetFilterStatistics() const;
+
   protected:
     USImageSource();
     virtual ~USImageSource();
@@ -82,6 +100,14 @@ namespace mitk {
     */
     virtual void GetNextRawImage(mitk::Image::Pointer&) = 0;
 
+    /**
+    * \brief Copies the given OpenCV image into a frame of the frame pool.
+    * Multi channel images and images with an unsupported depth are converted
+    * by mitk::OpenCVToMitkImageFilter instead, as well as all images if the
+    * pool is exhausted.
+    */
+    mitk::Image::Pointer ConvertToPooledImage(const cv::Mat& image);
+
     /**
     * \brief Used to convert from OpenCV Images to MITK Images.
     */
@@ -99,6 +125,10 @@ namespace mitk {
 
     int                                        m_CurrentImageId;
 
+    mitk::USImageFramePool::Pointer            m_FramePool;
+    USImageStageStatistics                     m_FilterStatistics;
+    itk::RealTimeClock::Pointer                m_Clock;
+
     itk::FastMutexLock::Pointer m_ImageFilterMutex;
   };
 } // namespace mitk
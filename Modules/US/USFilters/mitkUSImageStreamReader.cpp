@@ -0,0 +1,256 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkUSImageStreamReader.h"
+#include "mitkUSImageStreamRecorder.h"
+#include <mitkImageWriteAccessor.h>
+#include <mitkExceptionMacro.h>
+
+#include <itkMetaImageIO.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+  template <typename T>
+  bool ReadValue(std::ifstream& stream, T& value)
+  {
+    stream.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return stream.good();
+  }
+
+  // size of a frame record without the payload, following the record type
+  const std::streamoff FRAME_HEADER_SIZE = sizeof(double) + 2 * sizeof(int) + 5 * sizeof(unsigned int)
+    + 6 * sizeof(double) + sizeof(unsigned long long);
+}
+
+mitk::USImageStreamReader::USImageStreamReader()
+  : m_FileMutex(itk::FastMutexLock::New())
+{
+}
+
+mitk::USImageStreamReader::~USImageStreamReader()
+{
+  this->Close();
+}
+
+void mitk::USImageStreamReader::Open(const std::string& fileName)
+{
+  this->Close();
+
+  m_StreamFile.open(fileName.c_str(), std::ios::in | std::ios::binary);
+  if (!m_StreamFile.is_open())
+  {
+    mitkThrow() << "Cannot open stream file " << fileName << " for reading.";
+  }
+
+  const size_t identifierLength = std::strlen(USImageStreamRecorder::FILE_IDENTIFIER);
+  std::vector<char> identifier(identifierLength);
+  unsigned int version = 0;
+  m_StreamFile.read(identifier.data(), identifierLength);
+  if (!m_StreamFile.good() || std::memcmp(identifier.data(), USImageStreamRecorder::FILE_IDENTIFIER, identifierLength) != 0
+    || !ReadValue(m_StreamFile, version) || version > USImageStreamRecorder::FILE_VERSION)
+  {
+    this->Close();
+    mitkThrow() << "File " << fileName << " is no valid ultrasound stream file.";
+  }
+
+  m_StreamFile.seekg(0, std::ios::end);
+  std::streamoff fileSize = m_StreamFile.tellg();
+
+  this->ScanStreamFile(fileSize);
+}
+
+void mitk::USImageStreamReader::Close()
+{
+  m_FileMutex->Lock();
+  if (m_StreamFile.is_open())
+  {
+    m_StreamFile.close();
+  }
+  m_StreamFile.clear();
+  m_TimeStamps.clear();
+  m_Offsets.clear();
+  m_Messages.clear();
+  m_FileMutex->Unlock();
+}
+
+bool mitk::USImageStreamReader::GetIsOpen() const
+{
+  return m_StreamFile.is_open();
+}
+
+void mitk::USImageStreamReader::ScanStreamFile(std::streamoff fileSize)
+{
+  m_StreamFile.clear();
+  m_StreamFile.seekg(std::strlen(USImageStreamRecorder::FILE_IDENTIFIER) + sizeof(unsigned int));
+
+  unsigned int recordType;
+  while (true)
+  {
+    unsigned long long offset = static_cast<unsigned long long>(m_StreamFile.tellg());
+    if (!ReadValue(m_StreamFile, recordType))
+    {
+      break;
+    }
+
+    if (recordType == USImageStreamRecorder::Record_Frame)
+    {
+      double timeStamp;
+      if (!ReadValue(m_StreamFile, timeStamp))
+      {
+        break;
+      }
+      m_StreamFile.seekg(FRAME_HEADER_SIZE - sizeof(double) - sizeof(unsigned long long), std::ios::cur);
+      unsigned long long payloadSize;
+      if (!ReadValue(m_StreamFile, payloadSize))
+      {
+        break;
+      }
+      std::streamoff endOfRecord = static_cast<std::streamoff>(m_StreamFile.tellg()) + static_cast<std::streamoff>(payloadSize);
+      if (endOfRecord > fileSize)
+      {
+        // incomplete frame at the end of the file
+        break;
+      }
+      m_StreamFile.seekg(endOfRecord);
+      m_TimeStamps.push_back(timeStamp);
+      m_Offsets.push_back(offset);
+    }
+    else if (recordType == USImageStreamRecorder::Record_Message)
+    {
+      unsigned long long frameIndex;
+      unsigned int length;
+      if (!ReadValue(m_StreamFile, frameIndex) || !ReadValue(m_StreamFile, length))
+      {
+        break;
+      }
+      std::string message(length, '\0');
+      m_StreamFile.read(&message[0], length);
+      if (!m_StreamFile.good())
+      {
+        break;
+      }
+      m_Messages.insert(std::make_pair(static_cast<unsigned int>(frameIndex), message));
+    }
+    else
+    {
+      MITK_WARN << "Unknown record type " << recordType << " in ultrasound stream file, stopped reading.";
+      break;
+    }
+  }
+  m_StreamFile.clear();
+}
+
+unsigned int mitk::USImageStreamReader::GetNumberOfFrames() const
+{
+  return static_cast<unsigned int>(m_Offsets.size());
+}
+
+double mitk::USImageStreamReader::GetTimeStamp(unsigned int frameIndex) const
+{
+  if (frameIndex >= m_TimeStamps.size())
+  {
+    mitkThrow() << "Frame index " << frameIndex << " is out of range.";
+  }
+  return m_TimeStamps[frameIndex];
+}
+
+unsigned int mitk::USImageStreamReader::GetFrameIndexForTimeStamp(double timeStamp) const
+{
+  std::vector<double>::const_iterator it = std::upper_bound(m_TimeStamps.begin(), m_TimeStamps.end(), timeStamp);
+  if (it == m_TimeStamps.begin())
+  {
+    return 0;
+  }
+  return static_cast<unsigned int>(it - m_TimeStamps.begin() - 1);
+}
+
+mitk::Image::Pointer mitk::USImageStreamReader::ReadFrame(unsigned int frameIndex)
+{
+  if (frameIndex >= m_Offsets.size())
+  {
+    mitkThrow() << "Frame index " << frameIndex << " is out of range.";
+  }
+
+  m_FileMutex->Lock();
+  m_StreamFile.clear();
+  m_StreamFile.seekg(m_Offsets[frameIndex] + sizeof(unsigned int));
+
+  double timeStamp;
+  int componentType, pixelType;
+  unsigned int numberOfComponents, dimension;
+  unsigned int dimensions[3];
+  double spacing[3], origin[3];
+  unsigned long long payloadSize;
+  ReadValue(m_StreamFile, timeStamp);
+  ReadValue(m_StreamFile, componentType);
+  ReadValue(m_StreamFile, pixelType);
+  ReadValue(m_StreamFile, numberOfComponents);
+  ReadValue(m_StreamFile, dimension);
+  m_StreamFile.read(reinterpret_cast<char*>(dimensions), sizeof(dimensions));
+  m_StreamFile.read(reinterpret_cast<char*>(spacing), sizeof(spacing));
+  m_StreamFile.read(reinterpret_cast<char*>(origin), sizeof(origin));
+  if (!ReadValue(m_StreamFile, payloadSize) || dimension == 0 || dimension > 3)
+  {
+    m_FileMutex->Unlock();
+    mitkThrow() << "Frame " << frameIndex << " of the ultrasound stream file is corrupt.";
+  }
+
+  itk::MetaImageIO::Pointer imageIO = itk::MetaImageIO::New();
+  imageIO->SetComponentType(static_cast<itk::ImageIOBase::IOComponentType>(componentType));
+  imageIO->SetPixelType(static_cast<itk::ImageIOBase::IOPixelType>(pixelType));
+  imageIO->SetNumberOfComponents(numberOfComponents);
+
+  mitk::Image::Pointer image = mitk::Image::New();
+  image->Initialize(mitk::MakePixelType(imageIO), dimension, dimensions);
+
+  mitk::Vector3D imageSpacing;
+  mitk::Point3D imageOrigin;
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    imageSpacing[d] = spacing[d];
+    imageOrigin[d] = origin[d];
+  }
+  image->GetGeometry()->SetSpacing(imageSpacing);
+  image->GetGeometry()->SetOrigin(imageOrigin);
+
+  {
+    mitk::ImageWriteAccessor accessor(image, image->GetVolumeData(0));
+    size_t expectedSize = static_cast<size_t>(dimensions[0]) * dimensions[1] * dimensions[2] * image->GetPixelType().GetSize();
+    if (payloadSize != expectedSize)
+    {
+      m_FileMutex->Unlock();
+      mitkThrow() << "Frame " << frameIndex << " of the ultrasound stream file has an unexpected size.";
+    }
+    m_StreamFile.read(static_cast<char*>(accessor.GetData()), payloadSize);
+  }
+  bool readSucceeded = m_StreamFile.good();
+  m_FileMutex->Unlock();
+
+  if (!readSucceeded)
+  {
+    mitkThrow() << "Could not read frame " << frameIndex << " of the ultrasound stream file.";
+  }
+
+  return image;
+}
+
+const std::multimap<unsigned int, std::string>& mitk::USImageStreamReader::GetMessages() const
+{
+  return m_Messages;
+}
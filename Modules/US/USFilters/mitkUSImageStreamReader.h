@@ -0,0 +1,98 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKUSImageStreamReader_H_HEADER_INCLUDED_
+#define MITKUSImageStreamReader_H_HEADER_INCLUDED_
+
+// MITK
+#include <MitkUSExports.h>
+#include <mitkCommon.h>
+#include <mitkImage.h>
+
+// ITK
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+#include <itkFastMutexLock.h>
+
+// STL
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace mitk {
+  /**
+  * \brief Provides random access to the frames of a stream file written by
+  * mitk::USImageStreamRecorder.
+  *
+  * On Open() the record headers of the stream file are scanned once (skipping
+  * the pixel data) to build an index of frame offsets and timestamps and to
+  * collect the messages. Frames are then read on demand.
+  *
+  * \ingroup US
+  */
+  class MITKUS_EXPORT USImageStreamReader : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(USImageStreamReader, itk::Object);
+    itkFactorylessNewMacro(Self)
+
+    /**
+    * \brief Opens the given stream file and reads its frame index.
+    * \throw mitk::Exception if the file cannot be opened or is no valid stream file
+    */
+    void Open(const std::string& fileName);
+
+    void Close();
+
+    bool GetIsOpen() const;
+
+    unsigned int GetNumberOfFrames() const;
+
+    /** \brief Timestamp of the frame with the given index as passed to mitk::USImageStreamRecorder::AddFrame(). */
+    double GetTimeStamp(unsigned int frameIndex) const;
+
+    /**
+    * \brief Returns the index of the last frame recorded at or before the given timestamp.
+    * Timestamps before the first frame map to frame 0.
+    */
+    unsigned int GetFrameIndexForTimeStamp(double timeStamp) const;
+
+    /**
+    * \brief Reads the frame with the given index.
+    * \throw mitk::Exception if the index is out of range or the file is corrupt
+    */
+    mitk::Image::Pointer ReadFrame(unsigned int frameIndex);
+
+    /** \brief Messages of the stream file mapped to the index of the frame they belong to. */
+    const std::multimap<unsigned int, std::string>& GetMessages() const;
+
+  protected:
+    USImageStreamReader();
+    virtual ~USImageStreamReader();
+
+    void ScanStreamFile(std::streamoff fileSize);
+
+  private:
+    std::ifstream                            m_StreamFile;
+    std::vector<double>                      m_TimeStamps;
+    std::vector<unsigned long long>          m_Offsets;
+    std::multimap<unsigned int, std::string> m_Messages;
+    itk::FastMutexLock::Pointer              m_FileMutex;
+  };
+} // namespace mitk
+
+#endif // MITKUSImageStreamReader_H_HEADER_INCLUDED_
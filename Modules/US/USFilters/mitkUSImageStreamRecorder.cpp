@@ -0,0 +1,283 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkUSImageStreamRecorder.h"
+#include <mitkImageReadAccessor.h>
+#include <mitkExceptionMacro.h>
+
+#include <cstring>
+
+const char* mitk::USImageStreamRecorder::FILE_IDENTIFIER = "MITKUSSTREAM";
+const unsigned int mitk::USImageStreamRecorder::FILE_VERSION = 1;
+
+namespace
+{
+  template <typename T>
+  void WriteValue(std::ofstream& stream, const T& value)
+  {
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+}
+
+mitk::USImageStreamRecorder::USImageStreamRecorder()
+  : m_MaximumQueueSize(64),
+  m_IsRecording(false),
+  m_StopRequested(false),
+  m_NumberOfQueuedFrames(0),
+  m_NumberOfRecordedFrames(0),
+  m_NumberOfDroppedFrames(0),
+  m_MultiThreader(itk::MultiThreader::New()),
+  m_ThreadID(-1),
+  m_QueueCondition(itk::ConditionVariable::New())
+{
+}
+
+mitk::USImageStreamRecorder::~USImageStreamRecorder()
+{
+  this->Stop();
+}
+
+void mitk::USImageStreamRecorder::Start(const std::string& fileName)
+{
+  if (m_IsRecording)
+  {
+    mitkThrow() << "Recording to a stream file is already running.";
+  }
+
+  m_StreamFile.open(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_StreamFile.is_open())
+  {
+    mitkThrow() << "Cannot open stream file " << fileName << " for writing.";
+  }
+
+  m_StreamFile.write(FILE_IDENTIFIER, std::strlen(FILE_IDENTIFIER));
+  WriteValue(m_StreamFile, FILE_VERSION);
+
+  m_CounterMutex.Lock();
+  m_NumberOfRecordedFrames = 0;
+  m_NumberOfDroppedFrames = 0;
+  m_CounterMutex.Unlock();
+
+  m_QueueMutex.Lock();
+  m_Queue.clear();
+  m_NumberOfQueuedFrames = 0;
+  m_StopRequested = false;
+  m_IsRecording = true;
+  m_QueueMutex.Unlock();
+
+  m_ThreadID = m_MultiThreader->SpawnThread(this->WriterThread, this);
+}
+
+void mitk::USImageStreamRecorder::Stop()
+{
+  if (!m_IsRecording)
+  {
+    return;
+  }
+
+  m_QueueMutex.Lock();
+  m_StopRequested = true;
+  m_QueueCondition->Broadcast();
+  m_QueueMutex.Unlock();
+
+  // the writer thread drains the queue before it returns
+  m_MultiThreader->TerminateThread(m_ThreadID);
+  m_ThreadID = -1;
+
+  m_StreamFile.close();
+
+  m_QueueMutex.Lock();
+  m_IsRecording = false;
+  m_FreeBuffers.clear();
+  m_QueueMutex.Unlock();
+}
+
+bool mitk::USImageStreamRecorder::GetIsRecording() const
+{
+  return m_IsRecording;
+}
+
+bool mitk::USImageStreamRecorder::AddFrame(const mitk::Image* image, double timeStamp)
+{
+  if (!m_IsRecording || image == nullptr || !image->IsInitialized() || image->GetDimension() > 3)
+  {
+    return false;
+  }
+
+  m_QueueMutex.Lock();
+  if (m_Queue.size() >= m_MaximumQueueSize)
+  {
+    m_QueueMutex.Unlock();
+    m_CounterMutex.Lock();
+    ++m_NumberOfDroppedFrames;
+    m_CounterMutex.Unlock();
+    return false;
+  }
+  std::vector<char> buffer;
+  if (!m_FreeBuffers.empty())
+  {
+    buffer.swap(m_FreeBuffers.back());
+    m_FreeBuffers.pop_back();
+  }
+  m_QueueMutex.Unlock();
+
+  QueueItem item;
+  item.type = Record_Frame;
+  item.timeStamp = timeStamp;
+  mitk::PixelType pixelType = image->GetPixelType();
+  item.componentType = pixelType.GetComponentType();
+  item.pixelType = pixelType.GetPixelType();
+  item.numberOfComponents = static_cast<unsigned int>(pixelType.GetNumberOfComponents());
+  item.dimension = image->GetDimension();
+  mitk::Vector3D spacing = image->GetGeometry()->GetSpacing();
+  mitk::Point3D origin = image->GetGeometry()->GetOrigin();
+  for (unsigned int d = 0; d < 3; ++d)
+  {
+    item.dimensions[d] = d < item.dimension ? image->GetDimension(d) : 1;
+    item.spacing[d] = spacing[d];
+    item.origin[d] = origin[d];
+  }
+  item.frameIndex = 0;
+
+  // copy the pixel data of the first time step, reusing a buffer of an already written frame
+  size_t size = static_cast<size_t>(item.dimensions[0]) * item.dimensions[1] * item.dimensions[2] * pixelType.GetSize();
+  {
+    mitk::ImageReadAccessor accessor(image, image->GetVolumeData(0));
+    buffer.resize(size);
+    std::memcpy(buffer.data(), accessor.GetData(), size);
+  }
+  item.data.swap(buffer);
+
+  m_QueueMutex.Lock();
+  item.frameIndex = m_NumberOfQueuedFrames++;
+  m_Queue.push_back(QueueItem());
+  std::swap(m_Queue.back(), item);
+  m_QueueCondition->Signal();
+  m_QueueMutex.Unlock();
+
+  return true;
+}
+
+void mitk::USImageStreamRecorder::AddMessage(const std::string& message)
+{
+  if (!m_IsRecording)
+  {
+    return;
+  }
+
+  m_QueueMutex.Lock();
+  QueueItem item;
+  item.type = Record_Message;
+  item.timeStamp = 0.0;
+  item.frameIndex = m_NumberOfQueuedFrames > 0 ? m_NumberOfQueuedFrames - 1 : 0;
+  item.message = message;
+  m_Queue.push_back(item);
+  m_QueueCondition->Signal();
+  m_QueueMutex.Unlock();
+}
+
+unsigned long mitk::USImageStreamRecorder::GetNumberOfRecordedFrames() const
+{
+  m_CounterMutex.Lock();
+  unsigned long numberOfRecordedFrames = m_NumberOfRecordedFrames;
+  m_CounterMutex.Unlock();
+  return numberOfRecordedFrames;
+}
+
+unsigned long mitk::USImageStreamRecorder::GetNumberOfDroppedFrames() const
+{
+  m_CounterMutex.Lock();
+  unsigned long numberOfDroppedFrames = m_NumberOfDroppedFrames;
+  m_CounterMutex.Unlock();
+  return numberOfDroppedFrames;
+}
+
+void mitk::USImageStreamRecorder::WriteItem(QueueItem& item)
+{
+  unsigned int recordType = item.type;
+
+  WriteValue(m_StreamFile, recordType);
+  if (item.type == Record_Frame)
+  {
+    WriteValue(m_StreamFile, item.timeStamp);
+    WriteValue(m_StreamFile, item.componentType);
+    WriteValue(m_StreamFile, item.pixelType);
+    WriteValue(m_StreamFile, item.numberOfComponents);
+    WriteValue(m_StreamFile, item.dimension);
+    m_StreamFile.write(reinterpret_cast<const char*>(item.dimensions), sizeof(item.dimensions));
+    m_StreamFile.write(reinterpret_cast<const char*>(item.spacing), sizeof(item.spacing));
+    m_StreamFile.write(reinterpret_cast<const char*>(item.origin), sizeof(item.origin));
+    unsigned long long payloadSize = item.data.size();
+    WriteValue(m_StreamFile, payloadSize);
+    m_StreamFile.write(item.data.data(), item.data.size());
+  }
+  else
+  {
+    unsigned int length = static_cast<unsigned int>(item.message.size());
+    WriteValue(m_StreamFile, item.frameIndex);
+    WriteValue(m_StreamFile, length);
+    m_StreamFile.write(item.message.data(), length);
+  }
+}
+
+ITK_THREAD_RETURN_TYPE mitk::USImageStreamRecorder::WriterThread(void* pInfoStruct)
+{
+  /* extract this pointer from Thread Info structure */
+  struct itk::MultiThreader::ThreadInfoStruct* pInfo =
+    (struct itk::MultiThreader::ThreadInfoStruct*)pInfoStruct;
+  mitk::USImageStreamRecorder* recorder = (mitk::USImageStreamRecorder*)pInfo->UserData;
+
+  while (true)
+  {
+    recorder->m_QueueMutex.Lock();
+    while (recorder->m_Queue.empty() && !recorder->m_StopRequested)
+    {
+      recorder->m_QueueCondition->Wait(&recorder->m_QueueMutex);
+    }
+    if (recorder->m_Queue.empty())
+    {
+      // stop was requested and everything is written
+      recorder->m_QueueMutex.Unlock();
+      break;
+    }
+    QueueItem item;
+    std::swap(item, recorder->m_Queue.front());
+    recorder->m_Queue.pop_front();
+    recorder->m_QueueMutex.Unlock();
+
+    recorder->WriteItem(item);
+
+    if (item.type == Record_Frame)
+    {
+      recorder->m_CounterMutex.Lock();
+      ++recorder->m_NumberOfRecordedFrames;
+      recorder->m_CounterMutex.Unlock();
+
+      // hand the buffer back for the next frame
+      recorder->m_QueueMutex.Lock();
+      if (recorder->m_FreeBuffers.size() < recorder->m_MaximumQueueSize)
+      {
+        recorder->m_FreeBuffers.push_back(std::vector<char>());
+        recorder->m_FreeBuffers.back().swap(item.data);
+      }
+      recorder->m_QueueMutex.Unlock();
+    }
+  }
+
+  recorder->m_StreamFile.flush();
+
+  return ITK_THREAD_RETURN_VALUE;
+}
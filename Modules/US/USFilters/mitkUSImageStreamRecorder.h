@@ -0,0 +1,153 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKUSImageStreamRecorder_H_HEADER_INCLUDED_
+#define MITKUSImageStreamRecorder_H_HEADER_INCLUDED_
+
+// MITK
+#include <MitkUSExports.h>
+#include <mitkCommon.h>
+#include <mitkImage.h>
+
+// ITK
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+#include <itkMultiThreader.h>
+#include <itkConditionVariable.h>
+#include <itkMutexLock.h>
+#include <itkSimpleFastMutexLock.h>
+
+// STL
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace mitk {
+  /**
+  * \brief Records image frames with timestamps into a single append-only stream file.
+  *
+  * Frames passed to mitk::USImageStreamRecorder::AddFrame() are copied into a
+  * bounded queue and written by a background thread, so that recording does
+  * not block the acquisition. If the queue is full, the frame is dropped and
+  * counted (see GetNumberOfDroppedFrames()). Memory usage is therefore limited
+  * to the maximum queue size times the size of one frame.
+  *
+  * The stream file starts with a short header followed by one record per frame
+  * (timestamp, pixel type, dimensions, spacing, origin and the raw pixel data)
+  * or message. Every record starts with its type and frame records store the
+  * payload size, so mitk::USImageStreamReader can build a frame index by
+  * skipping over the payloads and then seek by frame index or timestamp.
+  * Incomplete records at the end (e.g. after a crash) are ignored by the reader.
+  *
+  * \ingroup US
+  */
+  class MITKUS_EXPORT USImageStreamRecorder : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(USImageStreamRecorder, itk::Object);
+    itkFactorylessNewMacro(Self)
+
+    /** Identifier at the beginning of every stream file. */
+    static const char* FILE_IDENTIFIER;
+    /** Version of the stream file format written by this class. */
+    static const unsigned int FILE_VERSION;
+
+    enum RecordType { Record_Frame = 1, Record_Message = 2 };
+
+    /**
+    * \brief Maximum number of frames waiting to be written. Default is 64.
+    * Must be set before Start() is called.
+    */
+    itkSetMacro(MaximumQueueSize, unsigned int);
+    itkGetMacro(MaximumQueueSize, unsigned int);
+
+    /**
+    * \brief Opens the stream file and starts the writer thread.
+    * \throw mitk::Exception if the file cannot be opened or recording is already running
+    */
+    void Start(const std::string& fileName);
+
+    /**
+    * \brief Writes all queued frames, stops the writer thread and closes the files.
+    */
+    void Stop();
+
+    bool GetIsRecording() const;
+
+    /**
+    * \brief Queues a copy of the given 2D or 3D image for writing.
+    * \return false if the frame was dropped because the queue is full or recording is not running
+    */
+    bool AddFrame(const mitk::Image* image, double timeStamp);
+
+    /**
+    * \brief Queues a message which is associated with the last added frame.
+    */
+    void AddMessage(const std::string& message);
+
+    /** \brief Number of frames written to the stream file since Start() was called. */
+    unsigned long GetNumberOfRecordedFrames() const;
+
+    /** \brief Number of frames dropped since Start() was called. */
+    unsigned long GetNumberOfDroppedFrames() const;
+
+  protected:
+    USImageStreamRecorder();
+    virtual ~USImageStreamRecorder();
+
+    struct QueueItem
+    {
+      RecordType         type;
+      double             timeStamp;
+      int                componentType;
+      int                pixelType;
+      unsigned int       numberOfComponents;
+      unsigned int       dimension;
+      unsigned int       dimensions[3];
+      double             spacing[3];
+      double             origin[3];
+      std::vector<char>  data;
+      unsigned long long frameIndex;
+      std::string        message;
+    };
+
+    static ITK_THREAD_RETURN_TYPE WriterThread(void* pInfoStruct);
+
+    void WriteItem(QueueItem& item);
+
+  private:
+    unsigned int                m_MaximumQueueSize;
+    std::deque<QueueItem>       m_Queue;
+    std::vector<std::vector<char> > m_FreeBuffers; ///< recycled frame buffers, at most m_MaximumQueueSize
+
+    std::ofstream               m_StreamFile;
+
+    bool                        m_IsRecording;
+    bool                        m_StopRequested;
+    unsigned long long          m_NumberOfQueuedFrames;
+    unsigned long               m_NumberOfRecordedFrames;
+    unsigned long               m_NumberOfDroppedFrames;
+
+    itk::MultiThreader::Pointer m_MultiThreader;
+    int                         m_ThreadID;
+    itk::ConditionVariable::Pointer m_QueueCondition;
+    itk::SimpleMutexLock        m_QueueMutex;
+    mutable itk::SimpleFastMutexLock m_CounterMutex;
+  };
+} // namespace mitk
+
+#endif // MITKUSImageStreamRecorder_H_HEADER_INCLUDED_
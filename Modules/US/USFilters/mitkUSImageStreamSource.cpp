@@ -0,0 +1,70 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkUSImageStreamSource.h"
+
+mitk::USImageStreamSource::USImageStreamSource()
+  : m_Reader(mitk::USImageStreamReader::New()),
+  m_CurrentFrameIndex(0),
+  m_Loop(false)
+{
+}
+
+mitk::USImageStreamSource::~USImageStreamSource()
+{
+}
+
+void mitk::USImageStreamSource::SetStreamFile(const std::string& fileName)
+{
+  m_Reader->Open(fileName);
+  m_CurrentFrameIndex = 0;
+}
+
+void mitk::USImageStreamSource::SeekToFrame(unsigned int frameIndex)
+{
+  m_CurrentFrameIndex = frameIndex;
+}
+
+void mitk::USImageStreamSource::SeekToTimeStamp(double timeStamp)
+{
+  m_CurrentFrameIndex = m_Reader->GetFrameIndexForTimeStamp(timeStamp);
+}
+
+void mitk::USImageStreamSource::GetNextRawImage(mitk::Image::Pointer& image)
+{
+  unsigned int numberOfFrames = m_Reader->GetNumberOfFrames();
+  if (m_Loop && numberOfFrames > 0 && m_CurrentFrameIndex >= numberOfFrames)
+  {
+    m_CurrentFrameIndex = 0;
+  }
+
+  if (m_CurrentFrameIndex >= numberOfFrames)
+  {
+    image = nullptr;
+    return;
+  }
+
+  try
+  {
+    image = m_Reader->ReadFrame(m_CurrentFrameIndex);
+  }
+  catch (const mitk::Exception& e)
+  {
+    MITK_WARN("USImageStreamSource") << e.GetDescription();
+    image = nullptr;
+  }
+  ++m_CurrentFrameIndex;
+}
@@ -0,0 +1,81 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKUSImageStreamSource_H_HEADER_INCLUDED_
+#define MITKUSImageStreamSource_H_HEADER_INCLUDED_
+
+#include <mitkCommon.h>
+#include <MitkUSExports.h>
+#include <mitkUSImageSource.h>
+#include "mitkUSImageStreamReader.h"
+
+namespace mitk
+{
+  /**
+  * \brief Image source playing back a stream file recorded by mitk::USImageStreamRecorder.
+  *
+  * Every call of mitk::USImageSource::GetNextImage() returns the next frame of
+  * the stream. Playback can be positioned by frame index or by timestamp and
+  * optionally loops at the end of the stream.
+  *
+  * \ingroup US
+  */
+  class MITKUS_EXPORT USImageStreamSource : public USImageSource
+  {
+  public:
+    mitkClassMacro(USImageStreamSource, USImageSource);
+    itkFactorylessNewMacro(Self);
+
+    /**
+    * \brief Opens the given stream file and positions playback at the first frame.
+    * \throw mitk::Exception if the file cannot be opened
+    */
+    void SetStreamFile(const std::string& fileName);
+
+    itkGetMacro(Reader, mitk::USImageStreamReader::Pointer);
+
+    /** \brief If true, playback restarts at the first frame after the last frame. Default is false. */
+    itkSetMacro(Loop, bool);
+    itkGetMacro(Loop, bool);
+
+    /** \brief Index of the frame returned by the next call of GetNextImage(). */
+    itkGetMacro(CurrentFrameIndex, unsigned int);
+
+    void SeekToFrame(unsigned int frameIndex);
+
+    /** \brief Positions playback at the last frame recorded at or before the given timestamp. */
+    void SeekToTimeStamp(double timeStamp);
+
+  protected:
+    USImageStreamSource();
+    virtual ~USImageStreamSource();
+
+    using Superclass::GetNextRawImage;
+
+    /**
+    * \brief Reads the current frame from the stream file and advances playback.
+    * The image is null at the end of the stream if looping is disabled.
+    */
+    virtual void GetNextRawImage(mitk::Image::Pointer& image) override;
+
+  private:
+    mitk::USImageStreamReader::Pointer m_Reader;
+    unsigned int                       m_CurrentFrameIndex;
+    bool                               m_Loop;
+  };
+}  // namespace mitk
+
+#endif // MITKUSImageStreamSource_H_HEADER_INCLUDED_
@@ -201,14 +201,8 @@ void mitk::USImageVideoSource::GetNextRawImage( mitk::Image::Pointer& image )
 
   this->GetNextRawImage(cv_img);
 
-  // convert to MITK-Image
-  IplImage ipl_img = cv_img;
-
-  this->m_OpenCVToMitkFilter->SetOpenCVImage(&ipl_img);
-  this->m_OpenCVToMitkFilter->Update();
-
-  // OpenCVToMitkImageFilter returns a standard mitk::image. We then transform it into an USImage
-  image = this->m_OpenCVToMitkFilter->GetOutput();
+  // convert to MITK-Image, single channel frames are written into the frame pool
+  image = this->ConvertToPooledImage(cv_img);
 
   // clean up
   cv_img.release();
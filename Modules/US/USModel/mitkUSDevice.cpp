@@ -51,6 +51,9 @@ mitk::USDevice::USDevice(std::string manufacturer, std::string model)
   m_SpawnAcquireThread(true),
   m_MultiThreader(itk::MultiThreader::New()),
   m_ImageMutex(itk::FastMutexLock::New()),
+  m_ImageAcquisitionTime(0.0),
+  m_ImageDelivered(true),
+  m_Clock(itk::RealTimeClock::New()),
   m_ThreadID(-1),
   m_UnregisteringStarted(false)
 {
@@ -76,6 +79,9 @@ mitk::USDevice::USDevice(mitk::USImageMetadata::Pointer metadata)
   m_SpawnAcquireThread(true),
   m_MultiThreader(itk::MultiThreader::New()),
   m_ImageMutex(itk::FastMutexLock::New()),
+  m_ImageAcquisitionTime(0.0),
+  m_ImageDelivered(true),
+  m_Clock(itk::RealTimeClock::New()),
   m_ThreadID(-1),
   m_UnregisteringStarted(false)
 {
@@ -545,9 +551,28 @@ output->Graft( graft );
 
 void mitk::USDevice::GrabImage()
 {
+  double acquisitionStartTime = m_Clock->GetTimeInSeconds();
   mitk::Image::Pointer image = this->GetUSImageSource()->GetNextImage();
+  double acquisitionTime = m_Clock->GetTimeInSeconds();
+
+  if (image.IsNull() || !image->IsInitialized())
+  {
+    m_AcquisitionStatistics.AddDroppedFrame();
+  }
+  else
+  {
+    m_AcquisitionStatistics.AddFrame((acquisitionTime - acquisitionStartTime) * 1000.0);
+  }
+
   m_ImageMutex->Lock();
+  if (!m_ImageDelivered && m_Image.IsNotNull() && m_Image->IsInitialized())
+  {
+    // previous frame was replaced before any update of the output
+    m_OutputStatistics.AddDroppedFrame();
+  }
   this->SetImage(image);
+  m_ImageAcquisitionTime = acquisitionTime;
+  m_ImageDelivered = false;
   m_ImageMutex->Unlock();
   // if (image.IsNotNull() && (image->GetGeometry()!=NULL)){
   //  MITK_INFO << "Spacing: " << image->GetGeometry()->GetSpacing();}
@@ -597,9 +622,33 @@ void mitk::USDevice::GenerateData()
     m_Image->GetSliceData(0, 0, 0));
   output->SetSlice(inputReadAccessor.GetData());
   output->SetGeometry(m_Image->GetGeometry());
+
+  if (!m_ImageDelivered)
+  {
+    m_OutputStatistics.AddFrame((m_Clock->GetTimeInSeconds() - m_ImageAcquisitionTime) * 1000.0);
+    m_ImageDelivered = true;
+  }
   m_ImageMutex->Unlock();
 };
 
+mitk::Image::Pointer mitk::USDevice::GetCurrentFrame()
+{
+  m_ImageMutex->Lock();
+  mitk::Image::Pointer frame = m_Image;
+  m_ImageMutex->Unlock();
+  return frame;
+}
+
+const mitk::USImageStageStatistics& mitk::USDevice::GetAcquisitionStatistics() const
+{
+  return m_AcquisitionStatistics;
+}
+
+const mitk::USImageStageStatistics& mitk::USDevice::GetOutputStatistics() const
+{
+  return m_OutputStatistics;
+}
+
 std::string mitk::USDevice::GetServicePropertyLabel()
 {
   std::string isActive;
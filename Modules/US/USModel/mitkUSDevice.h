@@ -24,6 +24,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkUSProbe.h"
 #include <MitkUSExports.h>
 #include "mitkUSImageSource.h"
+#include "mitkUSImageStageStatistics.h"
 
 // MitkIGTL
 #include "mitkIGTLMessageProvider.h"
@@ -39,6 +40,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 // ITK
 #include <itkObjectFactory.h>
 #include <itkConditionVariable.h>
+#include <itkRealTimeClock.h>
 
 // Microservices
 #include <mitkServiceInterface.h>
@@ -312,6 +314,29 @@ namespace mitk {
 
       void GrabImage();
 
+    /**
+    * \brief Returns the most recently acquired frame without copying it.
+    * The frame may be shared with other consumers and must not be modified.
+    * Frames coming from the frame pool of the image source are recycled as
+    * soon as no consumer holds a reference anymore.
+    */
+    mitk::Image::Pointer GetCurrentFrame();
+
+    /**
+    * \brief Frame counters and latencies of the acquisition stage
+    * (time needed by mitk::USImageSource::GetNextImage()). Frames for which
+    * the image source delivered no image are counted as dropped.
+    */
+    const USImageStageStatistics& GetAcquisitionStatistics() const;
+
+    /**
+    * \brief Frame counters and latencies of the output stage (time from
+    * acquisition until the frame was copied to the output in GenerateData()).
+    * Acquired frames which were replaced before they reached the output are
+    * counted as dropped.
+    */
+    const USImageStageStatistics& GetOutputStatistics() const;
+
   protected:
     itkSetMacro(Image, mitk::Image::Pointer);
     itkSetMacro(SpawnAcquireThread, bool);
@@ -458,6 +483,11 @@ namespace mitk {
     itk::SimpleMutexLock        m_FreezeMutex;
     itk::MultiThreader::Pointer m_MultiThreader; ///< itk::MultiThreader used for thread handling
     itk::FastMutexLock::Pointer m_ImageMutex; ///< mutex for images provided by the image source
+    double m_ImageAcquisitionTime; ///< time stamp (in seconds) when m_Image was acquired
+    bool m_ImageDelivered; ///< true if m_Image was already copied to the output
+    itk::RealTimeClock::Pointer m_Clock; ///< clock used for the stage latencies
+    USImageStageStatistics m_AcquisitionStatistics;
+    USImageStageStatistics m_OutputStatistics;
     int m_ThreadID; ///< ID of the started thread
 
     bool m_UnregisteringStarted;
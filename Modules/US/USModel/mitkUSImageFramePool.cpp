@@ -0,0 +1,144 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkUSImageFramePool.h"
+
+mitk::USImageFramePool::USImageFramePool()
+  : m_MaximumNumberOfFrames(8),
+  m_NumberOfDroppedFrames(0),
+  m_FramesMutex(itk::FastMutexLock::New())
+{
+}
+
+mitk::USImageFramePool::~USImageFramePool()
+{
+}
+
+void mitk::USImageFramePool::SetMaximumNumberOfFrames(unsigned int maximumNumberOfFrames)
+{
+  m_FramesMutex->Lock();
+  m_MaximumNumberOfFrames = maximumNumberOfFrames;
+  m_FramesMutex->Unlock();
+  this->ReleaseUnusedFrames();
+}
+
+unsigned int mitk::USImageFramePool::GetMaximumNumberOfFrames() const
+{
+  m_FramesMutex->Lock();
+  unsigned int maximumNumberOfFrames = m_MaximumNumberOfFrames;
+  m_FramesMutex->Unlock();
+  return maximumNumberOfFrames;
+}
+
+bool mitk::USImageFramePool::HasLayout(const mitk::Image* frame, const mitk::PixelType& pixelType,
+  unsigned int dimension, const unsigned int* dimensions)
+{
+  if (!frame->IsInitialized() || frame->GetDimension() != dimension || frame->GetPixelType() != pixelType)
+  {
+    return false;
+  }
+
+  for (unsigned int d = 0; d < dimension; ++d)
+  {
+    if (frame->GetDimension(d) != dimensions[d])
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+mitk::Image::Pointer mitk::USImageFramePool::AcquireFrame(const mitk::PixelType& pixelType,
+  unsigned int dimension, const unsigned int* dimensions)
+{
+  m_FramesMutex->Lock();
+
+  // a reference count of one means that only the pool references the frame
+  mitk::Image::Pointer result;
+  for (std::vector<mitk::Image::Pointer>::iterator it = m_Frames.begin(); it != m_Frames.end(); ++it)
+  {
+    if ((*it)->GetReferenceCount() == 1 && HasLayout(*it, pixelType, dimension, dimensions))
+    {
+      result = *it;
+      break;
+    }
+  }
+
+  if (result.IsNull())
+  {
+    // make room for a frame with the new layout by dropping free frames of a different layout
+    for (std::vector<mitk::Image::Pointer>::iterator it = m_Frames.begin(); it != m_Frames.end();)
+    {
+      if ((*it)->GetReferenceCount() == 1) { it = m_Frames.erase(it); }
+      else { ++it; }
+    }
+
+    if (m_Frames.size() < m_MaximumNumberOfFrames)
+    {
+      result = mitk::Image::New();
+      result->Initialize(pixelType, dimension, dimensions);
+      m_Frames.push_back(result);
+    }
+    else
+    {
+      ++m_NumberOfDroppedFrames;
+    }
+  }
+
+  m_FramesMutex->Unlock();
+
+  return result;
+}
+
+void mitk::USImageFramePool::ReleaseUnusedFrames()
+{
+  m_FramesMutex->Lock();
+  for (std::vector<mitk::Image::Pointer>::iterator it = m_Frames.begin(); it != m_Frames.end();)
+  {
+    if ((*it)->GetReferenceCount() == 1) { it = m_Frames.erase(it); }
+    else { ++it; }
+  }
+  m_FramesMutex->Unlock();
+}
+
+unsigned int mitk::USImageFramePool::GetNumberOfFrames() const
+{
+  m_FramesMutex->Lock();
+  unsigned int numberOfFrames = static_cast<unsigned int>(m_Frames.size());
+  m_FramesMutex->Unlock();
+  return numberOfFrames;
+}
+
+unsigned int mitk::USImageFramePool::GetNumberOfFramesInUse() const
+{
+  m_FramesMutex->Lock();
+  unsigned int numberOfFramesInUse = 0;
+  for (std::vector<mitk::Image::Pointer>::const_iterator it = m_Frames.begin(); it != m_Frames.end(); ++it)
+  {
+    if ((*it)->GetReferenceCount() > 1) { ++numberOfFramesInUse; }
+  }
+  m_FramesMutex->Unlock();
+  return numberOfFramesInUse;
+}
+
+unsigned long mitk::USImageFramePool::GetNumberOfDroppedFrames() const
+{
+  m_FramesMutex->Lock();
+  unsigned long numberOfDroppedFrames = m_NumberOfDroppedFrames;
+  m_FramesMutex->Unlock();
+  return numberOfDroppedFrames;
+}
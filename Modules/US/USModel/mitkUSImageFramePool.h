@@ -0,0 +1,95 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKUSImageFramePool_H_HEADER_INCLUDED_
+#define MITKUSImageFramePool_H_HEADER_INCLUDED_
+
+#include <MitkUSExports.h>
+#include <mitkCommon.h>
+#include <mitkImage.h>
+
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+#include <itkFastMutexLock.h>
+
+#include <vector>
+
+namespace mitk {
+  /**
+  * \brief Pool of preallocated frame images which are recycled between acquisitions.
+  *
+  * Frames handed out by mitk::USImageFramePool::AcquireFrame() are ordinary
+  * mitk::Image objects whose buffers stay allocated for the lifetime of the pool.
+  * A frame is reused as soon as the pool holds the only reference to it, so
+  * consumers (display, filters, OpenIGTLink export) can share a frame without
+  * copying it simply by keeping a smart pointer for as long as they need the data.
+  *
+  * If all frames are in use and the maximum number of frames is reached,
+  * AcquireFrame() returns a null pointer and the frame is counted as dropped.
+  *
+  * \ingroup US
+  */
+  class MITKUS_EXPORT USImageFramePool : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(USImageFramePool, itk::Object);
+    itkFactorylessNewMacro(Self)
+
+    /**
+    * \brief Maximum number of frames held by the pool. Default is 8.
+    * Reducing the value does not release frames which are currently in use.
+    */
+    void SetMaximumNumberOfFrames(unsigned int maximumNumberOfFrames);
+    unsigned int GetMaximumNumberOfFrames() const;
+
+    /**
+    * \brief Returns a frame with the given layout which is not referenced by
+    * any consumer anymore. A new frame is allocated if no free frame with
+    * matching layout exists and the pool is not exhausted. Free frames with a
+    * different layout are released first.
+    *
+    * \return the frame or a null pointer if all frames are in use
+    */
+    mitk::Image::Pointer AcquireFrame(const mitk::PixelType& pixelType, unsigned int dimension, const unsigned int* dimensions);
+
+    /** \brief Releases all frames which are not in use by a consumer. */
+    void ReleaseUnusedFrames();
+
+    /** \brief Number of frames currently allocated by the pool. */
+    unsigned int GetNumberOfFrames() const;
+
+    /** \brief Number of frames currently referenced by at least one consumer. */
+    unsigned int GetNumberOfFramesInUse() const;
+
+    /** \brief Number of requests which could not be served since the pool was exhausted. */
+    unsigned long GetNumberOfDroppedFrames() const;
+
+  protected:
+    USImageFramePool();
+    virtual ~USImageFramePool();
+
+    static bool HasLayout(const mitk::Image* frame, const mitk::PixelType& pixelType, unsigned int dimension, const unsigned int* dimensions);
+
+  private:
+    std::vector<mitk::Image::Pointer> m_Frames;
+    unsigned int                      m_MaximumNumberOfFrames;
+    unsigned long                     m_NumberOfDroppedFrames;
+
+    itk::FastMutexLock::Pointer       m_FramesMutex;
+  };
+} // namespace mitk
+
+#endif // MITKUSImageFramePool_H_HEADER_INCLUDED_
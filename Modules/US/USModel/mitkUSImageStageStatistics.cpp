@@ -0,0 +1,94 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkUSImageStageStatistics.h"
+
+mitk::USImageStageStatistics::USImageStageStatistics()
+  : m_NumberOfFrames(0),
+  m_NumberOfDroppedFrames(0),
+  m_LastLatency(0.0),
+  m_LatencySum(0.0),
+  m_MaximumLatency(0.0)
+{
+}
+
+void mitk::USImageStageStatistics::AddFrame(double latencyInMs)
+{
+  m_Mutex.Lock();
+  ++m_NumberOfFrames;
+  m_LastLatency = latencyInMs;
+  m_LatencySum += latencyInMs;
+  if (latencyInMs > m_MaximumLatency) { m_MaximumLatency = latencyInMs; }
+  m_Mutex.Unlock();
+}
+
+void mitk::USImageStageStatistics::AddDroppedFrame()
+{
+  m_Mutex.Lock();
+  ++m_NumberOfDroppedFrames;
+  m_Mutex.Unlock();
+}
+
+void mitk::USImageStageStatistics::Reset()
+{
+  m_Mutex.Lock();
+  m_NumberOfFrames = 0;
+  m_NumberOfDroppedFrames = 0;
+  m_LastLatency = 0.0;
+  m_LatencySum = 0.0;
+  m_MaximumLatency = 0.0;
+  m_Mutex.Unlock();
+}
+
+unsigned long mitk::USImageStageStatistics::GetNumberOfFrames() const
+{
+  m_Mutex.Lock();
+  unsigned long numberOfFrames = m_NumberOfFrames;
+  m_Mutex.Unlock();
+  return numberOfFrames;
+}
+
+unsigned long mitk::USImageStageStatistics::GetNumberOfDroppedFrames() const
+{
+  m_Mutex.Lock();
+  unsigned long numberOfDroppedFrames = m_NumberOfDroppedFrames;
+  m_Mutex.Unlock();
+  return numberOfDroppedFrames;
+}
+
+double mitk::USImageStageStatistics::GetLastLatency() const
+{
+  m_Mutex.Lock();
+  double lastLatency = m_LastLatency;
+  m_Mutex.Unlock();
+  return lastLatency;
+}
+
+double mitk::USImageStageStatistics::GetMeanLatency() const
+{
+  m_Mutex.Lock();
+  double meanLatency = m_NumberOfFrames > 0 ? m_LatencySum / m_NumberOfFrames : 0.0;
+  m_Mutex.Unlock();
+  return meanLatency;
+}
+
+double mitk::USImageStageStatistics::GetMaximumLatency() const
+{
+  m_Mutex.Lock();
+  double maximumLatency = m_MaximumLatency;
+  m_Mutex.Unlock();
+  return maximumLatency;
+}
@@ -0,0 +1,64 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKUSImageStageStatistics_H_HEADER_INCLUDED_
+#define MITKUSImageStageStatistics_H_HEADER_INCLUDED_
+
+#include <MitkUSExports.h>
+
+#include <itkSimpleFastMutexLock.h>
+
+namespace mitk {
+  /**
+  * \brief Thread safe frame and latency counters for one stage of the
+  * ultrasound image pipeline (e.g. acquisition, filtering or output).
+  *
+  * Latencies are given in milliseconds.
+  *
+  * \ingroup US
+  */
+  class MITKUS_EXPORT USImageStageStatistics
+  {
+  public:
+    USImageStageStatistics();
+
+    /** \brief Counts a frame which passed the stage with the given latency. */
+    void AddFrame(double latencyInMs);
+
+    /** \brief Counts a frame which was dropped in this stage. */
+    void AddDroppedFrame();
+
+    /** \brief Resets all counters to zero. */
+    void Reset();
+
+    unsigned long GetNumberOfFrames() const;
+    unsigned long GetNumberOfDroppedFrames() const;
+    double GetLastLatency() const;
+    double GetMeanLatency() const;
+    double GetMaximumLatency() const;
+
+  private:
+    unsigned long m_NumberOfFrames;
+    unsigned long m_NumberOfDroppedFrames;
+    double        m_LastLatency;
+    double        m_LatencySum;
+    double        m_MaximumLatency;
+
+    mutable itk::SimpleFastMutexLock m_Mutex;
+  };
+} // namespace mitk
+
+#endif // MITKUSImageStageStatistics_H_HEADER_INCLUDED_
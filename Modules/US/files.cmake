@@ -12,9 +12,14 @@ USModel/mitkUSVideoDevice.cpp
 USModel/mitkUSVideoDeviceCustomControls.cpp
 USModel/mitkUSProbe.cpp
 USModel/mitkUSDevicePersistence.cpp
+USModel/mitkUSImageFramePool.cpp
+USModel/mitkUSImageStageStatistics.cpp
 
 ## Filters and Sources
 USFilters/mitkUSImageLoggingFilter.cpp
+USFilters/mitkUSImageStreamRecorder.cpp
+USFilters/mitkUSImageStreamReader.cpp
+USFilters/mitkUSImageStreamSource.cpp
 USFilters/mitkUSImageSource.cpp
 USFilters/mitkUSImageVideoSource.cpp
 USFilters/mitkIGTLMessageToUSImageFilter.cpp
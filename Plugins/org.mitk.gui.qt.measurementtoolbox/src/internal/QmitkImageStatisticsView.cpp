@@ -48,6 +48,7 @@ QmitkImageStatisticsView::QmitkImageStatisticsView(QObject* /*parent*/, const ch
   m_ImageObserverTag( -1 ),
   m_ImageMaskObserverTag( -1 ),
   m_PlanarFigureObserverTag( -1 ),
+  m_PlanarFigureModifiedObserverTag( -1 ),
   m_TimeObserverTag( -1 ),
   m_CurrentStatisticsValid( false ),
   m_StatisticsUpdatePending( false ),
@@ -55,6 +56,7 @@ QmitkImageStatisticsView::QmitkImageStatisticsView(QObject* /*parent*/, const ch
   m_Visible(false)
 {
   this->m_CalculationThread = new QmitkImageStatisticsCalculationThread;
+  this->m_PlanarFigureSliceStatisticsCalculator = mitk::PlanarFigureSliceStatisticsCalculator::New();
 }
 
 QmitkImageStatisticsView::~QmitkImageStatisticsView()
@@ -64,7 +66,10 @@ QmitkImageStatisticsView::~QmitkImageStatisticsView()
   if ( m_SelectedImageMask != NULL )
     m_SelectedImageMask->RemoveObserver( m_ImageMaskObserverTag );
   if ( m_SelectedPlanarFigure != NULL )
+  {
     m_SelectedPlanarFigure->RemoveObserver( m_PlanarFigureObserverTag );
+    m_SelectedPlanarFigure->RemoveObserver( m_PlanarFigureModifiedObserverTag );
+  }
 
   while(this->m_CalculationThread->isRunning()) // wait until thread has finished
   {
@@ -525,6 +530,7 @@ void QmitkImageStatisticsView::ReinitData()
   if(this->m_SelectedPlanarFigure != NULL)
   {
     this->m_SelectedPlanarFigure->RemoveObserver( this->m_PlanarFigureObserverTag);
+    this->m_SelectedPlanarFigure->RemoveObserver( this->m_PlanarFigureModifiedObserverTag);
     this->m_SelectedPlanarFigure = NULL;
   }
   this->m_SelectedDataNodes.clear();
@@ -607,6 +613,10 @@ void QmitkImageStatisticsView::UpdateStatistics()
         this->m_SelectedPlanarFigure = planarFig;
         this->m_PlanarFigureObserverTag  =
             this->m_SelectedPlanarFigure->AddObserver(mitk::EndInteractionPlanarFigureEvent(), changeListener);
+        ITKCommandType::Pointer planarFigureModifiedListener = ITKCommandType::New();
+        planarFigureModifiedListener->SetCallbackFunction( this, &QmitkImageStatisticsView::SelectedPlanarFigureModified );
+        this->m_PlanarFigureModifiedObserverTag =
+            this->m_SelectedPlanarFigure->AddObserver(itk::ModifiedEvent(), planarFigureModifiedListener);
         maskName = this->m_SelectedDataNodes.at(i)->GetName();
         maskType = this->m_SelectedPlanarFigure->GetNameOfClass();
         maskDimension = 2;
@@ -777,6 +787,63 @@ void QmitkImageStatisticsView::SelectedDataModified()
   }
 }
 
+void QmitkImageStatisticsView::SelectedPlanarFigureModified()
+{
+  // only refresh statistics that are already shown, the exact calculation is triggered when the interaction ends
+  if ( !m_CurrentStatisticsValid || m_StatisticsUpdatePending || this->m_CalculationThread->isRunning()
+       || m_SelectedImage == NULL || m_SelectedPlanarFigure == NULL || !m_SelectedPlanarFigure->IsClosed()
+       || this->m_Controls->m_StatisticsTable->columnCount() != static_cast<int>(m_SelectedImage->GetTimeSteps()) )
+  {
+    return;
+  }
+
+  this->m_PlanarFigureSliceStatisticsCalculator->SetInputImage( m_SelectedImage );
+  this->m_PlanarFigureSliceStatisticsCalculator->SetPlanarFigure( m_SelectedPlanarFigure );
+
+  int decimals = 2;
+  mitk::PixelType doublePix = mitk::MakeScalarPixelType< double >();
+  mitk::PixelType floatPix = mitk::MakeScalarPixelType< float >();
+  if (m_SelectedImage->GetPixelType()==doublePix || m_SelectedImage->GetPixelType()==floatPix)
+  {
+    decimals = 5;
+  }
+  const mitk::Vector3D &spacing = m_SelectedImage->GetGeometry()->GetSpacing();
+
+  try
+  {
+    for (unsigned int t = 0; t < m_SelectedImage->GetTimeSteps(); t++)
+    {
+      mitk::PlanarFigureSliceStatisticsCalculator::Statistics s =
+          this->m_PlanarFigureSliceStatisticsCalculator->GetStatistics(t);
+
+      this->m_Controls->m_StatisticsTable->setItem( 0, t, new QTableWidgetItem(
+          QString("%1").arg(s.Mean, 0, 'f', decimals) ) );
+      this->m_Controls->m_StatisticsTable->setItem( 2, t, new QTableWidgetItem(
+          QString("%1").arg(s.Std, 0, 'f', decimals) ) );
+      this->m_Controls->m_StatisticsTable->setItem( 3, t, new QTableWidgetItem(
+          QString("%1").arg(s.RMS, 0, 'f', decimals) ) );
+      this->m_Controls->m_StatisticsTable->setItem( 6, t, new QTableWidgetItem(
+          QString("%1").arg(s.N) ) );
+      double volume = spacing[0] * spacing[1] * spacing[2] * (double) s.N;
+      this->m_Controls->m_StatisticsTable->setItem( 7, t, new QTableWidgetItem(
+          QString("%1").arg(volume, 0, 'f', decimals) ) );
+
+      // the remaining rows still belong to the old figure until the exact calculation has finished
+      for ( int row = 0; row < this->m_Controls->m_StatisticsTable->rowCount(); ++row )
+      {
+        if ( row != 0 && row != 2 && row != 3 && row != 6 && row != 7 )
+        {
+          this->m_Controls->m_StatisticsTable->setItem( row, t, new QTableWidgetItem( "NA" ) );
+        }
+      }
+    }
+  }
+  catch ( const mitk::Exception& )
+  {
+    // e.g. figure dragged out of the image, reported by the exact calculation after the interaction
+  }
+}
+
 void QmitkImageStatisticsView::NodeRemoved(const mitk::DataNode *node)
 {
   while(this->m_CalculationThread->isRunning()) // wait until thread has finished
@@ -27,6 +27,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 // mitk includes
 #include "mitkImageStatisticsCalculator.h"
+#include "mitkPlanarFigureSliceStatisticsCalculator.h"
 #include "mitkILifecycleAwarePart.h"
 #include "mitkPlanarLine.h"
 
@@ -144,6 +145,10 @@ protected:
 
   /** \brief Method called when itkModifiedEvent is called by selected data. */
   void SelectedDataModified();
+  /** \brief Method called while the selected planar figure is modified (e.g. dragged). Updates mean, std, RMS, N
+  * and volume of the current statistics from the summed-area tables of the figure's slice and shows "NA" for
+  * the other statistics. All statistics are recalculated once the interaction has ended. */
+  void SelectedPlanarFigureModified();
   /** \brief  Method called when the data manager selection changes */
   void SelectionChanged(const QList<mitk::DataNode::Pointer> &selectedNodes);
   /** \brief  Method called to remove old selection when a new selection is present */
@@ -165,6 +170,7 @@ protected:
   // if you have a planar figure selected, the statistics values will be saved in this one.
   std::vector<QString> m_PlanarFigureStatistics;
   QmitkImageStatisticsCalculationThread* m_CalculationThread;
+  mitk::PlanarFigureSliceStatisticsCalculator::Pointer m_PlanarFigureSliceStatisticsCalculator;
 
   QmitkStepperAdapter*      m_TimeStepperAdapter;
   unsigned int              m_CurrentTime;
@@ -179,6 +185,7 @@ protected:
   long m_ImageObserverTag;
   long m_ImageMaskObserverTag;
   long m_PlanarFigureObserverTag;
+  long m_PlanarFigureModifiedObserverTag;
   long m_TimeObserverTag;
 
   SelectedDataNodeVectorType m_SelectedDataNodes;